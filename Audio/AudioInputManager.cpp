@@ -2,7 +2,6 @@
 
 #include "AudioInputManager.h"
 #include <cmath>
-#include <complex>
 #include <algorithm>
 #include <thread>
 #include <functional>
@@ -22,6 +21,8 @@
 #endif
 
 static constexpr float PI_F = 3.14159265358979323846f;
+/** One large capture packet at a small hop would otherwise run a burst of analyses back to back; older frames in it are skipped. */
+static constexpr int MAX_SPECTRUM_FRAMES_PER_BUFFER = 8;
 
 #ifdef _WIN32
 class AudioInputManager::WasapiCapturer
@@ -253,7 +254,7 @@ AudioInputManager::AudioInputManager(QObject* parent)
 {
     level_timer.setInterval(33);
     connect(&level_timer, &QTimer::timeout, this, &AudioInputManager::onLevelTick);
-    sample_buffer.reserve(fft_size * 4);
+    resetSampleHistoryLocked();
     bands16.assign(bands_count, 0.0f);
     eq_gain.assign(bands_count, 1.0f);
     resetAutoLevel();
@@ -500,6 +501,7 @@ void AudioInputManager::resetAnalyzerTuning()
     auto_level_enabled = true;
     auto_level_peak_decay = 0.995f;
     auto_level_floor_decay = 0.9995f;
+    setFFTOverlap(0.5f);
     resetAutoLevel();
 }
 
@@ -734,7 +736,7 @@ void AudioInputManager::setFFTSize(int n)
     }
     fft_size = chosen;
     band_peak_smoothed.assign(bands_count, 0.1f);
-    sample_buffer.clear();
+    resetSampleHistoryLocked();
     window.clear();
     prev_mags.clear();
     prev_band_frame.assign(bands_count, 0.0f);
@@ -745,6 +747,35 @@ void AudioInputManager::setFFTSize(int n)
     band_peak_activity.assign(bands_count, 0.05f);
 }
 
+void AudioInputManager::setFFTOverlap(float overlap)
+{
+    QMutexLocker bl(&bands_mutex);
+    fft_overlap = std::clamp(overlap, 0.0f, 0.9375f);
+}
+
+void AudioInputManager::setFFTHopSize(int hop_samples)
+{
+    if(fft_size <= 0)
+    {
+        return;
+    }
+    setFFTOverlap(1.0f - (float)hop_samples / (float)fft_size);
+}
+
+int AudioInputManager::getFFTHopSize() const
+{
+    const int hop = (int)std::lround((float)fft_size * (1.0f - fft_overlap));
+    return std::clamp(hop, 1, std::max(1, fft_size));
+}
+
+void AudioInputManager::resetSampleHistoryLocked()
+{
+    sample_history.assign((size_t)fft_size, 0.0f);
+    history_write = 0;
+    history_filled = 0;
+    samples_since_hop = 0;
+}
+
 void AudioInputManager::setCrossovers(float bass_upper_hz, float mid_upper_hz)
 {
     if(bass_upper_hz < 20.0f) bass_upper_hz = 20.0f;
@@ -773,6 +804,14 @@ void AudioInputManager::processBuffer(const char* data, int bytes)
     int count = bytes / (int)sizeof(int16_t);
     if(count <= 0) return;
 
+    if((int)sample_history.size() != fft_size)
+    {
+        resetSampleHistoryLocked();
+    }
+    const int history_mask = fft_size - 1;
+    const int hop = getFFTHopSize();
+    int skip_frames = std::max(0, (samples_since_hop + count) / hop - MAX_SPECTRUM_FRAMES_PER_BUFFER);
+
     double sum = 0.0;
     for(int i = 0; i < count; i++)
     {
@@ -780,9 +819,24 @@ void AudioInputManager::processBuffer(const char* data, int bytes)
         float scaled = (float)(s * gain);
         float limited = (std::abs(scaled) >= 1.0f) ? (scaled > 0 ? 1.0f : -1.0f)
                        : (float)std::tanh((double)scaled);
-        sample_buffer.push_back(limited);
+        sample_history[history_write] = limited;
+        history_write = (history_write + 1) & history_mask;
+        if(history_filled < fft_size) history_filled++;
         double d = (double)limited;
         sum += d * d;
+
+        if(++samples_since_hop >= hop)
+        {
+            samples_since_hop = 0;
+            if(skip_frames > 0)
+            {
+                skip_frames--;
+            }
+            else if(history_filled == fft_size)
+            {
+                computeSpectrum();
+            }
+        }
     }
     double rms = std::sqrt(sum / std::max(1, count));
     double val = rms;
@@ -849,17 +903,6 @@ void AudioInputManager::processBuffer(const char* data, int bytes)
     if(out < 0.0f) out = 0.0f;
     if(out > 1.0f) out = 1.0f;
     current_level.store(out);
-
-    if((int)sample_buffer.size() >= fft_size)
-    {
-        computeSpectrum();
-        int keep = fft_size / 2;
-        if(keep < 1) keep = 1;
-        if((int)sample_buffer.size() > keep)
-        {
-            sample_buffer.erase(sample_buffer.begin(), sample_buffer.end() - keep);
-        }
-    }
 }
 
 void AudioInputManager::updateChannelLevels(const std::vector<float>& levels)
@@ -931,55 +974,27 @@ void AudioInputManager::ensureWindow()
     }
 }
 
-static void fft_cooley_tukey(std::vector<std::complex<float>>& a)
-{
-    const size_t n = a.size();
-    size_t j = 0;
-    for(size_t i = 1; i < n; i++)
-    {
-        size_t bit = n >> 1;
-        for(; j & bit; bit >>= 1) j ^= bit;
-        j ^= bit;
-        if(i < j) std::swap(a[i], a[j]);
-    }
-    for(size_t len = 2; len <= n; len <<= 1)
-    {
-        float ang = -2.0f * PI_F / (float)len;
-        std::complex<float> wlen(std::cos(ang), std::sin(ang));
-        for(size_t i = 0; i < n; i += len)
-        {
-            std::complex<float> w(1.0f, 0.0f);
-            for(size_t k = 0; k < len/2; k++)
-            {
-                std::complex<float> u = a[i + k];
-                std::complex<float> v = a[i + k + len/2] * w;
-                a[i + k] = u + v;
-                a[i + k + len/2] = u - v;
-                w *= wlen;
-            }
-        }
-    }
-}
-
 void AudioInputManager::computeSpectrum()
 {
     ensureWindow();
-    if((int)sample_buffer.size() < fft_size) return;
-    std::vector<std::complex<float>> buf(fft_size);
-    int start = (int)sample_buffer.size() - fft_size;
-    for(int i = 0; i < fft_size; i++)
+    if(history_filled < fft_size || (int)sample_history.size() != fft_size) return;
+    fft.prepare(fft_size);
+    int n2 = fft_size / 2;
+    fft_frame.resize((size_t)fft_size);
+    fft_mags.resize((size_t)n2);
+
+    // Unroll the ring oldest-first: [history_write, fft_size) then [0, history_write).
+    const int tail = fft_size - history_write;
+    for(int i = 0; i < tail; i++)
     {
-        float s = sample_buffer[start + i] * window[i];
-        buf[i] = std::complex<float>(s, 0.0f);
+        fft_frame[i] = sample_history[history_write + i] * window[i];
     }
-    fft_cooley_tukey(buf);
-    int n2 = fft_size / 2;
-    std::vector<float> mags(n2);
-    for(int i = 0; i < n2; i++)
+    for(int i = tail; i < fft_size; i++)
     {
-        float m = std::abs(buf[i]) / (fft_size * 0.5f);
-        mags[i] = m;
+        fft_frame[i] = sample_history[i - tail] * window[i];
     }
+    fft.magnitudes(fft_frame.data(), 1.0f / (fft_size * 0.5f), fft_mags.data());
+    const std::vector<float>& mags = fft_mags;
 
     float fs = (float)sample_rate_hz;
     float bin_min = (fft_size > 0) ? (fs / (float)fft_size) : 1.0f;
@@ -989,13 +1004,14 @@ void AudioInputManager::computeSpectrum()
     {
         return;
     }
-    std::vector<float> eq_copy;
     {
         QMutexLocker bl(&bands_mutex);
         ensureEqGainSizeLocked();
-        eq_copy = eq_gain;
+        eq_frame = eq_gain;
     }
-    std::vector<float> newBands(bands_count, 0.0f);
+    const std::vector<float>& eq_copy = eq_frame;
+    band_frame.assign(bands_count, 0.0f);
+    std::vector<float>& newBands = band_frame;
     for(int b = 0; b < bands_count; b++)
     {
         float t0 = (float)b / (float)bands_count;
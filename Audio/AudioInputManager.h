@@ -10,6 +10,7 @@
 #include <QTimer>
 #include <QString>
 #include <QStringList>
+#include "RealFFT.h"
 #include <atomic>
 #include <vector>
 
@@ -40,6 +41,12 @@ public:
     void setCrossovers(float bass_upper_hz, float mid_upper_hz);
     void setFFTSize(int n);
     int  getFFTSize() const { return fft_size; }
+    /** Fraction of each analysis frame shared with the next (0 .. 15/16); 0.5 runs a frame every fft_size / 2 samples. */
+    void  setFFTOverlap(float overlap);
+    float getFFTOverlap() const { return fft_overlap; }
+    /** Same as setFFTOverlap(1 - hop / fft_size); the overlap, not the hop, is kept across FFT size changes. */
+    void setFFTHopSize(int hop_samples);
+    int  getFFTHopSize() const;
     int  getBandsCount() const;
     float getBassUpperHz() const { return xover_bass_upper; }
     float getMidUpperHz() const { return xover_mid_upper; }
@@ -192,8 +199,19 @@ private:
 
     int fft_size = 512;
     int sample_rate_hz = 48000;
-    std::vector<float> sample_buffer;
+    float fft_overlap = 0.5f;
+    /** Ring of the last fft_size limited samples; the oldest sits at history_write once history_filled == fft_size. */
+    std::vector<float> sample_history;
+    int history_write = 0;
+    int history_filled = 0;
+    int samples_since_hop = 0;
     std::vector<float> window;
+    /** Per-hop scratch, sized with fft_size / bands_count so steady-state analysis does not allocate. */
+    RealFFT fft;
+    std::vector<float> fft_frame;
+    std::vector<float> fft_mags;
+    std::vector<float> band_frame;
+    std::vector<float> eq_frame;
     mutable QRecursiveMutex bands_mutex;
     std::vector<float> bands16;
     float bass_level = 0.0f;
@@ -222,6 +240,7 @@ private:
     float visualizer_floor = 1e-4f;
 
     void ensureWindow();
+    void resetSampleHistoryLocked();
     void computeSpectrum();
 
 #ifdef _WIN32
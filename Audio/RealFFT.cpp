@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "RealFFT.h"
+
+#include <cmath>
+
+static constexpr double PI_D = 3.14159265358979323846;
+
+void RealFFT::prepare(int size)
+{
+    if(size == n || size < 4 || (size & (size - 1)) != 0)
+    {
+        return;
+    }
+
+    n = size;
+    half = size / 2;
+
+    int bits = 0;
+    while((1 << bits) < half)
+    {
+        bits++;
+    }
+    bit_reverse.resize((size_t)half);
+    for(int i = 0; i < half; i++)
+    {
+        uint32_t r = 0;
+        for(int b = 0; b < bits; b++)
+        {
+            r |= (uint32_t)((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse[(size_t)i] = r;
+    }
+
+    // Tables are evaluated in double once; the old per-stage "w *= wlen" recurrence drifted at 8192 points.
+    const int quarter = half / 2;
+    twiddle_re.resize((size_t)quarter);
+    twiddle_im.resize((size_t)quarter);
+    for(int j = 0; j < quarter; j++)
+    {
+        const double angle = -2.0 * PI_D * (double)j / (double)half;
+        twiddle_re[(size_t)j] = (float)std::cos(angle);
+        twiddle_im[(size_t)j] = (float)std::sin(angle);
+    }
+
+    split_re.resize((size_t)half);
+    split_im.resize((size_t)half);
+    for(int k = 0; k < half; k++)
+    {
+        const double angle = -2.0 * PI_D * (double)k / (double)n;
+        split_re[(size_t)k] = (float)std::cos(angle);
+        split_im[(size_t)k] = (float)std::sin(angle);
+    }
+
+    work_re.assign((size_t)half, 0.0f);
+    work_im.assign((size_t)half, 0.0f);
+}
+
+void RealFFT::transformPacked(const float* input)
+{
+    float* re = work_re.data();
+    float* im = work_im.data();
+
+    for(int k = 0; k < half; k++)
+    {
+        const uint32_t j = bit_reverse[(size_t)k];
+        re[j] = input[2 * k];
+        im[j] = input[2 * k + 1];
+    }
+
+    // First stage: every twiddle is 1.
+    for(int i = 0; i < half; i += 2)
+    {
+        const float ar = re[i], ai = im[i];
+        const float br = re[i + 1], bi = im[i + 1];
+        re[i] = ar + br;
+        im[i] = ai + bi;
+        re[i + 1] = ar - br;
+        im[i + 1] = ai - bi;
+    }
+
+    for(int len = 4; len <= half; len <<= 1)
+    {
+        const int span = len >> 1;
+        const int step = half / len;
+        for(int i = 0; i < half; i += len)
+        {
+            for(int k = 0; k < span; k++)
+            {
+                const float wr = twiddle_re[(size_t)(k * step)];
+                const float wi = twiddle_im[(size_t)(k * step)];
+                const int a = i + k;
+                const int b = a + span;
+                const float vr = re[b] * wr - im[b] * wi;
+                const float vi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - vr;
+                im[b] = im[a] - vi;
+                re[a] += vr;
+                im[a] += vi;
+            }
+        }
+    }
+}
+
+void RealFFT::forward(const float* input, float* out_re, float* out_im)
+{
+    if(n == 0)
+    {
+        return;
+    }
+    transformPacked(input);
+
+    const float* re = work_re.data();
+    const float* im = work_im.data();
+    const int mask = half - 1;
+
+    // X[k] = E[k] + W^k O[k], with E = (Z[k] + conj(Z[half-k])) / 2 and O = (Z[k] - conj(Z[half-k])) / 2i.
+    for(int k = 0; k < half; k++)
+    {
+        const int m = (half - k) & mask;
+        const float er = 0.5f * (re[k] + re[m]);
+        const float ei = 0.5f * (im[k] - im[m]);
+        const float orr = 0.5f * (im[k] + im[m]);
+        const float oi = -0.5f * (re[k] - re[m]);
+        const float wr = split_re[(size_t)k];
+        const float wi = split_im[(size_t)k];
+        out_re[k] = er + wr * orr - wi * oi;
+        out_im[k] = ei + wr * oi + wi * orr;
+    }
+    out_re[half] = re[0] - im[0];
+    out_im[half] = 0.0f;
+}
+
+void RealFFT::magnitudes(const float* input, float scale, float* out)
+{
+    if(n == 0)
+    {
+        return;
+    }
+    transformPacked(input);
+
+    const float* re = work_re.data();
+    const float* im = work_im.data();
+    const int mask = half - 1;
+
+    for(int k = 0; k < half; k++)
+    {
+        const int m = (half - k) & mask;
+        const float er = 0.5f * (re[k] + re[m]);
+        const float ei = 0.5f * (im[k] - im[m]);
+        const float orr = 0.5f * (im[k] + im[m]);
+        const float oi = -0.5f * (re[k] - re[m]);
+        const float wr = split_re[(size_t)k];
+        const float wi = split_im[(size_t)k];
+        const float xr = er + wr * orr - wi * oi;
+        const float xi = ei + wr * oi + wi * orr;
+        out[k] = std::sqrt(xr * xr + xi * xi) * scale;
+    }
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Forward FFT of a real, power-of-two length frame. The n real samples are packed as n/2
+ * complex values (even -> re, odd -> im), transformed with an iterative radix-2 FFT of half
+ * the length, and split back into the n/2 + 1 non-redundant bins.
+ *
+ * Bit-reverse order, butterfly twiddles and split twiddles are built once per size by
+ * prepare() and the work arrays are owned here, so transforming at a fixed size never
+ * allocates. Not thread-safe; one instance per analyzer.
+ */
+class RealFFT
+{
+public:
+    /** No-op when n matches the prepared size; n must be a power of two >= 4. */
+    void prepare(int n);
+    int  size() const { return n; }
+
+    /** Bins 0..n/2 of input (n samples) into out_re / out_im, each n/2 + 1 long. */
+    void forward(const float* input, float* out_re, float* out_im);
+
+    /** |X[k]| * scale for k in [0, n/2) into out (n/2 long), without materialising the spectrum. */
+    void magnitudes(const float* input, float scale, float* out);
+
+private:
+    void transformPacked(const float* input);
+
+    int                     n = 0;
+    int                     half = 0;
+    std::vector<uint32_t>   bit_reverse;
+    /** exp(-2*pi*i*j / half) for j in [0, half/2): butterfly twiddles of the half-length FFT. */
+    std::vector<float>      twiddle_re;
+    std::vector<float>      twiddle_im;
+    /** exp(-2*pi*i*k / n) for k in [0, half): recombines the even/odd half spectra. */
+    std::vector<float>      split_re;
+    std::vector<float>      split_im;
+    std::vector<float>      work_re;
+    std::vector<float>      work_im;
+};
+
+#endif // REALFFT_H
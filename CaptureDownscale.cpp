@@ -0,0 +1,375 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "CaptureDownscale.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CAPTURE_DOWNSCALE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+/*---------------------------------------------------------*\
+| AVX2 is compiled per function and picked at runtime, so   |
+| the plugin keeps its baseline ISA.                        |
+\*---------------------------------------------------------*/
+#if defined(CAPTURE_DOWNSCALE_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+    #define CAPTURE_DOWNSCALE_AVX2 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define CAPTURE_TARGET_AVX2
+    #else
+        #define CAPTURE_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace
+{
+
+/** Largest footprint whose 8-bit channel sums stay within int32 (the SSE2 path converts them signed). */
+constexpr long long kMaxFootprintPixels = 0x7FFFFFFFll / 255ll;
+
+void BuildSpans(int src_size, int dst_size, std::vector<int>& begin, std::vector<int>& end)
+{
+    begin.resize((size_t)dst_size);
+    end.resize((size_t)dst_size);
+    for(int i = 0; i < dst_size; i++)
+    {
+        int b = (int)(((long long)i * src_size) / dst_size);
+        int e = (int)(((long long)(i + 1) * src_size) / dst_size);
+        b = std::min(b, src_size - 1);
+        e = std::max(e, b + 1);
+        begin[(size_t)i] = b;
+        end[(size_t)i] = e;
+    }
+}
+
+#ifdef CAPTURE_DOWNSCALE_SSE2
+
+/** Adds source pixels [p, end) to acc; four pixels per step in 16-bit lanes, widened before they can overflow. */
+inline __m128i AccumulateSpanSse2(const uint8_t* p, const uint8_t* end, __m128i acc)
+{
+    const __m128i zero = _mm_setzero_si128();
+    while(end - p >= 16)
+    {
+        __m128i acc16 = zero;
+        // 2 pixels per lane per step: 128 steps stay below 65535.
+        int steps = 0;
+        while(end - p >= 16 && steps < 128)
+        {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            acc16 = _mm_add_epi16(acc16, _mm_unpacklo_epi8(px, zero));
+            acc16 = _mm_add_epi16(acc16, _mm_unpackhi_epi8(px, zero));
+            p += 16;
+            steps++;
+        }
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(acc16, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(acc16, zero));
+    }
+    while(p < end)
+    {
+        int raw;
+        std::memcpy(&raw, p, 4);
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(raw), zero), zero));
+        p += 4;
+    }
+    return acc;
+}
+
+void AccumulateRowSse2(const uint8_t* line, const int* col_begin, const int* col_end, int dst_width, uint32_t* sums)
+{
+    for(int c = 0; c < dst_width; c++)
+    {
+        __m128i* sum = reinterpret_cast<__m128i*>(sums + (size_t)c * 4u);
+        const __m128i acc = AccumulateSpanSse2(line + (size_t)col_begin[c] * 4u,
+                                               line + (size_t)col_end[c] * 4u,
+                                               _mm_loadu_si128(sum));
+        _mm_storeu_si128(sum, acc);
+    }
+}
+
+#ifdef CAPTURE_DOWNSCALE_AVX2
+
+/** Eight pixels per step; the sub-32-byte tail goes through the SSE2 span. */
+CAPTURE_TARGET_AVX2
+void AccumulateRowAvx2(const uint8_t* line, const int* col_begin, const int* col_end, int dst_width, uint32_t* sums)
+{
+    const __m256i zero256 = _mm256_setzero_si256();
+    const __m128i zero = _mm_setzero_si128();
+    for(int c = 0; c < dst_width; c++)
+    {
+        const uint8_t* p = line + (size_t)col_begin[c] * 4u;
+        const uint8_t* end = line + (size_t)col_end[c] * 4u;
+        __m128i* sum = reinterpret_cast<__m128i*>(sums + (size_t)c * 4u);
+        __m128i acc = _mm_loadu_si128(sum);
+
+        while(end - p >= 32)
+        {
+            __m256i acc16 = zero256;
+            int steps = 0;
+            while(end - p >= 32 && steps < 128)
+            {
+                const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                acc16 = _mm256_add_epi16(acc16, _mm256_unpacklo_epi8(px, zero256));
+                acc16 = _mm256_add_epi16(acc16, _mm256_unpackhi_epi8(px, zero256));
+                p += 32;
+                steps++;
+            }
+            const __m128i lo = _mm256_castsi256_si128(acc16);
+            const __m128i hi = _mm256_extracti128_si256(acc16, 1);
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(lo, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(lo, zero));
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(hi, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(hi, zero));
+        }
+
+        _mm_storeu_si128(sum, AccumulateSpanSse2(p, end, acc));
+    }
+}
+
+bool CpuSupportsAvx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if(regs[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(regs, 1);
+    const bool osxsave_avx = (regs[2] & (1 << 27)) && (regs[2] & (1 << 28));
+    if(!osxsave_avx || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+void ResolveRowSse2(const uint32_t* sums, const int* col_begin, const int* col_end, int dst_width,
+                    int row_span, bool swap_rb, uint8_t* out)
+{
+    const uint32_t alpha = 0xFF000000u;
+    for(int c = 0; c < dst_width; c++)
+    {
+        const float inv_area = 1.0f / (float)((col_end[c] - col_begin[c]) * row_span);
+        __m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + (size_t)c * 4u));
+        if(swap_rb)
+        {
+            sum = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        __m128i mean = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(inv_area)));
+        mean = _mm_packs_epi32(mean, mean);
+        mean = _mm_packus_epi16(mean, mean);
+        const uint32_t rgba = (uint32_t)_mm_cvtsi128_si32(mean) | alpha;
+        std::memcpy(out + (size_t)c * 4u, &rgba, 4);
+    }
+}
+
+#else
+
+void AccumulateRowScalar(const uint8_t* line, const int* col_begin, const int* col_end, int dst_width, uint32_t* sums)
+{
+    for(int c = 0; c < dst_width; c++)
+    {
+        uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        const uint8_t* p = line + (size_t)col_begin[c] * 4u;
+        const uint8_t* end = line + (size_t)col_end[c] * 4u;
+        for(; p < end; p += 4)
+        {
+            s0 += p[0];
+            s1 += p[1];
+            s2 += p[2];
+            s3 += p[3];
+        }
+        uint32_t* dst = sums + (size_t)c * 4u;
+        dst[0] += s0;
+        dst[1] += s1;
+        dst[2] += s2;
+        dst[3] += s3;
+    }
+}
+
+void ResolveRowScalar(const uint32_t* sums, const int* col_begin, const int* col_end, int dst_width,
+                      int row_span, bool swap_rb, uint8_t* out)
+{
+    for(int c = 0; c < dst_width; c++)
+    {
+        const float inv_area = 1.0f / (float)((col_end[c] - col_begin[c]) * row_span);
+        const uint32_t* s = sums + (size_t)c * 4u;
+        const uint8_t ch0 = (uint8_t)std::min(255.0f, (float)s[0] * inv_area + 0.5f);
+        const uint8_t ch1 = (uint8_t)std::min(255.0f, (float)s[1] * inv_area + 0.5f);
+        const uint8_t ch2 = (uint8_t)std::min(255.0f, (float)s[2] * inv_area + 0.5f);
+        uint8_t* o = out + (size_t)c * 4u;
+        o[0] = swap_rb ? ch2 : ch0;
+        o[1] = ch1;
+        o[2] = swap_rb ? ch0 : ch2;
+        o[3] = 255;
+    }
+}
+
+#endif
+
+using AccumulateRowFn = void (*)(const uint8_t*, const int*, const int*, int, uint32_t*);
+
+struct AccumulateKernel
+{
+    AccumulateRowFn fn;
+    const char*     name;
+};
+
+AccumulateKernel SelectAccumulateKernel()
+{
+#if defined(CAPTURE_DOWNSCALE_AVX2)
+    if(CpuSupportsAvx2())
+    {
+        return {AccumulateRowAvx2, "avx2"};
+    }
+#endif
+#if defined(CAPTURE_DOWNSCALE_SSE2)
+    return {AccumulateRowSse2, "sse2"};
+#else
+    return {AccumulateRowScalar, "scalar"};
+#endif
+}
+
+const AccumulateKernel& GetAccumulateKernel()
+{
+    static const AccumulateKernel kernel = SelectAccumulateKernel();
+    return kernel;
+}
+
+} // namespace
+
+const char* GetCaptureDownscaleKernelName()
+{
+    return GetAccumulateKernel().name;
+}
+
+void AreaDownscalePlan::Prepare(int src_width, int src_height, int dst_width, int dst_height)
+{
+    if(src_width == src_width_ && src_height == src_height_ &&
+       dst_width == dst_width_ && dst_height == dst_height_)
+    {
+        return;
+    }
+
+    src_width_ = src_width;
+    src_height_ = src_height;
+    dst_width_ = dst_width;
+    dst_height_ = dst_height;
+    if(src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0)
+    {
+        col_begin_.clear();
+        col_end_.clear();
+        row_begin_.clear();
+        row_end_.clear();
+        row_sums_.clear();
+        return;
+    }
+
+    BuildSpans(src_width, dst_width, col_begin_, col_end_);
+    BuildSpans(src_height, dst_height, row_begin_, row_end_);
+
+    // Only reachable for absurd ratios (e.g. 8K to a handful of pixels): drop trailing rows of the footprint.
+    int widest_col = 0;
+    for(int c = 0; c < dst_width; c++)
+    {
+        widest_col = std::max(widest_col, col_end_[(size_t)c] - col_begin_[(size_t)c]);
+    }
+    const int max_rows = (int)std::max(1ll, kMaxFootprintPixels / (long long)widest_col);
+    for(int r = 0; r < dst_height; r++)
+    {
+        row_end_[(size_t)r] = std::min(row_end_[(size_t)r], row_begin_[(size_t)r] + max_rows);
+    }
+
+    row_sums_.assign((size_t)dst_width * 4u, 0u);
+}
+
+void AreaDownscalePlan::Run(const CaptureImageView& src, int dst_width, int dst_height, uint8_t* dst)
+{
+    if(!src.IsValid() || !dst || dst_width <= 0 || dst_height <= 0)
+    {
+        return;
+    }
+    Prepare(src.width, src.height, dst_width, dst_height);
+
+    const bool swap_rb = (src.format == CapturePixelFormat::BGRA8888);
+    const AccumulateRowFn accumulate_row = GetAccumulateKernel().fn;
+    const int* col_begin = col_begin_.data();
+    const int* col_end = col_end_.data();
+    uint32_t* sums = row_sums_.data();
+    const size_t dst_row_bytes = (size_t)dst_width * 4u;
+
+    for(int r = 0; r < dst_height; r++)
+    {
+        const int y0 = row_begin_[(size_t)r];
+        const int y1 = row_end_[(size_t)r];
+        std::fill(row_sums_.begin(), row_sums_.end(), 0u);
+        for(int y = y0; y < y1; y++)
+        {
+            const uint8_t* line = src.pixels + (std::ptrdiff_t)y * (std::ptrdiff_t)src.stride_bytes;
+            accumulate_row(line, col_begin, col_end, dst_width, sums);
+        }
+#ifdef CAPTURE_DOWNSCALE_SSE2
+        ResolveRowSse2(sums, col_begin, col_end, dst_width, y1 - y0, swap_rb, dst + (size_t)r * dst_row_bytes);
+#else
+        ResolveRowScalar(sums, col_begin, col_end, dst_width, y1 - y0, swap_rb, dst + (size_t)r * dst_row_bytes);
+#endif
+    }
+}
+
+void CaptureMipChainBuilder::Build(const uint8_t* base, int width, int height,
+                                   std::vector<uint8_t>& storage, std::vector<CaptureMipLevel>& levels)
+{
+    levels.clear();
+    if(!base || width <= 0 || height <= 0)
+    {
+        storage.clear();
+        return;
+    }
+
+    size_t total_bytes = 0;
+    int level_w = width;
+    int level_h = height;
+    while(level_w > 1 || level_h > 1)
+    {
+        level_w = std::max(1, level_w / 2);
+        level_h = std::max(1, level_h / 2);
+        CaptureMipLevel level;
+        level.width = level_w;
+        level.height = level_h;
+        level.offset = total_bytes;
+        levels.push_back(level);
+        total_bytes += (size_t)level_w * (size_t)level_h * 4u;
+    }
+    storage.resize(total_bytes);
+    if(plans_.size() < levels.size())
+    {
+        plans_.resize(levels.size());
+    }
+
+    CaptureImageView src;
+    src.pixels = base;
+    src.width = width;
+    src.height = height;
+    src.stride_bytes = width * 4;
+    src.format = CapturePixelFormat::RGBA8888;
+    for(size_t i = 0; i < levels.size(); i++)
+    {
+        uint8_t* dst = storage.data() + levels[i].offset;
+        plans_[i].Run(src, levels[i].width, levels[i].height, dst);
+        src.pixels = dst;
+        src.width = levels[i].width;
+        src.height = levels[i].height;
+        src.stride_bytes = levels[i].width * 4;
+    }
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef CAPTUREDOWNSCALE_H
+#define CAPTUREDOWNSCALE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Byte order of a 32-bit source pixel in memory. BGRA covers X11 ZPixmap, QImage::Format_RGB32/ARGB32 and DXGI B8G8R8A8. */
+enum class CapturePixelFormat
+{
+    RGBA8888,
+    BGRA8888
+};
+
+/** Borrowed view of a 32-bit captured image; the backend owns the pixels until its next Grab(). A negative stride walks a bottom-up image from its last row. */
+struct CaptureImageView
+{
+    const uint8_t*      pixels = nullptr;
+    int                 width = 0;
+    int                 height = 0;
+    int                 stride_bytes = 0;
+    CapturePixelFormat  format = CapturePixelFormat::BGRA8888;
+
+    bool IsValid() const
+    {
+        return pixels && width > 0 && height > 0 && (stride_bytes >= width * 4 || -stride_bytes >= width * 4);
+    }
+};
+
+/**
+ * Fused area-average downscale + swizzle to tightly packed RGBA8888 (alpha forced to 255).
+ * Each destination pixel is the mean of the source pixels its footprint covers; spans are
+ * integer so no source pixel is weighted twice. Upscaling degrades to nearest neighbour.
+ *
+ * Span tables and the row accumulator are computed once per (source, destination) size and
+ * reused, so steady-state frames do not allocate. One plan per capture thread.
+ */
+class AreaDownscalePlan
+{
+public:
+    /** No-op when the sizes match the last call. */
+    void Prepare(int src_width, int src_height, int dst_width, int dst_height);
+
+    /** dst must hold dst_width * dst_height * 4 bytes; the plan is prepared from src on demand. */
+    void Run(const CaptureImageView& src, int dst_width, int dst_height, uint8_t* dst);
+
+private:
+    int src_width_ = 0;
+    int src_height_ = 0;
+    int dst_width_ = 0;
+    int dst_height_ = 0;
+    /** [x0, x1) source columns / [y0, y1) source rows per destination column / row. */
+    std::vector<int> col_begin_;
+    std::vector<int> col_end_;
+    std::vector<int> row_begin_;
+    std::vector<int> row_end_;
+    /** Per-channel sums of the current destination row (dst_width * 4). */
+    std::vector<uint32_t> row_sums_;
+};
+
+/** One reduced level of a capture pyramid, packed RGBA at offset bytes into the pyramid storage. */
+struct CaptureMipLevel
+{
+    int     width = 0;
+    int     height = 0;
+    size_t  offset = 0;
+};
+
+/**
+ * Builds the box-filtered pyramid below a packed RGBA image: each level halves the previous
+ * one (rounding down, at least 1x1) through AreaDownscalePlan, down to a single pixel. Keeps
+ * one plan per level, and the caller's vectors keep their capacity, so rebuilding at the same
+ * size does not allocate.
+ */
+class CaptureMipChainBuilder
+{
+public:
+    void Build(const uint8_t* base, int width, int height,
+               std::vector<uint8_t>& storage, std::vector<CaptureMipLevel>& levels);
+
+private:
+    std::vector<AreaDownscalePlan> plans_;
+};
+
+/** "avx2", "sse2" or "scalar": the row accumulator AreaDownscalePlan dispatched to on this CPU. */
+const char* GetCaptureDownscaleKernelName();
+
+#endif // CAPTUREDOWNSCALE_H
@@ -6,6 +6,7 @@
 #include "SpatialLightingSceneProvider.h"
 #include "VirtualController3D.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <vector>
 
@@ -19,6 +20,8 @@ constexpr unsigned int MATRIX_MAP_NA = 0xFFFFFFFFu;
 constexpr unsigned int DEVICE_VIEW_MAX_COLS = 20;
 constexpr float ZONE_STACK_PAD = 1.0f;
 
+std::atomic<std::uint64_t> g_layout_epoch{0};
+
 static LEDPosition3D MakeLedPosition(RGBControllerInterface* controller, unsigned int zone_idx, unsigned int led_idx, float x, float y, float z)
 {
     LEDPosition3D led_pos;
@@ -842,5 +845,11 @@ void ControllerLayout3D::MarkWorldPositionsDirty(ControllerTransform* ctrl_trans
     }
 
     ctrl_transform->world_positions_dirty = true;
+    ++g_layout_epoch;
     SpatialLightingSceneProvider::instance()->InvalidateFrameOccluders();
 }
+
+std::uint64_t ControllerLayout3D::LayoutEpoch()
+{
+    return g_layout_epoch.load();
+}
@@ -3,6 +3,7 @@
 #ifndef CONTROLLERLAYOUT3D_H
 #define CONTROLLERLAYOUT3D_H
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include "RGBController.h"
@@ -21,6 +22,8 @@ public:
     static Vector3D GetLedLocalCenter(const ControllerTransform* ctrl_transform);
     static void UpdateWorldPositions(ControllerTransform* ctrl_transform);
     static void MarkWorldPositionsDirty(ControllerTransform* ctrl_transform);
+    /** Bumped by MarkWorldPositionsDirty; LedFrameLayoutCache3D recompiles when it moves. */
+    static std::uint64_t LayoutEpoch();
     static void CalculateControllerLocalBounds(const ControllerTransform* ctrl_transform,
                                                Vector3D& min_bounds,
                                                Vector3D& max_bounds);
@@ -46,6 +46,11 @@ struct EffectInstance3D
     bool enabled;
     int id;
     std::unique_ptr<nlohmann::json> saved_settings;
+    /**
+     * Settings published for `effect` while the render worker owns it; the worker loads them
+     * before its next frame. Null while stopped (edits are loaded directly).
+     */
+    std::shared_ptr<const nlohmann::json> render_settings;
 
     EffectInstance3D()
         : name("New Effect")
@@ -56,6 +61,7 @@ struct EffectInstance3D
         , enabled(true)
         , id(0)
         , saved_settings(nullptr)
+        , render_settings(nullptr)
     {
     }
 
@@ -24,6 +24,7 @@ public:
     EffectInfo3D GetEffectInfo() const override;
     void SetupCustomUI(QWidget* parent) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
     bool RequiresWorldSpaceCoordinates() const override { return false; }
 
     nlohmann::json SaveSettings() const override;
@@ -2,6 +2,7 @@
 
 #include "BouncingBall.h"
 #include "BouncingBallVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
 #include "EffectHelpers.h"
@@ -124,6 +125,7 @@ BouncingBall::BouncingBall(QWidget* parent) : SpatialEffect3D(parent)
     SetRainbowMode(true);
     volume_assist_.setFragmentBody(QString::fromUtf8(BouncingBallVolumeFieldGlsl()));
     volume_assist_.setResolution(16);
+    volume_assist_.setCpuField(&BouncingBall::BuildCpuRows);
 }
 
 BouncingBall::~BouncingBall() = default;
@@ -225,6 +227,98 @@ void BouncingBall::PrepareGpuFields(std::uint64_t render_sequence, float time_se
     volume_assist_.prepare(render_sequence, time_sec, vp, 10);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn BouncingBall::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float sim_t = u[0];
+    const int count = (int)(std::clamp(u[1], 1.0f, 32.0f) + 0.5f);
+    const float radius = std::max(u[2], 0.02f);
+    const float glow_mul = std::max(u[3], 1.0f);
+    const float motion = std::clamp(u[4], 0.02f, 1.0f);
+    const float hue_scroll = Fract(u[5]);
+    const float detail = std::clamp(u[6], 0.05f, 1.0f);
+    const Vec3 origin01 = Clamp01(Vec3(u[7], u[8], u[9]));
+
+    const float lo = radius;
+    const float hi = 1.0f - radius;
+    const float g = (0.35f + 0.55f * motion) * 1.8f;
+    const float v_hop_base = std::sqrt(std::max(2.0f * g * 0.35f, 1e-4f));
+    const float horiz = (0.12f + 0.45f * motion) * 0.55f;
+    const float core_r = std::max(radius * 0.8f, 1e-4f);
+    const float glow_r = std::max(radius * 2.0f * glow_mul, 1e-4f);
+
+    auto hash01 = [](float n) { return Fract(std::sin(n) * 43758.5453f); };
+    // Elastic bounce between [lo, hi] at constant |speed| (bounce1D in the shader).
+    auto bounce = [lo, hi](float x0, float v, float t) {
+        const float len = std::max(hi - lo, 1e-4f);
+        float m = Mod((x0 - lo) + v * t, 2.0f * len);
+        if(m < 0.0f)
+        {
+            m += 2.0f * len;
+        }
+        return (m <= len) ? (lo + m) : (hi - (m - len));
+    };
+
+    // Ball paths are closed-form in time: place every ball once per bake.
+    struct Ball
+    {
+        Vec3 c;
+        float hue01;
+    };
+    std::vector<Ball> balls;
+    balls.reserve((size_t)count);
+    for(int k = 0; k < count; k++)
+    {
+        const float fk = (float)k;
+        const float x0 = Mix(lo, hi, hash01(fk * 131.0f + 1.7f));
+        const float z0 = Mix(lo, hi, hash01(fk * 919.0f + 2.3f));
+        const float vx = (hash01(fk * 733.0f) * 2.0f - 1.0f) * horiz;
+        const float vz = (hash01(fk * 829.0f) * 2.0f - 1.0f) * horiz;
+        const float drop = 0.35f + 0.55f * hash01(fk * 419.0f + 11.0f);
+        const float v0 = v_hop_base * std::sqrt(drop) * 1.05f;
+        const float phase = hash01(fk * 577.0f) * TWO_PI;
+
+        const float t = sim_t + hash01(fk * 47.0f) * 3.0f;
+        const float hop_period = std::max(2.0f * v0 / std::max(g, 1e-4f), 1e-3f);
+        const float tm = Mod(t + phase, hop_period);
+        const float py = std::clamp(lo + v0 * tm - 0.5f * g * tm * tm, lo, hi);
+        // Soft bias toward the effect origin so ref points matter.
+        const Vec3 c = Mix(Vec3(bounce(x0, vx, t), py, bounce(z0, vz, t)), origin01, 0.08f);
+        const float hue_spatial = (c.x * 0.39f + c.y * 0.56f + c.z * 0.33f) * (0.55f + 0.45f * detail);
+        balls.push_back({c, Fract(hue_scroll + fk * 0.1056f + hue_spatial)});
+    }
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 p01(row.x01[x], row.y01, row.z01);
+            float intensity = 0.0f;
+            float hue01 = hue_scroll;
+            for(const Ball& b : balls)
+            {
+                const float d = Length(p01 - b.c);
+                if(d > glow_r)
+                {
+                    continue;
+                }
+                const float core = std::max(0.0f, 1.0f - d / core_r);
+                const float outer = 0.7f * std::max(0.0f, 1.0f - d / glow_r);
+                const float v = Clamp01((std::pow(core, 0.9f) + outer) * 1.6f);
+                if(v > intensity)
+                {
+                    intensity = v;
+                    hue01 = b.hue01;
+                }
+            }
+            rgb[x * 3 + 0] = intensity;
+            rgb[x * 3 + 1] = hue01;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
 RGBColor BouncingBall::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     if(EffectGridSampleOutsideVolume(x, y, z, grid))
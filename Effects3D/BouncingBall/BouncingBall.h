@@ -48,6 +48,8 @@ private:
 
     float ball_physics_sim_t = 0.f;
     float ball_last_integrated_wall_time = -1e9f;
+    /** CPU port of BouncingBallVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
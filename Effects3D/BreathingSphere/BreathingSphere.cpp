@@ -2,6 +2,7 @@
 
 #include "BreathingSphere.h"
 #include "BreathingSphereVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
 
@@ -58,6 +59,7 @@ BreathingSphere::BreathingSphere(QWidget* parent) : SpatialEffect3D(parent)
     SetColors(default_colors);
     volume_assist_.setFragmentBody(QString::fromUtf8(BreathingSphereVolumeFieldGlsl()));
     volume_assist_.setResolution(28);
+    volume_assist_.setCpuField(&BreathingSphere::BuildCpuRows);
 }
 
 BreathingSphere::~BreathingSphere() = default;
@@ -246,34 +248,192 @@ void BreathingSphere::PrepareGpuFields(std::uint64_t render_sequence, float time
     volume_assist_.prepare(render_sequence, time_sec, vp, 16);
 }
 
-RGBColor BreathingSphere::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+SpatialVolumeFieldEngine::CpuRowFn BreathingSphere::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
 {
-    Vector3D origin = GetEffectOriginGrid(grid);
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float R = std::max(u[0], 0.02f);
+    const float breath_phase = u[1];
+    const float progress = u[2];
+    const float detail = std::max(u[3], 0.05f);
+    const int edge = (int)(Clamp01(u[4]) + 0.5f);
+    const float hole_frac = std::clamp(u[5], 0.0f, 0.95f);
+    const Vec3 origin01 = Clamp01(Vec3(u[6], u[7], u[8]));
+    const int shape = (int)(std::clamp(u[9], 0.0f, 5.0f) + 0.5f);
+    const float ax = std::clamp(u[10], 0.15f, 1.0f);
+    const float az = std::clamp(u[11], 0.15f, 1.0f);
+    const float pulse_strength = Clamp01(u[12]);
+    const Vec3 s(std::max(u[13], 0.25f), std::max(u[14], 0.25f), std::max(u[15], 0.25f));
+    const float pi = (float)M_PI;
+
+    auto smstep = [](float e0, float e1, float v) {
+        const float t = Clamp01((v - e0) / std::max(e1 - e0, 1e-5f));
+        return t * t * (3.0f - 2.0f * t);
+    };
+    // shapeMetric from BreathingSphereVolumeFieldGlsl: iso-value R on the chosen solid.
+    auto shape_metric = [=](Vec3 l) {
+        if(shape == 1)
+        {
+            return std::max(std::max(std::fabs(l.x), std::fabs(l.y)), std::fabs(l.z));
+        }
+        if(shape == 2)
+        {
+            return std::max(std::max(std::fabs(l.x) / ax, std::fabs(l.y)), std::fabs(l.z) / az);
+        }
+        if(shape == 3 || shape == 4)
+        {
+            const float n = (shape == 3) ? 3.0f : 5.0f;
+            const float an = TWO_PI / n;
+            const float a = std::atan2(l.z, l.x);
+            const float poly = std::cos(std::floor(0.5f + a / an) * an - a) * std::hypot(l.x, l.z) / std::cos(pi / n);
+            return std::max(poly, std::fabs(l.y));
+        }
+        return Length(l);
+    };
+
+    // Whole-room wave (shape 5): time terms are shared by every voxel.
+    const float inhale = std::sin(breath_phase) * pulse_strength;
+    const float exhale = std::sin(breath_phase + 1.2f) * pulse_strength;
+    const float air = pulse_strength < 0.001f
+                          ? 0.85f
+                          : 0.78f + 0.22f * (0.5f + 0.5f * std::sin(breath_phase * 1.05f)) * (0.55f + 0.45f * pulse_strength);
+
+    float band = (edge == 1) ? 0.018f : 0.16f;
+    band = std::max(band * (0.7f + 0.3f / std::max(detail, 0.2f)), (edge == 1) ? 0.012f : 0.02f);
+    const float r_in = hole_frac * R * 0.9f;
+    const float iw = (edge == 1) ? band * 0.4f : band * 1.1f;
+    const float ow = (edge == 1) ? band * 0.5f : band * 1.6f;
+    const float span_eff = std::max(R - r_in, R * 0.08f);
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 l = (Vec3(row.x01[x], row.y01, row.z01) - origin01) * s;
+            float* out = rgb + x * 3;
+            if(shape == 5)
+            {
+                const float dist_norm = std::clamp(Length(l) * 0.5f, 0.0f, 1.5f);
+                const float wave = std::sin(inhale * pi * 1.15f - dist_norm * (9.0f + 5.0f * detail)) * pulse_strength;
+                const float ripple =
+                    std::sin(breath_phase * 2.1f - dist_norm * TWO_PI * 2.2f + l.y * 0.02f * detail) * pulse_strength;
+                const float rush = std::sin(exhale * 1.7f + (l.x + l.z) * 0.015f * detail) * 0.4f * pulse_strength;
+                out[0] = Clamp01(air);
+                out[1] = Fract(0.38f + 0.32f * inhale + 0.24f * wave + 0.12f * ripple + rush * 0.1f + progress * 0.04f);
+                out[2] = 0.0f;
+                continue;
+            }
+
+            const float distance = shape_metric(l);
+            float intensity = 0.0f;
+            float norm_in_shell = 0.0f;
+            if(hole_frac <= 0.001f)
+            {
+                // Filled shape: hard inside, zero outside the shape metric.
+                if(edge == 1)
+                {
+                    float inside = 1.0f - smstep(R - band * 0.12f, R + band * 0.55f, distance);
+                    const float surface = 1.0f - smstep(0.0f, band * 0.55f, std::fabs(distance - R));
+                    inside = std::max(inside, surface * 0.4f * Step(distance, R + band));
+                    if(distance > R + band)
+                    {
+                        inside = 0.0f;
+                    }
+                    intensity = Clamp01(inside);
+                }
+                else
+                {
+                    const float inside = 1.0f - smstep(R - band * 0.35f, R + band, distance);
+                    const float soft_out = 1.0f - smstep(R, R + band * 2.2f, distance);
+                    intensity = Clamp01(std::max(inside, soft_out * 0.35f));
+                }
+                norm_in_shell = std::clamp(distance / (R + 1e-5f), 0.0f, 1.2f);
+            }
+            else
+            {
+                const float inner_open = smstep(r_in - iw, r_in + iw, distance);
+                float outer_open = 1.0f - smstep(R - ow * 0.2f, R + ow, distance);
+                float bell = std::sin(Clamp01((distance - r_in) / span_eff) * pi);
+                if(edge == 1)
+                {
+                    const float b2 = bell * bell;
+                    bell = b2 * b2;
+                    if(distance > R + ow)
+                    {
+                        outer_open = 0.0f;
+                    }
+                }
+                intensity = Clamp01(inner_open * outer_open * (0.15f + 0.85f * bell));
+                norm_in_shell = std::clamp((distance - r_in) / std::max(R - r_in, 1e-4f), 0.0f, 1.2f);
+            }
+            out[0] = intensity;
+            out[1] = Clamp01(norm_in_shell);
+            out[2] = 0.0f;
+        }
+    };
+}
+
+/** Everything CalculateColorGrid derives from settings / grid / time, resolved once per batch. */
+struct BreathingSphere::SampleFrame
+{
+    Vector3D origin{};
+    float boundary_radius_sq = 0.0f;
+    float rate = 0.0f;
+    float detail = 0.0f;
+    int shape = SHAPE_SPHERE;
+    bool volume_available = false;
+    bool strip_colormap = false;
+    bool rainbow = false;
+    SpatialLayerCore::MapperSettings strat_st;
+};
+
+BreathingSphere::SampleFrame BreathingSphere::MakeSampleFrame(const GridContext3D& grid) const
+{
+    SampleFrame f;
+    f.origin = GetEffectOriginGrid(grid);
+    f.boundary_radius_sq = EffectBoundaryRadiusSq(grid);
+    f.rate = GetScaledFrequency();
+    f.detail = std::max(0.05f, GetScaledDetail());
+    f.shape = std::max(0, std::min(breathing_shape, SHAPE_COUNT - 1));
+    f.volume_available = volume_assist_.isAvailable();
+    f.strip_colormap = UseEffectStripColormap();
+    f.rainbow = GetRainbowMode();
+    EffectStratumBlend::InitStratumBreaks(f.strat_st);
+    return f;
+}
+
+void BreathingSphere::ShadeSample(const SampleFrame& f,
+                                  float x,
+                                  float y,
+                                  float z,
+                                  float time,
+                                  const GridContext3D& grid,
+                                  PaletteSample& s) const
+{
+    const Vector3D& origin = f.origin;
     float raw_rx = x - origin.x;
     float raw_ry = y - origin.y;
     float raw_rz = z - origin.z;
 
-    if(!IsWithinEffectBoundary(raw_rx, raw_ry, raw_rz, grid))
-        return 0x00000000;
+    if(raw_rx * raw_rx + raw_ry * raw_ry + raw_rz * raw_rz > f.boundary_radius_sq)
+        return;
 
     Vector3D rot{x, y, z};
     float coord2 = NormalizeGridAxis01(rot.y, grid.min_y, grid.max_y);
-    SpatialLayerCore::MapperSettings strat_st;
-    EffectStratumBlend::InitStratumBreaks(strat_st);
     float sw[3];
-    EffectStratumBlend::WeightsForYNorm(coord2, strat_st, sw);
+    EffectStratumBlend::WeightsForYNorm(coord2, f.strat_st, sw);
     const EffectStratumBlend::BandBlendScalars bb =
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), sw, GetStratumTuning());
     const float stratum_mot01 =
         ComputeStratumMotion01(sw, grid, x, y, z, origin, time);
 
-    float rate = GetScaledFrequency();
-    float detail = std::max(0.05f, GetScaledDetail());
-    progress = CalculateProgress(time * bb.speed_mul);
-    const float cmap_phase01 = std::fmod(progress + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
+    const float rate = f.rate;
+    const float detail = f.detail;
+    const float sample_progress = CalculateProgress(time * bb.speed_mul);
     float strip_p01 = 0.0f;
-    if(UseEffectStripColormap())
+    if(f.strip_colormap)
     {
+        const float cmap_phase01 = std::fmod(sample_progress + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
         strip_p01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
                                                GetEffectStripColormapRepeats(),
                                                GetEffectStripColormapUnfold(),
@@ -285,69 +445,93 @@ RGBColor BreathingSphere::CalculateColorGrid(float x, float y, float z, float ti
                                                origin,
                                                rot);
     }
-    int shape = std::max(0, std::min(breathing_shape, SHAPE_COUNT - 1));
-    float breath_phase = progress * rate * 0.2f;
+    float breath_phase = sample_progress * rate * 0.2f;
 
     float c1 = NormalizeGridAxis01(rot.x, grid.min_x, grid.max_x);
     float c2 = coord2;
     float c3 = NormalizeGridAxis01(rot.z, grid.min_z, grid.max_z);
 
-    if(shape == SHAPE_WHOLE_ROOM)
+    if(f.shape == SHAPE_WHOLE_ROOM)
     {
-        if(volume_assist_.isAvailable())
+        if(f.volume_available)
         {
             const QVector3D samp = volume_assist_.sample01(c1, c2, c3);
-            float air = samp.x();
             float pos = samp.y();
-            RGBColor c;
-            if(UseEffectStripColormap())
-                c = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), strip_p01, time);
-            else if(GetRainbowMode())
+            s.gain = samp.x();
+            if(f.strip_colormap)
+                s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), strip_p01, time);
+            else if(f.rainbow)
             {
-                float hue = pos * 360.0f + time * rate * 12.0f * bb.speed_mul
-                            + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) * 360.0f;
-                c = GetRainbowColor(hue);
+                s.lookup = PaletteSample::HUE;
+                s.key = pos * 360.0f + time * rate * 12.0f * bb.speed_mul
+                        + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) * 360.0f;
             }
             else
-                c = GetColorAtPosition(std::fmod(pos + progress * 0.04f + 1.0f, 1.0f));
-            unsigned char r = (unsigned char)fminf(255.0f, fmaxf(0.0f, (c & 0xFF) * air));
-            unsigned char g = (unsigned char)fminf(255.0f, fmaxf(0.0f, ((c >> 8) & 0xFF) * air));
-            unsigned char b = (unsigned char)fminf(255.0f, fmaxf(0.0f, ((c >> 16) & 0xFF) * air));
-            return (RGBColor)((b << 16) | (g << 8) | r);
+            {
+                s.lookup = PaletteSample::PALETTE;
+                s.key = std::fmod(pos + sample_progress * 0.04f + 1.0f, 1.0f);
+            }
         }
-        return 0x00000000;
+        return;
     }
 
     float sphere_intensity = 0.0f;
     float norm_in_shell = 0.0f;
-    if(volume_assist_.isAvailable())
+    if(f.volume_available)
     {
         const QVector3D samp = volume_assist_.sample01(c1, c2, c3);
         sphere_intensity = samp.x();
         norm_in_shell = samp.y();
     }
 
-    RGBColor final_color;
-    if(UseEffectStripColormap())
-        final_color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), strip_p01, time);
-    else if(GetRainbowMode())
+    s.gain = sphere_intensity;
+    if(f.strip_colormap)
+        s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), strip_p01, time);
+    else if(f.rainbow)
     {
-        float hue = norm_in_shell * 290.0f * (0.6f + 0.4f * detail) + breath_phase * 72.0f + time * rate * 12.0f * bb.speed_mul + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) * 360.0f;
-        final_color = GetRainbowColor(hue);
+        s.lookup = PaletteSample::HUE;
+        s.key = norm_in_shell * 290.0f * (0.6f + 0.4f * detail) + breath_phase * 72.0f + time * rate * 12.0f * bb.speed_mul + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) * 360.0f;
     }
     else
     {
         float pos = fmodf(fmin(1.0f, norm_in_shell) * (0.6f + 0.4f * detail) + breath_phase * 0.1f, 1.0f);
         if(pos < 0.0f) pos += 1.0f;
-        final_color = GetColorAtPosition(pos);
+        s.lookup = PaletteSample::PALETTE;
+        s.key = pos;
     }
-    unsigned char r = final_color & 0xFF;
-    unsigned char g = (final_color >> 8) & 0xFF;
-    unsigned char b = (final_color >> 16) & 0xFF;
-    r = (unsigned char)(r * sphere_intensity);
-    g = (unsigned char)(g * sphere_intensity);
-    b = (unsigned char)(b * sphere_intensity);
-    return (b << 16) | (g << 8) | r;
+}
+
+RGBColor BreathingSphere::FinishSample(const PaletteSample& s)
+{
+    const RGBColor c = s.color;
+    unsigned char r = (unsigned char)fminf(255.0f, fmaxf(0.0f, (c & 0xFF) * s.gain));
+    unsigned char g = (unsigned char)fminf(255.0f, fmaxf(0.0f, ((c >> 8) & 0xFF) * s.gain));
+    unsigned char b = (unsigned char)fminf(255.0f, fmaxf(0.0f, ((c >> 16) & 0xFF) * s.gain));
+    return (RGBColor)((b << 16) | (g << 8) | r);
+}
+
+RGBColor BreathingSphere::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+{
+    PaletteSample s;
+    ShadeSample(MakeSampleFrame(grid), x, y, z, time, grid, s);
+    ResolvePaletteSamples(&s, 1);
+    return FinishSample(s);
+}
+
+void BreathingSphere::CalculateColorGridBatch(const float* xs,
+                                              const float* ys,
+                                              const float* zs,
+                                              size_t count,
+                                              float time,
+                                              const GridContext3D& grid,
+                                              RGBColor* out)
+{
+    const SampleFrame f = MakeSampleFrame(grid);
+    ShadePaletteBatch(
+        count,
+        out,
+        [&](size_t i, PaletteSample& s) { ShadeSample(f, xs[i], ys[i], zs[i], time, grid, s); },
+        &BreathingSphere::FinishSample);
 }
 
 nlohmann::json BreathingSphere::SaveSettings() const
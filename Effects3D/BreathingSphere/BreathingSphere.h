@@ -22,12 +22,35 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool SupportsConcurrentEvaluation() const override { return true; }
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
+protected:
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+
 private slots:
 private:
+    struct SampleFrame;
+    SampleFrame MakeSampleFrame(const GridContext3D& grid) const;
+    void ShadeSample(const SampleFrame& f,
+                     float x,
+                     float y,
+                     float z,
+                     float time,
+                     const GridContext3D& grid,
+                     PaletteSample& s) const;
+    /** Applies the sample's air / shell intensity once its palette lookup has resolved. */
+    static RGBColor FinishSample(const PaletteSample& s);
+
     enum Shape {
         SHAPE_SPHERE = 0,
         SHAPE_SQUARE,
@@ -52,6 +75,8 @@ private:
     int breath_pulse_pct = 55;
     int center_hole_pct = 0;
     float progress;
+    /** CPU port of BreathingSphereVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
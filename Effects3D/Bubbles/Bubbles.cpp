@@ -16,6 +16,24 @@ REGISTER_EFFECT_3D(Bubbles);
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace
+{
+
+/** hash01 from BubblesVolumeFieldGlsl, so CPU bakes launch the same bubbles. */
+float ShaderHash01(float seed, float salt)
+{
+    const float v = std::sin(seed * 12.9898f + salt * 78.233f) * 43758.5453f;
+    return v - std::floor(v);
+}
+
+/**
+ * Shell values below half an 8-bit step round to zero in the GL atlas; past this many
+ * thicknesses from the shell 1 / (1 + s^2) is under that, so bins can drop the bubble.
+ */
+constexpr float kShellReachThicknesses = 22.6f;
+
+} // namespace
+
 Bubbles::Bubbles(QWidget* parent) : SpatialEffect3D(parent)
 {
     SetRainbowMode(true);
@@ -23,6 +41,7 @@ Bubbles::Bubbles(QWidget* parent) : SpatialEffect3D(parent)
     volume_assist_.setFragmentBody(QString::fromUtf8(BubblesVolumeFieldGlsl()));
     // Particle loop lives in the shader — keep atlas lean like Starfield.
     volume_assist_.setResolution(16);
+    volume_assist_.setCpuField([this](const SpatialVolumeFieldEngine::CpuBakeContext& ctx) { return BuildCpuRows(ctx); });
 }
 
 EffectInfo3D Bubbles::GetEffectInfo() const
@@ -94,7 +113,7 @@ void Bubbles::SetupCustomUI(QWidget* parent)
              QStringLiteral("How widely bubble centers spread across X/Z."),
              [this](int v) { horizontal_fill = v / 100.0f; }, pct_format);
     bind_int("minSpacingRow", QStringLiteral("Min spacing:"), 10, 100, (int)(overlap_spacing * 100.0f),
-             QStringLiteral("Minimum separation hint (CPU fallback; GPU uses golden-angle spacing)."),
+             QStringLiteral("Minimum separation hint (kept for presets; placement uses golden-angle spacing)."),
              [this](int v) { overlap_spacing = v / 100.0f; }, pct_format);
     bind_int("launchRandomnessRow", QStringLiteral("Launch randomness:"), 0, 100,
              (int)std::lround(launch_randomness * 100.0f),
@@ -140,6 +159,121 @@ void Bubbles::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, co
     volume_assist_.prepare(render_sequence, time_sec, vp, 12);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn Bubbles::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    const float* u = ctx.params;
+    const float time_sec = u[0];
+    const int count = (int)(std::clamp(u[1], 4.0f, 48.0f) + 0.5f);
+    const float thick = std::max(u[2], 0.008f);
+    const float rise_rate = std::max(u[3], 0.01f);
+    const float interval = std::max(u[4], 0.12f);
+    const float max_r = std::max(u[5], 0.04f);
+    const float fill = std::clamp(u[6], 0.5f, 1.8f);
+    const float launch_jitter = std::clamp(u[7], 0.0f, 1.0f);
+    const float hue_scroll = u[8] - std::floor(u[8]);
+    const float ox = std::clamp(u[9], 0.0f, 1.0f);
+    const float oz = std::clamp(u[11], 0.0f, 1.0f);
+    const float golden = 2.39996323f;
+
+    // Launch timing and placement only depend on time: resolve the active set once per frame.
+    BubbleTable& t = bubble_table_;
+    t.Clear();
+    for(int i = 0; i < count; i++)
+    {
+        const float fi = (float)i;
+        const float seed = fi * 265.443f + 101.390f;
+        const float cycle_mul = (1.0f + 0.35f * launch_jitter) + (2.0f * launch_jitter) * ShaderHash01(seed, 11.0f);
+        const float active_frac = (0.52f - 0.26f * launch_jitter) + (0.06f + 0.22f * launch_jitter) * ShaderHash01(seed, 12.0f);
+        const float cycle_i = std::max(0.12f, interval * cycle_mul);
+        const float active_window = std::max(0.04f, cycle_i * active_frac);
+        const float offset_i = cycle_i * ShaderHash01(seed, 13.0f);
+        const float phase_arg = time_sec * rise_rate + offset_i;
+        const float phase_i = phase_arg - cycle_i * std::floor(phase_arg / cycle_i);
+        if(phase_i > active_window)
+            continue;
+
+        const float radius_phase = phase_i / active_window;
+        const float ring = std::sqrt((fi + 0.5f) / (float)count);
+        const float ang = fi * golden;
+        const float hue = fi * 0.111f + hue_scroll;
+        t.cx.push_back(std::clamp(ox + std::cos(ang) * ring * 0.50f * fill, 0.0f, 1.0f));
+        t.cy.push_back(std::clamp(radius_phase, 0.0f, 1.0f));
+        t.cz.push_back(std::clamp(oz + std::sin(ang) * ring * 0.50f * fill, 0.0f, 1.0f));
+        t.radius.push_back((0.18f + 0.82f * radius_phase) * max_r * 0.55f);
+        t.hue01.push_back(hue - std::floor(hue));
+    }
+
+    const float reach = thick * kShellReachThicknesses;
+    const float lo[3] = {0.0f, 0.0f, 0.0f};
+    const float hi[3] = {1.0f, 1.0f, 1.0f};
+    bubble_bins_.Build(
+        lo, hi, kBubbleBinsPerAxis, (int)t.cx.size(),
+        [&t, reach](int i, float* p_lo, float* p_hi) {
+            const float outer = t.radius[(size_t)i] + reach;
+            p_lo[0] = t.cx[(size_t)i] - outer;
+            p_lo[1] = t.cy[(size_t)i] - outer;
+            p_lo[2] = t.cz[(size_t)i] - outer;
+            p_hi[0] = t.cx[(size_t)i] + outer;
+            p_hi[1] = t.cy[(size_t)i] + outer;
+            p_hi[2] = t.cz[(size_t)i] + outer;
+            return true;
+        },
+        [&t, reach](int i, const float* cell_lo, const float* cell_hi) {
+            // Keep the cell if the shell band [r - reach, r + reach] crosses it.
+            const float c[3] = {t.cx[(size_t)i], t.cy[(size_t)i], t.cz[(size_t)i]};
+            float near2 = 0.0f;
+            float far2 = 0.0f;
+            for(int a = 0; a < 3; a++)
+            {
+                const float below = cell_lo[a] - c[a];
+                const float above = c[a] - cell_hi[a];
+                const float gap = std::max(0.0f, std::max(below, above));
+                const float span = std::max(std::fabs(c[a] - cell_lo[a]), std::fabs(cell_hi[a] - c[a]));
+                near2 += gap * gap;
+                far2 += span * span;
+            }
+            const float r = t.radius[(size_t)i];
+            const float inner = std::max(0.0f, r - reach);
+            return near2 <= (r + reach) * (r + reach) && far2 >= inner * inner;
+        });
+
+    const BubbleTable* table = &t;
+    const VolumeParticleBins* bins = &bubble_bins_;
+    const float inv_thick = 1.0f / thick;
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const float px = row.x01[x];
+            float intensity = 0.0f;
+            float hue01 = hue_scroll;
+
+            const std::uint16_t* it = nullptr;
+            const std::uint16_t* end = nullptr;
+            bins->Lookup(px, row.y01, row.z01, &it, &end);
+            for(; it != end; ++it)
+            {
+                const size_t i = *it;
+                const float dx = px - table->cx[i];
+                const float dy = row.y01 - table->cy[i];
+                const float dz = row.z01 - table->cz[i];
+                const float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+                const float shallow = (d - table->radius[i]) * inv_thick;
+                const float value = 1.0f / (1.0f + shallow * shallow);
+                if(value > intensity)
+                {
+                    intensity = value;
+                    hue01 = table->hue01[i];
+                }
+            }
+
+            rgb[x * 3 + 0] = intensity;
+            rgb[x * 3 + 1] = hue01;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
 RGBColor Bubbles::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
@@ -7,13 +7,9 @@
 #include "EffectRegisterer3D.h"
 #include "EffectStratumBlend.h"
 #include "Shaders/SpatialVolumeFieldAssist.h"
+#include "Shaders/VolumeParticleBins.h"
 #include <vector>
 
-struct BubbleCenter3D
-{
-    float cx, cy, cz, radius;
-};
-
 class Bubbles : public SpatialEffect3D
 {
     Q_OBJECT
@@ -27,12 +23,34 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
 private:
     static constexpr int kMaxGpuBubbles = 48;
+    static constexpr int kBubbleBinsPerAxis = 8;
+
+    /** Active bubbles of the current frame for the CPU atlas bake (SoA). */
+    struct BubbleTable
+    {
+        std::vector<float> cx, cy, cz;
+        std::vector<float> radius;
+        std::vector<float> hue01;
+
+        void Clear()
+        {
+            cx.clear();
+            cy.clear();
+            cz.clear();
+            radius.clear();
+            hue01.clear();
+        }
+    };
+
+    /** CPU port of BubblesVolumeFieldGlsl (SpatialVolumeFieldCpuBaker); fills bubble_table_ / bubble_bins_. */
+    SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
 
     int max_bubbles = 24;
     float bubble_thickness = 0.55f;
@@ -42,8 +60,8 @@ private:
     float horizontal_fill = 1.35f;
     float overlap_spacing = 0.65f;
     float launch_randomness = 0.55f;
-    float bubble_cache_time = -1e9f;
-    std::vector<BubbleCenter3D> bubble_centers_cached;
+    BubbleTable bubble_table_;
+    VolumeParticleBins bubble_bins_;
     SpatialVolumeFieldAssist volume_assist_;
 };
 
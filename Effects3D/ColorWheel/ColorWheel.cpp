@@ -2,6 +2,7 @@
 
 #include "ColorWheel.h"
 #include "ColorWheelVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectStratumBlend.h"
 #include "EffectHelpers.h"
 #include "SpatialKernelColormap.h"
@@ -19,6 +20,7 @@ ColorWheel::ColorWheel(QWidget* parent) : SpatialEffect3D(parent)
     SetRainbowMode(true);
     volume_assist_.setFragmentBody(QString::fromUtf8(ColorWheelVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&ColorWheel::BuildCpuRows);
 }
 
 EffectInfo3D ColorWheel::GetEffectInfo() const
@@ -140,82 +142,172 @@ void ColorWheel::PrepareGpuFields(std::uint64_t render_sequence, float time_sec,
     volume_assist_.prepare(render_sequence, time_sec, vp, 6);
 }
 
-RGBColor ColorWheel::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+SpatialVolumeFieldEngine::CpuRowFn ColorWheel::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
 {
-    const bool room_mapped = UsesRoomMappedCoordinates();
-    Vector3D origin = room_mapped ? Vector3D{grid.center_x, grid.center_y, grid.center_z}
-                                  : GetEffectOriginGrid(grid);
-    float rel_x = x - origin.x, rel_y = y - origin.y, rel_z = z - origin.z;
+    const float* u = ctx.params;
+    const float progress = u[0];
+    const float dir = u[1];
+    const float wrap = std::clamp(u[2], 0.1f, 3.0f);
+    const int pl = (int)(u[3] + 0.5f);
+    const int geom = (int)(u[4] + 0.5f);
+    const float freq_spin = u[5];
+    const float spin = progress * TWO_PI * dir + freq_spin;
+    const float cu = std::cos(spin);
+    const float su = std::sin(spin);
+    const float slices = std::max(2.0f, std::floor(wrap * 6.0f + 0.5f));
+    // Rings animate through the progress term in angle; the global spin would cancel it.
+    const float hue_offset = freq_spin * 0.02f + (geom != 2 ? progress * dir : 0.0f);
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ly = row.y01 * 2.0f - 1.0f;
+        const float lz = row.z01 * 2.0f - 1.0f;
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = row.x01[x] * 2.0f - 1.0f;
+            float pu = lx;
+            float pv = lz;
+            if(pl == 1)
+            {
+                pv = ly;
+            }
+            else if(pl == 2)
+            {
+                pu = lz;
+                pv = ly;
+            }
+
+            float angle = 0.0f;
+            if(geom == 1)
+            {
+                angle = (pu * cu + pv * su) * (float)M_PI * wrap;
+            }
+            else if(geom == 2)
+            {
+                angle = std::sqrt(pu * pu + pv * pv) * TWO_PI * wrap - progress * TWO_PI * dir - freq_spin;
+            }
+            else if(geom == 3)
+            {
+                const float a = std::atan2(pv, pu) - spin;
+                const float sector = std::floor((a / TWO_PI + 1.0f) * slices);
+                angle = (sector + 0.5f) / slices * TWO_PI;
+            }
+            else
+            {
+                angle = std::atan2(pv, pu) * wrap;
+            }
+
+            const float ang = (angle / TWO_PI + hue_offset) * TWO_PI;
+            rgb[x * 3 + 0] = std::cos(ang) * 0.5f + 0.5f;
+            rgb[x * 3 + 1] = std::sin(ang) * 0.5f + 0.5f;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
+/** Everything CalculateColorGrid derives from settings / grid / time, resolved once per batch. */
+struct ColorWheel::SampleFrame
+{
+    bool room_mapped = false;
+    Vector3D origin{};
+    float boundary_radius_sq = 0.0f;
+    float progress = 0.0f;
+    float frequency = 0.0f;
+    float size_tight = 1.0f;
+    bool volume_available = false;
+    bool strip_colormap = false;
+    bool rainbow = false;
+    EffectGridAxisHalfExtents extents{};
+    SpatialLayerCore::MapperSettings map;
+    SpatialLayerCore::Basis basis;
+};
+
+ColorWheel::SampleFrame ColorWheel::MakeSampleFrame(float time, const GridContext3D& grid) const
+{
+    SampleFrame f;
+    f.room_mapped = UsesRoomMappedCoordinates();
+    f.origin = f.room_mapped ? Vector3D{grid.center_x, grid.center_y, grid.center_z}
+                             : GetEffectOriginGrid(grid);
+    f.boundary_radius_sq = EffectBoundaryRadiusSq(grid);
+    f.progress = CalculateProgress(time);
+    f.frequency = GetScaledFrequency();
+    f.size_tight = 1.0f / std::max(0.2f, GetNormalizedSize());
+    f.volume_available = volume_assist_.isAvailable();
+    f.strip_colormap = UseEffectStripColormap();
+    f.rainbow = GetRainbowMode();
+    f.extents = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
 
-    float progress = CalculateProgress(time);
     float detail = std::max(0.05f, GetScaledDetail());
+    EffectStratumBlend::InitStratumBreaks(f.map);
+    f.map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
+    f.map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
+    f.map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
+    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), f.basis);
+    return f;
+}
+
+void ColorWheel::ShadeSample(const SampleFrame& f,
+                             float x,
+                             float y,
+                             float z,
+                             float time,
+                             const GridContext3D& grid,
+                             PaletteSample& s) const
+{
+    const Vector3D& origin = f.origin;
+    float rel_x = x - origin.x, rel_y = y - origin.y, rel_z = z - origin.z;
+
     Vector3D rot{x, y, z};
-    float lx = rot.x - origin.x, ly = rot.y - origin.y, lz = rot.z - origin.z;
+    float lx = rel_x, ly = rel_y, lz = rel_z;
 
     const float y_norm = NormalizeGridAxis01(rot.y, grid.min_y, grid.max_y);
-    SpatialLayerCore::MapperSettings map;
-    EffectStratumBlend::InitStratumBreaks(map);
-    map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
-    map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
-    map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
 
     float stratum_w[3]{};
-    EffectStratumBlend::WeightsForYNorm(y_norm, map, stratum_w);
+    EffectStratumBlend::WeightsForYNorm(y_norm, f.map, stratum_w);
     const EffectStratumBlend::BandBlendScalars bb =
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), stratum_w, GetStratumTuning());
-    const float stratum_mot01 =
-        ComputeStratumMotion01(stratum_w, grid, x, y, z, origin, time);
     float spd_mul = bb.speed_mul;
     float sz_mul = bb.tight_mul;
 
-    EffectGridAxisHalfExtents e = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
-    if(room_mapped)
+    EffectGridAxisHalfExtents e = f.extents;
+    if(f.room_mapped)
     {
-        const float size_tight = 1.0f / std::max(0.2f, GetNormalizedSize());
-        e.hw /= sz_mul * size_tight;
-        e.hh /= sz_mul * size_tight;
-        e.hd /= sz_mul * size_tight;
+        e.hw /= sz_mul * f.size_tight;
+        e.hh /= sz_mul * f.size_tight;
+        e.hd /= sz_mul * f.size_tight;
         if(std::fabs(lx) > e.hw || std::fabs(ly) > e.hh || std::fabs(lz) > e.hd)
         {
-            return 0x00000000;
+            return;
         }
     }
     else
     {
-        if(!IsWithinEffectBoundary(rel_x, rel_y, rel_z, grid))
+        if(rel_x * rel_x + rel_y * rel_y + rel_z * rel_z > f.boundary_radius_sq)
         {
-            return 0x00000000;
+            return;
         }
         e.hw /= sz_mul;
         e.hh /= sz_mul;
         e.hd /= sz_mul;
     }
 
-    float gpu_plane01 = 0.0f;
-    bool have_gpu_plane = false;
-    if(volume_assist_.isAvailable())
-    {
-        float c1 = 0.5f, c2 = 0.5f, c3 = 0.5f;
-        SampleCoordsOriginLocal01(rot.x, rot.y, rot.z, origin, e, &c1, &c2, &c3);
-        const QVector3D cs = volume_assist_.sample01(c1, c2, c3);
-        // Cos/sin atlas encoding (range-packed to 0..1 for the RGBA8 atlas) — avoids
-        // the rotating false seam from filtering wrapped hue.
-        float hue_rad = std::atan2(cs.y() * 2.0f - 1.0f, cs.x() * 2.0f - 1.0f);
-        gpu_plane01 = std::fmod(hue_rad / TWO_PI + 1.0f, 1.0f);
-        gpu_plane01 = std::fmod(gpu_plane01 + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01)
-                                    + time * GetScaledFrequency() * 0.02f * (spd_mul - 1.0f) + 1.0f,
-                                1.0f);
-        have_gpu_plane = true;
-    }
-
-    float hue_plane = 0.0f;
-    if(!have_gpu_plane)
-        return 0x00000000;
-    hue_plane = gpu_plane01 * 360.0f;
+    if(!f.volume_available)
+        return;
 
+    const float stratum_mot01 =
+        ComputeStratumMotion01(stratum_w, grid, x, y, z, origin, time);
 
-    SpatialLayerCore::Basis basis;
-    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), basis);
+    float c1 = 0.5f, c2 = 0.5f, c3 = 0.5f;
+    SampleCoordsOriginLocal01(rot.x, rot.y, rot.z, origin, e, &c1, &c2, &c3);
+    const QVector3D cs = volume_assist_.sample01(c1, c2, c3);
+    // Cos/sin atlas encoding (range-packed to 0..1 for the RGBA8 atlas) — avoids
+    // the rotating false seam from filtering wrapped hue.
+    float hue_rad = std::atan2(cs.y() * 2.0f - 1.0f, cs.x() * 2.0f - 1.0f);
+    float gpu_plane01 = std::fmod(hue_rad / TWO_PI + 1.0f, 1.0f);
+    gpu_plane01 = std::fmod(gpu_plane01 + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01)
+                                + time * f.frequency * 0.02f * (spd_mul - 1.0f) + 1.0f,
+                            1.0f);
+    float hue_plane = gpu_plane01 * 360.0f;
 
     SpatialLayerCore::SamplePoint sp{};
     sp.grid_x = x;
@@ -228,16 +320,16 @@ RGBColor ColorWheel::CalculateColorGrid(float x, float y, float z, float time, c
 
     if(hue_plane < 0.0f) hue_plane += 360.0f;
     const float plane01 = hue_plane / 360.0f;
-    float mapped_hue = ApplySpatialRainbowHue(hue_plane, plane01, basis, sp, map, time, &grid);
+    float mapped_hue = ApplySpatialRainbowHue(hue_plane, plane01, f.basis, sp, f.map, time, &grid);
     float palette01 = std::fmod(mapped_hue / 360.0f, 1.0f);
     if(palette01 < 0.0f)
     {
         palette01 += 1.0f;
     }
-    if(UseEffectStripColormap())
+    if(f.strip_colormap)
     {
         const float size_m = GetNormalizedSize();
-        const float ph01 = std::fmod(plane01 + progress * 0.17f + time * GetScaledFrequency() * 0.05f + 1.f, 1.f);
+        const float ph01 = std::fmod(plane01 + f.progress * 0.17f + time * f.frequency * 0.05f + 1.f, 1.f);
         palette01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
                                                GetEffectStripColormapRepeats(),
                                                GetEffectStripColormapUnfold(),
@@ -248,12 +340,35 @@ RGBColor ColorWheel::CalculateColorGrid(float x, float y, float z, float time, c
                                                size_m,
                                                origin,
                                                rot);
+        s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), std::clamp(palette01, 0.0f, 1.0f), time);
+        return;
     }
-    if(UseEffectStripColormap())
-    {
-        return ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), std::clamp(palette01, 0.0f, 1.0f), time);
-    }
-    return GetRainbowMode() ? GetRainbowColor(palette01 * 360.0f) : GetColorAtPosition(palette01);
+    s.lookup = f.rainbow ? PaletteSample::HUE : PaletteSample::PALETTE;
+    s.key = f.rainbow ? palette01 * 360.0f : palette01;
+}
+
+RGBColor ColorWheel::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+{
+    PaletteSample s;
+    ShadeSample(MakeSampleFrame(time, grid), x, y, z, time, grid, s);
+    ResolvePaletteSamples(&s, 1);
+    return s.color;
+}
+
+void ColorWheel::CalculateColorGridBatch(const float* xs,
+                                         const float* ys,
+                                         const float* zs,
+                                         size_t count,
+                                         float time,
+                                         const GridContext3D& grid,
+                                         RGBColor* out)
+{
+    const SampleFrame f = MakeSampleFrame(time, grid);
+    ShadePaletteBatch(
+        count,
+        out,
+        [&](size_t i, PaletteSample& s) { ShadeSample(f, xs[i], ys[i], zs[i], time, grid, s); },
+        [](const PaletteSample& s) { return s.color; });
 }
 
 nlohmann::json ColorWheel::SaveSettings() const
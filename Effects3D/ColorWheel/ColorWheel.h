@@ -21,14 +21,37 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool SupportsConcurrentEvaluation() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
+protected:
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+
 private:
+    struct SampleFrame;
+    SampleFrame MakeSampleFrame(float time, const GridContext3D& grid) const;
+    /** The wheel is unshaded: a resolved sample's color is final. */
+    void ShadeSample(const SampleFrame& f,
+                     float x,
+                     float y,
+                     float z,
+                     float time,
+                     const GridContext3D& grid,
+                     PaletteSample& s) const;
+
     int direction = 0;
     int hue_geometry_mode = 0;
     float hue_repeats = 1.0f;
+    /** CPU port of ColorWheelVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
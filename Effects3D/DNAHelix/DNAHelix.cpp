@@ -2,6 +2,7 @@
 
 #include "DNAHelix.h"
 #include "DNAHelixVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectHelpers.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
@@ -44,6 +45,7 @@ DNAHelix::DNAHelix(QWidget* parent) : SpatialEffect3D(parent)
     SetRainbowMode(false);
     volume_assist_.setFragmentBody(QString::fromUtf8(DNAHelixVolumeFieldGlsl()));
     volume_assist_.setResolution(20);
+    volume_assist_.setCpuField(&DNAHelix::BuildCpuRows);
 }
 
 DNAHelix::~DNAHelix() = default;
@@ -191,6 +193,82 @@ void DNAHelix::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, c
     volume_assist_.prepare(render_sequence, time_sec, vp, 9);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn DNAHelix::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float progress = u[0];
+    const float twists = std::max(u[1], 0.35f);
+    const float radius01 = std::clamp(u[2], 0.06f, 0.85f);
+    const float thickness = std::clamp(u[3], 0.03f, 0.45f);
+    const float rung_amount = Clamp01(u[4]);
+    const int shape = (int)(std::clamp(u[5], 0.0f, 3.0f) + 0.5f);
+    const Vec3 origin01 = Clamp01(Vec3(u[6], u[7], u[8]));
+    const float core_w = thickness * ((shape == 1) ? 1.65f : 1.0f);
+    const float glow_w = core_w * ((shape == 2) ? 2.8f : 2.2f);
+    const float pi = (float)M_PI;
+
+    // smstep from DNAHelixVolumeFieldGlsl: guards the zero-width edge.
+    auto smstep = [](float e0, float e1, float v) {
+        const float t = Clamp01((v - e0) / std::max(e1 - e0, 1e-5f));
+        return t * t * (3.0f - 2.0f * t);
+    };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        // Strand positions only depend on height.
+        const float ly = row.y01;
+        const float lz = (row.z01 - origin01.z) * 2.0f;
+        const float phase = ly * twists * TWO_PI + progress * TWO_PI;
+        const float hx1 = radius01 * std::cos(phase);
+        const float hz1 = radius01 * std::sin(phase);
+        const float rung_phase = Fract(ly * twists * 2.0f + progress * 0.5f);
+        const float rung_gate = 1.0f - smstep(0.0f, 0.12f + 0.08f * (1.0f - rung_amount), std::fabs(rung_phase - 0.5f));
+        const float palette_base = ly * twists * 0.35f + progress;
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = (row.x01[x] - origin01.x) * 2.0f;
+            const float d1 = std::hypot(lx - hx1, lz - hz1);
+            const float d2 = std::hypot(lx + hx1, lz + hz1);
+            const float d_strand = std::min(d1, d2);
+            const float strand = 1.0f - smstep(0.0f, core_w, d_strand);
+            const float glow = (1.0f - smstep(core_w, glow_w, d_strand)) * 0.55f;
+            const float rad = std::hypot(lx, lz);
+            float intensity = strand + glow;
+
+            if(shape == 2)
+            {
+                // Soft angular ribbons instead of tubes.
+                const float a = std::atan2(lz, lx);
+                const float da1 = std::fabs(Mod(a - phase + pi, TWO_PI) - pi);
+                const float da2 = std::fabs(Mod(a - phase - pi + pi, TWO_PI) - pi);
+                const float ang = std::min(da1, da2);
+                const float ribbon = (1.0f - smstep(0.0f, 0.55f + thickness, ang)) *
+                                     (1.0f - smstep(radius01 * 0.35f, radius01 * 1.35f, std::fabs(rad - radius01)));
+                intensity = std::max(intensity, ribbon);
+            }
+
+            float rung = 0.0f;
+            if(rung_amount > 0.02f)
+            {
+                const float bridge = 1.0f - smstep(0.0f, thickness * 1.1f, std::fabs(rad - radius01 * 0.55f));
+                const float between = 1.0f - smstep(radius01 * 0.15f, radius01 * 1.05f, rad);
+                rung = bridge * between * rung_gate * rung_amount;
+                if(shape == 3)
+                {
+                    rung *= 1.45f;
+                }
+                intensity = std::max(intensity, rung);
+            }
+
+            const float axis_glow = 0.10f * (1.0f - smstep(0.0f, radius01 * 1.4f, rad));
+            rgb[x * 3 + 0] = Clamp01(intensity + axis_glow);
+            rgb[x * 3 + 1] = Fract(palette_base + (d1 < d2 ? 0.0f : 0.5f));
+            rgb[x * 3 + 2] = (rung > strand * 0.45f) ? 1.0f : 0.0f;
+        }
+    };
+}
+
 RGBColor DNAHelix::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
@@ -25,6 +25,7 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
@@ -52,6 +53,8 @@ private:
     QSlider* twist_slider = nullptr;
     QSlider* thickness_slider = nullptr;
     QSlider* rung_slider = nullptr;
+    /** CPU port of DNAHelixVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
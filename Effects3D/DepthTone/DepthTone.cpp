@@ -2,6 +2,7 @@
 
 #include "DepthTone.h"
 #include "DepthToneVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectHelpers.h"
 
 #include "SpatialKernelColormap.h"
@@ -80,6 +81,7 @@ DepthTone::DepthTone(QWidget* parent) : SpatialEffect3D(parent)
     SetFrequency(30);
     volume_assist_.setFragmentBody(QString::fromUtf8(DepthToneVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&DepthTone::BuildCpuRows);
 }
 
 DepthTone::~DepthTone() = default;
@@ -216,6 +218,45 @@ void DepthTone::PrepareGpuFields(std::uint64_t render_sequence, float time_sec,
     volume_assist_.prepare(render_sequence, time_sec, vp, 10);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn DepthTone::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float pos = u[0];
+    const float hue_span = u[1];
+    const float percent_dim = u[2];
+    const int axis = (int)(std::clamp(u[3], 0.0f, 2.0f) + 0.5f);
+    const int layout = (int)(std::clamp(u[4], 0.0f, 2.0f) + 0.5f);
+    const float size_zoom = std::max(u[5], 0.15f);
+    const float soft = std::clamp(u[6], 0.05f, 1.0f);
+    const Vec3 origin01 = Clamp01(Vec3(u[7], u[8], u[9]));
+    const Vec3 center01 = layout == 2 ? origin01 : Vec3(0.5f);
+    const float tones = std::max(2.0f, 2.0f + hue_span * 32.0f);
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 p01(row.x01[x], row.y01, row.z01);
+            float d01 = axis == 0 ? p01.x : (axis == 1 ? p01.y : p01.z);
+            if(layout != 0)
+            {
+                d01 = Clamp01(Length(p01 - center01) / 0.8660254f);
+            }
+
+            const float d_mapped = layout == 0 ? Clamp01((d01 - 0.5f) / size_zoom + 0.5f) : Clamp01(d01 / size_zoom);
+            const float phase = pos + d_mapped * hue_span;
+            const float stepped = std::floor(phase * tones + 1e-4f) / tones;
+            const float phase_use = Mix(phase, Mix(phase, stepped, 0.85f), soft);
+            const float ang = Fract(phase_use + 1.0f) * TWO_PI;
+            const float center = 1.0f - std::fabs(d_mapped - 0.5f) * 2.0f;
+            rgb[x * 3 + 0] = std::cos(ang) * 0.5f + 0.5f;
+            rgb[x * 3 + 1] = std::sin(ang) * 0.5f + 0.5f;
+            rgb[x * 3 + 2] = Clamp01(1.0f - percent_dim * center);
+        }
+    };
+}
+
 RGBColor DepthTone::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
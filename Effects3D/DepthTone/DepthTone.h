@@ -24,6 +24,7 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
@@ -45,6 +46,8 @@ private:
     QSlider* dim_slider = nullptr;
     QComboBox* axis_combo = nullptr;
     QComboBox* layout_combo = nullptr;
+    /** CPU port of DepthToneVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
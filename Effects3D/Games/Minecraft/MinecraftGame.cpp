@@ -227,9 +227,11 @@ const GameTelemetryBridge::TelemetrySnapshot& PrepareRenderFrame(const GridConte
     {
         std::uint64_t prepared_sequence = UINT64_MAX;
         bool room_config_published = false;
+        /** Held until the revision moves; the published snapshot is immutable, so no copy is needed. */
+        std::uint64_t telemetry_revision = UINT64_MAX;
+        std::shared_ptr<const GameTelemetryBridge::TelemetrySnapshot> telemetry;
     };
     static thread_local FrameState state;
-    static thread_local GameTelemetryBridge::TelemetrySnapshot snapshot;
 
     const bool preview_pass = (grid.render_sequence == 0);
     const bool new_frame = preview_pass || state.prepared_sequence != grid.render_sequence;
@@ -244,7 +246,13 @@ const GameTelemetryBridge::TelemetrySnapshot& PrepareRenderFrame(const GridConte
         state.room_config_published = false;
     }
 
-    snapshot = GameTelemetryBridge::GetTelemetrySnapshot();
+    const std::uint64_t revision = GameTelemetryBridge::TelemetryDataRevision();
+    if(!state.telemetry || revision != state.telemetry_revision)
+    {
+        state.telemetry = GameTelemetryBridge::GetTelemetrySnapshot();
+        state.telemetry_revision = revision;
+    }
+    const GameTelemetryBridge::TelemetrySnapshot& snapshot = *state.telemetry;
 
     if(ch(channels, ChRoomAmbilight) && !state.room_config_published)
     {
@@ -21,6 +21,8 @@ public:
     EffectInfo3D GetEffectInfo() const override;
     void SetupCustomUI(QWidget* parent) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    /** Smoothing keeps per-LED state keyed by MinecraftGame::GetRenderSampleIndex(). */
+    bool RequiresPerLedSampleContext() const override { return GetSmoothing() != 0; }
 
 private:
     /** Per-LED EMA state for Output shaping → Smoothing. */
@@ -2,6 +2,7 @@
 
 #include "HarmonicPulse.h"
 #include "HarmonicPulseVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectHelpers.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialPatternKernels/SpatialPatternKernels.h"
@@ -86,6 +87,7 @@ HarmonicPulse::HarmonicPulse(QWidget* parent) : SpatialEffect3D(parent)
         SetColors(cols);
     volume_assist_.setFragmentBody(QString::fromUtf8(HarmonicPulseVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&HarmonicPulse::BuildCpuRows);
 }
 
 HarmonicPulse::~HarmonicPulse() = default;
@@ -223,6 +225,49 @@ void HarmonicPulse::PrepareGpuFields(std::uint64_t render_sequence, float time_s
     volume_assist_.prepare(render_sequence, time_sec, vp, 9);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn HarmonicPulse::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float motion = std::max(u[0], 0.02f);
+    const float spatial_freq = std::max(u[1], 0.5f);
+    const float wobble = std::clamp(u[2], 0.0f, 3.0f);
+    const float contrast = std::clamp(u[3], 0.35f, 2.5f);
+    const float size_density = std::max(u[4], 0.2f);
+    const float pulse_mix = Clamp01(u[5]);
+    const Vec3 origin01 = Clamp01(Vec3(u[6], u[7], u[8]));
+    const float t = ctx.time_sec;
+
+    // Everything but the spatial field only depends on time.
+    const float beat = 0.5f + 0.5f * std::sin(t * motion * TWO_PI);
+    const float beat2 = 0.5f + 0.5f * std::sin(t * motion * 1.618f * TWO_PI + 1.2f);
+    const float master = Clamp01(0.65f * beat + 0.35f * beat2);
+    const float zw = 0.5f + 0.5f * std::sin(t * motion * 0.55f * TWO_PI);
+    const float zoom = 1.0f + zw * wobble * 0.35f;
+    const float k = spatial_freq * zoom * size_density;
+    const float t1 = t * motion * TWO_PI;
+    const float t2 = t * motion * 0.73f * TWO_PI;
+    const float phase_t = t * motion * 0.15f;
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float yf = (row.y01 - origin01.y) * k;
+        const float zf = (row.z01 - origin01.z) * k;
+        const float y_term = 0.30f * std::cos(yf * TWO_PI + t2);
+        const float z_term = 0.25f * std::sin(zf * TWO_PI + t1 - t2);
+        for(int x = 0; x < row.count; x++)
+        {
+            const float xf = (row.x01[x] - origin01.x) * k;
+            const float field = Clamp01(0.5f + 0.5f * (0.45f * std::sin(xf * TWO_PI + t1) + y_term + z_term));
+            float val = Mix(master, field * (0.35f + 0.65f * master), pulse_mix);
+            val = std::pow(Clamp01(val), contrast);
+            rgb[x * 3 + 0] = Clamp01(0.12f + 0.88f * val);
+            rgb[x * 3 + 1] = Fract(master * 0.5f + field * 0.35f + phase_t);
+            rgb[x * 3 + 2] = master;
+        }
+    };
+}
+
 RGBColor HarmonicPulse::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
@@ -2,6 +2,7 @@
 
 #include "HexLattice.h"
 #include "HexLatticeVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialPatternKernels/SpatialPatternKernels.h"
 
@@ -77,6 +78,7 @@ HexLattice::HexLattice(QWidget* parent) : SpatialEffect3D(parent)
     // Higher atlas res than most effects: hex walls are sub-cell features and
     // blur away at 18^3.
     volume_assist_.setResolution(20); // was 28 — atlas cost is n³; 20 keeps hex edges readable
+    volume_assist_.setCpuField(&HexLattice::BuildCpuRows);
 }
 
 HexLattice::~HexLattice() = default;
@@ -193,6 +195,63 @@ void HexLattice::PrepareGpuFields(std::uint64_t render_sequence, float time_sec,
     volume_assist_.prepare(render_sequence, time_sec, vp, 11);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn HexLattice::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float flow_t = u[0];
+    const float hue_t = u[1];
+    const float detail_norm = Clamp01(u[2]);
+    const float base_scale = std::max(u[3], 0.2f);
+    const float breathing_amount = std::clamp(u[4], 0.0f, 2.0f);
+    const float pulse_amount = std::clamp(u[5], 0.0f, 2.0f);
+    const float turbulence = std::clamp(u[6], 0.0f, 2.0f);
+    const float flow_mul = std::max(u[7], 0.15f);
+    const Vec3 origin01 = Clamp01(Vec3(u[8], u[9], u[10]));
+
+    auto wave01 = [](float v) { return 0.5f + 0.5f * std::sin(TWO_PI * v); };
+    const float breathe = 1.0f + (wave01(flow_t * 0.30f) - 0.5f) * 0.35f * breathing_amount;
+    // Soft-cap cell density like the shader so high Detail does not alias.
+    const float cells = std::min(12.0f, (5.0f + 7.0f * detail_norm) / base_scale * breathe);
+    const float edge_w = 0.20f - 0.08f * detail_norm;
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ly = Clamp01(row.y01 - origin01.y + 0.5f);
+        const float lz = Clamp01(row.z01 - origin01.z + 0.5f);
+        const float bend_x = turbulence * 0.07f * std::sin(TWO_PI * (ly * 0.8f + flow_t * 0.11f));
+        const float bend_z = turbulence * 0.07f * std::cos(TWO_PI * (ly * 0.8f - flow_t * 0.09f));
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = Clamp01(row.x01[x] - origin01.x + 0.5f);
+            const float uv_x = (lx + bend_x) * cells + flow_t * flow_mul * 0.22f;
+            const float uv_y = (lz + bend_z) * cells + flow_t * flow_mul * 0.31f;
+
+            const float r_x = 1.0f;
+            const float r_y = 1.7320508f;
+            const float a_x = Mod(uv_x, r_x) - r_x * 0.5f;
+            const float a_y = Mod(uv_y, r_y) - r_y * 0.5f;
+            const float b_x = Mod(uv_x - r_x * 0.5f, r_x) - r_x * 0.5f;
+            const float b_y = Mod(uv_y - r_y * 0.5f, r_y) - r_y * 0.5f;
+            const bool use_a = a_x * a_x + a_y * a_y < b_x * b_x + b_y * b_y;
+            const float gv_x = use_a ? a_x : b_x;
+            const float gv_y = use_a ? a_y : b_y;
+            const float id_x = uv_x - gv_x;
+            const float id_y = uv_y - gv_y;
+
+            const float hd = std::max(std::fabs(gv_x) * 0.5f + std::fabs(gv_y) * 0.8660254f, std::fabs(gv_x));
+            const float edge = Smoothstep(0.5f - edge_w, 0.5f - edge_w * 0.15f, hd);
+            const float hcell = Fract(std::sin(id_x * 12.9898f + id_y * 78.233f) * 43758.547f);
+            const float pulse = wave01(flow_t * (0.20f + 0.35f * hcell) * flow_mul + hcell);
+            const float cell_fill = (0.06f + 0.30f * pulse * pulse_amount) * (1.0f - edge);
+
+            rgb[x * 3 + 0] = Clamp01(edge * (0.80f + 0.20f * pulse) + cell_fill);
+            rgb[x * 3 + 1] = Fract(id_x * 0.045f + id_y * 0.030f + hcell * 0.18f + (ly - 0.5f) * 0.10f + hue_t);
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
 RGBColor HexLattice::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
@@ -3,18 +3,15 @@
 #include "OmniShapeTexture.h"
 
 #include "Geometry3DUtils.h"
-#include "MediaTextureEffectUtils.h"
 #include "OmniShapeTextureVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
+#include "MediaTextureEffectUtils.h"
 #include "SpatialLayerCore.h"
 #include <QCheckBox>
 #include <QComboBox>
 #include <QFileDialog>
 #include <QLabel>
-#include <QMovie>
-#include <QMutexLocker>
 #include <QPushButton>
-#include <QTimer>
-#include <QDateTime>
 #include "EffectSliderRow.h"
 #include "EffectUiRows.h"
 #include "MediaTextureAmbienceBlock.h"
@@ -242,25 +239,21 @@ OmniShapeTexture::OmniShapeTexture(QWidget* parent)
       motion_phase_slider(nullptr),
       media_resolution_slider(nullptr),
       tile_repeat_check(nullptr),
-      movie(nullptr),
-      gif_frame_timer(nullptr),
-      media_is_gif(false),
       base_shape(0),
       morph_percent(0),
       spin_percent(40)
 {
-    gif_frame_timer = new QTimer(this);
-    gif_frame_timer->setTimerType(Qt::PreciseTimer);
-    connect(gif_frame_timer, &QTimer::timeout, this, &OmniShapeTexture::OnGifFrameTimerTimeout);
     SetRainbowMode(false);
     SetSpeed(30);
     volume_assist_.setFragmentBody(QString::fromUtf8(OmniShapeTextureVolumeFieldGlsl()));
     volume_assist_.setResolution(28);
+    volume_assist_.setCpuField(&OmniShapeTexture::BuildCpuRows);
 }
 
 OmniShapeTexture::~OmniShapeTexture()
 {
-    ClearMovie();
+    // Joins the decoder before its queued on_loaded callback could outlive this.
+    media_atlas_.reset();
 }
 
 EffectInfo3D OmniShapeTexture::GetEffectInfo() const
@@ -271,7 +264,7 @@ EffectInfo3D OmniShapeTexture::GetEffectInfo() const
         "Image or GIF mapped onto a crisp 3D shape envelope at the effect origin (sphere / cube / octahedron / "
         "cylinder / hex / triangle). Size grows that silhouette; Scale tiles the texture. "
         "Morph blends to the next shape. Spin rotates the mapping; Scroll / Warp / Phase drive strong UV motion. "
-        "For GIFs, Speed is frames per second: 0 = frozen, 1 = 1 FPS, … up to 200 FPS. "
+        "For GIFs, Speed 30 plays at the file's own frame timing: 0 = frozen, 15 = half, 60 = double speed. "
         "Ambience: distance dim, falloff curve, edge fade, wave delay. "
         "Stratum bands blend speed, tightness, and phase.";
     info.category = "Media";
@@ -323,6 +316,7 @@ void OmniShapeTexture::SetupCustomUI(QWidget* parent)
     pick_row->addWidget(browse_button);
     pick_row->addWidget(path_label);
     layout->addLayout(pick_row);
+    UpdateMediaLabel();
 
     EffectLabeledComboRow* shape_row = EffectUiRows::AppendComboRow(layout, tr("Shape:"));
     shape_row->setObjectName(QStringLiteral("shapeRow"));
@@ -445,179 +439,59 @@ void OmniShapeTexture::OnShapeChanged(int index)
     emit ParametersChanged();
 }
 
-void OmniShapeTexture::OnMediaFrameChanged(int /*frameNumber*/)
-{
-    RefreshFrameFromMovie();
-}
-
-void OmniShapeTexture::OnGifFrameTimerTimeout()
+void OmniShapeTexture::LoadMediaFile(const QString& path)
 {
-    if(!movie || !media_is_gif)
-    {
-        return;
-    }
-    const int fc = movie->frameCount();
-    if(fc <= 0)
+    media_path = path;
+    media_atlas_.reset();
+    media_clock_.Reset();
+    if(!path.isEmpty())
     {
-        if(gif_frame_timer)
+        // Decoded off the GUI thread; frames become visible as they land.
+        media_atlas_ = std::make_unique<MediaFrameAtlas>(path, SpatialVolumeFieldEngine::kMaxMediaEdge, [this]()
         {
-            gif_frame_timer->stop();
-        }
-        return;
-    }
-    const int cur = movie->currentFrameNumber();
-    const int next = (cur + 1) % fc;
-    {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame = display_frame;
-        last_gif_step_ms = QDateTime::currentMSecsSinceEpoch();
-    }
-    (void)movie->jumpToFrame(next);
-    PublishDisplayFrame(movie->currentImage());
-}
-
-void OmniShapeTexture::ClearMovie()
-{
-    if(gif_frame_timer)
-    {
-        gif_frame_timer->stop();
-    }
-    if(movie)
-    {
-        movie->stop();
-        disconnect(movie, nullptr, this, nullptr);
-        delete movie;
-        movie = nullptr;
+            QMetaObject::invokeMethod(this, [this]()
+            {
+                UpdateMediaLabel();
+                emit ParametersChanged();
+            }, Qt::QueuedConnection);
+        });
     }
-    media_is_gif = false;
-    last_gif_step_ms = 0;
-    gif_step_interval_ms = 0;
-    QMutexLocker lock(&display_mutex);
-    previous_display_frame.reset();
+    UpdateMediaLabel();
+    emit ParametersChanged();
 }
 
-void OmniShapeTexture::PublishDisplayFrame(const QImage& src)
+void OmniShapeTexture::UpdateMediaLabel()
 {
-    if(src.isNull())
+    if(!path_label)
     {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame.reset();
-        display_frame.reset();
         return;
     }
-    QImage conv = src.convertToFormat(QImage::Format_ARGB32);
-    constexpr int kMaxSampleEdge = 1536;
-    if(conv.width() > kMaxSampleEdge || conv.height() > kMaxSampleEdge)
-    {
-        conv = conv.scaled(kMaxSampleEdge, kMaxSampleEdge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        conv = conv.convertToFormat(QImage::Format_ARGB32);
-    }
-    std::shared_ptr<QImage> shot = std::make_shared<QImage>(std::move(conv));
-    QMutexLocker lock(&display_mutex);
-    display_frame = std::move(shot);
-}
-
-void OmniShapeTexture::RefreshFrameFromMovie()
-{
-    if(!movie)
+    if(!media_atlas_)
     {
+        path_label->setText(tr("(no file)"));
         return;
     }
-    PublishDisplayFrame(movie->currentImage());
-}
-
-void OmniShapeTexture::LoadMediaFile(const QString& path)
-{
-    media_path = path;
-    if(path_label)
+    const MediaFrameAtlas::Stats stats = media_atlas_->GetStats();
+    if(!stats.complete)
     {
-        path_label->setText(path.isEmpty() ? tr("(no file)") : path);
+        path_label->setText(tr("%1 (loading…)").arg(media_path));
     }
-
-    ClearMovie();
-    {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame.reset();
-        display_frame.reset();
-    }
-
-    if(path.isEmpty())
+    else if(stats.failed)
     {
-        emit ParametersChanged();
-        return;
+        path_label->setText(tr("Invalid or unsupported media"));
     }
-
-    const bool is_gif = path.endsWith(QLatin1String(".gif"), Qt::CaseInsensitive);
-    if(is_gif)
+    else if(stats.frame_count > 1)
     {
-        movie = new QMovie(path, QByteArray(), this);
-        if(!movie->isValid())
-        {
-            delete movie;
-            movie = nullptr;
-            if(path_label)
-            {
-                path_label->setText(tr("Invalid or unsupported GIF"));
-            }
-            emit ParametersChanged();
-            return;
-        }
-        media_is_gif = true;
-        movie->start();
-        movie->setPaused(true);
-        (void)movie->jumpToFrame(0);
-        PublishDisplayFrame(movie->currentImage());
-        {
-            QMutexLocker lock(&display_mutex);
-            previous_display_frame.reset();
-        }
-        last_gif_step_ms = 0;
-        ApplyGifPlaybackSpeed();
+        path_label->setText(tr("%1 (%2 frames, %3 MiB%4)")
+                                .arg(media_path)
+                                .arg(stats.frame_count)
+                                .arg((double)stats.resident_bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                .arg(stats.streaming ? tr(", streaming") : QString()));
     }
     else
     {
-        QImage img(path);
-        if(img.isNull())
-        {
-            emit ParametersChanged();
-            return;
-        }
-        PublishDisplayFrame(img);
-    }
-
-    emit ParametersChanged();
-}
-
-void OmniShapeTexture::SetSpeed(unsigned int speed)
-{
-    SpatialEffect3D::SetSpeed(speed);
-    ApplyGifPlaybackSpeed();
-}
-
-void OmniShapeTexture::ApplyGifPlaybackSpeed()
-{
-    if(!movie || !media_is_gif || !gif_frame_timer)
-    {
-        if(gif_frame_timer)
-        {
-            gif_frame_timer->stop();
-        }
-        return;
-    }
-    const unsigned int fps = GetSpeed();
-    if(fps == 0)
-    {
-        gif_frame_timer->stop();
-        movie->setPaused(true);
-        gif_step_interval_ms = 0;
-        return;
+        path_label->setText(media_path);
     }
-    movie->setPaused(true);
-    const int interval_ms = std::max(1, (int)std::lround(1000.0 / (double)fps));
-    gif_frame_timer->stop();
-    gif_frame_timer->setInterval(interval_ms);
-    gif_step_interval_ms = interval_ms;
-    gif_frame_timer->start();
 }
 
 void OmniShapeTexture::OnBrowseMedia()
@@ -636,18 +510,13 @@ void OmniShapeTexture::OnBrowseMedia()
 
 void OmniShapeTexture::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid)
 {
-    std::shared_ptr<QImage> snap;
-    std::shared_ptr<QImage> prev_snap;
-    qint64 step_ms = 0;
-    int step_interval_ms = 0;
+    MediaPlaybackFrame frame;
+    if(media_atlas_)
     {
-        QMutexLocker lock(&display_mutex);
-        snap = display_frame;
-        prev_snap = previous_display_frame;
-        step_ms = last_gif_step_ms;
-        step_interval_ms = gif_step_interval_ms;
+        frame = media_clock_.Advance(*media_atlas_, time_sec, GetSpeed(), GetSmoothing() / 100.0f);
     }
-    if(!snap || snap->isNull())
+    const std::shared_ptr<const MediaFramePyramid>& snap = frame.current;
+    if(!snap || snap->IsNull())
     {
         volume_assist_.clearMediaTexture();
         /* Rebuild atlas so GPU samples go black instead of a stale frame. */
@@ -656,47 +525,21 @@ void OmniShapeTexture::PrepareGpuFields(std::uint64_t render_sequence, float tim
         return;
     }
 
-    QImage media = *snap;
-    constexpr int kGpuMediaEdge = SpatialVolumeFieldEngine::kMaxMediaEdge;
-    if(media.width() > kGpuMediaEdge || media.height() > kGpuMediaEdge)
-    {
-        media = media.scaled(kGpuMediaEdge, kGpuMediaEdge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    }
+    int media_w = snap->Width();
+    int media_h = snap->Height();
     const unsigned int eff_res = CombineMediaSampling(media_resolution);
     if(eff_res < 100u)
     {
         const float q = eff_res / 100.0f;
-        const int tw = std::max(8, (int)std::lround(4.0f + q * q * (float)(std::max(2, media.width()) - 4)));
-        const int th = std::max(8, (int)std::lround(4.0f + q * q * (float)(std::max(2, media.height()) - 4)));
-        media = media.scaled(tw, th, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        media_w = std::max(8, (int)std::lround(4.0f + q * q * (float)(std::max(2, media_w) - 4)));
+        media_h = std::max(8, (int)std::lround(4.0f + q * q * (float)(std::max(2, media_h) - 4)));
     }
+    QImage media = media_cache_.Resolve(*snap, media_w, media_h);
 
-    const float smoothing = GetSmoothing() / 100.0f;
-    if(media_is_gif && prev_snap && !prev_snap->isNull() && smoothing > 0.0f && step_interval_ms > 0 && step_ms > 0)
+    if(frame.previous && !frame.previous->IsNull())
     {
-        const qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
-        const float elapsed_ms = (float)std::max<qint64>(0, now_ms - step_ms);
-        const float blend_window_ms = std::max(1.0f, (float)step_interval_ms * smoothing);
-        const float a = std::clamp(elapsed_ms / blend_window_ms, 0.0f, 1.0f);
-        if(a < 0.999f)
-        {
-            QImage cur = media.convertToFormat(QImage::Format_ARGB32);
-            QImage prev = prev_snap->scaled(cur.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
-                              .convertToFormat(QImage::Format_ARGB32);
-            for(int y = 0; y < cur.height(); ++y)
-            {
-                QRgb* dst = reinterpret_cast<QRgb*>(cur.scanLine(y));
-                const QRgb* src = reinterpret_cast<const QRgb*>(prev.constScanLine(y));
-                for(int x = 0; x < cur.width(); ++x)
-                {
-                    const RGBColor c = MediaTextureEffect::LerpRGB(
-                        ToRGBColor(qRed(src[x]), qGreen(src[x]), qBlue(src[x])),
-                        ToRGBColor(qRed(dst[x]), qGreen(dst[x]), qBlue(dst[x])), a);
-                    dst[x] = qRgba(RGBGetRValue(c), RGBGetGValue(c), RGBGetBValue(c), 255);
-                }
-            }
-            media = std::move(cur);
-        }
+        const QImage prev = media_cache_.Resolve(*frame.previous, media.width(), media.height());
+        media = media_cache_.CrossFade(prev, media, frame.blend);
     }
 
     volume_assist_.setMediaTexture(media, tile_repeat_enabled);
@@ -713,7 +556,7 @@ void OmniShapeTexture::PrepareGpuFields(std::uint64_t render_sequence, float tim
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), sw, GetStratumTuning());
     const float tm = std::max(0.25f, bb.tight_mul);
 
-    const bool freeze_gif_motion = media_is_gif && GetSpeed() == 0;
+    const bool freeze_gif_motion = media_atlas_ && media_atlas_->GetStats().frame_count > 1 && GetSpeed() == 0;
     const float scroll_mul = motion_scroll / 100.0f;
     const float warp_mul = motion_warp / 100.0f;
     const float phase_mul = motion_phase / 100.0f;
@@ -763,6 +606,127 @@ void OmniShapeTexture::PrepareGpuFields(std::uint64_t render_sequence, float tim
     volume_assist_.prepare(render_sequence, time_sec, vp, 16);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn OmniShapeTexture::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    const float* p = ctx.params;
+    const int shape_a = (int)(std::clamp(p[0], 0.0f, 5.0f) + 0.5f);
+    const int shape_b = (shape_a + 1) % kOmniShapeCount;
+    const float morph = std::clamp(p[1], 0.0f, 1.0f);
+    const float tile = std::max(p[2], 0.12f);
+    const float yaw_rate = p[3];
+    const float pitch_rate = p[4];
+    const float phase_mul = std::clamp(p[5], 0.0f, 2.0f);
+    const float amp = p[6];
+    const float detail = std::max(p[7], 0.05f);
+    const float ox = std::clamp(p[8], 0.0f, 1.0f);
+    const float oy = std::clamp(p[9], 0.0f, 1.0f);
+    const float oz = std::clamp(p[10], 0.0f, 1.0f);
+    const float fd = std::clamp(p[11], 0.0f, 1.0f);
+    const float curve = std::clamp(p[12], 0.0f, 1.0f);
+    const float edge = std::clamp(p[13], 0.0f, 1.0f);
+    const float R = std::max(p[14], 0.05f);
+    const bool wrap = p[15] >= 1.5f;
+    const float prop = wrap ? (p[15] - 2.0f) : p[15];
+    // Motion always loops the image; idle clamp only when wrap is off.
+    const bool do_wrap = wrap || std::fabs(phase_mul) > 0.02f || amp > 1e-4f;
+    const float band = 0.018f + 0.008f * (1.0f - std::clamp(detail * 0.08f, 0.0f, 1.0f));
+    const float edge_mix = std::clamp(edge * 1.2f, 0.0f, 1.0f);
+    const float time_sec = ctx.time_sec;
+    const QImage* media = ctx.media;
+    const bool media_wrap = ctx.media_wrap;
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            float* out = rgb + x * 3;
+            out[0] = out[1] = out[2] = 0.0f;
+
+            const float px = row.x01[x];
+            float lx = (px - ox) * 2.0f;
+            float ly = (row.y01 - oy) * 2.0f;
+            float lz = (row.z01 - oz) * 2.0f;
+            const float llen = std::sqrt(lx * lx + ly * ly + lz * lz);
+            if(llen < 1e-5f)
+                continue;
+
+            // Propagation: spin/warp lag with distance.
+            const float dist_n = llen * 0.5f * 1.7320508f;
+            const float t_lag = prop * dist_n * 2.8f;
+            const float yaw = time_sec * yaw_rate - t_lag * yaw_rate;
+            const float pitch = time_sec * pitch_rate - t_lag * pitch_rate;
+            float dx = lx / llen;
+            float dy = ly / llen;
+            float dz = lz / llen;
+            RotateDir(dx, dy, dz, yaw, pitch);
+            RotateDir(lx, ly, lz, yaw, pitch);
+
+            const float ma = ShapeMetric(lx, ly, lz, shape_a);
+            const float mb = ShapeMetric(lx, ly, lz, shape_b);
+            const float metric = ma + (mb - ma) * morph;
+            if(metric > R + band)
+                continue;
+            const float mask = 1.0f - Smstep(R - band * 0.1f, R + band * 0.7f, metric);
+            const float surface = 1.0f - Smstep(0.0f, band * 0.75f, std::fabs(metric - R));
+            const float fill = metric <= R ? 0.42f : 0.0f;
+            const float shape_w = std::clamp(std::max(fill, surface * 1.25f), 0.0f, 1.0f) * mask;
+
+            float ua, va, ub, vb;
+            ShapeToUV(shape_a, dx, dy, dz, ua, va);
+            ShapeToUV(shape_b, dx, dy, dz, ub, vb);
+            ua = (ua - 0.5f) * tile + 0.5f;
+            va = (va - 0.5f) * tile + 0.5f;
+            ub = (ub - 0.5f) * tile + 0.5f;
+            vb = (vb - 0.5f) * tile + 0.5f;
+
+            const float t_eff = time_sec - t_lag;
+            const float scroll_u = t_eff * (0.15f + 0.55f * phase_mul);
+            const float scroll_v = t_eff * (0.08f + 0.42f * phase_mul);
+            ua += scroll_u;
+            va += scroll_v;
+            ub += scroll_u;
+            vb += scroll_v;
+
+            const float warp_ph = t_eff * (0.6f + 4.0f * phase_mul);
+            ua += std::sin(warp_ph + ua * 9.0f * detail * 0.1f + va * 6.0f * detail * 0.08f) * amp;
+            va += std::cos(warp_ph * 0.91f + ua * 7.0f * detail * 0.08f - va * 8.0f * detail * 0.1f) * amp;
+            ub += std::sin(warp_ph * 1.05f + ub * 9.0f * detail * 0.1f + vb * 6.0f * detail * 0.08f) * amp;
+            vb += std::cos(warp_ph * 0.94f + ub * 7.0f * detail * 0.08f - vb * 8.0f * detail * 0.1f) * amp;
+
+            if(do_wrap)
+            {
+                ua = MediaTextureEffect::Frac01(ua);
+                va = MediaTextureEffect::Frac01(va);
+                ub = MediaTextureEffect::Frac01(ub);
+                vb = MediaTextureEffect::Frac01(vb);
+            }
+            else
+            {
+                ua = std::clamp(ua, 0.0f, 1.0f);
+                va = std::clamp(va, 0.0f, 1.0f);
+                ub = std::clamp(ub, 0.0f, 1.0f);
+                vb = std::clamp(vb, 0.0f, 1.0f);
+            }
+
+            float ca[4];
+            float cb[4];
+            SpatialFieldCpuMath::SampleMedia(media, media_wrap, ua, 1.0f - va, ca);
+            SpatialFieldCpuMath::SampleMedia(media, media_wrap, ub, 1.0f - vb, cb);
+
+            const float d_face = std::min(std::min(std::min(px, 1.0f - px), std::min(row.y01, 1.0f - row.y01)),
+                                          std::min(row.z01, 1.0f - row.z01));
+            const float ag = MediaTextureEffect::AmbienceGain01(dist_n, d_face, fd, curve, edge);
+            // Edge ambience also sharpens the silhouette.
+            const float edge_boost = 1.0f + ((0.35f + 0.65f * surface) - 1.0f) * edge_mix;
+            const float gain = std::clamp(shape_w * ag * edge_boost, 0.0f, 1.0f);
+            for(int c = 0; c < 3; c++)
+            {
+                out[c] = (ca[c] + (cb[c] - ca[c]) * morph) * gain;
+            }
+        }
+    };
+}
+
 RGBColor OmniShapeTexture::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     if(EffectGridSampleOutsideVolume(x, y, z, grid))
@@ -7,9 +7,8 @@
 #include "EffectRegisterer3D.h"
 #include "EffectStratumBlend.h"
 #include "SpatialVolumeFieldAssist.h"
+#include "MediaFrameAtlas.h"
 
-#include <QImage>
-#include <QMutex>
 #include <QString>
 
 #include <cstdint>
@@ -18,10 +17,8 @@
 class QComboBox;
 class QCheckBox;
 class QLabel;
-class QMovie;
 class QPushButton;
 class QSlider;
-class QTimer;
 class OmniShapeTexture : public SpatialEffect3D
 {
     Q_OBJECT
@@ -41,19 +38,12 @@ public:
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
-    void SetSpeed(unsigned int speed) override;
-
 private slots:
     void OnBrowseMedia();
     void OnShapeChanged(int index);
-    void OnMediaFrameChanged(int frameNumber);
-    void OnGifFrameTimerTimeout();
 private:
-    void ClearMovie();
     void LoadMediaFile(const QString& path);
-    void RefreshFrameFromMovie();
-    void PublishDisplayFrame(const QImage& src);
-    void ApplyGifPlaybackSpeed();
+    void UpdateMediaLabel();
 
     QPushButton* browse_button;
     QLabel* path_label;
@@ -82,20 +72,16 @@ private:
     bool tile_repeat_enabled = false;
 
     QString media_path;
-    QMovie* movie;
-    QTimer* gif_frame_timer;
-    bool media_is_gif;
-
-    QMutex display_mutex;
-    std::shared_ptr<QImage> display_frame;
-    std::shared_ptr<QImage> previous_display_frame;
-    qint64 last_gif_step_ms = 0;
-    int gif_step_interval_ms = 0;
 
     int base_shape;
     unsigned int morph_percent;
     unsigned int spin_percent;
 
+    std::unique_ptr<MediaFrameAtlas> media_atlas_;
+    MediaPlaybackClock media_clock_;
+    MediaFrameCache media_cache_;
+    /** CPU port of OmniShapeTextureVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
@@ -2,6 +2,7 @@
 
 #include "Plasma.h"
 #include "PlasmaVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
 
@@ -34,6 +35,7 @@ Plasma::Plasma(QWidget* parent) : SpatialEffect3D(parent)
     SetRainbowMode(false);
     volume_assist_.setFragmentBody(QString::fromUtf8(PlasmaVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&Plasma::BuildCpuRows);
 }
 
 Plasma::~Plasma() = default;
@@ -142,52 +144,186 @@ void Plasma::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, con
     volume_assist_.prepare(render_sequence, time_sec, vp, 6);
 }
 
-RGBColor Plasma::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+SpatialVolumeFieldEngine::CpuRowFn Plasma::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float prog = u[0];
+    const float fs = std::max(u[1], 0.05f);
+    const int pattern = (int)(u[2] + 0.5f);
+    const Vec3 origin01 = Clamp01(Vec3(u[3], u[4], u[5]));
+
+    // finalizePlasma01 from PlasmaVolumeFieldGlsl.
+    auto finalize = [](float raw, float bias, float gain) {
+        float v = Clamp01((raw + 6.0f) / 12.0f + bias);
+        if(gain > 0.01f && std::fabs(gain - 1.0f) > 0.001f)
+        {
+            v = std::pow(v, gain);
+        }
+        return Clamp01(v);
+    };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        // Shift so the effect/ref origin sits at 0.5.
+        const float c2 = Clamp01(row.y01 - origin01.y + 0.5f);
+        const float c3 = Clamp01(row.z01 - origin01.z + 0.5f);
+        for(int x = 0; x < row.count; x++)
+        {
+            const float c1 = Clamp01(row.x01[x] - origin01.x + 0.5f);
+            float v = 0.5f;
+            if(pattern == 0)
+            {
+                v = std::sin((c1 + prog * 2.0f) * fs * 10.0f) + std::sin((c2 + prog * 1.7f) * fs * 8.0f) +
+                    std::sin((c1 + c2 + prog * 1.3f) * fs * 6.0f) + std::cos((c1 - c2 + prog * 2.2f) * fs * 7.0f) +
+                    std::sin(std::sqrt(c1 * c1 + c2 * c2) * fs * 5.0f + prog * 1.5f) +
+                    std::cos(c3 * fs * 4.0f + prog * 0.9f);
+                v = finalize(v, 0.0f, 1.12f);
+            }
+            else if(pattern == 1)
+            {
+                const float angle = std::atan2(c2 - 0.5f, c1 - 0.5f);
+                const float radius = std::hypot(c1 - 0.5f, c2 - 0.5f);
+                v = std::sin(angle * 4.0f + radius * fs * 9.5f + prog * 2.4f) +
+                    std::sin(angle * 3.0f - radius * fs * 7.0f + prog * 1.8f) +
+                    std::cos(angle * 6.0f + radius * fs * 4.5f - prog * 2.1f) + std::sin(c3 * fs * 5.5f + prog) +
+                    std::cos((angle * 2.0f + c3 * fs * 3.5f) + prog * 1.4f);
+                v = finalize(v, -0.04f, 1.38f);
+            }
+            else if(pattern == 2)
+            {
+                const float dist = std::hypot(c1 - 0.5f, c2 - 0.5f);
+                v = std::sin(dist * fs * 12.0f - prog * 3.4f) + std::sin(dist * fs * 18.0f - prog * 2.6f) +
+                    std::cos(dist * fs * 9.0f + prog * 2.0f) + std::sin((c1 + c2) * fs * 5.0f + prog * 1.0f) * 0.45f +
+                    std::cos(c3 * fs * 4.0f - prog * 0.6f) * 0.35f;
+                v = finalize(v, 0.02f, 1.28f);
+            }
+            else if(pattern == 3)
+            {
+                const float flow1 = std::sin(c1 * fs * 8.0f + std::sin(c2 * fs * 12.0f + prog) + prog * 0.5f);
+                const float flow2 = std::cos(c2 * fs * 9.0f + std::cos(c3 * fs * 11.0f + prog * 1.3f));
+                const float flow3 = std::sin(c3 * fs * 7.0f + std::sin(c1 * fs * 13.0f + prog * 0.7f));
+                const float flow4 = std::cos((c1 + c2) * fs * 6.0f + std::sin(prog * 1.5f));
+                const float flow5 = std::sin((c2 + c3) * fs * 5.0f + std::cos(prog * 1.8f));
+                v = finalize(flow1 + flow2 + flow3 + flow4 + flow5, 0.06f, 0.88f);
+            }
+            else if(pattern == 4)
+            {
+                const float n1 = std::sin((c1 + prog * 0.5f) * fs * 40.0f) * std::sin((c2 + prog * 0.3f) * fs * 52.0f) *
+                                 std::sin((c3 + prog * 0.7f) * fs * 31.0f);
+                const float n2 = std::sin((c1 * 2.3f + c2 + prog) * fs * 20.0f) *
+                                 std::cos((c2 * 1.7f + c3 + prog * 1.2f) * fs * 25.0f);
+                const float n3 = std::cos((c1 + c2 * 2.1f + c3) * fs * 15.0f + prog * 2.0f);
+                v = finalize(n1 * 0.5f + n2 * 0.35f + n3 * 0.15f, -0.02f, 1.55f);
+            }
+            else if(pattern == 5)
+            {
+                const float y = c2 - prog * 0.55f;
+                const float turb = 0.18f * std::sin((c1 * 3.1f + c3 * 2.7f) * fs * 8.0f + prog * 4.0f);
+                const float xw = c1 + turb * std::sin(y * fs * 10.0f + prog * 2.0f);
+                const float zw = c3 + turb * std::cos(y * fs * 9.0f - prog * 1.7f);
+                const float tongues = std::sin(xw * fs * 14.0f + prog * 3.2f) + std::cos(zw * fs * 12.0f - prog * 2.4f) +
+                                      0.7f * std::sin((xw + zw) * fs * 9.0f + y * fs * 16.0f - prog * 5.0f) +
+                                      0.5f * std::cos(y * fs * 18.0f + prog * 1.5f);
+                const float floor_heat = std::pow(Clamp01(1.0f - c2), 0.55f);
+                v = tongues * (0.35f + 0.65f * floor_heat) + 1.25f * floor_heat;
+                v = std::pow(Clamp01((v + 3.0f) / 6.0f), 0.72f);
+            }
+            else
+            {
+                const float r = std::sqrt((c1 - 0.5f) * (c1 - 0.5f) + (c2 - 0.5f) * (c2 - 0.5f) + (c3 - 0.5f) * (c3 - 0.5f));
+                v = std::sin(r * fs * 30.0f - prog * 2.0f) + std::sin((c1 + c2) * fs * 20.0f + prog * 1.5f) * 0.6f +
+                    std::cos((c2 + c3) * fs * 18.0f - prog * 1.2f) * 0.5f + std::sin(c3 * fs * 25.0f + prog * 0.8f) * 0.4f;
+                v = finalize(v, 0.0f, 1.2f);
+            }
+
+            rgb[x * 3 + 0] = v;
+            rgb[x * 3 + 1] = v;
+            rgb[x * 3 + 2] = v;
+        }
+    };
+}
+
+/** Everything CalculateColorGrid derives from settings / grid / time, resolved once per batch. */
+struct Plasma::SampleFrame
+{
+    Vector3D origin{};
+    float boundary_radius_sq = 0.0f;
+    float rate = 0.0f;
+    float progress = 0.0f;
+    float size_multiplier = 1.0f;
+    float origin_y01 = 0.5f;
+    float max_radius = 0.0f;
+    bool volume_available = false;
+    bool strip_colormap = false;
+    bool rainbow = false;
+    SpatialLayerCore::MapperSettings strat_map;
+    SpatialLayerCore::Basis basis;
+    SpatialLayerCore::MapperSettings map;
+};
+
+Plasma::SampleFrame Plasma::MakeSampleFrame(float time, const GridContext3D& grid) const
+{
+    SampleFrame f;
+    f.origin = GetEffectOriginGrid(grid);
+    f.boundary_radius_sq = EffectBoundaryRadiusSq(grid);
+    f.rate = GetScaledFrequency();
+    const float detail = std::max(0.05f, GetScaledDetail());
+    f.progress = CalculateProgress(time);
+    f.size_multiplier = GetNormalizedSize();
+    {
+        float ox = 0.5f, oz = 0.5f;
+        PackEffectOrigin01(grid, f.origin, &ox, &f.origin_y01, &oz);
+    }
+    f.max_radius = EffectGridMedianHalfExtent(grid, GetNormalizedScale()) * 1.7320508f;
+    f.volume_available = volume_assist_.isAvailable();
+    f.strip_colormap = UseEffectStripColormap();
+    f.rainbow = GetRainbowMode();
+    EffectStratumBlend::InitStratumBreaks(f.strat_map);
+    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), f.basis);
+    EffectStratumBlend::InitStratumBreaks(f.map);
+    f.map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
+    f.map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
+    f.map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
+    return f;
+}
+
+void Plasma::ShadeSample(const SampleFrame& f,
+                         float x,
+                         float y,
+                         float z,
+                         float time,
+                         const GridContext3D& grid,
+                         PaletteSample& s) const
 {
-    Vector3D origin = GetEffectOriginGrid(grid);
+    const Vector3D& origin = f.origin;
     float rel_x = x - origin.x;
     float rel_y = y - origin.y;
     float rel_z = z - origin.z;
 
-    if(!IsWithinEffectBoundary(rel_x, rel_y, rel_z, grid))
+    if(rel_x * rel_x + rel_y * rel_y + rel_z * rel_z > f.boundary_radius_sq)
     {
-        return 0x00000000;
+        return;
     }
 
-    float rate = GetScaledFrequency();
-    float detail = std::max(0.05f, GetScaledDetail());
-    progress = CalculateProgress(time);
-
-    float size_multiplier = GetNormalizedSize();
-
     Vector3D rotated_pos{x, y, z};
-    float rot_rel_x = rotated_pos.x - origin.x;
-    float rot_rel_y = rotated_pos.y - origin.y;
-    float rot_rel_z = rotated_pos.z - origin.z;
 
     float n1 = NormalizeGridAxis01(rotated_pos.x, grid.min_x, grid.max_x);
     float n2 = NormalizeGridAxis01(rotated_pos.y, grid.min_y, grid.max_y);
     float n3 = NormalizeGridAxis01(rotated_pos.z, grid.min_z, grid.max_z);
-    float oy = 0.5f;
-    {
-        float ox = 0.5f, oz = 0.5f;
-        PackEffectOrigin01(grid, origin, &ox, &oy, &oz);
-    }
-    float coord2 = std::clamp(n2 - oy + 0.5f, 0.0f, 1.0f);
+    float coord2 = std::clamp(n2 - f.origin_y01 + 0.5f, 0.0f, 1.0f);
 
-    SpatialLayerCore::MapperSettings strat_map;
-    EffectStratumBlend::InitStratumBreaks(strat_map);
     float stratum_w[3];
-    EffectStratumBlend::WeightsForYNorm(coord2, strat_map, stratum_w);
+    EffectStratumBlend::WeightsForYNorm(coord2, f.strat_map, stratum_w);
     const EffectStratumBlend::BandBlendScalars bb =
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), stratum_w, GetStratumTuning());
     const float stratum_mot01 =
         ComputeStratumMotion01(stratum_w, grid, x, y, z, origin, time);
-    const float prog = progress * bb.speed_mul;
+    const float prog = f.progress * bb.speed_mul;
     const float pshift = EffectStratumBlend::PhaseShift01(bb);
 
     float plasma_value = 0.0f;
-    if(volume_assist_.isAvailable())
+    if(f.volume_available)
     {
         /* GLSL already centers on origin — sample room 01 + stratum phase only. */
         const float g1 = std::fmod(n1 + pshift + 1.0f, 1.0f);
@@ -197,24 +333,15 @@ RGBColor Plasma::CalculateColorGrid(float x, float y, float z, float time, const
     }
     plasma_value = EffectStratumBlend::ApplyMotionToUnit01(plasma_value, stratum_mot01, 0.28f);
 
-    float radial_distance = sqrtf(rot_rel_x*rot_rel_x + rot_rel_y*rot_rel_y + rot_rel_z*rot_rel_z);
-    float max_radius = EffectGridMedianHalfExtent(grid, GetNormalizedScale()) * 1.7320508f;
+    float radial_distance = sqrtf(rel_x*rel_x + rel_y*rel_y + rel_z*rel_z);
     float depth_factor = 1.0f;
-    if(max_radius > 0.001f)
+    if(f.max_radius > 0.001f)
     {
-        float normalized_dist = fmin(1.0f, radial_distance / max_radius);
+        float normalized_dist = fmin(1.0f, radial_distance / f.max_radius);
         depth_factor = 0.45f + 0.55f * (1.0f - normalized_dist * 0.6f);
     }
 
-    RGBColor final_color;
-    SpatialLayerCore::Basis basis;
-    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), basis);
-    SpatialLayerCore::MapperSettings map;
-    EffectStratumBlend::InitStratumBreaks(map);
-    map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
-    map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
-    map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
-
+    s.gain = depth_factor;
     SpatialLayerCore::SamplePoint sp{};
     sp.grid_x = x;
     sp.grid_y = y;
@@ -224,44 +351,44 @@ RGBColor Plasma::CalculateColorGrid(float x, float y, float z, float time, const
     sp.origin_z = origin.z;
     sp.y_norm = coord2;
 
-    const float phase01 = std::fmod(prog + pshift + 1.0f, 1.0f);
-    float strip_p01 = 0.0f;
-    if(UseEffectStripColormap())
+    if(f.strip_colormap)
     {
-        strip_p01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
-                                                 GetEffectStripColormapRepeats(),
-                                                 GetEffectStripColormapUnfold(),
-                                                 GetEffectStripColormapDirectionDeg(),
-                                                 phase01,
-                                                 time,
-                                                 grid,
-                                                 size_multiplier,
-                                                 origin,
-                                                 rotated_pos);
+        const float phase01 = std::fmod(prog + pshift + 1.0f, 1.0f);
+        float p01v = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
+                                                GetEffectStripColormapRepeats(),
+                                                GetEffectStripColormapUnfold(),
+                                                GetEffectStripColormapDirectionDeg(),
+                                                phase01,
+                                                time,
+                                                grid,
+                                                f.size_multiplier,
+                                                origin,
+                                                rotated_pos);
+        s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
     }
-
-    if(UseEffectStripColormap())
+    else if(f.rainbow)
     {
-        float p01v = strip_p01;
-        final_color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
-    }
-    else if(GetRainbowMode())
-    {
-        float hue = plasma_value * 360.0f + time * rate * 12.0f;
-        hue = ApplySpatialRainbowHue(hue, plasma_value, basis, sp, map, time, &grid);
+        float hue = plasma_value * 360.0f + time * f.rate * 12.0f;
+        hue = ApplySpatialRainbowHue(hue, plasma_value, f.basis, sp, f.map, time, &grid);
         float p01 = std::fmod(hue / 360.0f, 1.0f);
         if(p01 < 0.0f)
         {
             p01 += 1.0f;
         }
-        final_color = GetRainbowColor(p01 * 360.0f);
+        s.lookup = PaletteSample::HUE;
+        s.key = p01 * 360.0f;
     }
     else
     {
-        float p = ApplySpatialPalette01(plasma_value, basis, sp, map, time, &grid);
-        final_color = GetColorAtPosition(p);
+        s.lookup = PaletteSample::PALETTE;
+        s.key = ApplySpatialPalette01(plasma_value, f.basis, sp, f.map, time, &grid);
     }
+}
 
+RGBColor Plasma::FinishSample(const PaletteSample& s)
+{
+    const RGBColor final_color = s.color;
+    const float depth_factor = s.gain;
     unsigned char r = final_color & 0xFF;
     unsigned char g = (final_color >> 8) & 0xFF;
     unsigned char b = (final_color >> 16) & 0xFF;
@@ -271,6 +398,30 @@ RGBColor Plasma::CalculateColorGrid(float x, float y, float z, float time, const
     return (b << 16) | (g << 8) | r;
 }
 
+RGBColor Plasma::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+{
+    PaletteSample s;
+    ShadeSample(MakeSampleFrame(time, grid), x, y, z, time, grid, s);
+    ResolvePaletteSamples(&s, 1);
+    return FinishSample(s);
+}
+
+void Plasma::CalculateColorGridBatch(const float* xs,
+                                     const float* ys,
+                                     const float* zs,
+                                     size_t count,
+                                     float time,
+                                     const GridContext3D& grid,
+                                     RGBColor* out)
+{
+    const SampleFrame f = MakeSampleFrame(time, grid);
+    ShadePaletteBatch(
+        count,
+        out,
+        [&](size_t i, PaletteSample& s) { ShadeSample(f, xs[i], ys[i], zs[i], time, grid, s); },
+        &Plasma::FinishSample);
+}
+
 nlohmann::json Plasma::SaveSettings() const
 {
     nlohmann::json j = SpatialEffect3D::SaveSettings();
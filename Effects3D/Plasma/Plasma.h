@@ -24,6 +24,8 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool SupportsConcurrentEvaluation() const override { return true; }
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
@@ -31,10 +33,33 @@ public:
 private slots:
     void OnPlasmaParameterChanged();
 
+protected:
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+
 private:
+    struct SampleFrame;
+    SampleFrame MakeSampleFrame(float time, const GridContext3D& grid) const;
+    void ShadeSample(const SampleFrame& f,
+                     float x,
+                     float y,
+                     float z,
+                     float time,
+                     const GridContext3D& grid,
+                     PaletteSample& s) const;
+    /** Applies the sample's depth falloff once its palette lookup has resolved. */
+    static RGBColor FinishSample(const PaletteSample& s);
+
     QComboBox* pattern_combo = nullptr;
     int pattern_type = 0;
     float progress = 0.0f;
+    /** CPU port of PlasmaVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
@@ -2,6 +2,7 @@
 
 #include "PulseRing.h"
 #include "PulseRingVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "EffectHelpers.h"
 #include "SpatialLayerCore.h"
@@ -58,6 +59,7 @@ PulseRing::PulseRing(QWidget* parent) : SpatialEffect3D(parent)
     volume_assist_.setFragmentBody(QString::fromUtf8(PulseRingVolumeFieldGlsl()));
     // Hex/square corners need enough voxels, but 28×28×28 was a major frame cost.
     volume_assist_.setResolution(20);
+    volume_assist_.setCpuField(&PulseRing::BuildCpuRows);
 }
 
 EffectInfo3D PulseRing::GetEffectInfo() const
@@ -210,6 +212,92 @@ void PulseRing::PrepareGpuFields(std::uint64_t render_sequence, float time_sec,
     volume_assist_.prepare(render_sequence, time_sec, vp, 13);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn PulseRing::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float progress = u[0];
+    const float hole_r = std::clamp(u[1], 0.0f, 0.7f);
+    const float sigma = std::max(u[2], 0.01f);
+    const float amp = std::clamp(u[3], 0.2f, 2.0f);
+    const float detail = std::clamp(u[4], 0.05f, 1.0f);
+    const int style = (int)(u[5] + 0.5f);
+    const float phase_offset = u[6];
+    const int shape = (int)(std::clamp(u[7], 0.0f, 4.0f) + 0.5f);
+    const float size_scale = std::clamp(u[8], 0.25f, 2.5f);
+    const float hue_scroll = Fract(u[9]);
+    const Vec3 origin01 = Clamp01(Vec3(u[10], u[11], u[12]));
+
+    const float inv_size = 1.0f / std::max(size_scale, 0.25f);
+    const float usable = std::max(0.12f, 1.0f - hole_r);
+    const float half_w = std::max(0.010f, sigma * Mix(0.55f, 0.18f, detail));
+    const float y_half = Mix(0.28f, 0.07f, detail);
+    const float center = hole_r + Fract(progress + phase_offset) * usable;
+
+    // footprintXZ from PulseRingVolumeFieldGlsl: hex, triangle, square or circle metric.
+    auto footprint = [shape](float px, float pz) {
+        if(shape == 2)
+        {
+            return std::max(std::fabs(px) * 0.5f + std::fabs(pz) * 0.8660254f, std::fabs(px)) / 0.8660254f;
+        }
+        if(shape == 3)
+        {
+            const float an = TWO_PI / 3.0f;
+            const float a = std::atan2(pz, px);
+            const float poly = std::cos(std::floor(0.5f + a / an) * an - a) * std::hypot(px, pz);
+            return std::max(poly / 0.5f, 0.0f);
+        }
+        if(shape == 4)
+        {
+            return std::max(std::fabs(px), std::fabs(pz));
+        }
+        return std::hypot(px, pz);
+    };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float py = (row.y01 - origin01.y) * 2.0f;
+        const float pz = (row.z01 - origin01.z) * 2.0f;
+        const float slab = 1.0f - Smoothstep(y_half, y_half + 0.035f, std::fabs(py));
+        for(int x = 0; x < row.count; x++)
+        {
+            const float px = (row.x01[x] - origin01.x) * 2.0f;
+            float d = 0.0f;
+            float height_mul = 1.0f;
+            if(shape == 1)
+            {
+                d = std::sqrt(px * px + py * py + pz * pz) * inv_size;
+            }
+            else
+            {
+                d = footprint(px, pz) * inv_size;
+                height_mul = slab;
+            }
+
+            float intensity = 0.0f;
+            float color_drv = 0.0f;
+            if(style == 1)
+            {
+                const float fill = Smoothstep(hole_r - 0.02f, hole_r + 0.01f, d);
+                const float outer = 1.0f - Smoothstep(1.02f, 1.20f, d);
+                intensity = fill * outer * height_mul;
+                color_drv = Fract(std::atan2(pz, px) / TWO_PI + 0.5f + hue_scroll);
+            }
+            else
+            {
+                float band = 1.0f - Smoothstep(0.0f, std::max(half_w, 0.008f), std::fabs(d - center));
+                band *= band;
+                intensity = band * height_mul * Smoothstep(hole_r - 0.03f, hole_r + 0.01f, d) * amp;
+                color_drv = Fract(Clamp01((d - hole_r) / usable) * 0.85f + hue_scroll);
+            }
+
+            rgb[x * 3 + 0] = Clamp01(intensity);
+            rgb[x * 3 + 1] = color_drv;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
 RGBColor PulseRing::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
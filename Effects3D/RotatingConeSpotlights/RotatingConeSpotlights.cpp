@@ -2,6 +2,7 @@
 
 #include "RotatingConeSpotlights.h"
 #include "RotatingConeVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectHelpers.h"
 #include "SpatialKernelColormap.h"
 #include <QColor>
@@ -326,6 +327,7 @@ RotatingConeSpotlights::RotatingConeSpotlights(QWidget* parent) : SpatialEffect3
     SetRainbowMode(false);
     volume_assist_.setFragmentBody(QString::fromUtf8(RotatingConeVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&RotatingConeSpotlights::BuildCpuRows);
     ApplyLayoutPreset(LAYOUT_AUTO);
 }
 
@@ -576,6 +578,160 @@ void RotatingConeSpotlights::PrepareGpuFields(std::uint64_t render_sequence, flo
     volume_assist_.prepare(render_sequence, time_sec, vp, 16);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn RotatingConeSpotlights::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* p = ctx.params;
+    const float spin_t = p[0];
+    const float scale = std::max(p[1], 1e-5f);
+    const float hue_static = p[2];
+    const int count = (int)(std::clamp(p[3], 1.0f, 4.0f) + 0.5f);
+    const int motion_mode = (int)(Clamp01(p[4]) + 0.5f);
+    const int surface = (int)(std::clamp(p[5], 0.0f, 4.0f) + 0.5f);
+
+    float wander = 1.0f;
+    float elev_bias = 0.0f;
+    Vec3 ref_o(0.5f);
+    if(surface == 1)
+    {
+        wander = std::clamp(std::floor(p[14]) / 100.0f, 0.15f, 2.0f);
+        ref_o = Vec3(Clamp01(Fract(p[14])), Clamp01(std::floor(p[15]) / 4095.0f), Clamp01(Fract(p[15])));
+    }
+    else
+    {
+        wander = std::clamp(p[14], 0.15f, 2.0f);
+        elev_bias = std::clamp(p[15], -1.2f, 1.2f);
+    }
+    if(surface == 2)
+    {
+        elev_bias = -0.55f;
+    }
+    else if(surface == 3)
+    {
+        elev_bias = 0.55f;
+    }
+    else if(surface == 4)
+    {
+        elev_bias = 0.0f;
+    }
+
+    // Apex and aim only depend on time: build each cone's frame once per bake.
+    struct Cone
+    {
+        Vec3 apex;
+        Vec3 ax;
+        Vec3 ay;
+        Vec3 az;
+        float hue01;
+    };
+    std::vector<Cone> cones;
+    cones.reserve((size_t)count);
+    for(int i = 0; i < count; i++)
+    {
+        // resolveApex
+        const float uu = Clamp01(p[6 + i * 2]);
+        const float vv = Clamp01(p[7 + i * 2]);
+        Vec3 apex;
+        if(surface == 0)
+        {
+            apex = Vec3(Mix(0.12f, 0.88f, uu), 0.5f, Mix(0.12f, 0.88f, vv));
+        }
+        else if(surface == 1)
+        {
+            const Vec3 o(std::clamp(ref_o.x, 0.05f, 0.95f), std::clamp(ref_o.y, 0.05f, 0.95f), std::clamp(ref_o.z, 0.05f, 0.95f));
+            apex = Vec3(std::clamp(o.x + (uu - 0.5f) * 0.70f, 0.05f, 0.95f), o.y, std::clamp(o.z + (vv - 0.5f) * 0.70f, 0.05f, 0.95f));
+        }
+        else if(surface == 2)
+        {
+            apex = Vec3(Mix(0.10f, 0.90f, uu), 0.92f, Mix(0.10f, 0.90f, vv));
+        }
+        else if(surface == 3)
+        {
+            apex = Vec3(Mix(0.10f, 0.90f, uu), 0.08f, Mix(0.10f, 0.90f, vv));
+        }
+        else
+        {
+            // Walls: U = angle around perimeter, V = height.
+            const float ang = uu * TWO_PI;
+            apex = Vec3(0.5f + 0.46f * std::cos(ang), Mix(0.12f, 0.88f, vv), 0.5f + 0.46f * std::sin(ang));
+        }
+
+        // aimWander: followers mirror their pair leader in Opposite mode.
+        const int pair = (i / 2) * 2;
+        const bool is_follower = motion_mode > 0 && i != pair && !(count == 3 && i == 2);
+        const int src = is_follower ? pair : i;
+        const float seed = (float)src * 1.6180339f;
+        const float t = spin_t * (0.55f + 0.22f * (float)src) + seed * 2.3999632f;
+        float yaw = t + wander * 0.85f * std::sin(t * 0.73f + seed * 4.1f) + wander * 0.45f * std::sin(t * 1.37f + seed * 2.7f) +
+                    wander * 0.25f * std::sin(t * 2.11f + seed);
+        float pitch = elev_bias + wander * 0.55f * std::sin(t * 0.91f + seed * 3.3f) + wander * 0.35f * std::sin(t * 1.67f + seed * 1.9f);
+        if(is_follower)
+        {
+            yaw += (float)M_PI;
+            pitch = elev_bias - (pitch - elev_bias);
+        }
+        pitch = std::clamp(pitch, -1.35f, 1.35f);
+        const float cp = std::cos(pitch);
+        Vec3 aim = Normalize(Vec3(std::cos(yaw) * cp, std::sin(pitch), std::sin(yaw) * cp));
+
+        if(surface == 4)
+        {
+            aim = Normalize(Mix(Normalize(Vec3(0.5f) - apex), aim, 0.65f));
+        }
+        else if(surface == 2)
+        {
+            aim = Normalize(Mix(Vec3(0.0f, -1.0f, 0.0f), aim, 0.70f));
+        }
+        else if(surface == 3)
+        {
+            aim = Normalize(Mix(Vec3(0.0f, 1.0f, 0.0f), aim, 0.70f));
+        }
+
+        // coneLocal basis
+        Vec3 az = aim;
+        const float len = Length(az);
+        az = len < 1e-5f ? Vec3(0.0f, 0.0f, 1.0f) : az / Vec3(len);
+        const Vec3 up = std::fabs(az.y) < 0.92f ? Vec3(0.0f, 1.0f, 0.0f) : Vec3(1.0f, 0.0f, 0.0f);
+        const Vec3 ax = Normalize(Cross(up, az));
+        const Vec3 ay = Cross(az, ax);
+        cones.push_back({apex, ax, ay, az, Fract(hue_static + (float)i / (float)std::max(count, 1) + 0.07f * apex.x)});
+    }
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 p01(row.x01[x], row.y01, row.z01);
+            float best_sat = 0.0f;
+            float best_val = 0.0f;
+            float best_h = 0.0f;
+            for(const Cone& c : cones)
+            {
+                const Vec3 d = p01 - c.apex;
+                const float lz = Dot(d, c.az);
+                if(lz <= 0.0f)
+                {
+                    continue;
+                }
+                const float lx = Dot(d, c.ax);
+                const float ly = Dot(d, c.ay);
+                const float dist = std::clamp(lz - std::sqrt((lx * lx + ly * ly) / scale), -1.0f, 1.0f);
+                const float sat = Clamp01(1.0f - dist);
+                if(sat > best_sat)
+                {
+                    const float lift = std::max(0.0f, 1.0f + dist);
+                    best_sat = sat;
+                    best_val = Clamp01(lift * lift * lift * lift);
+                    best_h = c.hue01;
+                }
+            }
+            rgb[x * 3 + 0] = best_sat;
+            rgb[x * 3 + 1] = best_val;
+            rgb[x * 3 + 2] = best_h;
+        }
+    };
+}
+
 RGBColor RotatingConeSpotlights::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     Vector3D origin = GetEffectOriginGrid(grid);
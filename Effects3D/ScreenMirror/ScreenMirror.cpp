@@ -18,6 +18,7 @@
 #include <QFont>
 #include <QPushButton>
 #include <algorithm>
+#include <mutex>
 
 REGISTER_EFFECT_3D(ScreenMirror);
 
@@ -282,6 +283,7 @@ void ScreenMirror::SetupCustomUI(QWidget* parent)
                 new_settings.reference_point_id = plane_ref_id;
             }
             new_settings.enabled = DefaultMonitorEnabledForPlane(plane);
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
             settings_it = monitor_settings.emplace(plane_name, new_settings).first;
         }
         MonitorSettings& settings = settings_it->second;
@@ -355,6 +357,7 @@ void ScreenMirror::OnCalibrationPatternChanged()
 
 bool ScreenMirror::ShouldShowCalibrationPattern(const std::string& plane_name) const
 {
+    std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
     std::map<std::string, MonitorSettings>::const_iterator it = monitor_settings.find(plane_name);
     if(it != monitor_settings.end())
     {
@@ -367,6 +370,7 @@ bool ScreenMirror::ShouldShowCalibrationPattern(const std::string& plane_name) c
 
 bool ScreenMirror::ShouldShowScreenPreview(const std::string& plane_name) const
 {
+    std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
     std::map<std::string, MonitorSettings>::const_iterator it = monitor_settings.find(plane_name);
     if(it != monitor_settings.end())
     {
@@ -399,7 +403,18 @@ void ScreenMirror::CreateMonitorSettingsUI(DisplayPlane3D* plane, MonitorSetting
     settings.group_box->setToolTip(has_capture_source
                                       ? QStringLiteral("Enable or disable this monitor's influence.")
                                       : QStringLiteral("This monitor needs a capture source assigned in Display Plane settings."));
-    connect(settings.group_box, &QGroupBox::toggled, this, &ScreenMirror::OnParameterChanged);
+    const std::string plane_name = plane->GetName();
+    connect(settings.group_box, &QGroupBox::toggled, this, [this, plane_name](bool on) {
+        {
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+            std::map<std::string, MonitorSettings>::iterator it = monitor_settings.find(plane_name);
+            if(it != monitor_settings.end())
+            {
+                it->second.enabled = on;
+            }
+        }
+        OnParameterChanged();
+    });
 
     auto* panel = new ScreenMirrorMonitorPanel(settings.group_box);
     panel->initialize(this, settings, plane, has_capture_source);
@@ -449,6 +464,7 @@ void ScreenMirror::RefreshMonitorStatus()
                 new_settings.reference_point_id = plane_ref_id;
             }
             new_settings.enabled = DefaultMonitorEnabledForPlane(plane);
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
             settings_it = monitor_settings.emplace(plane_name, new_settings).first;
         }
         MonitorSettings& settings = settings_it->second;
@@ -37,6 +37,15 @@ public:
     EffectInfo3D GetEffectInfo() const override;
     void SetupCustomUI(QWidget* parent) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    /** Refreshes the frame cache and sampling plan once for the whole batch. */
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+    void PrepareRenderSnapshot() override;
     bool UsesSpatialSamplingQuantization() const override { return false; }
     bool RequiresWorldSpaceCoordinates() const override { return true; }
     bool RequiresWorldSpaceGridBounds() const override { return true; }
@@ -333,6 +342,8 @@ private:
     uint64_t                                                             frame_cache_refresh_ms_;
     uint64_t                                                             frame_cache_last_render_seq_;
     std::unordered_map<std::string, std::shared_ptr<CapturedFrame>>      frame_cache_;
+    /** Capture id -> ScreenCaptureManager handle, resolved once per id. */
+    std::unordered_map<std::string, CaptureSourceHandle>                 capture_handles_;
     std::vector<DisplayPlane3D*>                                         frame_cache_planes_;
 
     struct LEDKey
@@ -347,6 +358,21 @@ private:
             if(y != other.y) return y < other.y;
             return z < other.z;
         }
+        bool operator==(const LEDKey& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct LEDKeyHash
+    {
+        size_t operator()(const LEDKey& key) const
+        {
+            uint64_t h = (uint64_t)(uint32_t)key.x * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t)(uint32_t)key.y * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+            h ^= (uint64_t)(uint32_t)key.z * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+            return (size_t)h;
+        }
     };
 
     struct LEDState
@@ -354,7 +380,90 @@ private:
         float r, g, b;
         uint64_t smooth_last_tick_ms;
     };
-    std::map<LEDKey, LEDState> led_states;
+
+    /** One enabled monitor in the sampling plan; sample-time settings are re-read each frame. */
+    struct SamplingPlanMonitor
+    {
+        const MonitorSettings* settings = nullptr;
+        DisplayPlane3D* plane = nullptr;
+        std::string capture_id;
+        bool use_calibration_pattern = false;
+        /** Wave propagation on: taps pick a delayed frame from capture_history. */
+        bool use_wave = false;
+        Vector3D falloff_ref{};
+        float reference_max_distance_mm = 0.0f;
+
+        /* Resolved once per frame. */
+        bool active = false;
+        std::shared_ptr<CapturedFrame> frame;
+        const std::deque<std::shared_ptr<CapturedFrame>>* history = nullptr;
+        float avg_frame_time_ms = 16.67f;
+        float u_min = 0.0f, u_max = 1.0f;
+        float v_min = 0.0f, v_max = 1.0f;
+        float corner_blend_strength_01 = 0.0f;
+        float corner_blend_zone_01 = 0.0f;
+    };
+
+    /** A (LED, monitor) pair that survived projection, capture-zone and falloff culling. */
+    struct SamplingPlanTap
+    {
+        unsigned int monitor;
+        /** Radial-mapped and rolled, before the black-bar window. */
+        float u;
+        float v;
+        /** Distance falloff x wave envelope x directional balance. */
+        float weight;
+        float delay_ms;
+    };
+
+    struct SamplingPlanLed
+    {
+        /** Plan epoch the taps were compiled for; stale LEDs recompile on their next sample. */
+        uint64_t epoch = 0;
+        unsigned int first_tap = 0;
+        unsigned int tap_count = 0;
+        LEDState smoothing{0.0f, 0.0f, 0.0f, 0};
+    };
+
+    /**
+     * Per-LED projection / weighting, compiled when an LED is first sampled in a plan epoch.
+     * The epoch moves only when the signature (planes, monitor geometry settings, reference
+     * points, grid) changes, so sampling a frame is a gather over the taps and the captured
+     * frames with no allocation or string lookups.
+     */
+    struct SamplingPlan
+    {
+        uint64_t epoch = 0;
+        std::vector<uint64_t> signature;
+        uint64_t render_sequence = 0;
+        /** frame_cache_refresh_ms_ the plan was resolved against; keys unsequenced (render_sequence 0) reuse. */
+        uint64_t frame_cache_refresh_ms = 0;
+        float grid_key[7] = {};
+        Vector3D grid_anchor_ref{};
+        float scale_mm = 0.0f;
+        std::vector<SamplingPlanMonitor> monitors;
+        std::vector<SamplingPlanTap> taps;
+        std::vector<SamplingPlanLed> leds;
+        std::unordered_map<LEDKey, unsigned int, LEDKeyHash> led_index;
+        /** -1 = not yet checked this frame. */
+        int any_capturing = -1;
+    };
+
+    struct SamplingContribution
+    {
+        unsigned int monitor;
+        float u;
+        float v;
+        float weight;
+        const CapturedFrame* frame;
+        const CapturedFrame* frame_blend;
+        float blend_t;
+    };
+
+    SamplingPlan sampling_plan_;
+    std::vector<uint64_t> sampling_signature_scratch_;
+    std::vector<SamplingContribution> sampling_contributions_;
+    std::vector<float> sampling_contribution_rgbw_;
 
     bool ResolveReferencePointById(int id, Vector3D& out) const;
     int LookupReferencePointIdByIndex(int index) const;
@@ -362,10 +471,12 @@ private:
     float GetHistoryRetentionMs() const;
     LEDKey MakeLEDKey(float x, float y, float z) const;
 
-    RGBColor CalculateColorGridInternal(float x, float y, float z, float time, const GridContext3D& grid,
-                                       const std::unordered_map<std::string, std::shared_ptr<CapturedFrame>>* frame_cache,
-                                       const std::vector<DisplayPlane3D*>* pre_fetched_planes = nullptr,
-                                       bool apply_led_smoothing = true);
+    void PrepareSamplingPlan(const GridContext3D& grid);
+    void BuildSamplingPlanSignature(const GridContext3D& grid, const Vector3D& anchor, std::vector<uint64_t>& out);
+    void CompileSamplingPlanMonitors(const GridContext3D& grid, const Vector3D& anchor);
+    void ResolveSamplingPlanFrame();
+    void CompileSamplingPlanLed(SamplingPlanLed& led, const Vector3D& led_pos);
+    RGBColor SampleSamplingPlan(float x, float y, float z);
 };
 
 #endif
@@ -13,10 +13,12 @@
 
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <array>
 #include <limits>
 #include <functional>
+#include <iterator>
 #include <mutex>
 #include <unordered_set>
 #include <vector>
@@ -37,9 +39,49 @@ const uint8_t* GetCalibrationPatternBuffer(int& out_w, int& out_h)
 
 namespace
 {
+    /*---------------------------------------------------------*\
+    | With sampling resolution below 100 every LED reads one    |
+    | quantized cell; sample the pyramid level whose texel is   |
+    | about that cell so the read averages it instead of        |
+    | aliasing on a single full-resolution texel.               |
+    \*---------------------------------------------------------*/
+    inline void SelectFrameLevel(const CapturedFrame& frame, unsigned int samp,
+                                 const uint8_t*& out_data, int& out_w, int& out_h)
+    {
+        out_data = frame.data.data();
+        out_w = frame.width;
+        out_h = frame.height;
+        if(samp >= 100u || frame.mips.empty() || frame.mip_data.empty())
+        {
+            return;
+        }
+
+        const float q = samp / 100.0f;
+        const float steps_u = std::max(2.0f, 4.0f + q * q * (float)(std::max(2, frame.width) - 4));
+        const float steps_v = std::max(2.0f, 4.0f + q * q * (float)(std::max(2, frame.height) - 4));
+        const float texels_per_cell = std::min((float)frame.width / steps_u, (float)frame.height / steps_v);
+
+        size_t level = 0;
+        while(level < frame.mips.size() && texels_per_cell >= (float)(2u << level))
+        {
+            level++;
+        }
+        if(level == 0)
+        {
+            return;
+        }
+        const CaptureMipLevel& mip = frame.mips[level - 1];
+        out_data = frame.mip_data.data() + mip.offset;
+        out_w = mip.width;
+        out_h = mip.height;
+    }
+
+    /** quant_w/quant_h: level-0 size the sampling-resolution grid is derived from, so picking a mip does not move the cells. */
     inline RGBColor SampleFrameWithCornerBlend(const uint8_t* frame_data,
                                                int frame_w,
                                                int frame_h,
+                                               int quant_w,
+                                               int quant_h,
                                                float u_s,
                                                float v_s,
                                                float u_min,
@@ -58,7 +100,7 @@ namespace
         auto quant = [&](float& u, float& v) {
             if(samp < 100u)
             {
-                Geometry3D::QuantizeMediaUV01(u, v, frame_w, frame_h, samp);
+                Geometry3D::QuantizeMediaUV01(u, v, quant_w, quant_h, samp);
             }
         };
 
@@ -242,6 +284,10 @@ void ScreenMirror::RefreshFrameCacheForRenderSequence(const GridContext3D& grid)
         capture_mgr.Initialize();
     }
     capture_mgr.SetTargetFPS(120);
+    if(GetSamplingResolution() < 100u)
+    {
+        capture_mgr.RequestMipPyramid();
+    }
     int cap_w = 320, cap_h = 180;
     int q = std::clamp(capture_quality, 0, 7);
     if(q == 1) { cap_w = 480; cap_h = 270; }
@@ -263,7 +309,12 @@ void ScreenMirror::RefreshFrameCacheForRenderSequence(const GridContext3D& grid)
         {
             capture_mgr.StartCapture(capture_id);
         }
-        std::shared_ptr<CapturedFrame> frame = capture_mgr.GetLatestFrame(capture_id);
+        std::unordered_map<std::string, CaptureSourceHandle>::iterator handle_it = capture_handles_.find(capture_id);
+        if(handle_it == capture_handles_.end())
+        {
+            handle_it = capture_handles_.emplace(capture_id, capture_mgr.GetSourceHandle(capture_id)).first;
+        }
+        std::shared_ptr<CapturedFrame> frame = capture_mgr.GetLatestFrame(handle_it->second);
         if(frame && frame->valid && !frame->data.empty())
         {
             frame_cache_[capture_id] = frame;
@@ -287,180 +338,342 @@ void ScreenMirror::RefreshFrameCacheForRenderSequence(const GridContext3D& grid)
 
 RGBColor ScreenMirror::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
+    (void)time;
     RefreshFrameCacheForRenderSequence(grid);
-    return CalculateColorGridInternal(x, y, z, time, grid, &frame_cache_, &frame_cache_planes_);
+    PrepareSamplingPlan(grid);
+    return SampleSamplingPlan(x, y, z);
 }
 
-RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, float time, const GridContext3D& grid,
-                                                     const std::unordered_map<std::string, std::shared_ptr<CapturedFrame>>* frame_cache,
-                                                     const std::vector<DisplayPlane3D*>* pre_fetched_planes,
-                                                     bool apply_led_smoothing)
+void ScreenMirror::CalculateColorGridBatch(const float* xs,
+                                           const float* ys,
+                                           const float* zs,
+                                           size_t count,
+                                           float /*time*/,
+                                           const GridContext3D& grid,
+                                           RGBColor* out)
 {
-    (void)time;
-    std::vector<DisplayPlane3D*> all_planes;
-    if(pre_fetched_planes)
-        all_planes = *pre_fetched_planes;
-    else
-        all_planes = DisplayPlaneManager::instance()->GetDisplayPlanes();
+    RefreshFrameCacheForRenderSequence(grid);
+    PrepareSamplingPlan(grid);
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = SampleSamplingPlan(xs[i], ys[i], zs[i]);
+    }
+}
 
-    if(all_planes.empty())
+void ScreenMirror::PrepareRenderSnapshot()
+{
+    // Settings fix-ups the per-LED path used to repeat for every sample. Done here on the GUI
+    // thread so the worker never inserts into monitor_settings or a capture_zones list.
+    std::vector<DisplayPlane3D*> planes = DisplayPlaneManager::instance()->GetDisplayPlanes();
+    for(DisplayPlane3D* plane : planes)
     {
-        return ToRGBColor(0, 0, 0);
+        if(!plane) continue;
+        std::map<std::string, MonitorSettings>::iterator settings_it = monitor_settings.find(plane->GetName());
+        if(settings_it == monitor_settings.end())
+        {
+            settings_it = monitor_settings.emplace(plane->GetName(), MonitorSettings()).first;
+            settings_it->second.enabled = DefaultMonitorEnabledForPlane(plane);
+        }
+        std::vector<CaptureZone>& zones = settings_it->second.capture_zones;
+        if(zones.empty())
+        {
+            zones.push_back(CaptureZone(0.0f, 1.0f, 0.0f, 1.0f));
+        }
+        if(std::none_of(zones.begin(), zones.end(), [](const CaptureZone& zone) { return zone.enabled; }))
+        {
+            zones[0].enabled = true;
+        }
     }
+}
 
-    Vector3D led_pos = {x, y, z};
-    ScreenCaptureManager& capture_mgr = ScreenCaptureManager::Instance();
+void ScreenMirror::PrepareSamplingPlan(const GridContext3D& grid)
+{
+    SamplingPlan& plan = sampling_plan_;
+    const Vector3D anchor = GetReferencePointGrid(grid);
+    const float grid_key[7] = {grid.min_x, grid.max_x, grid.min_y, grid.max_y, grid.min_z, grid.max_z, grid.grid_scale_mm};
+    const bool same_grid = std::equal(std::begin(grid_key), std::end(grid_key), std::begin(plan.grid_key)) &&
+                           anchor.x == plan.grid_anchor_ref.x &&
+                           anchor.y == plan.grid_anchor_ref.y &&
+                           anchor.z == plan.grid_anchor_ref.z;
+    if(grid.render_sequence != 0 && grid.render_sequence == plan.render_sequence && same_grid)
+    {
+        return;
+    }
+    // Unsequenced callers sample per LED: the plan's inputs only move when the frame cache
+    // refreshes, so skip the signature rebuild until then.
+    if(grid.render_sequence == 0 && plan.render_sequence == 0 && plan.epoch != 0 && same_grid &&
+       plan.frame_cache_refresh_ms == frame_cache_refresh_ms_)
+    {
+        return;
+    }
+    plan.render_sequence = grid.render_sequence;
+    plan.frame_cache_refresh_ms = frame_cache_refresh_ms_;
+    std::copy(std::begin(grid_key), std::end(grid_key), std::begin(plan.grid_key));
+    plan.grid_anchor_ref = anchor;
 
-    struct MonitorContribution
+    BuildSamplingPlanSignature(grid, anchor, sampling_signature_scratch_);
+    if(plan.epoch == 0 || sampling_signature_scratch_ != plan.signature)
     {
-        DisplayPlane3D* plane;
-        Geometry3D::PlaneProjection proj;
-        std::shared_ptr<CapturedFrame> frame;
-        std::shared_ptr<CapturedFrame> frame_blend;
-        float blend_t;
-        float weight;
-        float blend;
-        float brightness_multiplier;
-        float brightness_threshold;
-        float white_rolloff;
-        float vibrance;
-        float led_output_gain_r;
-        float led_output_gain_g;
-        float led_output_gain_b;
-        float black_bar_letterbox_percent;
-        float black_bar_pillarbox_percent;
-        float smoothing_time_ms;
-        bool use_calibration_pattern;
-        float corner_blend_strength_01;
-        float corner_blend_zone_01;
+        plan.signature.swap(sampling_signature_scratch_);
+        CompileSamplingPlanMonitors(grid, anchor);
+    }
+    ResolveSamplingPlanFrame();
+}
+
+void ScreenMirror::BuildSamplingPlanSignature(const GridContext3D& grid, const Vector3D& anchor, std::vector<uint64_t>& out)
+{
+    out.clear();
+    auto push_f = [&out](float value) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        out.push_back(bits);
+    };
+    auto push_v = [&push_f](const Vector3D& value) {
+        push_f(value.x);
+        push_f(value.y);
+        push_f(value.z);
     };
 
-    std::vector<MonitorContribution> contributions;
-    contributions.reserve(all_planes.size());
-    Vector3D grid_anchor_ref = GetReferencePointGrid(grid);
+    push_f(grid.min_x); push_f(grid.max_x);
+    push_f(grid.min_y); push_f(grid.max_y);
+    push_f(grid.min_z); push_f(grid.max_z);
+    push_f(grid.grid_scale_mm);
+    push_v(anchor);
+
+    for(DisplayPlane3D* plane : frame_cache_planes_)
+    {
+        if(!plane) continue;
+        // Entries are created on the GUI thread (PrepareRenderSnapshot); a plane added since is skipped.
+        std::map<std::string, MonitorSettings>::const_iterator settings_it = monitor_settings.find(plane->GetName());
+        if(settings_it == monitor_settings.end()) continue;
+        const MonitorSettings& s = settings_it->second;
+        out.push_back((uint64_t)(uintptr_t)plane);
+        out.push_back((uint64_t)(uintptr_t)&s);
+        out.push_back((uint64_t)std::hash<std::string>()(plane->GetCaptureSourceId()));
+        const Transform3D& transform = plane->GetTransform();
+        push_v(transform.position);
+        push_f(transform.rotation.x); push_f(transform.rotation.y); push_f(transform.rotation.z);
+
+        const bool enabled = s.enabled;
+        out.push_back((enabled ? 1u : 0u) | (s.show_calibration_pattern ? 2u : 0u) | (s.scale_inverted ? 4u : 0u));
+        if(!enabled)
+        {
+            continue;
+        }
+        push_f(s.scale);
+        push_f(s.edge_softness);
+        push_f(s.falloff_curve_exponent);
+        push_f(s.propagation_speed_mm_per_ms);
+        push_f(s.wave_decay_ms);
+        push_f(s.wave_time_to_edge_sec);
+        push_f(s.front_back_balance);
+        push_f(s.left_right_balance);
+        push_f(s.top_bottom_balance);
+        push_f(s.screen_map_roll_deg);
+        out.push_back((uint64_t)(uint32_t)s.radial_corner_expansion_ui);
+        out.push_back((uint64_t)(uint32_t)s.radial_corner_bias_tl_ui);
+        out.push_back((uint64_t)(uint32_t)s.radial_corner_bias_tr_ui);
+        out.push_back((uint64_t)(uint32_t)s.radial_corner_bias_bl_ui);
+        out.push_back((uint64_t)(uint32_t)s.radial_corner_bias_br_ui);
+        out.push_back((uint64_t)(uint32_t)s.reference_point_id);
+        Vector3D custom_ref;
+        if(s.reference_point_id > 0 && ResolveReferencePointById(s.reference_point_id, custom_ref))
+        {
+            push_v(custom_ref);
+        }
+        out.push_back(s.capture_zones.size());
+        for(const CaptureZone& zone : s.capture_zones)
+        {
+            push_f(zone.u_min); push_f(zone.u_max);
+            push_f(zone.v_min); push_f(zone.v_max);
+            out.push_back(zone.enabled ? 1u : 0u);
+        }
+    }
+}
+
+void ScreenMirror::CompileSamplingPlanMonitors(const GridContext3D& grid, const Vector3D& anchor)
+{
+    SamplingPlan& plan = sampling_plan_;
+    const uint64_t previous_epoch = plan.epoch;
+    plan.epoch++;
+    plan.monitors.clear();
+    plan.taps.clear();
+
+    // Keep smoothing state of LEDs sampled in the last epoch; forget positions no longer rendered.
+    std::vector<SamplingPlanLed> kept_leds;
+    kept_leds.reserve(plan.leds.size());
+    for(std::unordered_map<LEDKey, unsigned int, LEDKeyHash>::iterator it = plan.led_index.begin();
+        it != plan.led_index.end(); )
+    {
+        if(plan.leds[it->second].epoch != previous_epoch)
+        {
+            it = plan.led_index.erase(it);
+            continue;
+        }
+        kept_leds.push_back(plan.leds[it->second]);
+        it->second = (unsigned int)(kept_leds.size() - 1);
+        ++it;
+    }
+    plan.leds.swap(kept_leds);
 
-    const float scale_mm = SafeGridScaleMm(grid.grid_scale_mm);
-    float base_max_distance_mm = ComputeMaxReferenceDistanceMm(grid, grid_anchor_ref, scale_mm);
+    plan.scale_mm = SafeGridScaleMm(grid.grid_scale_mm);
+    float base_max_distance_mm = ComputeMaxReferenceDistanceMm(grid, anchor, plan.scale_mm);
     if(base_max_distance_mm <= 0.0f)
     {
         base_max_distance_mm = 3000.0f;
     }
 
-    std::map<std::string, std::unordered_map<std::string, FrameHistory>::iterator> history_cache;
-
-    for(size_t plane_index = 0; plane_index < all_planes.size(); plane_index++)
+    for(DisplayPlane3D* plane : frame_cache_planes_)
     {
-        DisplayPlane3D* plane = all_planes[plane_index];
         if(!plane) continue;
+        std::map<std::string, MonitorSettings>::const_iterator settings_it = monitor_settings.find(plane->GetName());
+        if(settings_it == monitor_settings.end()) continue;
+        const MonitorSettings& s = settings_it->second;
+        if(!s.enabled)
+        {
+            continue;
+        }
 
-        std::string plane_name = plane->GetName();
-        std::map<std::string, MonitorSettings>::iterator settings_it = monitor_settings.find(plane_name);
-        if(settings_it == monitor_settings.end())
+        SamplingPlanMonitor monitor;
+        monitor.settings = &s;
+        monitor.plane = plane;
+        monitor.capture_id = plane->GetCaptureSourceId();
+        monitor.use_calibration_pattern = s.show_calibration_pattern;
+        if(!monitor.use_calibration_pattern && monitor.capture_id.empty())
         {
-            settings_it = monitor_settings.emplace(plane_name, MonitorSettings()).first;
-            settings_it->second.enabled = DefaultMonitorEnabledForPlane(plane);
-            if(settings_it->second.capture_zones.empty())
+            continue;
+        }
+        monitor.use_wave = !monitor.use_calibration_pattern &&
+                           (s.wave_time_to_edge_sec > 0.4f || s.propagation_speed_mm_per_ms >= 5.0f);
+
+        monitor.falloff_ref = anchor;
+        monitor.reference_max_distance_mm = base_max_distance_mm;
+        Vector3D custom_ref;
+        if(s.reference_point_id > 0 && ResolveReferencePointById(s.reference_point_id, custom_ref))
+        {
+            monitor.falloff_ref = custom_ref;
+            monitor.reference_max_distance_mm = ComputeMaxReferenceDistanceMm(grid, custom_ref, plan.scale_mm);
+            if(monitor.reference_max_distance_mm <= 0.0f)
             {
-                settings_it->second.capture_zones.push_back(CaptureZone(0.0f, 1.0f, 0.0f, 1.0f));
+                monitor.reference_max_distance_mm = base_max_distance_mm;
             }
         }
+        plan.monitors.push_back(std::move(monitor));
+    }
+}
 
-        MonitorSettings& mon_settings = settings_it->second;
-        
-        if(mon_settings.capture_zones.empty())
+void ScreenMirror::ResolveSamplingPlanFrame()
+{
+    SamplingPlan& plan = sampling_plan_;
+    plan.any_capturing = -1;
+    for(SamplingPlanMonitor& monitor : plan.monitors)
+    {
+        const MonitorSettings& s = *monitor.settings;
+        const float lp = std::clamp(s.black_bar_letterbox_percent, 0.0f, 49.0f) / 100.0f;
+        const float pp = std::clamp(s.black_bar_pillarbox_percent, 0.0f, 49.0f) / 100.0f;
+        monitor.u_min = pp;
+        monitor.u_max = 1.0f - pp;
+        monitor.v_min = lp;
+        monitor.v_max = 1.0f - lp;
+        monitor.corner_blend_strength_01 = std::clamp(s.corner_blend_strength_pct / 100.0f, 0.0f, 1.0f);
+        monitor.corner_blend_zone_01 = std::clamp(s.corner_blend_zone_pct / 100.0f, 0.0f, 0.32f);
+
+        monitor.frame.reset();
+        monitor.history = nullptr;
+        if(monitor.use_calibration_pattern)
         {
-            mon_settings.capture_zones.push_back(CaptureZone(0.0f, 1.0f, 0.0f, 1.0f));
+            monitor.active = true;
+            continue;
         }
-        bool has_enabled_zone = false;
-        for(size_t zone_idx = 0; zone_idx < mon_settings.capture_zones.size(); zone_idx++)
+
+        std::unordered_map<std::string, std::shared_ptr<CapturedFrame>>::const_iterator frame_it =
+            frame_cache_.find(monitor.capture_id);
+        if(frame_it != frame_cache_.end())
         {
-            if(mon_settings.capture_zones[zone_idx].enabled)
-            {
-                has_enabled_zone = true;
-                break;
-            }
+            monitor.frame = frame_it->second;
         }
-        if(!has_enabled_zone && !mon_settings.capture_zones.empty())
+        monitor.active = monitor.frame && monitor.frame->valid && !monitor.frame->data.empty();
+        if(!monitor.active || !monitor.use_wave)
         {
-            mon_settings.capture_zones[0].enabled = true;
+            continue;
         }
-        
-        bool monitor_enabled = mon_settings.group_box ? mon_settings.group_box->isChecked() : mon_settings.enabled;
-        if(!monitor_enabled)
+
+        std::unordered_map<std::string, FrameHistory>::iterator history_it = capture_history.find(monitor.capture_id);
+        if(history_it == capture_history.end() || history_it->second.frames.size() < 2)
         {
             continue;
         }
+        FrameHistory& history = history_it->second;
+        const std::deque<std::shared_ptr<CapturedFrame>>& frames = history.frames;
 
-        bool monitor_calibration_pattern = mon_settings.show_calibration_pattern;
-        
-        std::string capture_id = plane->GetCaptureSourceId();
-        std::shared_ptr<CapturedFrame> frame = nullptr;
+        float avg_frame_time_ms = history.cached_avg_frame_time_ms > 0.0f
+            ? history.cached_avg_frame_time_ms : 16.67f;
+        uint64_t latest_timestamp = frames.back()->timestamp_ms;
+        const uint64_t frame_rate_stale_ms = 200;
 
-        if(!monitor_calibration_pattern)
+        if(history.last_frame_rate_update == 0 ||
+           (latest_timestamp - history.last_frame_rate_update) > frame_rate_stale_ms)
         {
-            if(capture_id.empty())
-            {
-                continue;
-            }
-            if(frame_cache)
-            {
-                std::unordered_map<std::string, std::shared_ptr<CapturedFrame>>::const_iterator it =
-                    frame_cache->find(capture_id);
-                frame = (it != frame_cache->end()) ? it->second : nullptr;
-            }
-            else
+            size_t check_frames = std::min(frames.size() - 1, (size_t)10);
+            uint64_t total_time = 0;
+            size_t valid_pairs = 0;
+            const uint64_t min_delta_ms = 8;
+            const uint64_t max_delta_ms = 80;
+
+            for(size_t i = frames.size() - check_frames; i < frames.size(); i++)
             {
-                if(!capture_mgr.IsCapturing(capture_id))
+                if(i > 0)
                 {
-                    capture_mgr.StartCapture(capture_id);
-                    if(!capture_mgr.IsCapturing(capture_id))
+                    uint64_t frame_time = frames[i]->timestamp_ms;
+                    uint64_t prev_time = frames[i-1]->timestamp_ms;
+                    uint64_t delta = (frame_time > prev_time) ? (frame_time - prev_time) : 0;
+                    if(delta >= min_delta_ms && delta <= max_delta_ms)
                     {
-                        continue;
+                        total_time += delta;
+                        valid_pairs++;
                     }
                 }
-                frame = capture_mgr.GetLatestFrame(capture_id);
-                if(!frame || !frame->valid || frame->data.empty())
-                {
-                    continue;
-                }
-                AddFrameToHistory(capture_id, frame);
             }
-            if(!frame || !frame->valid || frame->data.empty())
+
+            if(valid_pairs > 0 && total_time > 0)
             {
-                continue;
+                float measured_ms = (float)total_time / (float)valid_pairs;
+                measured_ms = std::clamp(measured_ms, 12.0f, 50.0f);
+                if(history.cached_avg_frame_time_ms > 0.0f)
+                    avg_frame_time_ms = 0.75f * history.cached_avg_frame_time_ms + 0.25f * measured_ms;
+                else
+                    avg_frame_time_ms = measured_ms;
             }
+            history.cached_avg_frame_time_ms = avg_frame_time_ms;
+            history.last_frame_rate_update = latest_timestamp;
         }
+        monitor.history = &frames;
+        monitor.avg_frame_time_ms = history.cached_avg_frame_time_ms;
+    }
+}
 
-        const Vector3D* falloff_ref = &grid_anchor_ref;
-        Vector3D custom_ref;
-        if(mon_settings.reference_point_id > 0 &&
-           ResolveReferencePointById(mon_settings.reference_point_id, custom_ref))
-        {
-            falloff_ref = &custom_ref;
-        }
+void ScreenMirror::CompileSamplingPlanLed(SamplingPlanLed& led, const Vector3D& led_pos)
+{
+    SamplingPlan& plan = sampling_plan_;
+    led.epoch = plan.epoch;
+    led.first_tap = (unsigned int)plan.taps.size();
+    led.tap_count = 0;
 
-        float reference_max_distance_mm = base_max_distance_mm;
-        if(falloff_ref != &grid_anchor_ref)
-        {
-            reference_max_distance_mm = ComputeMaxReferenceDistanceMm(grid, *falloff_ref, scale_mm);
-            if(reference_max_distance_mm <= 0.0f)
-            {
-                reference_max_distance_mm = base_max_distance_mm;
-            }
-        }
+    for(unsigned int monitor_index = 0; monitor_index < plan.monitors.size(); monitor_index++)
+    {
+        const SamplingPlanMonitor& monitor = plan.monitors[monitor_index];
+        const MonitorSettings& mon_settings = *monitor.settings;
+        const Vector3D* falloff_ref = &monitor.falloff_ref;
+        const float reference_max_distance_mm = monitor.reference_max_distance_mm;
 
         Geometry3D::PlaneProjection proj =
-            Geometry3D::SpatialMapToScreen(led_pos, *plane, 0.0f, falloff_ref, scale_mm);
+            Geometry3D::SpatialMapToScreen(led_pos, *monitor.plane, 0.0f, falloff_ref, plan.scale_mm);
 
         if(!proj.is_valid) continue;
 
         float u = proj.u;
         float v = proj.v;
 
-        if(mon_settings.capture_zones.empty())
-        {
-            mon_settings.capture_zones.push_back(CaptureZone(0.0f, 1.0f, 0.0f, 1.0f));
-        }
         bool in_zone = false;
         for(size_t zone_idx = 0; zone_idx < mon_settings.capture_zones.size(); zone_idx++)
         {
@@ -488,9 +701,6 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
 
         Geometry3D::ApplyUVRotationDegrees01(u, v, mon_settings.screen_map_roll_deg);
 
-        proj.u = u;
-        proj.v = v;
-
         float monitor_scale = std::clamp(mon_settings.scale, 0.0f, 3.0f);
         float coverage = monitor_scale;
         float curve_exp = std::clamp(mon_settings.falloff_curve_exponent, 0.5f, 2.0f);
@@ -516,151 +726,33 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
             }
         }
 
-        std::shared_ptr<CapturedFrame> sampling_frame = frame;
-        std::shared_ptr<CapturedFrame> sampling_frame_blend;
-        float sampling_blend_t = 0.0f;
         float delay_ms = 0.0f;
-        float speed_mm_per_ms = 0.0f;
-        bool use_wave = !monitor_calibration_pattern && !capture_id.empty();
-        if(use_wave && mon_settings.wave_time_to_edge_sec > 0.4f)
+        if(monitor.use_wave && mon_settings.wave_time_to_edge_sec > 0.4f)
         {
             float t_sec = std::clamp(mon_settings.wave_time_to_edge_sec, 0.5f, 10.0f);
-            speed_mm_per_ms = reference_max_distance_mm / (t_sec * 1000.0f);
+            float speed_mm_per_ms = reference_max_distance_mm / (t_sec * 1000.0f);
             speed_mm_per_ms = std::max(speed_mm_per_ms, 0.1f);
-            delay_ms = proj.distance / speed_mm_per_ms;
-            delay_ms = std::clamp(delay_ms, 0.0f, 60000.0f);
+            delay_ms = std::clamp(proj.distance / speed_mm_per_ms, 0.0f, 60000.0f);
         }
-        else if(use_wave && mon_settings.propagation_speed_mm_per_ms >= 5.0f)
+        else if(monitor.use_wave)
         {
-            speed_mm_per_ms = WaveIntensityToSpeedMmPerMs(mon_settings.propagation_speed_mm_per_ms);
-            delay_ms = proj.distance / std::max(speed_mm_per_ms, 0.5f);
-            delay_ms = std::clamp(delay_ms, 0.0f, 15000.0f);
-        }
-
-        if(use_wave && (mon_settings.wave_time_to_edge_sec > 0.4f || mon_settings.propagation_speed_mm_per_ms >= 5.0f))
-        {
-            std::unordered_map<std::string, FrameHistory>::iterator history_it = capture_history.end();
-            std::map<std::string, std::unordered_map<std::string, FrameHistory>::iterator>::iterator cache_it = history_cache.find(capture_id);
-            if(cache_it != history_cache.end())
-            {
-                history_it = cache_it->second;
-            }
-            else
-            {
-                history_it = capture_history.find(capture_id);
-                if(history_it != capture_history.end())
-                {
-                    history_cache[capture_id] = history_it;
-                }
-            }
-            
-            if(history_it != capture_history.end() && history_it->second.frames.size() >= 2)
-            {
-                FrameHistory& history = history_it->second;
-                const std::deque<std::shared_ptr<CapturedFrame>>& frames = history.frames;
-                
-                float avg_frame_time_ms = history.cached_avg_frame_time_ms > 0.0f
-                    ? history.cached_avg_frame_time_ms : 16.67f;
-                uint64_t latest_timestamp = frames.back()->timestamp_ms;
-                const uint64_t frame_rate_stale_ms = 200;
-
-                if(history.last_frame_rate_update == 0 ||
-                   (latest_timestamp - history.last_frame_rate_update) > frame_rate_stale_ms)
-                {
-                    if(frames.size() >= 2)
-                    {
-                        size_t check_frames = std::min(frames.size() - 1, (size_t)10);
-                        uint64_t total_time = 0;
-                        size_t valid_pairs = 0;
-                        const uint64_t min_delta_ms = 8;
-                        const uint64_t max_delta_ms = 80;
-
-                        for(size_t i = frames.size() - check_frames; i < frames.size(); i++)
-                        {
-                            if(i > 0 && i < frames.size())
-                            {
-                                uint64_t frame_time = frames[i]->timestamp_ms;
-                                uint64_t prev_time = frames[i-1]->timestamp_ms;
-                                uint64_t delta = (frame_time > prev_time) ? (frame_time - prev_time) : 0;
-                                if(delta >= min_delta_ms && delta <= max_delta_ms)
-                                {
-                                    total_time += delta;
-                                    valid_pairs++;
-                                }
-                            }
-                        }
-
-                        if(valid_pairs > 0 && total_time > 0)
-                        {
-                            float measured_ms = (float)total_time / (float)valid_pairs;
-                            measured_ms = std::clamp(measured_ms, 12.0f, 50.0f);
-                            if(history.cached_avg_frame_time_ms > 0.0f)
-                                avg_frame_time_ms = 0.75f * history.cached_avg_frame_time_ms + 0.25f * measured_ms;
-                            else
-                                avg_frame_time_ms = measured_ms;
-                        }
-                    }
-                    history.cached_avg_frame_time_ms = avg_frame_time_ms;
-                    history.last_frame_rate_update = latest_timestamp;
-                }
-                else
-                {
-                    avg_frame_time_ms = history.cached_avg_frame_time_ms;
-                }
-
-                float frame_offset_f = delay_ms / std::max(avg_frame_time_ms, 1.0f);
-                frame_offset_f = std::max(0.0f, frame_offset_f);
-                int frame_offset_int = (int)(frame_offset_f + 0.5f);
-                frame_offset_int = std::max(0, frame_offset_int);
-
-                if(frame_offset_int < (int)frames.size())
-                {
-                    size_t frame_index_lo = frames.size() - 1 - (size_t)frame_offset_int;
-                    float frac = frame_offset_f - std::floor(frame_offset_f);
-                    if(frame_index_lo < frames.size())
-                    {
-                        sampling_frame = frames[frame_index_lo];
-                        if(frac > 0.01f && frame_index_lo + 1 < frames.size())
-                        {
-                            sampling_frame_blend = frames[frame_index_lo + 1];
-                            sampling_blend_t = frac;
-                        }
-                    }
-                }
-            }
-            else
-            {
-            }
+            float speed_mm_per_ms = WaveIntensityToSpeedMmPerMs(mon_settings.propagation_speed_mm_per_ms);
+            delay_ms = std::clamp(proj.distance / std::max(speed_mm_per_ms, 0.5f), 0.0f, 15000.0f);
         }
 
         float wave_envelope = 1.0f;
         if((mon_settings.wave_time_to_edge_sec > 0.4f || mon_settings.propagation_speed_mm_per_ms >= 5.0f) && mon_settings.wave_decay_ms > 0.1f)
         {
-            if(delay_ms <= 0.0f && use_wave)
-            {
-                if(mon_settings.wave_time_to_edge_sec > 0.4f)
-                {
-                    float t_sec = std::clamp(mon_settings.wave_time_to_edge_sec, 0.5f, 10.0f);
-                    speed_mm_per_ms = reference_max_distance_mm / (t_sec * 1000.0f);
-                    delay_ms = proj.distance / std::max(speed_mm_per_ms, 0.1f);
-                }
-                else
-                {
-                    speed_mm_per_ms = WaveIntensityToSpeedMmPerMs(mon_settings.propagation_speed_mm_per_ms);
-                    delay_ms = proj.distance / std::max(speed_mm_per_ms, 0.5f);
-                }
-                delay_ms = std::clamp(delay_ms, 0.0f, 60000.0f);
-            }
             wave_envelope = std::exp(-delay_ms / std::max(mon_settings.wave_decay_ms, 0.1f));
         }
 
         float weight = distance_falloff * wave_envelope;
 
-        const float ref_max_units = MMToGridUnits(reference_max_distance_mm, scale_mm);
+        const float ref_max_units = MMToGridUnits(reference_max_distance_mm, plan.scale_mm);
         if(ref_max_units > 0.001f && (std::fabs(mon_settings.front_back_balance) > 0.5f || std::fabs(mon_settings.left_right_balance) > 0.5f || std::fabs(mon_settings.top_bottom_balance) > 0.5f))
         {
             Vector3D ref_to_led = { led_pos.x - falloff_ref->x, led_pos.y - falloff_ref->y, led_pos.z - falloff_ref->z };
-            const Transform3D& transform = plane->GetTransform();
+            const Transform3D& transform = monitor.plane->GetTransform();
             float rot[9];
             Geometry3D::ComputeRotationMatrix(transform.rotation, rot);
             Vector3D plane_right  = { rot[0], rot[3], rot[6] };
@@ -680,67 +772,108 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
 
         if(weight > 0.01f)
         {
-            MonitorContribution contrib;
-            contrib.plane = plane;
-            contrib.proj = proj;
-            contrib.frame = sampling_frame;
-            contrib.frame_blend = sampling_frame_blend;
-            contrib.blend_t = sampling_blend_t;
-            contrib.weight = weight;
-            contrib.blend = mon_settings.blend;
-            contrib.brightness_multiplier = mon_settings.brightness_multiplier;
-            contrib.brightness_threshold = mon_settings.brightness_threshold;
-            contrib.white_rolloff = mon_settings.white_rolloff;
-            contrib.vibrance = mon_settings.vibrance;
-            contrib.led_output_gain_r = mon_settings.led_output_gain_r;
-            contrib.led_output_gain_g = mon_settings.led_output_gain_g;
-            contrib.led_output_gain_b = mon_settings.led_output_gain_b;
-            contrib.black_bar_letterbox_percent = mon_settings.black_bar_letterbox_percent;
-            contrib.black_bar_pillarbox_percent = mon_settings.black_bar_pillarbox_percent;
-            contrib.smoothing_time_ms = mon_settings.smoothing_time_ms;
-            contrib.use_calibration_pattern = mon_settings.show_calibration_pattern;
-            contrib.corner_blend_strength_01 =
-                std::clamp(mon_settings.corner_blend_strength_pct / 100.0f, 0.0f, 1.0f);
-            contrib.corner_blend_zone_01 =
-                std::clamp(mon_settings.corner_blend_zone_pct / 100.0f, 0.0f, 0.32f);
-            contributions.push_back(contrib);
+            SamplingPlanTap tap;
+            tap.monitor = monitor_index;
+            tap.u = u;
+            tap.v = v;
+            tap.weight = weight;
+            tap.delay_ms = delay_ms;
+            plan.taps.push_back(tap);
+            led.tap_count++;
         }
     }
+}
 
-    if(contributions.empty())
+RGBColor ScreenMirror::SampleSamplingPlan(float x, float y, float z)
+{
+    SamplingPlan& plan = sampling_plan_;
+    if(frame_cache_planes_.empty())
     {
-        if(show_calibration_pattern)
+        return ToRGBColor(0, 0, 0);
+    }
+
+    const LEDKey key = MakeLEDKey(x, y, z);
+    std::unordered_map<LEDKey, unsigned int, LEDKeyHash>::iterator led_it = plan.led_index.find(key);
+    if(led_it == plan.led_index.end())
+    {
+        led_it = plan.led_index.emplace(key, (unsigned int)plan.leds.size()).first;
+        plan.leds.emplace_back();
+    }
+    SamplingPlanLed& led = plan.leds[led_it->second];
+    if(led.epoch != plan.epoch)
+    {
+        CompileSamplingPlanLed(led, Vector3D{x, y, z});
+    }
+
+    std::vector<SamplingContribution>& contributions = sampling_contributions_;
+    contributions.clear();
+    for(unsigned int tap_index = led.first_tap; tap_index < led.first_tap + led.tap_count; tap_index++)
+    {
+        const SamplingPlanTap& tap = plan.taps[tap_index];
+        const SamplingPlanMonitor& monitor = plan.monitors[tap.monitor];
+        if(!monitor.active)
         {
-            return ToRGBColor(0, 0, 0);
+            continue;
         }
-        
-        int capturing_count = 0;
-        for(size_t plane_index = 0; plane_index < all_planes.size(); plane_index++)
+
+        SamplingContribution contrib;
+        contrib.monitor = tap.monitor;
+        contrib.u = tap.u;
+        contrib.v = tap.v;
+        contrib.weight = tap.weight;
+        contrib.frame = monitor.frame.get();
+        contrib.frame_blend = nullptr;
+        contrib.blend_t = 0.0f;
+
+        if(monitor.history)
         {
-            DisplayPlane3D* plane = all_planes[plane_index];
-            if(plane && !plane->GetCaptureSourceId().empty())
+            const std::deque<std::shared_ptr<CapturedFrame>>& frames = *monitor.history;
+            float frame_offset_f = tap.delay_ms / std::max(monitor.avg_frame_time_ms, 1.0f);
+            frame_offset_f = std::max(0.0f, frame_offset_f);
+            int frame_offset_int = (int)(frame_offset_f + 0.5f);
+
+            if(frame_offset_int < (int)frames.size())
             {
-                if(capture_mgr.IsCapturing(plane->GetCaptureSourceId()))
+                size_t frame_index_lo = frames.size() - 1 - (size_t)frame_offset_int;
+                float frac = frame_offset_f - std::floor(frame_offset_f);
+                contrib.frame = frames[frame_index_lo].get();
+                if(frac > 0.01f && frame_index_lo + 1 < frames.size())
                 {
-                    capturing_count++;
+                    contrib.frame_blend = frames[frame_index_lo + 1].get();
+                    contrib.blend_t = frac;
                 }
             }
         }
+        contributions.push_back(contrib);
+    }
 
-        if(capturing_count > 0)
+    if(contributions.empty())
+    {
+        if(show_calibration_pattern)
         {
             return ToRGBColor(0, 0, 0);
         }
-        else
+
+        if(plan.any_capturing < 0)
         {
-            return ToRGBColor(128, 0, 128);
+            ScreenCaptureManager& capture_mgr = ScreenCaptureManager::Instance();
+            plan.any_capturing = 0;
+            for(DisplayPlane3D* plane : frame_cache_planes_)
+            {
+                if(plane && !plane->GetCaptureSourceId().empty() && capture_mgr.IsCapturing(plane->GetCaptureSourceId()))
+                {
+                    plan.any_capturing = 1;
+                    break;
+                }
+            }
         }
+        return plan.any_capturing ? ToRGBColor(0, 0, 0) : ToRGBColor(128, 0, 128);
     }
 
     float avg_blend = 0.0f;
     for(size_t contrib_index = 0; contrib_index < contributions.size(); contrib_index++)
     {
-        avg_blend += contributions[contrib_index].blend;
+        avg_blend += plan.monitors[contributions[contrib_index].monitor].settings->blend;
     }
     avg_blend /= (float)contributions.size();
     float blend_factor = avg_blend / 100.0f;
@@ -766,40 +899,31 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
 
     float total_r = 0.0f, total_g = 0.0f, total_b = 0.0f;
     float total_weight = 0.0f;
-    std::vector<float> per_contrib_r;
-    std::vector<float> per_contrib_g;
-    std::vector<float> per_contrib_b;
-    std::vector<float> per_contrib_w;
-    per_contrib_r.reserve(contributions.size());
-    per_contrib_g.reserve(contributions.size());
-    per_contrib_b.reserve(contributions.size());
-    per_contrib_w.reserve(contributions.size());
+    // r, g, b, weight per accepted contribution.
+    std::vector<float>& per_contrib = sampling_contribution_rgbw_;
+    per_contrib.clear();
+    const unsigned int samp = GetSamplingResolution();
 
     for(size_t contrib_index = 0; contrib_index < contributions.size(); contrib_index++)
     {
-        MonitorContribution& contrib = contributions[contrib_index];
-        float sample_u = contrib.proj.u;
-        float sample_v = contrib.proj.v;
-        const float corner_strength_01 = contrib.corner_blend_strength_01;
-        const float corner_zone_01 = contrib.corner_blend_zone_01;
+        SamplingContribution& contrib = contributions[contrib_index];
+        const SamplingPlanMonitor& monitor = plan.monitors[contrib.monitor];
+        const MonitorSettings& mon_settings = *monitor.settings;
+        const float u_min = monitor.u_min, u_max = monitor.u_max;
+        const float v_min = monitor.v_min, v_max = monitor.v_max;
+        const float sample_u_clamped = std::clamp(contrib.u, u_min, u_max);
 
         float r, g, b;
 
-        if(contrib.use_calibration_pattern)
+        if(monitor.use_calibration_pattern)
         {
             int cal_w = 0;
             int cal_h = 0;
             const uint8_t* cal_data = GetCalibrationPatternBuffer(cal_w, cal_h);
-            float lp = std::clamp(contrib.black_bar_letterbox_percent, 0.0f, 49.0f) / 100.0f;
-            float pp = std::clamp(contrib.black_bar_pillarbox_percent, 0.0f, 49.0f) / 100.0f;
-            float u_min = pp;
-            float u_max = 1.0f - pp;
-            float v_min = lp;
-            float v_max = 1.0f - lp;
-            float sample_u_clamped = std::clamp(sample_u, u_min, u_max);
-            float tex_v = std::clamp(sample_v, v_min, v_max);
-            const unsigned int samp = GetSamplingResolution();
+            float tex_v = std::clamp(contrib.v, v_min, v_max);
             RGBColor sampled_cal = SampleFrameWithCornerBlend(cal_data,
+                                                              cal_w,
+                                                              cal_h,
                                                               cal_w,
                                                               cal_h,
                                                               sample_u_clamped,
@@ -809,8 +933,8 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
                                                               v_min,
                                                               v_max,
                                                               samp,
-                                                              corner_strength_01,
-                                                              corner_zone_01);
+                                                              monitor.corner_blend_strength_01,
+                                                              monitor.corner_blend_zone_01);
             r = (float)RGBGetRValue(sampled_cal);
             g = (float)RGBGetGValue(sampled_cal);
             b = (float)RGBGetBValue(sampled_cal);
@@ -822,29 +946,26 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
                 continue;
             }
 
-            float lp = std::clamp(contrib.black_bar_letterbox_percent, 0.0f, 49.0f) / 100.0f;
-            float pp = std::clamp(contrib.black_bar_pillarbox_percent, 0.0f, 49.0f) / 100.0f;
-            float u_min = pp, u_max = 1.0f - pp;
-            float v_min = lp, v_max = 1.0f - lp;
-            float sample_u_clamped = std::clamp(sample_u, u_min, u_max);
-            float flipped_v = 1.0f - sample_v;
-            flipped_v = std::clamp(flipped_v, v_min, v_max);
-            const unsigned int samp = GetSamplingResolution();
-            const float u_s = sample_u_clamped;
-            const float v_s = flipped_v;
-
-            RGBColor sampled_color = SampleFrameWithCornerBlend(contrib.frame->data.data(),
+            const float flipped_v = std::clamp(1.0f - contrib.v, v_min, v_max);
+
+            const uint8_t* level_data = nullptr;
+            int level_w = 0;
+            int level_h = 0;
+            SelectFrameLevel(*contrib.frame, samp, level_data, level_w, level_h);
+            RGBColor sampled_color = SampleFrameWithCornerBlend(level_data,
+                                                                level_w,
+                                                                level_h,
                                                                 contrib.frame->width,
                                                                 contrib.frame->height,
-                                                                u_s,
-                                                                v_s,
+                                                                sample_u_clamped,
+                                                                flipped_v,
                                                                 u_min,
                                                                 u_max,
                                                                 v_min,
                                                                 v_max,
                                                                 samp,
-                                                                corner_strength_01,
-                                                                corner_zone_01);
+                                                                monitor.corner_blend_strength_01,
+                                                                monitor.corner_blend_zone_01);
 
             r = (float)RGBGetRValue(sampled_color);
             g = (float)RGBGetGValue(sampled_color);
@@ -852,20 +973,21 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
 
             if(contrib.frame_blend && !contrib.frame_blend->data.empty() && contrib.blend_t > 0.01f)
             {
-                const float u_b = sample_u_clamped;
-                const float v_b = flipped_v;
-                RGBColor sampled_blend = SampleFrameWithCornerBlend(contrib.frame_blend->data.data(),
+                SelectFrameLevel(*contrib.frame_blend, samp, level_data, level_w, level_h);
+                RGBColor sampled_blend = SampleFrameWithCornerBlend(level_data,
+                                                                      level_w,
+                                                                      level_h,
                                                                       contrib.frame_blend->width,
                                                                       contrib.frame_blend->height,
-                                                                      u_b,
-                                                                      v_b,
+                                                                      sample_u_clamped,
+                                                                      flipped_v,
                                                                       u_min,
                                                                       u_max,
                                                                       v_min,
                                                                       v_max,
                                                                       samp,
-                                                                      corner_strength_01,
-                                                                      corner_zone_01);
+                                                                      monitor.corner_blend_strength_01,
+                                                                      monitor.corner_blend_zone_01);
                 float r2 = (float)RGBGetRValue(sampled_blend);
                 float g2 = (float)RGBGetGValue(sampled_blend);
                 float b2 = (float)RGBGetBValue(sampled_blend);
@@ -875,9 +997,9 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
                 b = (1.0f - t) * b + t * b2;
             }
 
-            if(contrib.brightness_threshold > 0.0f)
+            if(mon_settings.brightness_threshold > 0.0f)
             {
-                float thr = std::min(255.0f, contrib.brightness_threshold);
+                float thr = std::min(255.0f, mon_settings.brightness_threshold);
                 float luminance = 0.299f * r + 0.587f * g + 0.114f * b;
                 float peak = std::max(r, std::max(g, b));
                 float level = std::max(luminance, peak);
@@ -898,7 +1020,7 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
         float min_rgb = std::min(r, std::min(g, b));
         float sat = (max_rgb > 0.001f) ? ((max_rgb - min_rgb) / max_rgb) : 0.0f;
 
-        const float wr_full = std::clamp(contrib.white_rolloff, 0.0f, kWhiteRolloffStoredMax);
+        const float wr_full = std::clamp(mon_settings.white_rolloff, 0.0f, kWhiteRolloffStoredMax);
         const float wr_sub = std::min(1.0f, wr_full);
 
         if(lum > 242.0f && sat < 0.20f)
@@ -931,11 +1053,11 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
             b = std::clamp(b, 0.0f, 255.0f);
         }
 
-        r *= contrib.brightness_multiplier;
-        g *= contrib.brightness_multiplier;
-        b *= contrib.brightness_multiplier;
+        r *= mon_settings.brightness_multiplier;
+        g *= mon_settings.brightness_multiplier;
+        b *= mon_settings.brightness_multiplier;
 
-        float vib = std::max(0.0f, std::min(2.0f, contrib.vibrance));
+        float vib = std::max(0.0f, std::min(2.0f, mon_settings.vibrance));
         if(std::fabs(vib - 1.0f) > 0.001f)
         {
             float gray = (r + g + b) / 3.0f;
@@ -947,9 +1069,9 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
             b = std::max(0.0f, std::min(255.0f, b));
         }
 
-        r = std::clamp(r * contrib.led_output_gain_r, 0.0f, 255.0f);
-        g = std::clamp(g * contrib.led_output_gain_g, 0.0f, 255.0f);
-        b = std::clamp(b * contrib.led_output_gain_b, 0.0f, 255.0f);
+        r = std::clamp(r * mon_settings.led_output_gain_r, 0.0f, 255.0f);
+        g = std::clamp(g * mon_settings.led_output_gain_g, 0.0f, 255.0f);
+        b = std::clamp(b * mon_settings.led_output_gain_b, 0.0f, 255.0f);
 
         float adjusted_weight = contrib.weight * (0.5f + 0.5f * blend_factor);
 
@@ -958,10 +1080,10 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
         total_b += b * adjusted_weight;
         total_weight += adjusted_weight;
 
-        per_contrib_r.push_back(r);
-        per_contrib_g.push_back(g);
-        per_contrib_b.push_back(b);
-        per_contrib_w.push_back(adjusted_weight);
+        per_contrib.push_back(r);
+        per_contrib.push_back(g);
+        per_contrib.push_back(b);
+        per_contrib.push_back(adjusted_weight);
     }
 
     if(total_weight > 0.0f)
@@ -971,22 +1093,23 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
         total_b /= total_weight;
     }
 
-    if(per_contrib_w.size() >= 2 && total_weight > 1e-6f)
+    const size_t accepted = per_contrib.size() / 4;
+    if(accepted >= 2 && total_weight > 1e-6f)
     {
         size_t best = 0;
-        for(size_t i = 1; i < per_contrib_w.size(); i++)
+        for(size_t i = 1; i < accepted; i++)
         {
-            if(per_contrib_w[i] > per_contrib_w[best])
+            if(per_contrib[i * 4 + 3] > per_contrib[best * 4 + 3])
             {
                 best = i;
             }
         }
-        const float dominance = per_contrib_w[best] / total_weight;
+        const float dominance = per_contrib[best * 4 + 3] / total_weight;
         if(dominance >= 0.50f)
         {
-            total_r = per_contrib_r[best];
-            total_g = per_contrib_g[best];
-            total_b = per_contrib_b[best];
+            total_r = per_contrib[best * 4 + 0];
+            total_g = per_contrib[best * 4 + 1];
+            total_b = per_contrib[best * 4 + 2];
         }
         else
         {
@@ -1015,68 +1138,52 @@ RGBColor ScreenMirror::CalculateColorGridInternal(float x, float y, float z, flo
     if(total_g > 255.0f) total_g = 255.0f;
     if(total_b > 255.0f) total_b = 255.0f;
 
-    if(apply_led_smoothing)
+    float max_smoothing_time = 0.0f;
+    for(size_t i = 0; i < contributions.size(); i++)
     {
-        float max_smoothing_time = 0.0f;
-        if(contributions.size() == 1)
+        max_smoothing_time = std::max(max_smoothing_time, plan.monitors[contributions[i].monitor].settings->smoothing_time_ms);
+    }
+
+    LEDState& state = led.smoothing;
+    if(max_smoothing_time > 0.1f)
+    {
+        static const std::chrono::steady_clock::time_point smooth_clock_start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point now_tp = std::chrono::steady_clock::now();
+        uint64_t tick_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 now_tp - smooth_clock_start)
+                                 .count();
+
+        if(state.smooth_last_tick_ms == 0)
         {
-            max_smoothing_time = contributions[0].smoothing_time_ms;
+            state.r = total_r;
+            state.g = total_g;
+            state.b = total_b;
+            state.smooth_last_tick_ms = tick_ms;
         }
         else
         {
-            for(size_t i = 0; i < contributions.size(); i++)
-            {
-                if(contributions[i].smoothing_time_ms > max_smoothing_time)
-                {
-                    max_smoothing_time = contributions[i].smoothing_time_ms;
-                }
-            }
-        }
-        
-        if(max_smoothing_time > 0.1f)
-        {
-            LEDKey key = MakeLEDKey(x, y, z);
-            LEDState& state = led_states[key];
-
-            static const std::chrono::steady_clock::time_point smooth_clock_start = std::chrono::steady_clock::now();
-            std::chrono::steady_clock::time_point now_tp = std::chrono::steady_clock::now();
-            uint64_t tick_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
-                                     now_tp - smooth_clock_start)
-                                     .count();
-
-            if(state.smooth_last_tick_ms == 0)
+            uint64_t dt_ms_u64 = (tick_ms > state.smooth_last_tick_ms) ? (tick_ms - state.smooth_last_tick_ms) : 0;
+            if(dt_ms_u64 == 0)
             {
-                state.r = total_r;
-                state.g = total_g;
-                state.b = total_b;
-                state.smooth_last_tick_ms = tick_ms;
-            }
-            else
-            {
-                uint64_t dt_ms_u64 = (tick_ms > state.smooth_last_tick_ms) ? (tick_ms - state.smooth_last_tick_ms) : 0;
-                if(dt_ms_u64 == 0)
-                {
-                    dt_ms_u64 = 1;
-                }
-                float dt = (float)dt_ms_u64;
-                float tau = max_smoothing_time;
-                float alpha = dt / (tau + dt);
-
-                state.r += alpha * (total_r - state.r);
-                state.g += alpha * (total_g - state.g);
-                state.b += alpha * (total_b - state.b);
-                state.smooth_last_tick_ms = tick_ms;
-
-                total_r = state.r;
-                total_g = state.g;
-                total_b = state.b;
+                dt_ms_u64 = 1;
             }
+            float dt = (float)dt_ms_u64;
+            float tau = max_smoothing_time;
+            float alpha = dt / (tau + dt);
+
+            state.r += alpha * (total_r - state.r);
+            state.g += alpha * (total_g - state.g);
+            state.b += alpha * (total_b - state.b);
+            state.smooth_last_tick_ms = tick_ms;
+
+            total_r = state.r;
+            total_g = state.g;
+            total_b = state.b;
         }
-        else
-        {
-            LEDKey key = MakeLEDKey(x, y, z);
-            led_states.erase(key);
-        }
+    }
+    else
+    {
+        state = LEDState{0.0f, 0.0f, 0.0f, 0};
     }
 
     return ToRGBColor((uint8_t)total_r, (uint8_t)total_g, (uint8_t)total_b);
@@ -14,6 +14,7 @@
 #include <QPushButton>
 #include <algorithm>
 #include <cmath>
+#include <mutex>
 
 nlohmann::json ScreenMirror::SaveSettings() const
 {
@@ -431,6 +432,8 @@ void ScreenMirror::LoadSettings(const nlohmann::json& settings)
     const nlohmann::json& monitors = settings["monitor_settings"];
     for(nlohmann::json::const_iterator it = monitors.begin(); it != monitors.end(); ++it)
     {
+            // The render worker reads monitor_settings (and each capture_zones list) mid-frame.
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
             const std::string& monitor_name = it.key();
             const nlohmann::json& mon = it.value();
 
@@ -60,8 +60,21 @@ ShellPattern::ShellPattern(QWidget* parent) : SpatialEffect3D(parent)
     SetColors(default_colors);
     strip_assist_.setFragmentBody(QString::fromUtf8(SpatialStripKernelFieldGlsl()));
     strip_assist_.setWidth(256);
+    // SpatialStripKernelFieldGlsl is a port of EvalSpatialPatternKernel, so the CPU fill is the original.
+    strip_assist_.setCpuField([](const SpatialStripFieldEngine::CpuBakeContext& ctx, float* r) {
+        const float* u = ctx.params;
+        const float time_sec = std::fabs(u[3]) < 1e-8f ? ctx.time_sec : u[3];
+        const int kid = (int)(u[0] + 0.5f);
+        for(int x = 0; x < ctx.width; x++)
+        {
+            const float s01 = ((float)x + 0.5f) / (float)ctx.width;
+            const float k = EvalSpatialPatternKernel(kid, s01, u[1], std::max(u[2], 1.0f), time_sec);
+            r[x] = (k + 1.0f) * 0.5f;
+        }
+    });
     volume_assist_.setFragmentBody(QString::fromUtf8(ShellPatternCubeVolumeFieldGlsl()));
     volume_assist_.setResolution(28);
+    volume_assist_.setCpuField(&ShellPattern::BuildCpuRows);
 }
 
 ShellPattern::~ShellPattern() = default;
@@ -262,13 +275,9 @@ float BoundedProgress01(float time_sec, float speed_mul)
 }
 } // namespace
 
-float ShellPattern::EvaluateCubeDisplay(int disp, float lx, float ly, float lz, float k, float amp,
-                                        float progress, float time_sec, float sigma) const
+float ShellPattern::EvaluateCubeDisplay(int disp, float lx, float ly, float lz, float k, float amp, float progress,
+                                        float time_sec, float sigma, float detail, float size_m, float freq_n)
 {
-    const float detail = std::clamp(GetNormalizedDetail(), 0.05f, 1.0f);
-    const float size_m = std::clamp(GetNormalizedSize(), 0.2f, 2.5f);
-    const float freq_n = std::clamp(GetNormalizedFrequency(), 0.05f, 1.0f);
-
     if(disp == DISP_BARS)
     {
         const int n = 3 + (int)std::lround(3.0f * detail);
@@ -416,6 +425,33 @@ float ShellPattern::EvaluateCubeDisplay(int disp, float lx, float ly, float lz,
     return 0.0f;
 }
 
+SpatialVolumeFieldEngine::CpuRowFn ShellPattern::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    const float* u = ctx.params;
+    const int disp = (int)(std::clamp(u[0], (float)DISP_BARS, (float)DISP_RAIN) + 0.5f);
+    const float amp = std::clamp(u[1], 0.2f, 2.0f);
+    const float progress = u[2] - std::floor(u[2]);
+    const float sigma = std::max(u[3], 0.02f);
+    const float detail = std::clamp(u[4], 0.05f, 1.0f);
+    const float size_m = std::clamp(u[5], 0.2f, 2.5f);
+    const float freq_n = std::clamp(u[6], 0.05f, 1.0f);
+    const float k = std::clamp(u[7], -1.0f, 1.0f);
+    const float time_sec = ctx.time_sec;
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ly = row.y01 * 2.0f - 1.0f;
+        const float lz = row.z01 * 2.0f - 1.0f;
+        for(int x = 0; x < row.count; x++)
+        {
+            rgb[x * 3 + 0] = EvaluateCubeDisplay(disp, row.x01[x] * 2.0f - 1.0f, ly, lz, k, amp, progress, time_sec,
+                                                 sigma, detail, size_m, freq_n);
+            rgb[x * 3 + 1] = 0.0f;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
 void ShellPattern::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& /*grid*/)
 {
     const int pat = std::clamp(UseEffectStripColormap() ? GetEffectStripColormapKernel() : pattern_id, 0,
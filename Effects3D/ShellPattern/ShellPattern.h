@@ -29,6 +29,7 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
@@ -55,8 +56,10 @@ private:
 
     float EvaluateKernel(float s01, float phase01, float time_sec, int pattern, float repeats) const;
     /** Spatial LED-cube style intensity for the newer display modes (0..1). */
-    float EvaluateCubeDisplay(int disp, float lx, float ly, float lz, float k, float amp,
-                              float progress, float time_sec, float sigma) const;
+    static float EvaluateCubeDisplay(int disp, float lx, float ly, float lz, float k, float amp, float progress,
+                                     float time_sec, float sigma, float detail, float size_m, float freq_n);
+    /** CPU port of ShellPatternCubeVolumeFieldGlsl (SpatialVolumeFieldCpuBaker) over EvaluateCubeDisplay. */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
 
     int unfold_mode = 0;
     int display_mode = DISP_SHELL_Y;
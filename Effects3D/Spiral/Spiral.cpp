@@ -2,6 +2,7 @@
 
 #include "Spiral.h"
 #include "SpiralVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "EffectStratumBlend.h"
 #include "SpatialLayerCore.h"
@@ -36,6 +37,7 @@ Spiral::Spiral(QWidget* parent) : SpatialEffect3D(parent)
     SetColors(default_colors);
     volume_assist_.setFragmentBody(QString::fromUtf8(SpiralVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&Spiral::BuildCpuRows);
 }
 
 Spiral::~Spiral() = default;
@@ -69,6 +71,107 @@ void Spiral::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, con
     };
     volume_assist_.prepare(render_sequence, time_sec, vp, 11);
 }
+
+SpatialVolumeFieldEngine::CpuRowFn Spiral::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const float progress_e = u[0];
+    const float freq_scale_e = std::max(u[1], 0.01f);
+    const int pattern = (int)(u[2] + 0.5f);
+    const float num_arms = std::max(u[3], 1.0f);
+    const float gap_factor = std::clamp(u[4], 0.0f, 0.95f);
+    const float detail_e = std::max(u[5], 0.05f);
+    const float coil01 = Clamp01(u[6]);
+    const float height01 = Clamp01(u[7]);
+    const Vec3 origin01 = Clamp01(Vec3(u[8], u[9], u[10]));
+
+    const float detail_mul = std::clamp(detail_e / 20.0f, 0.0f, 1.5f);
+    const float coil_rate = coil01 * TWO_PI * (2.2f + 1.4f * detail_mul);
+    const float twist_rate = height01 * TWO_PI * (1.0f + 0.75f * detail_mul);
+    const float period = TWO_PI / num_arms;
+    // Threshold per pattern: the shader remaps the sine patterns above it to 0..1.
+    const float thresh = pattern == 0 ? 0.22f + 0.55f * gap_factor
+                       : pattern == 3 ? 0.18f + 0.50f * gap_factor
+                                      : 0.20f + 0.48f * gap_factor;
+    auto remap = [thresh](float v) { return Clamp01((v - thresh) / std::max(1e-3f, 1.0f - thresh)); };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float norm_twist = Clamp01(row.y01 - origin01.y + 0.5f);
+        const float lz = (row.z01 - origin01.z) * 2.0f;
+        const float z_twist = norm_twist * twist_rate;
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = (row.x01[x] - origin01.x) * 2.0f;
+            const float norm_radius = Clamp01(std::hypot(lx, lz));
+            const float spiral_angle =
+                std::atan2(lz, lx) * num_arms + norm_radius * coil_rate + z_twist - progress_e * 1.35f;
+            float v = 0.5f;
+
+            if(pattern == 0)
+            {
+                v = std::sin(spiral_angle) * (1.0f + 0.4f * std::cos(norm_twist * freq_scale_e * 3.0f + progress_e * 0.7f));
+                v += 0.3f * std::cos(spiral_angle * 0.5f + norm_twist * freq_scale_e * 4.5f + progress_e * 1.2f);
+                v = remap((v + 1.5f) / 3.0f);
+            }
+            else if(pattern == 1 || pattern == 2)
+            {
+                const float arm_angle = Mod(spiral_angle, period);
+                const float blade_width = (1.0f - gap_factor) * period;
+                const float radial_fade = 0.4f + 0.6f * (1.0f - std::exp(-norm_radius * (detail_e * 0.8f)));
+                if(pattern == 1)
+                {
+                    v = arm_angle < blade_width
+                            ? 0.5f + 0.5f * std::cos(arm_angle / std::max(blade_width, 1e-4f) * 3.14159f)
+                            : 0.0f;
+                    v = v * radial_fade + 0.1f * radial_fade;
+                }
+                else
+                {
+                    float blade = 0.0f;
+                    if(arm_angle < blade_width)
+                    {
+                        const float pos = std::fabs(arm_angle - blade_width * 0.5f) / std::max(blade_width * 0.5f, 1e-4f);
+                        blade = 1.0f - pos * pos;
+                    }
+                    const float energy_pulse = 0.2f * std::sin(norm_radius * (detail_e * 1.2f) - progress_e * 2.0f);
+                    v = std::max(0.0f, blade + energy_pulse) * radial_fade;
+                }
+            }
+            else if(pattern == 3)
+            {
+                v = 0.5f + 0.5f * std::sin(spiral_angle + norm_radius * (detail_e * 2.0f)) * (1.0f - norm_radius * 0.3f);
+                v = remap(v);
+            }
+            else if(pattern == 4)
+            {
+                v = 0.5f + 0.5f * std::sin(spiral_angle - progress_e * 0.65f) *
+                               std::cos(norm_twist * freq_scale_e * 3.0f + progress_e);
+                v = remap(v);
+            }
+            else
+            {
+                // Simple Spin: clean rotating blades; Coil bends them into a spiral.
+                const float arm_angle = Mod(spiral_angle, period);
+                const float blade_width = (1.0f - gap_factor) * period * 0.85f;
+                const float blade_core = arm_angle < blade_width ? 1.0f - arm_angle / std::max(blade_width, 1e-4f) : 0.0f;
+                float blade_glow = 0.0f;
+                if(arm_angle < blade_width * 1.5f)
+                {
+                    const float glow_dist = std::fabs(arm_angle - blade_width * 0.5f) / std::max(blade_width * 0.5f, 1e-4f);
+                    blade_glow = 0.3f * (1.0f - glow_dist);
+                }
+                const float radial_fade = 0.35f + 0.65f * (1.0f - std::min(1.0f, norm_radius) * 0.6f);
+                v = std::min(1.0f, blade_core + blade_glow) * radial_fade + 0.08f * radial_fade;
+            }
+
+            rgb[x * 3 + 0] = Clamp01(v);
+            rgb[x * 3 + 1] = 0.0f;
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
 EffectInfo3D Spiral::GetEffectInfo() const
 {
     EffectInfo3D info;
@@ -205,40 +308,81 @@ void Spiral::OnSpiralParameterChanged()
     emit ParametersChanged();
 }
 
-RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+/** Everything CalculateColorGrid derives from settings / grid / time, resolved once per batch. */
+struct Spiral::SampleFrame
 {
-    Vector3D origin = GetEffectOriginGrid(grid);
+    Vector3D origin{};
+    float boundary_radius_sq = 0.0f;
+    float rate = 0.0f;
+    float detail = 0.0f;
+    float progress = 0.0f;
+    float size_multiplier = 1.0f;
+    bool volume_available = false;
+    bool strip_colormap = false;
+    bool rainbow = false;
+    EffectGridAxisHalfExtents extents{};
+    SpatialLayerCore::MapperSettings strat_map;
+    SpatialLayerCore::Basis compass_basis;
+    SpatialLayerCore::MapperSettings compass_map;
+};
+
+Spiral::SampleFrame Spiral::MakeSampleFrame(float time, const GridContext3D& grid) const
+{
+    SampleFrame f;
+    f.origin = GetEffectOriginGrid(grid);
+    f.boundary_radius_sq = EffectBoundaryRadiusSq(grid);
+    f.rate = GetScaledFrequency();
+    f.detail = std::max(0.05f, GetScaledDetail());
+    f.progress = CalculateProgress(time);
+    f.size_multiplier = GetNormalizedSize();
+    f.volume_available = volume_assist_.isAvailable();
+    f.strip_colormap = UseEffectStripColormap();
+    f.rainbow = GetRainbowMode();
+    f.extents = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
+    EffectStratumBlend::InitStratumBreaks(f.strat_map);
+
+    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), f.compass_basis);
+    f.compass_map.floor_end = 0.30f;
+    f.compass_map.desk_end = 0.55f;
+    f.compass_map.upper_end = 0.78f;
+    f.compass_map.blend_softness =
+        std::clamp(0.08f + 0.05f * (1.0f - f.detail), 0.05f, 0.20f);
+    f.compass_map.center_size = std::clamp(0.10f + 0.22f * f.size_multiplier, 0.06f, 0.50f);
+    f.compass_map.directional_sharpness = std::clamp(1.0f + f.detail * 0.15f, 0.85f, 2.4f);
+    return f;
+}
+
+void Spiral::ShadeSample(const SampleFrame& f,
+                         float x,
+                         float y,
+                         float z,
+                         float time,
+                         const GridContext3D& grid,
+                         PaletteSample& s) const
+{
+    const Vector3D& origin = f.origin;
     float rel_x = x - origin.x;
     float rel_y = y - origin.y;
     float rel_z = z - origin.z;
 
-    if(!IsWithinEffectBoundary(rel_x, rel_y, rel_z, grid))
+    if(rel_x * rel_x + rel_y * rel_y + rel_z * rel_z > f.boundary_radius_sq)
     {
-        return 0x00000000;
+        return;
     }
 
-    float rate = GetScaledFrequency();
-    float detail = std::max(0.05f, GetScaledDetail());
-    progress = CalculateProgress(time);
-
-    float size_multiplier = GetNormalizedSize();
-
     Vector3D rotated_pos{x, y, z};
-    float rot_rel_x = rotated_pos.x - origin.x;
-    float rot_rel_z = rotated_pos.z - origin.z;
+    float rot_rel_x = rel_x;
+    float rot_rel_z = rel_z;
 
     float angle = atan2(rot_rel_z, rot_rel_x);
-    EffectGridAxisHalfExtents ex = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
-    float r_xz = EffectGridHorizontalRadialNormXZ(rot_rel_x, rot_rel_z, ex.hw, ex.hd);
+    float r_xz = EffectGridHorizontalRadialNormXZ(rot_rel_x, rot_rel_z, f.extents.hw, f.extents.hd);
     float norm_radius = EffectGridHorizontalRadialNorm01(r_xz);
     norm_radius = fmaxf(0.0f, fminf(1.0f, norm_radius));
 
     float norm_twist = NormalizeGridAxis01(rotated_pos.y, grid.min_y, grid.max_y);
 
-    SpatialLayerCore::MapperSettings strat_map;
-    EffectStratumBlend::InitStratumBreaks(strat_map);
     float sw[3];
-    EffectStratumBlend::WeightsForYNorm(norm_twist, strat_map, sw);
+    EffectStratumBlend::WeightsForYNorm(norm_twist, f.strat_map, sw);
     const EffectStratumBlend::BandBlendScalars bb =
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), sw, GetStratumTuning());
     const float stratum_mot01 =
@@ -246,9 +390,9 @@ RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const
     float spd_mul = bb.speed_mul;
     float tight_mul = bb.tight_mul;
 
-    const float detail_e = detail * tight_mul;
-    const float rate_e = rate * spd_mul;
-    const float progress_e = progress * spd_mul;
+    const float detail_e = f.detail * tight_mul;
+    const float rate_e = f.rate * spd_mul;
+    const float progress_e = f.progress * spd_mul;
     const float coil01 = coil_amount / 100.0f;
     const float height01 = height_coil_amount / 100.0f;
     const float two_pi = 6.2831853f;
@@ -259,7 +403,7 @@ RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const
     spiral_angle += stratum_mot01 * 6.2831853f * 0.55f;
 
     float spiral_value = 0.0f;
-    if(volume_assist_.isAvailable())
+    if(f.volume_available)
     {
         const float c1 = NormalizeGridAxis01(rotated_pos.x, grid.min_x, grid.max_x);
         const float c2 = norm_twist;
@@ -267,34 +411,6 @@ RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const
         spiral_value = volume_assist_.sampleScalar01(c1, c2, c3);
     }
 
-    const float phase01 =
-        std::fmod(progress_e * 0.25f + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
-    float strip_p01 = 0.0f;
-    if(UseEffectStripColormap())
-    {
-        strip_p01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
-                                               GetEffectStripColormapRepeats(),
-                                               GetEffectStripColormapUnfold(),
-                                               GetEffectStripColormapDirectionDeg(),
-                                               phase01,
-                                               time,
-                                               grid,
-                                               size_multiplier,
-                                               origin,
-                                               rotated_pos);
-    }
-
-    SpatialLayerCore::Basis compass_basis;
-    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), compass_basis);
-    SpatialLayerCore::MapperSettings compass_map;
-    compass_map.floor_end = 0.30f;
-    compass_map.desk_end = 0.55f;
-    compass_map.upper_end = 0.78f;
-    compass_map.blend_softness =
-        std::clamp(0.08f + 0.05f * (1.0f - detail), 0.05f, 0.20f);
-    compass_map.center_size = std::clamp(0.10f + 0.22f * size_multiplier, 0.06f, 0.50f);
-    compass_map.directional_sharpness = std::clamp(1.0f + detail * 0.15f, 0.85f, 2.4f);
-
     SpatialLayerCore::SamplePoint compass_sample{};
     compass_sample.grid_x = x;
     compass_sample.grid_y = y;
@@ -304,44 +420,61 @@ RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const
     compass_sample.origin_z = origin.z;
     compass_sample.y_norm = norm_twist;
 
-    RGBColor final_color;
-    if(UseEffectStripColormap())
+    if(f.strip_colormap)
     {
+        const float phase01 =
+            std::fmod(progress_e * 0.25f + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
+        float strip_p01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
+                                                     GetEffectStripColormapRepeats(),
+                                                     GetEffectStripColormapUnfold(),
+                                                     GetEffectStripColormapDirectionDeg(),
+                                                     phase01,
+                                                     time,
+                                                     grid,
+                                                     f.size_multiplier,
+                                                     origin,
+                                                     rotated_pos);
         float textured_p01 = std::fmod(strip_p01 + spiral_value * 0.35f + 1.0f, 1.0f);
         float p01v = textured_p01;
-        final_color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
+        s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
     }
-    else if((pattern_type == 1 || pattern_type == 2 || pattern_type == 5) && !GetRainbowMode())
+    else if((pattern_type == 1 || pattern_type == 2 || pattern_type == 5) && !f.rainbow)
     {
         float arm_index = fmod(spiral_angle / (6.28318f / num_arms), (float)num_arms);
         if(arm_index < 0) arm_index += num_arms;
         float pos = fmodf((arm_index / (float)num_arms) + time * rate_e * 0.02f, 1.0f);
         if(pos < 0.0f) pos += 1.0f;
-        float p = ApplySpatialPalette01(pos, compass_basis, compass_sample, compass_map, time, &grid);
-        final_color = GetColorAtPosition(p);
+        s.lookup = PaletteSample::PALETTE;
+        s.key = ApplySpatialPalette01(pos, f.compass_basis, compass_sample, f.compass_map, time, &grid);
     }
-    else if(GetRainbowMode())
+    else if(f.rainbow)
     {
         float hue = spiral_angle * 57.2958f + spiral_value * 200.0f + norm_twist * 40.0f + time * rate_e * 12.0f;
-        hue = ApplySpatialRainbowHue(hue, fmodf(spiral_value + 0.25f, 1.0f), compass_basis, compass_sample, compass_map, time, &grid);
+        hue = ApplySpatialRainbowHue(hue, fmodf(spiral_value + 0.25f, 1.0f), f.compass_basis, compass_sample, f.compass_map, time, &grid);
         float p01 = std::fmod(hue / 360.0f, 1.0f);
         if(p01 < 0.0f)
         {
             p01 += 1.0f;
         }
-        final_color = GetRainbowColor(p01 * 360.0f);
+        s.lookup = PaletteSample::HUE;
+        s.key = p01 * 360.0f;
     }
     else
     {
         float pos = fmodf(spiral_value + time * rate_e * 0.02f, 1.0f);
         if(pos < 0.0f) pos += 1.0f;
-        float p = ApplySpatialPalette01(pos, compass_basis, compass_sample, compass_map, time, &grid);
-        final_color = GetColorAtPosition(p);
+        s.lookup = PaletteSample::PALETTE;
+        s.key = ApplySpatialPalette01(pos, f.compass_basis, compass_sample, f.compass_map, time, &grid);
     }
 
     float spiral_mask = std::clamp(spiral_value, 0.0f, 1.0f);
-    spiral_mask = std::pow(spiral_mask, 0.85f);
+    s.gain = std::pow(spiral_mask, 0.85f);
+}
 
+RGBColor Spiral::FinishSample(const PaletteSample& s)
+{
+    const RGBColor final_color = s.color;
+    const float spiral_mask = s.gain;
     unsigned char r = final_color & 0xFF;
     unsigned char g = (final_color >> 8) & 0xFF;
     unsigned char b = (final_color >> 16) & 0xFF;
@@ -351,6 +484,30 @@ RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const
     return (b << 16) | (g << 8) | r;
 }
 
+RGBColor Spiral::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+{
+    PaletteSample s;
+    ShadeSample(MakeSampleFrame(time, grid), x, y, z, time, grid, s);
+    ResolvePaletteSamples(&s, 1);
+    return FinishSample(s);
+}
+
+void Spiral::CalculateColorGridBatch(const float* xs,
+                                     const float* ys,
+                                     const float* zs,
+                                     size_t count,
+                                     float time,
+                                     const GridContext3D& grid,
+                                     RGBColor* out)
+{
+    const SampleFrame f = MakeSampleFrame(time, grid);
+    ShadePaletteBatch(
+        count,
+        out,
+        [&](size_t i, PaletteSample& s) { ShadeSample(f, xs[i], ys[i], zs[i], time, grid, s); },
+        &Spiral::FinishSample);
+}
+
 nlohmann::json Spiral::SaveSettings() const
 {
     nlohmann::json j = SpatialEffect3D::SaveSettings();
@@ -25,13 +25,36 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool SupportsConcurrentEvaluation() const override { return true; }
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
+protected:
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+
 private slots:
     void OnSpiralParameterChanged();
 private:
+    struct SampleFrame;
+    SampleFrame MakeSampleFrame(float time, const GridContext3D& grid) const;
+    void ShadeSample(const SampleFrame& f,
+                     float x,
+                     float y,
+                     float z,
+                     float time,
+                     const GridContext3D& grid,
+                     PaletteSample& s) const;
+    /** Applies the spiral mask once the sample's palette lookup has resolved. */
+    static RGBColor FinishSample(const PaletteSample& s);
+
     static constexpr int kSpiralPatternCount = 6;
 
     QSlider*   arms_slider = nullptr;
@@ -46,6 +69,8 @@ private:
     unsigned int    coil_amount = 25;       // 0 = straight spin rays, 100 = tight spiral
     unsigned int    height_coil_amount = 15; // 0 = flat spin, 100 = strong vertical helix
     float           progress;
+    /** CPU port of SpiralVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist volume_assist_;
 };
 
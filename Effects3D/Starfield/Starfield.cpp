@@ -7,6 +7,7 @@
 #include "SpatialLayerCore.h"
 #include <algorithm>
 #include <cmath>
+#include <vector>
 #include <QComboBox>
 #include "EffectUiRows.h"
 #include "EffectUiSync.h"
@@ -17,33 +18,27 @@ namespace
 {
 constexpr float kTau = 6.28318530718f;
 
-float hash_float(unsigned int seed, unsigned int salt)
+float saturate(float v)
 {
-    unsigned int v = seed * 73856093u ^ salt * 19349663u;
-    v = (v << 13u) ^ v;
-    v = v * (v * v * 15731u + 789221u) + 1376312589u;
-    return ((v & 0xFFFFu) / 65535.0f) * 2.0f - 1.0f;
+    return std::clamp(v, 0.0f, 1.0f);
 }
 
-float hash01(unsigned int seed, unsigned int salt)
+float smoothstep(float e0, float e1, float x)
 {
-    return hash_float(seed, salt) * 0.5f + 0.5f;
+    const float t = saturate((x - e0) / (e1 - e0));
+    return t * t * (3.0f - 2.0f * t);
 }
 
-float frac01(float v)
+/** hash11 from StarfieldVolumeFieldGlsl, so CPU bakes place the same stars. */
+float hash11(float n)
 {
+    const float v = std::sin(n * 127.1f) * 43758.5453f;
     return v - std::floor(v);
 }
 
-float saturate(float v)
-{
-    return std::clamp(v, 0.0f, 1.0f);
-}
-
-float sparkle_flash(float phase, float sharpness)
+float hash_signed(float n)
 {
-    const float s = std::max(0.0f, std::sin(phase));
-    return std::pow(s, std::max(4.0f, sharpness));
+    return hash11(n) * 2.0f - 1.0f;
 }
 
 RGBColor PackRGB(float r, float g, float b, float intensity)
@@ -86,6 +81,7 @@ Starfield::Starfield(QWidget* parent) : SpatialEffect3D(parent)
     volume_assist_.setFragmentBody(QString::fromUtf8(StarfieldVolumeFieldGlsl()));
     // Moderate atlas: particle loop is inside the shader, keep voxels lean.
     volume_assist_.setResolution(16);
+    volume_assist_.setCpuField([this](const SpatialVolumeFieldEngine::CpuBakeContext& ctx) { return BuildCpuRows(ctx); });
 }
 
 EffectInfo3D Starfield::GetEffectInfo() const
@@ -277,157 +273,274 @@ void Starfield::PrepareGpuFields(std::uint64_t render_sequence, float time_sec,
     volume_assist_.prepare(render_sequence, time_sec, vp, 13);
 }
 
-RGBColor Starfield::AccumParticles(const EvalContext& ctx, int mode_i) const
+SpatialVolumeFieldEngine::CpuRowFn Starfield::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
 {
-    // Slim CPU fallback — fewer particles, one color resolve after accumulate.
-    const int n = std::max(8, std::min(kMaxCpuParticles, ctx.particle_count));
-    const ViewSample& led = ctx.view;
-
-    const float sway = ctx.drift * 0.18f;
-    const float sway_c = std::cos(ctx.time * 0.35f * sway * 6.0f + 0.4f);
-    const float sway_s = std::sin(ctx.time * 0.28f * sway * 6.0f);
-    const float led_vx = led.vx * (1.0f + sway * 0.08f * sway_c) - led.vy * sway * 0.12f * sway_s;
-    const float led_vy = led.vy * (1.0f + sway * 0.08f * sway_c) + led.vx * sway * 0.12f * sway_s;
-    const float led_vz = led.vz;
-
-    const float base_thick = std::max(0.012f, ctx.thickness * 0.40f * ctx.size_m);
-    float sum_i = 0.0f, sum_p = 0.0f, sum_h = 0.0f;
-
-    for(int i = 0; i < n; i++)
+    const float* u = ctx.params;
+    const float progress = u[0];
+    const float time_sec = u[1];
+    const int mode = (int)(std::clamp(u[2], 0.0f, 5.0f) + 0.5f);
+    const int count = (int)(std::clamp(u[3], 8.0f, 48.0f) + 0.5f);
+    const float thickness = std::max(u[4], 0.02f);
+    const float size_m = std::max(u[5], 0.25f);
+    const float fill = std::clamp(u[6], 0.4f, 1.0f);
+    const float drift = saturate(u[7]);
+    const float twinkle = saturate(u[8]);
+    const float hue_scroll = u[9];
+    const float ox = saturate(u[10]);
+    const float oy = saturate(u[11]);
+    const float oz = saturate(u[12]);
+
+    const float view_scale = 2.0f / fill;
+    const float sway = drift * 0.18f;
+    const float sway_a = sway * 0.08f * std::cos(time_sec * 0.35f * sway * 6.0f + 0.4f);
+    const float sway_b = sway * 0.12f * std::sin(time_sec * 0.28f * sway * 6.0f);
+
+    StarTable& t = star_table_;
+    t.Resize(mode < 4 ? count : 0);
+    if(mode < 4)
     {
-        const float dir_x = hash_float((unsigned int)i, 31u);
-        const float dir_y = hash_float((unsigned int)i, 32u);
-        const float dir_len = std::sqrt(dir_x * dir_x + dir_y * dir_y) + 1e-4f;
-        const float ux = dir_x / dir_len;
-        const float uy = dir_y / dir_len;
-        const float aim = 0.15f + 0.95f * hash01((unsigned int)i, 33u);
-        const float seed_d = hash01((unsigned int)i, 34u);
-
-        float depth, stretch = 1.0f, bright = 1.0f;
-        if(mode_i == MODE_TWINKLE)
+        const float base_thick = std::max(0.012f, thickness * 0.40f * size_m);
+        for(int i = 0; i < count; i++)
         {
-            depth = 0.35f + 0.60f * seed_d;
-            const float rate = 1.0f + ctx.twinkle * 5.0f + hash01((unsigned int)i, 35u) * 3.0f;
-            const float ph = ctx.time * rate * 0.8f + seed_d * kTau;
-            bright = 0.14f + 0.86f * sparkle_flash(ph, 12.0f);
-        }
-        else
-        {
-            float travel = ctx.progress * 0.22f;
-            if(mode_i == MODE_WARP)
-                travel *= 1.35f;
-            if(mode_i == MODE_HYPERDRIVE)
-                travel *= 2.05f;
-            depth = frac01(seed_d - travel);
-            const float nearness = 1.0f - depth;
-            if(mode_i == MODE_STARS)
+            const float fi = (float)i;
+            const float dir_x = hash_signed(fi * 12.9898f + 31.0f);
+            const float dir_y = hash_signed(fi * 78.233f + 32.0f);
+            const float dir_len = std::sqrt(dir_x * dir_x + dir_y * dir_y) + 1e-4f;
+            const float ux = dir_x / dir_len;
+            const float uy = dir_y / dir_len;
+            const float aim = 0.15f + 0.95f * hash11(fi * 45.1f + 33.0f);
+            const float seed_d = hash11(fi * 91.7f + 34.0f);
+
+            float depth;
+            float stretch = 1.0f;
+            float bright = 1.0f;
+            float hot = 0.0f;
+            float cross = 0.0f;
+            if(mode == 1)
             {
-                stretch = 1.0f + nearness * nearness * (2.2f + 2.0f * ctx.size_m);
-                bright = 0.35f + 0.65f * nearness;
-            }
-            else if(mode_i == MODE_WARP)
-            {
-                stretch = 1.0f + nearness * (8.0f + 10.0f * ctx.size_m);
-                bright = 0.25f + 0.90f * nearness;
+                depth = 0.35f + 0.60f * seed_d;
+                const float rate = 1.0f + twinkle * 5.0f + hash11(fi + 35.0f) * 3.0f;
+                const float ph = time_sec * rate * 0.8f + seed_d * kTau;
+                bright = 0.14f + 0.86f * std::pow(std::max(0.0f, std::sin(ph)), 12.0f);
+                hot = saturate((bright - 0.5f) * 1.2f);
+                cross = 1.2f * std::pow(std::max(0.0f, std::sin(time_sec * (2.0f + twinkle * 4.0f) + fi)), 10.0f);
             }
             else
             {
-                stretch = 1.0f + nearness * (14.0f + 16.0f * ctx.size_m);
-                bright = 0.20f + 1.10f * nearness;
+                float travel = progress * 0.22f;
+                if(mode == 2)
+                    travel *= 1.35f;
+                if(mode == 3)
+                    travel *= 2.05f;
+                const float d = seed_d - travel;
+                depth = d - std::floor(d);
+                const float nearness = 1.0f - depth;
+                if(mode == 0)
+                {
+                    stretch = 1.0f + nearness * nearness * (2.2f + 2.0f * size_m);
+                    bright = 0.35f + 0.65f * nearness;
+                    if(twinkle > 0.01f)
+                    {
+                        const float ph = time_sec * (1.5f + twinkle * 2.5f) + fi;
+                        bright *= 0.75f + 0.25f * std::pow(std::max(0.0f, std::sin(ph)), 6.0f);
+                    }
+                }
+                else if(mode == 2)
+                {
+                    stretch = 1.0f + nearness * (8.0f + 10.0f * size_m);
+                    bright = 0.25f + 0.90f * nearness;
+                    hot = saturate(nearness * 0.45f);
+                }
+                else
+                {
+                    stretch = 1.0f + nearness * (14.0f + 16.0f * size_m);
+                    bright = 0.20f + 1.10f * nearness;
+                    hot = saturate(nearness * 0.75f);
+                }
             }
+
+            const float persp = 1.0f / std::max(0.06f, 0.08f + depth * 0.92f);
+            float mz = -1.0f;
+            if(mode == 2 || mode == 3)
+                mz = -0.35f - 0.65f * (1.0f - depth);
+            const float mlen = std::sqrt(ux * ux + uy * uy + mz * mz) + 1e-4f;
+
+            float thick = base_thick;
+            if(mode == 1)
+                thick *= 0.70f;
+            if(mode == 3)
+                thick *= 0.85f;
+            const float along_sig = thick * stretch;
+            const float across_sig = thick * ((mode == 1) ? 0.85f : 1.0f);
+
+            t.px[i] = ux * aim * persp * 0.95f;
+            t.py[i] = uy * aim * persp * 0.95f;
+            t.pz[i] = depth * 2.0f - 1.0f;
+            t.mx[i] = ux / mlen;
+            t.my[i] = uy / mlen;
+            t.mz[i] = mz / mlen;
+            t.inv_along2[i] = 1.0f / (along_sig * along_sig);
+            t.inv_across2[i] = 1.0f / (across_sig * across_sig);
+            t.bright[i] = bright;
+            t.nearness[i] = 1.0f - depth;
+            t.hot[i] = hot;
+            t.cross[i] = cross;
+            // d2 <= 10 bounds |along| and |across| by sqrt(10) sigmas each.
+            t.reach_along[i] = 3.1623f * along_sig;
+            t.reach_across[i] = 3.1623f * across_sig;
         }
 
-        const float persp = 1.0f / std::max(0.06f, 0.08f + depth * 0.92f);
-        const float px = ux * aim * persp * 0.95f;
-        const float py = uy * aim * persp * 0.95f;
-        const float pz = depth * 2.0f - 1.0f;
-
-        float dx = led_vx - px, dy = led_vy - py, dz = led_vz - pz;
-        float mx = ux, my = uy, mz = -1.0f;
-        if(mode_i == MODE_WARP || mode_i == MODE_HYPERDRIVE)
-            mz = -0.35f - 0.65f * (1.0f - depth);
-        const float mlen = std::sqrt(mx * mx + my * my + mz * mz) + 1e-4f;
-        mx /= mlen;
-        my /= mlen;
-        mz /= mlen;
-
-        const float along = dx * mx + dy * my + dz * mz;
-        const float ax = dx - along * mx, ay = dy - along * my, az = dz - along * mz;
-        const float across2 = ax * ax + ay * ay + az * az;
-        float thick = base_thick * ((mode_i == MODE_TWINKLE) ? 0.70f : (mode_i == MODE_HYPERDRIVE ? 0.85f : 1.0f));
-        const float along_sig = thick * stretch;
-        const float across_sig = thick;
-        const float d2 = (along * along) / (along_sig * along_sig) + across2 / (across_sig * across_sig);
-        if(d2 > 10.0f)
-            continue;
-
-        float contrib = std::exp(-d2) * bright;
-        if(contrib < 0.02f)
-            continue;
-
-        float hot = 0.0f;
-        if(mode_i == MODE_WARP || mode_i == MODE_HYPERDRIVE)
-            hot = saturate((1.0f - depth) * (mode_i == MODE_HYPERDRIVE ? 0.75f : 0.45f));
-        else if(mode_i == MODE_TWINKLE)
-            hot = saturate((bright - 0.5f) * 1.2f);
-
-        sum_i += contrib;
-        sum_p += (1.0f - depth) * contrib;
-        sum_h += hot * contrib;
+        // View-space box of the atlas: z is a plain scale, x/y also pass through the sway shear.
+        float lo[3] = {1e9f, 1e9f, (0.0f - oz) * view_scale};
+        float hi[3] = {-1e9f, -1e9f, (1.0f - oz) * view_scale};
+        for(int corner = 0; corner < 4; corner++)
+        {
+            const float lx = (((corner & 1) ? 1.0f : 0.0f) - ox) * view_scale;
+            const float ly = (((corner & 2) ? 1.0f : 0.0f) - oy) * view_scale;
+            const float vx = lx * (1.0f + sway_a) - ly * sway_b;
+            const float vy = ly * (1.0f + sway_a) + lx * sway_b;
+            lo[0] = std::min(lo[0], vx);
+            hi[0] = std::max(hi[0], vx);
+            lo[1] = std::min(lo[1], vy);
+            hi[1] = std::max(hi[1], vy);
+        }
+        star_bins_.Build(lo, hi, kStarBinsPerAxis, count, [&t](int i, float* p_lo, float* p_hi) {
+            const float m[3] = {t.mx[i], t.my[i], t.mz[i]};
+            const float c[3] = {t.px[i], t.py[i], t.pz[i]};
+            for(int a = 0; a < 3; a++)
+            {
+                const float reach = std::fabs(m[a]) * t.reach_along[i] + t.reach_across[i];
+                p_lo[a] = c[a] - reach;
+                p_hi[a] = c[a] + reach;
+            }
+            return true;
+        });
     }
 
-    if(sum_i < 1e-5f)
-        return 0x00000000;
-    const float intensity = std::clamp(sum_i * (mode_i == MODE_HYPERDRIVE ? 1.15f : 0.95f), 0.0f, 1.0f);
-    const float palette01 = frac01(sum_p / sum_i);
-    const float hotness = saturate(sum_h / sum_i);
-    return FinishSample(ctx, intensity, palette01, hotness, mode_i);
-}
+    const StarTable* table = &t;
+    const VolumeParticleBins* bins = &star_bins_;
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ly = (row.y01 - oy) * view_scale;
+        const float led_vz = (row.z01 - oz) * view_scale;
+        const float gate_z = smoothstep(-1.25f, -0.85f, led_vz);
 
-RGBColor Starfield::EvalBlackhole(const EvalContext& ctx) const
-{
-    const ViewSample& v = ctx.view;
-    const float r_xy = std::max(1e-4f, v.radial);
-    const float ang = v.ang + ctx.drift * 0.25f * std::sin(ctx.time * 0.4f);
-    const float horizon = 0.14f + 0.05f * ctx.thickness;
-    if(r_xy < horizon && v.vz > -0.2f)
-        return 0x00000000;
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = (row.x01[x] - ox) * view_scale;
+            const float led_vx = lx * (1.0f + sway_a) - ly * sway_b;
+            const float led_vy = ly * (1.0f + sway_a) + lx * sway_b;
+            const float radial = std::sqrt(led_vx * led_vx + led_vy * led_vy);
+            float intensity = 0.0f;
+            float palette01 = 0.5f;
+            float hotness = 0.0f;
+
+            if(mode == 4)
+            {
+                const float r_xy = std::max(radial, 1e-4f);
+                const float horizon = 0.14f + 0.05f * thickness;
+                if(r_xy < horizon && led_vz > -0.2f)
+                {
+                    rgb[x * 3 + 0] = rgb[x * 3 + 1] = rgb[x * 3 + 2] = 0.0f;
+                    continue;
+                }
+                const float ang = std::atan2(led_vy, led_vx);
+                const float disk_thick = std::max(0.04f, thickness * 0.50f * size_m);
+                const float plane = std::exp(-(led_vz * led_vz) / (disk_thick * disk_thick * 4.0f))
+                                    * std::exp(-(led_vy * led_vy) / (disk_thick * disk_thick));
+                const float disk = plane * smoothstep(horizon * 1.1f, horizon * 1.6f, r_xy)
+                                   * (1.0f - smoothstep(0.55f, 1.15f, r_xy));
+                const float spiral = 0.5f + 0.5f * std::sin(4.0f * ang - std::log(r_xy) * 3.8f - progress * 3.5f);
+                const float pr = (r_xy - horizon * 1.35f) / (0.04f + 0.03f * thickness);
+                const float photon = std::exp(-pr * pr);
+                const float lr = (r_xy - horizon) / 0.08f;
+                const float lens = std::exp(-lr * lr) * 0.45f;
+                const float led_len = std::sqrt(lx * lx + ly * ly + led_vz * led_vz);
+                intensity = disk * (0.30f + 0.70f * spiral) + photon * 1.4f + lens;
+                intensity *= 1.0f - smoothstep(0.9f, 1.3f, led_len);
+                const float pal = 1.0f - r_xy + hue_scroll;
+                palette01 = pal - std::floor(pal);
+                hotness = saturate(1.0f - (r_xy - horizon) / 0.5f) * 0.55f + photon * 0.4f;
+            }
+            else if(mode == 5)
+            {
+                const float ang = std::atan2(led_vy, led_vx);
+                const float depth = saturate(led_vz * 0.5f + 0.5f);
+                const float tunnel_r = 0.38f + 0.20f * size_m;
+                const float wall_w = std::max(0.03f, thickness * 0.50f * size_m);
+                const float wr = (radial - tunnel_r) / wall_w;
+                const float wall = std::exp(-wr * wr);
+                const float rings = 0.5f + 0.5f * std::cos((depth * 5.5f + progress * 0.85f) * kTau);
+                const float helix = 0.5f + 0.5f * std::cos(6.0f * ang + depth * (5.0f + drift * 4.0f) - progress * 6.6f);
+                const float perspective = 0.30f + 0.70f * (1.0f - depth);
+                const float core_glow = (1.0f - smoothstep(0.0f, tunnel_r * 0.9f, radial)) * 0.10f
+                                        * (0.35f + 0.65f * rings) * perspective;
+                intensity = wall * (0.28f + 0.40f * rings + 0.48f * helix) * perspective + core_glow;
+                if(radial > tunnel_r + wall_w * 3.0f)
+                    intensity = 0.0f;
+                intensity *= (1.0f - smoothstep(1.05f, 1.35f, std::fabs(led_vx)))
+                             * (1.0f - smoothstep(1.05f, 1.35f, std::fabs(led_vy)));
+                intensity *= 1.25f;
+                const float pal = depth + hue_scroll;
+                palette01 = pal - std::floor(pal);
+                hotness = depth * 0.35f;
+            }
+            else
+            {
+                const float gate = gate_z
+                                   * (1.0f - smoothstep(1.05f, 1.35f, std::fabs(led_vx)))
+                                   * (1.0f - smoothstep(1.05f, 1.35f, std::fabs(led_vy)));
+                // Outside the window every streak is gated to zero; only twinkle flares remain.
+                if(gate > 0.0f || mode == 1)
+                {
+                    float sum_i = 0.0f;
+                    float sum_p = 0.0f;
+                    float sum_h = 0.0f;
+                    const std::uint16_t* it = nullptr;
+                    const std::uint16_t* end = nullptr;
+                    bins->Lookup(led_vx, led_vy, led_vz, &it, &end);
+                    for(; it != end; ++it)
+                    {
+                        const int i = *it;
+                        const float dx = led_vx - table->px[i];
+                        const float dy = led_vy - table->py[i];
+                        const float dz = led_vz - table->pz[i];
+                        const float along = dx * table->mx[i] + dy * table->my[i] + dz * table->mz[i];
+                        const float ax = dx - table->mx[i] * along;
+                        const float ay = dy - table->my[i] * along;
+                        const float az = dz - table->mz[i] * along;
+                        const float d2 = along * along * table->inv_along2[i]
+                                         + (ax * ax + ay * ay + az * az) * table->inv_across2[i];
+                        if(d2 > 10.0f)
+                            continue;
+
+                        float contrib = std::exp(-d2) * table->bright[i] * gate;
+                        if(mode == 1)
+                            contrib = std::max(contrib, std::exp(-(std::fabs(dx) + std::fabs(dy)) * 18.0f) * table->cross[i]);
+                        if(contrib < 0.02f)
+                            continue;
+
+                        sum_i += contrib;
+                        sum_p += table->nearness[i] * contrib;
+                        sum_h += table->hot[i] * contrib;
+                    }
+                    if(sum_i > 1e-5f)
+                    {
+                        intensity = saturate(sum_i * ((mode == 3) ? 1.15f : 0.95f));
+                        const float pal = sum_p / sum_i + hue_scroll;
+                        palette01 = pal - std::floor(pal);
+                        hotness = saturate(sum_h / sum_i);
+                    }
+                }
+            }
 
-    const float disk_thick = std::max(0.04f, ctx.thickness * 0.50f * ctx.size_m);
-    const float plane = std::exp(-(v.vz * v.vz) / (disk_thick * disk_thick * 4.0f))
-                        * std::exp(-(v.vy * v.vy) / (disk_thick * disk_thick));
-    const float disk = plane * saturate((r_xy - horizon * 1.1f) / std::max(1e-4f, horizon * 0.5f))
-                       * saturate((1.15f - r_xy) / 0.60f);
-    const float spiral = 0.5f + 0.5f * std::sin(4.0f * ang - std::log(r_xy) * 3.8f - ctx.progress * 3.5f);
-    const float photon = std::exp(-std::pow((r_xy - horizon * 1.35f) / (0.04f + 0.03f * ctx.thickness), 2.0f));
-    const float lens = std::exp(-std::pow((r_xy - horizon) / 0.08f, 2.0f)) * 0.45f;
-    float intensity = disk * (0.30f + 0.70f * spiral) + photon * 1.4f + lens;
-    if(intensity < 0.02f)
-        return 0x00000000;
-    const float hotness = saturate(1.0f - (r_xy - horizon) / 0.5f) * 0.55f + photon * 0.4f;
-    return FinishSample(ctx, intensity, saturate(1.0f - r_xy), hotness, MODE_BLACKHOLE);
+            rgb[x * 3 + 0] = saturate(intensity);
+            rgb[x * 3 + 1] = palette01 - std::floor(palette01);
+            rgb[x * 3 + 2] = saturate(hotness);
+        }
+    };
 }
 
-RGBColor Starfield::EvalWormhole(const EvalContext& ctx) const
-{
-    const ViewSample& v = ctx.view;
-    const float rad = v.radial;
-    const float ang = v.ang;
-    const float depth = saturate(v.vz * 0.5f + 0.5f);
-    const float tunnel_r = 0.38f + 0.20f * ctx.size_m;
-    const float wall_w = std::max(0.03f, ctx.thickness * 0.50f * ctx.size_m);
-    const float wall = std::exp(-std::pow((rad - tunnel_r) / wall_w, 2.0f));
-    const float rings = 0.5f + 0.5f * std::cos((depth * 5.5f + ctx.progress * 0.85f) * kTau);
-    const float helix = 0.5f + 0.5f * std::cos(6.0f * ang + depth * (5.0f + ctx.drift * 4.0f) - ctx.progress * 6.6f);
-    const float perspective = 0.30f + 0.70f * (1.0f - depth);
-    float intensity = wall * (0.28f + 0.40f * rings + 0.48f * helix) * perspective;
-    if(rad > tunnel_r + wall_w * 3.0f)
-        intensity = 0.0f;
-    intensity *= 1.25f;
-    if(intensity < 0.02f)
-        return 0x00000000;
-    return FinishSample(ctx, intensity, depth, depth * 0.35f, MODE_WORMHOLE);
-}
 
 RGBColor Starfield::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
@@ -7,6 +7,9 @@
 #include "EffectRegisterer3D.h"
 #include "EffectStratumBlend.h"
 #include "Shaders/SpatialVolumeFieldAssist.h"
+#include "Shaders/VolumeParticleBins.h"
+
+#include <vector>
 
 class Starfield : public SpatialEffect3D
 {
@@ -20,6 +23,7 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
@@ -35,7 +39,7 @@ private:
         MODE_COUNT
     };
     static constexpr int kMaxGpuParticles = 48;
-    static constexpr int kMaxCpuParticles = 36;
+    static constexpr int kStarBinsPerAxis = 8;
     static const char* ModeName(int m);
 
     struct ViewSample
@@ -75,9 +79,28 @@ private:
     ViewSample MakeViewSample(const Vector3D& rp, const Vector3D& origin, const EffectGridAxisHalfExtents& e, float fill) const;
     RGBColor ResolveSpaceColor(const EvalContext& ctx, float pos01, float hue_shift) const;
     RGBColor FinishSample(const EvalContext& ctx, float intensity, float palette01, float hotness, int mode_i) const;
-    RGBColor AccumParticles(const EvalContext& ctx, int mode_i) const;
-    RGBColor EvalBlackhole(const EvalContext& ctx) const;
-    RGBColor EvalWormhole(const EvalContext& ctx) const;
+
+    /** Particle state for the CPU atlas bake, one entry per star (SoA, rebuilt each frame). */
+    struct StarTable
+    {
+        std::vector<float> px, py, pz;
+        std::vector<float> mx, my, mz;
+        std::vector<float> inv_along2, inv_across2;
+        std::vector<float> reach_along, reach_across;
+        std::vector<float> bright, nearness, hot, cross;
+
+        void Resize(int n)
+        {
+            for(std::vector<float>* v : {&px, &py, &pz, &mx, &my, &mz, &inv_along2, &inv_across2,
+                                         &reach_along, &reach_across, &bright, &nearness, &hot, &cross})
+            {
+                v->resize((size_t)n);
+            }
+        }
+    };
+
+    /** CPU port of StarfieldVolumeFieldGlsl (SpatialVolumeFieldCpuBaker); fills star_table_ / star_bins_. */
+    SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
 
     int mode = MODE_STARS;
     int num_stars = 32;
@@ -85,6 +108,8 @@ private:
     float drift_amount = 0.12f;
     float twinkle_speed = 0.45f;
     float fill_amount = 1.0f;
+    StarTable star_table_;
+    VolumeParticleBins star_bins_;
     SpatialVolumeFieldAssist volume_assist_;
 };
 
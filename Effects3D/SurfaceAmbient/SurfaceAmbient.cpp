@@ -2,6 +2,7 @@
 
 #include "SurfaceAmbient.h"
 #include "SurfaceAmbientVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "EffectHelpers.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
@@ -340,6 +341,7 @@ SurfaceAmbient::SurfaceAmbient(QWidget* parent) : SpatialEffect3D(parent)
 {
     volume_assist_.setFragmentBody(QString::fromUtf8(SurfaceAmbientVolumeFieldGlsl()));
     volume_assist_.setResolution(20);
+    volume_assist_.setCpuField(&SurfaceAmbient::BuildCpuRows);
 }
 
 void SurfaceAmbient::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& /*grid*/)
@@ -381,6 +383,74 @@ void SurfaceAmbient::PrepareGpuFields(std::uint64_t render_sequence, float time_
     volume_assist_.prepare(render_sequence, time_sec, vp, 8);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn SurfaceAmbient::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    const float* u = ctx.params;
+    const int mask = (int)std::max(0.0f, u[0]);
+    const int style_id = (int)(u[1] + 0.5f);
+    const int motion_id = (int)(u[2] + 0.5f);
+    const float h_pct = std::max(0.05f, u[3]);
+    const float sigma = std::max(0.02f, u[4]);
+    const float freq = std::max(0.05f, u[5]);
+    const float speed = std::max(0.0f, u[6]);
+    const float time_e = u[7];
+    const float height_ext = std::max(0.02f, h_pct);
+    const float d_sigma = std::max(1e-4f, sigma);
+
+    // saShellIntensity on the unit room (extent 1).
+    auto shell = [=](int bit, float dist) {
+        if(!(mask & bit) || dist < 0.0f || dist > height_ext)
+            return 0.0f;
+        return std::exp(-dist * dist / (d_sigma * d_sigma));
+    };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ny = row.y01;
+        const float nz = row.z01;
+        const float i_floor = shell(SURF_FLOOR, ny);
+        const float i_ceil = shell(SURF_CEIL, 1.0f - ny);
+        const float i_zm = shell(SURF_WALL_ZM, nz);
+        const float i_zp = shell(SURF_WALL_ZP, 1.0f - nz);
+        for(int x = 0; x < row.count; x++)
+        {
+            const float nx = row.x01[x];
+            float best_i = 0.0f;
+            float best_a = 0.0f;
+            float best_b = 0.0f;
+            float best_up = 0.0f;
+            int best_role = 0;
+            auto take = [&](float i, int role, float a, float b, float up) {
+                if(i > best_i)
+                {
+                    best_i = i;
+                    best_role = role;
+                    best_a = a;
+                    best_b = b;
+                    best_up = up;
+                }
+            };
+            take(i_floor, 0, nx, nz, 0.0f);
+            take(i_ceil, 1, nx, nz, 1.0f);
+            take(shell(SURF_WALL_XM, nx), 2, nz, ny, ny);
+            take(shell(SURF_WALL_XP, 1.0f - nx), 2, nz, ny, ny);
+            take(i_zm, 2, nx, ny, ny);
+            take(i_zp, 2, nx, ny, ny);
+
+            float* out = rgb + x * 3;
+            out[0] = out[1] = out[2] = 0.0f;
+            if(best_i < 0.004f)
+                continue;
+
+            float sparse = 1.0f;
+            const float ps = EvalPresetField(style_id, best_role, best_a, best_b, best_up, time_e, freq, speed, &sparse);
+            const float plasma = ApplySpatialMotion(motion_id, best_role, best_a, best_b, best_up, time_e, speed, ps);
+            out[0] = std::clamp(best_i * sparse, 0.0f, 1.0f);
+            out[1] = std::clamp(plasma, 0.0f, 1.0f);
+        }
+    };
+}
+
 EffectInfo3D SurfaceAmbient::GetEffectInfo() const
 {
     EffectInfo3D info{};
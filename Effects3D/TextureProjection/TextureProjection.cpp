@@ -3,19 +3,16 @@
 #include "TextureProjection.h"
 
 #include "Geometry3DUtils.h"
-#include "MediaTextureEffectUtils.h"
 #include "SpatialLayerCore.h"
 #include "TextureProjectionVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
+#include "MediaTextureEffectUtils.h"
 
 #include <QCheckBox>
 #include <QComboBox>
 #include <QFileDialog>
 #include <QLabel>
-#include <QMovie>
-#include <QMutexLocker>
 #include <QPushButton>
-#include <QTimer>
-#include <QDateTime>
 #include "EffectSliderRow.h"
 #include "EffectUiRows.h"
 #include "MediaTextureAmbienceBlock.h"
@@ -43,23 +40,19 @@ TextureProjection::TextureProjection(QWidget* parent)
       motion_phase_slider(nullptr),
       media_resolution_slider(nullptr),
       tile_repeat_check(nullptr),
-      movie(nullptr),
-      gif_frame_timer(nullptr),
-      media_is_gif(false),
       projection_mode(0)
 {
-    gif_frame_timer = new QTimer(this);
-    gif_frame_timer->setTimerType(Qt::PreciseTimer);
-    connect(gif_frame_timer, &QTimer::timeout, this, &TextureProjection::OnGifFrameTimerTimeout);
     SetRainbowMode(false);
     SetSpeed(30);
     volume_assist_.setFragmentBody(QString::fromUtf8(TextureProjectionVolumeFieldGlsl()));
     volume_assist_.setResolution(18);
+    volume_assist_.setCpuField(&TextureProjection::BuildCpuRows);
 }
 
 TextureProjection::~TextureProjection()
 {
-    ClearMovie();
+    // Joins the decoder before its queued on_loaded callback could outlive this.
+    media_atlas_.reset();
 }
 
 EffectInfo3D TextureProjection::GetEffectInfo() const
@@ -71,7 +64,7 @@ EffectInfo3D TextureProjection::GetEffectInfo() const
         "Scroll pans the texture in a continuous loop; Warp distorts UVs; Phase steers scroll direction and warp tempo. "
         "Tile repeats the image across the room; motion still loops when Tile is off. "
         "Ambience: distance dim, falloff curve, edge fade, and wave delay (motion lags with distance). "
-        "For GIFs, Speed is frames per second (0 = frozen). Size zooms; Scale adds repeats.";
+        "For GIFs, Speed 30 plays at the file's own frame timing (0 = frozen). Size zooms; Scale adds repeats.";
     info.category = "Media";
     info.effect_type = SPATIAL_EFFECT_TEXTURE_PROJECTION;
     info.is_reversible = false;
@@ -121,6 +114,7 @@ void TextureProjection::SetupCustomUI(QWidget* parent)
     pick_row->addWidget(browse_button);
     pick_row->addWidget(path_label);
     layout->addLayout(pick_row);
+    UpdateMediaLabel();
 
     EffectLabeledComboRow* projection_row = EffectUiRows::AppendComboRow(layout, tr("Projection:"));
     projection_row->setObjectName(QStringLiteral("projectionRow"));
@@ -213,179 +207,59 @@ void TextureProjection::OnProjectionModeChanged(int index)
     emit ParametersChanged();
 }
 
-void TextureProjection::OnMediaFrameChanged(int /*frameNumber*/)
-{
-    RefreshFrameFromMovie();
-}
-
-void TextureProjection::OnGifFrameTimerTimeout()
+void TextureProjection::LoadMediaFile(const QString& path)
 {
-    if(!movie || !media_is_gif)
-    {
-        return;
-    }
-    const int fc = movie->frameCount();
-    if(fc <= 0)
+    media_path = path;
+    media_atlas_.reset();
+    media_clock_.Reset();
+    if(!path.isEmpty())
     {
-        if(gif_frame_timer)
+        // Decoded off the GUI thread; frames become visible as they land.
+        media_atlas_ = std::make_unique<MediaFrameAtlas>(path, SpatialVolumeFieldEngine::kMaxMediaEdge, [this]()
         {
-            gif_frame_timer->stop();
-        }
-        return;
-    }
-    const int cur = movie->currentFrameNumber();
-    const int next = (cur + 1) % fc;
-    {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame = display_frame;
-        last_gif_step_ms = QDateTime::currentMSecsSinceEpoch();
-    }
-    (void)movie->jumpToFrame(next);
-    PublishDisplayFrame(movie->currentImage());
-}
-
-void TextureProjection::ClearMovie()
-{
-    if(gif_frame_timer)
-    {
-        gif_frame_timer->stop();
-    }
-    if(movie)
-    {
-        movie->stop();
-        disconnect(movie, nullptr, this, nullptr);
-        delete movie;
-        movie = nullptr;
+            QMetaObject::invokeMethod(this, [this]()
+            {
+                UpdateMediaLabel();
+                emit ParametersChanged();
+            }, Qt::QueuedConnection);
+        });
     }
-    media_is_gif = false;
-    last_gif_step_ms = 0;
-    gif_step_interval_ms = 0;
-    QMutexLocker lock(&display_mutex);
-    previous_display_frame.reset();
+    UpdateMediaLabel();
+    emit ParametersChanged();
 }
 
-void TextureProjection::PublishDisplayFrame(const QImage& src)
+void TextureProjection::UpdateMediaLabel()
 {
-    if(src.isNull())
+    if(!path_label)
     {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame.reset();
-        display_frame.reset();
         return;
     }
-    QImage conv = src.convertToFormat(QImage::Format_ARGB32);
-    constexpr int kMaxSampleEdge = 1536;
-    if(conv.width() > kMaxSampleEdge || conv.height() > kMaxSampleEdge)
-    {
-        conv = conv.scaled(kMaxSampleEdge, kMaxSampleEdge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        conv = conv.convertToFormat(QImage::Format_ARGB32);
-    }
-    std::shared_ptr<QImage> shot = std::make_shared<QImage>(std::move(conv));
-    QMutexLocker lock(&display_mutex);
-    display_frame = std::move(shot);
-}
-
-void TextureProjection::RefreshFrameFromMovie()
-{
-    if(!movie)
+    if(!media_atlas_)
     {
+        path_label->setText(tr("(no file)"));
         return;
     }
-    PublishDisplayFrame(movie->currentImage());
-}
-
-void TextureProjection::LoadMediaFile(const QString& path)
-{
-    media_path = path;
-    if(path_label)
+    const MediaFrameAtlas::Stats stats = media_atlas_->GetStats();
+    if(!stats.complete)
     {
-        path_label->setText(path.isEmpty() ? tr("(no file)") : path);
+        path_label->setText(tr("%1 (loading…)").arg(media_path));
     }
-
-    ClearMovie();
+    else if(stats.failed)
     {
-        QMutexLocker lock(&display_mutex);
-        previous_display_frame.reset();
-        display_frame.reset();
+        path_label->setText(tr("Invalid or unsupported media"));
     }
-
-    if(path.isEmpty())
+    else if(stats.frame_count > 1)
     {
-        emit ParametersChanged();
-        return;
-    }
-
-    const bool is_gif = path.endsWith(QLatin1String(".gif"), Qt::CaseInsensitive);
-    if(is_gif)
-    {
-        movie = new QMovie(path, QByteArray(), this);
-        if(!movie->isValid())
-        {
-            delete movie;
-            movie = nullptr;
-            if(path_label)
-            {
-                path_label->setText(tr("Invalid or unsupported GIF"));
-            }
-            emit ParametersChanged();
-            return;
-        }
-        media_is_gif = true;
-        movie->start();
-        movie->setPaused(true);
-        (void)movie->jumpToFrame(0);
-        PublishDisplayFrame(movie->currentImage());
-        {
-            QMutexLocker lock(&display_mutex);
-            previous_display_frame.reset();
-        }
-        last_gif_step_ms = 0;
-        ApplyGifPlaybackSpeed();
+        path_label->setText(tr("%1 (%2 frames, %3 MiB%4)")
+                                .arg(media_path)
+                                .arg(stats.frame_count)
+                                .arg((double)stats.resident_bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                .arg(stats.streaming ? tr(", streaming") : QString()));
     }
     else
     {
-        QImage img(path);
-        if(img.isNull())
-        {
-            emit ParametersChanged();
-            return;
-        }
-        PublishDisplayFrame(img);
+        path_label->setText(media_path);
     }
-
-    emit ParametersChanged();
-}
-
-void TextureProjection::SetSpeed(unsigned int speed)
-{
-    SpatialEffect3D::SetSpeed(speed);
-    ApplyGifPlaybackSpeed();
-}
-
-void TextureProjection::ApplyGifPlaybackSpeed()
-{
-    if(!movie || !media_is_gif || !gif_frame_timer)
-    {
-        if(gif_frame_timer)
-        {
-            gif_frame_timer->stop();
-        }
-        return;
-    }
-    const unsigned int fps = GetSpeed();
-    if(fps == 0)
-    {
-        gif_frame_timer->stop();
-        movie->setPaused(true);
-        gif_step_interval_ms = 0;
-        return;
-    }
-    movie->setPaused(true);
-    const int interval_ms = std::max(1, (int)std::lround(1000.0 / (double)fps));
-    gif_frame_timer->stop();
-    gif_frame_timer->setInterval(interval_ms);
-    gif_step_interval_ms = interval_ms;
-    gif_frame_timer->start();
 }
 
 void TextureProjection::OnBrowseMedia()
@@ -404,18 +278,13 @@ void TextureProjection::OnBrowseMedia()
 
 void TextureProjection::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid)
 {
-    std::shared_ptr<QImage> snap;
-    std::shared_ptr<QImage> prev_snap;
-    qint64 step_ms = 0;
-    int step_interval_ms = 0;
+    MediaPlaybackFrame frame;
+    if(media_atlas_)
     {
-        QMutexLocker lock(&display_mutex);
-        snap = display_frame;
-        prev_snap = previous_display_frame;
-        step_ms = last_gif_step_ms;
-        step_interval_ms = gif_step_interval_ms;
+        frame = media_clock_.Advance(*media_atlas_, time_sec, GetSpeed(), GetSmoothing() / 100.0f);
     }
-    if(!snap || snap->isNull())
+    const std::shared_ptr<const MediaFramePyramid>& snap = frame.current;
+    if(!snap || snap->IsNull())
     {
         volume_assist_.clearMediaTexture();
         float zp[16] = {};
@@ -423,39 +292,11 @@ void TextureProjection::PrepareGpuFields(std::uint64_t render_sequence, float ti
         return;
     }
 
-    QImage media = *snap;
-    // Cap before optional GIF blend so per-frame work stays cheap.
-    constexpr int kGpuMediaEdge = SpatialVolumeFieldEngine::kMaxMediaEdge;
-    if(media.width() > kGpuMediaEdge || media.height() > kGpuMediaEdge)
-    {
-        media = media.scaled(kGpuMediaEdge, kGpuMediaEdge, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    }
-    const float smoothing = GetSmoothing() / 100.0f;
-    if(media_is_gif && prev_snap && !prev_snap->isNull() && smoothing > 0.0f && step_interval_ms > 0 && step_ms > 0)
+    QImage media = snap->Base();
+    if(frame.previous && !frame.previous->IsNull())
     {
-        const qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
-        const float elapsed_ms = (float)std::max<qint64>(0, now_ms - step_ms);
-        const float blend_window_ms = std::max(1.0f, (float)step_interval_ms * smoothing);
-        const float a = std::clamp(elapsed_ms / blend_window_ms, 0.0f, 1.0f);
-        if(a < 0.999f)
-        {
-            QImage cur = media.convertToFormat(QImage::Format_ARGB32);
-            QImage prev = prev_snap->scaled(cur.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
-                              .convertToFormat(QImage::Format_ARGB32);
-            for(int y = 0; y < cur.height(); ++y)
-            {
-                QRgb* dst = reinterpret_cast<QRgb*>(cur.scanLine(y));
-                const QRgb* src = reinterpret_cast<const QRgb*>(prev.constScanLine(y));
-                for(int x = 0; x < cur.width(); ++x)
-                {
-                    const RGBColor c = MediaTextureEffect::LerpRGB(
-                        ToRGBColor(qRed(src[x]), qGreen(src[x]), qBlue(src[x])),
-                        ToRGBColor(qRed(dst[x]), qGreen(dst[x]), qBlue(dst[x])), a);
-                    dst[x] = qRgba(RGBGetRValue(c), RGBGetGValue(c), RGBGetBValue(c), 255);
-                }
-            }
-            media = std::move(cur);
-        }
+        const QImage prev = media_cache_.Resolve(*frame.previous, media.width(), media.height());
+        media = media_cache_.CrossFade(prev, media, frame.blend);
     }
 
     volume_assist_.setMediaTexture(media, tile_repeat_enabled);
@@ -472,7 +313,7 @@ void TextureProjection::PrepareGpuFields(std::uint64_t render_sequence, float ti
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), sw, GetStratumTuning());
     const float tm = std::max(0.25f, bb.tight_mul);
 
-    const bool freeze_gif_motion = media_is_gif && GetSpeed() == 0;
+    const bool freeze_gif_motion = media_atlas_ && media_atlas_->GetStats().frame_count > 1 && GetSpeed() == 0;
     const float scroll_mul = motion_scroll / 100.0f;
     const float warp_mul = motion_warp / 100.0f;
     const float phase_mul = motion_phase / 100.0f;
@@ -521,6 +362,104 @@ void TextureProjection::PrepareGpuFields(std::uint64_t render_sequence, float ti
     volume_assist_.prepare(render_sequence, time_sec, vp, 16);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn TextureProjection::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* p = ctx.params;
+    const int mode = (int)(std::clamp(p[0], 0.0f, 3.0f) + 0.5f);
+    const float tile = std::max(p[1], 0.12f);
+    const float scroll_rate = p[2];
+    const float phase_mul = std::clamp(p[3], 0.0f, 2.0f);
+    const float amp = p[4];
+    const float detail_s = std::max(p[5], 0.05f);
+    const Vec3 origin01 = Clamp01(Vec3(p[6], p[7], p[8]));
+    const float fd = Clamp01(p[9]);
+    const float curve = Clamp01(p[10]);
+    const float edge = Clamp01(p[11]);
+    const float prop = Clamp01(p[12]);
+    const float steps_u = std::max(p[13], 2.0f);
+    const float steps_v = std::max(Mod(p[14], 1000.0f), 2.0f);
+    const bool use_q = p[14] >= 500.0f;
+    // Motion always loops the image; idle clamp only when wrap_mode is off.
+    const bool do_wrap = p[15] > 0.5f || std::fabs(scroll_rate) > 1e-5f || amp > 1e-4f;
+    const float time_sec = ctx.time_sec;
+    const float v_ratio = 0.12f + 0.88f * Clamp01(phase_mul);
+    const QImage* media = ctx.media;
+    const bool media_wrap = ctx.media_wrap;
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 p01(row.x01[x], row.y01, row.z01);
+            float u = 0.5f;
+            float v = 0.5f;
+            if(mode == 0)
+            {
+                u = p01.x;
+                v = p01.z;
+            }
+            else if(mode == 1)
+            {
+                u = p01.x;
+                v = p01.y;
+            }
+            else if(mode == 2)
+            {
+                u = p01.y;
+                v = p01.z;
+            }
+            else
+            {
+                const Vec3 d = p01 - origin01;
+                const float len = Length(d);
+                if(len >= 1e-5f)
+                {
+                    u = std::atan2(d.z / len, d.x / len) / TWO_PI + 0.5f;
+                    v = std::asin(std::clamp(d.y / len, -1.0f, 1.0f)) / (float)M_PI + 0.5f;
+                }
+            }
+
+            u = (u - 0.5f) * tile + 0.5f;
+            v = (v - 0.5f) * tile + 0.5f;
+
+            const float dist_n = Length(p01 - origin01) * 1.7320508f;
+            const float t_eff = time_sec - prop * dist_n * 3.2f;
+            u += t_eff * scroll_rate;
+            v += t_eff * scroll_rate * v_ratio;
+
+            const float warp_ph = t_eff * (0.55f + 3.8f * phase_mul);
+            u += std::sin(warp_ph + u * 9.0f * detail_s * 0.1f + v * 6.0f * detail_s * 0.08f) * amp;
+            v += std::cos(warp_ph * 0.93f + u * 7.0f * detail_s * 0.08f - v * 8.5f * detail_s * 0.1f) * amp;
+
+            if(do_wrap)
+            {
+                u = Fract(u);
+                v = Fract(v);
+            }
+            else
+            {
+                u = Clamp01(u);
+                v = Clamp01(v);
+            }
+            if(use_q)
+            {
+                u = std::floor(u * steps_u) / steps_u;
+                v = std::floor(v * steps_v) / steps_v;
+            }
+
+            float texel[4];
+            SampleMedia(media, media_wrap, u, 1.0f - v, texel);
+            const float d_face = std::min(std::min(std::min(p01.x, 1.0f - p01.x), std::min(p01.y, 1.0f - p01.y)),
+                                          std::min(p01.z, 1.0f - p01.z));
+            const float ag = MediaTextureEffect::AmbienceGain01(dist_n, d_face, fd, curve, edge);
+            rgb[x * 3 + 0] = texel[0] * ag;
+            rgb[x * 3 + 1] = texel[1] * ag;
+            rgb[x * 3 + 2] = texel[2] * ag;
+        }
+    };
+}
+
 RGBColor TextureProjection::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
 {
     if(EffectGridSampleOutsideVolume(x, y, z, grid))
@@ -2,6 +2,7 @@
 
 #include "TravelingLight.h"
 #include "TravelingLightVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
 #include "../EffectHelpers.h"
@@ -69,6 +70,7 @@ TravelingLight::TravelingLight(QWidget* parent) : SpatialEffect3D(parent)
     SetColors(default_colors);
     volume_assist_.setFragmentBody(QString::fromUtf8(TravelingLightVolumeFieldGlsl()));
     volume_assist_.setResolution(22);
+    volume_assist_.setCpuField(&TravelingLight::BuildCpuRows);
 }
 
 void TravelingLight::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid)
@@ -113,6 +115,234 @@ void TravelingLight::PrepareGpuFields(std::uint64_t render_sequence, float time_
     volume_assist_.prepare(render_sequence, time_sec, vp, 16);
 }
 
+SpatialVolumeFieldEngine::CpuRowFn TravelingLight::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    using namespace SpatialFieldCpuMath;
+    const float* u = ctx.params;
+    const int mode = (int)(std::clamp(u[0], 0.0f, 9.0f) + 0.5f);
+    const float progress = Fract(u[1]);
+    const float size_scale = std::max(u[2], 0.05f);
+    const float tight_inv = std::max(u[3], 0.25f);
+    const int ax = (int)(std::clamp(u[4], 0.0f, 2.0f) + 0.5f);
+    const int plane = (int)(std::clamp(u[5], 0.0f, 2.0f) + 0.5f);
+    const float glow_amt = std::clamp(u[6], 0.1f, 1.0f);
+    const int wipe_edge = (int)(std::clamp(u[7], 0.0f, 2.0f) + 0.5f);
+    const int ndiv = (int)(std::clamp(u[8], 2.0f, 16.0f) + 0.5f);
+    const int front_shape = (int)(std::clamp(u[9], 0.0f, 3.0f) + 0.5f);
+    const int front_edge = (int)(std::clamp(u[10], 0.0f, 2.0f) + 0.5f);
+    const float front_thick = std::clamp(u[11], 0.05f, 1.0f);
+    const float freq_n = std::max(u[12], 0.02f);
+    const Vec3 origin01 = Clamp01(Vec3(u[13], u[14], u[15]));
+    const float pi = (float)M_PI;
+
+    auto smstep = [](float e0, float e1, float v) {
+        const float t = Clamp01((v - e0) / std::max(e1 - e0, 1e-5f));
+        return t * t * (3.0f - 2.0f * t);
+    };
+    auto soft_band = [](float d, float sigma) {
+        const float s = std::max(sigma, 0.02f);
+        return std::exp(-(d * d) / (s * s));
+    };
+    auto axis_comp = [](const Vec3& p, int a) { return a == 0 ? p.x : (a == 1 ? p.y : p.z); };
+    auto secondary = [](const Vec3& p, int a) { return a == 0 ? p.y : (a == 1 ? p.z : p.x); };
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        for(int x = 0; x < row.count; x++)
+        {
+            const Vec3 p01(row.x01[x], row.y01, row.z01);
+            const Vec3 l = (p01 - origin01) * 2.0f;
+            float intensity = 0.0f;
+            float driver = progress;
+            float aux = 0.0f;
+
+            if(mode == MODE_KITT)
+            {
+                const float beam = (progress < 0.5f) ? (2.0f * progress) : (2.0f * (1.0f - progress));
+                const float w = std::clamp(0.15f * size_scale, 0.05f, 0.5f) * tight_inv;
+                const float dist = std::fabs(beam - axis_comp(p01, ax));
+                intensity = soft_band(dist, w * 0.55f) * (0.55f + 0.45f * (1.0f - smstep(0.0f, w, dist)));
+                driver = Clamp01(1.0f - dist / std::max(w, 1e-5f));
+                aux = (progress < 0.5f) ? 1.0f : 0.0f;
+            }
+            else if(mode == MODE_WIPE)
+            {
+                float prog2 = Fract(progress * 0.5f) * 2.0f;
+                if(prog2 > 1.0f)
+                    prog2 = 2.0f - prog2;
+                const float edge_distance = std::fabs(p01.x - prog2);
+                const float thickness_factor = 0.2f * size_scale * tight_inv;
+                if(wipe_edge == 0)
+                {
+                    const float core = 1.0f - smstep(0.0f, thickness_factor * 0.6f, edge_distance);
+                    const float halo = 0.4f * (1.0f - smstep(thickness_factor * 0.6f, thickness_factor * 1.2f, edge_distance));
+                    intensity = std::min(1.0f, core + halo);
+                }
+                else if(wipe_edge == 1)
+                    intensity = 1.0f - smstep(thickness_factor * 0.35f, thickness_factor * 0.55f, edge_distance);
+                else
+                    intensity = 1.0f - smstep(thickness_factor * 0.70f, thickness_factor * 1.05f, edge_distance);
+                const float radial = Length(l) * 0.5f;
+                intensity *= 0.55f + 0.45f * (1.0f - std::min(1.0f, radial / 1.7320508f) * 0.5f);
+                driver = Fract(prog2 + progress * freq_n * 0.02f);
+            }
+            else if(mode == MODE_MOVING_PANES)
+            {
+                const float zone_size = 1.0f / (float)ndiv;
+                const int zone = (int)std::clamp(std::floor(axis_comp(p01, ax) / zone_size), 0.0f, (float)(ndiv - 1));
+                const float zone_id = (float)(zone - (zone / 2) * 2);
+                driver = 0.5f * (1.0f + std::sin(secondary(p01, ax) * pi * 4.0f +
+                                                 (zone_id > 0.5f ? 1.0f : -1.0f) * progress * TWO_PI + 0.78539816f));
+                intensity = 1.0f;
+                aux = zone_id;
+            }
+            else if(mode == MODE_CROSSING)
+            {
+                const float bias_x = std::clamp(origin01.x - 0.5f, -0.125f, 0.125f);
+                const float bias_y = std::clamp(origin01.y - 0.5f, -0.125f, 0.125f);
+                const float xp = 0.5f + bias_x + std::sin(progress * pi) * (0.5f - std::fabs(bias_x));
+                const float yp = 0.5f + bias_y + std::sin(progress * pi * 1.3f) * (0.5f - std::fabs(bias_y));
+                const float thick = std::clamp(0.08f * size_scale, 0.02f, 0.2f) * tight_inv;
+                const float soft = Mix(0.08f, 0.35f, glow_amt);
+                intensity = soft_band(std::fabs(p01.x - xp), thick * (0.55f + soft));
+                driver = soft_band(std::fabs(p01.y - yp), thick * (0.55f + soft));
+                aux = 1.0f;
+            }
+            else if(mode == MODE_ROTATING)
+            {
+                const float point_angle = (plane == 0) ? std::atan2(l.z, l.x)
+                                        : ((plane == 1) ? std::atan2(l.x, l.y) : std::atan2(l.z, l.y));
+                const float diff = Mod(point_angle - progress * TWO_PI + pi, TWO_PI) - pi;
+                const float abs_diff = std::fabs(diff);
+                const float width = std::clamp(0.15f * size_scale, 0.05f, 0.5f) * pi * tight_inv;
+                const float core = 1.0f - smstep(0.0f, width * 0.55f, abs_diff);
+                const float halo = soft_band(abs_diff, width * (0.85f + 0.9f * glow_amt));
+                intensity = std::max(core, halo * 0.65f);
+                driver = Fract(progress + progress * freq_n * 0.02f);
+            }
+            else if(mode == MODE_WAVE_FRONTS)
+            {
+                float pos01 = 0.0f;
+                if(front_shape == 0)
+                    pos01 = std::clamp(std::hypot(l.x, l.z) / 2.828427f, 0.0f, 1.25f);
+                else if(front_shape == 1)
+                    pos01 = std::clamp(std::max(std::fabs(l.x), std::fabs(l.z)) * 0.5f, 0.0f, 1.25f);
+                else if(front_shape == 2)
+                    pos01 = p01.x;
+                else
+                    pos01 = Fract(p01.x * 0.5f + p01.z * 0.5f);
+
+                // Frequency adds extra crests (1..4 rings/bands).
+                const float crests = std::clamp(1.0f + std::floor(freq_n * 0.85f + 0.35f), 1.0f, 4.0f);
+                float d = 1.0f;
+                for(int r = 0; r < 4 && (float)r < crests; r++)
+                {
+                    const float front = Fract(progress + (float)r / crests);
+                    if(front_shape == 0 || front_shape == 1)
+                    {
+                        d = std::min(d, std::fabs(pos01 - front));
+                        d = std::min(d, std::fabs(pos01 - (front - 1.0f)));
+                        d = std::min(d, std::fabs(pos01 - (front + 1.0f)));
+                    }
+                    else
+                    {
+                        const float wd = std::fabs(pos01 - front);
+                        d = std::min(d, std::min(wd, 1.0f - wd));
+                    }
+                }
+
+                // frontEdgeProfile
+                const float sigma = Mix(0.035f, 0.20f, front_thick);
+                if(front_edge == 1)
+                    intensity = 1.0f - smstep(sigma * 0.55f * 0.65f, sigma * 0.55f, d);
+                else if(front_edge == 2)
+                    intensity = 1.0f - smstep(sigma * 0.95f * 0.75f, sigma * 0.95f, d);
+                else
+                    intensity = soft_band(d, sigma);
+                const float radial = Length(l) * 0.5f;
+                intensity *= 0.72f + 0.28f * (1.0f - std::min(1.0f, radial / 1.7320508f) * 0.55f);
+                driver = Fract(pos01 * 0.35f + progress);
+            }
+            else
+            {
+                // Comet / Chase / Marquee / ZigZag
+                const float axis_val = axis_comp(p01, ax);
+                const float tail_len = std::max(0.08f, 0.25f * size_scale * tight_inv);
+                if(mode == MODE_CHASE)
+                {
+                    for(int c = 0; c < 4; c++)
+                    {
+                        const float distance = Fract(progress + (float)c / 4.0f) - axis_val;
+                        float i = 0.0f;
+                        float hue_off = 0.0f;
+                        if(distance >= -tail_len * 0.15f && distance <= tail_len)
+                        {
+                            const float t = Clamp01(distance / tail_len);
+                            const float head_w = soft_band(std::min(0.0f, distance), tail_len * 0.12f);
+                            i = std::max(head_w, (1.0f - t) * (1.0f - t) * 0.85f) * smstep(-tail_len * 0.15f, 0.0f, distance);
+                            i *= 1.0f - smstep(tail_len * 0.92f, tail_len, std::max(0.0f, distance));
+                            hue_off = (1.0f - t) * 60.0f / 360.0f;
+                        }
+                        if(i > intensity)
+                        {
+                            intensity = i;
+                            driver = Fract(progress + hue_off);
+                        }
+                    }
+                }
+                else if(mode == MODE_MARQUEE)
+                {
+                    const float distance = progress - axis_val;
+                    const float band = std::max(0.06f, tail_len * 0.5f);
+                    const float core = 1.0f - smstep(0.0f, band, std::max(0.0f, distance));
+                    const float tip = soft_band(std::min(0.0f, distance), band * 0.35f) * 0.7f;
+                    intensity = std::max(core * Step(0.0f, distance + band * 0.05f), tip);
+                    intensity *= 1.0f - smstep(band * 0.9f, band * 1.15f, std::max(0.0f, distance));
+                    driver = Fract(progress + progress * freq_n * 0.02f);
+                }
+                else if(mode == MODE_ZIGZAG)
+                {
+                    // Soft snake along a folded 16x16 path.
+                    const float n_cols = 16.0f;
+                    const float n_rows = 16.0f;
+                    const float col_cont = std::clamp(axis_val, 0.0f, 0.999f) * n_cols;
+                    const float row_cont = std::clamp(secondary(p01, ax), 0.0f, 0.999f) * n_rows;
+                    const float seg = std::floor(col_cont);
+                    const float local = (Mod(seg, 2.0f) < 0.5f) ? row_cont : (n_rows - row_cont);
+                    const float path_pos = Clamp01((seg * n_rows + local) / (n_cols * n_rows));
+                    const float tail = std::clamp(0.28f * size_scale, 0.12f, 0.55f) * tight_inv;
+                    float dist_in_tail = progress - path_pos;
+                    if(dist_in_tail < 0.0f)
+                        dist_in_tail += 1.0f;
+                    if(dist_in_tail <= tail)
+                    {
+                        const float t = dist_in_tail / tail;
+                        intensity = (1.0f - t) * (1.0f - t) * (1.0f - smstep(0.82f, 1.0f, t));
+                        driver = path_pos;
+                    }
+                }
+                else
+                {
+                    // Comet: soft head + quadratic tail.
+                    const float dist = progress - axis_val;
+                    if(dist >= -tail_len * 0.18f && dist <= tail_len)
+                    {
+                        const float t = Clamp01(dist / tail_len);
+                        const float head_w = soft_band(std::min(0.0f, dist), tail_len * 0.14f);
+                        intensity = std::max(head_w, (1.0f - t) * (1.0f - t));
+                        intensity *= 1.0f - smstep(tail_len * 0.9f, tail_len, std::max(0.0f, dist));
+                        driver = Fract(progress + (1.0f - t) * (60.0f / 360.0f));
+                    }
+                }
+            }
+
+            rgb[x * 3 + 0] = Clamp01(intensity);
+            rgb[x * 3 + 1] = Clamp01(driver);
+            rgb[x * 3 + 2] = Clamp01(aux);
+        }
+    };
+}
+
 EffectInfo3D TravelingLight::GetEffectInfo() const
 {
     EffectInfo3D info{};
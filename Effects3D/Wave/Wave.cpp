@@ -2,6 +2,7 @@
 
 #include "Wave.h"
 #include "WaveSurfaceVolumeFieldGlsl.h"
+#include "Shaders/SpatialFieldCpuMath.h"
 #include "SpatialKernelColormap.h"
 #include "SpatialLayerCore.h"
 #include <QComboBox>
@@ -39,6 +40,7 @@ Wave::Wave(QWidget* parent) : SpatialEffect3D(parent)
     SetColors(default_colors);
     surface_volume_assist_.setFragmentBody(QString::fromUtf8(WaveSurfaceVolumeFieldGlsl()));
     surface_volume_assist_.setResolution(18); // was 28 — wave surface is soft; lower atlas = less lag
+    surface_volume_assist_.setCpuField(&Wave::BuildCpuRows);
 }
 
 Wave::~Wave() = default;
@@ -174,92 +176,164 @@ void Wave::PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const
     surface_volume_assist_.prepare(render_sequence, time_sec, vp, 6);
 }
 
-RGBColor Wave::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+SpatialVolumeFieldEngine::CpuRowFn Wave::BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx)
+{
+    const float* u = ctx.params;
+    const float travel = u[0];
+    const float freq = std::max(u[1], 0.2f);
+    const float amp = std::max(u[2], 0.2f);
+    const int style = (int)(u[3] + 0.5f);
+    const float dir_c = std::cos(u[4]);
+    const float dir_s = std::sin(u[4]);
+    const float sigma = std::max(u[5], 0.02f);
+    const float d_cutoff = 3.0f * sigma * std::max(1.0f, amp);
+    const float inv_sigma2 = 1.0f / (sigma * sigma);
+
+    return [=](const SpatialVolumeFieldEngine::CpuRow& row, float* rgb)
+    {
+        const float ly = row.y01 * 2.0f - 1.0f;
+        const float lz = row.z01 * 2.0f - 1.0f;
+        for(int x = 0; x < row.count; x++)
+        {
+            const float lx = row.x01[x] * 2.0f - 1.0f;
+            const float r = std::hypot(lx, lz);
+            const float wave_pos = dir_c * lx + dir_s * lz;
+            float surface_y = 0.0f;
+            if(style == 1)
+            {
+                surface_y = amp * std::sin(freq * r * 3.0f + travel);
+            }
+            else if(style == 2)
+            {
+                surface_y = amp * std::sin(freq * wave_pos * 4.0f + travel);
+            }
+            else if(style == 3)
+            {
+                surface_y = amp * (std::sin(freq * r + travel) * 0.5f +
+                                   std::sin(travel * 0.7f + freq * r * 1.5f + travel * 1.2f) * 0.3f +
+                                   std::sin(travel * 0.5f + r * 2.0f + travel * 0.8f) * 0.2f);
+            }
+            else if(style == 4)
+            {
+                surface_y = amp * (0.5f + 0.5f * std::sin(freq * r + wave_pos * 2.0f + travel));
+            }
+            else
+            {
+                surface_y = amp * std::sin(freq * r + wave_pos * 2.0f + travel);
+            }
+
+            const float d = std::fabs(ly - surface_y);
+            rgb[x * 3 + 0] = d <= d_cutoff ? std::min(1.0f, std::exp(-d * d * inv_sigma2)) : 0.0f;
+            rgb[x * 3 + 1] = std::clamp((surface_y / amp + 1.0f) * 0.5f, 0.0f, 1.0f);
+            rgb[x * 3 + 2] = 0.0f;
+        }
+    };
+}
+
+/** Everything CalculateColorGrid derives from settings / grid / time, resolved once per batch. */
+struct Wave::SampleFrame
+{
+    Vector3D origin{};
+    float boundary_radius_sq = 0.0f;
+    float progress = 0.0f;
+    float rate = 0.0f;
+    float fade = 0.0f;
+    bool volume_available = false;
+    bool strip_colormap = false;
+    bool rainbow = false;
+    EffectGridAxisHalfExtents extents{};
+    SpatialLayerCore::MapperSettings strat_map;
+    SpatialLayerCore::Basis basis;
+    SpatialLayerCore::MapperSettings map;
+};
+
+Wave::SampleFrame Wave::MakeSampleFrame(float time, const GridContext3D& grid) const
 {
-    Vector3D origin = GetEffectOriginGrid(grid);
+    SampleFrame f;
+    f.origin = GetEffectOriginGrid(grid);
+    f.boundary_radius_sq = EffectBoundaryRadiusSq(grid);
+    f.progress = CalculateProgress(time);
+    f.rate = GetScaledFrequency();
+    f.fade = std::clamp(surface_edge_fade / 100.0f, 0.0f, 1.0f);
+    f.volume_available = surface_volume_assist_.isAvailable();
+    f.strip_colormap = UseEffectStripColormap();
+    f.rainbow = GetRainbowMode();
+    EffectStratumBlend::InitStratumBreaks(f.strat_map);
+
+    float scale_eff = std::max(0.05f, GetNormalizedScale());
+    float sw = grid.width * 0.5f * scale_eff;
+    float sh = grid.height * 0.5f * scale_eff;
+    float sd = grid.depth * 0.5f * scale_eff;
+    if(sw < 1e-5f) sw = 1.0f;
+    if(sh < 1e-5f) sh = 1.0f;
+    if(sd < 1e-5f) sd = 1.0f;
+    f.extents = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
+    f.extents.hw = sw;
+    f.extents.hh = sh;
+    f.extents.hd = sd;
+
+    float detail = std::max(0.05f, GetScaledDetail());
+    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), f.basis);
+    EffectStratumBlend::InitStratumBreaks(f.map);
+    f.map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
+    f.map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
+    f.map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
+    return f;
+}
+
+void Wave::ShadeSample(const SampleFrame& f,
+                       float x,
+                       float y,
+                       float z,
+                       float time,
+                       const GridContext3D& grid,
+                       PaletteSample& s) const
+{
+    const Vector3D& origin = f.origin;
     float rel_x = x - origin.x, rel_y = y - origin.y, rel_z = z - origin.z;
-    if(!IsWithinEffectBoundary(rel_x, rel_y, rel_z, grid))
-        return 0x00000000;
+    if(rel_x * rel_x + rel_y * rel_y + rel_z * rel_z > f.boundary_radius_sq)
+        return;
+    if(!f.volume_available)
+        return;
 
     Vector3D rot{x, y, z};
     float coord_y01 = NormalizeGridAxis01(rot.y, grid.min_y, grid.max_y);
-    SpatialLayerCore::MapperSettings strat_map_s;
-    EffectStratumBlend::InitStratumBreaks(strat_map_s);
     float swt[3];
-    EffectStratumBlend::WeightsForYNorm(coord_y01, strat_map_s, swt);
+    EffectStratumBlend::WeightsForYNorm(coord_y01, f.strat_map, swt);
     const EffectStratumBlend::BandBlendScalars bb =
         EffectStratumBlend::BlendBands(GetStratumLayoutMode(), swt, GetStratumTuning());
     const float stratum_mot01 =
         ComputeStratumMotion01(swt, grid, x, y, z, origin, time);
 
-    float progress_val = CalculateProgress(time) * bb.speed_mul;
-    const float surf_phase01 =
-        std::fmod(progress_val + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
-    float strip_surf_p01 = 0.0f;
-    if(UseEffectStripColormap())
-    {
-        strip_surf_p01 = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
-                                                    GetEffectStripColormapRepeats(),
-                                                    GetEffectStripColormapUnfold(),
-                                                    GetEffectStripColormapDirectionDeg(),
-                                                    surf_phase01,
-                                                    time,
-                                                    grid,
-                                                    GetNormalizedScale(),
-                                                    origin,
-                                                    rot);
-    }
-    float scale_eff = std::max(0.05f, GetNormalizedScale());
-    float sw = grid.width * 0.5f * scale_eff;
-    float sh = grid.height * 0.5f * scale_eff;
-    float sd = grid.depth * 0.5f * scale_eff;
-    if(sw < 1e-5f) sw = 1.0f;
-    if(sh < 1e-5f) sh = 1.0f;
-    if(sd < 1e-5f) sd = 1.0f;
+    float progress_val = f.progress * bb.speed_mul;
 
     float intensity = 0.0f;
     float pos_norm = 0.5f;
-    if(surface_volume_assist_.isAvailable())
     {
-        EffectGridAxisHalfExtents e = MakeEffectGridAxisHalfExtents(grid, GetNormalizedScale());
-        e.hw = sw;
-        e.hh = sh;
-        e.hd = sd;
         float c1 = 0.5f, c2 = 0.5f, c3 = 0.5f;
-        SampleCoordsOriginLocal01(rot.x, rot.y, rot.z, origin, e, &c1, &c2, &c3);
+        SampleCoordsOriginLocal01(rot.x, rot.y, rot.z, origin, f.extents, &c1, &c2, &c3);
         const QVector3D samp = surface_volume_assist_.sample01(c1, c2, c3);
         intensity = samp.x();
         pos_norm = EffectStratumBlend::ApplyMotionToUnit01(samp.y(), stratum_mot01, 0.28f);
         if(intensity <= 1e-5f)
         {
-            return 0x00000000;
+            return;
         }
     }
-    else
-        return 0x00000000;
 
-    float fade = std::clamp(surface_edge_fade / 100.0f, 0.0f, 1.0f);
-    if(fade > 0.001f)
+    if(f.fade > 0.001f)
     {
         const float u = RoomXZEdgeProximity01(rot.x, rot.z, grid);
-        float edge_mul = 1.0f - fade * smoothstep(0.0f, 1.0f, u);
+        float edge_mul = 1.0f - f.fade * smoothstep(0.0f, 1.0f, u);
         intensity *= std::max(0.0f, std::min(1.0f, edge_mul));
     }
 
     float hue = fmodf(pos_norm * 180.0f + progress_val * 60.0f, 360.0f);
     if(hue < 0.0f) hue += 360.0f;
-    float rate = GetScaledFrequency();
+    const float rate = f.rate;
     float pos_color = fmodf(pos_norm + time * rate * 0.02f, 1.0f);
     if(pos_color < 0.0f) pos_color += 1.0f;
 
-    float detail = std::max(0.05f, GetScaledDetail());
-    SpatialLayerCore::Basis basis;
-    SpatialLayerCore::MakeBasisFromEffectEulerDegrees(GetRotationYaw(), GetRotationPitch(), GetRotationRoll(), basis);
-    SpatialLayerCore::MapperSettings map;
-    EffectStratumBlend::InitStratumBreaks(map);
-    map.blend_softness = std::clamp(0.09f + 0.08f * (1.0f - detail), 0.05f, 0.20f);
-    map.center_size = std::clamp(0.10f + 0.22f * GetNormalizedScale(), 0.06f, 0.50f);
-    map.directional_sharpness = std::clamp(0.95f + detail * 0.1f, 0.85f, 2.2f);
     SpatialLayerCore::SamplePoint sp{};
     sp.grid_x = x;
     sp.grid_y = y;
@@ -269,32 +343,74 @@ RGBColor Wave::CalculateColorGrid(float x, float y, float z, float time, const G
     sp.origin_z = origin.z;
     sp.y_norm = coord_y01;
 
-    RGBColor c;
-    if(UseEffectStripColormap())
+    s.gain = intensity;
+    if(f.strip_colormap)
     {
-        float p01v = strip_surf_p01;
-        c = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
+        const float surf_phase01 =
+            std::fmod(progress_val + EffectStratumBlend::CombinedPhase01(bb, stratum_mot01) + 1.0f, 1.0f);
+        float p01v = SampleStripKernelPalette01(GetEffectStripColormapKernel(),
+                                                GetEffectStripColormapRepeats(),
+                                                GetEffectStripColormapUnfold(),
+                                                GetEffectStripColormapDirectionDeg(),
+                                                surf_phase01,
+                                                time,
+                                                grid,
+                                                GetNormalizedScale(),
+                                                origin,
+                                                rot);
+        s.color = ResolveStripKernelFinalColor(GetEffectStripColormapKernel(), p01v, time);
     }
-    else if(GetRainbowMode())
+    else if(f.rainbow)
     {
         float hue2 = fmodf(hue + time * rate * 12.0f, 360.0f);
         if(hue2 < 0.0f) hue2 += 360.0f;
-        hue2 = ApplySpatialRainbowHue(hue2, pos_norm, basis, sp, map, time, &grid);
+        hue2 = ApplySpatialRainbowHue(hue2, pos_norm, f.basis, sp, f.map, time, &grid);
         float p01 = std::fmod(hue2 / 360.0f, 1.0f);
         if(p01 < 0.0f) p01 += 1.0f;
-        c = GetRainbowColor(p01 * 360.0f);
+        s.lookup = PaletteSample::HUE;
+        s.key = p01 * 360.0f;
     }
     else
     {
-        float p = ApplySpatialPalette01(pos_color, basis, sp, map, time, &grid);
-        c = GetColorAtPosition(p);
+        s.lookup = PaletteSample::PALETTE;
+        s.key = ApplySpatialPalette01(pos_color, f.basis, sp, f.map, time, &grid);
     }
+}
+
+RGBColor Wave::FinishSample(const PaletteSample& s)
+{
+    const RGBColor c = s.color;
+    const float intensity = s.gain;
     int r_ = std::min(255, std::max(0, (int)((c & 0xFF) * intensity)));
     int g_ = std::min(255, std::max(0, (int)(((c >> 8) & 0xFF) * intensity)));
     int b_ = std::min(255, std::max(0, (int)(((c >> 16) & 0xFF) * intensity)));
     return (RGBColor)((b_ << 16) | (g_ << 8) | r_);
 }
 
+RGBColor Wave::CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid)
+{
+    PaletteSample s;
+    ShadeSample(MakeSampleFrame(time, grid), x, y, z, time, grid, s);
+    ResolvePaletteSamples(&s, 1);
+    return FinishSample(s);
+}
+
+void Wave::CalculateColorGridBatch(const float* xs,
+                                   const float* ys,
+                                   const float* zs,
+                                   size_t count,
+                                   float time,
+                                   const GridContext3D& grid,
+                                   RGBColor* out)
+{
+    const SampleFrame f = MakeSampleFrame(time, grid);
+    ShadePaletteBatch(
+        count,
+        out,
+        [&](size_t i, PaletteSample& s) { ShadeSample(f, xs[i], ys[i], zs[i], time, grid, s); },
+        &Wave::FinishSample);
+}
+
 nlohmann::json Wave::SaveSettings() const
 {
     nlohmann::json j = SpatialEffect3D::SaveSettings();
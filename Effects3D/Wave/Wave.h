@@ -25,11 +25,34 @@ public:
     void SetupCustomUI(QWidget* parent) override;
     void PrepareGpuFields(std::uint64_t render_sequence, float time_sec, const GridContext3D& grid) override;
     RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) override;
+    bool SupportsConcurrentEvaluation() const override { return true; }
+    bool ClipsToEffectBoundary() const override { return true; }
 
     nlohmann::json SaveSettings() const override;
     void LoadSettings(const nlohmann::json& settings) override;
 
+protected:
+    void CalculateColorGridBatch(const float* xs,
+                                 const float* ys,
+                                 const float* zs,
+                                 size_t count,
+                                 float time,
+                                 const GridContext3D& grid,
+                                 RGBColor* out) override;
+
 private:
+    struct SampleFrame;
+    SampleFrame MakeSampleFrame(float time, const GridContext3D& grid) const;
+    void ShadeSample(const SampleFrame& f,
+                     float x,
+                     float y,
+                     float z,
+                     float time,
+                     const GridContext3D& grid,
+                     PaletteSample& s) const;
+    /** Applies the sample's intensity once its palette lookup has resolved. */
+    static RGBColor FinishSample(const PaletteSample& s);
+
     enum WaveStyle { STYLE_SINUS = 0, STYLE_RADIAL, STYLE_LINEAR, STYLE_OCEAN_DRIFT, STYLE_GRADIENT, STYLE_COUNT };
     static const char* WaveStyleName(int s);
 
@@ -48,6 +71,8 @@ private:
     float wave_direction_deg = 0.0f;
     float surface_edge_fade = 18.0f;
 
+    /** CPU port of WaveSurfaceVolumeFieldGlsl (SpatialVolumeFieldCpuBaker). */
+    static SpatialVolumeFieldEngine::CpuRowFn BuildCpuRows(const SpatialVolumeFieldEngine::CpuBakeContext& ctx);
     SpatialVolumeFieldAssist surface_volume_assist_;
 };
 
@@ -142,7 +142,10 @@ static void CloseSocketFd(int& fd)
 
 std::mutex GameTelemetryBridge::stats_mutex;
 GameTelemetryBridge::Stats GameTelemetryBridge::stats;
+std::mutex GameTelemetryBridge::telemetry_write_mutex;
 GameTelemetryBridge::TelemetrySnapshot GameTelemetryBridge::telemetry;
+std::shared_ptr<const GameTelemetryBridge::TelemetrySnapshot> GameTelemetryBridge::published_telemetry =
+    std::make_shared<const GameTelemetryBridge::TelemetrySnapshot>();
 
 static RoomSampleFrameShmReader g_room_sample_shm_reader;
 
@@ -327,7 +330,7 @@ bool GameTelemetryBridge::ProcessIncomingJson(const char* data, size_t size, std
                 bool apply_room_sample_shm = false;
 
                 {
-                std::lock_guard<std::mutex> guard(stats_mutex);
+                std::lock_guard<std::mutex> guard(telemetry_write_mutex);
                 telemetry.last_source = out_source;
                 telemetry.last_type = out_type;
                 telemetry.last_event_ms = NowMs();
@@ -350,10 +353,10 @@ bool GameTelemetryBridge::ProcessIncomingJson(const char* data, size_t size, std
                 }
                 else if(out_type == "room_sample_shm_notify")
                 {
-                    // Deferred: TryApplyLatest locks stats_mutex again.
+                    // Deferred: TryApplyLatest locks telemetry_write_mutex again.
                     apply_room_sample_shm = true;
                 }
-                g_telemetry_data_revision.fetch_add(1, std::memory_order_relaxed);
+                PublishTelemetryLocked();
                 }
 
                 if(apply_room_sample_shm)
@@ -378,20 +381,28 @@ bool GameTelemetryBridge::ProcessIncomingJson(const char* data, size_t size, std
     return false;
 }
 
-GameTelemetryBridge::TelemetrySnapshot GameTelemetryBridge::GetTelemetrySnapshot()
+void GameTelemetryBridge::PublishTelemetryLocked()
 {
-    std::lock_guard<std::mutex> guard(stats_mutex);
-    return telemetry;
+    // The room sample RGBA is shared, not copied: only the small fields are duplicated per publish.
+    std::atomic_store(&published_telemetry, std::shared_ptr<const TelemetrySnapshot>(
+                                                std::make_shared<const TelemetrySnapshot>(telemetry)));
+    // Published before the bump, so a reader that sees the new revision also sees the new snapshot.
+    g_telemetry_data_revision.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const GameTelemetryBridge::TelemetrySnapshot> GameTelemetryBridge::GetTelemetrySnapshot()
+{
+    return std::atomic_load(&published_telemetry);
 }
 
 std::uint64_t GameTelemetryBridge::TelemetryDataRevision()
 {
-    return g_telemetry_data_revision.load(std::memory_order_relaxed);
+    return g_telemetry_data_revision.load(std::memory_order_acquire);
 }
 
 void GameTelemetryBridge::NotifyTelemetryDataUpdated()
 {
-    g_telemetry_data_revision.fetch_add(1, std::memory_order_relaxed);
+    g_telemetry_data_revision.fetch_add(1, std::memory_order_release);
 }
 
 void GameTelemetryBridge::ApplyRoomSampleShmFrame(const RoomSampleFrameProtocol::FrameHeader& hdr,
@@ -407,7 +418,19 @@ void GameTelemetryBridge::ApplyRoomSampleShmFrame(const RoomSampleFrameProtocol:
         return;
     }
 
-    std::lock_guard<std::mutex> guard(stats_mutex);
+    // Packed slots only mean something against the exact cell list they were filled for.
+    const bool packed = (hdr.flags & RoomSampleFrameProtocol::kFlagPackedImportant) != 0;
+    std::shared_ptr<const RoomSampleConfigPublisher::ImportantCellTable> cell_table;
+    if(packed)
+    {
+        cell_table = RoomSampleConfigPublisher::GetLastImportantCellTable();
+        if(!cell_table || cell_table->config_id != hdr.config_id || rgba.size() != cell_table->cells.size() * 4u)
+        {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(telemetry_write_mutex);
     telemetry.room_sample.has_frame = true;
     telemetry.room_sample.frame_id = hdr.frame_id;
     telemetry.room_sample.config_id = hdr.config_id;
@@ -426,11 +449,14 @@ void GameTelemetryBridge::ApplyRoomSampleShmFrame(const RoomSampleFrameProtocol:
     telemetry.room_sample.effect_origin_z = cfg.effect_origin_z;
     telemetry.room_sample.room_to_world_scale = cfg.room_to_world_scale;
     telemetry.room_sample.rgba = std::make_shared<const std::vector<unsigned char>>(std::move(rgba));
+    telemetry.room_sample.packed = packed;
+    telemetry.room_sample.cell_table = std::move(cell_table);
     telemetry.room_sample.received_ms =
         (hdr.timestamp_ms > 0) ? hdr.timestamp_ms
                                : (unsigned long long)std::chrono::duration_cast<std::chrono::milliseconds>(
                                      std::chrono::steady_clock::now().time_since_epoch())
                                      .count();
+    PublishTelemetryLocked();
 }
 
 void GameTelemetryBridge::GetStats(unsigned int& packets_total,
@@ -11,6 +11,7 @@
 #include <cstdint>
 
 #include "RoomSampleFrameProtocol.h"
+#include "RoomSampleConfigPublisher.h"
 
 #include <memory>
 
@@ -45,7 +46,11 @@ public:
         float effect_origin_y = 0.0f;
         float effect_origin_z = 0.0f;
         float room_to_world_scale = 0.05f;
+        /** Full cubemap, or with packed set one RGBA quad per cell_table->cells entry. */
         std::shared_ptr<const std::vector<unsigned char>> rgba;
+        bool packed = false;
+        /** Decode table of the frame's config; set for packed frames. */
+        std::shared_ptr<const RoomSampleConfigPublisher::ImportantCellTable> cell_table;
         unsigned long long received_ms = 0;
     };
 
@@ -102,7 +107,12 @@ public:
                          unsigned int& packets_error,
                          std::string& last_source,
                          std::string& last_type);
-    static TelemetrySnapshot GetTelemetrySnapshot();
+    /**
+     * Latest published snapshot; never null. Snapshots are immutable once published, so readers hold the
+     * pointer for as long as they like and never wait on the UDP or SHM threads. Re-fetch when
+     * TelemetryDataRevision() moves.
+     */
+    static std::shared_ptr<const TelemetrySnapshot> GetTelemetrySnapshot();
 
     static std::uint64_t TelemetryDataRevision();
     static void NotifyTelemetryDataUpdated();
@@ -113,6 +123,8 @@ private:
     void StartUdpListener();
     void StopUdpListener();
     void UdpListenLoop();
+    /** Writers only (telemetry_write_mutex held): copies the working state into a new published snapshot. */
+    static void PublishTelemetryLocked();
     static bool ProcessIncomingJson(const char* data, size_t size, std::string& out_source, std::string& out_type);
 
     std::atomic<bool> udp_running;
@@ -130,7 +142,13 @@ private:
 
     static std::mutex stats_mutex;
     static Stats stats;
+
+    /** Serializes the UDP and SHM writers; readers never take it. */
+    static std::mutex telemetry_write_mutex;
+    /** Working state the writers fold events into; guarded by telemetry_write_mutex. */
     static TelemetrySnapshot telemetry;
+    /** Swapped with std::atomic_store / std::atomic_load. */
+    static std::shared_ptr<const TelemetrySnapshot> published_telemetry;
 };
 
 #endif
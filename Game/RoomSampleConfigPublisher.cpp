@@ -39,7 +39,33 @@ static std::mutex g_mu;
 static bool g_has_publish_room_grid = false;
 static GridContext3D g_publish_room_grid(0, 1, 0, 1, 0, 1, 10.0f);
 static std::vector<float> g_frame_led_xyz;
-static std::vector<std::uint32_t> g_last_important_cells;
+static std::shared_ptr<const RoomSampleConfigPublisher::ImportantCellTable> g_last_cell_table;
+
+static std::shared_ptr<const RoomSampleConfigPublisher::ImportantCellTable>
+BuildImportantCellTable(const RoomSampleFrameProtocol::ConfigHeader& hdr, const std::vector<std::uint32_t>& cells)
+{
+    static_assert(RoomSampleFrameProtocol::kMaxImportantCells < 65535u, "packed slot + 1 must fit in uint16");
+    std::size_t texel_count = 0;
+    if(cells.empty() || !RoomSampleFrameProtocol::TryComputeRgbaBytes(hdr.size_x, hdr.size_y, hdr.size_z, texel_count))
+    {
+        return nullptr;
+    }
+    texel_count /= 4u;
+
+    auto table = std::make_shared<RoomSampleConfigPublisher::ImportantCellTable>();
+    table->config_id = hdr.config_id;
+    table->face_size = hdr.size_x;
+    table->cells = cells;
+    table->slot_by_texel.assign(texel_count, 0);
+    for(std::size_t slot = 0; slot < cells.size(); slot++)
+    {
+        if(cells[slot] < texel_count)
+        {
+            table->slot_by_texel[cells[slot]] = (std::uint16_t)(slot + 1u);
+        }
+    }
+    return table;
+}
 
 /** Cubemap texels covering each mapped LED direction (+ bilinear 2×2). */
 static void BuildImportantCubemapTexels(const RoomSampleFrameProtocol::ConfigHeader& hdr,
@@ -290,7 +316,7 @@ void PublishIfNeeded(const GridContext3D& grid,
     BuildImportantCubemapTexels(hdr, led_xyz, important_cells);
     if(!important_cells.empty())
     {
-        hdr.flags |= RoomSampleFrameProtocol::kFlagImportantCells;
+        hdr.flags |= RoomSampleFrameProtocol::kFlagImportantCells | RoomSampleFrameProtocol::kFlagPackedImportant;
         const std::uint32_t count = (std::uint32_t)important_cells.size();
         std::memcpy(hdr.reserved + RoomSampleFrameProtocol::kReservedImportantCountOffset,
                     &count,
@@ -315,9 +341,15 @@ void PublishIfNeeded(const GridContext3D& grid,
     hdr.sequence = 2;
     WriteConfigFile(hdr, important_cells);
 
+    // Table before g_last_config: a packed frame that matches the new config id finds its decode table.
+    if(config_changed || !g_last_cell_table)
+    {
+        std::shared_ptr<const ImportantCellTable> table = BuildImportantCellTable(hdr, important_cells);
+        std::lock_guard<std::mutex> lock(g_mu);
+        g_last_cell_table = std::move(table);
+    }
     g_last_config = hdr;
     g_has_last_config = true;
-    g_last_important_cells = std::move(important_cells);
 
     if(config_changed)
     {
@@ -331,7 +363,7 @@ void PublishIfNeeded(const GridContext3D& grid,
                  span_x,
                  span_y,
                  span_z,
-                 g_last_important_cells.size());
+                 important_cells.size());
     }
 
     last_hash = hash;
@@ -349,9 +381,10 @@ bool GetLastPublishedConfig(RoomSampleFrameProtocol::ConfigHeader& out)
     return (out.flags & RoomSampleFrameProtocol::kFlagEnabled) != 0;
 }
 
-const std::vector<std::uint32_t>& GetLastImportantCells()
+std::shared_ptr<const ImportantCellTable> GetLastImportantCellTable()
 {
-    return g_last_important_cells;
+    std::lock_guard<std::mutex> lock(g_mu);
+    return g_last_cell_table;
 }
 
 void Disable()
@@ -366,7 +399,8 @@ void Disable()
     hdr.flags = 0;
     WriteConfigFile(hdr, {});
     g_has_last_config = false;
-    g_last_important_cells.clear();
+    std::lock_guard<std::mutex> lock(g_mu);
+    g_last_cell_table.reset();
 #endif
 }
 
@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 struct GridContext3D;
@@ -19,6 +20,17 @@ struct Settings;
 namespace RoomSampleConfigPublisher
 {
 
+/** Decode table for kFlagPackedImportant frames of one published config; immutable once published. */
+struct ImportantCellTable
+{
+    std::uint32_t config_id = 0;
+    int face_size = 0;
+    /** Flat cubemap texels ((u * face_size + v) * 6 + face) in published order; packed slot i carries cells[i]. */
+    std::vector<std::uint32_t> cells;
+    /** Per flat texel: packed slot + 1, or 0 when the texel is not shipped. */
+    std::vector<std::uint16_t> slot_by_texel;
+};
+
 /**
  * Global room grid used for Room Ambilight sizing / LED→cubemap mapping.
  * Must match LED room_position space (not a zone-local effect grid).
@@ -39,7 +51,8 @@ void Disable();
 
 bool GetLastPublishedConfig(RoomSampleFrameProtocol::ConfigHeader& out);
 
-const std::vector<std::uint32_t>& GetLastImportantCells();
+/** Cell table of the last published config; null when it had no important cells. Safe from any thread. */
+std::shared_ptr<const ImportantCellTable> GetLastImportantCellTable();
 
 }
 
@@ -38,6 +38,13 @@ constexpr std::uint32_t kFlagCubemap = 1u << 4;
 constexpr std::uint32_t kFlagFlipRight = 1u << 5;
 /** Unused — kept so flag bit indices stay stable. */
 constexpr std::uint32_t kFlagFlipForward = 1u << 6;
+/**
+ * Packed important texels. On the config: the plugin accepts packed frames for its important cells.
+ * On a frame: the payload is important_cell_count RGBA quads in the config's important-cell order
+ * (rgba_raw_size = count * 4) instead of the full cubemap; size_x/y/z still describe the cubemap and
+ * config_id names the config whose cell list defines the order.
+ */
+constexpr std::uint32_t kFlagPackedImportant = 1u << 7;
 constexpr std::size_t kDefaultTargetCells = 800u * 600u;
 constexpr std::size_t kMaxCells = 512000u;
 constexpr std::uint32_t kMaxImportantCells = 16384u;
@@ -150,6 +157,11 @@ inline bool TryComputeRgbaBytes(int sx, int sy, int sz, std::size_t& out_bytes)
     return true;
 }
 
+inline bool IsValidPackedImportantBytes(std::uint32_t bytes)
+{
+    return bytes > 0 && (bytes % 4u) == 0 && bytes <= kMaxImportantCells * 4u;
+}
+
 /** Map a unit direction in player-local space to cubemap face + u,v in [0,1]. */
 inline void DirectionToCubemapUv(float dx, float dy, float dz, int& face, float& u, float& v)
 {
@@ -68,8 +68,19 @@ static bool ReadMappedOrFileBytes(const std::wstring& path, std::vector<unsigned
         void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, to_read);
         if(view != nullptr)
         {
-            out_bytes.resize(to_read);
-            std::memcpy(out_bytes.data(), view, to_read);
+            // Copy only header + stored payload (packed frames are tens of KB in an 8 MiB file). A size
+            // torn by a concurrent write fails the seqlock / bounds checks in ReadSnapshot and is retried.
+            std::size_t copy_bytes = to_read;
+            RoomSampleFrameProtocol::FrameHeader peek{};
+            std::memcpy(&peek, view, sizeof(peek));
+            if(peek.magic == RoomSampleFrameProtocol::kFrameMagic &&
+               peek.header_bytes == RoomSampleFrameProtocol::kFrameHeaderBytes)
+            {
+                copy_bytes = std::min<std::size_t>(to_read,
+                                                   (std::size_t)peek.header_bytes + (std::size_t)peek.rgba_stored_size);
+            }
+            out_bytes.resize(copy_bytes);
+            std::memcpy(out_bytes.data(), view, copy_bytes);
             UnmapViewOfFile(view);
             CloseHandle(mapping);
             CloseHandle(file);
@@ -175,8 +186,20 @@ static bool ReadSnapshot(const unsigned char* base,
     }
 
     std::size_t raw_bytes = 0;
-    if(!RoomSampleFrameProtocol::TryComputeRgbaBytes(hdr.size_x, hdr.size_y, hdr.size_z, raw_bytes) ||
-       raw_bytes != hdr.rgba_raw_size || raw_bytes == 0)
+    if(!RoomSampleFrameProtocol::TryComputeRgbaBytes(hdr.size_x, hdr.size_y, hdr.size_z, raw_bytes) || raw_bytes == 0)
+    {
+        return false;
+    }
+    if((hdr.flags & RoomSampleFrameProtocol::kFlagPackedImportant) != 0)
+    {
+        // Important-cell order; the cell count is checked against the config's table on apply.
+        if(!RoomSampleFrameProtocol::IsValidPackedImportantBytes(hdr.rgba_raw_size))
+        {
+            return false;
+        }
+        raw_bytes = hdr.rgba_raw_size;
+    }
+    else if(raw_bytes != hdr.rgba_raw_size)
     {
         return false;
     }
@@ -319,8 +342,8 @@ bool RoomSampleFrameShmReader::TryApplyLatest()
     last_size_y = hdr.size_y;
     last_size_z = hdr.size_z;
     last_applied_frame_id = hdr.frame_id;
+    // Publishes and bumps TelemetryDataRevision itself.
     GameTelemetryBridge::ApplyRoomSampleShmFrame(hdr, std::move(rgba));
-    GameTelemetryBridge::NotifyTelemetryDataUpdated();
     return true;
 #else
     return false;
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef GRADIENTLUT3D_H
+#define GRADIENTLUT3D_H
+
+#include "RGBController.h"
+#include "Colors.h"
+#include <cmath>
+#include <cstddef>
+
+namespace GradientLut3D
+{
+    /** Full-saturation hue wheel color (hue in degrees, any range). Reference math the rainbow table is baked from. */
+    inline RGBColor HueToColor(float hue)
+    {
+        hue = std::fmod(hue, 360.0f);
+        if(hue < 0) hue += 360.0f;
+
+        float c = 1.0f;
+        float x = c * (1.0f - std::fabs(std::fmod(hue / 60.0f, 2.0f) - 1.0f));
+
+        float r, g, b;
+        if(hue < 60) { r = c; g = x; b = 0; }
+        else if(hue < 120) { r = x; g = c; b = 0; }
+        else if(hue < 180) { r = 0; g = c; b = x; }
+        else if(hue < 240) { r = 0; g = x; b = c; }
+        else if(hue < 300) { r = x; g = 0; b = c; }
+        else { r = c; g = 0; b = x; }
+
+        return ((int)(b * 255) << 16) | ((int)(g * 255) << 8) | (int)(r * 255);
+    }
+
+    /** Linear blend across evenly spaced stops at t in [0, 1]; white when there are no stops. */
+    inline RGBColor LerpEvenStops(const RGBColor* stops, size_t count, float t)
+    {
+        t = (t > 0.0f) ? t : 0.0f;
+        t = (t < 1.0f) ? t : 1.0f;
+
+        if(count == 0)
+        {
+            return COLOR_WHITE;
+        }
+        if(count == 1)
+        {
+            return stops[0];
+        }
+
+        float scaled_pos = t * (float)(count - 1);
+        int index = (int)scaled_pos;
+        float frac = scaled_pos - index;
+
+        if(index >= (int)count - 1)
+        {
+            return stops[count - 1];
+        }
+
+        RGBColor color1 = stops[index];
+        RGBColor color2 = stops[index + 1];
+
+        int b1 = (color1 >> 16) & 0xFF;
+        int g1 = (color1 >> 8) & 0xFF;
+        int r1 = color1 & 0xFF;
+
+        int b2 = (color2 >> 16) & 0xFF;
+        int g2 = (color2 >> 8) & 0xFF;
+        int r2 = color2 & 0xFF;
+
+        int r = (int)(r1 + (r2 - r1) * frac);
+        int g = (int)(g1 + (g2 - g1) * frac);
+        int b = (int)(b1 + (b2 - b1) * frac);
+
+        return (b << 16) | (g << 8) | r;
+    }
+
+    /**
+     * Gradient baked into kSize packed colors. Sampling is one clamp, one float-to-int and one load; the batch
+     * variant has no branches so the compiler can vectorize the index math. Resolution is 1/1023 of the gradient,
+     * which stays within about one channel step of the direct blend for palettes of up to a handful of stops.
+     */
+    class Table
+    {
+    public:
+        static constexpr int kSize = 1024;
+
+        /** Bakes LerpEvenStops over stops; entry i sits at t = i / (kSize - 1) so both ends are exact. */
+        void BuildEvenStops(const RGBColor* stops, size_t count)
+        {
+            for(int i = 0; i < kSize; i++)
+            {
+                entries_[i] = LerpEvenStops(stops, count, (float)i / (float)(kSize - 1));
+            }
+        }
+
+        /** Bakes the hue wheel; entry i sits at hue = i * 360 / kSize and the table wraps. */
+        void BuildHueWheel()
+        {
+            for(int i = 0; i < kSize; i++)
+            {
+                entries_[i] = HueToColor((float)i * (360.0f / (float)kSize));
+            }
+        }
+
+        /** t is clamped to [0, 1]; NaN reads the first entry. */
+        RGBColor Sample01(float t) const
+        {
+            return entries_[Index01(t)];
+        }
+
+        /** Hue in degrees, any range; wraps around the table. */
+        RGBColor SampleHue(float hue) const
+        {
+            return entries_[IndexHue(hue)];
+        }
+
+        void Sample01Batch(const float* t, RGBColor* out, size_t count) const
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = entries_[Index01(t[i])];
+            }
+        }
+
+        void SampleHueBatch(const float* hue, RGBColor* out, size_t count) const
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                out[i] = entries_[IndexHue(hue[i])];
+            }
+        }
+
+    private:
+        static int Index01(float t)
+        {
+            t = (t > 0.0f) ? t : 0.0f;
+            t = (t < 1.0f) ? t : 1.0f;
+            return (int)(t * (float)(kSize - 1) + 0.5f);
+        }
+
+        static int IndexHue(float hue)
+        {
+            float turns = hue * (1.0f / 360.0f);
+            turns -= std::floor(turns);
+            turns = (turns >= 0.0f && turns < 1.0f) ? turns : 0.0f;
+            return (int)(turns * (float)kSize + 0.5f) & (kSize - 1);
+        }
+
+        RGBColor entries_[kSize] = {};
+    };
+
+    /** Shared hue wheel table, built on first use. */
+    inline const Table& HueWheel()
+    {
+        static const Table table = []()
+        {
+            Table t;
+            t.BuildHueWheel();
+            return t;
+        }();
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "LedFrameLayout3D.h"
+#include "ControllerLayout3D.h"
+
+#include <cstring>
+
+namespace
+{
+
+bool TryGetZoneGlobalLedIndex(RGBControllerInterface* controller,
+                              unsigned int zone_idx,
+                              unsigned int led_idx,
+                              unsigned int* global_idx)
+{
+    if(!controller || controller->GetZoneCount() == 0 || controller->GetLEDCount() == 0)
+    {
+        return false;
+    }
+    if(zone_idx >= controller->GetZoneCount())
+    {
+        return false;
+    }
+    if(led_idx >= controller->GetZoneLEDsCount(zone_idx))
+    {
+        return false;
+    }
+    *global_idx = controller->GetZoneStartIndex(zone_idx) + led_idx;
+    return (*global_idx < controller->GetLEDCount());
+}
+
+constexpr std::uint64_t kFingerprintSeed = 14695981039346656037ull;
+
+/** One FNV-1a step over a whole 64-bit word. */
+void MixFingerprint(std::uint64_t& hash, std::uint64_t word)
+{
+    hash ^= word;
+    hash *= 1099511628211ull;
+}
+
+std::uint64_t FloatBits(float value)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return static_cast<std::uint64_t>(bits);
+}
+
+/** Each LED's device mapping and local position; world / room positions derive from these. */
+std::uint64_t FingerprintLedPositions(const std::vector<LEDPosition3D>& led_positions)
+{
+    std::uint64_t hash = kFingerprintSeed;
+    for(const LEDPosition3D& led_position : led_positions)
+    {
+        MixFingerprint(hash, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(led_position.controller)));
+        MixFingerprint(hash, (static_cast<std::uint64_t>(led_position.zone_idx) << 32) | led_position.led_idx);
+        MixFingerprint(hash, (FloatBits(led_position.local_position.x) << 32) | FloatBits(led_position.local_position.y));
+        MixFingerprint(hash, FloatBits(led_position.local_position.z));
+    }
+    return hash;
+}
+
+/** Room positions of the span's compiled LEDs, in stream order. */
+std::uint64_t FingerprintSpanRoomPositions(const LedFrameLayout3D& layout, const LedFrameLayout3D::ControllerSpan& span)
+{
+    std::uint64_t hash = kFingerprintSeed;
+    MixFingerprint(hash, span.count);
+    for(std::size_t i = span.first; i < span.first + span.count; i++)
+    {
+        MixFingerprint(hash, (FloatBits(layout.room_x[i]) << 32) | FloatBits(layout.room_y[i]));
+        MixFingerprint(hash, FloatBits(layout.room_z[i]));
+    }
+    return hash;
+}
+
+void AppendLed(LedFrameLayout3D& layout,
+               LedFrameLayout3D::ControllerSpan& span,
+               const LEDPosition3D& led_position,
+               unsigned int led_pos_idx,
+               RGBControllerInterface* output_controller,
+               unsigned int global_idx)
+{
+    const std::size_t index = layout.size();
+    const bool extends_zone = span.zone_count > 0 &&
+                              layout.zones.back().controller == output_controller &&
+                              layout.zones.back().zone_idx == led_position.zone_idx &&
+                              layout.zones.back().first + layout.zones.back().count == index;
+    if(extends_zone)
+    {
+        layout.zones.back().count++;
+    }
+    else
+    {
+        LedFrameLayout3D::ZoneSpan zone;
+        zone.controller = output_controller;
+        zone.zone_idx = led_position.zone_idx;
+        zone.first = index;
+        zone.count = 1;
+        layout.zones.push_back(zone);
+        span.zone_count++;
+    }
+
+    layout.world_x.push_back(led_position.world_position.x);
+    layout.world_y.push_back(led_position.world_position.y);
+    layout.world_z.push_back(led_position.world_position.z);
+    layout.room_x.push_back(led_position.room_position.x);
+    layout.room_y.push_back(led_position.room_position.y);
+    layout.room_z.push_back(led_position.room_position.z);
+    layout.led_position_index.push_back(led_pos_idx);
+    layout.global_led_index.push_back(global_idx);
+    span.count++;
+}
+
+std::shared_ptr<LedFrameLayout3D> CompileLedFrameLayout(const std::vector<std::unique_ptr<ControllerTransform>>& transforms,
+                                                        const std::unordered_set<RGBControllerInterface*>& managed_by_virtuals)
+{
+    std::shared_ptr<LedFrameLayout3D> layout = std::make_shared<LedFrameLayout3D>();
+
+    std::size_t reserve = 0;
+    for(const std::unique_ptr<ControllerTransform>& transform : transforms)
+    {
+        if(transform)
+        {
+            // Every transform, rendered or not, so no stale world_positions_dirty keeps the cache cold.
+            ControllerLayout3D::UpdateWorldPositions(transform.get());
+            reserve += transform->led_positions.size();
+        }
+    }
+    layout->world_x.reserve(reserve);
+    layout->world_y.reserve(reserve);
+    layout->world_z.reserve(reserve);
+    layout->room_x.reserve(reserve);
+    layout->room_y.reserve(reserve);
+    layout->room_z.reserve(reserve);
+    layout->led_position_index.reserve(reserve);
+    layout->global_led_index.reserve(reserve);
+
+    for(unsigned int ctrl_idx = 0; ctrl_idx < transforms.size(); ctrl_idx++)
+    {
+        ControllerTransform* transform = transforms[ctrl_idx].get();
+        if(!transform || transform->hidden_by_virtual)
+        {
+            continue;
+        }
+        if(transform->controller && managed_by_virtuals.find(transform->controller) != managed_by_virtuals.end())
+        {
+            continue;
+        }
+
+        const bool virtual_only = transform->virtual_controller && !transform->controller;
+        RGBControllerInterface* controller = transform->controller;
+        if(!virtual_only && (!controller || controller->GetZoneCount() == 0 || controller->GetLEDCount() == 0))
+        {
+            continue;
+        }
+
+        LedFrameLayout3D::ControllerSpan span;
+        span.transform = transform;
+        span.ctrl_idx = ctrl_idx;
+        span.virtual_only = virtual_only;
+        span.led_position_count = transform->led_positions.size();
+        span.first = layout->size();
+        span.first_zone = layout->zones.size();
+
+        for(unsigned int led_pos_idx = 0; led_pos_idx < transform->led_positions.size(); led_pos_idx++)
+        {
+            const LEDPosition3D& led_position = transform->led_positions[led_pos_idx];
+            unsigned int global_idx = 0;
+            if(virtual_only)
+            {
+                // Mapped LED without a valid device index still gets a preview color.
+                if(!led_position.controller)
+                {
+                    continue;
+                }
+                RGBControllerInterface* output =
+                    TryGetZoneGlobalLedIndex(led_position.controller, led_position.zone_idx, led_position.led_idx, &global_idx)
+                        ? led_position.controller
+                        : nullptr;
+                AppendLed(*layout, span, led_position, led_pos_idx, output, global_idx);
+                continue;
+            }
+            if(TryGetZoneGlobalLedIndex(controller, led_position.zone_idx, led_position.led_idx, &global_idx))
+            {
+                AppendLed(*layout, span, led_position, led_pos_idx, controller, global_idx);
+            }
+        }
+        span.room_key = FingerprintSpanRoomPositions(*layout, span);
+        layout->controllers.push_back(span);
+    }
+    return layout;
+}
+
+} // namespace
+
+LedFrameLayoutCache3D::TransformSignature LedFrameLayoutCache3D::MakeSignature(const ControllerTransform* transform,
+                                                                               const std::unordered_set<RGBControllerInterface*>& managed_by_virtuals)
+{
+    TransformSignature sig;
+    sig.transform = transform;
+    if(!transform)
+    {
+        return sig;
+    }
+    sig.controller = transform->controller;
+    sig.virtual_controller = transform->virtual_controller;
+    sig.led_fingerprint = FingerprintLedPositions(transform->led_positions);
+    sig.led_count = transform->led_positions.size();
+    if(transform->controller)
+    {
+        sig.device_led_count = transform->controller->GetLEDCount();
+        sig.device_zone_count = transform->controller->GetZoneCount();
+        sig.managed = managed_by_virtuals.find(transform->controller) != managed_by_virtuals.end();
+    }
+    sig.hidden = transform->hidden_by_virtual;
+    sig.placement = transform->transform;
+    return sig;
+}
+
+bool LedFrameLayoutCache3D::SignatureMatches(const TransformSignature& a, const TransformSignature& b)
+{
+    return a.transform == b.transform &&
+           a.controller == b.controller &&
+           a.virtual_controller == b.virtual_controller &&
+           a.led_fingerprint == b.led_fingerprint &&
+           a.led_count == b.led_count &&
+           a.device_led_count == b.device_led_count &&
+           a.device_zone_count == b.device_zone_count &&
+           a.hidden == b.hidden &&
+           a.managed == b.managed &&
+           std::memcmp(&a.placement, &b.placement, sizeof(Transform3D)) == 0;
+}
+
+std::shared_ptr<const LedFrameLayout3D> LedFrameLayoutCache3D::Acquire(const std::vector<std::unique_ptr<ControllerTransform>>& transforms,
+                                                                       const std::unordered_set<RGBControllerInterface*>& managed_by_virtuals)
+{
+    const std::uint64_t layout_epoch = ControllerLayout3D::LayoutEpoch();
+    bool stale = invalidated_ || !layout_ || layout_epoch != seen_layout_epoch_ ||
+                 signatures_.size() != transforms.size();
+
+    for(std::size_t i = 0; i < transforms.size(); i++)
+    {
+        const ControllerTransform* transform = transforms[i].get();
+        if(transform && transform->world_positions_dirty)
+        {
+            stale = true;
+        }
+        if(stale)
+        {
+            break;
+        }
+        if(!SignatureMatches(signatures_[i], MakeSignature(transform, managed_by_virtuals)))
+        {
+            stale = true;
+        }
+    }
+
+    if(!stale)
+    {
+        return layout_;
+    }
+
+    signatures_.resize(transforms.size());
+    for(std::size_t i = 0; i < transforms.size(); i++)
+    {
+        signatures_[i] = MakeSignature(transforms[i].get(), managed_by_virtuals);
+    }
+
+    std::shared_ptr<LedFrameLayout3D> layout = CompileLedFrameLayout(transforms, managed_by_virtuals);
+    layout->epoch = ++epoch_;
+    layout_ = std::move(layout);
+    seen_layout_epoch_ = layout_epoch;
+    invalidated_ = false;
+    return layout_;
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef LEDFRAMELAYOUT3D_H
+#define LEDFRAMELAYOUT3D_H
+
+#include "LEDPosition3D.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+/** Allocator that starts every SoA stream on its own cache line. */
+template<typename T>
+struct CacheAlignedAllocator
+{
+    using value_type = T;
+    static constexpr std::size_t kAlignment = 64;
+
+    CacheAlignedAllocator() = default;
+    template<typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+    }
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p, std::align_val_t(kAlignment));
+    }
+
+    template<typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+template<typename T>
+using CacheAlignedVector = std::vector<T, CacheAlignedAllocator<T>>;
+
+/**
+ * Compiled structure-of-arrays view of every LED the effect stack drives.
+ * Only LEDs with an output index are included, grouped by controller and then by
+ * zone runs, so one controller is a contiguous slice of every stream. Built on the
+ * GUI thread and immutable once published; the render worker shares it by pointer.
+ */
+struct LedFrameLayout3D
+{
+    struct ControllerSpan
+    {
+        /** Identity only; checked against controller_transforms before colors are applied. */
+        const ControllerTransform* transform = nullptr;
+        unsigned int ctrl_idx = 0;
+        bool virtual_only = false;
+        /** transform->led_positions.size() at compile time. */
+        std::size_t led_position_count = 0;
+        std::size_t first = 0;
+        std::size_t count = 0;
+        std::size_t first_zone = 0;
+        std::size_t zone_count = 0;
+        /** Fingerprint of this span's room positions: equal across compiles means none of its LEDs moved. */
+        std::uint64_t room_key = 0;
+    };
+
+    /** Consecutive LEDs of one span that write to the same device zone. */
+    struct ZoneSpan
+    {
+        /** nullptr: virtual LED whose mapping has no valid output index (preview only). */
+        RGBControllerInterface* controller = nullptr;
+        unsigned int zone_idx = 0;
+        std::size_t first = 0;
+        std::size_t count = 0;
+    };
+
+    std::uint64_t epoch = 0;
+
+    CacheAlignedVector<float> world_x;
+    CacheAlignedVector<float> world_y;
+    CacheAlignedVector<float> world_z;
+    CacheAlignedVector<float> room_x;
+    CacheAlignedVector<float> room_y;
+    CacheAlignedVector<float> room_z;
+    /** Index into ControllerTransform::led_positions (preview write-back, per-LED effect state). */
+    std::vector<unsigned int> led_position_index;
+    /** GetZoneStartIndex(zone) + led_idx on the zone span's controller. */
+    std::vector<unsigned int> global_led_index;
+
+    std::vector<ControllerSpan> controllers;
+    std::vector<ZoneSpan> zones;
+
+    std::size_t size() const { return world_x.size(); }
+};
+
+/**
+ * Owns the current LedFrameLayout3D and recompiles it only when the layout epoch
+ * moves: Invalidate() for structural edits, ControllerLayout3D::LayoutEpoch() for
+ * MarkWorldPositionsDirty, and a per-transform signature check for edits that only
+ * set world_positions_dirty or rewrote led_positions / device zones in place. The
+ * signature fingerprints LED contents, since a rewrite may reuse the same storage.
+ */
+class LedFrameLayoutCache3D
+{
+public:
+    std::shared_ptr<const LedFrameLayout3D> Acquire(const std::vector<std::unique_ptr<ControllerTransform>>& transforms,
+                                                    const std::unordered_set<RGBControllerInterface*>& managed_by_virtuals);
+    void Invalidate() { invalidated_ = true; }
+
+private:
+    struct TransformSignature
+    {
+        const ControllerTransform* transform = nullptr;
+        const RGBControllerInterface* controller = nullptr;
+        const void* virtual_controller = nullptr;
+        std::uint64_t led_fingerprint = 0;
+        std::size_t led_count = 0;
+        unsigned int device_led_count = 0;
+        unsigned int device_zone_count = 0;
+        bool hidden = false;
+        bool managed = false;
+        Transform3D placement{};
+    };
+
+    static TransformSignature MakeSignature(const ControllerTransform* transform,
+                                            const std::unordered_set<RGBControllerInterface*>& managed_by_virtuals);
+    static bool SignatureMatches(const TransformSignature& a, const TransformSignature& b);
+
+    std::shared_ptr<const LedFrameLayout3D> layout_;
+    std::vector<TransformSignature> signatures_;
+    std::uint64_t seen_layout_epoch_ = 0;
+    std::uint64_t epoch_ = 0;
+    bool invalidated_ = true;
+};
+
+#endif
@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "MediaFrameAtlas.h"
+#include "PluginLog.h"
+
+#include <QImage>
+#include <QImageReader>
+
+#include <algorithm>
+#include <cmath>
+
+MediaFrameAtlas::MediaFrameAtlas(const QString& path, int max_edge, std::function<void()> on_loaded)
+    : path_(path),
+      max_edge_(max_edge),
+      on_loaded_(std::move(on_loaded))
+{
+    thread_ = std::thread(&MediaFrameAtlas::DecodeLoop, this);
+}
+
+MediaFrameAtlas::~MediaFrameAtlas()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+MediaFrameAtlas::Stats MediaFrameAtlas::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.frame_count = (int)slots_.size();
+    stats.duration_ms = duration_ms_;
+    stats.complete = complete_;
+    stats.failed = failed_;
+    stats.streaming = streaming_;
+    stats.resident_frames = resident_frames_;
+    stats.resident_bytes = resident_bytes_;
+    return stats;
+}
+
+int MediaFrameAtlas::FrameIndexAt(double time_ms, float* frame_phase) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(frame_phase)
+    {
+        *frame_phase = 1.0f;
+    }
+    if(slots_.empty())
+    {
+        return -1;
+    }
+    if(slots_.size() == 1 || duration_ms_ <= 0)
+    {
+        return 0;
+    }
+
+    double t = std::fmod(time_ms, (double)duration_ms_);
+    if(t < 0.0)
+    {
+        t += (double)duration_ms_;
+    }
+    const std::vector<Slot>::const_iterator next =
+        std::upper_bound(slots_.begin(), slots_.end(), t,
+                         [](double value, const Slot& slot) { return value < (double)slot.start_ms; });
+    const int index = std::max(0, (int)(next - slots_.begin()) - 1);
+    if(frame_phase)
+    {
+        const Slot& slot = slots_[(size_t)index];
+        *frame_phase = std::clamp((float)((t - (double)slot.start_ms) / (double)std::max(1, slot.duration_ms)), 0.0f, 1.0f);
+    }
+    return index;
+}
+
+std::shared_ptr<const MediaFramePyramid> MediaFrameAtlas::Frame(int index, bool playhead)
+{
+    std::shared_ptr<const MediaFramePyramid> result;
+    bool wake_decoder = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int count = (int)slots_.size();
+        if(count == 0)
+        {
+            return result;
+        }
+        index = ((index % count) + count) % count;
+        if(playhead && streaming_ && index != requested_index_)
+        {
+            requested_index_ = index;
+            wake_decoder = true;
+        }
+
+        use_clock_++;
+        for(int step = 0; step < count; step++)
+        {
+            Slot& slot = slots_[(size_t)((index - step + count) % count)];
+            if(slot.pyramid)
+            {
+                slot.last_use = use_clock_;
+                result = slot.pyramid;
+                break;
+            }
+        }
+    }
+    if(wake_decoder)
+    {
+        cv_.notify_one();
+    }
+    return result;
+}
+
+bool MediaFrameAtlas::InWindow(int index) const
+{
+    if(!streaming_)
+    {
+        return true;
+    }
+    const int count = (int)slots_.size();
+    // One frame behind the playhead stays for the cross-fade.
+    const int offset = ((index - requested_index_ + 1) % count + count) % count;
+    return offset <= kStreamWindowFrames;
+}
+
+int MediaFrameAtlas::FirstMissingInWindow() const
+{
+    const int count = (int)slots_.size();
+    if(!streaming_ || !complete_ || count == 0)
+    {
+        return -1;
+    }
+    for(int step = 0; step < std::min(count, kStreamWindowFrames); step++)
+    {
+        const int index = (requested_index_ + step) % count;
+        if(!slots_[(size_t)index].pyramid)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+void MediaFrameAtlas::StoreLocked(int index, std::shared_ptr<const MediaFramePyramid> pyramid)
+{
+    Slot& slot = slots_[(size_t)index];
+    if(slot.pyramid)
+    {
+        return;
+    }
+    resident_bytes_ += pyramid->ByteSize();
+    resident_frames_++;
+    slot.pyramid = std::move(pyramid);
+    slot.last_use = ++use_clock_;
+
+    while(streaming_ && resident_bytes_ > kResidentBudgetBytes)
+    {
+        Slot* victim = nullptr;
+        for(size_t i = 0; i < slots_.size(); i++)
+        {
+            Slot& candidate = slots_[i];
+            if(candidate.pyramid && (int)i != index && !InWindow((int)i) &&
+               (!victim || candidate.last_use < victim->last_use))
+            {
+                victim = &candidate;
+            }
+        }
+        if(!victim)
+        {
+            break;
+        }
+        resident_bytes_ -= victim->pyramid->ByteSize();
+        resident_frames_--;
+        victim->pyramid.reset();
+    }
+}
+
+void MediaFrameAtlas::DecodeLoop()
+{
+    QImageReader reader(path_);
+    reader.setDecideFormatFromContent(true);
+
+    // First pass: time every frame and keep pyramids until the budget runs out.
+    int reader_pos = 0;
+    for(;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(stopping_)
+            {
+                return;
+            }
+        }
+        const QImage image = reader.read();
+        if(image.isNull())
+        {
+            break;
+        }
+        const int delay_ms = reader.nextImageDelay();
+        std::shared_ptr<const MediaFramePyramid> pyramid = std::make_shared<const MediaFramePyramid>(image, max_edge_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot slot;
+        slot.start_ms = duration_ms_;
+        slot.duration_ms = (delay_ms > 10) ? delay_ms : kDefaultFrameDelayMs;
+        duration_ms_ += slot.duration_ms;
+        slots_.push_back(slot);
+        if(resident_bytes_ + pyramid->ByteSize() > kResidentBudgetBytes)
+        {
+            streaming_ = true;
+        }
+        if(InWindow(reader_pos))
+        {
+            StoreLocked(reader_pos, std::move(pyramid));
+        }
+        reader_pos++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        complete_ = true;
+        failed_ = slots_.empty();
+        if(failed_)
+        {
+            streaming_ = false;
+        }
+    }
+    const Stats stats = GetStats();
+    if(stats.failed)
+    {
+        LOG_WARNING("[OpenRGB3DSpatialPlugin] Media '%s' could not be decoded: %s",
+                    qUtf8Printable(path_), qUtf8Printable(reader.errorString()));
+    }
+    else
+    {
+        LOG_INFO("[OpenRGB3DSpatialPlugin] Media '%s': %d frame(s), %d ms, %.1f MiB resident%s",
+                 qUtf8Printable(path_), stats.frame_count, stats.duration_ms,
+                 (double)stats.resident_bytes / (1024.0 * 1024.0),
+                 stats.streaming ? " (streaming)" : "");
+    }
+    if(on_loaded_)
+    {
+        on_loaded_();
+    }
+    if(!stats.streaming)
+    {
+        return;
+    }
+
+    // Streaming: decode forward into the window, reopening the file when playback wrapped behind the reader.
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(;;)
+    {
+        int target = -1;
+        cv_.wait(lock, [&]() { return stopping_ || (target = FirstMissingInWindow()) >= 0; });
+        if(stopping_)
+        {
+            return;
+        }
+        lock.unlock();
+
+        if(target < reader_pos)
+        {
+            reader.setFileName(path_);
+            reader_pos = 0;
+        }
+        // Earlier frames are still decoded: animated frames are composed onto the previous one.
+        bool read_failed = false;
+        while(reader_pos <= target)
+        {
+            const QImage image = reader.read();
+            if(image.isNull())
+            {
+                read_failed = true;
+                break;
+            }
+            const int frame = reader_pos++;
+            lock.lock();
+            const bool wanted = !stopping_ && InWindow(frame) && !slots_[(size_t)frame].pyramid;
+            const bool stop = stopping_;
+            lock.unlock();
+            if(stop)
+            {
+                return;
+            }
+            if(wanted)
+            {
+                std::shared_ptr<const MediaFramePyramid> pyramid = std::make_shared<const MediaFramePyramid>(image, max_edge_);
+                lock.lock();
+                StoreLocked(frame, std::move(pyramid));
+                lock.unlock();
+            }
+        }
+
+        lock.lock();
+        if(read_failed)
+        {
+            // Keep what is resident rather than spinning on a file that went away.
+            streaming_ = false;
+            LOG_WARNING("[OpenRGB3DSpatialPlugin] Media '%s' stopped streaming: %s",
+                        qUtf8Printable(path_), qUtf8Printable(reader.errorString()));
+            return;
+        }
+    }
+}
+
+void MediaPlaybackClock::Reset()
+{
+    clock_ms_ = 0.0;
+    last_time_sec_ = 0.0f;
+    has_time_ = false;
+}
+
+MediaPlaybackFrame MediaPlaybackClock::Advance(MediaFrameAtlas& atlas, float time_sec, unsigned int speed, float smoothing)
+{
+    // Effect time restarts with the stack; a backwards or long jump re-anchors instead of skipping ahead.
+    float dt = has_time_ ? time_sec - last_time_sec_ : 0.0f;
+    if(dt < 0.0f || dt > 1.0f)
+    {
+        dt = 0.0f;
+    }
+    last_time_sec_ = time_sec;
+    has_time_ = true;
+    clock_ms_ += (double)dt * 1000.0 * (double)speed / (double)kNativeSpeed;
+
+    MediaPlaybackFrame frame;
+    float phase = 1.0f;
+    const int index = atlas.FrameIndexAt(clock_ms_, &phase);
+    if(index < 0)
+    {
+        return frame;
+    }
+    frame.current = atlas.Frame(index);
+    if(speed == 0 || smoothing <= 0.0f)
+    {
+        return frame;
+    }
+
+    const float blend = std::clamp(phase / smoothing, 0.0f, 1.0f);
+    if(blend < 0.999f)
+    {
+        std::shared_ptr<const MediaFramePyramid> previous = atlas.Frame(index - 1, false);
+        if(previous && previous != frame.current)
+        {
+            frame.previous = std::move(previous);
+            frame.blend = blend;
+        }
+    }
+    return frame;
+}
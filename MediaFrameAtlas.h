@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef MEDIAFRAMEATLAS_H
+#define MEDIAFRAMEATLAS_H
+
+#include "MediaFramePyramid.h"
+
+#include <QString>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Every frame of one media file (still image or animation) decoded on a background
+ * thread with QImageReader into MediaFramePyramids, each with its start time from the
+ * file's frame delays. Effects pick frames from their own clock (MediaPlaybackClock);
+ * nothing decodes on the GUI or render thread.
+ *
+ * Frames stay resident while the asset fits kResidentBudgetBytes. Past that the atlas
+ * streams: the decoder keeps kStreamWindowFrames frames from the last requested one
+ * onwards, evicts the least recently used outside that window, and re-reads the file
+ * from the start when playback wraps. A frame that is not decoded yet resolves to the
+ * nearest earlier resident one.
+ *
+ * All public methods are thread-safe. The destructor stops and joins the decoder.
+ */
+class MediaFrameAtlas
+{
+public:
+    static constexpr std::size_t kResidentBudgetBytes = 96u * 1024u * 1024u;
+    static constexpr int kStreamWindowFrames = 24;
+    /** Used for frames whose delay is missing or 10 ms and below, as browsers do. */
+    static constexpr int kDefaultFrameDelayMs = 100;
+
+    struct Stats
+    {
+        /** Frames timed so far; final once complete. */
+        int frame_count = 0;
+        int duration_ms = 0;
+        bool complete = false;
+        bool failed = false;
+        bool streaming = false;
+        int resident_frames = 0;
+        std::size_t resident_bytes = 0;
+    };
+
+    /**
+     * Starts decoding path at up to max_edge per side. on_loaded runs on the decoder
+     * thread once the first pass over the file finished (or failed).
+     */
+    MediaFrameAtlas(const QString& path, int max_edge, std::function<void()> on_loaded);
+    ~MediaFrameAtlas();
+
+    MediaFrameAtlas(const MediaFrameAtlas&) = delete;
+    MediaFrameAtlas& operator=(const MediaFrameAtlas&) = delete;
+
+    const QString& Path() const { return path_; }
+    Stats GetStats() const;
+
+    /**
+     * Frame showing time_ms into the loop, or -1 while nothing is decoded. frame_phase
+     * receives how far into that frame time_ms is, in [0, 1] (1 for a single frame).
+     */
+    int FrameIndexAt(double time_ms, float* frame_phase = nullptr) const;
+
+    /**
+     * Resident pyramid for index (wrapped), else the nearest earlier resident one.
+     * playhead moves the streaming window to index.
+     */
+    std::shared_ptr<const MediaFramePyramid> Frame(int index, bool playhead = true);
+
+private:
+    struct Slot
+    {
+        int start_ms = 0;
+        int duration_ms = 0;
+        std::shared_ptr<const MediaFramePyramid> pyramid;
+        std::uint64_t last_use = 0;
+    };
+
+    void DecodeLoop();
+    /** Callers hold mutex_. */
+    bool InWindow(int index) const;
+    int FirstMissingInWindow() const;
+    void StoreLocked(int index, std::shared_ptr<const MediaFramePyramid> pyramid);
+
+    const QString path_;
+    const int max_edge_;
+    std::function<void()> on_loaded_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Slot> slots_;
+    std::size_t resident_bytes_ = 0;
+    int resident_frames_ = 0;
+    int duration_ms_ = 0;
+    int requested_index_ = 0;
+    std::uint64_t use_clock_ = 0;
+    bool complete_ = false;
+    bool failed_ = false;
+    bool streaming_ = false;
+    bool stopping_ = false;
+
+    std::thread thread_;
+};
+
+struct MediaPlaybackFrame
+{
+    std::shared_ptr<const MediaFramePyramid> current;
+    /** Set while the cross-fade from the previous frame is still running. */
+    std::shared_ptr<const MediaFramePyramid> previous;
+    float blend = 1.0f;
+};
+
+/**
+ * Per-effect playback position on an atlas, advanced by the render time passed to
+ * PrepareGpuFields so it needs no timer. Speed kNativeSpeed plays at the file's own
+ * frame delays; 0 holds the current frame.
+ */
+class MediaPlaybackClock
+{
+public:
+    static constexpr unsigned int kNativeSpeed = 30;
+
+    void Reset();
+
+    /** smoothing in [0, 1]: fraction of each frame's duration spent fading in from the previous frame. */
+    MediaPlaybackFrame Advance(MediaFrameAtlas& atlas, float time_sec, unsigned int speed, float smoothing);
+
+private:
+    double clock_ms_ = 0.0;
+    float last_time_sec_ = 0.0f;
+    bool has_time_ = false;
+};
+
+#endif
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "MediaFramePyramid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MEDIA_FRAME_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace
+{
+
+std::atomic<std::uint64_t> g_next_media_frame_id{1};
+
+CaptureImageView ViewOf(const uint8_t* pixels, int width, int height, int stride_bytes)
+{
+    CaptureImageView view;
+    view.pixels = pixels;
+    view.width = width;
+    view.height = height;
+    view.stride_bytes = stride_bytes;
+    view.format = CapturePixelFormat::RGBA8888;
+    return view;
+}
+
+/** Reuses image's buffer when it has this size and format and nobody else shares it; never detach-copies. */
+void EnsureImage(QImage& image, int width, int height)
+{
+    if(image.width() != width || image.height() != height || image.format() != QImage::Format_RGBA8888 ||
+       !image.isDetached())
+    {
+        image = QImage(width, height, QImage::Format_RGBA8888);
+    }
+}
+
+} // namespace
+
+MediaFramePyramid::MediaFramePyramid(const QImage& src, int max_edge)
+    : frame_id_(g_next_media_frame_id.fetch_add(1, std::memory_order_relaxed))
+{
+    if(src.isNull() || src.width() < 1 || src.height() < 1)
+    {
+        return;
+    }
+
+    const QImage full = src.convertToFormat(QImage::Format_RGBA8888);
+    max_edge = std::max(1, max_edge);
+    if(full.width() > max_edge || full.height() > max_edge)
+    {
+        const float scale = std::min((float)max_edge / (float)full.width(), (float)max_edge / (float)full.height());
+        const int width = std::clamp((int)std::lround((float)full.width() * scale), 1, max_edge);
+        const int height = std::clamp((int)std::lround((float)full.height() * scale), 1, max_edge);
+        base_ = QImage(width, height, QImage::Format_RGBA8888);
+        AreaDownscalePlan plan;
+        plan.Run(ViewOf(full.constBits(), full.width(), full.height(), (int)full.bytesPerLine()),
+                 width, height, base_.bits());
+    }
+    else
+    {
+        base_ = full;
+    }
+
+    // Levels are packed tightly; 32-bit QImage rows never carry padding.
+    CaptureMipChainBuilder builder;
+    builder.Build(base_.constBits(), base_.width(), base_.height(), mip_storage_, mip_levels_);
+}
+
+std::size_t MediaFramePyramid::ByteSize() const
+{
+    return (std::size_t)base_.sizeInBytes() + mip_storage_.size();
+}
+
+void MediaFramePyramid::ResolveInto(int width, int height, AreaDownscalePlan& plan, QImage& out) const
+{
+    if(base_.isNull() || width < 1 || height < 1)
+    {
+        out = QImage();
+        return;
+    }
+
+    CaptureImageView src = ViewOf(base_.constBits(), base_.width(), base_.height(), (int)base_.bytesPerLine());
+    for(const CaptureMipLevel& level : mip_levels_)
+    {
+        if(level.width < width || level.height < height)
+        {
+            break;
+        }
+        src = ViewOf(mip_storage_.data() + level.offset, level.width, level.height, level.width * 4);
+    }
+
+    EnsureImage(out, width, height);
+    plan.Run(src, width, height, out.bits());
+}
+
+const QImage& MediaFrameCache::Resolve(const MediaFramePyramid& frame, int width, int height)
+{
+    if(width == frame.Width() && height == frame.Height())
+    {
+        return frame.Base();
+    }
+
+    use_clock_++;
+    for(Entry& entry : entries_)
+    {
+        if(entry.frame_id == frame.FrameId() && entry.width == width && entry.height == height)
+        {
+            entry.last_use = use_clock_;
+            return entry.image;
+        }
+    }
+
+    Entry& entry = (entries_[0].last_use <= entries_[1].last_use) ? entries_[0] : entries_[1];
+    frame.ResolveInto(width, height, plan_, entry.image);
+    entry.frame_id = frame.FrameId();
+    entry.width = width;
+    entry.height = height;
+    entry.last_use = use_clock_;
+    return entry.image;
+}
+
+const QImage& MediaFrameCache::CrossFade(const QImage& from, const QImage& to, float t)
+{
+    blend_index_ ^= 1;
+    QImage& out = blend_[blend_index_];
+    if(to.isNull() || from.size() != to.size() ||
+       from.format() != QImage::Format_RGBA8888 || to.format() != QImage::Format_RGBA8888)
+    {
+        out = to;
+        return out;
+    }
+
+    EnsureImage(out, to.width(), to.height());
+    const std::size_t row_pixels = (std::size_t)to.width();
+    for(int y = 0; y < to.height(); y++)
+    {
+        CrossFadeRGBA8(from.constScanLine(y), to.constScanLine(y), out.scanLine(y), row_pixels, t);
+    }
+    return out;
+}
+
+void CrossFadeRGBA8(const uint8_t* a, const uint8_t* b, uint8_t* dst, std::size_t pixel_count, float t)
+{
+    // 8.8 fixed point: a * (256 - w) + b * w peaks at 255 * 256, so 16-bit lanes cannot overflow.
+    const int w = (int)std::lround(std::clamp(t, 0.0f, 1.0f) * 256.0f);
+    const int inv_w = 256 - w;
+    std::size_t i = 0;
+
+#ifdef MEDIA_FRAME_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weight_a = _mm_set1_epi16((short)inv_w);
+    const __m128i weight_b = _mm_set1_epi16((short)w);
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+    for(; i + 4 <= pixel_count; i += 4)
+    {
+        const __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4u));
+        const __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4u));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), weight_a),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), weight_b));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), weight_a),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), weight_b));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4u), _mm_or_si128(_mm_packus_epi16(lo, hi), alpha));
+    }
+#endif
+
+    for(; i < pixel_count; i++)
+    {
+        const uint8_t* pa = a + i * 4u;
+        const uint8_t* pb = b + i * 4u;
+        uint8_t* out = dst + i * 4u;
+        out[0] = (uint8_t)((pa[0] * inv_w + pb[0] * w + 128) >> 8);
+        out[1] = (uint8_t)((pa[1] * inv_w + pb[1] * w + 128) >> 8);
+        out[2] = (uint8_t)((pa[2] * inv_w + pb[2] * w + 128) >> 8);
+        out[3] = 255;
+    }
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef MEDIAFRAMEPYRAMID_H
+#define MEDIAFRAMEPYRAMID_H
+
+#include "CaptureDownscale.h"
+
+#include <QImage>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * One decoded media frame, prepared once when it is published: packed RGBA8
+ * (QImage::Format_RGBA8888) capped at max_edge, plus its box-filtered mip chain down to
+ * 1x1. Immutable after construction, so the publisher and PrepareGpuFields share it by
+ * pointer. FrameId() is unique per instance and keys MediaFrameCache.
+ */
+class MediaFramePyramid
+{
+public:
+    MediaFramePyramid(const QImage& src, int max_edge);
+
+    std::uint64_t FrameId() const { return frame_id_; }
+    bool IsNull() const { return base_.isNull(); }
+    int Width() const { return base_.width(); }
+    int Height() const { return base_.height(); }
+    const QImage& Base() const { return base_; }
+    std::size_t ByteSize() const;
+
+    /** Area-averaged width x height copy, read from the smallest level that still covers it. */
+    void ResolveInto(int width, int height, AreaDownscalePlan& plan, QImage& out) const;
+
+private:
+    std::uint64_t frame_id_ = 0;
+    QImage base_;
+    std::vector<uint8_t> mip_storage_;
+    std::vector<CaptureMipLevel> mip_levels_;
+};
+
+/**
+ * Per-effect resolutions of published pyramids, keyed by (frame id, size). Two entries:
+ * the current frame and the previous one a GIF cross-fade reads, so a frame step resolves
+ * only the new frame. A cached image keeps its QImage::cacheKey(), so the volume-field
+ * engine does not re-upload an unchanged texture. Only touched from PrepareGpuFields.
+ */
+class MediaFrameCache
+{
+public:
+    /** Base() itself when the size matches, otherwise a cached resolution. */
+    const QImage& Resolve(const MediaFramePyramid& frame, int width, int height);
+
+    /** lerp(from, to, t) per channel with alpha 255; from and to must share a size. Written into a reused buffer. */
+    const QImage& CrossFade(const QImage& from, const QImage& to, float t);
+
+private:
+    struct Entry
+    {
+        std::uint64_t frame_id = 0;
+        int width = 0;
+        int height = 0;
+        std::uint64_t last_use = 0;
+        QImage image;
+    };
+
+    Entry entries_[2];
+    std::uint64_t use_clock_ = 0;
+    AreaDownscalePlan plan_;
+    /** Alternated so the buffer written this frame is not the one the engine still shares from the last. */
+    QImage blend_[2];
+    int blend_index_ = 0;
+};
+
+/** dst = a + (b - a) * t on packed RGBA8 pixels, alpha forced to 255; SSE2 where available. */
+void CrossFadeRGBA8(const uint8_t* a, const uint8_t* b, uint8_t* dst, std::size_t pixel_count, float t);
+
+#endif
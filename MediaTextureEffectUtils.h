@@ -53,6 +53,23 @@ inline float AmbienceGain(float dist_origin, float max_r, float d_face,
     return std::clamp(g, 0.0f, 1.0f);
 }
 
+/** ambienceGain of the media volume shaders: dist_n already 0..1, sliders as 0..1 fractions. */
+inline float AmbienceGain01(float dist_n, float d_face, float fd, float c, float es)
+{
+    float g = 1.0f;
+    const float amount = std::clamp(fd * 0.95f + c * 0.55f, 0.0f, 1.0f);
+    if(amount > 1e-4f)
+    {
+        const float linear = 1.0f - std::clamp(dist_n, 0.0f, 1.0f) * (0.12f + 0.88f * amount);
+        g *= std::pow(std::clamp(linear, 0.0f, 1.0f), 0.70f + 3.8f * c);
+    }
+    if(es > 1e-4f)
+    {
+        g *= Smoothstep(0.0f, 0.035f + 0.55f * es, d_face);
+    }
+    return std::clamp(g, 0.0f, 1.0f);
+}
+
 inline int BilinearChannelSample(int a00, int a10, int a01, int a11, float ttx, float tty)
 {
     const float top = (float)a00 * (1.0f - ttx) + (float)a10 * ttx;
@@ -60,6 +77,21 @@ inline int BilinearChannelSample(int a00, int a10, int a01, int a11, float ttx,
     return (int)(top * (1.0f - tty) + bot * tty + 0.5f);
 }
 
+/** Texel as QRgb from a raw scanline; 32-bit formats skip QImage::pixel()'s per-call format dispatch. */
+inline QRgb FetchTexel(const QImage& img, const uchar* line, int x, int y, bool rgba8888, bool qrgb32)
+{
+    if(qrgb32)
+    {
+        return reinterpret_cast<const QRgb*>(line)[x];
+    }
+    if(rgba8888)
+    {
+        const uchar* p = line + x * 4;
+        return qRgba(p[0], p[1], p[2], p[3]);
+    }
+    return img.pixel(x, y);
+}
+
 inline RGBColor SampleImageBilinear(const QImage& img, float u, float v)
 {
     if(img.isNull() || img.width() < 1 || img.height() < 1)
@@ -69,11 +101,16 @@ inline RGBColor SampleImageBilinear(const QImage& img, float u, float v)
     u = std::clamp(u, 0.0f, 1.0f);
     v = std::clamp(v, 0.0f, 1.0f);
 
+    const QImage::Format format = img.format();
+    const bool qrgb32 = format == QImage::Format_RGB32 || format == QImage::Format_ARGB32 ||
+                        format == QImage::Format_ARGB32_Premultiplied;
+    const bool rgba8888 = format == QImage::Format_RGBA8888 || format == QImage::Format_RGBX8888;
+
     const int w = img.width();
     const int h = img.height();
     if(w == 1 && h == 1)
     {
-        const QRgb p = img.pixel(0, 0);
+        const QRgb p = FetchTexel(img, img.constScanLine(0), 0, 0, rgba8888, qrgb32);
         return ToRGBColor(qRed(p), qGreen(p), qBlue(p));
     }
 
@@ -86,10 +123,12 @@ inline RGBColor SampleImageBilinear(const QImage& img, float u, float v)
     const float tx = fx - (float)x0;
     const float ty = fy - (float)y0;
 
-    const QRgb p00 = img.pixel(x0, y0);
-    const QRgb p10 = img.pixel(x1, y0);
-    const QRgb p01 = img.pixel(x0, y1);
-    const QRgb p11 = img.pixel(x1, y1);
+    const uchar* line0 = img.constScanLine(y0);
+    const uchar* line1 = img.constScanLine(y1);
+    const QRgb p00 = FetchTexel(img, line0, x0, y0, rgba8888, qrgb32);
+    const QRgb p10 = FetchTexel(img, line0, x1, y0, rgba8888, qrgb32);
+    const QRgb p01 = FetchTexel(img, line1, x0, y1, rgba8888, qrgb32);
+    const QRgb p11 = FetchTexel(img, line1, x1, y1, rgba8888, qrgb32);
 
     const int r = BilinearChannelSample(qRed(p00), qRed(p10), qRed(p01), qRed(p11), tx, ty);
     const int g = BilinearChannelSample(qGreen(p00), qGreen(p10), qGreen(p01), qGreen(p11), tx, ty);
@@ -7,13 +7,6 @@ TEMPLATE = lib
 CONFIG += plugin silent c++17
 CONFIG -= debug_and_release debug_and_release_target
 
-msvc {
-    QMAKE_CXXFLAGS += /utf-8 /bigobj
-    greaterThan(QT_MAJOR_VERSION, 5): QMAKE_CXXFLAGS += /wd4996 /Zm300
-}
-
-win32:DEFINES += NOMINMAX WIN32_LEAN_AND_MEAN
-
 isEmpty(VERSION_NUM) {
     GIT_DESCRIBE = $$system("git describe --tags --always 2>nul || git describe --tags --always 2>/dev/null || echo ''")
     !isEmpty(GIT_DESCRIBE) {
@@ -85,84 +78,10 @@ prebuild_json.commands = $$QMAKE_STREAM_EDITOR -e \"s|VERSION_NUM|$$VERSION_NUM|
 QMAKE_EXTRA_TARGETS   += prebuild_json
 PRE_TARGETDEPS        += prebuild_json_target
 
-INCLUDEPATH += \
-    OpenRGB/ \
-    OpenRGB/SPDAccessor \
-    OpenRGB/hidapi_wrapper \
-    OpenRGB/dependencies/hidapi-win/include \
-    OpenRGB/i2c_smbus \
-    OpenRGB/RGBController \
-    OpenRGB/net_port \
-    OpenRGB/dependencies/json \
-    OpenRGB/qt
-
-HEADERS += \
-    OpenRGB/Colors.h \
-    OpenRGB/OpenRGBPluginInterface.h \
-    OpenRGB/ResourceManagerCallback.h \
-    OpenRGB/RGBController/RGBControllerInterface.h \
-    OpenRGB/RGBController/RGBController.h \
-    OpenRGB/LogManager.h \
-    PluginLog.h
-
-RESOURCES += \
-    resources/spatial_shaders.qrc \
-    resources/plugin_ui.qrc
-
-INCLUDEPATH += \
-    ui \
-    ui/widgets \
-    Effects3D \
-    Game \
-    Game/lz4 \
-    SpatialSamplers \
-    SpatialRoom \
-    SpatialLighting \
-    Shaders \
-    Audio
+include(SpatialEngine.pri)
 
 HEADERS += \
     OpenRGB3DSpatialPlugin.h \
-    LEDPosition3D.h \
-    ControllerLayout3D.h \
-    GridSpaceUtils.h \
-    ZoneGrid3D.h \
-    SpatialEffectTypes.h \
-    SpatialEffect3D.h \
-    EffectListManager3D.h \
-    EffectRegisterer3D.h \
-    EffectInstance3D.h \
-    StackPreset3D.h \
-    VirtualController3D.h \
-    VirtualReferencePoint3D.h \
-    Zone3D.h \
-    ZoneManager3D.h \
-    DisplayPlane3D.h \
-    DisplayPlaneManager.h \
-    ScreenCaptureManager.h \
-    Geometry3DUtils.h \
-    TransformJson.h \
-    MediaTextureEffectUtils.h \
-    Game/StripPatternSurface.h \
-    QtCompat.h \
-    ui/widgets/GameTelemetryStatusPanel.h \
-    Game/GameTelemetryBridge.h \
-    Game/RoomSampleFrameProtocol.h \
-    Game/RoomSampleShmPaths.h \
-    Game/RoomSampleFrameShmReader.h \
-    Game/RoomSampleConfigPublisher.h \
-    SpatialSamplers/SpatialBasisUtils.h \
-    SpatialSamplers/SpatialLayerCore.h \
-    SpatialSamplers/RoomSampleMapping.h \
-    Effects3D/Games/Minecraft/MinecraftGame.h \
-    Effects3D/Games/Minecraft/MinecraftGameSettings.h \
-    Effects3D/Games/Minecraft/MinecraftSubEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftHealth/MinecraftHealthEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftHunger/MinecraftHungerEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftAir/MinecraftAirEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftDurability/MinecraftDurabilityEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftDamage/MinecraftDamageEffect3D.h \
-    Effects3D/Games/Minecraft/MinecraftRoomAmbilight/MinecraftRoomAmbilightEffect3D.h \
     Effects3D/EffectPacks/EffectPack.h \
     Effects3D/EffectPacks/EffectPackPlayer.h \
     Effects3D/EffectPacks/EffectPackApplier.h \
@@ -176,17 +95,6 @@ HEADERS += \
     Effects3D/EventBindings/MacEventSource.h \
     Effects3D/EventBindings/EventSourceRegistry.h \
     Effects3D/EventBindings/BindingRuntime.h \
-    SpatialRoom/SpatialRoomTypes.h \
-    SpatialRoom/SpatialRoomDefaults.h \
-    SpatialRoom/SpatialRoomFrame.h \
-    SpatialLighting/BlockerGridOccluder.h \
-    SpatialLighting/OccluderSpatialIndex.h \
-    SpatialLighting/SpatialLightingEngine.h \
-    SpatialLighting/EmitterRelayMirror.h \
-    SpatialLighting/EmitterLocalSampling.h \
-    SpatialLighting/SpatialLightingSceneProvider.h \
-    Effects3D/SpatialLighting/RoomSpatialLightingUi.h \
-    ui/PluginSettingsPaths.h \
     ui/GridSettingsPanel.h \
     ui/SceneTransformPanel.h \
     ui/SceneObjectSpacingPanel.h \
@@ -209,13 +117,12 @@ HEADERS += \
     ui/EffectControlsHostPanel.h \
     ui/OpenRGB3DSpatialTab.h \
     ui/SpatialTabLedHelpers.h \
-    ui/ControllerDisplayUtils.h \
+    ui/EffectRenderWorker.h \
+    ui/ControllerOutputStage.h \
     ui/TooltipProxy.h \
     ui/LEDViewport3D.h \
     ui/LEDViewport3D_Internal.h \
     ui/ZoneControllerPickerDialog.h \
-    ui/CustomControllerTypes.h \
-    ui/CustomControllerMappingUtils.h \
     ui/CustomControllerGridKeys.h \
     ui/CustomControllerClipboard.h \
     ui/CustomControllerDialog.h \
@@ -235,7 +142,6 @@ HEADERS += \
     ui/SpatialControllerCardList.h \
     ui/CustomControllerDeviceWidget.h \
     ui/CustomControllerPreviewDialog.h \
-    ui/OpenRGBPluginsFont.h \
     ui/PluginClickableLabel.h \
     ui/Gizmo3D.h \
     ui/viewport/ViewportMath.h \
@@ -243,132 +149,10 @@ HEADERS += \
     ui/viewport/GlProgram.h \
     ui/viewport/MeshBatch.h \
     ui/viewport/MeshGeometry.h \
-    ui/viewport/ViewportShaders.h \
-    ui/CaptureZonesWidget.h \
-    ui/PluginUiUtils.h \
-    Effects3D/EffectStratumBlend.h \
-    Effects3D/EffectHelpers.h \
-    Effects3D/EffectUiSync.h \
-    Effects3D/AudioReactiveCommon.h \
-    Effects3D/SpatialKernelColormap.h \
-    ui/widgets/StripKernelColormapPanel.h \
-    ui/widgets/StratumBandPanel.h \
-    ui/widgets/EffectMotionPanel.h \
-    ui/widgets/EffectOutputPanel.h \
-    ui/widgets/EffectGeometryPanel.h \
-    ui/widgets/EffectSurfacesPanel.h \
-    ui/widgets/EffectLayerBanner.h \
-    ui/widgets/EffectStackBlendRow.h \
-    ui/widgets/EffectColorPanel.h \
-    ui/widgets/EffectCustomHost.h \
-    ui/widgets/EffectTransportRow.h \
-    ui/widgets/EffectSliderRow.h \
-    ui/widgets/EffectLabeledComboRow.h \
-    ui/widgets/EffectLabeledSpinRow.h \
-    ui/widgets/EffectCheckRow.h \
-    ui/widgets/EffectInfoLabel.h \
-    ui/widgets/EffectSectionHeading.h \
-    ui/widgets/EffectCollapsibleSection.h \
-    ui/widgets/RoomSpatialLightSettingsPanel.h \
-    ui/widgets/EffectRoomOutputPanel.h \
-    ui/widgets/RoomOutputDeviceCard.h \
-    ui/widgets/EffectUiRows.h \
-    ui/widgets/MediaTextureAmbienceBlock.h \
-    ui/widgets/AudioEqBandColumn.h \
-    ui/widgets/EffectControlsRoot.h \
-    Effects3D/SpectrumBars/SpectrumBars.h \
-    Effects3D/AudioStripVisualizer/AudioStripVisualizer.h \
-    Effects3D/ShaderField/ShaderField.h \
-    Shaders/SpatialShaderEngine.h \
-    Shaders/SpatialShaderUniforms.h \
-    Shaders/SpatialShaderCatalog.h \
-    Shaders/SpatialFieldAssistBase.h \
-    Shaders/SpatialVolumeFieldEngine.h \
-    Shaders/SpatialVolumeFieldAssist.h \
-    Shaders/SpatialStripFieldEngine.h \
-    Shaders/SpatialStripFieldAssist.h \
-    Effects3D/Plasma/PlasmaVolumeFieldGlsl.h \
-    Effects3D/Spiral/SpiralVolumeFieldGlsl.h \
-    Effects3D/Wave/WaveSurfaceVolumeFieldGlsl.h \
-    Effects3D/HexLattice/HexLatticeVolumeFieldGlsl.h \
-    Effects3D/PulseRing/PulseRingVolumeFieldGlsl.h \
-    Effects3D/DepthTone/DepthToneVolumeFieldGlsl.h \
-    Effects3D/ColorWheel/ColorWheelVolumeFieldGlsl.h \
-    Effects3D/BreathingSphere/BreathingSphereVolumeFieldGlsl.h \
-    Effects3D/HarmonicPulse/HarmonicPulseVolumeFieldGlsl.h \
-    Effects3D/DNAHelix/DNAHelixVolumeFieldGlsl.h \
-    Effects3D/RotatingConeSpotlights/RotatingConeVolumeFieldGlsl.h \
-    Effects3D/Bubbles/BubblesVolumeFieldGlsl.h \
-    Effects3D/BouncingBall/BouncingBallVolumeFieldGlsl.h \
-    Effects3D/Starfield/StarfieldVolumeFieldGlsl.h \
-    Effects3D/TextureProjection/TextureProjectionVolumeFieldGlsl.h \
-    Effects3D/OmniShapeTexture/OmniShapeTextureVolumeFieldGlsl.h \
-    Effects3D/TravelingLight/TravelingLightVolumeFieldGlsl.h \
-    Effects3D/SurfaceAmbient/SurfaceAmbientVolumeFieldGlsl.h \
-    Effects3D/ShellPattern/ShellPatternCubeVolumeFieldGlsl.h \
-    Effects3D/SpatialPatternKernels/SpatialStripKernelFieldGlsl.h \
-    Effects3D/AudioReactiveUi.h \
-    Effects3D/AudioLevel/AudioLevel.h \
-    Effects3D/AudioPulse/AudioPulse.h \
-    Audio/AudioInputManager.h \
-    Effects3D/Plasma/Plasma.h \
-    Effects3D/Spiral/Spiral.h \
-    Effects3D/TravelingLight/TravelingLight.h \
-    Effects3D/Wave/Wave.h \
-    Effects3D/BreathingSphere/BreathingSphere.h \
-    Effects3D/DNAHelix/DNAHelix.h \
-    Effects3D/BouncingBall/BouncingBall.h \
-    Effects3D/PulseRing/PulseRing.h \
-    Effects3D/SurfaceAmbient/SurfaceAmbient.h \
-    Effects3D/Starfield/Starfield.h \
-    Effects3D/Bubbles/Bubbles.h \
-    Effects3D/ColorWheel/ColorWheel.h \
-    Effects3D/ScreenMirror/ScreenMirror.h \
-    Effects3D/ScreenMirror/ScreenMirror_Internal.h \
-    Effects3D/ScreenMirror/ScreenMirrorCalibrationPattern.h \
-    Effects3D/ScreenMirror/ScreenMirrorMonitorPanel.h \
-    Effects3D/TextureProjection/TextureProjection.h \
-    Effects3D/OmniShapeTexture/OmniShapeTexture.h \
-    Effects3D/ShellPattern/ShellPattern.h \
-    Effects3D/SpatialPatternKernels/SpatialPatternKernels.h \
-    Effects3D/SpatialPatternKernels/SpatialPatternPalettes.h \
-    Effects3D/RotatingConeSpotlights/RotatingConeSpotlights.h \
-    Effects3D/HarmonicPulse/HarmonicPulse.h \
-    Effects3D/HexLattice/HexLattice.h \
-    Effects3D/DepthTone/DepthTone.h
+    ui/viewport/ViewportShaders.h
 
 SOURCES += \
     OpenRGB3DSpatialPlugin.cpp \
-    ControllerLayout3D.cpp \
-    GridSpaceUtils.cpp \
-    ZoneGrid3D.cpp \
-    SpatialEffect3D.cpp \
-    SpatialEffect3D_Eval.cpp \
-    SpatialEffect3D_Settings.cpp \
-    EffectInstance3D.cpp \
-    StackPreset3D.cpp \
-    VirtualController3D.cpp \
-    VirtualReferencePoint3D.cpp \
-    Zone3D.cpp \
-    ZoneManager3D.cpp \
-    DisplayPlane3D.cpp \
-    ScreenCaptureManager.cpp \
-    ui/widgets/GameTelemetryStatusPanel.cpp \
-    Game/GameTelemetryBridge.cpp \
-    Game/RoomSampleFrameShmReader.cpp \
-    Game/RoomSampleConfigPublisher.cpp \
-    Game/lz4/lz4.c \
-    SpatialSamplers/SpatialLayerCore.cpp \
-    SpatialSamplers/RoomSampleMapping.cpp \
-    Effects3D/Games/Minecraft/MinecraftGame.cpp \
-    Effects3D/Games/Minecraft/MinecraftGameSettings.cpp \
-    Effects3D/Games/Minecraft/MinecraftSubEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftHealth/MinecraftHealthEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftHunger/MinecraftHungerEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftAir/MinecraftAirEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftDurability/MinecraftDurabilityEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftDamage/MinecraftDamageEffect3D.cpp \
-    Effects3D/Games/Minecraft/MinecraftRoomAmbilight/MinecraftRoomAmbilightEffect3D.cpp \
     Effects3D/EffectPacks/EffectPack.cpp \
     Effects3D/EffectPacks/EffectPackSerialize.cpp \
     Effects3D/EffectPacks/EffectPackBlockEvalAxis.cpp \
@@ -384,16 +168,6 @@ SOURCES += \
     Effects3D/EventBindings/MacEventSource.cpp \
     Effects3D/EventBindings/EventSourceRegistry.cpp \
     Effects3D/EventBindings/BindingRuntime.cpp \
-    SpatialRoom/SpatialRoomDefaults.cpp \
-    SpatialRoom/SpatialRoomFrame.cpp \
-    SpatialLighting/BlockerGridOccluder.cpp \
-    SpatialLighting/OccluderSpatialIndex.cpp \
-    SpatialLighting/SpatialLightingEngine.cpp \
-    SpatialLighting/EmitterRelayMirror.cpp \
-    SpatialLighting/EmitterLocalSampling.cpp \
-    SpatialLighting/SpatialLightingSceneProvider.cpp \
-    Effects3D/SpatialLighting/RoomSpatialLightingUi.cpp \
-    ui/PluginSettingsPaths.cpp \
     ui/GridSettingsPanel.cpp \
     ui/SceneTransformPanel.cpp \
     ui/SceneObjectSpacingPanel.cpp \
@@ -431,6 +205,8 @@ SOURCES += \
     ui/ZoneControllerPickerDialog.cpp \
     ui/OpenRGB3DSpatialTab_Effects.cpp \
     ui/OpenRGB3DSpatialTab_EffectsRender.cpp \
+    ui/EffectRenderWorker.cpp \
+    ui/ControllerOutputStage.cpp \
     ui/OpenRGB3DSpatialTab_EffectsProfiles.cpp \
     ui/LEDViewport3D.cpp \
     ui/LEDViewport3D_Input.cpp \
@@ -443,17 +219,14 @@ SOURCES += \
     ui/CustomControllerDialog_Grid.cpp \
     ui/CustomControllerDialog_Sources.cpp \
     ui/CustomControllerDialog_Transform.cpp \
-    ui/CustomControllerMappingUtils.cpp \
     ui/ReferencePointDialog.cpp \
     ui/DisplayPlaneDialog.cpp \
     ui/custom-controller-grid/CustomControllerGridItem.cpp \
     ui/custom-controller-grid/CustomControllerGridScene.cpp \
     ui/custom-controller-grid/CustomControllerLayoutGrid.cpp \
     ui/ControllerCards.cpp \
-    ui/ControllerDisplayUtils.cpp \
     ui/CustomControllerWidgets.cpp \
     ui/CustomControllerPreviewDialog.cpp \
-    ui/OpenRGBPluginsFont.cpp \
     ui/PluginClickableLabel.cpp \
     ui/Gizmo3D.cpp \
     ui/Gizmo3D_Mesh.cpp \
@@ -462,63 +235,9 @@ SOURCES += \
     ui/viewport/GlProgram.cpp \
     ui/viewport/MeshBatch.cpp \
     ui/viewport/MeshGeometry.cpp \
-    ui/viewport/ViewportShaders.cpp \
-    ui/CaptureZonesWidget.cpp \
-    ui/widgets/StratumBandPanel.cpp \
-    ui/widgets/StripKernelColormapPanel.cpp \
-    ui/widgets/EffectCommonPanels.cpp \
-    ui/widgets/EffectRowWidgets.cpp \
-    ui/widgets/RoomSpatialLightSettingsPanel.cpp \
-    ui/widgets/EffectRoomOutputPanel.cpp \
-    ui/widgets/RoomOutputDeviceCard.cpp \
-    ui/widgets/EffectStackBlendRow.cpp \
-    ui/widgets/EffectCustomHost.cpp \
-    ui/widgets/EffectTransportRow.cpp \
-    ui/widgets/MediaTextureAmbienceBlock.cpp \
-    ui/widgets/AudioEqBandColumn.cpp \
-    Effects3D/Plasma/Plasma.cpp \
-    Effects3D/Spiral/Spiral.cpp \
-    Effects3D/TravelingLight/TravelingLight.cpp \
-    Effects3D/Wave/Wave.cpp \
-    Effects3D/BreathingSphere/BreathingSphere.cpp \
-    Effects3D/DNAHelix/DNAHelix.cpp \
-    Effects3D/BouncingBall/BouncingBall.cpp \
-    Effects3D/SpectrumBars/SpectrumBars.cpp \
-    Effects3D/AudioStripVisualizer/AudioStripVisualizer.cpp \
-    Effects3D/ShaderField/ShaderField.cpp \
-    Shaders/SpatialShaderEngine.cpp \
-    Shaders/SpatialShaderCatalog.cpp \
-    Shaders/SpatialVolumeFieldEngine.cpp \
-    Shaders/SpatialVolumeFieldAssist.cpp \
-    Shaders/SpatialStripFieldEngine.cpp \
-    Shaders/SpatialStripFieldAssist.cpp \
-    Effects3D/AudioLevel/AudioLevel.cpp \
-    Effects3D/AudioPulse/AudioPulse.cpp \
-    Effects3D/PulseRing/PulseRing.cpp \
-    Effects3D/SurfaceAmbient/SurfaceAmbient.cpp \
-    Effects3D/Starfield/Starfield.cpp \
-    Effects3D/Bubbles/Bubbles.cpp \
-    Effects3D/ColorWheel/ColorWheel.cpp \
-    Effects3D/ScreenMirror/ScreenMirror.cpp \
-    Effects3D/ScreenMirror/ScreenMirror_Render.cpp \
-    Effects3D/ScreenMirror/ScreenMirror_Settings.cpp \
-    Effects3D/ScreenMirror/ScreenMirrorMonitorPanel.cpp \
-    Effects3D/TextureProjection/TextureProjection.cpp \
-    Effects3D/OmniShapeTexture/OmniShapeTexture.cpp \
-    Effects3D/ShellPattern/ShellPattern.cpp \
-    Effects3D/SpatialPatternKernels/SpatialPatternKernels.cpp \
-    Effects3D/SpatialPatternKernels/SpatialPatternPalettes.cpp \
-    Effects3D/RotatingConeSpotlights/RotatingConeSpotlights.cpp \
-    Effects3D/HarmonicPulse/HarmonicPulse.cpp \
-    Effects3D/HexLattice/HexLattice.cpp \
-    Effects3D/DepthTone/DepthTone.cpp \
-    Audio/AudioInputManager.cpp
+    ui/viewport/ViewportShaders.cpp
 
 win32:CONFIG += QTPLUGIN
-win32:LIBS += \
-    -lOle32 -lOleAut32 -lAvrt -lMmdevapi -lPropsys -luuid \
-    -lgdi32 -luser32 -ld3d11 -ldxgi -ld3dcompiler \
-    -lws2_32 -lopengl32 -lWtsapi32
 
 win32:CONFIG(debug, debug|release): DESTDIR = debug
 win32:CONFIG(release, debug|release): DESTDIR = release
@@ -543,12 +262,6 @@ win32 {
     QMAKE_EXTRA_TARGETS += quietclean
 }
 
-win32:DEFINES += \
-    _MBCS \
-    WIN32 \
-    _CRT_SECURE_NO_WARNINGS \
-    _WINSOCK_DEPRECATED_NO_WARNINGS
-
 FORMS += \
     ui/forms/OpenRGB3DSpatialTab.ui \
     ui/forms/GridSettingsPanel.ui \
@@ -557,7 +270,6 @@ FORMS += \
     ui/forms/SceneObjectEditHostPanel.ui \
     ui/forms/ObjectCreatorTabPanel.ui \
     ui/forms/ControllerListPanel.ui \
-    ui/forms/MediaTextureAmbienceBlock.ui \
     ui/forms/EffectLibraryPanel.ui \
     ui/forms/EffectPackPanel.ui \
     ui/forms/EventBindingsPanel.ui \
@@ -566,51 +278,22 @@ FORMS += \
     ui/forms/EffectGlobalSettingsPanel.ui \
     ui/forms/AudioInputPanel.ui \
     ui/forms/AudioAdvancedSettingsDialog.ui \
-    ui/forms/EffectLayerBanner.ui \
-    ui/forms/EffectMotionPanel.ui \
-    ui/forms/EffectOutputPanel.ui \
-    ui/forms/EffectSurfacesPanel.ui \
-    ui/forms/EffectGeometryPanel.ui \
-    ui/forms/EffectColorPanel.ui \
     ui/forms/ZoneControllerPickerDialog.ui \
-    ui/forms/EffectStackBlendRow.ui \
     ui/forms/CustomControllerDialog.ui \
     ui/forms/ReferencePointDialog.ui \
     ui/forms/DisplayPlaneDialog.ui \
-    ui/forms/StratumBandPanel.ui \
-    ui/forms/StripKernelColormapPanel.ui \
-    ui/forms/GameTelemetryStatusPanel.ui \
-    ui/forms/EffectTransportRow.ui \
-    ui/forms/AudioEqBandColumn.ui \
     ui/forms/CustomControllerPreviewDialog.ui \
-    ui/forms/CaptureZonesWidget.ui \
     ui/forms/SpatialControllerCardWidget.ui \
     ui/forms/SpatialControllerCardList.ui \
     ui/forms/CustomControllerDeviceWidget.ui \
-    ui/forms/CustomControllerDeviceList.ui \
-    ui/forms/EffectSliderRow.ui \
-    ui/forms/EffectLabeledComboRow.ui \
-    ui/forms/EffectLabeledSpinRow.ui \
-    ui/forms/EffectCheckRow.ui \
-    ui/forms/EffectInfoLabel.ui \
-    ui/forms/EffectSectionHeading.ui \
-    ui/forms/EffectCollapsibleSection.ui \
-    ui/forms/RoomSpatialLightSettingsPanel.ui \
-    ui/forms/ScreenMirrorCapturePanel.ui \
-    ui/forms/ScreenMirrorMonitorSettings.ui \
-    ui/forms/ScreenMirrorEffectShell.ui \
-    ui/forms/MinecraftGameSettingsScroll.ui
+    ui/forms/CustomControllerDeviceList.ui
 
 unix:!macx {
     QT += dbus
     # Q_OBJECT helper - only moc on Linux (header is #ifdef Q_OS_LINUX).
     HEADERS += Effects3D/EventBindings/LinuxLoginWatcher.h
-    # GCC 16 + Qt 6 / nlohmann json: false positives from system and bundled headers.
-    QMAKE_CXXFLAGS += -Wno-psabi -Wno-array-bounds -Wno-sfinae-incomplete
     target.path = $$PREFIX/lib/openrgb/plugins/
     INSTALLS += target
-    LIBS += -lGL
 }
 
 QMAKE_MACOSX_DEPLOYMENT_TARGET = 10.15
-macx:LIBS += -framework OpenGL -framework CoreFoundation -framework IOKit
@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ScreenCaptureBackend.h"
+#include "PluginLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+namespace
+{
+
+/** Horizontal scroll period of the synthetic pattern, in pixels. */
+constexpr int kSyntheticPeriod = 256;
+
+/**
+ * Diagonal colour bands plus a vertical luminance ramp, rendered once into a buffer one
+ * period wider than the output; Grab() scrolls the view instead of redrawing.
+ */
+class SyntheticCaptureBackend : public ScreenCaptureBackend
+{
+public:
+    SyntheticCaptureBackend(int width, int height)
+        : width(std::max(1, width)), height(std::max(1, height)), phase(0)
+    {
+    }
+
+    const char* Name() const override { return "synthetic"; }
+
+    bool Open() override
+    {
+        const int buffer_width = width + kSyntheticPeriod;
+        pixels.resize((size_t)buffer_width * (size_t)height * 4u);
+        for(int y = 0; y < height; y++)
+        {
+            uint8_t* row = pixels.data() + (size_t)y * (size_t)buffer_width * 4u;
+            const int luma = 64 + (191 * y) / std::max(1, height - 1);
+            for(int x = 0; x < buffer_width; x++)
+            {
+                const int band = (x + y) % kSyntheticPeriod;
+                uint8_t* px = row + (size_t)x * 4u;
+                px[0] = (uint8_t)((band * luma) / kSyntheticPeriod);
+                px[1] = (uint8_t)(((kSyntheticPeriod - 1 - band) * luma) / kSyntheticPeriod);
+                px[2] = (uint8_t)(((band * 2) % kSyntheticPeriod * luma) / kSyntheticPeriod);
+                px[3] = 255;
+            }
+        }
+        phase = 0;
+        return true;
+    }
+
+    void Close() override
+    {
+        pixels.clear();
+        pixels.shrink_to_fit();
+    }
+
+    bool Grab(CaptureImageView& out_view) override
+    {
+        if(pixels.empty())
+        {
+            return false;
+        }
+        const int buffer_width = width + kSyntheticPeriod;
+        out_view.pixels = pixels.data() + (size_t)phase * 4u;
+        out_view.width = width;
+        out_view.height = height;
+        out_view.stride_bytes = buffer_width * 4;
+        out_view.format = CapturePixelFormat::RGBA8888;
+        phase = (phase + 4) % kSyntheticPeriod;
+        return true;
+    }
+
+private:
+    int                     width;
+    int                     height;
+    int                     phase;
+    std::vector<uint8_t>    pixels;
+};
+
+bool ReadPpmToken(std::istream& in, std::string& token)
+{
+    token.clear();
+    char ch = 0;
+    while(in.get(ch))
+    {
+        if(ch == '#')
+        {
+            std::string comment;
+            std::getline(in, comment);
+            continue;
+        }
+        if(ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+        {
+            if(!token.empty())
+            {
+                return true;
+            }
+            continue;
+        }
+        token.push_back(ch);
+    }
+    return !token.empty();
+}
+
+class FileCaptureBackend : public ScreenCaptureBackend
+{
+public:
+    explicit FileCaptureBackend(const std::string& path)
+        : path(path), width(0), height(0)
+    {
+    }
+
+    const char* Name() const override { return "file"; }
+
+    bool Open() override
+    {
+        std::ifstream in(path, std::ios::binary);
+        if(!in)
+        {
+            LOG_WARNING("[ScreenCapture] Cannot open capture file '%s'", path.c_str());
+            return false;
+        }
+
+        std::string magic, w_token, h_token, max_token;
+        if(!ReadPpmToken(in, magic) || magic != "P6" ||
+           !ReadPpmToken(in, w_token) || !ReadPpmToken(in, h_token) || !ReadPpmToken(in, max_token))
+        {
+            LOG_WARNING("[ScreenCapture] '%s' is not a binary PPM (P6)", path.c_str());
+            return false;
+        }
+        try
+        {
+            width = std::stoi(w_token);
+            height = std::stoi(h_token);
+        }
+        catch(...)
+        {
+            width = 0;
+            height = 0;
+        }
+        if(width <= 0 || height <= 0 || max_token != "255")
+        {
+            LOG_WARNING("[ScreenCapture] Unsupported PPM header in '%s' (need 8-bit P6)", path.c_str());
+            return false;
+        }
+
+        // ReadPpmToken consumed the single whitespace byte that ends the header.
+        std::vector<uint8_t> rgb((size_t)width * (size_t)height * 3u);
+        if(!in.read(reinterpret_cast<char*>(rgb.data()), (std::streamsize)rgb.size()))
+        {
+            LOG_WARNING("[ScreenCapture] Truncated pixel data in '%s'", path.c_str());
+            return false;
+        }
+
+        pixels.resize((size_t)width * (size_t)height * 4u);
+        for(size_t i = 0, count = (size_t)width * (size_t)height; i < count; i++)
+        {
+            pixels[i * 4u + 0u] = rgb[i * 3u + 0u];
+            pixels[i * 4u + 1u] = rgb[i * 3u + 1u];
+            pixels[i * 4u + 2u] = rgb[i * 3u + 2u];
+            pixels[i * 4u + 3u] = 255;
+        }
+        return true;
+    }
+
+    void Close() override
+    {
+        pixels.clear();
+        pixels.shrink_to_fit();
+    }
+
+    bool Grab(CaptureImageView& out_view) override
+    {
+        if(pixels.empty())
+        {
+            return false;
+        }
+        out_view.pixels = pixels.data();
+        out_view.width = width;
+        out_view.height = height;
+        out_view.stride_bytes = width * 4;
+        out_view.format = CapturePixelFormat::RGBA8888;
+        return true;
+    }
+
+private:
+    std::string             path;
+    int                     width;
+    int                     height;
+    std::vector<uint8_t>    pixels;
+};
+
+} // namespace
+
+std::unique_ptr<ScreenCaptureBackend> CreateSyntheticCaptureBackend(int width, int height)
+{
+    return std::make_unique<SyntheticCaptureBackend>(width, height);
+}
+
+std::unique_ptr<ScreenCaptureBackend> CreateFileCaptureBackend(const std::string& path)
+{
+    return std::make_unique<FileCaptureBackend>(path);
+}
+
+CapturedFrameRing::CapturedFrameRing()
+    : next_slot(0)
+{
+    slots.reserve(kInitialSlots);
+    for(size_t i = 0; i < kInitialSlots; i++)
+    {
+        slots.push_back(std::make_shared<CapturedFrame>());
+    }
+}
+
+std::shared_ptr<CapturedFrame> CapturedFrameRing::Acquire(int width, int height)
+{
+    std::shared_ptr<CapturedFrame> frame;
+    const size_t count = slots.size();
+    for(size_t i = 0; i < count; i++)
+    {
+        const size_t index = (next_slot + i) % count;
+        // use_count() == 1: only the ring holds it, and only this thread can hand out new references.
+        if(slots[index].use_count() == 1)
+        {
+            // Pairs with the reader's release of its last reference before we overwrite the pixels.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            frame = slots[index];
+            next_slot = (index + 1) % count;
+            break;
+        }
+    }
+
+    if(!frame)
+    {
+        frame = std::make_shared<CapturedFrame>();
+        if(slots.size() < kMaxSlots)
+        {
+            slots.push_back(frame);
+            next_slot = 0;
+        }
+    }
+
+    frame->width = width;
+    frame->height = height;
+    frame->data.resize((size_t)width * (size_t)height * 4u);
+    frame->valid = false;
+    frame->used_gdi_capture = false;
+    return frame;
+}
+
+CaptureFramePipeline::CaptureFramePipeline(std::unique_ptr<ScreenCaptureBackend> backend)
+    : backend(std::move(backend)), opened(false)
+{
+}
+
+CaptureFramePipeline::~CaptureFramePipeline()
+{
+    Close();
+}
+
+bool CaptureFramePipeline::Open()
+{
+    if(!opened && backend)
+    {
+        opened = backend->Open();
+    }
+    return opened;
+}
+
+void CaptureFramePipeline::Close()
+{
+    if(opened && backend)
+    {
+        backend->Close();
+    }
+    opened = false;
+}
+
+const char* CaptureFramePipeline::GetBackendName() const
+{
+    return backend ? backend->Name() : "none";
+}
+
+std::shared_ptr<CapturedFrame> CaptureFramePipeline::Capture(int target_width, int target_height, uint64_t frame_id, bool build_mips)
+{
+    if(!opened)
+    {
+        return nullptr;
+    }
+
+    CaptureImageView view;
+    if(!backend->Grab(view) || !view.IsValid())
+    {
+        return nullptr;
+    }
+
+    const int out_w = target_width > 0 ? target_width : view.width;
+    const int out_h = target_height > 0 ? target_height : view.height;
+
+    std::shared_ptr<CapturedFrame> frame = ring.Acquire(out_w, out_h);
+    downscale.Run(view, out_w, out_h, frame->data.data());
+    if(build_mips)
+    {
+        mip_builder.Build(frame->data.data(), out_w, out_h, frame->mip_data, frame->mips);
+    }
+    else
+    {
+        frame->mips.clear();
+    }
+
+    frame->frame_id = frame_id;
+    frame->timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    frame->valid = true;
+    return frame;
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef SCREENCAPTUREBACKEND_H
+#define SCREENCAPTUREBACKEND_H
+
+#include "CaptureDownscale.h"
+#include "ScreenCaptureManager.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * One source of full-resolution 32-bit pixels for a capture thread. Open()/Grab()/Close()
+ * are only ever called from that thread, so implementations may keep thread-affine handles
+ * (an X display connection, a shared-memory segment). Grab() hands out a view into
+ * backend-owned storage that stays valid until the next Grab() or Close().
+ */
+class ScreenCaptureBackend
+{
+public:
+    virtual ~ScreenCaptureBackend() = default;
+
+    virtual const char* Name() const = 0;
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+    /** False when no new image is available this tick (display gone, read error). */
+    virtual bool Grab(CaptureImageView& out_view) = 0;
+};
+
+/** Moving test pattern; no display or file needed, so capture can be exercised and benchmarked headless. */
+std::unique_ptr<ScreenCaptureBackend> CreateSyntheticCaptureBackend(int width, int height);
+
+/** Binary PPM (P6, maxval 255) loaded once and replayed every Grab(). */
+std::unique_ptr<ScreenCaptureBackend> CreateFileCaptureBackend(const std::string& path);
+
+#ifndef _WIN32
+/** X11 root-window capture of one screen rectangle: XShmGetImage into a shared segment, XGetImage when MIT-SHM is unavailable. Null when built without X11. */
+std::unique_ptr<ScreenCaptureBackend> CreateX11CaptureBackend(int x, int y, int width, int height);
+
+/** QScreen::grabWindow fallback (Wayland, or builds without X11). */
+std::unique_ptr<ScreenCaptureBackend> CreateQtScreenCaptureBackend(int screen_index);
+#endif
+
+/**
+ * Preallocated pool of CapturedFrame objects handed to readers through shared_ptr. A slot is
+ * reused once nothing but the ring references it, so with the usual single reader (latest
+ * frame + render-tick snapshot) three slots cycle forever. Readers that retain frames (the
+ * ScreenMirror history) grow the ring up to kMaxSlots; beyond that frames are transient.
+ */
+class CapturedFrameRing
+{
+public:
+    static constexpr size_t kInitialSlots = 3;
+    static constexpr size_t kMaxSlots = 256;
+
+    CapturedFrameRing();
+
+    /** Unreferenced frame with data sized to width * height * 4; valid is cleared until the caller fills it. */
+    std::shared_ptr<CapturedFrame> Acquire(int width, int height);
+
+    size_t GetSlotCount() const { return slots.size(); }
+
+private:
+    std::vector<std::shared_ptr<CapturedFrame>> slots;
+    size_t                                      next_slot;
+};
+
+/** Backend grab -> fused area-average downscale / RGBA convert -> ring slot. One per capture thread. */
+class CaptureFramePipeline
+{
+public:
+    explicit CaptureFramePipeline(std::unique_ptr<ScreenCaptureBackend> backend);
+    ~CaptureFramePipeline();
+
+    CaptureFramePipeline(const CaptureFramePipeline&) = delete;
+    CaptureFramePipeline& operator=(const CaptureFramePipeline&) = delete;
+
+    bool Open();
+    void Close();
+    const char* GetBackendName() const;
+
+    /** Null when the backend had nothing to grab; otherwise a filled frame of target size (source size when either is <= 0). */
+    std::shared_ptr<CapturedFrame> Capture(int target_width, int target_height, uint64_t frame_id, bool build_mips);
+
+    size_t GetRingSlotCount() const { return ring.GetSlotCount(); }
+
+private:
+    std::unique_ptr<ScreenCaptureBackend>   backend;
+    CapturedFrameRing                       ring;
+    AreaDownscalePlan                       downscale;
+    CaptureMipChainBuilder                  mip_builder;
+    bool                                    opened;
+};
+
+#endif // SCREENCAPTUREBACKEND_H
@@ -0,0 +1,402 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef _WIN32
+
+#include "ScreenCaptureBackend.h"
+#include "PluginLog.h"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QPixmap>
+#include <QScreen>
+
+#ifdef SPATIAL_CAPTURE_XSHM
+    #include <X11/Xlib.h>
+    #include <X11/Xutil.h>
+    #include <X11/extensions/XShm.h>
+    #include <sys/ipc.h>
+    #include <sys/shm.h>
+    #include <atomic>
+    #include <cstdlib>
+    #include <cstring>
+    #include <mutex>
+#endif
+
+namespace
+{
+
+#ifdef SPATIAL_CAPTURE_XSHM
+
+/*---------------------------------------------------------*\
+| XShmAttach / XShmGetImage report failure (remote X, a     |
+| rectangle left outside the root after a mode change)      |
+| through the error handler, whose default terminates the   |
+| process; trap it around those requests. The handler is    |
+| process-wide, so capture threads take turns holding the   |
+| trap, and it only claims errors from the trapped          |
+| connection; any other display's go to the previous one.   |
+\*---------------------------------------------------------*/
+std::mutex                 x11_trap_mutex;
+std::atomic<Display*>      x11_trap_display{nullptr};
+std::atomic<XErrorHandler> x11_trap_previous{nullptr};
+std::atomic<bool>          x11_trap_failed{false};
+
+int TrapX11Error(Display* display, XErrorEvent* event)
+{
+    if(display == x11_trap_display.load())
+    {
+        x11_trap_failed.store(true);
+        return 0;
+    }
+    const XErrorHandler previous = x11_trap_previous.load();
+    return previous ? previous(display, event) : 0;
+}
+
+/** Traps X errors on display for its lifetime; check Failed() once the request has round-tripped. */
+class ScopedX11ErrorTrap
+{
+public:
+    explicit ScopedX11ErrorTrap(Display* display)
+        : lock(x11_trap_mutex)
+    {
+        x11_trap_failed.store(false);
+        x11_trap_display.store(display);
+        x11_trap_previous.store(XSetErrorHandler(TrapX11Error));
+    }
+
+    ~ScopedX11ErrorTrap()
+    {
+        XSetErrorHandler(x11_trap_previous.exchange(nullptr));
+        x11_trap_display.store(nullptr);
+    }
+
+    ScopedX11ErrorTrap(const ScopedX11ErrorTrap&) = delete;
+    ScopedX11ErrorTrap& operator=(const ScopedX11ErrorTrap&) = delete;
+
+    bool Failed() const { return x11_trap_failed.load(); }
+
+private:
+    std::lock_guard<std::mutex> lock;
+};
+
+/** ZPixmap bits per pixel the server uses for depth, or 0 when it lists no such format. */
+int PixmapBitsPerPixel(Display* display, int depth)
+{
+    int count = 0;
+    XPixmapFormatValues* formats = XListPixmapFormats(display, &count);
+    int bits_per_pixel = 0;
+    for(int i = 0; formats && i < count; i++)
+    {
+        if(formats[i].depth == depth)
+        {
+            bits_per_pixel = formats[i].bits_per_pixel;
+            break;
+        }
+    }
+    if(formats)
+    {
+        XFree(formats);
+    }
+    return bits_per_pixel;
+}
+
+/** Root-window grab of one screen rectangle over a private display connection owned by the capture thread. */
+class X11CaptureBackend : public ScreenCaptureBackend
+{
+public:
+    X11CaptureBackend(int x, int y, int width, int height)
+        : x(x), y(y), width(width), height(height),
+          display(nullptr), root(0), image(nullptr), use_shm(false), shm_attached(false)
+    {
+        std::memset(&shm_info, 0, sizeof(shm_info));
+        shm_info.shmid = -1;
+        shm_info.shmaddr = (char*)-1;
+    }
+
+    ~X11CaptureBackend() override
+    {
+        Close();
+    }
+
+    const char* Name() const override { return use_shm ? "x11-shm" : "x11"; }
+
+    bool Open() override
+    {
+        if(width <= 0 || height <= 0)
+        {
+            return false;
+        }
+
+        display = XOpenDisplay(nullptr);
+        if(!display)
+        {
+            return false;
+        }
+        root = DefaultRootWindow(display);
+
+        // Grab only hands out 32-bpp views; reject other visuals here so the Qt backend takes over.
+        const int bits_per_pixel = PixmapBitsPerPixel(display, DefaultDepth(display, DefaultScreen(display)));
+        if(bits_per_pixel != 32)
+        {
+            LOG_INFO("[ScreenCapture] X11 root is %d bpp, not 32; using Qt capture", bits_per_pixel);
+            Close();
+            return false;
+        }
+
+        use_shm = XShmQueryExtension(display) && AttachSharedImage();
+        if(!use_shm)
+        {
+            LOG_INFO("[ScreenCapture] MIT-SHM unavailable, falling back to XGetImage");
+        }
+        return true;
+    }
+
+    void Close() override
+    {
+        if(use_shm)
+        {
+            ReleaseSharedImage();
+        }
+        else if(image)
+        {
+            XDestroyImage(image);
+            image = nullptr;
+        }
+        if(display)
+        {
+            XCloseDisplay(display);
+            display = nullptr;
+        }
+        use_shm = false;
+    }
+
+    bool Grab(CaptureImageView& out_view) override
+    {
+        if(!display)
+        {
+            return false;
+        }
+
+        if(use_shm)
+        {
+            ScopedX11ErrorTrap trap(display);
+            const bool grabbed = XShmGetImage(display, root, image, x, y, AllPlanes);
+            if(!grabbed || trap.Failed())
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if(image)
+            {
+                XDestroyImage(image);
+                image = nullptr;
+            }
+            ScopedX11ErrorTrap trap(display);
+            image = XGetImage(display, root, x, y, (unsigned int)width, (unsigned int)height, AllPlanes, ZPixmap);
+            if(!image || trap.Failed())
+            {
+                return false;
+            }
+        }
+
+        if(image->bits_per_pixel != 32)
+        {
+            return false;
+        }
+        out_view.pixels = reinterpret_cast<const uint8_t*>(image->data);
+        out_view.width = image->width;
+        out_view.height = image->height;
+        out_view.stride_bytes = image->bytes_per_line;
+        out_view.format = (image->red_mask == 0xFF0000ul && image->byte_order == LSBFirst)
+                        ? CapturePixelFormat::BGRA8888
+                        : CapturePixelFormat::RGBA8888;
+        return true;
+    }
+
+private:
+    bool AttachSharedImage()
+    {
+        const int screen = DefaultScreen(display);
+        image = XShmCreateImage(display, DefaultVisual(display, screen), (unsigned int)DefaultDepth(display, screen),
+                                ZPixmap, nullptr, &shm_info, (unsigned int)width, (unsigned int)height);
+        if(!image)
+        {
+            return false;
+        }
+
+        shm_info.shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * (size_t)image->height, IPC_CREAT | 0600);
+        if(shm_info.shmid < 0)
+        {
+            ReleaseSharedImage();
+            return false;
+        }
+        shm_info.shmaddr = image->data = (char*)shmat(shm_info.shmid, nullptr, 0);
+        if(shm_info.shmaddr == (char*)-1)
+        {
+            image->data = nullptr;
+            ReleaseSharedImage();
+            return false;
+        }
+        shm_info.readOnly = False;
+
+        bool attached = false;
+        {
+            ScopedX11ErrorTrap trap(display);
+            attached = XShmAttach(display, &shm_info);
+            XSync(display, False);
+            attached = attached && !trap.Failed();
+        }
+
+        // Marked for removal now; the segment lives until both sides detach.
+        shmctl(shm_info.shmid, IPC_RMID, nullptr);
+
+        if(!attached)
+        {
+            ReleaseSharedImage();
+            return false;
+        }
+        shm_attached = true;
+        return true;
+    }
+
+    void ReleaseSharedImage()
+    {
+        if(shm_attached)
+        {
+            XShmDetach(display, &shm_info);
+            XSync(display, False);
+            shm_attached = false;
+        }
+        if(image)
+        {
+            // The pixels are the shared segment, not Xlib's malloc; keep XDestroyImage from freeing them.
+            image->data = nullptr;
+            XDestroyImage(image);
+            image = nullptr;
+        }
+        if(shm_info.shmaddr != (char*)-1)
+        {
+            shmdt(shm_info.shmaddr);
+            shm_info.shmaddr = (char*)-1;
+        }
+        if(shm_info.shmid >= 0)
+        {
+            shmctl(shm_info.shmid, IPC_RMID, nullptr);
+            shm_info.shmid = -1;
+        }
+    }
+
+    int                 x;
+    int                 y;
+    int                 width;
+    int                 height;
+    Display*            display;
+    Window              root;
+    XImage*             image;
+    XShmSegmentInfo     shm_info;
+    bool                use_shm;
+    bool                shm_attached;
+};
+
+#endif
+
+/** QScreen::grabWindow per tick; Qt allocates the pixmap, but downscale and publication still go through the ring. */
+class QtScreenCaptureBackend : public ScreenCaptureBackend
+{
+public:
+    explicit QtScreenCaptureBackend(int screen_index)
+        : screen_index(screen_index)
+    {
+    }
+
+    const char* Name() const override { return "qt"; }
+
+    bool Open() override
+    {
+        return screen_index >= 0;
+    }
+
+    void Close() override
+    {
+        image = QImage();
+    }
+
+    bool Grab(CaptureImageView& out_view) override
+    {
+        QList<QScreen*> screens = QGuiApplication::screens();
+        if(screen_index < 0 || screen_index >= screens.size() || !screens[screen_index])
+        {
+            return false;
+        }
+        QScreen* screen = screens[screen_index];
+        QRect geometry = screen->geometry();
+        image = screen->grabWindow(0, geometry.x(), geometry.y(), geometry.width(), geometry.height()).toImage();
+        if(image.isNull())
+        {
+            return false;
+        }
+
+        CapturePixelFormat format = CapturePixelFormat::RGBA8888;
+        switch(image.format())
+        {
+            case QImage::Format_RGB32:
+            case QImage::Format_ARGB32:
+            case QImage::Format_ARGB32_Premultiplied:
+                if(QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+                {
+                    format = CapturePixelFormat::BGRA8888;
+                    break;
+                }
+                image = image.convertToFormat(QImage::Format_RGBA8888);
+                break;
+            case QImage::Format_RGBA8888:
+            case QImage::Format_RGBX8888:
+            case QImage::Format_RGBA8888_Premultiplied:
+                break;
+            default:
+                image = image.convertToFormat(QImage::Format_RGBA8888);
+                break;
+        }
+
+        out_view.pixels = image.constBits();
+        out_view.width = image.width();
+        out_view.height = image.height();
+        out_view.stride_bytes = (int)image.bytesPerLine();
+        out_view.format = format;
+        return true;
+    }
+
+private:
+    int     screen_index;
+    QImage  image;
+};
+
+} // namespace
+
+std::unique_ptr<ScreenCaptureBackend> CreateX11CaptureBackend(int x, int y, int width, int height)
+{
+#ifdef SPATIAL_CAPTURE_XSHM
+    // XWayland exposes an X root window but not the compositor's output.
+    const char* session_type = std::getenv("XDG_SESSION_TYPE");
+    if(session_type && std::strcmp(session_type, "wayland") == 0)
+    {
+        return nullptr;
+    }
+    return std::make_unique<X11CaptureBackend>(x, y, width, height);
+#else
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<ScreenCaptureBackend> CreateQtScreenCaptureBackend(int screen_index)
+{
+    return std::make_unique<QtScreenCaptureBackend>(screen_index);
+}
+
+#endif // _WIN32
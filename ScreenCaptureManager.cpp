@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-only
 
 #include "ScreenCaptureManager.h"
+#include "ScreenCaptureBackend.h"
 #include "PluginLog.h"
 #include <chrono>
 #include <algorithm>
@@ -21,6 +22,9 @@
     #pragma comment(lib, "d3d11.lib")
     #pragma comment(lib, "dxgi.lib")
     #pragma comment(lib, "d3dcompiler.lib")
+#else
+    #include <cstdio>
+    #include <cstdlib>
 #endif
 
 ScreenCaptureManager& ScreenCaptureManager::Instance()
@@ -36,7 +40,10 @@ ScreenCaptureManager::ScreenCaptureManager()
     , target_height(270)
     , target_fps(30)
     , windows_capture_backend_mode(1)
-    , render_tick_snapshot_active(false)
+    , mip_pyramid_requested_ms(0)
+    , source_slots(new SourceSlot[kMaxCaptureSources])
+    , source_slot_count(0)
+    , render_tick_frames(kMaxCaptureSources)
 {
 }
 
@@ -105,11 +112,11 @@ void ScreenCaptureManager::Shutdown()
         sources.clear();
     }
 
+    // Capture threads are joined, so this thread may act as every slot's writer.
+    const int slot_count = source_slot_count.load();
+    for(int handle = 0; handle < slot_count; handle++)
     {
-        std::lock_guard<std::mutex> lock(frames_mutex);
-        latest_frames.clear();
-        render_tick_snapshot.clear();
-        render_tick_snapshot_active = false;
+        PublishFrame(handle, nullptr);
     }
 
     initialized.store(false);
@@ -247,38 +254,109 @@ bool ScreenCaptureManager::IsCapturing(const std::string& source_id) const
     return (it != capture_active.end() && it->second.load());
 }
 
+/** Depth of Begin/EndRenderTickSnapshot on this thread; the snapshot is only served while > 0. */
+static thread_local int render_tick_depth = 0;
+
+CaptureSourceHandle ScreenCaptureManager::GetSourceHandle(const std::string& source_id)
+{
+    std::lock_guard<std::mutex> lock(handles_mutex);
+    std::map<std::string, CaptureSourceHandle>::const_iterator it = source_handles.find(source_id);
+    if(it != source_handles.end())
+    {
+        return it->second;
+    }
+
+    const int handle = source_slot_count.load();
+    if(handle >= kMaxCaptureSources)
+    {
+        LOG_WARNING("[ScreenCapture] Too many capture sources, not registering '%s'", source_id.c_str());
+        return kInvalidCaptureSourceHandle;
+    }
+    source_handles[source_id] = handle;
+    // Release: a render tick that sees the new count sees the constructed slot.
+    source_slot_count.store(handle + 1, std::memory_order_release);
+    return handle;
+}
+
+CaptureSourceHandle ScreenCaptureManager::FindSourceHandle(const std::string& source_id) const
+{
+    std::lock_guard<std::mutex> lock(handles_mutex);
+    std::map<std::string, CaptureSourceHandle>::const_iterator it = source_handles.find(source_id);
+    return (it != source_handles.end()) ? it->second : kInvalidCaptureSourceHandle;
+}
+
 std::shared_ptr<CapturedFrame> ScreenCaptureManager::GetLatestFrame(const std::string& source_id) const
 {
-    std::lock_guard<std::mutex> lock(frames_mutex);
-    if(render_tick_snapshot_active)
+    return GetLatestFrame(FindSourceHandle(source_id));
+}
+
+std::shared_ptr<CapturedFrame> ScreenCaptureManager::GetLatestFrame(CaptureSourceHandle handle) const
+{
+    if(handle < 0 || handle >= source_slot_count.load(std::memory_order_acquire))
     {
-        std::map<std::string, std::shared_ptr<CapturedFrame>>::const_iterator snap_it =
-            render_tick_snapshot.find(source_id);
-        if(snap_it != render_tick_snapshot.end())
-        {
-            return snap_it->second;
-        }
+        return nullptr;
     }
-    std::map<std::string, std::shared_ptr<CapturedFrame>>::const_iterator it = latest_frames.find(source_id);
-    if(it != latest_frames.end())
+    if(render_tick_depth > 0)
     {
-        return it->second;
+        return render_tick_frames[(size_t)handle];
     }
-    return nullptr;
+    const SourceSlot& slot = source_slots[handle];
+    std::lock_guard<std::mutex> lock(slot.latest_mutex);
+    return slot.latest;
+}
+
+void ScreenCaptureManager::PublishFrame(CaptureSourceHandle handle, std::shared_ptr<CapturedFrame> frame)
+{
+    if(handle < 0 || handle >= source_slot_count.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    SourceSlot& slot = source_slots[handle];
+    {
+        std::lock_guard<std::mutex> lock(slot.latest_mutex);
+        slot.latest = frame;
+    }
+
+    slot.buffers[slot.back_index] = std::move(frame);
+    const uint32_t previous = slot.middle_state.exchange(slot.back_index | SourceSlot::kFreshBit,
+                                                         std::memory_order_acq_rel);
+    slot.back_index = previous & SourceSlot::kIndexMask;
+    // Whatever the tick never picked up (or handed back) is ours again; let the ring reuse it.
+    slot.buffers[slot.back_index].reset();
 }
 
 void ScreenCaptureManager::BeginRenderTickSnapshot()
 {
-    std::lock_guard<std::mutex> lock(frames_mutex);
-    render_tick_snapshot = latest_frames;
-    render_tick_snapshot_active = true;
+    if(render_tick_depth++ > 0)
+    {
+        return;
+    }
+
+    const int slot_count = source_slot_count.load(std::memory_order_acquire);
+    for(int handle = 0; handle < slot_count; handle++)
+    {
+        SourceSlot& slot = source_slots[handle];
+        if(slot.middle_state.load(std::memory_order_relaxed) & SourceSlot::kFreshBit)
+        {
+            const uint32_t previous = slot.middle_state.exchange(slot.front_index, std::memory_order_acq_rel);
+            slot.front_index = previous & SourceSlot::kIndexMask;
+        }
+        render_tick_frames[(size_t)handle] = slot.buffers[slot.front_index];
+    }
 }
 
 void ScreenCaptureManager::EndRenderTickSnapshot()
 {
-    std::lock_guard<std::mutex> lock(frames_mutex);
-    render_tick_snapshot_active = false;
-    render_tick_snapshot.clear();
+    if(render_tick_depth <= 0 || --render_tick_depth > 0)
+    {
+        return;
+    }
+
+    const int slot_count = source_slot_count.load(std::memory_order_acquire);
+    for(int handle = 0; handle < slot_count; handle++)
+    {
+        render_tick_frames[(size_t)handle].reset();
+    }
 }
 
 void ScreenCaptureManager::SetDownscaleResolution(int width, int height)
@@ -287,6 +365,23 @@ void ScreenCaptureManager::SetDownscaleResolution(int width, int height)
     target_height.store((std::max)(32, (std::min)(height, 2160)));
 }
 
+static int64_t SteadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ScreenCaptureManager::RequestMipPyramid()
+{
+    mip_pyramid_requested_ms.store(SteadyNowMs(), std::memory_order_relaxed);
+}
+
+bool ScreenCaptureManager::IsMipPyramidRequested() const
+{
+    const int64_t requested = mip_pyramid_requested_ms.load(std::memory_order_relaxed);
+    return requested != 0 && SteadyNowMs() - requested < 2000;
+}
+
 void ScreenCaptureManager::SetTargetFPS(int fps)
 {
     target_fps.store((std::max)(1, (std::min)(fps, 120)));
@@ -997,6 +1092,7 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
         }
         active_flag = &(active_it->second);
     }
+    const CaptureSourceHandle source_handle = GetSourceHandle(source_id);
 
     size_t underscore_pos = source_id.find('_');
     if(underscore_pos == std::string::npos)
@@ -1047,6 +1143,10 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
 
     uint64_t frame_counter = 0;
     std::vector<uint8_t> dxgi_rgba_buffer;
+    AreaDownscalePlan dxgi_downscale;
+    AreaDownscalePlan frame_downscale;
+    CaptureMipChainBuilder frame_mips;
+    CapturedFrameRing frame_ring;
     std::chrono::steady_clock::time_point thread_start_tp = std::chrono::steady_clock::now();
     std::chrono::steady_clock::time_point last_dxgi_retry = thread_start_tp;
     std::chrono::steady_clock::time_point last_gdi_force = thread_start_tp;
@@ -1232,7 +1332,7 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
                             dxgi_state.context->Unmap(dxgi_state.staging_texture, 0);
                             image = QImage(out_dst, out_w, out_h, out_w * 4, QImage::Format_RGBA8888).copy();
                         }
-                        else if(src_is_bgra)
+                        else
                         {
                             const int out_w = needs_downscale ? target_w : (int)dxgi_state.width;
                             const int out_h = needs_downscale ? target_h : (int)dxgi_state.height;
@@ -1242,45 +1342,17 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
                                 dxgi_rgba_buffer.resize(out_need);
                             }
 
-                            // One pass: BGRA→RGBA + optional nearest downscale (avoids QImage convertToFormat).
-                            for(int y = 0; y < out_h; y++)
-                            {
-                                const UINT src_y = needs_downscale
-                                    ? (UINT)(((uint64_t)y * dxgi_state.height) / (uint64_t)out_h)
-                                    : (UINT)y;
-                                const uint8_t* row_base = src + (size_t)src_y * mapped.RowPitch;
-                                uint8_t* row_dst = dxgi_rgba_buffer.data() + (size_t)y * out_w * 4;
-                                for(int x = 0; x < out_w; x++)
-                                {
-                                    const UINT src_x = needs_downscale
-                                        ? (UINT)(((uint64_t)x * dxgi_state.width) / (uint64_t)out_w)
-                                        : (UINT)x;
-                                    const uint8_t* px = row_base + (size_t)src_x * 4;
-                                    row_dst[0] = px[2];
-                                    row_dst[1] = px[1];
-                                    row_dst[2] = px[0];
-                                    row_dst[3] = px[3];
-                                    row_dst += 4;
-                                }
-                            }
-                            dxgi_state.context->Unmap(dxgi_state.staging_texture, 0);
-                            image = QImage(dxgi_rgba_buffer.data(), out_w, out_h, out_w * 4,
-                                           QImage::Format_RGBA8888).copy();
-                        }
-                        else
-                        {
-                            QImage wrap((const uchar*)src, (int)dxgi_state.width, (int)dxgi_state.height,
-                                        (int)mapped.RowPitch, QImage::Format_RGBA8888);
-                            if(needs_downscale)
-                            {
-                                image = wrap.scaled(target_w, target_h, Qt::IgnoreAspectRatio, Qt::FastTransformation)
-                                            .convertToFormat(QImage::Format_RGBA8888);
-                            }
-                            else
-                            {
-                                image = wrap.copy();
-                            }
+                            // One pass: area-average downscale + swap to RGBA (avoids QImage scaled/convertToFormat).
+                            CaptureImageView staging_view;
+                            staging_view.pixels = src;
+                            staging_view.width = (int)dxgi_state.width;
+                            staging_view.height = (int)dxgi_state.height;
+                            staging_view.stride_bytes = (int)mapped.RowPitch;
+                            staging_view.format = src_is_bgra ? CapturePixelFormat::BGRA8888 : CapturePixelFormat::RGBA8888;
+                            dxgi_downscale.Run(staging_view, out_w, out_h, dxgi_rgba_buffer.data());
                             dxgi_state.context->Unmap(dxgi_state.staging_texture, 0);
+                            // Wraps the thread's buffer; consumed below before the next Map().
+                            image = QImage(dxgi_rgba_buffer.data(), out_w, out_h, out_w * 4, QImage::Format_RGBA8888);
                         }
                     }
                     if(dxgi_state.desktop_frame_acquired)
@@ -1399,44 +1471,30 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
             }
         }
 
-        int target_w = target_width.load();
-        int target_h = target_height.load();
-        if(image.width() != target_w || image.height() != target_h)
-        {
-            image = image.scaled(target_w, target_h, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-        }
+        const int target_w = target_width.load();
+        const int target_h = target_height.load();
         if(image.format() != QImage::Format_RGBA8888)
         {
             image = image.convertToFormat(QImage::Format_RGBA8888);
         }
 
+        // Scale (area average) and the DXGI vertical flip in one pass into a reused ring frame.
+        CaptureImageView image_view;
+        image_view.pixels = image.constBits();
+        image_view.width = image.width();
+        image_view.height = image.height();
+        image_view.stride_bytes = (int)image.bytesPerLine();
+        image_view.format = CapturePixelFormat::RGBA8888;
         if(!frame_from_gdi)
         {
-            image = image.mirrored(false, true);
+            image_view.pixels += (size_t)(image_view.height - 1) * (size_t)image_view.stride_bytes;
+            image_view.stride_bytes = -image_view.stride_bytes;
         }
 
-        std::shared_ptr<CapturedFrame> frame = std::make_shared<CapturedFrame>();
+        std::shared_ptr<CapturedFrame> frame = frame_ring.Acquire(target_w, target_h);
         frame->used_gdi_capture = frame_from_gdi;
-        frame->width = image.width();
-        frame->height = image.height();
-        frame->data.resize(frame->width * frame->height * 4);
-        const int line_bytes = frame->width * 4;
-        const int src_stride = image.bytesPerLine();
-        const uint8_t* src = image.constBits();
-        uint8_t* dst = frame->data.data();
-        if(src_stride == line_bytes)
-        {
-            memcpy(dst, src, (size_t)line_bytes * (size_t)frame->height);
-        }
-        else
-        {
-            for(int y = 0; y < frame->height; y++)
-            {
-                memcpy(dst, src, (size_t)line_bytes);
-                dst += line_bytes;
-                src += src_stride;
-            }
-        }
+        frame_downscale.Run(image_view, target_w, target_h, frame->data.data());
+        image = QImage();
 
         thread_local std::vector<uint8_t> capture_blend_prev;
         thread_local bool blend_backend_known = false;
@@ -1463,15 +1521,21 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
         blend_last_was_gdi = frame_from_gdi;
         blend_backend_known = true;
 
+        if(IsMipPyramidRequested())
+        {
+            frame_mips.Build(frame->data.data(), frame->width, frame->height, frame->mip_data, frame->mips);
+        }
+        else
+        {
+            frame->mips.clear();
+        }
+
         frame->frame_id = frame_counter++;
         frame->timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
         frame->valid = true;
 
-        {
-            std::lock_guard<std::mutex> lock(frames_mutex);
-            latest_frames[source_id] = frame;
-        }
+        PublishFrame(source_handle, frame);
 
         last_frame_produced = std::chrono::steady_clock::now();
         if(frame_counter == 1)
@@ -1506,6 +1570,95 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
 
 #else
 
+/*---------------------------------------------------------*\
+| Test sources, enumerated only when the variable is set:   |
+|   OPENRGB_SPATIAL_CAPTURE_SYNTHETIC=<w>x<h>  -> synthetic_0 |
+|   OPENRGB_SPATIAL_CAPTURE_FILE=<image.ppm>   -> file_0      |
+\*---------------------------------------------------------*/
+static const char* const kSyntheticSourceEnv = "OPENRGB_SPATIAL_CAPTURE_SYNTHETIC";
+static const char* const kFileSourceEnv = "OPENRGB_SPATIAL_CAPTURE_FILE";
+
+static bool GetSyntheticSourceSize(int& width, int& height)
+{
+    const char* value = std::getenv(kSyntheticSourceEnv);
+    if(!value || !*value)
+    {
+        return false;
+    }
+    width = 1920;
+    height = 1080;
+    int w = 0;
+    int h = 0;
+    if(std::sscanf(value, "%dx%d", &w, &h) == 2 && w > 0 && h > 0)
+    {
+        width = w;
+        height = h;
+    }
+    return true;
+}
+
+static bool IsScreenSourceId(const std::string& source_id)
+{
+    return source_id.compare(0, 7, "screen_") == 0;
+}
+
+/** Picks the backend for a source id; screens prefer X11 (MIT-SHM) and fall back to QScreen::grabWindow. */
+static std::unique_ptr<CaptureFramePipeline> OpenLinuxCapturePipeline(const std::string& source_id, int screen_index)
+{
+    std::unique_ptr<CaptureFramePipeline> pipeline;
+
+    if(source_id.compare(0, 10, "synthetic_") == 0)
+    {
+        int width = 0;
+        int height = 0;
+        if(!GetSyntheticSourceSize(width, height))
+        {
+            return nullptr;
+        }
+        pipeline = std::make_unique<CaptureFramePipeline>(CreateSyntheticCaptureBackend(width, height));
+    }
+    else if(source_id.compare(0, 5, "file_") == 0)
+    {
+        const char* path = std::getenv(kFileSourceEnv);
+        if(!path || !*path)
+        {
+            return nullptr;
+        }
+        pipeline = std::make_unique<CaptureFramePipeline>(CreateFileCaptureBackend(path));
+    }
+    else
+    {
+        QList<QScreen*> screens = QGuiApplication::screens();
+        if(screen_index < 0 || screen_index >= screens.size() || !screens[screen_index])
+        {
+            return nullptr;
+        }
+
+        // X11 root coordinates are device pixels; Qt geometry is in device-independent pixels.
+        QScreen* screen = screens[screen_index];
+        const QRect geometry = screen->geometry();
+        const qreal dpr = screen->devicePixelRatio();
+        std::unique_ptr<ScreenCaptureBackend> x11 = CreateX11CaptureBackend(
+            (int)(geometry.x() * dpr), (int)(geometry.y() * dpr),
+            (int)(geometry.width() * dpr), (int)(geometry.height() * dpr));
+        if(x11)
+        {
+            pipeline = std::make_unique<CaptureFramePipeline>(std::move(x11));
+            if(pipeline->Open())
+            {
+                return pipeline;
+            }
+        }
+        pipeline = std::make_unique<CaptureFramePipeline>(CreateQtScreenCaptureBackend(screen_index));
+    }
+
+    if(!pipeline->Open())
+    {
+        return nullptr;
+    }
+    return pipeline;
+}
+
 bool ScreenCaptureManager::InitializePlatform()
 {
     return true;
@@ -1537,16 +1690,59 @@ void ScreenCaptureManager::EnumerateSourcesPlatform()
 
         sources[info.id] = info;
     }
+
+    int synthetic_width = 0;
+    int synthetic_height = 0;
+    if(GetSyntheticSourceSize(synthetic_width, synthetic_height))
+    {
+        CaptureSourceInfo info;
+        info.id = "synthetic_0";
+        info.name = "Synthetic Test Pattern";
+        info.width = synthetic_width;
+        info.height = synthetic_height;
+        info.x = 0;
+        info.y = 0;
+        info.is_primary = false;
+        info.is_available = true;
+        sources[info.id] = info;
+    }
+
+    const char* file_path = std::getenv(kFileSourceEnv);
+    if(file_path && *file_path)
+    {
+        std::unique_ptr<ScreenCaptureBackend> probe = CreateFileCaptureBackend(file_path);
+        CaptureImageView view;
+        const bool loaded = probe->Open() && probe->Grab(view);
+
+        CaptureSourceInfo info;
+        info.id = "file_0";
+        info.name = std::string("File: ") + file_path;
+        info.width = loaded ? view.width : 0;
+        info.height = loaded ? view.height : 0;
+        info.x = 0;
+        info.y = 0;
+        info.is_primary = false;
+        info.is_available = loaded;
+        sources[info.id] = info;
+        probe->Close();
+    }
 }
 
 bool ScreenCaptureManager::StartCapturePlatform(const std::string& source_id)
 {
-    size_t underscore_pos = source_id.find('_');
-    if(underscore_pos == std::string::npos)
+    if(!IsScreenSourceId(source_id))
     {
-        LOG_WARNING("[ScreenCapture] Invalid source_id format in StartCapturePlatform: '%s'", source_id.c_str());
-        return false;
+        std::lock_guard<std::mutex> lock(sources_mutex);
+        std::map<std::string, CaptureSourceInfo>::const_iterator it = sources.find(source_id);
+        if(it == sources.end() || !it->second.is_available)
+        {
+            LOG_WARNING("[ScreenCapture] Unknown capture source '%s'", source_id.c_str());
+            return false;
+        }
+        return true;
     }
+
+    size_t underscore_pos = source_id.find('_');
     int screen_index = -1;
     try
     {
@@ -1570,16 +1766,6 @@ void ScreenCaptureManager::StopCapturePlatform(const std::string& /*source_id*/)
 {
 }
 
-static QImage GrabScreenLinux(QScreen* screen)
-{
-    if(!screen)
-    {
-        return QImage();
-    }
-    QRect geometry = screen->geometry();
-    return screen->grabWindow(0, geometry.x(), geometry.y(), geometry.width(), geometry.height()).toImage();
-}
-
 void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
 {
     std::atomic<bool>* active_flag = nullptr;
@@ -1593,93 +1779,69 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
         }
         active_flag = &(active_it->second);
     }
+    const CaptureSourceHandle source_handle = GetSourceHandle(source_id);
 
-    size_t underscore_pos = source_id.find('_');
-    if(underscore_pos == std::string::npos)
+    int screen_index = -1;
+    if(IsScreenSourceId(source_id))
     {
-        LOG_WARNING("[ScreenCapture] Invalid source_id format: '%s'", source_id.c_str());
-        return;
+        try
+        {
+            screen_index = std::stoi(source_id.substr(7));
+        }
+        catch(...)
+        {
+            LOG_WARNING("[ScreenCapture] Invalid source_id format: '%s'", source_id.c_str());
+            return;
+        }
     }
-    int screen_index = std::stoi(source_id.substr(underscore_pos + 1));
+
+    // Grabs failing this many ticks in a row (mode change, display reset) reopen the backend.
+    const int reopen_after_failed_grabs = 30;
 
     uint64_t frame_counter = 0;
     const int target_frame_time_ms = 1000 / target_fps.load();
-    bool logged_screen_unavailable = false;
+    bool logged_source_unavailable = false;
+    int failed_grabs = 0;
+    std::unique_ptr<CaptureFramePipeline> pipeline;
 
     while(active_flag->load())
     {
         std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
 
-        QList<QScreen*> screens = QGuiApplication::screens();
-        QScreen* screen = nullptr;
-        if(screen_index >= 0 && screen_index < screens.size())
+        if(!pipeline)
         {
-            screen = screens[screen_index];
-        }
-
-        if(!screen)
-        {
-            if(!logged_screen_unavailable)
+            pipeline = OpenLinuxCapturePipeline(source_id, screen_index);
+            if(!pipeline)
             {
-                LOG_WARNING("[ScreenCapture] Screen %d unavailable, waiting for it to return", screen_index);
-                logged_screen_unavailable = true;
+                if(!logged_source_unavailable)
+                {
+                    LOG_WARNING("[ScreenCapture] Source '%s' unavailable, waiting for it to return", source_id.c_str());
+                    logged_source_unavailable = true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
-        }
-        if(logged_screen_unavailable)
-        {
-            logged_screen_unavailable = false;
-        }
-
-        QImage image = GrabScreenLinux(screen);
-        if(image.isNull())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+            logged_source_unavailable = false;
+            failed_grabs = 0;
+            LOG_INFO("[ScreenCapture] Capturing '%s' with the %s backend", source_id.c_str(), pipeline->GetBackendName());
         }
 
-        int target_w = target_width.load();
-        int target_h = target_height.load();
-        if(image.width() != target_w || image.height() != target_h)
-        {
-            image = image.scaled(target_w, target_h, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-        }
-        if(image.format() != QImage::Format_RGBA8888)
-        {
-            image = image.convertToFormat(QImage::Format_RGBA8888);
-        }
-
-        std::shared_ptr<CapturedFrame> frame = std::make_shared<CapturedFrame>();
-        frame->width = image.width();
-        frame->height = image.height();
-        frame->data.resize(frame->width * frame->height * 4);
-        const int line_bytes = frame->width * 4;
-        const int src_stride = image.bytesPerLine();
-        const uint8_t* src = image.constBits();
-        uint8_t* dst = frame->data.data();
-        if(src_stride == line_bytes)
-        {
-            memcpy(dst, src, (size_t)line_bytes * (size_t)frame->height);
-        }
-        else
+        std::shared_ptr<CapturedFrame> frame = pipeline->Capture(target_width.load(), target_height.load(), frame_counter,
+                                                                     IsMipPyramidRequested());
+        if(!frame)
         {
-            for(int y = 0; y < frame->height; y++)
+            if(++failed_grabs >= reopen_after_failed_grabs)
             {
-                memcpy(dst, src, (size_t)line_bytes);
-                dst += line_bytes;
-                src += src_stride;
+                pipeline.reset();
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
         }
-        frame->frame_id = frame_counter++;
-        frame->timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        frame->valid = true;
+        failed_grabs = 0;
+        frame_counter++;
 
-        {
-            std::lock_guard<std::mutex> lock(frames_mutex);
-            latest_frames[source_id] = frame;
-        }
+        PublishFrame(source_handle, frame);
+        frame.reset();
 
         std::chrono::steady_clock::time_point frame_end = std::chrono::steady_clock::now();
         int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(frame_end - frame_start).count();
@@ -1693,6 +1855,9 @@ void ScreenCaptureManager::CaptureThreadFunction(const std::string& source_id)
             std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
         }
     }
+
+    LOG_INFO("[ScreenCapture] Capture thread stopped for '%s' (produced %llu frames)",
+             source_id.c_str(), (unsigned long long)frame_counter);
 }
 
 #endif
@@ -12,6 +12,12 @@
 #include <thread>
 #include <cstdint>
 
+#include "CaptureDownscale.h"
+
+/** Index of a registered capture source; stable for the lifetime of the process. */
+using CaptureSourceHandle = int;
+static constexpr CaptureSourceHandle kInvalidCaptureSourceHandle = -1;
+
 struct CaptureSourceInfo
 {
     std::string     id;
@@ -33,6 +39,9 @@ struct CapturedFrame
     uint64_t                timestamp_ms;
     bool                    valid;
     bool                    used_gdi_capture;
+    /** Box-filtered levels below data (level 0), packed in mip_data; empty unless RequestMipPyramid() is live. */
+    std::vector<uint8_t>            mip_data;
+    std::vector<CaptureMipLevel>    mips;
 
     CapturedFrame()
         : width(0), height(0), frame_id(0), timestamp_ms(0), valid(false), used_gdi_capture(false)
@@ -53,6 +62,16 @@ public:
     bool IsCapturing(const std::string& source_id) const;
     std::shared_ptr<CapturedFrame> GetLatestFrame(const std::string& source_id) const;
 
+    /** Registers source_id on first use; kInvalidCaptureSourceHandle once kMaxCaptureSources ids exist. */
+    CaptureSourceHandle GetSourceHandle(const std::string& source_id);
+    /** Inside a render tick on the ticking thread: the tick's snapshot, lock-free. Elsewhere: the newest published frame. */
+    std::shared_ptr<CapturedFrame> GetLatestFrame(CaptureSourceHandle handle) const;
+
+    /**
+     * Pins the newest frame of every source for the calling thread until the matching End.
+     * Nested pairs reuse the outer snapshot. Ticks must be serialized by the caller
+     * (SpatialEffect3D::RenderStateMutex()); takes no lock and hashes no ids.
+     */
     void BeginRenderTickSnapshot();
     void EndRenderTickSnapshot();
     void SetDownscaleResolution(int width, int height);
@@ -61,6 +80,9 @@ public:
         width = target_width;
         height = target_height;
     }
+    /** Readers call this every tick they want CapturedFrame::mips; capture threads stop building them a couple of seconds after the last call. */
+    void RequestMipPyramid();
+    bool IsMipPyramidRequested() const;
     void SetTargetFPS(int fps);
     int GetTargetFPS() const { return target_fps; }
 
@@ -72,6 +94,28 @@ public:
     bool IsCaptureSessionActive() const { return capture_session_active.load(); }
 
 private:
+    static constexpr int kMaxCaptureSources = 64;
+
+    /**
+     * Per-source triple buffer. The capture thread fills buffers[back_index] and swaps it into
+     * middle_state; the render tick swaps its front_index out when the fresh bit is set. Each
+     * side only touches the buffer it owns, so neither waits on the other. GUI readers outside
+     * a tick use latest under latest_mutex, which only the owning capture thread also takes.
+     */
+    struct SourceSlot
+    {
+        static constexpr uint32_t kIndexMask = 0x3u;
+        static constexpr uint32_t kFreshBit = 0x4u;
+
+        std::shared_ptr<CapturedFrame>  buffers[3];
+        std::atomic<uint32_t>           middle_state{2u};
+        uint32_t                        back_index = 1u;
+        uint32_t                        front_index = 0u;
+
+        mutable std::mutex              latest_mutex;
+        std::shared_ptr<CapturedFrame>  latest;
+    };
+
     ScreenCaptureManager();
     ~ScreenCaptureManager();
 
@@ -84,20 +128,26 @@ private:
     bool StartCapturePlatform(const std::string& source_id);
     void StopCapturePlatform(const std::string& source_id);
     void CaptureThreadFunction(const std::string& source_id);
+    CaptureSourceHandle FindSourceHandle(const std::string& source_id) const;
+    /** Capture-thread side of the slot; nullptr clears the source. */
+    void PublishFrame(CaptureSourceHandle handle, std::shared_ptr<CapturedFrame> frame);
     std::atomic<bool>                       initialized;
     std::atomic<bool>                       capture_session_active;
     std::atomic<int>                        target_width;
     std::atomic<int>                        target_height;
     std::atomic<int>                        target_fps;
     std::atomic<int>                        windows_capture_backend_mode;
+    std::atomic<int64_t>                    mip_pyramid_requested_ms;
 
     mutable std::mutex                      sources_mutex;
     std::map<std::string, CaptureSourceInfo> sources;
 
-    mutable std::mutex                      frames_mutex;
-    std::map<std::string, std::shared_ptr<CapturedFrame>> latest_frames;
-    mutable bool                            render_tick_snapshot_active;
-    mutable std::map<std::string, std::shared_ptr<CapturedFrame>> render_tick_snapshot;
+    mutable std::mutex                      handles_mutex;
+    std::map<std::string, CaptureSourceHandle> source_handles;
+    std::unique_ptr<SourceSlot[]>           source_slots;
+    std::atomic<int>                        source_slot_count;
+    /** Written by the outermost BeginRenderTickSnapshot, read on the ticking thread only. */
+    std::vector<std::shared_ptr<CapturedFrame>> render_tick_frames;
 
     mutable std::mutex                      threads_mutex;
     std::map<std::string, std::thread>      capture_threads;
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-only
+#pragma once
+
+#include <QImage>
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * GLSL builtins for CPU ports of volumeMain / stripMain (setCpuField on the field
+ * engines). Each helper follows the GLSL definition, so a port can be read line for
+ * line against its shader and bakes the same atlas.
+ */
+namespace SpatialFieldCpuMath
+{
+
+struct Vec3
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    Vec3() = default;
+    constexpr Vec3(float v) : x(v), y(v), z(v) {}
+    constexpr Vec3(float vx, float vy, float vz) : x(vx), y(vy), z(vz) {}
+};
+
+inline Vec3 operator+(Vec3 a, Vec3 b) { return Vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Vec3 operator-(Vec3 a, Vec3 b) { return Vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Vec3 operator*(Vec3 a, Vec3 b) { return Vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline Vec3 operator/(Vec3 a, Vec3 b) { return Vec3(a.x / b.x, a.y / b.y, a.z / b.z); }
+inline Vec3 operator-(Vec3 a) { return Vec3(-a.x, -a.y, -a.z); }
+
+inline float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Length(Vec3 a) { return std::sqrt(Dot(a, a)); }
+inline Vec3 Cross(Vec3 a, Vec3 b) { return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+
+/** normalize(); zero vectors stay zero instead of turning into NaN. */
+inline Vec3 Normalize(Vec3 a)
+{
+    const float len = Length(a);
+    return len > 0.0f ? a / Vec3(len) : Vec3(0.0f);
+}
+
+inline float Fract(float x) { return x - std::floor(x); }
+/** GLSL mod(): result takes the sign of y, unlike std::fmod. */
+inline float Mod(float x, float y) { return x - y * std::floor(x / y); }
+inline float Mix(float a, float b, float t) { return a + (b - a) * t; }
+inline Vec3 Mix(Vec3 a, Vec3 b, float t) { return a + (b - a) * Vec3(t); }
+inline float Clamp01(float x) { return std::clamp(x, 0.0f, 1.0f); }
+inline Vec3 Clamp01(Vec3 a) { return Vec3(Clamp01(a.x), Clamp01(a.y), Clamp01(a.z)); }
+inline float Step(float edge, float x) { return x < edge ? 0.0f : 1.0f; }
+
+inline float Smoothstep(float edge0, float edge1, float x)
+{
+    const float t = Clamp01((x - edge0) / (edge1 - edge0));
+    return t * t * (3.0f - 2.0f * t);
+}
+
+/**
+ * texture(u_media, uv) as the volume engine binds it: GL_LINEAR with GL_REPEAT when
+ * wrap is set, else GL_CLAMP_TO_EDGE; a null image samples opaque black like the 1x1
+ * placeholder texture. media must be Format_RGBA8888 (CpuBakeContext::media).
+ */
+inline void SampleMedia(const QImage* media, bool wrap, float u, float v, float* rgba)
+{
+    rgba[0] = rgba[1] = rgba[2] = 0.0f;
+    rgba[3] = 1.0f;
+    if(!media || media->isNull() || !std::isfinite(u) || !std::isfinite(v))
+    {
+        return;
+    }
+
+    const int w = media->width();
+    const int h = media->height();
+    const float fx = u * (float)w - 0.5f;
+    const float fy = v * (float)h - 0.5f;
+    const float x0f = std::floor(fx);
+    const float y0f = std::floor(fy);
+    const float tx = fx - x0f;
+    const float ty = fy - y0f;
+
+    auto texel = [wrap](int i, int n) {
+        if(wrap)
+        {
+            i %= n;
+            return i < 0 ? i + n : i;
+        }
+        return std::clamp(i, 0, n - 1);
+    };
+    // Float texel origins can sit far outside int range for wild uv; GL wraps/clamps those too.
+    const float x_lim = (float)(w * 4);
+    const float y_lim = (float)(h * 4);
+    const int x0 = (int)std::clamp(wrap ? Mod(x0f, (float)w) : x0f, -x_lim, x_lim);
+    const int y0 = (int)std::clamp(wrap ? Mod(y0f, (float)h) : y0f, -y_lim, y_lim);
+    const int xs[2] = {texel(x0, w), texel(x0 + 1, w)};
+    const int ys[2] = {texel(y0, h), texel(y0 + 1, h)};
+    const float wx[2] = {1.0f - tx, tx};
+    const float wy[2] = {1.0f - ty, ty};
+
+    rgba[3] = 0.0f;
+    for(int j = 0; j < 2; j++)
+    {
+        const uchar* line = media->constScanLine(ys[j]);
+        for(int i = 0; i < 2; i++)
+        {
+            const uchar* px = line + (size_t)xs[i] * 4;
+            const float wgt = wx[i] * wy[j] * (1.0f / 255.0f);
+            rgba[0] += px[0] * wgt;
+            rgba[1] += px[1] * wgt;
+            rgba[2] += px[2] * wgt;
+            rgba[3] += px[3] * wgt;
+        }
+    }
+}
+
+} // namespace SpatialFieldCpuMath
@@ -3,6 +3,7 @@
 #include "SpatialStripFieldAssist.h"
 
 #include <algorithm>
+#include <utility>
 
 void SpatialStripFieldAssist::setWidth(int w)
 {
@@ -13,9 +14,22 @@ void SpatialStripFieldAssist::setWidth(int w)
     }
 }
 
+void SpatialStripFieldAssist::setCpuField(SpatialStripFieldEngine::CpuField field)
+{
+    cpu_field_ = std::move(field);
+    if(engine_)
+    {
+        engine_->setCpuField(cpu_field_);
+    }
+}
+
 void SpatialStripFieldAssist::applyEngineSize(SpatialStripFieldEngine& engine)
 {
     engine.setWidth(width_);
+    if(cpu_field_)
+    {
+        engine.setCpuField(cpu_field_);
+    }
 }
 
 float SpatialStripFieldAssist::sample01(float s01) const
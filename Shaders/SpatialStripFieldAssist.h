@@ -12,6 +12,9 @@ class SpatialStripFieldAssist : public SpatialFieldAssistBase<SpatialStripFieldE
 public:
     void setWidth(int w);
 
+    /** CPU port of the fragment body; keeps the effect on the strip when GL is unavailable. */
+    void setCpuField(SpatialStripFieldEngine::CpuField field);
+
     float sample01(float s01) const;
     float sampleKernelSigned(float s01) const;
 
@@ -19,4 +22,5 @@ private:
     void applyEngineSize(SpatialStripFieldEngine& engine) override;
 
     int width_ = 256;
+    SpatialStripFieldEngine::CpuField cpu_field_;
 };
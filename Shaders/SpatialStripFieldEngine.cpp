@@ -1,15 +1,19 @@
 // SPDX-License-Identifier: GPL-2.0-only
 
 #include "SpatialStripFieldEngine.h"
+#include "PluginLog.h"
 
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
+#include <QThread>
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <utility>
 
 namespace
 {
@@ -39,6 +43,16 @@ QString BuildStripFragmentShader(const QString& user_body)
                "}\n");
 }
 
+/** Same switch SpatialVolumeFieldEngine reads. */
+bool CpuFieldsForced()
+{
+    static const bool forced = [] {
+        const char* value = std::getenv("OPENRGB_SPATIAL_CPU_FIELDS");
+        return value && value[0] != '\0' && value[0] != '0';
+    }();
+    return forced;
+}
+
 } // namespace
 
 SpatialStripFieldEngine::SpatialStripFieldEngine() = default;
@@ -46,7 +60,14 @@ SpatialStripFieldEngine::SpatialStripFieldEngine() = default;
 SpatialStripFieldEngine::~SpatialStripFieldEngine()
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    shutdownGl();
+    if(claimGlContext())
+    {
+        shutdownGl();
+    }
+    else
+    {
+        abandonGl();
+    }
 }
 
 void SpatialStripFieldEngine::shutdownGl()
@@ -69,6 +90,39 @@ void SpatialStripFieldEngine::shutdownGl()
     gl_ok_ = false;
 }
 
+bool SpatialStripFieldEngine::claimGlContext()
+{
+    if(!context_ || context_->thread() == QThread::currentThread())
+    {
+        return true;
+    }
+    context_->moveToThread(QThread::currentThread());
+    return context_->thread() == QThread::currentThread();
+}
+
+void SpatialStripFieldEngine::parkGlContext()
+{
+    if(!context_)
+    {
+        return;
+    }
+    if(QOpenGLContext::currentContext() == context_.get())
+    {
+        context_->doneCurrent();
+    }
+    context_->moveToThread(nullptr);
+}
+
+void SpatialStripFieldEngine::abandonGl()
+{
+    fbo_.reset();
+    program_.reset();
+    context_.reset();
+    surface_.reset();
+    fbo_w_ = 0;
+    gl_ok_ = false;
+}
+
 void SpatialStripFieldEngine::setFragmentBody(const QString& glsl_body)
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -121,6 +175,19 @@ void SpatialStripFieldEngine::setParams(const Params& params)
     params_dirty_ = true;
 }
 
+void SpatialStripFieldEngine::setCpuField(CpuField field)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    cpu_field_ = std::move(field);
+    params_dirty_ = true;
+}
+
+bool SpatialStripFieldEngine::usingCpuField() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cpu_mode_;
+}
+
 QString SpatialStripFieldEngine::lastError() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -134,7 +201,13 @@ bool SpatialStripFieldEngine::ensureReady()
     {
         return available_.load();
     }
-    return renderStrip();
+    if(!claimGlContext())
+    {
+        abandonGl();
+    }
+    const bool ready = renderStrip();
+    parkGlContext();
+    return ready;
 }
 
 bool SpatialStripFieldEngine::initGl()
@@ -240,18 +313,20 @@ bool SpatialStripFieldEngine::renderStrip()
         return false;
     }
 
-    if(!initGl())
+    if(cpu_mode_)
     {
-        available_.store(false);
-        return false;
+        return fillCpuStrip();
+    }
+    if((cpu_field_ && CpuFieldsForced()) || !initGl())
+    {
+        return failOverToCpu();
     }
 
     if(body_dirty_ || !program_)
     {
         if(!compileProgram(fragment_body_))
         {
-            available_.store(false);
-            return false;
+            return failOverToCpu();
         }
         body_dirty_ = false;
     }
@@ -306,6 +381,43 @@ bool SpatialStripFieldEngine::renderStrip()
     return true;
 }
 
+bool SpatialStripFieldEngine::failOverToCpu()
+{
+    if(!cpu_field_)
+    {
+        available_.store(false);
+        return false;
+    }
+    LOG_WARNING("[OpenRGB3DSpatialPlugin] Strip field falling back to CPU fill: %s",
+                last_error_.isEmpty() ? "forced by OPENRGB_SPATIAL_CPU_FIELDS" : qUtf8Printable(last_error_));
+    shutdownGl();
+    cpu_mode_ = true;
+    return fillCpuStrip();
+}
+
+bool SpatialStripFieldEngine::fillCpuStrip()
+{
+    CpuBakeContext ctx;
+    ctx.time_sec = params_.time_sec;
+    ctx.params = params_.values;
+    ctx.width = width_;
+    strip_r_.assign((size_t)width_, 0.0f);
+    cpu_field_(ctx, strip_r_.data());
+    for(float& r : strip_r_)
+    {
+        // The GL target clamps on write; keep sample01 seeing the same range.
+        r = std::clamp(r, 0.0f, 1.0f);
+    }
+    strip_w_ = width_;
+
+    body_dirty_ = false;
+    params_dirty_ = false;
+    size_dirty_ = false;
+    last_error_.clear();
+    available_.store(strip_w_ > 0);
+    return available_.load();
+}
+
 void SpatialStripFieldEngine::readbackStrip(int w)
 {
     QOpenGLFunctions* gl = context_->functions();
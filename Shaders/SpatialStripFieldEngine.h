@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -16,6 +17,9 @@ class QOpenGLShaderProgram;
  * Offscreen OpenGL assist for 1D strip kernels: render a row atlas, sample on CPU.
  * User body: void stripMain(out vec4 out_color, in float s01);
  * Engine supplies u_time and u_params[16].
+ *
+ * Without a usable GL context a registered CPU port of stripMain (setCpuField) fills
+ * the same row instead; OPENRGB_SPATIAL_CPU_FIELDS=1 forces that path, as for volumes.
  */
 class SpatialStripFieldEngine
 {
@@ -31,6 +35,17 @@ public:
         int count = 0;
     };
 
+    /** Per-fill inputs of a CPU field, matching the shader uniforms. */
+    struct CpuBakeContext
+    {
+        float time_sec = 0.0f;
+        const float* params = nullptr;
+        int width = 0;
+    };
+
+    /** Writes ctx.width red values (0..1); texel x sits at s01 = (x + 0.5) / width like the GL pass. */
+    using CpuField = std::function<void(const CpuBakeContext& ctx, float* r)>;
+
     SpatialStripFieldEngine();
     ~SpatialStripFieldEngine();
 
@@ -41,6 +56,10 @@ public:
     void setWidth(int w);
     void setParams(const Params& params);
 
+    /** C++ equivalent of the fragment body, used when GL is unavailable. */
+    void setCpuField(CpuField field);
+    bool usingCpuField() const;
+
     bool ensureReady();
     /** Linear sample of red channel as signed kernel (-1..1) encoded in R as (k+1)/2.
      *  Lock-free — do not call concurrently with ensureReady. */
@@ -53,10 +72,17 @@ public:
 private:
     bool initGl();
     void shutdownGl();
+    /** Same thread hand-off as SpatialVolumeFieldEngine: pull a parked context, park it after ensureReady. */
+    bool claimGlContext();
+    void parkGlContext();
+    void abandonGl();
     bool compileProgram(const QString& body);
     bool ensureFbo(int w);
     bool renderStrip();
     void readbackStrip(int w);
+    /** GL failed: latch onto the CPU field when one is registered, else report unavailable. */
+    bool failOverToCpu();
+    bool fillCpuStrip();
 
     QString fragment_body_;
     Params params_{};
@@ -71,6 +97,9 @@ private:
     std::atomic<bool> available_{false};
     QString last_error_;
 
+    CpuField cpu_field_;
+    bool cpu_mode_ = false;
+
     std::unique_ptr<QOffscreenSurface> surface_;
     std::unique_ptr<QOpenGLContext> context_;
     std::unique_ptr<QOpenGLShaderProgram> program_;
@@ -3,6 +3,7 @@
 #include "SpatialVolumeFieldAssist.h"
 
 #include <algorithm>
+#include <utility>
 
 void SpatialVolumeFieldAssist::setResolution(int n)
 {
@@ -35,9 +36,22 @@ void SpatialVolumeFieldAssist::clearMediaTexture()
     }
 }
 
+void SpatialVolumeFieldAssist::setCpuField(SpatialVolumeFieldEngine::CpuField field)
+{
+    cpu_field_ = std::move(field);
+    if(engine_)
+    {
+        engine_->setCpuField(cpu_field_);
+    }
+}
+
 void SpatialVolumeFieldAssist::applyEngineSize(SpatialVolumeFieldEngine& engine)
 {
     engine.setResolution(resolution_);
+    if(cpu_field_)
+    {
+        engine.setCpuField(cpu_field_);
+    }
     if(has_pending_media_)
     {
         engine.setMediaTexture(pending_media_, pending_wrap_);
@@ -20,6 +20,9 @@ public:
     void setMediaTexture(const QImage& image, bool wrap);
     void clearMediaTexture();
 
+    /** CPU port of the fragment body; keeps the effect on the atlas when GL is unavailable. */
+    void setCpuField(SpatialVolumeFieldEngine::CpuField field);
+
     float sampleScalar01(float x, float y, float z) const;
     QVector3D sample01(float x, float y, float z) const;
 
@@ -31,4 +34,5 @@ private:
     QImage pending_media_;
     bool pending_wrap_ = false;
     bool has_pending_media_ = false;
+    SpatialVolumeFieldEngine::CpuField cpu_field_;
 };
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "SpatialVolumeFieldCpuBaker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+int SpatialVolumeFieldCpuBaker::nextResolution(int requested_n) const
+{
+    if(resolution_ <= 0 || last_bake_us_ <= 0.0)
+    {
+        return requested_n;
+    }
+    const double voxel_us = last_bake_us_ / ((double)resolution_ * (double)resolution_ * (double)resolution_);
+    const int fit = (int)std::floor(std::cbrt(kBudgetUs / std::max(voxel_us, 1e-6)));
+    int n = resolution_;
+    if(fit < n)
+    {
+        n = fit;
+    }
+    else if(fit > n + 1)
+    {
+        // Grow one step at a time so a single cheap frame does not bounce the size.
+        n = n + 1;
+    }
+    return std::clamp(n, SpatialVolumeFieldEngine::kMinResolution, requested_n);
+}
+
+int SpatialVolumeFieldCpuBaker::bake(const SpatialVolumeFieldEngine::CpuField& field,
+                                     SpatialVolumeFieldEngine::CpuBakeContext ctx,
+                                     int requested_n,
+                                     std::vector<float>& rgb)
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+
+    const int n = nextResolution(requested_n);
+    ctx.resolution = n;
+    const SpatialVolumeFieldEngine::CpuRowFn row_fn = field ? field(ctx) : SpatialVolumeFieldEngine::CpuRowFn();
+
+    rgb.assign((size_t)n * (size_t)n * (size_t)n * 3u, 0.0f);
+    x01_.resize((size_t)n);
+    const float inv_n = 1.0f / (float)n;
+    for(int x = 0; x < n; ++x)
+    {
+        // Same voxel centres the GL pass feeds volumeMain.
+        x01_[(size_t)x] = ((float)x + 0.5f) * inv_n;
+    }
+
+    if(row_fn)
+    {
+        const size_t row_count = (size_t)n * (size_t)n;
+        const size_t row_stride = (size_t)n * 3u;
+        const size_t slots = ctx.pool ? (size_t)ctx.pool->GetSlotCount() : 1u;
+        const size_t tiles = std::min(row_count, slots * 4u);
+        const size_t rows_per_tile = (row_count + tiles - 1u) / tiles;
+
+        ranges_.clear();
+        for(size_t begin = 0; begin < row_count; begin += rows_per_tile)
+        {
+            EffectRenderTaskPool::TaskRange range;
+            range.begin = begin;
+            range.end = std::min(row_count, begin + rows_per_tile);
+            ranges_.push_back(range);
+        }
+
+        float* out = rgb.data();
+        const float* x01 = x01_.data();
+        auto bake_rows = [&](size_t begin, size_t end, unsigned int /*slot*/) {
+            SpatialVolumeFieldEngine::CpuRow row;
+            row.x01 = x01;
+            row.count = n;
+            for(size_t r = begin; r < end; ++r)
+            {
+                const size_t z = r / (size_t)n;
+                const size_t y = r - z * (size_t)n;
+                row.y01 = ((float)y + 0.5f) * inv_n;
+                row.z01 = ((float)z + 0.5f) * inv_n;
+                float* dst = out + r * row_stride;
+                row_fn(row, dst);
+                // The GL target clamps on write; keep sample01 seeing the same range.
+                for(size_t i = 0; i < row_stride; ++i)
+                {
+                    dst[i] = std::clamp(dst[i], 0.0f, 1.0f);
+                }
+            }
+        };
+        if(ctx.pool)
+        {
+            ctx.pool->Run(ranges_, bake_rows);
+        }
+        else
+        {
+            bake_rows(0, row_count, 0);
+        }
+    }
+
+    resolution_ = n;
+    last_bake_us_ = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    return n;
+}
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0-only
+#pragma once
+
+#include "EffectRenderTaskPool.h"
+#include "SpatialVolumeFieldEngine.h"
+
+#include <vector>
+
+/**
+ * CPU fill of a SpatialVolumeFieldEngine atlas: same n^3 RGB float layout
+ * ((z * n + y) * n + x) * 3, one CpuField row per (y, z), rows split into tiles on the
+ * render tab's EffectRenderTaskPool (CpuBakeContext::pool; inline when there is none).
+ * Row-at-a-time calls let field ports keep their inner x loop over flat arrays the
+ * compiler can vectorize.
+ *
+ * The resolution adapts to kBudgetUs: after each bake the per-voxel cost predicts the
+ * largest n that fits, growing back towards the requested resolution one step at a
+ * time once there is headroom. One baker per engine; not thread-safe itself.
+ */
+class SpatialVolumeFieldCpuBaker
+{
+public:
+    /** Wall-clock target for one atlas bake. */
+    static constexpr double kBudgetUs = 2000.0;
+
+    /** Bakes into rgb at the adaptive resolution (<= requested_n); returns the n used. */
+    int bake(const SpatialVolumeFieldEngine::CpuField& field,
+             SpatialVolumeFieldEngine::CpuBakeContext ctx,
+             int requested_n,
+             std::vector<float>& rgb);
+
+    double lastBakeUs() const { return last_bake_us_; }
+
+private:
+    int nextResolution(int requested_n) const;
+
+    int resolution_ = 0;
+    double last_bake_us_ = 0.0;
+    std::vector<float> x01_;
+    std::vector<EffectRenderTaskPool::TaskRange> ranges_;
+};
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0-only
 
 #include "SpatialVolumeFieldEngine.h"
+#include "SpatialVolumeFieldCpuBaker.h"
+#include "PluginLog.h"
 
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
@@ -8,15 +10,19 @@
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
+#include <QThread>
 #include <QVector2D>
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 
 namespace
 {
 
+EffectRenderTaskPool* g_cpu_bake_pool = nullptr;
+
 const char* kVertexShader = R"(attribute vec2 a_position;
 void main() {
     gl_Position = vec4(a_position, 0.0, 1.0);
@@ -73,6 +79,15 @@ void ConvertRgbaAtlasToRgb(const unsigned char* rgba, int n, std::vector<float>&
     }
 }
 
+bool CpuFieldsForced()
+{
+    static const bool forced = [] {
+        const char* value = std::getenv("OPENRGB_SPATIAL_CPU_FIELDS");
+        return value && value[0] != '\0' && value[0] != '0';
+    }();
+    return forced;
+}
+
 } // namespace
 
 SpatialVolumeFieldEngine::SpatialVolumeFieldEngine() = default;
@@ -80,7 +95,14 @@ SpatialVolumeFieldEngine::SpatialVolumeFieldEngine() = default;
 SpatialVolumeFieldEngine::~SpatialVolumeFieldEngine()
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    shutdownGl();
+    if(claimGlContext())
+    {
+        shutdownGl();
+    }
+    else
+    {
+        abandonGl();
+    }
 }
 
 void SpatialVolumeFieldEngine::destroyPbos()
@@ -143,6 +165,48 @@ void SpatialVolumeFieldEngine::shutdownGl()
     gl_ok_ = false;
 }
 
+bool SpatialVolumeFieldEngine::claimGlContext()
+{
+    if(!context_ || context_->thread() == QThread::currentThread())
+    {
+        return true;
+    }
+    // Only a context without affinity can be pulled; parkGlContext leaves it that way.
+    context_->moveToThread(QThread::currentThread());
+    return context_->thread() == QThread::currentThread();
+}
+
+void SpatialVolumeFieldEngine::parkGlContext()
+{
+    if(!context_)
+    {
+        return;
+    }
+    if(QOpenGLContext::currentContext() == context_.get())
+    {
+        context_->doneCurrent();
+    }
+    context_->moveToThread(nullptr);
+}
+
+void SpatialVolumeFieldEngine::abandonGl()
+{
+    // Without a current context Qt defers the GL deletes to context teardown.
+    pbos_[0] = pbos_[1] = 0;
+    pbo_has_pending_ = false;
+    pbo_bytes_ = 0;
+    pbo_pending_n_ = 0;
+    media_tex_id_ = 0;
+    media_tex_w_ = 0;
+    media_tex_h_ = 0;
+    fbo_.reset();
+    program_.reset();
+    context_.reset();
+    surface_.reset();
+    fbo_n_ = 0;
+    gl_ok_ = false;
+}
+
 void SpatialVolumeFieldEngine::setFragmentBody(const QString& glsl_body)
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -209,7 +273,7 @@ void SpatialVolumeFieldEngine::setMediaTexture(const QImage& image, bool wrap)
         }
     }
     const qint64 key = conv.isNull() ? 0 : conv.cacheKey();
-    if(key == media_cache_key_ && wrap == media_wrap_ && media_tex_id_ != 0 && !media_dirty_)
+    if(key == media_cache_key_ && wrap == media_wrap_ && (media_tex_id_ != 0 || cpu_mode_) && !media_dirty_)
     {
         return;
     }
@@ -230,6 +294,24 @@ bool SpatialVolumeFieldEngine::mediaDirty() const
     return media_dirty_;
 }
 
+void SpatialVolumeFieldEngine::setCpuField(CpuField field)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    cpu_field_ = std::move(field);
+    params_dirty_ = true;
+}
+
+bool SpatialVolumeFieldEngine::usingCpuField() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cpu_mode_;
+}
+
+void SpatialVolumeFieldEngine::setCpuBakePool(EffectRenderTaskPool* pool)
+{
+    g_cpu_bake_pool = pool;
+}
+
 QString SpatialVolumeFieldEngine::lastError() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -243,7 +325,13 @@ bool SpatialVolumeFieldEngine::ensureReady()
     {
         return available_.load();
     }
-    return renderAtlas();
+    if(!claimGlContext())
+    {
+        abandonGl();
+    }
+    const bool ready = renderAtlas();
+    parkGlContext();
+    return ready;
 }
 
 bool SpatialVolumeFieldEngine::initGl()
@@ -447,18 +535,20 @@ bool SpatialVolumeFieldEngine::renderAtlas()
         return false;
     }
 
-    if(!initGl())
+    if(cpu_mode_)
     {
-        available_.store(false);
-        return false;
+        return bakeCpuAtlas();
+    }
+    if((cpu_field_ && CpuFieldsForced()) || !initGl())
+    {
+        return failOverToCpu();
     }
 
     if(body_dirty_ || !program_)
     {
         if(!compileProgram(fragment_body_))
         {
-            available_.store(false);
-            return false;
+            return failOverToCpu();
         }
         body_dirty_ = false;
     }
@@ -530,6 +620,40 @@ bool SpatialVolumeFieldEngine::renderAtlas()
     return available_.load();
 }
 
+bool SpatialVolumeFieldEngine::failOverToCpu()
+{
+    if(!cpu_field_)
+    {
+        available_.store(false);
+        return false;
+    }
+    LOG_WARNING("[OpenRGB3DSpatialPlugin] Volume field falling back to CPU bake: %s",
+                last_error_.isEmpty() ? "forced by OPENRGB_SPATIAL_CPU_FIELDS" : qUtf8Printable(last_error_));
+    shutdownGl();
+    cpu_mode_ = true;
+    cpu_baker_ = std::make_unique<SpatialVolumeFieldCpuBaker>();
+    return bakeCpuAtlas();
+}
+
+bool SpatialVolumeFieldEngine::bakeCpuAtlas()
+{
+    CpuBakeContext ctx;
+    ctx.time_sec = params_.time_sec;
+    ctx.params = params_.values;
+    ctx.media = &media_image_;
+    ctx.media_wrap = media_wrap_;
+    ctx.pool = g_cpu_bake_pool;
+    atlas_res_ = cpu_baker_->bake(cpu_field_, ctx, resolution_, atlas_rgb_);
+
+    body_dirty_ = false;
+    params_dirty_ = false;
+    size_dirty_ = false;
+    media_dirty_ = false;
+    last_error_.clear();
+    available_.store(atlas_res_ > 0 && !atlas_rgb_.empty());
+    return available_.load();
+}
+
 void SpatialVolumeFieldEngine::readbackAtlas(int n)
 {
     QOpenGLFunctions* gl = context_->functions();
@@ -5,6 +5,7 @@
 #include <QString>
 #include <QVector3D>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -12,7 +13,9 @@
 class QOffscreenSurface;
 class QOpenGLContext;
 class QOpenGLFramebufferObject;
+class EffectRenderTaskPool;
 class QOpenGLShaderProgram;
+class SpatialVolumeFieldCpuBaker;
 
 /**
  * Shared offscreen OpenGL assist: evaluate a volumetric GLSL field on a unit-cube
@@ -23,8 +26,14 @@ class QOpenGLShaderProgram;
  * where p01 is in [0,1]^3. Engine supplies u_time, u_params[16], and optional
  * sampler2D u_media (media texture for TextureProjection / OmniShapeTexture).
  *
+ * Without a usable GL context (headless nodes, failed compile) an effect that registered
+ * a CPU port of volumeMain via setCpuField gets the same atlas baked on the CPU
+ * (SpatialVolumeFieldCpuBaker); the resolution may then drop below setResolution to
+ * hold the bake inside its time budget. OPENRGB_SPATIAL_CPU_FIELDS=1 forces that path.
+ *
  * Sibling to SpatialShaderEngine (2D fullscreen). Does not use the viewport MeshBatch.
- * Call ensureReady() from one thread only (typically the effect render path).
+ * Call ensureReady() from one thread at a time (the render worker, or the GUI thread while
+ * it is stopped); the GL context is parked between calls so either may pick it up.
  * sample01 / sampleScalar01 are lock-free — do not call concurrently with ensureReady.
  */
 class SpatialVolumeFieldEngine
@@ -42,6 +51,33 @@ public:
         int count = 0;
     };
 
+    /** Per-bake inputs of a CPU field, matching the shader uniforms. */
+    struct CpuBakeContext
+    {
+        float time_sec = 0.0f;
+        const float* params = nullptr;
+        /** Format_RGBA8888, or null image when no media is set. */
+        const QImage* media = nullptr;
+        bool media_wrap = false;
+        int resolution = 0;
+        /** Pool the rows are tiled on; null bakes every row on the calling thread. */
+        EffectRenderTaskPool* pool = nullptr;
+    };
+
+    /** One (y, z) row of voxel centres; x01 holds count values shared by every row. */
+    struct CpuRow
+    {
+        const float* x01 = nullptr;
+        int count = 0;
+        float y01 = 0.0f;
+        float z01 = 0.0f;
+    };
+
+    /** Writes row.count RGB triples (0..1). Called concurrently for different rows. */
+    using CpuRowFn = std::function<void(const CpuRow& row, float* rgb)>;
+    /** Called once per bake; may precompute per-frame tables and capture them in the row function. */
+    using CpuField = std::function<CpuRowFn(const CpuBakeContext& ctx)>;
+
     SpatialVolumeFieldEngine();
     ~SpatialVolumeFieldEngine();
 
@@ -57,6 +93,17 @@ public:
     void clearMediaTexture();
     bool mediaDirty() const;
 
+    /** C++ equivalent of the fragment body, used when GL is unavailable. */
+    void setCpuField(CpuField field);
+    bool usingCpuField() const;
+
+    /**
+     * Pool every engine in CPU mode tiles its bakes on: the render tab's pool, so CPU fields
+     * follow Render.EvaluationThreads instead of spawning threads of their own. Set and
+     * cleared only while the render worker is stopped, so no bake sees it change.
+     */
+    static void setCpuBakePool(EffectRenderTaskPool* pool);
+
     /** Rebuild atlas if dirty. Returns false if GL unavailable or compile failed. */
     bool ensureReady();
 
@@ -72,6 +119,12 @@ public:
 private:
     bool initGl();
     void shutdownGl();
+    /** Pulls a parked context onto the calling thread; false if another thread still owns it. */
+    bool claimGlContext();
+    /** Releases the context and its thread affinity once ensureReady is done with it. */
+    void parkGlContext();
+    /** Drops GL objects owned by another thread without touching GL. */
+    void abandonGl();
     bool compileProgram(const QString& body);
     bool ensureFbo(int n);
     bool renderAtlas();
@@ -80,6 +133,9 @@ private:
     bool ensurePbos(int n);
     void destroyMediaTexture();
     bool uploadMediaTexture();
+    /** GL failed: latch onto the CPU baker when a field is registered, else report unavailable. */
+    bool failOverToCpu();
+    bool bakeCpuAtlas();
 
     QString fragment_body_;
     Params params_{};
@@ -102,6 +158,10 @@ private:
     int media_tex_w_ = 0;
     int media_tex_h_ = 0;
 
+    CpuField cpu_field_;
+    std::unique_ptr<SpatialVolumeFieldCpuBaker> cpu_baker_;
+    bool cpu_mode_ = false;
+
     std::unique_ptr<QOffscreenSurface> surface_;
     std::unique_ptr<QOpenGLContext> context_;
     std::unique_ptr<QOpenGLShaderProgram> program_;
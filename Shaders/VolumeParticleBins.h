@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-2.0-only
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Coarse uniform grid over a box with a CSR list of particle indices per cell, for CPU
+ * volume-field bakes that would otherwise test every particle at every voxel. Particles
+ * are inserted by a conservative bounding box, optionally narrowed by a per-cell test,
+ * so a lookup returns a superset of the particles that can reach a point.
+ *
+ * Storage is reused across Build() calls; rebuild once per frame from the particle
+ * table, then query from any number of threads.
+ */
+class VolumeParticleBins
+{
+public:
+    static constexpr int kMaxCellsPerAxis = 16;
+
+    /**
+     * bounds(i, lo, hi) fills particle i's box and returns false to skip it.
+     * touches(i, cell_lo, cell_hi) may reject cells inside the box (e.g. a shell's hollow).
+     */
+    template<typename BoundsFn, typename TouchFn>
+    void Build(const float lo[3], const float hi[3], int cells_per_axis, int particle_count,
+               BoundsFn bounds, TouchFn touches)
+    {
+        cells_ = std::clamp(cells_per_axis, 1, kMaxCellsPerAxis);
+        for(int a = 0; a < 3; a++)
+        {
+            lo_[a] = lo[a];
+            const float span = std::max(hi[a] - lo[a], 1e-6f);
+            cell_size_[a] = span / (float)cells_;
+            inv_cell_[a] = (float)cells_ / span;
+        }
+
+        const int cell_count = cells_ * cells_ * cells_;
+        offsets_.assign((size_t)cell_count + 1u, 0u);
+        pairs_.clear();
+        for(int i = 0; i < particle_count; i++)
+        {
+            float p_lo[3];
+            float p_hi[3];
+            if(!bounds(i, p_lo, p_hi))
+            {
+                continue;
+            }
+            int c0[3];
+            int c1[3];
+            bool outside = false;
+            for(int a = 0; a < 3; a++)
+            {
+                c0[a] = std::max(0, CellCoord(p_lo[a], a));
+                c1[a] = std::min(cells_ - 1, CellCoord(p_hi[a], a));
+                outside = outside || (c0[a] > c1[a]);
+            }
+            if(outside)
+            {
+                continue;
+            }
+            for(int z = c0[2]; z <= c1[2]; z++)
+            {
+                for(int y = c0[1]; y <= c1[1]; y++)
+                {
+                    for(int x = c0[0]; x <= c1[0]; x++)
+                    {
+                        const float cell_lo[3] = {lo_[0] + (float)x * cell_size_[0],
+                                                  lo_[1] + (float)y * cell_size_[1],
+                                                  lo_[2] + (float)z * cell_size_[2]};
+                        const float cell_hi[3] = {cell_lo[0] + cell_size_[0],
+                                                  cell_lo[1] + cell_size_[1],
+                                                  cell_lo[2] + cell_size_[2]};
+                        if(!touches(i, cell_lo, cell_hi))
+                        {
+                            continue;
+                        }
+                        const std::uint32_t cell = (std::uint32_t)((z * cells_ + y) * cells_ + x);
+                        pairs_.push_back(((std::uint64_t)cell << 32) | (std::uint32_t)i);
+                        offsets_[cell + 1u]++;
+                    }
+                }
+            }
+        }
+
+        // Counting sort into CSR; particle order inside a cell stays ascending.
+        for(int c = 0; c < cell_count; c++)
+        {
+            offsets_[(size_t)c + 1u] += offsets_[(size_t)c];
+        }
+        indices_.resize(pairs_.size());
+        cursor_.assign(offsets_.begin(), offsets_.end() - 1);
+        for(std::uint64_t pair : pairs_)
+        {
+            const std::uint32_t cell = (std::uint32_t)(pair >> 32);
+            indices_[cursor_[cell]++] = (std::uint16_t)(pair & 0xFFFFu);
+        }
+    }
+
+    template<typename BoundsFn>
+    void Build(const float lo[3], const float hi[3], int cells_per_axis, int particle_count, BoundsFn bounds)
+    {
+        Build(lo, hi, cells_per_axis, particle_count, bounds,
+              [](int, const float*, const float*) { return true; });
+    }
+
+    /** Particles whose boxes cover the cell containing (x, y, z); points outside clamp to the edge cells. */
+    void Lookup(float x, float y, float z, const std::uint16_t** begin, const std::uint16_t** end) const
+    {
+        if(cells_ == 0)
+        {
+            *begin = *end = nullptr;
+            return;
+        }
+        const int cx = std::clamp(CellCoord(x, 0), 0, cells_ - 1);
+        const int cy = std::clamp(CellCoord(y, 1), 0, cells_ - 1);
+        const int cz = std::clamp(CellCoord(z, 2), 0, cells_ - 1);
+        const size_t cell = (size_t)((cz * cells_ + cy) * cells_ + cx);
+        *begin = indices_.data() + offsets_[cell];
+        *end = indices_.data() + offsets_[cell + 1u];
+    }
+
+    /** Total cell entries; average particles per cell is this over cells^3. */
+    size_t EntryCount() const { return indices_.size(); }
+
+private:
+    int CellCoord(float v, int axis) const
+    {
+        const float c = (v - lo_[axis]) * inv_cell_[axis];
+        // Clamp before the int cast so far-away boxes do not overflow.
+        return (int)std::floor(std::clamp(c, -1.0f, (float)cells_));
+    }
+
+    int cells_ = 0;
+    float lo_[3] = {};
+    float cell_size_[3] = {1.0f, 1.0f, 1.0f};
+    float inv_cell_[3] = {1.0f, 1.0f, 1.0f};
+    std::vector<std::uint32_t> offsets_;
+    std::vector<std::uint32_t> cursor_;
+    std::vector<std::uint16_t> indices_;
+    std::vector<std::uint64_t> pairs_;
+};
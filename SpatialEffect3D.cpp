@@ -883,7 +883,11 @@ void SpatialEffect3D::DisconnectStackRoomOutputPanel()
 void SpatialEffect3D::OnAddColorClicked()
 {
     RGBColor new_color = GetRainbowColor(colors.size() * 60.0f);
-    colors.push_back(new_color);
+    {
+        std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+        colors.push_back(new_color);
+        palette_revision_++;
+    }
     CreateColorButton(new_color);
 
     remove_color_button->setEnabled(colors.size() > 1);
@@ -894,7 +898,11 @@ void SpatialEffect3D::OnRemoveColorClicked()
 {
     if(colors.size() > 1)
     {
-        colors.pop_back();
+        {
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+            colors.pop_back();
+            palette_revision_++;
+        }
         RemoveLastColorButton();
         remove_color_button->setEnabled(colors.size() > 1);
         emit ParametersChanged();
@@ -921,7 +929,11 @@ void SpatialEffect3D::OnColorButtonClicked()
     if(color_dialog.exec() == QDialog::Accepted)
     {
         QColor new_color = color_dialog.currentColor();
-        colors[index] = ((unsigned int)new_color.blue() << 16) | ((unsigned int)new_color.green() << 8) | (unsigned int)new_color.red();
+        {
+            std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+            colors[index] = ((unsigned int)new_color.blue() << 16) | ((unsigned int)new_color.green() << 8) | (unsigned int)new_color.red();
+            palette_revision_++;
+        }
 
         PluginUiSetRgbSwatchButton(clicked_button, new_color.red(), new_color.green(), new_color.blue());
 
@@ -1091,22 +1103,25 @@ void SpatialEffect3D::OnParameterChanged()
             sampling_resolution_label->setText(QString::number(effect_sampling_resolution));
         }
     }
-    if(room_ao_slider)
     {
-        effect_room_relay_params_.ao_strength = static_cast<float>(std::clamp(room_ao_slider->value(), 0, 100));
-        if(room_ao_label)
+        std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+        if(room_ao_slider)
         {
-            room_ao_label->setText(QString::number(static_cast<int>(effect_room_relay_params_.ao_strength)) +
-                                   QStringLiteral("%"));
+            effect_room_relay_params_.ao_strength = static_cast<float>(std::clamp(room_ao_slider->value(), 0, 100));
+        }
+        if(room_blockers_check)
+        {
+            effect_room_relay_params_.use_occlusion = room_blockers_check->isChecked();
+        }
+        if(room_walls_blockers_check)
+        {
+            effect_room_relay_params_.use_room_walls = room_walls_blockers_check->isChecked();
         }
     }
-    if(room_blockers_check)
-    {
-        effect_room_relay_params_.use_occlusion = room_blockers_check->isChecked();
-    }
-    if(room_walls_blockers_check)
+    if(room_ao_slider && room_ao_label)
     {
-        effect_room_relay_params_.use_room_walls = room_walls_blockers_check->isChecked();
+        room_ao_label->setText(QString::number(static_cast<int>(effect_room_relay_params_.ao_strength)) +
+                               QStringLiteral("%"));
     }
     InvalidateRelayShadeCache();
     UpdateRoomShadingControlVisibility();
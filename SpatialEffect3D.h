@@ -18,13 +18,16 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <functional>
+#include <mutex>
 #include <QString>
 
 #include "LEDPosition3D.h"
 #include "SpatialEffectTypes.h"
 #include "GridSpaceUtils.h"
+#include "GradientLut3D.h"
 #include "SpatialRoom/SpatialRoomTypes.h"
 #include "SpatialLighting/SpatialLightingEngine.h"
 #include "Effects3D/SpatialLighting/RoomSpatialLightingUi.h"
@@ -279,10 +282,45 @@ public:
     virtual void SetupCustomUI(QWidget* parent) = 0;
     virtual RGBColor CalculateColorGrid(float x, float y, float z, float time, const GridContext3D& grid) = 0;
 
+    /**
+     * Render thread, once per frame from SyncRenderSnapshotEffects with RenderStateMutex held:
+     * create or repair shared settings state the unlocked evaluation then only reads. Default no-op.
+     */
+    virtual void PrepareRenderSnapshot() {}
     /** Once-per-frame GPU atlas/strip rebuild. Default no-op; LED samples only in CalculateColorGrid. */
     virtual void PrepareGpuFields(std::uint64_t /*render_sequence*/, float /*time_sec*/, const GridContext3D& /*grid*/) {}
     RGBColor EvaluateColorGrid(float x, float y, float z, float time, const GridContext3D& grid);
+    /**
+     * Full stack-layer sample for count points sharing one grid (SoA xs/ys/zs, not modified):
+     * axis scale / rotation unless SkipsSpatialSampleWarp, EvaluateColorGrid, the active-surface
+     * mask and PostProcessColorGrid. Same result per point as the scalar sequence; per-frame
+     * constants are resolved once per call. Not re-entrant per thread (shared scratch).
+     */
+    void EvaluateColorGridBatch(const float* xs,
+                                const float* ys,
+                                const float* zs,
+                                size_t count,
+                                float time,
+                                const GridContext3D& grid,
+                                RGBColor* out);
+    /** True when CalculateColorGrid reads per-LED thread state (sample index), so the stack must not batch it. */
+    virtual bool RequiresPerLedSampleContext() const { return false; }
+    /**
+     * True when EvaluateColorGridBatch may run on several threads at once for disjoint points:
+     * CalculateColorGrid only reads settings / per-frame GPU fields and writes no members.
+     */
+    virtual bool SupportsConcurrentEvaluation() const { return false; }
+    /** True when CalculateColorGrid returns black for every sample outside IsWithinEffectBoundary. */
+    virtual bool ClipsToEffectBoundary() const { return false; }
+    /**
+     * Conservative cull for region fills: false only when EvaluateColorGridBatch returns black
+     * for every point of the axis-aligned box [box_min, box_max] (before warp / quantization).
+     */
+    bool EffectBoundaryTouchesBox(const Vector3D& box_min, const Vector3D& box_max, const GridContext3D& grid) const;
+    /** Per thread: the effect whose CalculateColorGrid is running on the calling thread. */
     static const SpatialEffect3D* GetEvaluatingEffect();
+    /** Held by the render worker while it evaluates; GUI-side edits that reallocate effect state take it too. */
+    static std::recursive_mutex& RenderStateMutex();
     virtual bool UsesSpatialSamplingQuantization() const { return true; }
 
     bool EffectGridSampleOutsideVolume(float x, float y, float z, const GridContext3D& grid) const;
@@ -361,6 +399,18 @@ public:
     float GetRotationRoll() const { return effect_rotation_roll; }
 
     RGBColor PostProcessColorGrid(RGBColor color) const;
+    void PostProcessColorGridBatch(RGBColor* colors, size_t count) const;
+    /**
+     * Rebuilds the intensity / brightness / sharpness lookup tables when those settings moved. Call once per
+     * frame before evaluation fans out (RenderStateMutex held); post-processing falls back to direct math
+     * while the tables are stale, so a frame that skips this is still correct.
+     */
+    void PreparePostProcessStage();
+    /**
+     * Rebakes the palette table behind GetColorAtPosition after the colors changed. Same contract as
+     * PreparePostProcessStage: call before fan-out with RenderStateMutex held; stale tables fall back to the blend.
+     */
+    void PreparePaletteLut();
 
     Vector3D GetEffectOriginGrid(const GridContext3D& grid) const;
     float GetBoundaryMultiplier(float rel_x, float rel_y, float rel_z, const GridContext3D& grid) const;
@@ -385,6 +435,14 @@ public:
         return effect_room_coordinate_mode_ == SpatialRoom::SpatialRoomCoordinateMode::RoomMapped;
     }
     const RoomSpatialLightingUi::RoomSpatialLightParams& roomRelayParams() const { return effect_room_relay_params_; }
+    /** AO strength (0..1) and probe span this layer shades with; false when it does not apply room shading. */
+    bool GetRoomAmbientShadeParams(const GridContext3D& grid, float& ao_strength, float& probe_span) const;
+    /** Multiplier ApplyLayerRoomAmbientShading scales by; 1 when this layer does not shade or nothing occludes. */
+    float GetLayerRoomAmbientShadeFactor(float room_x,
+                                         float room_y,
+                                         float room_z,
+                                         const GridContext3D& grid,
+                                         int shade_slot = -1) const;
     RGBColor ApplyLayerRoomAmbientShading(float room_x,
                                           float room_y,
                                           float room_z,
@@ -411,6 +469,8 @@ public:
                                      const std::function<QString(int)>& transform_label = {});
     void DisconnectStackRoomOutputPanel();
     void InvalidateRelayShadeCache();
+    /** Bumped by InvalidateRelayShadeCache: role, emitter/receiver lists or occlusion changed. */
+    std::uint64_t roomRoutingRevision() const { return room_routing_revision_.load(std::memory_order_relaxed); }
     void SyncRoomCoordinateModeFromReference();
 
 signals:
@@ -567,9 +627,35 @@ protected:
     RoomSpatialLightingUi::RoomSpatialLightParams effect_room_relay_params_{};
     std::vector<int> effect_emitter_controller_indices_;
     std::vector<int> effect_receiver_controller_indices_;
+    std::atomic<std::uint64_t> room_routing_revision_{0};
 
     mutable SpatialLighting::ShadeSettings relay_shade_{};
 
+    /** Post-process compiled by PreparePostProcessStage for the settings it records. */
+    struct PostProcessStage
+    {
+        static constexpr int kLumCurveSteps = 1024;
+
+        bool valid = false;
+        unsigned int intensity = 0;
+        unsigned int brightness = 0;
+        unsigned int sharpness = 0;
+        bool black = false;
+        bool sharpen = false;
+        /** Channel byte after the intensity x brightness factor, clamped to 255. */
+        std::uint8_t channel[256] = {};
+        /** pow(lum / 255, gamma) * 255 at lum = i * 255 / kLumCurveSteps; read with linear interpolation. */
+        float lum_curve[kLumCurveSteps + 1] = {};
+    };
+    PostProcessStage post_process_stage_;
+    bool PostProcessStageCurrent() const;
+    static RGBColor ApplyPostProcessStage(RGBColor color, const PostProcessStage& stage);
+
+    /** Bumped on every edit of colors; palette_lut_ is current while palette_lut_revision_ matches. */
+    std::uint64_t palette_revision_ = 1;
+    std::uint64_t palette_lut_revision_ = 0;
+    GradientLut3D::Table palette_lut_;
+
     void ApplyRelayShadeSettings(const GridContext3D& grid) const;
     RGBColor ShadeRelayReceiversAt(float x, float y, float z, const GridContext3D& grid) const;
     QGroupBox*          path_plane_group;
@@ -607,6 +693,55 @@ protected:
     Vector3D GetEffectOrigin() const;
     RGBColor GetRainbowColor(float hue) const;
     RGBColor GetColorAtPosition(float position) const;
+    /** GetColorAtPosition over count positions; one table load per color once PreparePaletteLut has run. */
+    void GetColorsAtPositions(const float* positions, RGBColor* out, size_t count) const;
+
+    /**
+     * One sample with its palette / rainbow lookup deferred, so a batch resolves every lookup
+     * in one pass (ResolvePaletteSamples). key is a palette position (PALETTE) or a hue in
+     * degrees (HUE); color is final for DIRECT and the lookup result once resolved. gain is
+     * the effect's own intensity, applied by the effect after resolving.
+     */
+    struct PaletteSample
+    {
+        enum Lookup : unsigned char
+        {
+            DIRECT,
+            PALETTE,
+            HUE
+        };
+        Lookup lookup = DIRECT;
+        float key = 0.0f;
+        float gain = 1.0f;
+        RGBColor color = 0x00000000;
+    };
+    /** GetColorsAtPositions for the PALETTE samples, the hue wheel's SampleHueBatch for the HUE ones. */
+    void ResolvePaletteSamples(PaletteSample* samples, size_t count) const;
+
+    /**
+     * Batch driver for effects that shade through PaletteSample: shade(i, sample) fills each of
+     * count samples, in stack chunks, then out[i] = finish(sample) after the lookups resolve.
+     */
+    template<typename Shade, typename Finish>
+    void ShadePaletteBatch(size_t count, RGBColor* out, Shade shade, Finish finish) const
+    {
+        constexpr size_t kChunk = 64;
+        PaletteSample samples[kChunk];
+        for(size_t base = 0; base < count; base += kChunk)
+        {
+            const size_t n = std::min(count - base, kChunk);
+            for(size_t i = 0; i < n; i++)
+            {
+                samples[i] = PaletteSample{};
+                shade(base + i, samples[i]);
+            }
+            ResolvePaletteSamples(samples, n);
+            for(size_t i = 0; i < n; i++)
+            {
+                out[base + i] = finish(samples[i]);
+            }
+        }
+    }
     RGBColor GetPerBeatPulseColor(uint32_t color_slot) const;
     RGBColor ResolveAudioReactiveColor(const AudioReactiveSettings3D& cfg,
                                        const AudioReactiveColorParams& params) const;
@@ -636,6 +771,20 @@ protected:
                                  const GridContext3D* grid = nullptr) const;
 
     bool IsWithinEffectBoundary(float rel_x, float rel_y, float rel_z, const GridContext3D& grid) const;
+    /** Squared radius IsWithinEffectBoundary compares against (hoist it out of batch loops). */
+    float EffectBoundaryRadiusSq(const GridContext3D& grid) const;
+
+    /**
+     * Batch form of CalculateColorGrid over already warped / quantized samples. Default loops
+     * CalculateColorGrid; overrides hoist per-frame state and must match it sample for sample.
+     */
+    virtual void CalculateColorGridBatch(const float* xs,
+                                         const float* ys,
+                                         const float* zs,
+                                         size_t count,
+                                         float time,
+                                         const GridContext3D& grid,
+                                         RGBColor* out);
 
     Vector3D TransformPointByRotation(float x, float y, float z,
                                       const Vector3D& origin) const;
@@ -140,67 +140,96 @@ float SpatialEffect3D::ComputeStratumMotion01(const float layer_weights[3],
 
 RGBColor SpatialEffect3D::GetRainbowColor(float hue) const
 {
-    hue = std::fmod(hue, 360.0f);
-    if(hue < 0) hue += 360.0f;
-
-    float c = 1.0f;
-    float x = c * (1.0f - std::fabs(std::fmod(hue / 60.0f, 2.0f) - 1.0f));
-
-    float r, g, b;
-    if(hue < 60) { r = c; g = x; b = 0; }
-    else if(hue < 120) { r = x; g = c; b = 0; }
-    else if(hue < 180) { r = 0; g = c; b = x; }
-    else if(hue < 240) { r = 0; g = x; b = c; }
-    else if(hue < 300) { r = x; g = 0; b = c; }
-    else { r = c; g = 0; b = x; }
+    return GradientLut3D::HueWheel().SampleHue(hue);
+}
 
-    return ((int)(b * 255) << 16) | ((int)(g * 255) << 8) | (int)(r * 255);
+void SpatialEffect3D::PreparePaletteLut()
+{
+    if(palette_lut_revision_ == palette_revision_)
+    {
+        return;
+    }
+    palette_lut_.BuildEvenStops(colors.data(), colors.size());
+    palette_lut_revision_ = palette_revision_;
 }
 
 RGBColor SpatialEffect3D::GetColorAtPosition(float position) const
 {
-    position = std::clamp(position, 0.0f, 1.0f);
-
     if(rainbow_mode)
     {
+        position = std::clamp(position, 0.0f, 1.0f);
         return GetRainbowColor(position * 360.0f);
     }
-
-    if(colors.empty())
+    if(palette_lut_revision_ == palette_revision_)
     {
-        return COLOR_WHITE;
+        return palette_lut_.Sample01(position);
     }
+    return GradientLut3D::LerpEvenStops(colors.data(), colors.size(), position);
+}
 
-    if(colors.size() == 1)
+void SpatialEffect3D::GetColorsAtPositions(const float* positions, RGBColor* out, size_t count) const
+{
+    if(rainbow_mode)
     {
-        return colors[0];
+        const GradientLut3D::Table& wheel = GradientLut3D::HueWheel();
+        for(size_t i = 0; i < count; i++)
+        {
+            out[i] = wheel.SampleHue(std::clamp(positions[i], 0.0f, 1.0f) * 360.0f);
+        }
+        return;
     }
-
-    float scaled_pos = position * (colors.size() - 1);
-    int index = (int)scaled_pos;
-    float frac = scaled_pos - index;
-
-    if(index >= (int)colors.size() - 1)
+    if(palette_lut_revision_ == palette_revision_)
+    {
+        palette_lut_.Sample01Batch(positions, out, count);
+        return;
+    }
+    for(size_t i = 0; i < count; i++)
     {
-        return colors.back();
+        out[i] = GradientLut3D::LerpEvenStops(colors.data(), colors.size(), positions[i]);
     }
+}
 
-    RGBColor color1 = colors[index];
-    RGBColor color2 = colors[index + 1];
-
-    int b1 = (color1 >> 16) & 0xFF;
-    int g1 = (color1 >> 8) & 0xFF;
-    int r1 = color1 & 0xFF;
-
-    int b2 = (color2 >> 16) & 0xFF;
-    int g2 = (color2 >> 8) & 0xFF;
-    int r2 = color2 & 0xFF;
-
-    int r = (int)(r1 + (r2 - r1) * frac);
-    int g = (int)(g1 + (g2 - g1) * frac);
-    int b = (int)(b1 + (b2 - b1) * frac);
+void SpatialEffect3D::ResolvePaletteSamples(PaletteSample* samples, size_t count) const
+{
+    constexpr size_t kChunk = 64;
+    float keys[kChunk];
+    RGBColor looked_up[kChunk];
+    size_t slots[kChunk];
+    const GradientLut3D::Table& wheel = GradientLut3D::HueWheel();
 
-    return (b << 16) | (g << 8) | r;
+    for(size_t base = 0; base < count; base += kChunk)
+    {
+        const size_t n = std::min(count - base, kChunk);
+        PaletteSample* chunk = samples + base;
+        for(const PaletteSample::Lookup lookup : {PaletteSample::PALETTE, PaletteSample::HUE})
+        {
+            size_t m = 0;
+            for(size_t i = 0; i < n; i++)
+            {
+                if(chunk[i].lookup == lookup)
+                {
+                    keys[m] = chunk[i].key;
+                    slots[m++] = i;
+                }
+            }
+            if(m == 0)
+            {
+                continue;
+            }
+            if(lookup == PaletteSample::PALETTE)
+            {
+                GetColorsAtPositions(keys, looked_up, m);
+            }
+            else
+            {
+                wheel.SampleHueBatch(keys, looked_up, m);
+            }
+            for(size_t j = 0; j < m; j++)
+            {
+                chunk[slots[j]].color = looked_up[j];
+            }
+        }
+    }
 }
 
 RGBColor SpatialEffect3D::GetPerBeatPulseColor(uint32_t color_slot) const
@@ -537,11 +566,122 @@ RGBColor SpatialEffect3D::EvaluateColorGrid(float x, float y, float z, float tim
     return base;
 }
 
+namespace
+{
+/** Warped / quantized copies of the caller's SoA positions (one set per thread, reused). */
+struct BatchSampleScratch
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> qx;
+    std::vector<float> qy;
+    std::vector<float> qz;
+};
+
+thread_local BatchSampleScratch g_tls_batch_scratch;
+}
+
+void SpatialEffect3D::EvaluateColorGridBatch(const float* xs,
+                                             const float* ys,
+                                             const float* zs,
+                                             size_t count,
+                                             float time,
+                                             const GridContext3D& grid,
+                                             RGBColor* out)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    BatchSampleScratch& scratch = g_tls_batch_scratch;
+    scratch.x.assign(xs, xs + count);
+    scratch.y.assign(ys, ys + count);
+    scratch.z.assign(zs, zs + count);
+    float* wx = scratch.x.data();
+    float* wy = scratch.y.data();
+    float* wz = scratch.z.data();
+
+    if(!SkipsSpatialSampleWarp())
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            ApplyAxisScale(wx[i], wy[i], wz[i], grid);
+            ApplyEffectRotation(wx[i], wy[i], wz[i], grid);
+        }
+    }
+
+    if(effect_room_output_role_ == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
+    {
+        // Relay layers branch on the overlay pass / shading controller per sample; keep the scalar path.
+        for(size_t i = 0; i < count; i++)
+        {
+            out[i] = EvaluateColorGrid(wx[i], wy[i], wz[i], time, grid);
+        }
+    }
+    else
+    {
+        const float* sx = wx;
+        const float* sy = wy;
+        const float* sz = wz;
+        const unsigned int resolution_pct = GetSamplingResolution();
+        if(UsesSpatialSamplingQuantization() && resolution_pct < 100u)
+        {
+            scratch.qx.assign(wx, wx + count);
+            scratch.qy.assign(wy, wy + count);
+            scratch.qz.assign(wz, wz + count);
+            for(size_t i = 0; i < count; i++)
+            {
+                ApplySpatialSamplingQuantization(scratch.qx[i], scratch.qy[i], scratch.qz[i], grid, resolution_pct);
+            }
+            sx = scratch.qx.data();
+            sy = scratch.qy.data();
+            sz = scratch.qz.data();
+        }
+
+        const SpatialEffect3D* prev_eval_effect = g_tls_eval_effect;
+        g_tls_eval_effect = this;
+        CalculateColorGridBatch(sx, sy, sz, count, time, grid, out);
+        g_tls_eval_effect = prev_eval_effect;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!IsPointOnActiveSurface(wx[i], wy[i], wz[i], grid))
+        {
+            out[i] = 0x00000000;
+        }
+    }
+
+    PostProcessColorGridBatch(out, count);
+}
+
+void SpatialEffect3D::CalculateColorGridBatch(const float* xs,
+                                              const float* ys,
+                                              const float* zs,
+                                              size_t count,
+                                              float time,
+                                              const GridContext3D& grid,
+                                              RGBColor* out)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = CalculateColorGrid(xs[i], ys[i], zs[i], time, grid);
+    }
+}
+
 const SpatialEffect3D* SpatialEffect3D::GetEvaluatingEffect()
 {
     return g_tls_eval_effect;
 }
 
+std::recursive_mutex& SpatialEffect3D::RenderStateMutex()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
 float SpatialEffect3D::ApplySpatialPalette01(float base_pos01,
                                             const SpatialLayerCore::Basis& basis,
                                             const SpatialLayerCore::SamplePoint& sp,
@@ -689,12 +829,18 @@ float SpatialEffect3D::CalculateProgress(float time) const
     return time * GetScaledSpeed();
 }
 
-RGBColor SpatialEffect3D::PostProcessColorGrid(RGBColor color) const
+namespace
 {
-    float intensity_normalized = effect_intensity / 200.0f;
-    float intensity_mul = std::pow(intensity_normalized, 0.7f) * 1.7f;
-    float brightness_mul = effect_brightness / 100.0f;
-    float factor = intensity_mul * brightness_mul;
+struct PostProcessParams
+{
+    float factor = 0.0f;
+    bool sharpen = false;
+    float gamma = 1.0f;
+};
+
+RGBColor ApplyPostProcess(RGBColor color, const PostProcessParams& params)
+{
+    const float factor = params.factor;
     if(factor <= 0.0f) return 0x00000000;
 
     unsigned char r = color & 0xFF;
@@ -704,11 +850,9 @@ RGBColor SpatialEffect3D::PostProcessColorGrid(RGBColor color) const
     int gg = (int)(g * factor); if(gg > 255) gg = 255;
     int bb = (int)(b * factor); if(bb > 255) bb = 255;
 
-    if(effect_sharpness != 0)
+    if(params.sharpen)
     {
-        // 0 = passthrough. Higher = crisper / more contrast.
-        // Old values below 100 darkened everything — that side of the scale is removed.
-        const float gamma = std::pow(2.0f, effect_sharpness / 100.0f);
+        const float gamma = params.gamma;
         float rf = (float)rr;
         float gf = (float)gg;
         float bf = (float)bb;
@@ -732,6 +876,136 @@ RGBColor SpatialEffect3D::PostProcessColorGrid(RGBColor color) const
     return (bb << 16) | (gg << 8) | rr;
 }
 
+PostProcessParams MakePostProcessParams(unsigned int intensity, unsigned int brightness, unsigned int sharpness)
+{
+    PostProcessParams params;
+    float intensity_normalized = intensity / 200.0f;
+    float intensity_mul = std::pow(intensity_normalized, 0.7f) * 1.7f;
+    float brightness_mul = brightness / 100.0f;
+    params.factor = intensity_mul * brightness_mul;
+    // 0 = passthrough. Higher = crisper / more contrast.
+    // Old values below 100 darkened everything — that side of the scale is removed.
+    params.sharpen = (sharpness != 0);
+    if(params.sharpen)
+    {
+        params.gamma = std::pow(2.0f, sharpness / 100.0f);
+    }
+    return params;
+}
+}
+
+void SpatialEffect3D::PreparePostProcessStage()
+{
+    if(PostProcessStageCurrent())
+    {
+        return;
+    }
+    PostProcessStage& stage = post_process_stage_;
+    const PostProcessParams params = MakePostProcessParams(effect_intensity, effect_brightness, effect_sharpness);
+    stage.intensity = effect_intensity;
+    stage.brightness = effect_brightness;
+    stage.sharpness = effect_sharpness;
+    stage.black = params.factor <= 0.0f;
+    stage.sharpen = params.sharpen;
+    for(int v = 0; v < 256; v++)
+    {
+        stage.channel[v] = (std::uint8_t)std::min((int)(v * params.factor), 255);
+    }
+    if(stage.sharpen)
+    {
+        for(int i = 0; i <= PostProcessStage::kLumCurveSteps; i++)
+        {
+            const float x = (float)i / (float)PostProcessStage::kLumCurveSteps;
+            stage.lum_curve[i] = std::pow(x, params.gamma) * 255.0f;
+        }
+    }
+    stage.valid = true;
+}
+
+bool SpatialEffect3D::PostProcessStageCurrent() const
+{
+    const PostProcessStage& stage = post_process_stage_;
+    return stage.valid && stage.intensity == effect_intensity && stage.brightness == effect_brightness &&
+           stage.sharpness == effect_sharpness;
+}
+
+/** ApplyPostProcess with the pow() calls replaced by the stage's tables. */
+RGBColor SpatialEffect3D::ApplyPostProcessStage(RGBColor color, const PostProcessStage& stage)
+{
+    int rr = stage.channel[color & 0xFF];
+    int gg = stage.channel[(color >> 8) & 0xFF];
+    int bb = stage.channel[(color >> 16) & 0xFF];
+
+    if(stage.sharpen)
+    {
+        float rf = (float)rr;
+        float gf = (float)gg;
+        float bf = (float)bb;
+        const float lum = 0.299f * rf + 0.587f * gf + 0.114f * bf;
+        if(lum > 0.25f)
+        {
+            const float pos = std::min(lum, 255.0f) * ((float)PostProcessStage::kLumCurveSteps / 255.0f);
+            const int i0 = std::min((int)pos, PostProcessStage::kLumCurveSteps - 1);
+            const float t = pos - (float)i0;
+            const float lum_new = stage.lum_curve[i0] + (stage.lum_curve[i0 + 1] - stage.lum_curve[i0]) * t;
+            const float scale = lum_new / lum;
+            rf = std::clamp(rf * scale, 0.0f, 255.0f);
+            gf = std::clamp(gf * scale, 0.0f, 255.0f);
+            bf = std::clamp(bf * scale, 0.0f, 255.0f);
+            rr = std::min((int)(rf + 0.5f), 255);
+            gg = std::min((int)(gf + 0.5f), 255);
+            bb = std::min((int)(bf + 0.5f), 255);
+        }
+    }
+
+    return (bb << 16) | (gg << 8) | rr;
+}
+
+RGBColor SpatialEffect3D::PostProcessColorGrid(RGBColor color) const
+{
+    if(PostProcessStageCurrent())
+    {
+        return post_process_stage_.black ? 0x00000000 : ApplyPostProcessStage(color, post_process_stage_);
+    }
+    return ApplyPostProcess(color, MakePostProcessParams(effect_intensity, effect_brightness, effect_sharpness));
+}
+
+void SpatialEffect3D::PostProcessColorGridBatch(RGBColor* colors, size_t count) const
+{
+    if(!PostProcessStageCurrent())
+    {
+        const PostProcessParams params = MakePostProcessParams(effect_intensity, effect_brightness, effect_sharpness);
+        for(size_t i = 0; i < count; i++)
+        {
+            colors[i] = ApplyPostProcess(colors[i], params);
+        }
+        return;
+    }
+
+    const PostProcessStage& stage = post_process_stage_;
+    if(stage.black)
+    {
+        std::fill(colors, colors + count, (RGBColor)0x00000000);
+        return;
+    }
+    if(!stage.sharpen)
+    {
+        // Table-only pass: three byte loads per color, no float math.
+        const std::uint8_t* channel = stage.channel;
+        for(size_t i = 0; i < count; i++)
+        {
+            const RGBColor c = colors[i];
+            colors[i] = ((RGBColor)channel[(c >> 16) & 0xFF] << 16) | ((RGBColor)channel[(c >> 8) & 0xFF] << 8) |
+                        (RGBColor)channel[c & 0xFF];
+        }
+        return;
+    }
+    for(size_t i = 0; i < count; i++)
+    {
+        colors[i] = ApplyPostProcessStage(colors[i], stage);
+    }
+}
+
 static float smoothstep_edge(float edge0, float edge1, float x)
 {
     float t = (x - edge0) / (std::max(0.0001f, edge1 - edge0));
@@ -853,6 +1127,12 @@ Vector3D SpatialEffect3D::RotateVectorByEuler(float dx, float dy, float dz, floa
 }
 
 bool SpatialEffect3D::IsWithinEffectBoundary(float rel_x, float rel_y, float rel_z, const GridContext3D& grid) const
+{
+    float dist_sq = rel_x * rel_x + rel_y * rel_y + rel_z * rel_z;
+    return dist_sq <= EffectBoundaryRadiusSq(grid);
+}
+
+float SpatialEffect3D::EffectBoundaryRadiusSq(const GridContext3D& grid) const
 {
     Vector3D o = GetEffectOriginGrid(grid);
     float max_corner_sq = 0.0f;
@@ -878,10 +1158,33 @@ bool SpatialEffect3D::IsWithinEffectBoundary(float rel_x, float rel_y, float rel
     }
 
     float scale_percentage = GetNormalizedScale();
-    float scale_radius_sq = max_corner_sq * scale_percentage * scale_percentage;
+    return max_corner_sq * scale_percentage * scale_percentage;
+}
 
-    float dist_sq = rel_x * rel_x + rel_y * rel_y + rel_z * rel_z;
-    return dist_sq <= scale_radius_sq;
+bool SpatialEffect3D::EffectBoundaryTouchesBox(const Vector3D& box_min, const Vector3D& box_max, const GridContext3D& grid) const
+{
+    // Quantized samples snap toward the grid and relay layers shade per sample; neither is bounded here.
+    if(!ClipsToEffectBoundary() ||
+       effect_room_output_role_ == SpatialRoom::SpatialRoomOutputRole::EmitterRelay ||
+       (UsesSpatialSamplingQuantization() && GetSamplingResolution() < 100u))
+    {
+        return true;
+    }
+
+    // Rotation about the origin keeps distances; axis scale shrinks them by at most 100 / max(scale).
+    float radius = std::sqrt(EffectBoundaryRadiusSq(grid));
+    if(!SkipsSpatialSampleWarp())
+    {
+        const unsigned int max_scale = std::max(std::max(effect_scale_x, effect_scale_y), effect_scale_z);
+        radius *= (float)std::max(max_scale, 1u) / 100.0f;
+    }
+    radius = radius * 1.001f + 1e-4f;
+
+    const Vector3D o = GetEffectOriginGrid(grid);
+    const float dx = std::max(std::max(box_min.x - o.x, o.x - box_max.x), 0.0f);
+    const float dy = std::max(std::max(box_min.y - o.y, o.y - box_max.y), 0.0f);
+    const float dz = std::max(std::max(box_min.z - o.z, o.z - box_max.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
 }
 
 bool SpatialEffect3D::IsPointOnActiveSurface(float x, float y, float z, const GridContext3D& grid) const
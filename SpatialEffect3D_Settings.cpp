@@ -15,6 +15,8 @@
 
 void SpatialEffect3D::setRoomEmitterControllerIndex(int index, bool enabled)
 {
+    // The render worker walks these lists mid-frame (isRoomEmitterController / isRoomReceiverController).
+    std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
     auto it = std::find(effect_emitter_controller_indices_.begin(), effect_emitter_controller_indices_.end(), index);
     if(enabled)
     {
@@ -39,6 +41,7 @@ void SpatialEffect3D::setRoomEmitterControllerIndex(int index, bool enabled)
 
 void SpatialEffect3D::setRoomReceiverControllerIndex(int index, bool enabled)
 {
+    std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
     if(enabled && isRoomEmitterController(index))
     {
         return;
@@ -100,24 +103,36 @@ RGBColor SpatialEffect3D::SampleRelayShadeAt(float x, float y, float z, const Gr
     return ShadeRelayReceiversAt(x, y, z, grid);
 }
 
-RGBColor SpatialEffect3D::ApplyLayerRoomAmbientShading(float room_x,
-                                                       float room_y,
-                                                       float room_z,
-                                                       RGBColor color,
-                                                       const GridContext3D& grid,
-                                                       int shade_slot) const
+bool SpatialEffect3D::GetRoomAmbientShadeParams(const GridContext3D& grid, float& ao_strength, float& probe_span) const
 {
-    if(color == 0x00000000)
-    {
-        return color;
-    }
     if(effect_room_output_role_ == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
     {
-        return color;
+        return false;
     }
     if(!effect_room_relay_params_.use_occlusion)
     {
-        return color;
+        return false;
+    }
+
+    ao_strength = effect_room_relay_params_.ao_strength / 100.0f;
+    const float reach_u = MMToGridUnits(effect_room_relay_params_.light_reach_mm, grid.grid_scale_mm);
+    const float room_diag =
+        std::sqrt(grid.width * grid.width + grid.height * grid.height + grid.depth * grid.depth);
+    probe_span = std::clamp(std::max(reach_u * 0.4f, room_diag * 0.05f), 0.5f, 18.0f);
+    return true;
+}
+
+float SpatialEffect3D::GetLayerRoomAmbientShadeFactor(float room_x,
+                                                      float room_y,
+                                                      float room_z,
+                                                      const GridContext3D& grid,
+                                                      int shade_slot) const
+{
+    float ao_strength = 0.0f;
+    float probe_span = 0.0f;
+    if(!GetRoomAmbientShadeParams(grid, ao_strength, probe_span))
+    {
+        return 1.0f;
     }
 
     SpatialLightingSceneProvider* provider = SpatialLightingSceneProvider::instance();
@@ -126,15 +141,9 @@ RGBColor SpatialEffect3D::ApplyLayerRoomAmbientShading(float room_x,
     const SpatialLighting::RoomBlockerField& room_blocker_field = provider->frameRoomBlockerField();
     if(occluder_aabbs.empty() && occluders.empty() && !room_blocker_field.IsValid())
     {
-        return color;
+        return 1.0f;
     }
 
-    const float ao_strength = effect_room_relay_params_.ao_strength / 100.0f;
-    const float reach_u = MMToGridUnits(effect_room_relay_params_.light_reach_mm, grid.grid_scale_mm);
-    const float room_diag =
-        std::sqrt(grid.width * grid.width + grid.height * grid.height + grid.depth * grid.depth);
-    const float probe_span = std::clamp(std::max(reach_u * 0.4f, room_diag * 0.05f), 0.5f, 18.0f);
-
     const float shade_factor = provider->ComputeAmbientShadeFactorCached(shade_slot,
                                                                        room_x,
                                                                        room_y,
@@ -144,7 +153,22 @@ RGBColor SpatialEffect3D::ApplyLayerRoomAmbientShading(float room_x,
                                                                        grid.center_z,
                                                                        ao_strength,
                                                                        probe_span);
-    if(shade_factor >= 0.999f)
+    return (shade_factor >= 0.999f) ? 1.0f : shade_factor;
+}
+
+RGBColor SpatialEffect3D::ApplyLayerRoomAmbientShading(float room_x,
+                                                       float room_y,
+                                                       float room_z,
+                                                       RGBColor color,
+                                                       const GridContext3D& grid,
+                                                       int shade_slot) const
+{
+    if(color == 0x00000000)
+    {
+        return color;
+    }
+    const float shade_factor = GetLayerRoomAmbientShadeFactor(room_x, room_y, room_z, grid, shade_slot);
+    if(shade_factor >= 1.0f)
     {
         return color;
     }
@@ -180,6 +204,7 @@ void SpatialEffect3D::RefreshRoomOutputControllerLists()
 
 void SpatialEffect3D::InvalidateRelayShadeCache()
 {
+    room_routing_revision_.fetch_add(1, std::memory_order_relaxed);
     SpatialLightingSceneProvider::instance()->InvalidateFrameOccluders();
 }
 
@@ -220,11 +245,13 @@ void SpatialEffect3D::SetSpatialMappingMode(SpatialMappingMode mode)
 
 void SpatialEffect3D::SetColors(const std::vector<RGBColor>& new_colors)
 {
+    std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
     colors = new_colors;
     if(colors.empty())
     {
         colors.push_back(COLOR_RED);
     }
+    palette_revision_++;
 }
 
 std::vector<RGBColor> SpatialEffect3D::GetColors() const
@@ -580,6 +607,7 @@ void SpatialEffect3D::LoadSettings(const nlohmann::json& settings)
 
     if(settings.contains("room_output_role") && settings["room_output_role"].is_number_integer())
     {
+        std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
         const int raw_role = settings["room_output_role"].get<int>();
         if(raw_role == (int)SpatialRoom::SpatialRoomOutputRole::Direct
            || raw_role == (int)SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
@@ -593,7 +621,10 @@ void SpatialEffect3D::LoadSettings(const nlohmann::json& settings)
             effect_room_output_role_ = SpatialRoom::SpatialRoomOutputRole::Direct;
         }
     }
-    RoomSpatialLightingUi::LoadParamsFromJson(settings, "room_relay_light", effect_room_relay_params_);
+    {
+        std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+        RoomSpatialLightingUi::LoadParamsFromJson(settings, "room_relay_light", effect_room_relay_params_);
+    }
     if(room_ao_slider)
     {
         const int ao_pct = std::clamp(static_cast<int>(effect_room_relay_params_.ao_strength), 0, 100);
@@ -612,33 +643,36 @@ void SpatialEffect3D::LoadSettings(const nlohmann::json& settings)
         room_walls_blockers_check->setChecked(effect_room_relay_params_.use_room_walls);
     }
     UpdateRoomShadingControlVisibility();
-    effect_emitter_controller_indices_.clear();
-    if(settings.contains("room_emitter_controllers") && settings["room_emitter_controllers"].is_array())
     {
-        for(const auto& v : settings["room_emitter_controllers"])
+        std::lock_guard<std::recursive_mutex> render_lock(RenderStateMutex());
+        effect_emitter_controller_indices_.clear();
+        if(settings.contains("room_emitter_controllers") && settings["room_emitter_controllers"].is_array())
         {
-            if(v.is_number_integer())
+            for(const auto& v : settings["room_emitter_controllers"])
             {
-                effect_emitter_controller_indices_.push_back(v.get<int>());
+                if(v.is_number_integer())
+                {
+                    effect_emitter_controller_indices_.push_back(v.get<int>());
+                }
             }
         }
-    }
-    effect_receiver_controller_indices_.clear();
-    if(settings.contains("room_receiver_controllers") && settings["room_receiver_controllers"].is_array())
-    {
-        for(const auto& v : settings["room_receiver_controllers"])
+        effect_receiver_controller_indices_.clear();
+        if(settings.contains("room_receiver_controllers") && settings["room_receiver_controllers"].is_array())
         {
-            if(v.is_number_integer())
+            for(const auto& v : settings["room_receiver_controllers"])
             {
-                effect_receiver_controller_indices_.push_back(v.get<int>());
+                if(v.is_number_integer())
+                {
+                    effect_receiver_controller_indices_.push_back(v.get<int>());
+                }
             }
         }
+        effect_receiver_controller_indices_.erase(
+            std::remove_if(effect_receiver_controller_indices_.begin(),
+                           effect_receiver_controller_indices_.end(),
+                           [this](int idx) { return isRoomEmitterController(idx); }),
+            effect_receiver_controller_indices_.end());
     }
-    effect_receiver_controller_indices_.erase(
-        std::remove_if(effect_receiver_controller_indices_.begin(),
-                       effect_receiver_controller_indices_.end(),
-                       [this](int idx) { return isRoomEmitterController(idx); }),
-        effect_receiver_controller_indices_.end());
     InvalidateRelayShadeCache();
     if(room_output_panel_)
     {
@@ -0,0 +1,376 @@
+#-----------------------------------------------------------------------------------------------#
+# Spatial engine: effects, stack compositor, lighting, capture and audio analysis.              #
+# Included by OpenRGB3DSpatialPlugin.pro and by the headless benchmark (benchmark/). Nothing    #
+# here builds the tab; effect controls are only created when SetupCustomUI() is called.         #
+#-----------------------------------------------------------------------------------------------#
+QT += core gui widgets opengl
+CONFIG += c++17
+
+msvc {
+    QMAKE_CXXFLAGS += /utf-8 /bigobj
+    greaterThan(QT_MAJOR_VERSION, 5): QMAKE_CXXFLAGS += /wd4996 /Zm300
+}
+
+win32:DEFINES += NOMINMAX WIN32_LEAN_AND_MEAN
+
+INCLUDEPATH += \
+    $$PWD/OpenRGB/ \
+    $$PWD/OpenRGB/SPDAccessor \
+    $$PWD/OpenRGB/hidapi_wrapper \
+    $$PWD/OpenRGB/dependencies/hidapi-win/include \
+    $$PWD/OpenRGB/i2c_smbus \
+    $$PWD/OpenRGB/RGBController \
+    $$PWD/OpenRGB/net_port \
+    $$PWD/OpenRGB/dependencies/json \
+    $$PWD/OpenRGB/qt
+
+INCLUDEPATH += \
+    $$PWD \
+    $$PWD/ui \
+    $$PWD/ui/widgets \
+    $$PWD/Effects3D \
+    $$PWD/Game \
+    $$PWD/Game/lz4 \
+    $$PWD/SpatialSamplers \
+    $$PWD/SpatialRoom \
+    $$PWD/SpatialLighting \
+    $$PWD/Shaders \
+    $$PWD/Audio
+
+# CONFIG += spatial_engine_link: include paths and platform libraries only, for targets that
+# link the prebuilt static engine (benchmark/SpatialBench.pro) instead of compiling it.
+!spatial_engine_link {
+    HEADERS += \
+        $$PWD/OpenRGB/Colors.h \
+        $$PWD/OpenRGB/OpenRGBPluginInterface.h \
+        $$PWD/OpenRGB/ResourceManagerCallback.h \
+        $$PWD/OpenRGB/RGBController/RGBControllerInterface.h \
+        $$PWD/OpenRGB/RGBController/RGBController.h \
+        $$PWD/OpenRGB/LogManager.h \
+        $$PWD/PluginLog.h
+
+    RESOURCES += \
+        $$PWD/resources/spatial_shaders.qrc \
+        $$PWD/resources/plugin_ui.qrc
+
+    HEADERS += \
+        $$PWD/LEDPosition3D.h \
+        $$PWD/ControllerLayout3D.h \
+        $$PWD/LedFrameLayout3D.h \
+        $$PWD/GridSpaceUtils.h \
+        $$PWD/ZoneGrid3D.h \
+        $$PWD/SpatialEffectTypes.h \
+        $$PWD/SpatialEffect3D.h \
+        $$PWD/EffectListManager3D.h \
+        $$PWD/EffectRegisterer3D.h \
+        $$PWD/EffectInstance3D.h \
+        $$PWD/StackPreset3D.h \
+        $$PWD/VirtualController3D.h \
+        $$PWD/VirtualReferencePoint3D.h \
+        $$PWD/Zone3D.h \
+        $$PWD/ZoneManager3D.h \
+        $$PWD/DisplayPlane3D.h \
+        $$PWD/DisplayPlaneManager.h \
+        $$PWD/CaptureDownscale.h \
+        $$PWD/ScreenCaptureBackend.h \
+        $$PWD/ScreenCaptureManager.h \
+        $$PWD/Geometry3DUtils.h \
+        $$PWD/GradientLut3D.h \
+        $$PWD/TransformJson.h \
+        $$PWD/MediaTextureEffectUtils.h \
+        $$PWD/MediaFramePyramid.h \
+        $$PWD/MediaFrameAtlas.h \
+        $$PWD/Game/StripPatternSurface.h \
+        $$PWD/QtCompat.h \
+        $$PWD/ui/widgets/GameTelemetryStatusPanel.h \
+        $$PWD/Game/GameTelemetryBridge.h \
+        $$PWD/Game/RoomSampleFrameProtocol.h \
+        $$PWD/Game/RoomSampleShmPaths.h \
+        $$PWD/Game/RoomSampleFrameShmReader.h \
+        $$PWD/Game/RoomSampleConfigPublisher.h \
+        $$PWD/SpatialSamplers/SpatialBasisUtils.h \
+        $$PWD/SpatialSamplers/SpatialLayerCore.h \
+        $$PWD/SpatialSamplers/RoomSampleMapping.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftGame.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftGameSettings.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftSubEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftHealth/MinecraftHealthEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftHunger/MinecraftHungerEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftAir/MinecraftAirEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftDurability/MinecraftDurabilityEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftDamage/MinecraftDamageEffect3D.h \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftRoomAmbilight/MinecraftRoomAmbilightEffect3D.h \
+        $$PWD/SpatialRoom/SpatialRoomTypes.h \
+        $$PWD/SpatialRoom/SpatialRoomDefaults.h \
+        $$PWD/SpatialRoom/SpatialRoomFrame.h \
+        $$PWD/SpatialLighting/BlockerGridOccluder.h \
+        $$PWD/SpatialLighting/OccluderSpatialIndex.h \
+        $$PWD/SpatialLighting/SpatialLightingEngine.h \
+        $$PWD/SpatialLighting/EmitterRelayMirror.h \
+        $$PWD/SpatialLighting/EmitterLocalSampling.h \
+        $$PWD/SpatialLighting/SpatialLightingSceneProvider.h \
+        $$PWD/Effects3D/SpatialLighting/RoomSpatialLightingUi.h \
+        $$PWD/ui/PluginSettingsPaths.h \
+        $$PWD/ui/EffectRenderFrame.h \
+        $$PWD/ui/EffectRenderTaskPool.h \
+        $$PWD/ui/EffectStackEvaluator.h \
+        $$PWD/ui/EffectLayerCompositor.h \
+        $$PWD/ui/ControllerDisplayUtils.h \
+        $$PWD/ui/CustomControllerTypes.h \
+        $$PWD/ui/CustomControllerMappingUtils.h \
+        $$PWD/ui/OpenRGBPluginsFont.h \
+        $$PWD/ui/CaptureZonesWidget.h \
+        $$PWD/ui/PluginUiUtils.h \
+        $$PWD/Effects3D/EffectStratumBlend.h \
+        $$PWD/Effects3D/EffectHelpers.h \
+        $$PWD/Effects3D/EffectUiSync.h \
+        $$PWD/Effects3D/AudioReactiveCommon.h \
+        $$PWD/Effects3D/SpatialKernelColormap.h \
+        $$PWD/ui/widgets/StripKernelColormapPanel.h \
+        $$PWD/ui/widgets/StratumBandPanel.h \
+        $$PWD/ui/widgets/EffectMotionPanel.h \
+        $$PWD/ui/widgets/EffectOutputPanel.h \
+        $$PWD/ui/widgets/EffectGeometryPanel.h \
+        $$PWD/ui/widgets/EffectSurfacesPanel.h \
+        $$PWD/ui/widgets/EffectLayerBanner.h \
+        $$PWD/ui/widgets/EffectStackBlendRow.h \
+        $$PWD/ui/widgets/EffectColorPanel.h \
+        $$PWD/ui/widgets/EffectCustomHost.h \
+        $$PWD/ui/widgets/EffectTransportRow.h \
+        $$PWD/ui/widgets/EffectSliderRow.h \
+        $$PWD/ui/widgets/EffectLabeledComboRow.h \
+        $$PWD/ui/widgets/EffectLabeledSpinRow.h \
+        $$PWD/ui/widgets/EffectCheckRow.h \
+        $$PWD/ui/widgets/EffectInfoLabel.h \
+        $$PWD/ui/widgets/EffectSectionHeading.h \
+        $$PWD/ui/widgets/EffectCollapsibleSection.h \
+        $$PWD/ui/widgets/RoomSpatialLightSettingsPanel.h \
+        $$PWD/ui/widgets/EffectRoomOutputPanel.h \
+        $$PWD/ui/widgets/RoomOutputDeviceCard.h \
+        $$PWD/ui/widgets/EffectUiRows.h \
+        $$PWD/ui/widgets/MediaTextureAmbienceBlock.h \
+        $$PWD/ui/widgets/AudioEqBandColumn.h \
+        $$PWD/ui/widgets/EffectControlsRoot.h \
+        $$PWD/Effects3D/SpectrumBars/SpectrumBars.h \
+        $$PWD/Effects3D/AudioStripVisualizer/AudioStripVisualizer.h \
+        $$PWD/Effects3D/ShaderField/ShaderField.h \
+        $$PWD/Shaders/SpatialShaderEngine.h \
+        $$PWD/Shaders/SpatialShaderUniforms.h \
+        $$PWD/Shaders/SpatialShaderCatalog.h \
+        $$PWD/Shaders/SpatialFieldAssistBase.h \
+        $$PWD/Shaders/SpatialVolumeFieldEngine.h \
+        $$PWD/Shaders/SpatialVolumeFieldAssist.h \
+        $$PWD/Shaders/SpatialVolumeFieldCpuBaker.h \
+        $$PWD/Shaders/SpatialFieldCpuMath.h \
+        $$PWD/Shaders/VolumeParticleBins.h \
+        $$PWD/Shaders/SpatialStripFieldEngine.h \
+        $$PWD/Shaders/SpatialStripFieldAssist.h \
+        $$PWD/Effects3D/Plasma/PlasmaVolumeFieldGlsl.h \
+        $$PWD/Effects3D/Spiral/SpiralVolumeFieldGlsl.h \
+        $$PWD/Effects3D/Wave/WaveSurfaceVolumeFieldGlsl.h \
+        $$PWD/Effects3D/HexLattice/HexLatticeVolumeFieldGlsl.h \
+        $$PWD/Effects3D/PulseRing/PulseRingVolumeFieldGlsl.h \
+        $$PWD/Effects3D/DepthTone/DepthToneVolumeFieldGlsl.h \
+        $$PWD/Effects3D/ColorWheel/ColorWheelVolumeFieldGlsl.h \
+        $$PWD/Effects3D/BreathingSphere/BreathingSphereVolumeFieldGlsl.h \
+        $$PWD/Effects3D/HarmonicPulse/HarmonicPulseVolumeFieldGlsl.h \
+        $$PWD/Effects3D/DNAHelix/DNAHelixVolumeFieldGlsl.h \
+        $$PWD/Effects3D/RotatingConeSpotlights/RotatingConeVolumeFieldGlsl.h \
+        $$PWD/Effects3D/Bubbles/BubblesVolumeFieldGlsl.h \
+        $$PWD/Effects3D/BouncingBall/BouncingBallVolumeFieldGlsl.h \
+        $$PWD/Effects3D/Starfield/StarfieldVolumeFieldGlsl.h \
+        $$PWD/Effects3D/TextureProjection/TextureProjectionVolumeFieldGlsl.h \
+        $$PWD/Effects3D/OmniShapeTexture/OmniShapeTextureVolumeFieldGlsl.h \
+        $$PWD/Effects3D/TravelingLight/TravelingLightVolumeFieldGlsl.h \
+        $$PWD/Effects3D/SurfaceAmbient/SurfaceAmbientVolumeFieldGlsl.h \
+        $$PWD/Effects3D/ShellPattern/ShellPatternCubeVolumeFieldGlsl.h \
+        $$PWD/Effects3D/SpatialPatternKernels/SpatialStripKernelFieldGlsl.h \
+        $$PWD/Effects3D/AudioReactiveUi.h \
+        $$PWD/Effects3D/AudioLevel/AudioLevel.h \
+        $$PWD/Effects3D/AudioPulse/AudioPulse.h \
+        $$PWD/Audio/AudioInputManager.h \
+        $$PWD/Audio/RealFFT.h \
+        $$PWD/Effects3D/Plasma/Plasma.h \
+        $$PWD/Effects3D/Spiral/Spiral.h \
+        $$PWD/Effects3D/TravelingLight/TravelingLight.h \
+        $$PWD/Effects3D/Wave/Wave.h \
+        $$PWD/Effects3D/BreathingSphere/BreathingSphere.h \
+        $$PWD/Effects3D/DNAHelix/DNAHelix.h \
+        $$PWD/Effects3D/BouncingBall/BouncingBall.h \
+        $$PWD/Effects3D/PulseRing/PulseRing.h \
+        $$PWD/Effects3D/SurfaceAmbient/SurfaceAmbient.h \
+        $$PWD/Effects3D/Starfield/Starfield.h \
+        $$PWD/Effects3D/Bubbles/Bubbles.h \
+        $$PWD/Effects3D/ColorWheel/ColorWheel.h \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirror.h \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirror_Internal.h \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirrorCalibrationPattern.h \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirrorMonitorPanel.h \
+        $$PWD/Effects3D/TextureProjection/TextureProjection.h \
+        $$PWD/Effects3D/OmniShapeTexture/OmniShapeTexture.h \
+        $$PWD/Effects3D/ShellPattern/ShellPattern.h \
+        $$PWD/Effects3D/SpatialPatternKernels/SpatialPatternKernels.h \
+        $$PWD/Effects3D/SpatialPatternKernels/SpatialPatternPalettes.h \
+        $$PWD/Effects3D/RotatingConeSpotlights/RotatingConeSpotlights.h \
+        $$PWD/Effects3D/HarmonicPulse/HarmonicPulse.h \
+        $$PWD/Effects3D/HexLattice/HexLattice.h \
+        $$PWD/Effects3D/DepthTone/DepthTone.h
+
+    SOURCES += \
+        $$PWD/ControllerLayout3D.cpp \
+        $$PWD/LedFrameLayout3D.cpp \
+        $$PWD/GridSpaceUtils.cpp \
+        $$PWD/ZoneGrid3D.cpp \
+        $$PWD/SpatialEffect3D.cpp \
+        $$PWD/SpatialEffect3D_Eval.cpp \
+        $$PWD/SpatialEffect3D_Settings.cpp \
+        $$PWD/EffectInstance3D.cpp \
+        $$PWD/StackPreset3D.cpp \
+        $$PWD/VirtualController3D.cpp \
+        $$PWD/VirtualReferencePoint3D.cpp \
+        $$PWD/Zone3D.cpp \
+        $$PWD/ZoneManager3D.cpp \
+        $$PWD/DisplayPlane3D.cpp \
+        $$PWD/CaptureDownscale.cpp \
+        $$PWD/ScreenCaptureBackend.cpp \
+        $$PWD/ScreenCaptureBackendLinux.cpp \
+        $$PWD/ScreenCaptureManager.cpp \
+        $$PWD/MediaFramePyramid.cpp \
+        $$PWD/MediaFrameAtlas.cpp \
+        $$PWD/ui/widgets/GameTelemetryStatusPanel.cpp \
+        $$PWD/Game/GameTelemetryBridge.cpp \
+        $$PWD/Game/RoomSampleFrameShmReader.cpp \
+        $$PWD/Game/RoomSampleConfigPublisher.cpp \
+        $$PWD/Game/lz4/lz4.c \
+        $$PWD/SpatialSamplers/SpatialLayerCore.cpp \
+        $$PWD/SpatialSamplers/RoomSampleMapping.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftGame.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftGameSettings.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftSubEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftHealth/MinecraftHealthEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftHunger/MinecraftHungerEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftAir/MinecraftAirEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftDurability/MinecraftDurabilityEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftDamage/MinecraftDamageEffect3D.cpp \
+        $$PWD/Effects3D/Games/Minecraft/MinecraftRoomAmbilight/MinecraftRoomAmbilightEffect3D.cpp \
+        $$PWD/SpatialRoom/SpatialRoomDefaults.cpp \
+        $$PWD/SpatialRoom/SpatialRoomFrame.cpp \
+        $$PWD/SpatialLighting/BlockerGridOccluder.cpp \
+        $$PWD/SpatialLighting/OccluderSpatialIndex.cpp \
+        $$PWD/SpatialLighting/SpatialLightingEngine.cpp \
+        $$PWD/SpatialLighting/EmitterRelayMirror.cpp \
+        $$PWD/SpatialLighting/EmitterLocalSampling.cpp \
+        $$PWD/SpatialLighting/SpatialLightingSceneProvider.cpp \
+        $$PWD/Effects3D/SpatialLighting/RoomSpatialLightingUi.cpp \
+        $$PWD/ui/PluginSettingsPaths.cpp \
+        $$PWD/ui/EffectRenderTaskPool.cpp \
+        $$PWD/ui/EffectStackEvaluator.cpp \
+        $$PWD/ui/EffectLayerCompositor.cpp \
+        $$PWD/ui/CustomControllerMappingUtils.cpp \
+        $$PWD/ui/ControllerDisplayUtils.cpp \
+        $$PWD/ui/OpenRGBPluginsFont.cpp \
+        $$PWD/ui/CaptureZonesWidget.cpp \
+        $$PWD/ui/widgets/StratumBandPanel.cpp \
+        $$PWD/ui/widgets/StripKernelColormapPanel.cpp \
+        $$PWD/ui/widgets/EffectCommonPanels.cpp \
+        $$PWD/ui/widgets/EffectRowWidgets.cpp \
+        $$PWD/ui/widgets/RoomSpatialLightSettingsPanel.cpp \
+        $$PWD/ui/widgets/EffectRoomOutputPanel.cpp \
+        $$PWD/ui/widgets/RoomOutputDeviceCard.cpp \
+        $$PWD/ui/widgets/EffectStackBlendRow.cpp \
+        $$PWD/ui/widgets/EffectCustomHost.cpp \
+        $$PWD/ui/widgets/EffectTransportRow.cpp \
+        $$PWD/ui/widgets/MediaTextureAmbienceBlock.cpp \
+        $$PWD/ui/widgets/AudioEqBandColumn.cpp \
+        $$PWD/Effects3D/Plasma/Plasma.cpp \
+        $$PWD/Effects3D/Spiral/Spiral.cpp \
+        $$PWD/Effects3D/TravelingLight/TravelingLight.cpp \
+        $$PWD/Effects3D/Wave/Wave.cpp \
+        $$PWD/Effects3D/BreathingSphere/BreathingSphere.cpp \
+        $$PWD/Effects3D/DNAHelix/DNAHelix.cpp \
+        $$PWD/Effects3D/BouncingBall/BouncingBall.cpp \
+        $$PWD/Effects3D/SpectrumBars/SpectrumBars.cpp \
+        $$PWD/Effects3D/AudioStripVisualizer/AudioStripVisualizer.cpp \
+        $$PWD/Effects3D/ShaderField/ShaderField.cpp \
+        $$PWD/Shaders/SpatialShaderEngine.cpp \
+        $$PWD/Shaders/SpatialShaderCatalog.cpp \
+        $$PWD/Shaders/SpatialVolumeFieldEngine.cpp \
+        $$PWD/Shaders/SpatialVolumeFieldAssist.cpp \
+        $$PWD/Shaders/SpatialVolumeFieldCpuBaker.cpp \
+        $$PWD/Shaders/SpatialStripFieldEngine.cpp \
+        $$PWD/Shaders/SpatialStripFieldAssist.cpp \
+        $$PWD/Effects3D/AudioLevel/AudioLevel.cpp \
+        $$PWD/Effects3D/AudioPulse/AudioPulse.cpp \
+        $$PWD/Effects3D/PulseRing/PulseRing.cpp \
+        $$PWD/Effects3D/SurfaceAmbient/SurfaceAmbient.cpp \
+        $$PWD/Effects3D/Starfield/Starfield.cpp \
+        $$PWD/Effects3D/Bubbles/Bubbles.cpp \
+        $$PWD/Effects3D/ColorWheel/ColorWheel.cpp \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirror.cpp \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirror_Render.cpp \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirror_Settings.cpp \
+        $$PWD/Effects3D/ScreenMirror/ScreenMirrorMonitorPanel.cpp \
+        $$PWD/Effects3D/TextureProjection/TextureProjection.cpp \
+        $$PWD/Effects3D/OmniShapeTexture/OmniShapeTexture.cpp \
+        $$PWD/Effects3D/ShellPattern/ShellPattern.cpp \
+        $$PWD/Effects3D/SpatialPatternKernels/SpatialPatternKernels.cpp \
+        $$PWD/Effects3D/SpatialPatternKernels/SpatialPatternPalettes.cpp \
+        $$PWD/Effects3D/RotatingConeSpotlights/RotatingConeSpotlights.cpp \
+        $$PWD/Effects3D/HarmonicPulse/HarmonicPulse.cpp \
+        $$PWD/Effects3D/HexLattice/HexLattice.cpp \
+        $$PWD/Effects3D/DepthTone/DepthTone.cpp \
+        $$PWD/Audio/AudioInputManager.cpp \
+        $$PWD/Audio/RealFFT.cpp
+
+    FORMS += \
+        $$PWD/ui/forms/MediaTextureAmbienceBlock.ui \
+        $$PWD/ui/forms/EffectLayerBanner.ui \
+        $$PWD/ui/forms/EffectMotionPanel.ui \
+        $$PWD/ui/forms/EffectOutputPanel.ui \
+        $$PWD/ui/forms/EffectSurfacesPanel.ui \
+        $$PWD/ui/forms/EffectGeometryPanel.ui \
+        $$PWD/ui/forms/EffectColorPanel.ui \
+        $$PWD/ui/forms/EffectStackBlendRow.ui \
+        $$PWD/ui/forms/StratumBandPanel.ui \
+        $$PWD/ui/forms/StripKernelColormapPanel.ui \
+        $$PWD/ui/forms/GameTelemetryStatusPanel.ui \
+        $$PWD/ui/forms/EffectTransportRow.ui \
+        $$PWD/ui/forms/AudioEqBandColumn.ui \
+        $$PWD/ui/forms/CaptureZonesWidget.ui \
+        $$PWD/ui/forms/EffectSliderRow.ui \
+        $$PWD/ui/forms/EffectLabeledComboRow.ui \
+        $$PWD/ui/forms/EffectLabeledSpinRow.ui \
+        $$PWD/ui/forms/EffectCheckRow.ui \
+        $$PWD/ui/forms/EffectInfoLabel.ui \
+        $$PWD/ui/forms/EffectSectionHeading.ui \
+        $$PWD/ui/forms/EffectCollapsibleSection.ui \
+        $$PWD/ui/forms/RoomSpatialLightSettingsPanel.ui \
+        $$PWD/ui/forms/ScreenMirrorCapturePanel.ui \
+        $$PWD/ui/forms/ScreenMirrorMonitorSettings.ui \
+        $$PWD/ui/forms/ScreenMirrorEffectShell.ui \
+        $$PWD/ui/forms/MinecraftGameSettingsScroll.ui
+}
+
+win32:LIBS += \
+    -lOle32 -lOleAut32 -lAvrt -lMmdevapi -lPropsys -luuid \
+    -lgdi32 -luser32 -ld3d11 -ldxgi -ld3dcompiler \
+    -lws2_32 -lopengl32 -lWtsapi32
+
+win32:DEFINES += \
+    _MBCS \
+    WIN32 \
+    _CRT_SECURE_NO_WARNINGS \
+    _WINSOCK_DEPRECATED_NO_WARNINGS
+
+unix:!macx {
+    # GCC 16 + Qt 6 / nlohmann json: false positives from system and bundled headers.
+    QMAKE_CXXFLAGS += -Wno-psabi -Wno-array-bounds -Wno-sfinae-incomplete
+    LIBS += -lGL
+    # X11 screen capture via MIT-SHM; without it capture falls back to QScreen::grabWindow.
+    packagesExist(x11 xext) {
+        DEFINES += SPATIAL_CAPTURE_XSHM
+        LIBS += -lX11 -lXext
+    }
+}
+
+macx:LIBS += -framework OpenGL -framework CoreFoundation -framework IOKit
@@ -484,7 +484,7 @@ bool SegmentHitsBlockerGridsImpl(Vec3 a,
     }
 
     const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
-        SpatialLightingSceneProvider::instance()->controllers();
+        SpatialLightingSceneProvider::instance()->frameControllers();
     if(!transforms || grids.empty())
     {
         return false;
@@ -562,7 +562,7 @@ void BuildRoomBlockerField(RoomBlockerField& out, float grid_scale_mm, const Gri
 {
     out = RoomBlockerField{};
     const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
-        SpatialLightingSceneProvider::instance()->controllers();
+        SpatialLightingSceneProvider::instance()->frameControllers();
     if(!transforms)
     {
         return;
@@ -754,87 +754,99 @@ bool SegmentHitsRoomBlockerField(float ax,
     return SegmentHitsRoomBlockerFieldImpl({ax, ay, az}, {bx, by, bz}, field, also_skip_controller);
 }
 
-void BuildBlockerGridOccluders(std::vector<BlockerGridOccluder>& out, float grid_scale_mm)
+bool BuildBlockerGridOccluder(::ControllerTransform* ctrl,
+                              int controller_index,
+                              float grid_scale_mm,
+                              BlockerGridOccluder& out)
 {
-    out.clear();
-    const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
-        SpatialLightingSceneProvider::instance()->controllers();
-    if(!transforms)
+    if(!ctrl || ctrl->hidden_by_virtual || !ctrl->virtual_controller)
     {
-        return;
+        return false;
     }
 
-    const float scale_mm = SafeGridScaleMm(grid_scale_mm);
-    for(size_t ctrl_index = 0; ctrl_index < transforms->size(); ++ctrl_index)
+    VirtualController3D* layout = ctrl->virtual_controller;
+    const std::vector<CustomControllerLightBlocker>& blockers = layout->GetLightBlockers();
+    if(blockers.empty())
     {
-        ::ControllerTransform* ctrl = (*transforms)[ctrl_index].get();
-        if(!ctrl || ctrl->hidden_by_virtual || !ctrl->virtual_controller)
-        {
-            continue;
-        }
+        return false;
+    }
 
-        VirtualController3D* layout = ctrl->virtual_controller;
-        const std::vector<CustomControllerLightBlocker>& blockers = layout->GetLightBlockers();
-        if(blockers.empty())
+    if(ctrl->world_positions_dirty)
+    {
+        ControllerLayout3D::UpdateWorldPositions(ctrl);
+    }
+
+    const float scale_mm = SafeGridScaleMm(grid_scale_mm);
+    BlockerGridOccluder grid{};
+    grid.controller_index = controller_index;
+    grid.center_offset = ControllerLocalCenterOffset(ctrl);
+    grid.width = layout->GetWidth();
+    grid.height = layout->GetHeight();
+    grid.depth = layout->GetDepth();
+    BuildAxisEdges(layout, scale_mm, grid.width, &VirtualController3D::ColumnWidthMm, grid.x_edges);
+    BuildAxisEdges(layout, scale_mm, grid.height, &VirtualController3D::RowHeightMm, grid.y_edges);
+    BuildAxisEdges(layout, scale_mm, grid.depth, &VirtualController3D::LayerDepthMm, grid.z_edges);
+
+    const size_t cell_count =
+        static_cast<size_t>(grid.width) * static_cast<size_t>(grid.height) * static_cast<size_t>(grid.depth);
+    grid.dense_cells.assign(cell_count, 0);
+    for(const CustomControllerLightBlocker& blocker : blockers)
+    {
+        if(blocker.x < 0 || blocker.y < 0 || blocker.z < 0 || blocker.x >= grid.width || blocker.y >= grid.height ||
+           blocker.z >= grid.depth)
         {
             continue;
         }
+        const size_t index = static_cast<size_t>(blocker.x) +
+                             static_cast<size_t>(blocker.y) * static_cast<size_t>(grid.width) +
+                             static_cast<size_t>(blocker.z) * static_cast<size_t>(grid.width) *
+                                 static_cast<size_t>(grid.height);
+        grid.dense_cells[index] = 1;
+    }
+
+    const Vector3D local_corners[8] = {
+        {0.0f, 0.0f, 0.0f},
+        {grid.x_edges.back(), 0.0f, 0.0f},
+        {0.0f, grid.y_edges.back(), 0.0f},
+        {grid.x_edges.back(), grid.y_edges.back(), 0.0f},
+        {0.0f, 0.0f, grid.z_edges.back()},
+        {grid.x_edges.back(), 0.0f, grid.z_edges.back()},
+        {0.0f, grid.y_edges.back(), grid.z_edges.back()},
+        {grid.x_edges.back(), grid.y_edges.back(), grid.z_edges.back()},
+    };
+    grid.world_min = {std::numeric_limits<float>::max(),
+                      std::numeric_limits<float>::max(),
+                      std::numeric_limits<float>::max()};
+    grid.world_max = {std::numeric_limits<float>::lowest(),
+                      std::numeric_limits<float>::lowest(),
+                      std::numeric_limits<float>::lowest()};
+    for(const Vector3D& local_corner : local_corners)
+    {
+        const Vec3 world = ControllerLocalToWorld(ctrl, local_corner, grid.center_offset);
+        ExpandWorldBounds(&grid.world_min, &grid.world_max, world);
+    }
 
-        if(ctrl->world_positions_dirty)
-        {
-            ControllerLayout3D::UpdateWorldPositions(ctrl);
-        }
+    out = std::move(grid);
+    return true;
+}
 
-        BlockerGridOccluder grid{};
-        grid.controller_index = static_cast<int>(ctrl_index);
-        grid.center_offset = ControllerLocalCenterOffset(ctrl);
-        grid.width = layout->GetWidth();
-        grid.height = layout->GetHeight();
-        grid.depth = layout->GetDepth();
-        BuildAxisEdges(layout, scale_mm, grid.width, &VirtualController3D::ColumnWidthMm, grid.x_edges);
-        BuildAxisEdges(layout, scale_mm, grid.height, &VirtualController3D::RowHeightMm, grid.y_edges);
-        BuildAxisEdges(layout, scale_mm, grid.depth, &VirtualController3D::LayerDepthMm, grid.z_edges);
-
-        const size_t cell_count =
-            static_cast<size_t>(grid.width) * static_cast<size_t>(grid.height) * static_cast<size_t>(grid.depth);
-        grid.dense_cells.assign(cell_count, 0);
-        for(const CustomControllerLightBlocker& blocker : blockers)
-        {
-            if(blocker.x < 0 || blocker.y < 0 || blocker.z < 0 || blocker.x >= grid.width || blocker.y >= grid.height ||
-               blocker.z >= grid.depth)
-            {
-                continue;
-            }
-            const size_t index = static_cast<size_t>(blocker.x) +
-                                 static_cast<size_t>(blocker.y) * static_cast<size_t>(grid.width) +
-                                 static_cast<size_t>(blocker.z) * static_cast<size_t>(grid.width) *
-                                     static_cast<size_t>(grid.height);
-            grid.dense_cells[index] = 1;
-        }
+void BuildBlockerGridOccluders(std::vector<BlockerGridOccluder>& out, float grid_scale_mm)
+{
+    out.clear();
+    const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
+        SpatialLightingSceneProvider::instance()->frameControllers();
+    if(!transforms)
+    {
+        return;
+    }
 
-        const Vector3D local_corners[8] = {
-            {0.0f, 0.0f, 0.0f},
-            {grid.x_edges.back(), 0.0f, 0.0f},
-            {0.0f, grid.y_edges.back(), 0.0f},
-            {grid.x_edges.back(), grid.y_edges.back(), 0.0f},
-            {0.0f, 0.0f, grid.z_edges.back()},
-            {grid.x_edges.back(), 0.0f, grid.z_edges.back()},
-            {0.0f, grid.y_edges.back(), grid.z_edges.back()},
-            {grid.x_edges.back(), grid.y_edges.back(), grid.z_edges.back()},
-        };
-        grid.world_min = {std::numeric_limits<float>::max(),
-                          std::numeric_limits<float>::max(),
-                          std::numeric_limits<float>::max()};
-        grid.world_max = {std::numeric_limits<float>::lowest(),
-                          std::numeric_limits<float>::lowest(),
-                          std::numeric_limits<float>::lowest()};
-        for(const Vector3D& local_corner : local_corners)
+    for(size_t ctrl_index = 0; ctrl_index < transforms->size(); ++ctrl_index)
+    {
+        BlockerGridOccluder grid{};
+        if(BuildBlockerGridOccluder((*transforms)[ctrl_index].get(), static_cast<int>(ctrl_index), grid_scale_mm, grid))
         {
-            const Vec3 world = ControllerLocalToWorld(ctrl, local_corner, grid.center_offset);
-            ExpandWorldBounds(&grid.world_min, &grid.world_max, world);
+            out.push_back(std::move(grid));
         }
-
-        out.push_back(std::move(grid));
     }
 }
 
@@ -50,6 +50,12 @@ struct BlockerGridOccluder
     std::vector<uint8_t> dense_cells{};
 };
 
+/** One controller's blocker grid; false when it is hidden or has no light blockers. */
+bool BuildBlockerGridOccluder(::ControllerTransform* ctrl,
+                              int controller_index,
+                              float grid_scale_mm,
+                              BlockerGridOccluder& out);
+
 void BuildBlockerGridOccluders(std::vector<BlockerGridOccluder>& out, float grid_scale_mm);
 
 void BuildRoomBlockerField(RoomBlockerField& out,
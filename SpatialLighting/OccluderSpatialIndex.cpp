@@ -4,6 +4,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define OCCLUDER_INDEX_SSE2 1
+    #include <emmintrin.h>
+#endif
 
 namespace SpatialLighting
 {
@@ -14,34 +20,30 @@ constexpr int kMaxCellsPerAxis = 48;
 constexpr float kMinCellSize = 0.35f;
 constexpr float kMaxCellSize = 12.0f;
 
-thread_local std::vector<uint32_t> g_candidate_stamp;
-thread_local uint32_t g_candidate_generation = 1;
+/** Matches SegmentHitsAabb: axes this close to zero are tested as "origin inside the slab". */
+constexpr float kParallelEpsilon = 1e-8f;
 
-void MarkCandidate(uint16_t index, std::vector<uint16_t>& out)
-{
-    if(g_candidate_stamp.size() <= index)
-    {
-        g_candidate_stamp.resize(static_cast<size_t>(index) + 1u, 0u);
-    }
-    if(g_candidate_stamp[index] != g_candidate_generation)
-    {
-        g_candidate_stamp[index] = g_candidate_generation;
-        out.push_back(index);
-    }
-}
-
-void BumpCandidateGeneration()
-{
-    ++g_candidate_generation;
-    if(g_candidate_generation == 0u)
-    {
-        std::fill(g_candidate_stamp.begin(), g_candidate_stamp.end(), 0u);
-        g_candidate_generation = 1u;
-    }
-}
+constexpr uint16_t kPadEntry = 0xFFFFu;
+/**
+ * Padding lanes hold a zero-size box this far out: on a parallel axis the origin is never inside it, and
+ * on any other axis both slab distances land on the same side of [t_min, t_max], so it never hits.
+ */
+constexpr float kPadCoord = 1e30f;
 
 } // namespace
 
+/** Per-segment constants shared by every cell the DDA visits. */
+struct OccluderSpatialIndex::SlabRay
+{
+    float origin[3];
+    float inv_dir[3];
+    bool parallel[3];
+    float t_min;
+    float t_max;
+    int32_t skip_a;
+    int32_t skip_b;
+};
+
 void OccluderSpatialIndex::Clear()
 {
     origin_x_ = 0.0f;
@@ -51,28 +53,47 @@ void OccluderSpatialIndex::Clear()
     cells_x_ = 0;
     cells_y_ = 0;
     cells_z_ = 0;
-    cells_.clear();
+    boxes_.clear();
+    box_ranges_.clear();
+    cell_offsets_.clear();
+    entry_min_x_.clear();
+    entry_min_y_.clear();
+    entry_min_z_.clear();
+    entry_max_x_.clear();
+    entry_max_y_.clear();
+    entry_max_z_.clear();
+    entry_controller_.clear();
+    entry_box_.clear();
 }
 
 int OccluderSpatialIndex::CellIndex(int ix, int iy, int iz) const
 {
-    if(ix < 0 || iy < 0 || iz < 0 || ix >= cells_x_ || iy >= cells_y_ || iz >= cells_z_)
-    {
-        return -1;
-    }
     return ix + iy * cells_x_ + iz * cells_x_ * cells_y_;
 }
 
-void OccluderSpatialIndex::AppendCellCandidates(int cell_index, std::vector<uint16_t>& out_candidates) const
+bool OccluderSpatialIndex::CellRange(const OccluderAabb& box, std::array<int, 6>& range) const
 {
-    if(cell_index < 0 || cell_index >= static_cast<int>(cells_.size()))
-    {
-        return;
-    }
-    for(uint16_t index : cells_[static_cast<size_t>(cell_index)])
-    {
-        MarkCandidate(index, out_candidates);
-    }
+    const float fx0 = std::floor((box.min.x - origin_x_) / cell_size_);
+    const float fy0 = std::floor((box.min.y - origin_y_) / cell_size_);
+    const float fz0 = std::floor((box.min.z - origin_z_) / cell_size_);
+    const float fx1 = std::floor((box.max.x - origin_x_) / cell_size_);
+    const float fy1 = std::floor((box.max.y - origin_y_) / cell_size_);
+    const float fz1 = std::floor((box.max.z - origin_z_) / cell_size_);
+    // Clamp in float first so a box far outside the grid cannot overflow the int cast.
+    const auto clamp_cell = [](float v, int cells) {
+        return static_cast<int>(std::clamp(v, 0.0f, static_cast<float>(cells - 1)));
+    };
+    range[0] = clamp_cell(fx0, cells_x_);
+    range[1] = clamp_cell(fy0, cells_y_);
+    range[2] = clamp_cell(fz0, cells_z_);
+    range[3] = clamp_cell(fx1, cells_x_);
+    range[4] = clamp_cell(fy1, cells_y_);
+    range[5] = clamp_cell(fz1, cells_z_);
+    // Build sizes the grid around every box, so a box only sticks out when it moved past the extent.
+    return box.min.x >= origin_x_ && box.min.y >= origin_y_ && box.min.z >= origin_z_ &&
+           box.max.x <= origin_x_ + static_cast<float>(cells_x_) * cell_size_ &&
+           box.max.y <= origin_y_ + static_cast<float>(cells_y_) * cell_size_ &&
+           box.max.z <= origin_z_ + static_cast<float>(cells_z_) * cell_size_;
 }
 
 void OccluderSpatialIndex::Build(const std::vector<OccluderAabb>& aabbs,
@@ -110,7 +131,10 @@ void OccluderSpatialIndex::Build(const std::vector<OccluderAabb>& aabbs,
     const float span_z = std::max(max_z - min_z, kMinCellSize);
     const float max_span = std::max(span_x, std::max(span_y, span_z));
 
+    // Grow cells rather than cap the count, so the grid always covers every box and the DDA can clip
+    // segments to the extent.
     cell_size_ = std::clamp(max_span / 24.0f, kMinCellSize, kMaxCellSize);
+    cell_size_ = std::max(cell_size_, max_span / static_cast<float>(kMaxCellsPerAxis) * 1.0001f);
     origin_x_ = min_x;
     origin_y_ = min_y;
     origin_z_ = min_z;
@@ -118,84 +142,300 @@ void OccluderSpatialIndex::Build(const std::vector<OccluderAabb>& aabbs,
     cells_x_ = std::clamp(static_cast<int>(std::ceil(span_x / cell_size_)), 1, kMaxCellsPerAxis);
     cells_y_ = std::clamp(static_cast<int>(std::ceil(span_y / cell_size_)), 1, kMaxCellsPerAxis);
     cells_z_ = std::clamp(static_cast<int>(std::ceil(span_z / cell_size_)), 1, kMaxCellsPerAxis);
-    cells_.assign(static_cast<size_t>(cells_x_) * static_cast<size_t>(cells_y_) * static_cast<size_t>(cells_z_), {});
 
-    for(uint16_t index = 0; index < aabbs.size(); ++index)
+    const size_t box_count = std::min(aabbs.size(), static_cast<size_t>(kPadEntry));
+    boxes_.assign(aabbs.begin(), aabbs.begin() + static_cast<std::ptrdiff_t>(box_count));
+    box_ranges_.resize(box_count);
+    for(size_t index = 0; index < box_count; ++index)
     {
-        const OccluderAabb& box = aabbs[index];
-        const int ix0 = std::max(0, static_cast<int>(std::floor((box.min.x - origin_x_) / cell_size_)));
-        const int iy0 = std::max(0, static_cast<int>(std::floor((box.min.y - origin_y_) / cell_size_)));
-        const int iz0 = std::max(0, static_cast<int>(std::floor((box.min.z - origin_z_) / cell_size_)));
-        const int ix1 = std::min(cells_x_ - 1, static_cast<int>(std::floor((box.max.x - origin_x_) / cell_size_)));
-        const int iy1 = std::min(cells_y_ - 1, static_cast<int>(std::floor((box.max.y - origin_y_) / cell_size_)));
-        const int iz1 = std::min(cells_z_ - 1, static_cast<int>(std::floor((box.max.z - origin_z_) / cell_size_)));
+        CellRange(boxes_[index], box_ranges_[index]);
+    }
+    PackCells();
+}
 
-        for(int iz = iz0; iz <= iz1; ++iz)
+void OccluderSpatialIndex::PackCells()
+{
+    const size_t cell_count =
+        static_cast<size_t>(cells_x_) * static_cast<size_t>(cells_y_) * static_cast<size_t>(cells_z_);
+    cell_offsets_.assign(cell_count + 1u, 0u);
+    for(const std::array<int, 6>& range : box_ranges_)
+    {
+        for(int iz = range[2]; iz <= range[5]; ++iz)
         {
-            for(int iy = iy0; iy <= iy1; ++iy)
+            for(int iy = range[1]; iy <= range[4]; ++iy)
             {
-                for(int ix = ix0; ix <= ix1; ++ix)
+                for(int ix = range[0]; ix <= range[3]; ++ix)
                 {
-                    const int cell = CellIndex(ix, iy, iz);
-                    if(cell >= 0)
-                    {
-                        cells_[static_cast<size_t>(cell)].push_back(index);
-                    }
+                    cell_offsets_[static_cast<size_t>(CellIndex(ix, iy, iz)) + 1u]++;
+                }
+            }
+        }
+    }
+    for(size_t cell = 0; cell < cell_count; ++cell)
+    {
+        const uint32_t padded = (cell_offsets_[cell + 1u] + (kLanes - 1)) / kLanes * kLanes;
+        cell_offsets_[cell + 1u] = cell_offsets_[cell] + padded;
+    }
+
+    const size_t entry_count = cell_offsets_[cell_count];
+    entry_min_x_.assign(entry_count, kPadCoord);
+    entry_min_y_.assign(entry_count, kPadCoord);
+    entry_min_z_.assign(entry_count, kPadCoord);
+    entry_max_x_.assign(entry_count, kPadCoord);
+    entry_max_y_.assign(entry_count, kPadCoord);
+    entry_max_z_.assign(entry_count, kPadCoord);
+    entry_controller_.assign(entry_count, -1);
+    entry_box_.assign(entry_count, kPadEntry);
+
+    std::vector<uint32_t> cursor(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for(size_t index = 0; index < box_ranges_.size(); ++index)
+    {
+        const std::array<int, 6>& range = box_ranges_[index];
+        for(int iz = range[2]; iz <= range[5]; ++iz)
+        {
+            for(int iy = range[1]; iy <= range[4]; ++iy)
+            {
+                for(int ix = range[0]; ix <= range[3]; ++ix)
+                {
+                    WriteEntry(cursor[static_cast<size_t>(CellIndex(ix, iy, iz))]++, static_cast<uint16_t>(index));
                 }
             }
         }
     }
 }
 
-void OccluderSpatialIndex::CollectBoxCandidates(float min_x,
-                                                float min_y,
-                                                float min_z,
-                                                float max_x,
-                                                float max_y,
-                                                float max_z,
-                                                std::vector<uint16_t>& out_candidates) const
+void OccluderSpatialIndex::WriteEntry(size_t entry, uint16_t index)
 {
-    if(cells_.empty())
+    const OccluderAabb& box = boxes_[index];
+    entry_min_x_[entry] = box.min.x;
+    entry_min_y_[entry] = box.min.y;
+    entry_min_z_[entry] = box.min.z;
+    entry_max_x_[entry] = box.max.x;
+    entry_max_y_[entry] = box.max.y;
+    entry_max_z_[entry] = box.max.z;
+    entry_controller_[entry] = box.controller_index;
+    entry_box_[entry] = index;
+}
+
+bool OccluderSpatialIndex::UpdateEntry(uint16_t index, const OccluderAabb& old_box, const OccluderAabb& new_box)
+{
+    (void)old_box;
+    std::array<int, 6> range;
+    if(cell_offsets_.empty() || index >= boxes_.size() || !CellRange(new_box, range))
     {
-        return;
+        return false;
     }
 
-    BumpCandidateGeneration();
+    boxes_[index] = new_box;
+    if(range != box_ranges_[index])
+    {
+        box_ranges_[index] = range;
+        PackCells();
+        return true;
+    }
 
-    const int ix0 = std::max(0, static_cast<int>(std::floor((min_x - origin_x_) / cell_size_)));
-    const int iy0 = std::max(0, static_cast<int>(std::floor((min_y - origin_y_) / cell_size_)));
-    const int iz0 = std::max(0, static_cast<int>(std::floor((min_z - origin_z_) / cell_size_)));
-    const int ix1 = std::min(cells_x_ - 1, static_cast<int>(std::floor((max_x - origin_x_) / cell_size_)));
-    const int iy1 = std::min(cells_y_ - 1, static_cast<int>(std::floor((max_y - origin_y_) / cell_size_)));
-    const int iz1 = std::min(cells_z_ - 1, static_cast<int>(std::floor((max_z - origin_z_) / cell_size_)));
+    for(int iz = range[2]; iz <= range[5]; ++iz)
+    {
+        for(int iy = range[1]; iy <= range[4]; ++iy)
+        {
+            for(int ix = range[0]; ix <= range[3]; ++ix)
+            {
+                const size_t cell = static_cast<size_t>(CellIndex(ix, iy, iz));
+                for(uint32_t entry = cell_offsets_[cell]; entry < cell_offsets_[cell + 1u]; ++entry)
+                {
+                    if(entry_box_[entry] == index)
+                    {
+                        WriteEntry(entry, index);
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool OccluderSpatialIndex::CellHits(size_t cell, const SlabRay& ray) const
+{
+    const uint32_t begin = cell_offsets_[cell];
+    const uint32_t end = cell_offsets_[cell + 1u];
+    const float* const mins[3] = {entry_min_x_.data(), entry_min_y_.data(), entry_min_z_.data()};
+    const float* const maxs[3] = {entry_max_x_.data(), entry_max_y_.data(), entry_max_z_.data()};
 
-    for(int iz = iz0; iz <= iz1; ++iz)
+#ifdef OCCLUDER_INDEX_SSE2
+    const __m128i skip_a = _mm_set1_epi32(ray.skip_a);
+    const __m128i skip_b = _mm_set1_epi32(ray.skip_b);
+    for(uint32_t entry = begin; entry < end; entry += kLanes)
     {
-        for(int iy = iy0; iy <= iy1; ++iy)
+        __m128 t0 = _mm_set1_ps(ray.t_min);
+        __m128 t1 = _mm_set1_ps(ray.t_max);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int axis = 0; axis < 3; ++axis)
         {
-            for(int ix = ix0; ix <= ix1; ++ix)
+            const __m128 lo = _mm_loadu_ps(mins[axis] + entry);
+            const __m128 hi = _mm_loadu_ps(maxs[axis] + entry);
+            const __m128 o = _mm_set1_ps(ray.origin[axis]);
+            if(ray.parallel[axis])
             {
-                AppendCellCandidates(CellIndex(ix, iy, iz), out_candidates);
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(o, lo), _mm_cmple_ps(o, hi)));
+                continue;
             }
+            const __m128 inv = _mm_set1_ps(ray.inv_dir[axis]);
+            const __m128 t_lo = _mm_mul_ps(_mm_sub_ps(lo, o), inv);
+            const __m128 t_hi = _mm_mul_ps(_mm_sub_ps(hi, o), inv);
+            t0 = _mm_max_ps(t0, _mm_min_ps(t_lo, t_hi));
+            t1 = _mm_min_ps(t1, _mm_max_ps(t_lo, t_hi));
+        }
+        const __m128i controller = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entry_controller_.data() + entry));
+        const __m128 skipped =
+            _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(controller, skip_a), _mm_cmpeq_epi32(controller, skip_b)));
+        const __m128 hit = _mm_andnot_ps(skipped, _mm_and_ps(inside, _mm_cmple_ps(t0, t1)));
+        if(_mm_movemask_ps(hit) != 0)
+        {
+            return true;
         }
     }
+#else
+    for(uint32_t entry = begin; entry < end; ++entry)
+    {
+        const int32_t controller = entry_controller_[entry];
+        if(controller == ray.skip_a || controller == ray.skip_b)
+        {
+            continue;
+        }
+        float t0 = ray.t_min;
+        float t1 = ray.t_max;
+        bool inside = true;
+        for(int axis = 0; axis < 3 && inside; ++axis)
+        {
+            const float lo = mins[axis][entry];
+            const float hi = maxs[axis][entry];
+            if(ray.parallel[axis])
+            {
+                inside = ray.origin[axis] >= lo && ray.origin[axis] <= hi;
+                continue;
+            }
+            const float t_lo = (lo - ray.origin[axis]) * ray.inv_dir[axis];
+            const float t_hi = (hi - ray.origin[axis]) * ray.inv_dir[axis];
+            t0 = std::max(t0, std::min(t_lo, t_hi));
+            t1 = std::min(t1, std::max(t_lo, t_hi));
+        }
+        if(inside && t0 <= t1)
+        {
+            return true;
+        }
+    }
+#endif
+    return false;
 }
 
-void OccluderSpatialIndex::CollectSegmentCandidates(Vec3 a, Vec3 b, std::vector<uint16_t>& out_candidates) const
+bool OccluderSpatialIndex::SegmentHitsAny(Vec3 origin,
+                                          Vec3 dir,
+                                          float t_min,
+                                          float t_max,
+                                          int skip_controller,
+                                          int also_skip_controller) const
 {
-    if(cells_.empty())
+    if(cell_offsets_.empty() || t_max < t_min)
     {
-        return;
+        return false;
+    }
+
+    // -1 means "skip nothing"; map it to a tag no box carries so the lane compare stays branch-free.
+    constexpr int32_t kNoSkip = std::numeric_limits<int32_t>::min();
+    SlabRay ray;
+    ray.origin[0] = origin.x;
+    ray.origin[1] = origin.y;
+    ray.origin[2] = origin.z;
+    ray.t_min = t_min;
+    ray.t_max = t_max;
+    ray.skip_a = skip_controller >= 0 ? skip_controller : kNoSkip;
+    ray.skip_b = also_skip_controller >= 0 ? also_skip_controller : kNoSkip;
+
+    const float dir_v[3] = {dir.x, dir.y, dir.z};
+    const float grid_lo[3] = {origin_x_, origin_y_, origin_z_};
+    const int cells[3] = {cells_x_, cells_y_, cells_z_};
+
+    // Clip the segment to the grid extent; every box lies inside it.
+    float t_enter = t_min;
+    float t_exit = t_max;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        const float lo = grid_lo[axis];
+        const float hi = lo + static_cast<float>(cells[axis]) * cell_size_;
+        ray.parallel[axis] = std::fabs(dir_v[axis]) < kParallelEpsilon;
+        if(ray.parallel[axis])
+        {
+            ray.inv_dir[axis] = 0.0f;
+            if(ray.origin[axis] < lo || ray.origin[axis] > hi)
+            {
+                return false;
+            }
+            continue;
+        }
+        ray.inv_dir[axis] = 1.0f / dir_v[axis];
+        float t_lo = (lo - ray.origin[axis]) * ray.inv_dir[axis];
+        float t_hi = (hi - ray.origin[axis]) * ray.inv_dir[axis];
+        if(t_lo > t_hi)
+        {
+            std::swap(t_lo, t_hi);
+        }
+        t_enter = std::max(t_enter, t_lo);
+        t_exit = std::min(t_exit, t_hi);
+    }
+    if(t_enter > t_exit)
+    {
+        return false;
+    }
+
+    // Amanatides-Woo walk from the clipped entry point.
+    int cell[3];
+    int step[3];
+    float t_next[3];
+    float t_delta[3];
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        const float p = ray.origin[axis] + dir_v[axis] * t_enter;
+        const float c = std::floor((p - grid_lo[axis]) / cell_size_);
+        cell[axis] = static_cast<int>(std::clamp(c, 0.0f, static_cast<float>(cells[axis] - 1)));
+        if(ray.parallel[axis])
+        {
+            step[axis] = 0;
+            t_next[axis] = std::numeric_limits<float>::infinity();
+            t_delta[axis] = std::numeric_limits<float>::infinity();
+            continue;
+        }
+        step[axis] = dir_v[axis] > 0.0f ? 1 : -1;
+        const float boundary = grid_lo[axis] + static_cast<float>(cell[axis] + (step[axis] > 0 ? 1 : 0)) * cell_size_;
+        t_next[axis] = (boundary - ray.origin[axis]) * ray.inv_dir[axis];
+        t_delta[axis] = cell_size_ * std::fabs(ray.inv_dir[axis]);
     }
 
-    const float min_x = std::min(a.x, b.x);
-    const float min_y = std::min(a.y, b.y);
-    const float min_z = std::min(a.z, b.z);
-    const float max_x = std::max(a.x, b.x);
-    const float max_y = std::max(a.y, b.y);
-    const float max_z = std::max(a.z, b.z);
-    const float pad = cell_size_ * 0.5f;
-    CollectBoxCandidates(min_x - pad, min_y - pad, min_z - pad, max_x + pad, max_y + pad, max_z + pad, out_candidates);
+    for(;;)
+    {
+        if(CellHits(static_cast<size_t>(CellIndex(cell[0], cell[1], cell[2])), ray))
+        {
+            return true;
+        }
+        int axis = 0;
+        if(t_next[1] < t_next[axis])
+        {
+            axis = 1;
+        }
+        if(t_next[2] < t_next[axis])
+        {
+            axis = 2;
+        }
+        if(t_next[axis] > t_exit)
+        {
+            return false;
+        }
+        cell[axis] += step[axis];
+        if(cell[axis] < 0 || cell[axis] >= cells[axis])
+        {
+            return false;
+        }
+        t_next[axis] += t_delta[axis];
+    }
 }
 
 } // namespace SpatialLighting
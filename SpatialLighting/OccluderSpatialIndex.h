@@ -5,16 +5,24 @@
 
 #include "SpatialLighting/SpatialLightingEngine.h"
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
 namespace SpatialLighting
 {
 
-/** Uniform grid over AABB occluders for sub-linear segment queries. */
+/**
+ * Uniform grid over AABB occluders for sub-linear segment queries. Cells are stored flat (CSR):
+ * cell c owns entries [cell_offsets_[c], cell_offsets_[c + 1]), each entry an SoA copy of one box,
+ * and every run is padded to kLanes so a cell is tested kLanes boxes at a time with no tail loop.
+ * Segments walk the cells they cross (3D-DDA) instead of gathering a bounding box of cells.
+ */
 class OccluderSpatialIndex
 {
 public:
+    static constexpr int kLanes = 4;
+
     void Clear();
     void Build(const std::vector<OccluderAabb>& aabbs,
                float bounds_min_x,
@@ -24,23 +32,35 @@ public:
                float bounds_max_y,
                float bounds_max_z);
 
-    bool IsBuilt() const { return !cells_.empty(); }
+    bool IsBuilt() const { return !cell_offsets_.empty(); }
 
-    /** Collect AABB indices whose grid cells overlap the segment bounding box (deduped). */
-    void CollectSegmentCandidates(Vec3 a, Vec3 b, std::vector<uint16_t>& out_candidates) const;
+    /**
+     * Replaces AABB `index` (old_box must be what the index holds). Entries are rewritten in place when the
+     * box keeps its cells; otherwise the CSR arrays are re-packed from the stored cell ranges without
+     * re-binning other boxes. Returns false (index unchanged) when new_box leaves the grid extent: the caller
+     * rebuilds instead.
+     */
+    bool UpdateEntry(uint16_t index, const OccluderAabb& old_box, const OccluderAabb& new_box);
 
-    /** Collect AABB indices in an axis-aligned box (for short AO probes). */
-    void CollectBoxCandidates(float min_x,
-                              float min_y,
-                              float min_z,
-                              float max_x,
-                              float max_y,
-                              float max_z,
-                              std::vector<uint16_t>& out_candidates) const;
+    /**
+     * True when origin + dir * t hits any indexed AABB for some t in [t_min, t_max], skipping boxes tagged
+     * skip_controller or also_skip_controller (-1 = none). Same slab test as a per-box loop.
+     */
+    bool SegmentHitsAny(Vec3 origin,
+                        Vec3 dir,
+                        float t_min,
+                        float t_max,
+                        int skip_controller,
+                        int also_skip_controller) const;
 
 private:
+    struct SlabRay;
+
+    bool CellRange(const OccluderAabb& box, std::array<int, 6>& range) const;
     int CellIndex(int ix, int iy, int iz) const;
-    void AppendCellCandidates(int cell_index, std::vector<uint16_t>& out_candidates) const;
+    void PackCells();
+    void WriteEntry(size_t entry, uint16_t index);
+    bool CellHits(size_t cell, const SlabRay& ray) const;
 
     float origin_x_ = 0.0f;
     float origin_y_ = 0.0f;
@@ -49,7 +69,21 @@ private:
     int cells_x_ = 0;
     int cells_y_ = 0;
     int cells_z_ = 0;
-    std::vector<std::vector<uint16_t>> cells_;
+
+    /** By box index: the box and the inclusive cell range (x0, y0, z0, x1, y1, z1) it is binned into. */
+    std::vector<OccluderAabb> boxes_;
+    std::vector<std::array<int, 6>> box_ranges_;
+
+    std::vector<uint32_t> cell_offsets_;
+    std::vector<float> entry_min_x_;
+    std::vector<float> entry_min_y_;
+    std::vector<float> entry_min_z_;
+    std::vector<float> entry_max_x_;
+    std::vector<float> entry_max_y_;
+    std::vector<float> entry_max_z_;
+    std::vector<int32_t> entry_controller_;
+    /** Box index per entry; kPadEntry for padding lanes. */
+    std::vector<uint16_t> entry_box_;
 };
 
 } // namespace SpatialLighting
@@ -223,28 +223,11 @@ static bool SegmentHitsOccluderSet(Vec3 a,
     }
 
     const int skip_controller = SpatialLightingSceneProvider::instance()->shadingControllerIndex();
-    thread_local std::vector<uint16_t> candidate_indices;
-    candidate_indices.clear();
-
     if(aabb_index && aabb_index->IsBuilt())
     {
-        aabb_index->CollectSegmentCandidates(a, b, candidate_indices);
-        for(uint16_t box_index : candidate_indices)
+        if(aabb_index->SegmentHitsAny(a, dir, t_min, t_max, skip_controller, also_skip_controller))
         {
-            if(box_index >= aabbs.size())
-            {
-                continue;
-            }
-            const OccluderAabb& box = aabbs[box_index];
-            if((skip_controller >= 0 && box.controller_index == skip_controller) ||
-               (also_skip_controller >= 0 && box.controller_index == also_skip_controller))
-            {
-                continue;
-            }
-            if(SegmentHitsAabb(a, dir, t_min, t_max, box))
-            {
-                return true;
-            }
+            return true;
         }
     }
     else
@@ -316,24 +299,25 @@ static const OccluderSpatialIndex* ResolveAabbSpatialIndex(const std::vector<Occ
 
 } // namespace
 
-float ComputeRoomAmbientShadeFactor(float room_x,
-                                    float room_y,
-                                    float room_z,
-                                    float room_center_x,
-                                    float room_center_y,
-                                    float room_center_z,
-                                    const std::vector<OccluderAabb>& aabbs,
-                                    const std::vector<OccluderQuad>& quads,
-                                    const std::vector<BlockerGridOccluder>& blocker_grids,
-                                    float ao_strength_norm,
-                                    float probe_span,
-                                    const OccluderSpatialIndex* aabb_index,
-                                    const RoomBlockerField* room_blocker_field)
+RoomAmbientShadeTerms ComputeRoomAmbientShadeTerms(float room_x,
+                                                  float room_y,
+                                                  float room_z,
+                                                  float room_center_x,
+                                                  float room_center_y,
+                                                  float room_center_z,
+                                                  const std::vector<OccluderAabb>& aabbs,
+                                                  const std::vector<OccluderQuad>& quads,
+                                                  const std::vector<BlockerGridOccluder>& blocker_grids,
+                                                  bool with_openness,
+                                                  float probe_span,
+                                                  const OccluderSpatialIndex* aabb_index,
+                                                  const RoomBlockerField* room_blocker_field)
 {
+    RoomAmbientShadeTerms terms;
     if(aabbs.empty() && quads.empty() && blocker_grids.empty() &&
        (!room_blocker_field || !room_blocker_field->IsValid()))
     {
-        return 1.0f;
+        return terms;
     }
 
     const OccluderSpatialIndex* index = aabb_index;
@@ -346,29 +330,57 @@ float ComputeRoomAmbientShadeFactor(float room_x,
         blocker_grids.empty() ? nullptr : &blocker_grids;
     const RoomBlockerField* merged_field = room_blocker_field;
 
-    float shade_factor = 1.0f;
     const Vec3 led = {room_x, room_y, room_z};
     const Vec3 center = {room_center_x, room_center_y, room_center_z};
-    if(SegmentHitsOccluderSet(led, center, aabbs, quads, -1, index, grids, merged_field))
-    {
-        shade_factor *= 0.18f;
-    }
-
-    float effective_ao = ao_strength_norm;
-    if(SpatialRoom::IsRoomGridOverlayPass())
+    terms.center_blocked = SegmentHitsOccluderSet(led, center, aabbs, quads, -1, index, grids, merged_field);
+    if(with_openness)
     {
-        effective_ao = 0.0f;
+        terms.openness = ComputeAmbientOcclusion(led, aabbs, quads, probe_span, index, grids, merged_field);
     }
+    return terms;
+}
 
-    if(effective_ao > 0.01f)
+float CombineRoomAmbientShade(const RoomAmbientShadeTerms& terms, float ao_strength_norm)
+{
+    float shade_factor = terms.center_blocked ? 0.18f : 1.0f;
+    if(ao_strength_norm > 0.01f)
     {
-        const float openness = ComputeAmbientOcclusion(led, aabbs, quads, probe_span, index, grids, merged_field);
-        shade_factor *= 1.0f - effective_ao * (1.0f - openness);
+        shade_factor *= 1.0f - ao_strength_norm * (1.0f - terms.openness);
     }
-
     return shade_factor;
 }
 
+float ComputeRoomAmbientShadeFactor(float room_x,
+                                    float room_y,
+                                    float room_z,
+                                    float room_center_x,
+                                    float room_center_y,
+                                    float room_center_z,
+                                    const std::vector<OccluderAabb>& aabbs,
+                                    const std::vector<OccluderQuad>& quads,
+                                    const std::vector<BlockerGridOccluder>& blocker_grids,
+                                    float ao_strength_norm,
+                                    float probe_span,
+                                    const OccluderSpatialIndex* aabb_index,
+                                    const RoomBlockerField* room_blocker_field)
+{
+    const float effective_ao = SpatialRoom::IsRoomGridOverlayPass() ? 0.0f : ao_strength_norm;
+    const RoomAmbientShadeTerms terms = ComputeRoomAmbientShadeTerms(room_x,
+                                                                     room_y,
+                                                                     room_z,
+                                                                     room_center_x,
+                                                                     room_center_y,
+                                                                     room_center_z,
+                                                                     aabbs,
+                                                                     quads,
+                                                                     blocker_grids,
+                                                                     effective_ao > 0.01f,
+                                                                     probe_span,
+                                                                     aabb_index,
+                                                                     room_blocker_field);
+    return CombineRoomAmbientShade(terms, effective_ao);
+}
+
 void BuildOccluderAabbSpatialIndex(const std::vector<OccluderAabb>& aabbs,
                                    const GridContext3D& grid,
                                    OccluderSpatialIndex& out_index)
@@ -434,16 +446,8 @@ static Vector3D ControllerLocalCenterOffset(const ::ControllerTransform* ctrl)
     return ControllerLayout3D::GetLedLocalCenter(ctrl);
 }
 
-static void PushControllerAabbFromPoints(std::vector<OccluderAabb>& out,
-                                         int controller_index,
-                                         const Vec3* points,
-                                         int point_count)
+static OccluderAabb ControllerAabbFromPoints(int controller_index, const Vec3* points, int point_count)
 {
-    if(point_count <= 0)
-    {
-        return;
-    }
-
     OccluderAabb box{};
     box.min = points[0];
     box.max = points[0];
@@ -452,92 +456,95 @@ static void PushControllerAabbFromPoints(std::vector<OccluderAabb>& out,
     {
         ExpandAabbFromPoint(box, points[i]);
     }
-    out.push_back(box);
+    return box;
 }
 
-void AppendControllerOccluders(std::vector<OccluderAabb>& out, float grid_scale_mm)
+bool BuildControllerOccluder(::ControllerTransform* ctrl, int controller_index, float grid_scale_mm, OccluderAabb& out)
 {
-    const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
-        SpatialLightingSceneProvider::instance()->controllers();
-    if(!transforms)
+    if(!ctrl || ctrl->hidden_by_virtual || ctrl->led_positions.empty())
     {
-        return;
+        return false;
     }
 
     const float scale_mm = SafeGridScaleMm(grid_scale_mm);
     const float body_pad = MMToGridUnits(22.0f, scale_mm);
 
-    for(size_t ctrl_index = 0; ctrl_index < transforms->size(); ++ctrl_index)
+    if(ctrl->world_positions_dirty)
     {
-        ::ControllerTransform* ctrl = (*transforms)[ctrl_index].get();
-        if(!ctrl || ctrl->hidden_by_virtual)
-        {
-            continue;
-        }
+        ControllerLayout3D::UpdateWorldPositions(ctrl);
+    }
 
-        const int tag = static_cast<int>(ctrl_index);
-        if(ctrl->led_positions.empty())
-        {
-            continue;
-        }
+    Vector3D local_min{};
+    Vector3D local_max{};
+    ControllerLayout3D::CalculateControllerLocalBounds(ctrl, local_min, local_max);
 
-        if(ctrl->world_positions_dirty)
-        {
-            ControllerLayout3D::UpdateWorldPositions(ctrl);
-        }
+    local_min.x -= body_pad;
+    local_min.y -= body_pad;
+    local_min.z -= body_pad;
+    local_max.x += body_pad;
+    local_max.y += body_pad;
+    local_max.z += body_pad;
 
-        Vector3D local_min{};
-        Vector3D local_max{};
-        ControllerLayout3D::CalculateControllerLocalBounds(ctrl, local_min, local_max);
-
-        local_min.x -= body_pad;
-        local_min.y -= body_pad;
-        local_min.z -= body_pad;
-        local_max.x += body_pad;
-        local_max.y += body_pad;
-        local_max.z += body_pad;
-
-        const float span_x = local_max.x - local_min.x;
-        const float span_y = local_max.y - local_min.y;
-        const float span_z = local_max.z - local_min.z;
-        if(span_x < body_pad)
-        {
-            const float cx = (local_min.x + local_max.x) * 0.5f;
-            local_min.x = cx - body_pad * 0.5f;
-            local_max.x = cx + body_pad * 0.5f;
-        }
-        if(span_y < body_pad)
-        {
-            const float cy = (local_min.y + local_max.y) * 0.5f;
-            local_min.y = cy - body_pad * 0.5f;
-            local_max.y = cy + body_pad * 0.5f;
-        }
-        if(span_z < body_pad)
-        {
-            const float cz = (local_min.z + local_max.z) * 0.5f;
-            local_min.z = cz - body_pad * 0.5f;
-            local_max.z = cz + body_pad * 0.5f;
-        }
+    const float span_x = local_max.x - local_min.x;
+    const float span_y = local_max.y - local_min.y;
+    const float span_z = local_max.z - local_min.z;
+    if(span_x < body_pad)
+    {
+        const float cx = (local_min.x + local_max.x) * 0.5f;
+        local_min.x = cx - body_pad * 0.5f;
+        local_max.x = cx + body_pad * 0.5f;
+    }
+    if(span_y < body_pad)
+    {
+        const float cy = (local_min.y + local_max.y) * 0.5f;
+        local_min.y = cy - body_pad * 0.5f;
+        local_max.y = cy + body_pad * 0.5f;
+    }
+    if(span_z < body_pad)
+    {
+        const float cz = (local_min.z + local_max.z) * 0.5f;
+        local_min.z = cz - body_pad * 0.5f;
+        local_max.z = cz + body_pad * 0.5f;
+    }
+
+    const Vector3D center_offset = ControllerLocalCenterOffset(ctrl);
+    const Vector3D local_corners[8] = {
+        {local_min.x, local_min.y, local_min.z},
+        {local_max.x, local_min.y, local_min.z},
+        {local_min.x, local_max.y, local_min.z},
+        {local_max.x, local_max.y, local_min.z},
+        {local_min.x, local_min.y, local_max.z},
+        {local_max.x, local_min.y, local_max.z},
+        {local_min.x, local_max.y, local_max.z},
+        {local_max.x, local_max.y, local_max.z},
+    };
+
+    Vec3 world_corners[8];
+    for(int i = 0; i < 8; ++i)
+    {
+        world_corners[i] = ControllerLocalToWorld(ctrl, local_corners[i], center_offset);
+    }
+
+    out = ControllerAabbFromPoints(controller_index, world_corners, 8);
+    return true;
+}
+
+void AppendControllerOccluders(std::vector<OccluderAabb>& out, float grid_scale_mm)
+{
+    const std::vector<std::unique_ptr<::ControllerTransform>>* transforms =
+        SpatialLightingSceneProvider::instance()->frameControllers();
+    if(!transforms)
+    {
+        return;
+    }
 
-        const Vector3D center_offset = ControllerLocalCenterOffset(ctrl);
-        const Vector3D local_corners[8] = {
-            {local_min.x, local_min.y, local_min.z},
-            {local_max.x, local_min.y, local_min.z},
-            {local_min.x, local_max.y, local_min.z},
-            {local_max.x, local_max.y, local_min.z},
-            {local_min.x, local_min.y, local_max.z},
-            {local_max.x, local_min.y, local_max.z},
-            {local_min.x, local_max.y, local_max.z},
-            {local_max.x, local_max.y, local_max.z},
-        };
-
-        Vec3 world_corners[8];
-        for(int i = 0; i < 8; ++i)
+    for(size_t ctrl_index = 0; ctrl_index < transforms->size(); ++ctrl_index)
+    {
+        OccluderAabb box{};
+        if(BuildControllerOccluder((*transforms)[ctrl_index].get(), static_cast<int>(ctrl_index), grid_scale_mm, box))
         {
-            world_corners[i] = ControllerLocalToWorld(ctrl, local_corners[i], center_offset);
+            out.push_back(box);
         }
-
-        PushControllerAabbFromPoints(out, tag, world_corners, 8);
     }
 }
 
@@ -568,51 +575,60 @@ void BuildSpatialOccluders(std::vector<OccluderQuad>& out,
     }
 }
 
-void AppendDisplayPlaneOccluders(std::vector<OccluderQuad>& out, float grid_scale_mm)
+bool BuildDisplayPlaneOccluder(const DisplayPlane3D& plane, float grid_scale_mm, OccluderQuad& out)
 {
+    if(!plane.IsVisible())
+    {
+        return false;
+    }
+
     const float scale_mm = SafeGridScaleMm(grid_scale_mm);
-    for(DisplayPlane3D* plane : DisplayPlaneManager::instance()->GetDisplayPlanes())
+    const float width_units = MMToGridUnits(plane.GetWidthMM(), scale_mm);
+    const float height_units = MMToGridUnits(plane.GetHeightMM(), scale_mm);
+    if(width_units <= 0.0f || height_units <= 0.0f)
     {
-        if(!plane || !plane->IsVisible())
-        {
-            continue;
-        }
+        return false;
+    }
 
-        const float width_units = MMToGridUnits(plane->GetWidthMM(), scale_mm);
-        const float height_units = MMToGridUnits(plane->GetHeightMM(), scale_mm);
-        if(width_units <= 0.0f || height_units <= 0.0f)
-        {
-            continue;
-        }
+    const float half_w = width_units * 0.5f;
+    const float half_h = height_units * 0.5f;
+    const Vector3D local_corners[4] = {
+        {-half_w, -half_h, 0.0f},
+        {half_w, -half_h, 0.0f},
+        {half_w, half_h, 0.0f},
+        {-half_w, half_h, 0.0f},
+    };
 
-        const float half_w = width_units * 0.5f;
-        const float half_h = height_units * 0.5f;
-        const Vector3D local_corners[4] = {
-            {-half_w, -half_h, 0.0f},
-            {half_w, -half_h, 0.0f},
-            {half_w, half_h, 0.0f},
-            {-half_w, half_h, 0.0f},
-        };
+    OccluderQuad quad;
+    for(int i = 0; i < 4; ++i)
+    {
+        const Vector3D world = Geometry3D::TransformDisplayPlaneLocalToWorld(local_corners[i], plane.GetTransform());
+        quad.corners[i] = ToVec3(world);
+    }
 
+    const Vec3 e1 = Sub(quad.corners[1], quad.corners[0]);
+    const Vec3 e2 = Sub(quad.corners[3], quad.corners[0]);
+    const Vec3 n = {
+        e1.y * e2.z - e1.z * e2.y,
+        e1.z * e2.x - e1.x * e2.z,
+        e1.x * e2.y - e1.y * e2.x,
+    };
+    quad.normal = Normalize(n);
+    quad.double_sided = true;
+    quad.controller_index = -1;
+    out = quad;
+    return true;
+}
+
+void AppendDisplayPlaneOccluders(std::vector<OccluderQuad>& out, float grid_scale_mm)
+{
+    for(DisplayPlane3D* plane : DisplayPlaneManager::instance()->GetDisplayPlanes())
+    {
         OccluderQuad quad;
-        for(int i = 0; i < 4; ++i)
+        if(plane && BuildDisplayPlaneOccluder(*plane, grid_scale_mm, quad))
         {
-            const Vector3D world =
-                Geometry3D::TransformDisplayPlaneLocalToWorld(local_corners[i], plane->GetTransform());
-            quad.corners[i] = ToVec3(world);
+            out.push_back(quad);
         }
-
-        const Vec3 e1 = Sub(quad.corners[1], quad.corners[0]);
-        const Vec3 e2 = Sub(quad.corners[3], quad.corners[0]);
-        const Vec3 n = {
-            e1.y * e2.z - e1.z * e2.y,
-            e1.z * e2.x - e1.x * e2.z,
-            e1.x * e2.y - e1.y * e2.x,
-        };
-        quad.normal = Normalize(n);
-        quad.double_sided = true;
-        quad.controller_index = -1;
-        out.push_back(quad);
     }
 }
 
@@ -16,6 +16,7 @@ class OccluderSpatialIndex;
 }
 
 struct GridContext3D;
+class DisplayPlane3D;
 
 #include "SpatialLighting/BlockerGridOccluder.h"
 
@@ -99,6 +100,9 @@ struct RoomScene
     ShadeSettings shade{};
 };
 
+/** One display plane's quad; false when it is hidden or has no area. */
+bool BuildDisplayPlaneOccluder(const DisplayPlane3D& plane, float grid_scale_mm, OccluderQuad& out);
+
 /** Build occluders from visible display planes (room grid units). */
 void AppendDisplayPlaneOccluders(std::vector<OccluderQuad>& out, float grid_scale_mm);
 
@@ -110,6 +114,9 @@ void AppendRoomWallOccluders(std::vector<OccluderQuad>& out,
                              float max_y,
                              float max_z);
 
+/** One controller's padded body box tagged with controller_index; false when hidden or without LEDs. */
+bool BuildControllerOccluder(::ControllerTransform* ctrl, int controller_index, float grid_scale_mm, OccluderAabb& out);
+
 void AppendControllerOccluders(std::vector<OccluderAabb>& out, float grid_scale_mm);
 
 void BuildSpatialOccluders(std::vector<OccluderQuad>& out,
@@ -121,6 +128,34 @@ Vec3 GridToVec3(float x, float y, float z);
 
 RGBColor ShadeLed(const RoomScene& scene, float led_x, float led_y, float led_z);
 
+/**
+ * Receiver shading split into the parts that depend only on geometry, the room center and the probe span;
+ * AO strength is applied afterwards by CombineRoomAmbientShade, so a baked value survives strength edits.
+ */
+struct RoomAmbientShadeTerms
+{
+    bool center_blocked = false;
+    /** Fraction of the six axis probes that are open; 1 when not computed. */
+    float openness = 1.0f;
+};
+
+RoomAmbientShadeTerms ComputeRoomAmbientShadeTerms(float room_x,
+                                                  float room_y,
+                                                  float room_z,
+                                                  float room_center_x,
+                                                  float room_center_y,
+                                                  float room_center_z,
+                                                  const std::vector<OccluderAabb>& aabbs,
+                                                  const std::vector<OccluderQuad>& quads,
+                                                  const std::vector<BlockerGridOccluder>& blocker_grids,
+                                                  bool with_openness,
+                                                  float probe_span,
+                                                  const OccluderSpatialIndex* aabb_index = nullptr,
+                                                  const RoomBlockerField* room_blocker_field = nullptr);
+
+/** Center shadow times AO darkening; ao_strength_norm <= 0.01 leaves AO out. */
+float CombineRoomAmbientShade(const RoomAmbientShadeTerms& terms, float ao_strength_norm);
+
 /** Receiver shading: center shadow + AO, combined into one multiplier in [0,1]. */
 float ComputeRoomAmbientShadeFactor(float room_x,
                                     float room_y,
@@ -3,10 +3,17 @@
 #include "SpatialLightingSceneProvider.h"
 
 #include "ControllerLayout3D.h"
+#include "DisplayPlane3D.h"
+#include "DisplayPlaneManager.h"
+#include "LedFrameLayout3D.h"
 #include "SpatialEffect3D.h"
 #include "SpatialLighting/BlockerGridOccluder.h"
+#include "SpatialRoom/SpatialRoomFrame.h"
+#include "VirtualController3D.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 
 SpatialLightingSceneProvider* SpatialLightingSceneProvider::instance()
 {
@@ -17,9 +24,16 @@ SpatialLightingSceneProvider* SpatialLightingSceneProvider::instance()
 void SpatialLightingSceneProvider::SetControllers(
     const std::vector<std::unique_ptr<ControllerTransform>>* transforms)
 {
-    if(controllers_ != transforms)
+    controllers_ = transforms;
+}
+
+void SpatialLightingSceneProvider::SetFrameControllers(
+    std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>> transforms)
+{
+    if(frame_controllers_ != transforms)
     {
-        controllers_ = transforms;
+        // A new copy usually differs in a few transforms: re-derive and apply only what moved.
+        frame_controllers_ = std::move(transforms);
         InvalidateFrameOccluders();
     }
 }
@@ -45,43 +59,546 @@ bool SpatialLightingSceneProvider::isEmitterController(int controller_index) con
     return emitter_controller_indices_.find(controller_index) != emitter_controller_indices_.end();
 }
 
+namespace
+{
+
+/** FNV-1a over the raw bytes of each field; only compared against itself, never persisted. */
+class TransformHasher
+{
+public:
+    template<typename T>
+    void Add(const T& value)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for(size_t i = 0; i < sizeof(T); ++i)
+        {
+            hash_ = (hash_ ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+
+    void Add(const Transform3D& transform)
+    {
+        Add(transform.position.x);
+        Add(transform.position.y);
+        Add(transform.position.z);
+        Add(transform.rotation.x);
+        Add(transform.rotation.y);
+        Add(transform.rotation.z);
+        Add(transform.scale.x);
+        Add(transform.scale.y);
+        Add(transform.scale.z);
+    }
+
+    std::uint64_t Value() const { return hash_; }
+
+private:
+    std::uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+/**
+ * Everything the controller's body box and blocker grid read besides LED local positions; layout edits
+ * that move LEDs go through MarkWorldPositionsDirty, which makes the next ensure re-derive every object.
+ */
+std::uint64_t HashControllerTransform(const ControllerTransform* ctrl)
+{
+    TransformHasher hasher;
+    if(!ctrl)
+    {
+        return hasher.Value();
+    }
+    hasher.Add(ctrl->transform);
+    hasher.Add(ctrl->hidden_by_virtual);
+    hasher.Add(ctrl->led_positions.size());
+    hasher.Add(ctrl->virtual_controller);
+    if(ctrl->virtual_controller)
+    {
+        hasher.Add(ctrl->virtual_controller->GetWidth());
+        hasher.Add(ctrl->virtual_controller->GetHeight());
+        hasher.Add(ctrl->virtual_controller->GetDepth());
+        for(const CustomControllerLightBlocker& blocker : ctrl->virtual_controller->GetLightBlockers())
+        {
+            hasher.Add(blocker.x);
+            hasher.Add(blocker.y);
+            hasher.Add(blocker.z);
+        }
+    }
+    return hasher.Value();
+}
+
+std::uint64_t HashDisplayPlane(const DisplayPlane3D& plane)
+{
+    TransformHasher hasher;
+    hasher.Add(plane.GetTransform());
+    hasher.Add(plane.GetWidthMM());
+    hasher.Add(plane.GetHeightMM());
+    hasher.Add(plane.IsVisible());
+    return hasher.Value();
+}
+
+/** Room walls and the index extent follow the grid box; a change there rebuilds everything. */
+std::uint64_t HashOccluderGrid(const GridContext3D& grid)
+{
+    TransformHasher hasher;
+    hasher.Add(grid.min_x);
+    hasher.Add(grid.min_y);
+    hasher.Add(grid.min_z);
+    hasher.Add(grid.max_x);
+    hasher.Add(grid.max_y);
+    hasher.Add(grid.max_z);
+    hasher.Add(grid.grid_scale_mm);
+    return hasher.Value();
+}
+
+bool SameVec3(const SpatialLighting::Vec3& a, const SpatialLighting::Vec3& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool SameAabb(const SpatialLighting::OccluderAabb& a, const SpatialLighting::OccluderAabb& b)
+{
+    return SameVec3(a.min, b.min) && SameVec3(a.max, b.max) && a.controller_index == b.controller_index;
+}
+
+bool SameQuad(const SpatialLighting::OccluderQuad& a, const SpatialLighting::OccluderQuad& b)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        if(!SameVec3(a.corners[i], b.corners[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameBlockerGrid(const SpatialLighting::BlockerGridOccluder& a, const SpatialLighting::BlockerGridOccluder& b)
+{
+    return a.controller_index == b.controller_index && a.width == b.width && a.height == b.height &&
+           a.depth == b.depth && a.world_min.x == b.world_min.x && a.world_min.y == b.world_min.y &&
+           a.world_min.z == b.world_min.z && a.world_max.x == b.world_max.x && a.world_max.y == b.world_max.y &&
+           a.world_max.z == b.world_max.z && a.x_edges == b.x_edges && a.y_edges == b.y_edges &&
+           a.z_edges == b.z_edges && a.dense_cells == b.dense_cells;
+}
+
+SpatialLighting::Vec3 ToVec3(const Vector3D& v)
+{
+    return {v.x, v.y, v.z};
+}
+
+/** Quad hits accept a 2% UV margin (SegmentHitsFiniteQuad); pad the corner box to match. */
+void QuadBounds(const SpatialLighting::OccluderQuad& quad, SpatialLighting::Vec3& min, SpatialLighting::Vec3& max, float& pad)
+{
+    min = quad.corners[0];
+    max = quad.corners[0];
+    for(int i = 1; i < 4; ++i)
+    {
+        min.x = std::min(min.x, quad.corners[i].x);
+        min.y = std::min(min.y, quad.corners[i].y);
+        min.z = std::min(min.z, quad.corners[i].z);
+        max.x = std::max(max.x, quad.corners[i].x);
+        max.y = std::max(max.y, quad.corners[i].y);
+        max.z = std::max(max.z, quad.corners[i].z);
+    }
+    const float span = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+    pad = span * 0.03f;
+}
+
+/** Padding for AABB regions so float noise at a face never keeps a stale entry. */
+constexpr float kShadeDirtyPad = 1e-3f;
+
+} // namespace
+
 void SpatialLightingSceneProvider::InvalidateFrameOccluders()
 {
-    frame_occluders_valid_ = false;
-    frame_occluder_index_.Clear();
-    frame_blocker_grids_.clear();
-    frame_room_blocker_field_ = SpatialLighting::RoomBlockerField{};
-    ++scene_geometry_epoch_;
+    // The render worker may be walking the index / blocker grids right now; leave the
+    // containers alone and let EnsureFrameOccluders update them at the start of its next frame.
+    frame_occluders_valid_.store(false);
 }
 
 void SpatialLightingSceneProvider::EnsureFrameOccluders(const GridContext3D& grid,
                                                         const SpatialLighting::OccluderBuildOptions& options)
 {
-    if(frame_occluders_valid_ && frame_occluder_options_.display_planes == options.display_planes &&
-       frame_occluder_options_.room_walls == options.room_walls &&
-       frame_occluder_options_.controllers == options.controllers &&
-       frame_occluder_options_.light_blockers == options.light_blockers)
+    const bool options_match = frame_occluder_options_.display_planes == options.display_planes &&
+                               frame_occluder_options_.room_walls == options.room_walls &&
+                               frame_occluder_options_.controllers == options.controllers &&
+                               frame_occluder_options_.light_blockers == options.light_blockers;
+    const std::size_t controller_count = frame_controllers_ ? frame_controllers_->size() : 0u;
+    if(!frame_occluders_built_ || !options_match ||
+       controller_records_.size() != controller_count || frame_occluder_grid_hash_ != HashOccluderGrid(grid))
     {
+        RebuildFrameOccluders(grid, options);
         return;
     }
 
-    frame_occluder_quads_.clear();
+    // Cleared before the update so an invalidate that lands mid-update is not lost.
+    const bool rederive_all = !frame_occluders_valid_.exchange(true);
+    UpdateControllerOccluders(grid, rederive_all);
+    UpdateDisplayPlaneOccluders(grid, rederive_all);
+}
+
+void SpatialLightingSceneProvider::RebuildFrameOccluders(const GridContext3D& grid,
+                                                         const SpatialLighting::OccluderBuildOptions& options)
+{
+    frame_occluders_valid_.store(true);
+    frame_occluder_options_ = options;
+    frame_occluder_grid_hash_ = HashOccluderGrid(grid);
+
     frame_occluder_aabbs_.clear();
     frame_occluder_index_.Clear();
     frame_blocker_grids_.clear();
     frame_room_blocker_field_ = SpatialLighting::RoomBlockerField{};
-    SpatialLighting::BuildSpatialOccluders(frame_occluder_quads_, frame_occluder_aabbs_, grid, options);
+    controller_records_.assign(frame_controllers_ ? frame_controllers_->size() : 0u, ControllerOccluderRecord{});
+    for(size_t ctrl_index = 0; ctrl_index < controller_records_.size(); ++ctrl_index)
+    {
+        ControllerTransform* ctrl = (*frame_controllers_)[ctrl_index].get();
+        ControllerOccluderRecord& record = controller_records_[ctrl_index];
+        record.transform_hash = HashControllerTransform(ctrl);
+
+        SpatialLighting::OccluderAabb box{};
+        if(options.controllers &&
+           SpatialLighting::BuildControllerOccluder(ctrl, static_cast<int>(ctrl_index), grid.grid_scale_mm, box))
+        {
+            record.aabb_slot = static_cast<int>(frame_occluder_aabbs_.size());
+            frame_occluder_aabbs_.push_back(box);
+        }
+        SpatialLighting::BlockerGridOccluder blocker_grid{};
+        if(options.light_blockers &&
+           SpatialLighting::BuildBlockerGridOccluder(ctrl, static_cast<int>(ctrl_index), grid.grid_scale_mm, blocker_grid))
+        {
+            record.blocker_slot = static_cast<int>(frame_blocker_grids_.size());
+            frame_blocker_grids_.push_back(std::move(blocker_grid));
+        }
+    }
     if(options.light_blockers)
     {
-        SpatialLighting::BuildBlockerGridOccluders(frame_blocker_grids_, grid.grid_scale_mm);
         SpatialLighting::BuildRoomBlockerField(frame_room_blocker_field_, grid.grid_scale_mm, &grid);
     }
     SpatialLighting::BuildOccluderAabbSpatialIndex(frame_occluder_aabbs_, grid, frame_occluder_index_);
-    frame_occluder_options_ = options;
-    frame_occluders_valid_ = true;
+
+    BuildQuadOccluders(DisplayPlaneManager::instance()->GetDisplayPlanes(), grid);
+
+    frame_occluders_built_ = true;
     ++scene_geometry_epoch_;
 }
 
+void SpatialLightingSceneProvider::BuildQuadOccluders(const std::vector<DisplayPlane3D*>& planes,
+                                                      const GridContext3D& grid)
+{
+    frame_occluder_quads_.clear();
+    plane_records_.assign(planes.size(), DisplayPlaneOccluderRecord{});
+    for(size_t plane_index = 0; plane_index < planes.size(); ++plane_index)
+    {
+        const DisplayPlane3D* plane = planes[plane_index];
+        DisplayPlaneOccluderRecord& record = plane_records_[plane_index];
+        if(!plane)
+        {
+            continue;
+        }
+        record.plane_id = plane->GetId();
+        record.transform_hash = HashDisplayPlane(*plane);
+
+        SpatialLighting::OccluderQuad quad;
+        if(frame_occluder_options_.display_planes &&
+           SpatialLighting::BuildDisplayPlaneOccluder(*plane, grid.grid_scale_mm, quad))
+        {
+            record.quad_slot = static_cast<int>(frame_occluder_quads_.size());
+            frame_occluder_quads_.push_back(quad);
+        }
+    }
+    if(frame_occluder_options_.room_walls)
+    {
+        SpatialLighting::AppendRoomWallOccluders(frame_occluder_quads_,
+                                                 grid.min_x,
+                                                 grid.min_y,
+                                                 grid.min_z,
+                                                 grid.max_x,
+                                                 grid.max_y,
+                                                 grid.max_z);
+    }
+}
+
+void SpatialLightingSceneProvider::UpdateControllerOccluders(const GridContext3D& grid, bool rederive_all)
+{
+    struct PendingController
+    {
+        size_t ctrl_index = 0;
+        bool has_box = false;
+        SpatialLighting::OccluderAabb box{};
+        bool has_blocker_grid = false;
+        bool blocker_grid_changed = false;
+        SpatialLighting::BlockerGridOccluder blocker_grid{};
+    };
+    std::vector<PendingController> pending;
+
+    for(size_t ctrl_index = 0; ctrl_index < controller_records_.size(); ++ctrl_index)
+    {
+        ControllerTransform* ctrl = (*frame_controllers_)[ctrl_index].get();
+        ControllerOccluderRecord& record = controller_records_[ctrl_index];
+        const std::uint64_t hash = HashControllerTransform(ctrl);
+        if(!rederive_all && hash == record.transform_hash)
+        {
+            continue;
+        }
+        record.transform_hash = hash;
+
+        PendingController next;
+        next.ctrl_index = ctrl_index;
+        next.has_box = frame_occluder_options_.controllers &&
+                       SpatialLighting::BuildControllerOccluder(ctrl, static_cast<int>(ctrl_index), grid.grid_scale_mm, next.box);
+        next.has_blocker_grid = frame_occluder_options_.light_blockers &&
+                                SpatialLighting::BuildBlockerGridOccluder(ctrl,
+                                                                          static_cast<int>(ctrl_index),
+                                                                          grid.grid_scale_mm,
+                                                                          next.blocker_grid);
+        pending.push_back(std::move(next));
+    }
+    if(pending.empty())
+    {
+        return;
+    }
+
+    bool aabb_slots_changed = false;
+    bool blocker_slots_changed = false;
+    bool rebuild_index = false;
+    std::vector<SpatialLighting::BlockerGridOccluder> removed_blockers;
+    for(PendingController& next : pending)
+    {
+        const ControllerOccluderRecord& record = controller_records_[next.ctrl_index];
+
+        if(record.aabb_slot >= 0 && next.has_box)
+        {
+            SpatialLighting::OccluderAabb& box = frame_occluder_aabbs_[static_cast<size_t>(record.aabb_slot)];
+            if(!SameAabb(box, next.box))
+            {
+                MarkShadeDirty(box.min, box.max, kShadeDirtyPad);
+                MarkShadeDirty(next.box.min, next.box.max, kShadeDirtyPad);
+                if(!frame_occluder_index_.UpdateEntry(static_cast<uint16_t>(record.aabb_slot), box, next.box))
+                {
+                    rebuild_index = true;
+                }
+                box = next.box;
+            }
+        }
+        else if(record.aabb_slot >= 0 || next.has_box)
+        {
+            const SpatialLighting::OccluderAabb& box =
+                next.has_box ? next.box : frame_occluder_aabbs_[static_cast<size_t>(record.aabb_slot)];
+            MarkShadeDirty(box.min, box.max, kShadeDirtyPad);
+            aabb_slots_changed = true;
+        }
+
+        if(record.blocker_slot >= 0 && next.has_blocker_grid)
+        {
+            SpatialLighting::BlockerGridOccluder& blocker_grid =
+                frame_blocker_grids_[static_cast<size_t>(record.blocker_slot)];
+            if(!SameBlockerGrid(blocker_grid, next.blocker_grid))
+            {
+                removed_blockers.push_back(std::move(blocker_grid));
+                blocker_grid = next.blocker_grid;
+                next.blocker_grid_changed = true;
+            }
+        }
+        else if(record.blocker_slot >= 0)
+        {
+            removed_blockers.push_back(frame_blocker_grids_[static_cast<size_t>(record.blocker_slot)]);
+            blocker_slots_changed = true;
+        }
+        else if(next.has_blocker_grid)
+        {
+            next.blocker_grid_changed = true;
+            blocker_slots_changed = true;
+        }
+    }
+
+    // A box or blocker grid appeared or vanished: re-pack the list in controller order, reusing every
+    // unchanged entry, and reassign slots.
+    if(aabb_slots_changed || blocker_slots_changed)
+    {
+        std::vector<const PendingController*> pending_by_controller(controller_records_.size(), nullptr);
+        for(const PendingController& next : pending)
+        {
+            pending_by_controller[next.ctrl_index] = &next;
+        }
+
+        std::vector<SpatialLighting::OccluderAabb> aabbs;
+        std::vector<SpatialLighting::BlockerGridOccluder> blocker_grids;
+        for(size_t ctrl_index = 0; ctrl_index < controller_records_.size(); ++ctrl_index)
+        {
+            ControllerOccluderRecord& record = controller_records_[ctrl_index];
+            const PendingController* next = pending_by_controller[ctrl_index];
+
+            const SpatialLighting::OccluderAabb* box = nullptr;
+            if(next)
+            {
+                box = next->has_box ? &next->box : nullptr;
+            }
+            else if(record.aabb_slot >= 0)
+            {
+                box = &frame_occluder_aabbs_[static_cast<size_t>(record.aabb_slot)];
+            }
+            record.aabb_slot = box ? static_cast<int>(aabbs.size()) : -1;
+            if(box)
+            {
+                aabbs.push_back(*box);
+            }
+
+            const int old_blocker_slot = record.blocker_slot;
+            record.blocker_slot = -1;
+            if(next ? next->has_blocker_grid : old_blocker_slot >= 0)
+            {
+                record.blocker_slot = static_cast<int>(blocker_grids.size());
+                blocker_grids.push_back(next ? next->blocker_grid
+                                             : frame_blocker_grids_[static_cast<size_t>(old_blocker_slot)]);
+            }
+        }
+        frame_occluder_aabbs_ = std::move(aabbs);
+        frame_blocker_grids_ = std::move(blocker_grids);
+        rebuild_index = rebuild_index || aabb_slots_changed;
+    }
+
+    if(rebuild_index)
+    {
+        SpatialLighting::BuildOccluderAabbSpatialIndex(frame_occluder_aabbs_, grid, frame_occluder_index_);
+    }
+
+    std::vector<const SpatialLighting::BlockerGridOccluder*> moved_blockers;
+    for(const PendingController& next : pending)
+    {
+        if(next.blocker_grid_changed)
+        {
+            const int slot = controller_records_[next.ctrl_index].blocker_slot;
+            moved_blockers.push_back(&frame_blocker_grids_[static_cast<size_t>(slot)]);
+        }
+    }
+
+    // The merged blocker field is sized around every blocker, so any blocker change re-rasterizes it.
+    if(moved_blockers.empty() && removed_blockers.empty())
+    {
+        return;
+    }
+    const SpatialLighting::RoomBlockerField old_field = std::move(frame_room_blocker_field_);
+    frame_room_blocker_field_ = SpatialLighting::RoomBlockerField{};
+    SpatialLighting::BuildRoomBlockerField(frame_room_blocker_field_, grid.grid_scale_mm, &grid);
+
+    // Blockers are marked over whole field cells, so a blocker reaches up to one cell past its box.
+    const float field_pad = std::max(old_field.IsValid() ? old_field.cell_size : 0.0f,
+                                     frame_room_blocker_field_.IsValid() ? frame_room_blocker_field_.cell_size : 0.0f) +
+                            kShadeDirtyPad;
+    const bool field_moved = old_field.origin_x != frame_room_blocker_field_.origin_x ||
+                             old_field.origin_y != frame_room_blocker_field_.origin_y ||
+                             old_field.origin_z != frame_room_blocker_field_.origin_z ||
+                             old_field.cell_size != frame_room_blocker_field_.cell_size;
+    if(field_moved)
+    {
+        // Re-quantized: unchanged blockers may cover different cells too.
+        for(const SpatialLighting::BlockerGridOccluder& blocker_grid : frame_blocker_grids_)
+        {
+            MarkShadeDirty(ToVec3(blocker_grid.world_min), ToVec3(blocker_grid.world_max), field_pad);
+        }
+    }
+    else
+    {
+        for(const SpatialLighting::BlockerGridOccluder* blocker_grid : moved_blockers)
+        {
+            MarkShadeDirty(ToVec3(blocker_grid->world_min), ToVec3(blocker_grid->world_max), field_pad);
+        }
+    }
+    for(const SpatialLighting::BlockerGridOccluder& blocker_grid : removed_blockers)
+    {
+        MarkShadeDirty(ToVec3(blocker_grid.world_min), ToVec3(blocker_grid.world_max), field_pad);
+    }
+}
+
+void SpatialLightingSceneProvider::UpdateDisplayPlaneOccluders(const GridContext3D& grid, bool rederive_all)
+{
+    const std::vector<DisplayPlane3D*> planes = DisplayPlaneManager::instance()->GetDisplayPlanes();
+    bool changed = rederive_all || planes.size() != plane_records_.size();
+    for(size_t plane_index = 0; !changed && plane_index < planes.size(); ++plane_index)
+    {
+        const DisplayPlane3D* plane = planes[plane_index];
+        const DisplayPlaneOccluderRecord& record = plane_records_[plane_index];
+        changed = !plane || plane->GetId() != record.plane_id || HashDisplayPlane(*plane) != record.transform_hash;
+    }
+    if(!changed)
+    {
+        return;
+    }
+
+    // A handful of unindexed quads: rebuild the list, then diff per plane id for the shade regions.
+    const std::vector<DisplayPlaneOccluderRecord> old_records = std::move(plane_records_);
+    const std::vector<SpatialLighting::OccluderQuad> old_quads = frame_occluder_quads_;
+    BuildQuadOccluders(planes, grid);
+
+    const auto find_quad = [](const std::vector<DisplayPlaneOccluderRecord>& records,
+                              const std::vector<SpatialLighting::OccluderQuad>& quads,
+                              int plane_id) -> const SpatialLighting::OccluderQuad* {
+        for(const DisplayPlaneOccluderRecord& record : records)
+        {
+            if(record.plane_id == plane_id)
+            {
+                return record.quad_slot >= 0 ? &quads[static_cast<size_t>(record.quad_slot)] : nullptr;
+            }
+        }
+        return nullptr;
+    };
+    const auto mark_quad = [this](const SpatialLighting::OccluderQuad& quad) {
+        SpatialLighting::Vec3 min;
+        SpatialLighting::Vec3 max;
+        float pad = 0.0f;
+        QuadBounds(quad, min, max, pad);
+        MarkShadeDirty(min, max, pad + kShadeDirtyPad);
+    };
+
+    for(const DisplayPlaneOccluderRecord& record : plane_records_)
+    {
+        const SpatialLighting::OccluderQuad* now = find_quad(plane_records_, frame_occluder_quads_, record.plane_id);
+        const SpatialLighting::OccluderQuad* before = find_quad(old_records, old_quads, record.plane_id);
+        if(now && before && SameQuad(*now, *before))
+        {
+            continue;
+        }
+        if(now)
+        {
+            mark_quad(*now);
+        }
+        if(before)
+        {
+            mark_quad(*before);
+        }
+    }
+    for(const DisplayPlaneOccluderRecord& record : old_records)
+    {
+        const SpatialLighting::OccluderQuad* before = find_quad(old_records, old_quads, record.plane_id);
+        if(before && !find_quad(plane_records_, frame_occluder_quads_, record.plane_id))
+        {
+            mark_quad(*before);
+        }
+    }
+}
+
+void SpatialLightingSceneProvider::MarkShadeDirty(SpatialLighting::Vec3 min, SpatialLighting::Vec3 max, float pad)
+{
+    SpatialLighting::OccluderAabb& region = shade_dirty_regions_[shade_dirty_serial_ % kMaxShadeDirtyRegions];
+    region.min = {min.x - pad, min.y - pad, min.z - pad};
+    region.max = {max.x + pad, max.y + pad, max.z + pad};
+    ++shade_dirty_serial_;
+}
+
+bool SpatialLightingSceneProvider::PendingShadeDirtyRegions(std::uint64_t applied_serial,
+                                                            std::vector<SpatialLighting::OccluderAabb>& out) const
+{
+    out.clear();
+    if(shade_dirty_serial_ - applied_serial > kMaxShadeDirtyRegions)
+    {
+        return false;
+    }
+    for(std::uint64_t serial = applied_serial; serial < shade_dirty_serial_; ++serial)
+    {
+        out.push_back(shade_dirty_regions_[serial % kMaxShadeDirtyRegions]);
+    }
+    return true;
+}
+
 namespace
 {
 
@@ -94,46 +611,270 @@ std::uint64_t PackAmbientShadeKey(float x, float y, float z, float quant)
     return q(x) | (q(y) << 21) | (q(z) << 42);
 }
 
-struct AmbientShadeCacheEntry
+/** Terms are reusable for any AO strength; openness only when the entry traced it. */
+bool ShadeCacheEntryMatches(const AmbientShadeCacheEntry& entry,
+                            float room_center_x,
+                            float room_center_y,
+                            float room_center_z,
+                            float probe_span,
+                            bool need_openness)
 {
-    float shade_factor = 1.0f;
-    float room_center_x = 0.0f;
-    float room_center_y = 0.0f;
-    float room_center_z = 0.0f;
-    float ao_strength_norm = 0.0f;
-    float probe_span = 0.0f;
-};
+    constexpr float kEps = 1e-4f;
+    return entry.valid && (!need_openness || entry.openness >= 0.0f) &&
+           std::fabs(entry.room_center_x - room_center_x) < kEps && std::fabs(entry.room_center_y - room_center_y) < kEps &&
+           std::fabs(entry.room_center_z - room_center_z) < kEps && std::fabs(entry.probe_span - probe_span) < kEps;
+}
 
-bool ShadeCacheParamsMatch(const AmbientShadeCacheEntry& entry,
-                           float room_center_x,
-                           float room_center_y,
-                           float room_center_z,
-                           float ao_strength_norm,
-                           float probe_span)
+float ShadeFactorFromEntry(const AmbientShadeCacheEntry& entry, float effective_ao)
 {
-    constexpr float kEps = 1e-4f;
-    return std::fabs(entry.room_center_x - room_center_x) < kEps && std::fabs(entry.room_center_y - room_center_y) < kEps &&
-           std::fabs(entry.room_center_z - room_center_z) < kEps &&
-           std::fabs(entry.ao_strength_norm - ao_strength_norm) < kEps && std::fabs(entry.probe_span - probe_span) < kEps;
+    SpatialLighting::RoomAmbientShadeTerms terms;
+    terms.center_blocked = entry.center_blocked;
+    terms.openness = std::max(entry.openness, 0.0f);
+    return SpatialLighting::CombineRoomAmbientShade(terms, effective_ao);
+}
+
+/**
+ * ComputeRoomAmbientShadeFactor only looks along the receiver -> room center segment and six axis probes of
+ * probe_span, so an occluder change inside region can only alter entries whose segment or probes reach it.
+ */
+bool ShadeEntryReachesRegion(const AmbientShadeCacheEntry& entry, const SpatialLighting::OccluderAabb& region)
+{
+    const float reach = std::max(entry.probe_span, 0.15f);
+    if(entry.room_x >= region.min.x - reach && entry.room_x <= region.max.x + reach &&
+       entry.room_y >= region.min.y - reach && entry.room_y <= region.max.y + reach &&
+       entry.room_z >= region.min.z - reach && entry.room_z <= region.max.z + reach)
+    {
+        return true;
+    }
+
+    const float origin[3] = {entry.room_x, entry.room_y, entry.room_z};
+    const float delta[3] = {entry.room_center_x - entry.room_x,
+                            entry.room_center_y - entry.room_y,
+                            entry.room_center_z - entry.room_z};
+    const float lo[3] = {region.min.x, region.min.y, region.min.z};
+    const float hi[3] = {region.max.x, region.max.y, region.max.z};
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        if(std::fabs(delta[axis]) < 1e-8f)
+        {
+            if(origin[axis] < lo[axis] || origin[axis] > hi[axis])
+            {
+                return false;
+            }
+            continue;
+        }
+        const float inv = 1.0f / delta[axis];
+        float t_near = (lo[axis] - origin[axis]) * inv;
+        float t_far = (hi[axis] - origin[axis]) * inv;
+        if(t_near > t_far)
+        {
+            std::swap(t_near, t_far);
+        }
+        t0 = std::max(t0, t_near);
+        t1 = std::min(t1, t_far);
+        if(t0 > t1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShadeEntryReachesAny(const AmbientShadeCacheEntry& entry, const std::vector<SpatialLighting::OccluderAabb>& regions)
+{
+    for(const SpatialLighting::OccluderAabb& region : regions)
+    {
+        if(ShadeEntryReachesRegion(entry, region))
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 thread_local std::unordered_map<std::uint64_t, AmbientShadeCacheEntry> g_shade_position_cache;
-thread_local std::unordered_map<int, AmbientShadeCacheEntry> g_shade_slot_cache;
-thread_local std::uint64_t g_shade_cache_geometry_epoch = 0;
+thread_local std::uint64_t g_shade_position_cache_epoch = 0;
+thread_local std::uint64_t g_shade_position_cache_dirty_serial = 0;
+
+thread_local int g_shading_controller_index = -1;
 
 } // namespace
 
-void SpatialLightingSceneProvider::BeginAmbientShadeCacheFrame(float quant_size)
+void SpatialLightingSceneProvider::SetShadingControllerIndex(int index)
+{
+    g_shading_controller_index = index;
+}
+
+int SpatialLightingSceneProvider::shadingControllerIndex() const
+{
+    return g_shading_controller_index;
+}
+
+void SpatialLightingSceneProvider::SyncAmbientShadeSlots(AmbientShadeSlotBuffer& buffer,
+                                                         std::uint64_t layout_key,
+                                                         std::size_t slot_count)
 {
-    if(g_shade_cache_geometry_epoch != scene_geometry_epoch_)
+    const std::uint64_t geometry_epoch = scene_geometry_epoch_.load();
+    if(buffer.geometry_epoch != geometry_epoch || buffer.layout_key != layout_key)
     {
-        g_shade_position_cache.clear();
-        g_shade_slot_cache.clear();
-        g_shade_cache_geometry_epoch = scene_geometry_epoch_;
+        buffer.entries.clear();
+        buffer.geometry_epoch = geometry_epoch;
+        buffer.layout_key = layout_key;
+        buffer.dirty_serial = shade_dirty_serial_;
+    }
+    else if(buffer.dirty_serial != shade_dirty_serial_)
+    {
+        thread_local std::vector<SpatialLighting::OccluderAabb> regions;
+        if(PendingShadeDirtyRegions(buffer.dirty_serial, regions))
+        {
+            for(AmbientShadeCacheEntry& entry : buffer.entries)
+            {
+                if(entry.valid && ShadeEntryReachesAny(entry, regions))
+                {
+                    entry.valid = false;
+                }
+            }
+        }
+        else
+        {
+            buffer.entries.clear();
+        }
+        buffer.dirty_serial = shade_dirty_serial_;
+    }
+    buffer.entries.resize(slot_count);
+}
+
+void SpatialLightingSceneProvider::RemapLedShadeSlots(const LedFrameLayout3D& layout)
+{
+    AmbientShadeSlotBuffer& buffer = led_shade_slots_;
+    std::unordered_map<std::uint64_t, const ShadeSlotSpan*> previous_spans;
+    previous_spans.reserve(led_shade_spans_.size());
+    for(const ShadeSlotSpan& span : led_shade_spans_)
+    {
+        if(span.first + span.count <= buffer.entries.size())
+        {
+            previous_spans.emplace(span.room_key, &span);
+        }
+    }
+
+    // Entries depend only on the LED's room position, so a span whose positions are unchanged keeps them
+    // wherever the recompile placed it; everything else starts unbaked.
+    std::vector<AmbientShadeCacheEntry> entries(layout.size());
+    std::vector<ShadeSlotSpan> spans;
+    spans.reserve(layout.controllers.size());
+    for(const LedFrameLayout3D::ControllerSpan& span : layout.controllers)
+    {
+        std::unordered_map<std::uint64_t, const ShadeSlotSpan*>::const_iterator it = previous_spans.find(span.room_key);
+        if(it != previous_spans.end() && it->second->count == span.count)
+        {
+            std::copy_n(buffer.entries.begin() + static_cast<std::ptrdiff_t>(it->second->first),
+                        span.count,
+                        entries.begin() + static_cast<std::ptrdiff_t>(span.first));
+        }
+        spans.push_back(ShadeSlotSpan{span.room_key, span.first, span.count});
     }
+    buffer.entries.swap(entries);
+    buffer.layout_key = layout.epoch;
+    led_shade_spans_.swap(spans);
+}
+
+void SpatialLightingSceneProvider::BeginAmbientShadeCacheFrame(float quant_size, const LedFrameLayout3D* slot_layout)
+{
+    const std::uint64_t layout_key = slot_layout ? slot_layout->epoch : 0;
+    if(slot_layout && led_shade_slots_.layout_key != layout_key)
+    {
+        RemapLedShadeSlots(*slot_layout);
+    }
+    SyncAmbientShadeSlots(led_shade_slots_, layout_key, slot_layout ? slot_layout->size() : 0);
     shade_cache_quant_ = std::max(quant_size, 0.05f);
 }
 
+void SpatialLightingSceneProvider::BeginAmbientShadeOverlayFrame(std::uint64_t voxel_layout_key,
+                                                                 std::size_t voxel_count)
+{
+    SyncAmbientShadeSlots(overlay_shade_slots_, voxel_layout_key, voxel_count);
+}
+
+AmbientShadeCacheEntry SpatialLightingSceneProvider::TraceAmbientShadeEntry(float room_x,
+                                                                            float room_y,
+                                                                            float room_z,
+                                                                            float room_center_x,
+                                                                            float room_center_y,
+                                                                            float room_center_z,
+                                                                            float probe_span,
+                                                                            bool need_openness) const
+{
+    const SpatialLighting::RoomAmbientShadeTerms terms =
+        SpatialLighting::ComputeRoomAmbientShadeTerms(room_x,
+                                                      room_y,
+                                                      room_z,
+                                                      room_center_x,
+                                                      room_center_y,
+                                                      room_center_z,
+                                                      frame_occluder_aabbs_,
+                                                      frame_occluder_quads_,
+                                                      frame_blocker_grids_,
+                                                      need_openness,
+                                                      probe_span,
+                                                      &frame_occluder_index_,
+                                                      frame_room_blocker_field_.IsValid() ? &frame_room_blocker_field_
+                                                                                          : nullptr);
+    AmbientShadeCacheEntry entry{};
+    entry.valid = true;
+    entry.center_blocked = terms.center_blocked;
+    entry.openness = need_openness ? terms.openness : -1.0f;
+    entry.room_x = room_x;
+    entry.room_y = room_y;
+    entry.room_z = room_z;
+    entry.room_center_x = room_center_x;
+    entry.room_center_y = room_center_y;
+    entry.room_center_z = room_center_z;
+    entry.probe_span = probe_span;
+    return entry;
+}
+
+bool SpatialLightingSceneProvider::AmbientShadeSlotBaked(std::size_t shade_slot,
+                                                         float room_center_x,
+                                                         float room_center_y,
+                                                         float room_center_z,
+                                                         float probe_span,
+                                                         bool need_openness) const
+{
+    return shade_slot < led_shade_slots_.entries.size() &&
+           ShadeCacheEntryMatches(led_shade_slots_.entries[shade_slot],
+                                  room_center_x,
+                                  room_center_y,
+                                  room_center_z,
+                                  probe_span,
+                                  need_openness);
+}
+
+void SpatialLightingSceneProvider::BakeAmbientShadeSlot(std::size_t shade_slot,
+                                                        float room_x,
+                                                        float room_y,
+                                                        float room_z,
+                                                        float room_center_x,
+                                                        float room_center_y,
+                                                        float room_center_z,
+                                                        float probe_span,
+                                                        bool need_openness)
+{
+    if(shade_slot >= led_shade_slots_.entries.size())
+    {
+        return;
+    }
+    led_shade_slots_.entries[shade_slot] = TraceAmbientShadeEntry(room_x,
+                                                                  room_y,
+                                                                  room_z,
+                                                                  room_center_x,
+                                                                  room_center_y,
+                                                                  room_center_z,
+                                                                  probe_span,
+                                                                  need_openness);
+}
+
 float SpatialLightingSceneProvider::ComputeAmbientShadeFactorCached(int shade_slot,
                                                                   float room_x,
                                                                   float room_y,
@@ -144,67 +885,76 @@ float SpatialLightingSceneProvider::ComputeAmbientShadeFactorCached(int shade_sl
                                                                   float ao_strength_norm,
                                                                   float probe_span)
 {
+    // The overlay shows shadows only; its voxels have their own slot buffer.
+    const bool overlay_pass = SpatialRoom::IsRoomGridOverlayPass();
+    const float effective_ao = overlay_pass ? 0.0f : ao_strength_norm;
+    const bool need_openness = effective_ao > 0.01f;
+
     if(shade_slot >= 0)
     {
-        const auto slot_found = g_shade_slot_cache.find(shade_slot);
-        if(slot_found != g_shade_slot_cache.end() &&
-           ShadeCacheParamsMatch(slot_found->second,
-                                 room_center_x,
-                                 room_center_y,
-                                 room_center_z,
-                                 ao_strength_norm,
-                                 probe_span))
+        AmbientShadeSlotBuffer& buffer = overlay_pass ? overlay_shade_slots_ : led_shade_slots_;
+        if((size_t)shade_slot >= buffer.entries.size())
         {
-            return slot_found->second.shade_factor;
+            return ShadeFactorFromEntry(TraceAmbientShadeEntry(room_x,
+                                                               room_y,
+                                                               room_z,
+                                                               room_center_x,
+                                                               room_center_y,
+                                                               room_center_z,
+                                                               probe_span,
+                                                               need_openness),
+                                        effective_ao);
         }
+        AmbientShadeCacheEntry& slot_entry = buffer.entries[(size_t)shade_slot];
+        if(!ShadeCacheEntryMatches(slot_entry, room_center_x, room_center_y, room_center_z, probe_span, need_openness))
+        {
+            slot_entry = TraceAmbientShadeEntry(room_x,
+                                                room_y,
+                                                room_z,
+                                                room_center_x,
+                                                room_center_y,
+                                                room_center_z,
+                                                probe_span,
+                                                need_openness);
+        }
+        return ShadeFactorFromEntry(slot_entry, effective_ao);
     }
-    else
-    {
-        const std::uint64_t key = PackAmbientShadeKey(room_x, room_y, room_z, shade_cache_quant_);
-        const auto found = g_shade_position_cache.find(key);
-        if(found != g_shade_position_cache.end() &&
-           ShadeCacheParamsMatch(found->second,
-                                 room_center_x,
-                                 room_center_y,
-                                 room_center_z,
-                                 ao_strength_norm,
-                                 probe_span))
-        {
-            return found->second.shade_factor;
-        }
-    }
-
-    const float shade_factor = SpatialLighting::ComputeRoomAmbientShadeFactor(room_x,
-                                                                            room_y,
-                                                                            room_z,
-                                                                            room_center_x,
-                                                                            room_center_y,
-                                                                            room_center_z,
-                                                                            frame_occluder_aabbs_,
-                                                                            frame_occluder_quads_,
-                                                                            frame_blocker_grids_,
-                                                                            ao_strength_norm,
-                                                                            probe_span,
-                                                                            &frame_occluder_index_,
-                                                                            frame_room_blocker_field_.IsValid()
-                                                                                ? &frame_room_blocker_field_
-                                                                                : nullptr);
-    AmbientShadeCacheEntry entry{};
-    entry.shade_factor = shade_factor;
-    entry.room_center_x = room_center_x;
-    entry.room_center_y = room_center_y;
-    entry.room_center_z = room_center_z;
-    entry.ao_strength_norm = ao_strength_norm;
-    entry.probe_span = probe_span;
 
-    if(shade_slot >= 0)
+    // Per-thread cache: each pool worker notices a geometry change on its own first lookup.
+    if(g_shade_position_cache_epoch != scene_geometry_epoch_.load())
     {
-        g_shade_slot_cache[shade_slot] = entry;
+        g_shade_position_cache.clear();
+        g_shade_position_cache_epoch = scene_geometry_epoch_.load();
+        g_shade_position_cache_dirty_serial = shade_dirty_serial_;
     }
-    else
+    else if(g_shade_position_cache_dirty_serial != shade_dirty_serial_)
+    {
+        thread_local std::vector<SpatialLighting::OccluderAabb> regions;
+        if(PendingShadeDirtyRegions(g_shade_position_cache_dirty_serial, regions))
+        {
+            for(auto it = g_shade_position_cache.begin(); it != g_shade_position_cache.end();)
+            {
+                it = ShadeEntryReachesAny(it->second, regions) ? g_shade_position_cache.erase(it) : std::next(it);
+            }
+        }
+        else
+        {
+            g_shade_position_cache.clear();
+        }
+        g_shade_position_cache_dirty_serial = shade_dirty_serial_;
+    }
+    const std::uint64_t key = PackAmbientShadeKey(room_x, room_y, room_z, shade_cache_quant_);
+    AmbientShadeCacheEntry& entry = g_shade_position_cache[key];
+    if(!ShadeCacheEntryMatches(entry, room_center_x, room_center_y, room_center_z, probe_span, need_openness))
     {
-        const std::uint64_t key = PackAmbientShadeKey(room_x, room_y, room_z, shade_cache_quant_);
-        g_shade_position_cache[key] = entry;
+        entry = TraceAmbientShadeEntry(room_x,
+                                       room_y,
+                                       room_z,
+                                       room_center_x,
+                                       room_center_y,
+                                       room_center_z,
+                                       probe_span,
+                                       need_openness);
     }
-    return shade_factor;
+    return ShadeFactorFromEntry(entry, effective_ao);
 }
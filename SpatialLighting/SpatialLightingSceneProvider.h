@@ -8,6 +8,8 @@
 #include "SpatialLighting/OccluderSpatialIndex.h"
 #include "SpatialLighting/SpatialLightingEngine.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
@@ -15,18 +17,48 @@
 #include <vector>
 
 struct ControllerTransform;
+struct LedFrameLayout3D;
 struct GridContext3D;
+class DisplayPlane3D;
+
+/**
+ * Geometry half of one receiver's shade factor (see SpatialLighting::RoomAmbientShadeTerms), with the inputs it
+ * was traced from. AO strength is not part of the key: it is applied when the entry is read.
+ */
+struct AmbientShadeCacheEntry
+{
+    bool valid = false;
+    bool center_blocked = false;
+    /** Negative until the AO probes have been traced for this entry. */
+    float openness = -1.0f;
+    float room_x = 0.0f;
+    float room_y = 0.0f;
+    float room_z = 0.0f;
+    float room_center_x = 0.0f;
+    float room_center_y = 0.0f;
+    float room_center_z = 0.0f;
+    float probe_span = 0.0f;
+};
 
 class SpatialLightingSceneProvider
 {
 public:
     static SpatialLightingSceneProvider* instance();
 
+    /** GUI side: the tab's live transforms, for panels listing controllers. Render code uses frameControllers(). */
     void SetControllers(const std::vector<std::unique_ptr<ControllerTransform>>* transforms);
     const std::vector<std::unique_ptr<ControllerTransform>>* controllers() const { return controllers_; }
 
-    void SetShadingControllerIndex(int index) { shading_controller_index_ = index; }
-    int shadingControllerIndex() const { return shading_controller_index_; }
+    /**
+     * Render side: the snapshot's copy of the transforms that occluders, blocker fields and relay mirrors
+     * are built from. Set by the evaluating thread at the start of a frame, so it never changes mid-frame.
+     */
+    void SetFrameControllers(std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>> transforms);
+    const std::vector<std::unique_ptr<ControllerTransform>>* frameControllers() const { return frame_controllers_.get(); }
+
+    /** Per thread: render pool workers shade different controllers at the same time. */
+    void SetShadingControllerIndex(int index);
+    int shadingControllerIndex() const;
 
     void ClearEmitterRelayFrame();
     void SetEmitterRelayMirrorFrame(EmitterRelayMirror::MirrorFrame frame,
@@ -35,7 +67,16 @@ public:
     const EmitterRelayMirror::MirrorFrame& emitterRelayMirrorFrame() const { return emitter_relay_mirror_; }
     bool isEmitterController(int controller_index) const;
 
+    /**
+     * Cheap and callable from GUI slots mid-frame: marks occluders stale. The next EnsureFrameOccluders
+     * re-derives every object's occluders but only applies (and invalidates shading around) the ones that differ.
+     */
     void InvalidateFrameOccluders();
+    /**
+     * Per-object update: controllers and display planes whose transform hash moved get new occluders,
+     * moved boxes update only their OccluderSpatialIndex cells, and cached shade factors are dropped only
+     * where a changed occluder can reach them. Option, grid or controller-list changes rebuild everything.
+     */
     void EnsureFrameOccluders(const GridContext3D& grid, const SpatialLighting::OccluderBuildOptions& options);
     const std::vector<SpatialLighting::OccluderQuad>& frameOccluderQuads() const { return frame_occluder_quads_; }
     const std::vector<SpatialLighting::OccluderAabb>& frameOccluderAabbs() const { return frame_occluder_aabbs_; }
@@ -43,7 +84,39 @@ public:
     const std::vector<SpatialLighting::BlockerGridOccluder>& frameBlockerGrids() const { return frame_blocker_grids_; }
     const SpatialLighting::RoomBlockerField& frameRoomBlockerField() const { return frame_room_blocker_field_; }
 
-    void BeginAmbientShadeCacheFrame(float quant_size);
+    /**
+     * slot_layout: the LedFrameLayout3D the shade slots index into (nullptr = none). When a recompile moves
+     * its epoch, entries follow their controller span to its new slots by ControllerSpan::room_key; only
+     * spans whose LEDs moved start unbaked.
+     * The slot buffer persists across frames: only entries a dirty region can reach are dropped, and
+     * BakeAmbientShadeSlot refills them. Concurrent callers must shade disjoint slots; the position cache
+     * (shade_slot < 0) stays per thread.
+     */
+    void BeginAmbientShadeCacheFrame(float quant_size, const LedFrameLayout3D* slot_layout = nullptr);
+    /**
+     * Same for the room-grid overlay: while SpatialRoom::IsRoomGridOverlayPass(), shade slots index voxels
+     * [0, voxel_count) of a buffer keyed by voxel_layout_key (changes whenever the sample axes do).
+     */
+    void BeginAmbientShadeOverlayFrame(std::uint64_t voxel_layout_key, std::size_t voxel_count);
+
+    /** False when LED slot must be (re)baked for this center / probe span; need_openness asks for the AO probes too. */
+    bool AmbientShadeSlotBaked(std::size_t shade_slot,
+                               float room_center_x,
+                               float room_center_y,
+                               float room_center_z,
+                               float probe_span,
+                               bool need_openness) const;
+    /** Traces LED slot's shade terms. Safe to call for disjoint slots from several threads. */
+    void BakeAmbientShadeSlot(std::size_t shade_slot,
+                              float room_x,
+                              float room_y,
+                              float room_z,
+                              float room_center_x,
+                              float room_center_y,
+                              float room_center_z,
+                              float probe_span,
+                              bool need_openness);
+
     float ComputeAmbientShadeFactorCached(int shade_slot,
                                           float room_x,
                                           float room_y,
@@ -57,14 +130,69 @@ public:
 private:
     SpatialLightingSceneProvider() = default;
 
+    struct ControllerOccluderRecord
+    {
+        std::uint64_t transform_hash = 0;
+        /** Index into frame_occluder_aabbs_ / frame_blocker_grids_, or -1. */
+        int aabb_slot = -1;
+        int blocker_slot = -1;
+    };
+
+    struct DisplayPlaneOccluderRecord
+    {
+        int plane_id = -1;
+        std::uint64_t transform_hash = 0;
+        /** Index into frame_occluder_quads_, or -1. */
+        int quad_slot = -1;
+    };
+
+    /** Dense per-slot shade terms that outlive the frame, reset when the layout key or full geometry changes. */
+    struct AmbientShadeSlotBuffer
+    {
+        std::vector<AmbientShadeCacheEntry> entries;
+        std::uint64_t geometry_epoch = 0;
+        std::uint64_t layout_key = 0;
+        std::uint64_t dirty_serial = 0;
+    };
+
+    /** Where one controller span's entries sit in led_shade_slots_. */
+    struct ShadeSlotSpan
+    {
+        std::uint64_t room_key = 0;
+        std::size_t first = 0;
+        std::size_t count = 0;
+    };
+
+    /** Moves led_shade_slots_ onto layout's slots span by span and adopts its epoch as the layout key. */
+    void RemapLedShadeSlots(const LedFrameLayout3D& layout);
+    /** Applies pending dirty regions to buffer (or resets it) and sizes it to slot_count. */
+    void SyncAmbientShadeSlots(AmbientShadeSlotBuffer& buffer, std::uint64_t layout_key, std::size_t slot_count);
+    AmbientShadeCacheEntry TraceAmbientShadeEntry(float room_x,
+                                                  float room_y,
+                                                  float room_z,
+                                                  float room_center_x,
+                                                  float room_center_y,
+                                                  float room_center_z,
+                                                  float probe_span,
+                                                  bool need_openness) const;
+
+    void RebuildFrameOccluders(const GridContext3D& grid, const SpatialLighting::OccluderBuildOptions& options);
+    void BuildQuadOccluders(const std::vector<DisplayPlane3D*>& planes, const GridContext3D& grid);
+    void UpdateControllerOccluders(const GridContext3D& grid, bool rederive_all);
+    void UpdateDisplayPlaneOccluders(const GridContext3D& grid, bool rederive_all);
+    /** Publishes a room-space box, grown by pad, where cached shade factors may be stale. */
+    void MarkShadeDirty(SpatialLighting::Vec3 min, SpatialLighting::Vec3 max, float pad);
+    /** Regions published after applied_serial; false when the ring no longer holds them all. */
+    bool PendingShadeDirtyRegions(std::uint64_t applied_serial, std::vector<SpatialLighting::OccluderAabb>& out) const;
+
     const std::vector<std::unique_ptr<ControllerTransform>>* controllers_ = nullptr;
-    int shading_controller_index_ = -1;
+    std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>> frame_controllers_;
 
     bool emitter_relay_mirror_active_ = false;
     EmitterRelayMirror::MirrorFrame emitter_relay_mirror_;
     std::unordered_set<int> emitter_controller_indices_;
 
-    bool frame_occluders_valid_ = false;
+    std::atomic<bool> frame_occluders_valid_{false};
     SpatialLighting::OccluderBuildOptions frame_occluder_options_{};
     std::vector<SpatialLighting::OccluderQuad> frame_occluder_quads_;
     std::vector<SpatialLighting::OccluderAabb> frame_occluder_aabbs_;
@@ -72,8 +200,28 @@ private:
     std::vector<SpatialLighting::BlockerGridOccluder> frame_blocker_grids_;
     SpatialLighting::RoomBlockerField frame_room_blocker_field_;
 
-    std::uint64_t scene_geometry_epoch_ = 0;
+    bool frame_occluders_built_ = false;
+    std::uint64_t frame_occluder_grid_hash_ = 0;
+    std::vector<ControllerOccluderRecord> controller_records_;
+    std::vector<DisplayPlaneOccluderRecord> plane_records_;
+
+    /** Bumped only by full rebuilds; every shade cache resets when it moves. */
+    std::atomic<std::uint64_t> scene_geometry_epoch_{0};
+    /**
+     * Ring of the last kMaxShadeDirtyRegions dirty regions; shade_dirty_serial_ counts every region published.
+     * Each cache drops entries inside the regions past its own serial, or resets when it fell further behind.
+     * Written by EnsureFrameOccluders, read by shading; both run inside one evaluation on the render thread.
+     */
+    static constexpr std::size_t kMaxShadeDirtyRegions = 64;
+    SpatialLighting::OccluderAabb shade_dirty_regions_[kMaxShadeDirtyRegions];
+    std::uint64_t shade_dirty_serial_ = 0;
     float shade_cache_quant_ = 1.0f;
+    /** Indexed by LED frame layout index; one load per LED once baked. */
+    AmbientShadeSlotBuffer led_shade_slots_;
+    /** Span placement of led_shade_slots_ under its current layout key. */
+    std::vector<ShadeSlotSpan> led_shade_spans_;
+    /** Indexed by room-grid overlay voxel (ix * ny * nz + iy * nz + iz). */
+    AmbientShadeSlotBuffer overlay_shade_slots_;
 };
 
 #endif
@@ -6,8 +6,9 @@ namespace SpatialRoom
 {
 namespace
 {
-SpatialRoomFrameContext g_frame{};
-int g_overlay_pass_depth = 0;
+// Per thread: the render worker evaluates frames while the GUI thread may sample emitters.
+thread_local SpatialRoomFrameContext g_frame{};
+thread_local int g_overlay_pass_depth = 0;
 } // namespace
 
 void BeginEffectRenderFrame()
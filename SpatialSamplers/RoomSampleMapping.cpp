@@ -6,30 +6,44 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 
 namespace RoomSampleMapping
 {
 namespace
 {
-static float SampleChannel(const GameTelemetryBridge::RoomSampleFrameChannel& rs,
-                           int ix,
-                           int iy,
-                           int iz,
-                           int channel)
+/**
+ * RGBA quad of cubemap texel (ix, iy, iz), or null when out of range / not shipped. Full frames index
+ * the cubemap directly; packed frames go through the config's texel -> slot table, one load either way.
+ */
+static const unsigned char* TexelRgba(const GameTelemetryBridge::RoomSampleFrameChannel& rs, int ix, int iy, int iz)
 {
     if(ix < 0 || iy < 0 || iz < 0 || ix >= rs.size_x || iy >= rs.size_y || iz >= rs.size_z)
     {
-        return 0.0f;
+        return nullptr;
     }
     const std::size_t sy = (std::size_t)rs.size_y;
     const std::size_t sz = (std::size_t)rs.size_z;
-    const std::size_t idx = ((std::size_t)ix * sy + (std::size_t)iy) * sz + (std::size_t)iz;
-    const std::size_t bi = idx * 4u + (std::size_t)channel;
-    if(!rs.rgba || bi >= rs.rgba->size())
+    std::size_t idx = ((std::size_t)ix * sy + (std::size_t)iy) * sz + (std::size_t)iz;
+    if(rs.packed)
     {
-        return 0.0f;
+        if(!rs.cell_table || idx >= rs.cell_table->slot_by_texel.size())
+        {
+            return nullptr;
+        }
+        const std::uint16_t slot = rs.cell_table->slot_by_texel[idx];
+        if(slot == 0)
+        {
+            return nullptr;
+        }
+        idx = (std::size_t)slot - 1u;
     }
-    return (float)(*rs.rgba)[bi] / 255.0f;
+    const std::size_t bi = idx * 4u;
+    if(!rs.rgba || bi + 4u > rs.rgba->size())
+    {
+        return nullptr;
+    }
+    return rs.rgba->data() + bi;
 }
 
 static RGBColor PackRgb(float r, float g, float b, float a, bool& out_valid)
@@ -64,14 +78,19 @@ static RGBColor NearestFaceSample(const GameTelemetryBridge::RoomSampleFrameChan
     const float gv = std::clamp(v, 0.0f, 1.0f) * (float)rs.size_y - 0.5f;
     const int iu = std::clamp((int)std::lround(gu), 0, rs.size_x - 1);
     const int iv = std::clamp((int)std::lround(gv), 0, rs.size_y - 1);
-    const float a = SampleChannel(rs, iu, iv, face, 3);
+    const unsigned char* texel = TexelRgba(rs, iu, iv, face);
+    if(!texel)
+    {
+        return (RGBColor)0;
+    }
+    const float a = (float)texel[3] / 255.0f;
     if(a <= 0.02f)
     {
         return (RGBColor)0;
     }
-    return PackRgb(SampleChannel(rs, iu, iv, face, 0) * a,
-                   SampleChannel(rs, iu, iv, face, 1) * a,
-                   SampleChannel(rs, iu, iv, face, 2) * a,
+    return PackRgb((float)texel[0] / 255.0f * a,
+                   (float)texel[1] / 255.0f * a,
+                   (float)texel[2] / 255.0f * a,
                    a,
                    out_valid);
 }
@@ -0,0 +1,653 @@
+// SPDX-License-Identifier: GPL-2.0-only
+//
+// Headless effect-stack benchmark. Loads the plugin's OpenRGB profile payload
+// ({profile_version, layout, effects}), rebuilds the layout as synthetic
+// controllers and renders frames through the same EvaluateRenderSnapshot the
+// tab uses. See CONTRIBUTING.md, "Headless engine benchmark".
+
+#include "ControllerLayout3D.h"
+#include "EffectInstance3D.h"
+#include "EffectListManager3D.h"
+#include "EffectRenderFrame.h"
+#include "EffectRenderTaskPool.h"
+#include "EffectStackEvaluator.h"
+#include "GridSpaceUtils.h"
+#include "LedFrameLayout3D.h"
+#include "OpenRGB3DSpatialPlugin.h"
+#include "PluginLog.h"
+#include "Shaders/SpatialVolumeFieldEngine.h"
+#include "SpatialEffect3D.h"
+#include "SpatialLighting/SpatialLightingSceneProvider.h"
+#include "TransformJson.h"
+#include "VirtualReferencePoint3D.h"
+
+#include <QApplication>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+/*---------------------------------------------------------*\
+| Normally defined by OpenRGB3DSpatialPlugin.cpp. Null here, |
+| so LOG_* calls from the engine are no-ops.                |
+\*---------------------------------------------------------*/
+OpenRGBPluginAPIInterface* OpenRGB3DSpatialPlugin::APIPointer = nullptr;
+OpenRGBPluginAPIInterface* g_3dspatial_plugin_api = nullptr;
+
+/*---------------------------------------------------------*\
+| Every heap allocation in the process, worker threads      |
+| included; frames report the delta.                        |
+\*---------------------------------------------------------*/
+static std::atomic<std::uint64_t> g_allocation_count{0};
+
+static void* CountedAlloc(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void* CountedAlignedAlloc(std::size_t size, std::align_val_t align)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+    const std::size_t rounded = ((size ? size : 1) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+    return _aligned_malloc(rounded, alignment);
+#else
+    return std::aligned_alloc(alignment, rounded);
+#endif
+}
+
+static void AlignedFree(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(std::size_t size)
+{
+    void* ptr = CountedAlloc(size);
+    if(!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    void* ptr = CountedAlignedAlloc(size, align);
+    if(!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { AlignedFree(ptr); }
+
+namespace
+{
+
+struct BenchOptions
+{
+    std::string profile_path;
+    unsigned int frames = 600;
+    unsigned int warmup = 60;
+    /** Pool workers besides the main thread; negative = EffectRenderTaskPool::DefaultWorkerCount(). */
+    int threads = -1;
+    float frame_dt = 1.0f / 60.0f;
+    bool per_effect = true;
+};
+
+/**
+ * The profile's layout as synthetic controllers: one virtual-only ControllerTransform
+ * per layout entry with no device behind it. LEDs keep their zone/led indices; local
+ * positions are rebuilt as one row per zone at the saved LED spacing, since the real
+ * geometry comes from the device's zone/matrix data.
+ */
+struct BenchScene
+{
+    float grid_scale_mm = DEFAULT_GRID_SCALE_MM;
+    float room_width = DEFAULT_ROOM_SIZE_MM;
+    float room_depth = DEFAULT_ROOM_SIZE_MM;
+    float room_height = DEFAULT_ROOM_SIZE_MM;
+    std::vector<std::unique_ptr<ControllerTransform>> transforms;
+    std::vector<std::unique_ptr<VirtualReferencePoint3D>> reference_points;
+    std::shared_ptr<LedFrameLayout3D> layout;
+};
+
+struct FrameTiming
+{
+    std::vector<double> frame_us;
+    std::vector<std::uint64_t> allocations;
+};
+
+void PrintUsage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s <profile.json> [--frames N] [--warmup N] [--threads N] [--dt SECONDS] [--no-per-effect]\n"
+                 "  profile.json   plugin profile payload (same schema as OnProfileSave: layout + effects)\n"
+                 "  --frames N     measured frames per run (default 600)\n"
+                 "  --warmup N     unmeasured frames before each run (default 60)\n"
+                 "  --threads N    evaluation pool workers besides the main thread (default: one per spare core)\n"
+                 "  --dt SECONDS   effect time step per frame (default 1/60)\n"
+                 "  --no-per-effect  skip the per-layer ns/LED runs\n",
+                 argv0);
+}
+
+bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for(int arg_idx = 1; arg_idx < argc; arg_idx++)
+    {
+        const std::string arg = argv[arg_idx];
+        const bool has_value = arg_idx + 1 < argc;
+        try
+        {
+            if(arg == "--frames" && has_value)
+            {
+                options.frames = (unsigned int)std::max(1, std::stoi(argv[++arg_idx]));
+            }
+            else if(arg == "--warmup" && has_value)
+            {
+                options.warmup = (unsigned int)std::max(0, std::stoi(argv[++arg_idx]));
+            }
+            else if(arg == "--threads" && has_value)
+            {
+                options.threads = std::stoi(argv[++arg_idx]);
+            }
+            else if(arg == "--dt" && has_value)
+            {
+                options.frame_dt = std::stof(argv[++arg_idx]);
+            }
+            else if(arg == "--no-per-effect")
+            {
+                options.per_effect = false;
+            }
+            else if(!arg.empty() && arg[0] != '-' && options.profile_path.empty())
+            {
+                options.profile_path = arg;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        catch(const std::exception&)
+        {
+            return false;
+        }
+    }
+    return !options.profile_path.empty();
+}
+
+std::unique_ptr<ControllerTransform> MakeSyntheticController(const nlohmann::json& controller_json, float grid_scale_mm)
+{
+    std::unique_ptr<ControllerTransform> transform = std::make_unique<ControllerTransform>();
+    transform->controller = nullptr;
+    transform->virtual_controller = nullptr;
+    transform->transform = Transform3D{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+    TransformJson::ReadTransform(controller_json, transform->transform);
+    transform->display_color = 0x00FFFFFF;
+    transform->hidden_by_virtual = false;
+    transform->led_spacing_mm_x = controller_json["led_spacing_mm"]["x"].get<float>();
+    transform->led_spacing_mm_y = controller_json["led_spacing_mm"]["y"].get<float>();
+    transform->led_spacing_mm_z = controller_json["led_spacing_mm"]["z"].get<float>();
+    transform->granularity = controller_json["granularity"].get<int>();
+    transform->item_idx = controller_json["item_idx"].get<int>();
+    transform->world_positions_dirty = true;
+
+    const float step_x = MMToGridUnits(transform->led_spacing_mm_x > 0.0f ? transform->led_spacing_mm_x : grid_scale_mm,
+                                       grid_scale_mm);
+    const float step_y = MMToGridUnits(transform->led_spacing_mm_y > 0.0f ? transform->led_spacing_mm_y : grid_scale_mm,
+                                       grid_scale_mm);
+
+    // Zone -> row, in order of first appearance; LEDs advance along X within their row.
+    std::map<unsigned int, unsigned int> zone_rows;
+    std::map<unsigned int, unsigned int> zone_columns;
+    const nlohmann::json& mappings = controller_json["led_mappings"];
+    transform->led_positions.reserve(mappings.size());
+    for(const nlohmann::json& mapping : mappings)
+    {
+        LEDPosition3D led_position{};
+        led_position.controller = nullptr;
+        led_position.zone_idx = mapping["zone_index"].get<unsigned int>();
+        led_position.led_idx = mapping["led_index"].get<unsigned int>();
+        const unsigned int row = zone_rows.emplace(led_position.zone_idx, (unsigned int)zone_rows.size()).first->second;
+        const unsigned int column = zone_columns[led_position.zone_idx]++;
+        led_position.local_position = {column * step_x, row * step_y, 0.0f};
+        transform->led_positions.push_back(led_position);
+    }
+    return transform;
+}
+
+bool LoadScene(const nlohmann::json& layout_json, BenchScene& scene, std::string& error)
+{
+    try
+    {
+        scene.grid_scale_mm = SafeGridScaleMm(layout_json["grid"]["scale_mm"].get<float>());
+        scene.room_width = layout_json["room"]["width"].get<float>();
+        scene.room_depth = layout_json["room"]["depth"].get<float>();
+        scene.room_height = layout_json["room"]["height"].get<float>();
+
+        for(const nlohmann::json& controller_json : layout_json["controllers"])
+        {
+            scene.transforms.push_back(MakeSyntheticController(controller_json, scene.grid_scale_mm));
+        }
+        if(layout_json.contains("reference_points"))
+        {
+            for(const nlohmann::json& point_json : layout_json["reference_points"])
+            {
+                scene.reference_points.push_back(VirtualReferencePoint3D::FromJson(point_json));
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        error = e.what();
+        return false;
+    }
+    if(scene.transforms.empty())
+    {
+        error = "layout has no controllers";
+        return false;
+    }
+    return true;
+}
+
+/** LedFrameLayoutCache3D needs device zones; synthetic controllers map led_positions one to one instead. */
+std::shared_ptr<LedFrameLayout3D> CompileSyntheticLayout(const std::vector<std::unique_ptr<ControllerTransform>>& transforms)
+{
+    std::shared_ptr<LedFrameLayout3D> layout = std::make_shared<LedFrameLayout3D>();
+    layout->epoch = 1;
+    for(unsigned int ctrl_idx = 0; ctrl_idx < transforms.size(); ctrl_idx++)
+    {
+        ControllerTransform* transform = transforms[ctrl_idx].get();
+        ControllerLayout3D::UpdateWorldPositions(transform);
+
+        LedFrameLayout3D::ControllerSpan span;
+        span.transform = transform;
+        span.ctrl_idx = ctrl_idx;
+        span.virtual_only = true;
+        span.led_position_count = transform->led_positions.size();
+        span.first = layout->size();
+        span.first_zone = layout->zones.size();
+        for(unsigned int led_pos_idx = 0; led_pos_idx < transform->led_positions.size(); led_pos_idx++)
+        {
+            const LEDPosition3D& led_position = transform->led_positions[led_pos_idx];
+            const std::size_t index = layout->size();
+            if(span.zone_count > 0 && layout->zones.back().zone_idx == led_position.zone_idx)
+            {
+                layout->zones.back().count++;
+            }
+            else
+            {
+                LedFrameLayout3D::ZoneSpan zone;
+                zone.zone_idx = led_position.zone_idx;
+                zone.first = index;
+                zone.count = 1;
+                layout->zones.push_back(zone);
+                span.zone_count++;
+            }
+            layout->world_x.push_back(led_position.world_position.x);
+            layout->world_y.push_back(led_position.world_position.y);
+            layout->world_z.push_back(led_position.world_position.z);
+            layout->room_x.push_back(led_position.room_position.x);
+            layout->room_y.push_back(led_position.room_position.y);
+            layout->room_z.push_back(led_position.room_position.z);
+            layout->led_position_index.push_back(led_pos_idx);
+            layout->global_led_index.push_back(led_pos_idx);
+            span.count++;
+        }
+        layout->controllers.push_back(span);
+    }
+    return layout;
+}
+
+bool LoadStack(const nlohmann::json& effects_json,
+               std::vector<std::unique_ptr<EffectInstance3D>>& stack,
+               std::string& error)
+{
+    try
+    {
+        for(const nlohmann::json& instance_json : effects_json["stack"])
+        {
+            std::unique_ptr<EffectInstance3D> instance = EffectInstance3D::FromJson(instance_json);
+            if(!instance || !instance->enabled || instance->effect_class_name.empty())
+            {
+                continue;
+            }
+            SpatialEffect3D* effect = EffectListManager3D::get()->CreateEffect(instance->effect_class_name);
+            if(!effect)
+            {
+                std::fprintf(stderr, "skipping unregistered effect '%s'\n", instance->effect_class_name.c_str());
+                continue;
+            }
+            instance->effect.reset(effect);
+            if(instance->saved_settings && !instance->saved_settings->empty())
+            {
+                effect->LoadSettings(*instance->saved_settings);
+            }
+            stack.push_back(std::move(instance));
+        }
+    }
+    catch(const std::exception& e)
+    {
+        error = e.what();
+        return false;
+    }
+    if(stack.empty())
+    {
+        error = "effect stack is empty";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Snapshot for the given layers, built the way OpenRGB3DSpatialTab::BuildRenderFrameSnapshot
+ * does for a stack without zones or an emitter relay: zone-targeted layers (zone_index >= 0)
+ * run on every controller, and relay layers render as ordinary layers.
+ */
+std::shared_ptr<EffectRenderSnapshot> BuildSnapshot(const BenchScene& scene,
+                                                    const std::vector<EffectInstance3D*>& layers,
+                                                    int origin_item_data)
+{
+    const GridBounds bounds = ComputeGridBounds(MakeManualRoomSettings(true, scene.room_width, scene.room_height, scene.room_depth),
+                                                scene.grid_scale_mm,
+                                                scene.transforms);
+    GridContext3D grid(bounds.min_x, bounds.max_x,
+                       bounds.min_y, bounds.max_y,
+                       bounds.min_z, bounds.max_z,
+                       scene.grid_scale_mm);
+    Vector3D led_mu{};
+    if(TryComputeLedCentroid(scene.transforms, true, &led_mu))
+    {
+        grid.SetLedCentroid(led_mu.x, led_mu.y, led_mu.z);
+    }
+
+    ReferenceMode origin_mode = REF_MODE_USER_POSITION;
+    Vector3D origin = {grid.center_x, grid.center_y, grid.center_z};
+    if(origin_item_data == -1)
+    {
+        origin_mode = REF_MODE_ROOM_CENTER;
+    }
+    else if(origin_item_data == -2)
+    {
+        origin_mode = REF_MODE_TARGET_ZONE_CENTER;
+    }
+    else if(origin_item_data == -3)
+    {
+        origin_mode = REF_MODE_WORLD_ORIGIN;
+    }
+    else if(origin_item_data == -4)
+    {
+        origin_mode = REF_MODE_LED_CENTROID;
+    }
+    else if(origin_item_data >= 0 && origin_item_data < (int)scene.reference_points.size() &&
+            scene.reference_points[(size_t)origin_item_data])
+    {
+        origin = scene.reference_points[(size_t)origin_item_data]->GetPosition();
+    }
+
+    std::shared_ptr<EffectRenderSnapshot> snapshot = std::make_shared<EffectRenderSnapshot>(grid, grid);
+    snapshot->generation = 1;
+    snapshot->stack_ref_origin = origin;
+    snapshot->stack_origin_mode = origin_mode;
+    // The bench scene outlives every snapshot, so it is shared without a copy.
+    snapshot->scene = std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>>(std::shared_ptr<void>(),
+                                                                                                &scene.transforms);
+    for(EffectInstance3D* instance : layers)
+    {
+        RenderEffectSlot slot;
+        slot.effect = instance->effect.get();
+        slot.zone_index = instance->zone_index <= -1000 ? instance->zone_index : -1;
+        slot.blend_mode = instance->blend_mode;
+        snapshot->slots.push_back(std::move(slot));
+    }
+    snapshot->slot_grid_overrides.resize(snapshot->slots.size());
+    snapshot->relay_stack_index = snapshot->slots.size();
+    snapshot->layout = scene.layout;
+    return snapshot;
+}
+
+/**
+ * Warmup + measured frames. Each frame runs the worker's locked settings sync and then the
+ * unlocked evaluation (occluders, field bakes and LEDs); both count towards the frame time
+ * since the worker pays for both every tick. Every run keeps its own evaluator state, so
+ * per-layer passes never reuse the full stack's plan or overlay.
+ */
+FrameTiming RunFrames(const EffectRenderSnapshot& snapshot,
+                      EffectRenderTaskPool* pool,
+                      const BenchOptions& options)
+{
+    FrameTiming timing;
+    timing.frame_us.reserve(options.frames);
+    timing.allocations.reserve(options.frames);
+
+    EffectStackEvaluatorState state;
+    EffectRenderOutput output;
+    float time = 0.0f;
+    for(unsigned int frame = 0; frame < options.warmup + options.frames; frame++)
+    {
+        const std::uint64_t allocations_before = g_allocation_count.load(std::memory_order_relaxed);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+            SyncRenderSnapshotEffects(snapshot, state);
+        }
+        EvaluateRenderSnapshot(snapshot, time, NextEffectRenderSequence(), pool, state, output);
+        const double elapsed_us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        const std::uint64_t allocations = g_allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        if(frame >= options.warmup)
+        {
+            timing.frame_us.push_back(elapsed_us);
+            timing.allocations.push_back(allocations);
+        }
+        time += options.frame_dt;
+    }
+    return timing;
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    if(sorted.empty())
+    {
+        return 0.0;
+    }
+    const std::size_t rank = (std::size_t)std::ceil(fraction * (double)sorted.size());
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+void PrintStackReport(const FrameTiming& timing, std::size_t led_count)
+{
+    std::vector<double> sorted = timing.frame_us;
+    std::sort(sorted.begin(), sorted.end());
+    double total_us = 0.0;
+    for(double us : sorted)
+    {
+        total_us += us;
+    }
+    const double mean_us = total_us / (double)sorted.size();
+
+    std::uint64_t total_allocations = 0;
+    std::uint64_t max_allocations = 0;
+    for(std::uint64_t count : timing.allocations)
+    {
+        total_allocations += count;
+        max_allocations = std::max(max_allocations, count);
+    }
+
+    std::printf("frame time (us): mean %.1f  p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n",
+                mean_us,
+                Percentile(sorted, 0.50),
+                Percentile(sorted, 0.95),
+                Percentile(sorted, 0.99),
+                sorted.back());
+    std::printf("stack ns/LED: %.1f\n", led_count > 0 ? mean_us * 1000.0 / (double)led_count : 0.0);
+    std::printf("allocations/frame: mean %.1f  max %llu\n",
+                (double)total_allocations / (double)timing.allocations.size(),
+                (unsigned long long)max_allocations);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Effects are QWidgets; they need an application object but are never shown.
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    Q_INIT_RESOURCE(spatial_shaders);
+    Q_INIT_RESOURCE(plugin_ui);
+
+    BenchOptions options;
+    if(!ParseOptions(argc, argv, options))
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    nlohmann::json profile;
+    try
+    {
+        std::ifstream in(options.profile_path);
+        profile = nlohmann::json::parse(in);
+    }
+    catch(const std::exception& e)
+    {
+        std::fprintf(stderr, "cannot read '%s': %s\n", options.profile_path.c_str(), e.what());
+        return 1;
+    }
+    if(!profile.is_object() || !profile.contains("layout") || !profile.contains("effects"))
+    {
+        std::fprintf(stderr, "'%s' is not a plugin profile payload (needs layout and effects)\n",
+                     options.profile_path.c_str());
+        return 1;
+    }
+
+    std::string error;
+    BenchScene scene;
+    if(!LoadScene(profile["layout"], scene, error))
+    {
+        std::fprintf(stderr, "layout: %s\n", error.c_str());
+        return 1;
+    }
+    scene.layout = CompileSyntheticLayout(scene.transforms);
+    SpatialLightingSceneProvider::instance()->SetControllers(&scene.transforms);
+    SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
+
+    std::vector<std::unique_ptr<EffectInstance3D>> stack;
+    if(!LoadStack(profile["effects"], stack, error))
+    {
+        std::fprintf(stderr, "effects: %s\n", error.c_str());
+        return 1;
+    }
+    const nlohmann::json& effects_json = profile["effects"];
+    const int origin_item_data = effects_json.contains("origin_item_data") ? effects_json["origin_item_data"].get<int>() : -1;
+
+    EffectRenderTaskPool pool;
+    pool.SetWorkerCount(options.threads < 0 ? EffectRenderTaskPool::DefaultWorkerCount() : (unsigned int)options.threads);
+    SpatialVolumeFieldEngine::setCpuBakePool(&pool);
+
+    const std::size_t led_count = scene.layout->size();
+    std::printf("layout: %zu controllers, %zu LEDs, grid %.1f mm\n",
+                scene.transforms.size(), led_count, scene.grid_scale_mm);
+    std::printf("stack: %zu layers, %u pool workers, %u frames (+%u warmup)\n",
+                stack.size(), pool.GetWorkerCount(), options.frames, options.warmup);
+    for(const std::unique_ptr<EffectInstance3D>& instance : stack)
+    {
+        if(instance->zone_index >= 0)
+        {
+            std::printf("note: layer '%s' targets zone %d; zones are not modelled, it runs on every controller\n",
+                        instance->effect_class_name.c_str(), instance->zone_index);
+        }
+    }
+
+    std::vector<EffectInstance3D*> all_layers;
+    for(const std::unique_ptr<EffectInstance3D>& instance : stack)
+    {
+        all_layers.push_back(instance.get());
+    }
+    const std::shared_ptr<EffectRenderSnapshot> stack_snapshot = BuildSnapshot(scene, all_layers, origin_item_data);
+    PrintStackReport(RunFrames(*stack_snapshot, &pool, options), led_count);
+
+    if(options.per_effect)
+    {
+        std::printf("per effect (alone):\n");
+        for(size_t layer_idx = 0; layer_idx < all_layers.size(); layer_idx++)
+        {
+            EffectInstance3D* instance = all_layers[layer_idx];
+            const std::shared_ptr<EffectRenderSnapshot> layer_snapshot =
+                BuildSnapshot(scene, std::vector<EffectInstance3D*>{instance}, origin_item_data);
+            const FrameTiming timing = RunFrames(*layer_snapshot, &pool, options);
+            double total_us = 0.0;
+            for(double us : timing.frame_us)
+            {
+                total_us += us;
+            }
+            const double mean_us = total_us / (double)timing.frame_us.size();
+            const SpatialEffect3D* effect = instance->effect.get();
+            std::printf("  [%zu] %-28s ns/LED %8.1f  frame %8.1f us  %s\n",
+                        layer_idx,
+                        instance->effect_class_name.c_str(),
+                        led_count > 0 ? mean_us * 1000.0 / (double)led_count : 0.0,
+                        mean_us,
+                        effect->SupportsConcurrentEvaluation() && !effect->RequiresPerLedSampleContext()
+                            ? "pooled"
+                            : "serial");
+        }
+    }
+
+    SpatialVolumeFieldEngine::setCpuBakePool(nullptr);
+    SpatialLightingSceneProvider::instance()->SetControllers(nullptr);
+    SpatialLightingSceneProvider::instance()->SetFrameControllers(nullptr);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#-----------------------------------------------------------------------------------------------#
+# Command-line stack benchmark linked against the static engine from SpatialEngine.pro.         #
+#-----------------------------------------------------------------------------------------------#
+TEMPLATE = app
+TARGET = SpatialBench
+
+DEFINES += QT_NO_CONNECT_SLOTS_BY_NAME
+
+CONFIG += console silent spatial_engine_link
+CONFIG -= app_bundle debug_and_release debug_and_release_target
+
+include(../SpatialEngine.pri)
+
+SOURCES += \
+    SpatialBench.cpp
+
+# Effects register themselves from static initializers (REGISTER_EFFECT_3D), so every
+# object in the archive has to be linked even though nothing references it directly.
+# benchmark.pro builds both projects from one directory, so the archive sits next to us.
+ENGINE_DIR = $$OUT_PWD
+msvc {
+    LIBS = /WHOLEARCHIVE:$$ENGINE_DIR/SpatialEngine.lib $$LIBS
+    PRE_TARGETDEPS += $$ENGINE_DIR/SpatialEngine.lib
+} else:macx {
+    LIBS = -Wl,-force_load,$$ENGINE_DIR/libSpatialEngine.a $$LIBS
+    PRE_TARGETDEPS += $$ENGINE_DIR/libSpatialEngine.a
+} else {
+    LIBS = -Wl,--whole-archive $$ENGINE_DIR/libSpatialEngine.a -Wl,--no-whole-archive $$LIBS
+    PRE_TARGETDEPS += $$ENGINE_DIR/libSpatialEngine.a
+}
@@ -0,0 +1,12 @@
+#-----------------------------------------------------------------------------------------------#
+# The plugin's effect engine (../SpatialEngine.pri) as a static library, without the tab.       #
+#-----------------------------------------------------------------------------------------------#
+TEMPLATE = lib
+TARGET = SpatialEngine
+
+DEFINES += QT_NO_CONNECT_SLOTS_BY_NAME
+
+CONFIG += staticlib silent
+CONFIG -= debug_and_release debug_and_release_target
+
+include(../SpatialEngine.pri)
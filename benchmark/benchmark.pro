@@ -0,0 +1,12 @@
+#-----------------------------------------------------------------------------------------------#
+# Headless engine benchmark. From a build directory:                                            #
+#   qmake <repo>/benchmark/benchmark.pro && make                                                #
+#   ./SpatialBench <profile.json> [--frames N] [--threads N]                                    #
+#-----------------------------------------------------------------------------------------------#
+TEMPLATE = subdirs
+
+SUBDIRS = engine bench
+
+engine.file = SpatialEngine.pro
+bench.file = SpatialBench.pro
+bench.depends = engine
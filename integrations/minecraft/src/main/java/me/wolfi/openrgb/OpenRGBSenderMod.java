@@ -22,6 +22,7 @@ import java.net.DatagramPacket;
 import java.net.DatagramSocket;
 import java.net.InetAddress;
 import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
 import java.util.List;
 import java.util.Locale;
 
@@ -825,7 +826,9 @@ public class OpenRGBSenderMod implements ClientModInitializer
         final int sy = faceSize;
         final int sz = RoomSampleCubemap.FACE_COUNT;
         final int texelCount = sx * sy * sz;
-        final int rgbaCount = texelCount * 4;
+        // Packed: one RGBA quad per important cell (tens of KB) instead of the whole cubemap.
+        final boolean packed = cfg.acceptsPackedFrames();
+        final int rgbaCount = packed ? cfg.importantFlatIndices.length * 4 : texelCount * 4;
         if(rgbaCount <= 0)
         {
             return;
@@ -856,6 +859,11 @@ public class OpenRGBSenderMod implements ClientModInitializer
             roomSampleClearedForConfigId = cfg.configId;
             roomSampleCubemapCursor = 0;
             roomSampleAwaitingFirstPass = true;
+            if(packed)
+            {
+                // Packed slots belong to the new cell list; last config's colours would land on other LEDs.
+                Arrays.fill(rgba, (byte)0);
+            }
         }
 
         EntityDisplayColorSampler.beginFrame(world, player, probeRadius);
@@ -872,12 +880,14 @@ public class OpenRGBSenderMod implements ClientModInitializer
                 {
                     break;
                 }
-                final int flat = important[(start + step) % n];
+                final int slot = (start + step) % n;
+                final int flat = important[slot];
                 if(flat < 0 || flat >= texelCount)
                 {
                     continue;
                 }
-                writeCubemapTexel(world, player, cfg, eye, atmosphere, localDir, cell, rgba, flat, sx, sy, sz);
+                writeCubemapTexel(world, player, cfg, eye, atmosphere, localDir, cell, rgba,
+                        packed ? slot * 4 : flat * 4, flat, sx, sy, sz);
                 processed++;
             }
             final int next = (start + Math.max(1, processed)) % n;
@@ -905,7 +915,8 @@ public class OpenRGBSenderMod implements ClientModInitializer
         final long now = System.currentTimeMillis();
         final int frameId = (int)(now & 0x7FFFFFFFL);
         roomSampleRgbaBuffer = roomSampleFrameShmWriter.offerSwap(
-                frameId, now, cfg.configId, sx, sy, sz, rgba);
+                frameId, now, cfg.configId, sx, sy, sz,
+                packed ? RoomSampleFrameShmWriter.FLAG_PACKED_IMPORTANT : 0, rgba);
     }
 
     private static void writeCubemapTexel(Level world,
@@ -916,6 +927,7 @@ public class OpenRGBSenderMod implements ClientModInitializer
                                           float[] localDir,
                                           int[] cell,
                                           byte[] rgba,
+                                          int rgbaIndex,
                                           int flat,
                                           int sx,
                                           int sy,
@@ -934,7 +946,6 @@ public class OpenRGBSenderMod implements ClientModInitializer
                 cfg, player, localDir[0], localDir[1], localDir[2], range);
         sampleRoomCellAtWorldTarget(world, player, target, cell);
         maybeFillOutdoorSky(cfg, world, eye, target, atmosphere, cell);
-        final int rgbaIndex = flat * 4;
         // While HQ UV sprites are still decoding, keep the last good LED colour instead of
         // thrashing face-average → UV (looks like a texture-load flash).
         if(BlockUvTexelSampler.rayHadOnlyUvMisses() && (rgba[rgbaIndex + 3] & 0xFF) > 8)
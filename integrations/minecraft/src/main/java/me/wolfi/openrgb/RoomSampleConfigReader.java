@@ -17,6 +17,8 @@ final class RoomSampleConfigReader
     static final int FLAG_IMPORTANT_CELLS = 1 << 2;
     static final int FLAG_SKY_ENABLED = 1 << 3;
     static final int FLAG_CUBEMAP = 1 << 4;
+    /** Plugin decodes frames carrying only the important texels, packed in list order. */
+    static final int FLAG_PACKED_IMPORTANT = 1 << 7;
     static final int MAX_IMPORTANT_CELLS = 16384;
     /** Offset of reserved[0] where important_cell_count is stored when FLAG_IMPORTANT_CELLS is set. */
     static final int IMPORTANT_COUNT_OFFSET = 92;
@@ -43,6 +45,8 @@ final class RoomSampleConfigReader
         float roomToWorldScale;
         /** Flat indices (ix*sy+iy)*sz+iz covering active LEDs (+ neighbours). Empty = full grid. */
         int[] importantFlatIndices = new int[0];
+        /** Every published index was read back in order, so packed slot i is importantFlatIndices[i] on both sides. */
+        boolean importantCellsComplete = false;
         /** Block UV sample max side (64/128/256/512/1024). Default HQ experiment = 512. */
         int uvTextureMaxDim = UV_DIM_DEFAULT;
 
@@ -57,6 +61,11 @@ final class RoomSampleConfigReader
                     && importantFlatIndices.length > 0;
         }
 
+        boolean acceptsPackedFrames()
+        {
+            return (flags & FLAG_PACKED_IMPORTANT) != 0 && importantCellsComplete && hasImportantCells();
+        }
+
         boolean isSkyEnabled()
         {
             return (flags & FLAG_SKY_ENABLED) != 0;
@@ -157,9 +166,11 @@ final class RoomSampleConfigReader
                     .order(ByteOrder.LITTLE_ENDIAN)
                     .getInt();
             final int countFromFile = (bytes.length - HEADER_BYTES) / 4;
+            boolean countValid = true;
             if(importantCount <= 0 || importantCount > MAX_IMPORTANT_CELLS || importantCount > countFromFile)
             {
                 importantCount = Math.min(MAX_IMPORTANT_CELLS, countFromFile);
+                countValid = false;
             }
             if(importantCount > 0)
             {
@@ -176,6 +187,7 @@ final class RoomSampleConfigReader
                     }
                 }
                 cfg.importantFlatIndices = wrote == importantCount ? indices : Arrays.copyOf(indices, wrote);
+                cfg.importantCellsComplete = countValid && wrote == importantCount;
             }
         }
         cached = cfg;
@@ -29,6 +29,8 @@ final class RoomSampleFrameShmWriter
     static final int HEADER_BYTES = 64;
     static final int SHM_TOTAL_BYTES = 8 * 1024 * 1024; // 8 MiB — 512²×6 sparse cubemap headroom
     static final int FLAG_LZ4 = 1 << 0;
+    /** Payload is one RGBA quad per important cell, in the config's list order. */
+    static final int FLAG_PACKED_IMPORTANT = RoomSampleConfigReader.FLAG_PACKED_IMPORTANT;
 
     private static final int OFF_SEQUENCE = 8;
     private static final Logger LOGGER = LoggerFactory.getLogger("openrgb-sender");
@@ -55,6 +57,7 @@ final class RoomSampleFrameShmWriter
     private int pendingSizeX;
     private int pendingSizeY;
     private int pendingSizeZ;
+    private int pendingFlags;
     private boolean hasPending = false;
     private final AtomicBoolean running = new AtomicBoolean(false);
     private Thread worker;
@@ -98,6 +101,7 @@ final class RoomSampleFrameShmWriter
     /**
      * Zero-copy publish with a fixed 2-buffer pool (no per-drop allocations).
      * Takes ownership of {@code filled} and returns a same-sized buffer for the next sample.
+     * {@code payloadFlags} is 0 for a full cubemap or {@link #FLAG_PACKED_IMPORTANT}.
      */
     byte[] offerSwap(int frameId,
                      long timestampMs,
@@ -105,6 +109,7 @@ final class RoomSampleFrameShmWriter
                      int sizeX,
                      int sizeY,
                      int sizeZ,
+                     int payloadFlags,
                      byte[] filled)
     {
         if(filled == null || filled.length == 0)
@@ -143,6 +148,7 @@ final class RoomSampleFrameShmWriter
             pendingSizeX = sizeX;
             pendingSizeY = sizeY;
             pendingSizeZ = sizeZ;
+            pendingFlags = payloadFlags;
             hasPending = true;
             queueLock.notifyAll();
             return ret;
@@ -220,6 +226,7 @@ final class RoomSampleFrameShmWriter
             final int sizeX;
             final int sizeY;
             final int sizeZ;
+            final int payloadFlags;
             final byte[] workRgba;
             final int rgbaLen;
             synchronized(queueLock)
@@ -246,6 +253,7 @@ final class RoomSampleFrameShmWriter
                 sizeX = pendingSizeX;
                 sizeY = pendingSizeY;
                 sizeZ = pendingSizeZ;
+                payloadFlags = pendingFlags;
                 rgbaLen = pendingRgbaLen;
                 workRgba = pendingRgba;
                 pendingRgba = EMPTY;
@@ -254,7 +262,7 @@ final class RoomSampleFrameShmWriter
 
             try
             {
-                if(publishNow(frameId, timestampMs, configId, sizeX, sizeY, sizeZ, workRgba, rgbaLen))
+                if(publishNow(frameId, timestampMs, configId, sizeX, sizeY, sizeZ, payloadFlags, workRgba, rgbaLen))
                 {
                     final PublishListener listener = publishListener;
                     if(listener != null)
@@ -283,6 +291,7 @@ final class RoomSampleFrameShmWriter
                                             int sizeX,
                                             int sizeY,
                                             int sizeZ,
+                                            int payloadFlags,
                                             byte[] rgbaRaw,
                                             int rgbaLen) throws IOException
     {
@@ -325,7 +334,7 @@ final class RoomSampleFrameShmWriter
         buffer.putInt(sizeZ);
         buffer.putInt(rgbaLen);
         buffer.putInt(storedSize);
-        buffer.putInt(FLAG_LZ4);
+        buffer.putInt(FLAG_LZ4 | payloadFlags);
         buffer.position(HEADER_BYTES);
         buffer.put(compressScratch, 0, storedSize);
         buffer.putInt(OFF_SEQUENCE, evenSeq);
@@ -28,6 +28,8 @@ constexpr int kAutoPeakDecayDefault    = 50;
 constexpr int kAutoFloorDecayDefault   = 99;
 constexpr int kBassXoverDefault        = 200;
 constexpr int kMidXoverDefault         = 2000;
+constexpr int kFftOverlapDefault       = 50;
+constexpr int kFftOverlapMax           = 93;
 
 int pctFromDecay(float coeff, float lo, float hi)
 {
@@ -135,6 +137,16 @@ void AudioAdvancedSettingsDialog::buildRows()
         QStringLiteral("Used when Mix clarity separates instruments; higher = longer activity tails."));
     activity_peak_decay_row_->setValueLabelMinimumWidth(36);
 
+    fft_overlap_row_ = EffectUiRows::AppendSliderRow(
+        band_layout,
+        QStringLiteral("Analysis overlap"),
+        0,
+        kFftOverlapMax,
+        kFftOverlapDefault,
+        QStringLiteral("Share of each FFT frame reused by the next. Higher = more analyzer updates per second "
+                       "at the same FFT size (75% runs a 2048-point FFT every 512 samples)."));
+    fft_overlap_row_->setValueLabelMinimumWidth(36);
+
     QVBoxLayout* spectrum_layout = EffectUiRows::AppendCollapsibleSectionBody(layout, QStringLiteral("Spectrum preview"));
     if(!spectrum_layout)
     {
@@ -241,6 +253,10 @@ void AudioAdvancedSettingsDialog::loadFromManager()
     {
         set_pct_label(activity_peak_decay_row_, pctFromDecay(audio->getActivityPeakDecay(), 0.96f, 0.999f));
     }
+    if(fft_overlap_row_)
+    {
+        set_pct_label(fft_overlap_row_, static_cast<int>(std::lround(audio->getFFTOverlap() * 100.0f)));
+    }
     if(visualizer_decay_row_)
     {
         set_pct_label(visualizer_decay_row_, pctFromDecay(audio->getVisualizerPeakDecay(), 0.85f, 0.99f));
@@ -297,6 +313,10 @@ void AudioAdvancedSettingsDialog::applyToManager() const
     {
         audio->setActivityPeakDecay(decayFromPct(activity_peak_decay_row_->slider()->value(), 0.96f, 0.999f));
     }
+    if(fft_overlap_row_)
+    {
+        audio->setFFTOverlap(fft_overlap_row_->slider()->value() / 100.0f);
+    }
     if(visualizer_decay_row_)
     {
         audio->setVisualizerPeakDecay(decayFromPct(visualizer_decay_row_->slider()->value(), 0.85f, 0.99f));
@@ -359,6 +379,10 @@ void AudioAdvancedSettingsDialog::applyFromPluginSettings(const nlohmann::json&
     {
         audio->setActivityPeakDecay(decayFromPct(settings["AudioActivityPeakDecayPct"].get<int>(), 0.96f, 0.999f));
     }
+    if(settings.contains("AudioFFTOverlapPct"))
+    {
+        audio->setFFTOverlap(std::clamp(settings["AudioFFTOverlapPct"].get<int>(), 0, kFftOverlapMax) / 100.0f);
+    }
     if(settings.contains("AudioVisualizerPeakDecayPct"))
     {
         audio->setVisualizerPeakDecay(decayFromPct(settings["AudioVisualizerPeakDecayPct"].get<int>(), 0.85f, 0.99f));
@@ -398,6 +422,7 @@ void AudioAdvancedSettingsDialog::writeToPluginSettings(nlohmann::json& settings
     settings["AudioBandPeakDecayPct"]        = pctFromDecay(audio->getBandPeakDecay(), 0.97f, 0.999f);
     settings["AudioBassPeakDecayPct"]        = pctFromDecay(audio->getBassPeakDecay(), 0.98f, 0.999f);
     settings["AudioActivityPeakDecayPct"]     = pctFromDecay(audio->getActivityPeakDecay(), 0.96f, 0.999f);
+    settings["AudioFFTOverlapPct"]           = static_cast<int>(std::lround(audio->getFFTOverlap() * 100.0f));
     settings["AudioVisualizerPeakDecayPct"]  = pctFromDecay(audio->getVisualizerPeakDecay(), 0.85f, 0.99f);
     settings["AudioVisualizerFloorPct"]      = floorPctFromValue(audio->getVisualizerFloor());
     settings["AudioAutoLevelEnabled"]        = audio->isAutoLevelEnabled();
@@ -41,6 +41,7 @@ private:
     class EffectSliderRow* band_peak_decay_row_     = nullptr;
     class EffectSliderRow* bass_peak_decay_row_     = nullptr;
     class EffectSliderRow* activity_peak_decay_row_ = nullptr;
+    class EffectSliderRow* fft_overlap_row_         = nullptr;
     class EffectSliderRow* visualizer_decay_row_    = nullptr;
     class EffectSliderRow* visualizer_floor_row_    = nullptr;
     class EffectSliderRow* auto_peak_decay_row_     = nullptr;
@@ -6,6 +6,7 @@
 #include "QtCompat.h"
 #include "ScreenCaptureManager.h"
 #include "ScreenMirror/ScreenMirrorCalibrationPattern.h"
+#include "SpatialEffect3D.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -25,6 +26,7 @@
 #include <functional>
 #include <cmath>
 #include <limits>
+#include <mutex>
 
 CaptureZone::CaptureZone()
     : u_min(0.0f)
@@ -129,7 +131,10 @@ public:
         if(!capture_zones) return;
         CaptureZone new_zone(0.4f, 0.6f, 0.4f, 0.6f);
         new_zone.name = "Zone " + std::to_string(capture_zones->size() + 1);
-        capture_zones->push_back(new_zone);
+        {
+            std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+            capture_zones->push_back(new_zone);
+        }
         selected_zone_index = (int)capture_zones->size() - 1;
         if(valueChangedCallback) valueChangedCallback();
         update();
@@ -321,7 +326,10 @@ protected:
                 {
                     if(capture_zones->size() > 1)
                     {
-                        capture_zones->erase(capture_zones->begin() + i);
+                        {
+                            std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                            capture_zones->erase(capture_zones->begin() + i);
+                        }
                         if(selected_zone_index >= (int)capture_zones->size())
                             selected_zone_index = (int)capture_zones->size() - 1;
                         if(valueChangedCallback) valueChangedCallback();
@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ControllerOutputStage.h"
+#include "PluginLog.h"
+#include "RGBController/RGBController.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+static_assert(std::is_same<RGBColor, unsigned int>::value, "GetFrameBuffer hands out RGBColor buffers");
+
+struct ControllerOutputStage::Device
+{
+    RGBControllerInterface* controller = nullptr;
+    Worker* worker = nullptr;
+    /** GUI thread only: the frame being filled, and the last one that went out. */
+    std::vector<RGBColor> frame;
+    std::vector<RGBColor> last_submitted;
+    std::chrono::steady_clock::time_point last_submit_time;
+    bool has_submitted = false;
+    /** Guarded by worker->mutex: the newest submitted frame and whether the worker still owes it. */
+    std::vector<RGBColor> mailbox;
+    bool pending = false;
+    /** Worker thread only: the frame being written, swapped out of mailbox. */
+    std::vector<RGBColor> writing;
+    bool slow_write_logged = false;
+    DeviceStats stats;
+};
+
+struct ControllerOutputStage::Worker
+{
+    std::string key;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    /** Devices written on this thread; registration happens under mutex. */
+    std::vector<Device*> devices;
+    std::size_t cursor = 0;
+    unsigned int pending_count = 0;
+    bool stopping = false;
+};
+
+namespace
+{
+
+/** "I2C: /dev/i2c-1, address 0x27" -> "I2C: /dev/i2c-1": one queue per SMBus adapter. */
+std::string OutputQueueKey(RGBControllerInterface* controller)
+{
+    std::string location = controller->GetLocation();
+    if(location.empty())
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "device@%p", (void*)controller);
+        return buffer;
+    }
+    if(location.compare(0, 4, "I2C:") == 0 || location.compare(0, 6, "SMBus:") == 0)
+    {
+        const std::size_t address = location.find(", address");
+        if(address != std::string::npos)
+        {
+            location.resize(address);
+        }
+    }
+    return location;
+}
+
+} // namespace
+
+ControllerOutputStage::ControllerOutputStage() = default;
+
+ControllerOutputStage::~ControllerOutputStage()
+{
+    Reset();
+}
+
+void ControllerOutputStage::SetAsync(bool async)
+{
+    if(async == async_)
+    {
+        return;
+    }
+    // Workers may still be writing; make sure no device is driven from two threads.
+    Reset();
+    async_ = async;
+}
+
+ControllerOutputStage::Worker& ControllerOutputStage::FindOrAddWorker(const std::string& key)
+{
+    std::unique_ptr<Worker>& slot = workers_[key];
+    if(!slot)
+    {
+        slot = std::make_unique<Worker>();
+        slot->key = key;
+        slot->thread = std::thread(&ControllerOutputStage::WorkerLoop, this, slot.get());
+    }
+    return *slot;
+}
+
+ControllerOutputStage::Device& ControllerOutputStage::FindOrAddDevice(RGBControllerInterface* controller)
+{
+    std::unique_ptr<Device>& slot = devices_[controller];
+    if(!slot)
+    {
+        slot = std::make_unique<Device>();
+        slot->controller = controller;
+        slot->stats.name = controller->GetName();
+        slot->stats.queue = OutputQueueKey(controller);
+        // No worker owns the device yet, so reading its colours here cannot race a write.
+        const unsigned int led_count = controller->GetLEDCount();
+        slot->frame.resize(led_count);
+        for(unsigned int led_idx = 0; led_idx < led_count; led_idx++)
+        {
+            slot->frame[led_idx] = controller->GetColor(led_idx);
+        }
+        if(async_)
+        {
+            Worker& worker = FindOrAddWorker(slot->stats.queue);
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.devices.push_back(slot.get());
+            slot->worker = &worker;
+        }
+    }
+    return *slot;
+}
+
+unsigned int* ControllerOutputStage::GetFrameBuffer(RGBControllerInterface* controller)
+{
+    Device& device = FindOrAddDevice(controller);
+    // LED counts only change on a resize; new LEDs start black.
+    device.frame.resize(controller->GetLEDCount(), 0);
+    return device.frame.data();
+}
+
+void ControllerOutputStage::Submit(RGBControllerInterface* controller)
+{
+    if(!controller)
+    {
+        return;
+    }
+    Device& device = FindOrAddDevice(controller);
+    device.frame.resize(controller->GetLEDCount(), 0);
+
+    const std::size_t led_count = device.frame.size();
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const bool changed = !device.has_submitted ||
+                         device.last_submitted.size() != led_count ||
+                         (led_count > 0 && std::memcmp(device.last_submitted.data(), device.frame.data(),
+                                                       led_count * sizeof(RGBColor)) != 0);
+    const bool keep_alive = device.has_submitted &&
+                            now - device.last_submit_time >= std::chrono::milliseconds(kKeepAliveMs);
+
+    if(!changed && !keep_alive)
+    {
+        if(device.worker)
+        {
+            std::lock_guard<std::mutex> lock(device.worker->mutex);
+            device.stats.unchanged++;
+        }
+        else
+        {
+            device.stats.unchanged++;
+        }
+        return;
+    }
+
+    device.last_submitted.assign(device.frame.begin(), device.frame.end());
+    device.last_submit_time = now;
+    device.has_submitted = true;
+
+    if(!device.worker)
+    {
+        device.stats.submitted++;
+        for(std::size_t led_idx = 0; led_idx < led_count; led_idx++)
+        {
+            controller->SetColor((unsigned int)led_idx, device.last_submitted[led_idx]);
+        }
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        controller->UpdateLEDs();
+        RecordWrite(device, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        return;
+    }
+
+    Worker& worker = *device.worker;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        device.stats.submitted++;
+        device.mailbox.assign(device.last_submitted.begin(), device.last_submitted.end());
+        if(device.pending)
+        {
+            device.stats.dropped++;
+            return;
+        }
+        device.pending = true;
+        worker.pending_count++;
+    }
+    worker.cv.notify_one();
+}
+
+void ControllerOutputStage::RecordWrite(Device& device, double write_us)
+{
+    DeviceStats& stats = device.stats;
+    stats.written++;
+    stats.last_write_us = write_us;
+    stats.max_write_us = std::max(stats.max_write_us, write_us);
+    // EMA over roughly the last 32 writes; the first write seeds it.
+    stats.average_write_us = (stats.written == 1) ? write_us
+                                                  : stats.average_write_us + (write_us - stats.average_write_us) / 32.0;
+    if(write_us >= kSlowWriteWarnUs && !device.slow_write_logged)
+    {
+        device.slow_write_logged = true;
+        LOG_WARNING("[OpenRGB3DSpatialPlugin] UpdateLEDs on '%s' (%s) took %.1f ms",
+                    stats.name.c_str(), stats.queue.c_str(), write_us / 1000.0);
+    }
+}
+
+void ControllerOutputStage::WorkerLoop(Worker* worker)
+{
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    for(;;)
+    {
+        worker->cv.wait(lock, [worker]() { return worker->stopping || worker->pending_count > 0; });
+        if(worker->stopping)
+        {
+            return;
+        }
+
+        // Round-robin so one device resubmitting every frame cannot starve its bus neighbours.
+        Device* device = nullptr;
+        const std::size_t count = worker->devices.size();
+        for(std::size_t step = 0; step < count; step++)
+        {
+            Device* candidate = worker->devices[(worker->cursor + step) % count];
+            if(candidate->pending)
+            {
+                device = candidate;
+                worker->cursor = (worker->cursor + step + 1) % count;
+                break;
+            }
+        }
+        if(!device)
+        {
+            worker->pending_count = 0;
+            continue;
+        }
+        device->writing.swap(device->mailbox);
+        device->pending = false;
+        worker->pending_count--;
+
+        lock.unlock();
+        RGBControllerInterface* controller = device->controller;
+        const std::size_t led_count = std::min<std::size_t>(device->writing.size(), controller->GetLEDCount());
+        for(std::size_t led_idx = 0; led_idx < led_count; led_idx++)
+        {
+            controller->SetColor((unsigned int)led_idx, device->writing[led_idx]);
+        }
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        controller->UpdateLEDs();
+        const double write_us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        RecordWrite(*device, write_us);
+    }
+}
+
+void ControllerOutputStage::Reset()
+{
+    for(std::pair<const std::string, std::unique_ptr<Worker>>& entry : workers_)
+    {
+        Worker& worker = *entry.second;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.stopping = true;
+        }
+        worker.cv.notify_all();
+    }
+    for(std::pair<const std::string, std::unique_ptr<Worker>>& entry : workers_)
+    {
+        if(entry.second->thread.joinable())
+        {
+            entry.second->thread.join();
+        }
+    }
+    workers_.clear();
+    devices_.clear();
+}
+
+std::vector<ControllerOutputStage::DeviceStats> ControllerOutputStage::GetStats() const
+{
+    std::vector<DeviceStats> stats;
+    stats.reserve(devices_.size());
+    for(const std::pair<RGBControllerInterface* const, std::unique_ptr<Device>>& entry : devices_)
+    {
+        const Device& device = *entry.second;
+        if(device.worker)
+        {
+            std::lock_guard<std::mutex> lock(device.worker->mutex);
+            stats.push_back(device.stats);
+        }
+        else
+        {
+            stats.push_back(device.stats);
+        }
+    }
+    std::sort(stats.begin(), stats.end(), [](const DeviceStats& a, const DeviceStats& b) {
+        return a.queue != b.queue ? a.queue < b.queue : a.name < b.name;
+    });
+    return stats;
+}
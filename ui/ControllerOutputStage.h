@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef CONTROLLEROUTPUTSTAGE_H
+#define CONTROLLEROUTPUTSTAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RGBControllerInterface;
+
+/**
+ * Pushes finished frames to the physical devices off the GUI thread. The GUI writes
+ * each frame into the device's buffer from GetFrameBuffer(), never into the
+ * controller, then calls Submit(): it diffs that buffer against the last submission
+ * and, when something changed, copies the frame into the device's mailbox for its
+ * worker. Workers are keyed by device location, with the address stripped from
+ * I2C/SMBus locations, so devices sharing a bus or handle are written one at a time
+ * and a slow device only delays its own queue.
+ *
+ * A device is pending at most once; frames submitted while it waits replace the
+ * mailbox contents (latest frame wins, counted as dropped). The worker takes the
+ * mailbox and is the only thread that calls SetColor()/UpdateLEDs() on a device it
+ * owns, so the controller's colour array is never written from two threads and a
+ * device never receives colours the diff did not see.
+ *
+ * GetFrameBuffer(), Submit(), Reset(), SetAsync() and GetStats() are GUI-thread only.
+ */
+class ControllerOutputStage
+{
+public:
+    struct DeviceStats
+    {
+        std::string name;
+        /** Worker queue (location) the device is written on. */
+        std::string queue;
+        /** Frames whose colours differed from the previous submission (or keep-alives). */
+        std::uint64_t submitted = 0;
+        /** Frames skipped because no LED changed. */
+        std::uint64_t unchanged = 0;
+        /** Submitted frames replaced by a newer one before the worker reached them. */
+        std::uint64_t dropped = 0;
+        /** Completed UpdateLEDs() calls. */
+        std::uint64_t written = 0;
+        /** UpdateLEDs() wall time, in microseconds. */
+        double last_write_us = 0.0;
+        double average_write_us = 0.0;
+        double max_write_us = 0.0;
+    };
+
+    /** Unchanged devices are still rewritten this often, for hardware that falls back to its own mode. */
+    static constexpr int kKeepAliveMs = 1000;
+    /** A single UpdateLEDs() beyond this is logged once per device. */
+    static constexpr double kSlowWriteWarnUs = 100000.0;
+
+    ControllerOutputStage();
+    ~ControllerOutputStage();
+
+    ControllerOutputStage(const ControllerOutputStage&) = delete;
+    ControllerOutputStage& operator=(const ControllerOutputStage&) = delete;
+
+    /**
+     * Colours the next Submit() sends, one per controller LED (GetLEDCount()). Seeded from
+     * the controller when the device is first seen; valid until the next call for the same
+     * controller or Reset().
+     */
+    unsigned int* GetFrameBuffer(RGBControllerInterface* controller);
+
+    void Submit(RGBControllerInterface* controller);
+
+    /** Joins every worker (waiting out in-flight writes) and forgets all devices; call before controllers go away. */
+    void Reset();
+
+    /** False writes changed devices inline in Submit(), still skipping unchanged ones. */
+    void SetAsync(bool async);
+    bool IsAsync() const { return async_; }
+
+    std::vector<DeviceStats> GetStats() const;
+
+private:
+    struct Device;
+    struct Worker;
+
+    Device& FindOrAddDevice(RGBControllerInterface* controller);
+    Worker& FindOrAddWorker(const std::string& key);
+    static void RecordWrite(Device& device, double write_us);
+    void WorkerLoop(Worker* worker);
+
+    std::unordered_map<RGBControllerInterface*, std::unique_ptr<Device>> devices_;
+    std::unordered_map<std::string, std::unique_ptr<Worker>> workers_;
+    bool async_ = true;
+};
+
+#endif
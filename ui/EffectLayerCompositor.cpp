@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "EffectLayerCompositor.h"
+
+#include <algorithm>
+
+namespace
+{
+/** accum = op(accum, layer) per channel; op sees both sides as 0..255 floats. */
+template<typename Op>
+void BlendPass(float* r, float* g, float* b, const RGBColor* layer, size_t count, Op op)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        const RGBColor c = layer[i];
+        r[i] = op(r[i], (float)(c & 0xFF));
+        g[i] = op(g[i], (float)((c >> 8) & 0xFF));
+        b[i] = op(b[i], (float)((c >> 16) & 0xFF));
+    }
+}
+
+inline int QuantizeChannel(float v)
+{
+    return std::clamp((int)v, 0, 255);
+}
+
+/** Low-bias 32-bit integer hash (avalanche for consecutive indices). */
+inline std::uint32_t HashIndex(std::uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+}
+
+void LayerAccumulator::Reset(size_t count)
+{
+    r_.assign(count, 0.0f);
+    g_.assign(count, 0.0f);
+    b_.assign(count, 0.0f);
+}
+
+void LayerAccumulator::Blend(const RGBColor* layer, size_t count, BlendMode mode)
+{
+    float* r = r_.data();
+    float* g = g_.data();
+    float* b = b_.data();
+    const float inv_255 = 1.0f / 255.0f;
+
+    switch(mode)
+    {
+        case BlendMode::NO_BLEND:
+        case BlendMode::REPLACE:
+            BlendPass(r, g, b, layer, count, [](float, float o) { return o; });
+            break;
+
+        case BlendMode::ADD:
+            BlendPass(r, g, b, layer, count, [](float a, float o) { return std::min(a + o, 255.0f); });
+            break;
+
+        case BlendMode::MULTIPLY:
+            BlendPass(r, g, b, layer, count, [inv_255](float a, float o) { return a * o * inv_255; });
+            break;
+
+        case BlendMode::SCREEN:
+            BlendPass(r, g, b, layer, count,
+                      [inv_255](float a, float o) { return 255.0f - (255.0f - a) * (255.0f - o) * inv_255; });
+            break;
+
+        case BlendMode::MAX:
+            BlendPass(r, g, b, layer, count, [](float a, float o) { return std::max(a, o); });
+            break;
+
+        case BlendMode::MIN:
+            BlendPass(r, g, b, layer, count, [](float a, float o) { return std::min(a, o); });
+            break;
+
+        default:
+            break;
+    }
+}
+
+void LayerAccumulator::Quantize(RGBColor* out, size_t count) const
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        out[i] = ToRGBColor(QuantizeChannel(r_[i] + 0.5f),
+                            QuantizeChannel(g_[i] + 0.5f),
+                            QuantizeChannel(b_[i] + 0.5f));
+    }
+}
+
+void LayerAccumulator::QuantizeDithered(RGBColor* out,
+                                        size_t count,
+                                        std::uint32_t first_index,
+                                        std::uint32_t frame) const
+{
+    // Golden-ratio step in 32-bit fixed point; the top 24 bits become the threshold.
+    const std::uint32_t frame_offset = frame * 0x9E3779B9u;
+    const float to_unit = 1.0f / 16777216.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        const std::uint32_t bits = HashIndex(first_index + (std::uint32_t)i) + frame_offset;
+        const float threshold = (float)(bits >> 8) * to_unit;
+        out[i] = ToRGBColor(QuantizeChannel(r_[i] + threshold),
+                            QuantizeChannel(g_[i] + threshold),
+                            QuantizeChannel(b_[i] + threshold));
+    }
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef EFFECTLAYERCOMPOSITOR_H
+#define EFFECTLAYERCOMPOSITOR_H
+
+#include "EffectInstance3D.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Float accumulation for one batch of stack samples (a controller slice or an overlay plane).
+ * Each layer is blended in as one whole-buffer pass per mode over planar channels in the
+ * 0..255 range BlendColors works in, so the modes keep their look (ADD still saturates per
+ * layer) but nothing is truncated between layers or before ambient shading. The result is
+ * quantized once, optionally with temporal dithering.
+ */
+class LayerAccumulator
+{
+public:
+    /** Sizes to count samples, all black. */
+    void Reset(size_t count);
+
+    /** BlendColors(accum[i], layer[i], mode) for every sample, without the 8-bit round trip. */
+    void Blend(const RGBColor* layer, size_t count, BlendMode mode);
+
+    bool IsBlack(size_t i) const
+    {
+        return r_[i] <= 0.0f && g_[i] <= 0.0f && b_[i] <= 0.0f;
+    }
+
+    void Scale(size_t i, float factor)
+    {
+        r_[i] *= factor;
+        g_[i] *= factor;
+        b_[i] *= factor;
+    }
+
+    /** Round to nearest. */
+    void Quantize(RGBColor* out, size_t count) const;
+
+    /**
+     * Adds a per-sample threshold in [0, 1) before truncating: hashed from first_index + i so
+     * neighbours decorrelate, stepped by the golden ratio each frame so every sample's
+     * thresholds spread evenly over time. Fractional levels then average out on the LED
+     * instead of banding.
+     */
+    void QuantizeDithered(RGBColor* out, size_t count, std::uint32_t first_index, std::uint32_t frame) const;
+
+private:
+    std::vector<float> r_;
+    std::vector<float> g_;
+    std::vector<float> b_;
+};
+
+#endif
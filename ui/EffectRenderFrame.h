@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef EFFECTRENDERFRAME_H
+#define EFFECTRENDERFRAME_H
+
+#include "SpatialEffect3D.h"
+#include "EffectInstance3D.h"
+#include "LEDPosition3D.h"
+#include "LedFrameLayout3D.h"
+#include "SpatialLighting/EmitterLocalSampling.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct RenderEffectSlot
+{
+    SpatialEffect3D* effect = nullptr;
+    /** EffectInstance3D::render_settings when the snapshot was built; null = effect is already current. */
+    std::shared_ptr<const nlohmann::json> settings;
+    int zone_index = -1;
+    BlendMode blend_mode = BlendMode::REPLACE;
+    /** Copy of Zone3D::GetControllers() for zone_index >= 0 (worker never touches ZoneManager3D). */
+    std::vector<int> zone_controllers;
+};
+
+struct EffectSlotGridOverride
+{
+    bool use_zone_grid = false;
+    bool use_anchor_grid = false;
+    std::unique_ptr<GridContext3D> room_grid_local;
+    std::unique_ptr<GridContext3D> world_grid_local;
+};
+
+/**
+ * Everything the LED / overlay evaluation needs, captured on the GUI thread.
+ * The render worker only reads it. While the worker runs it owns the slot effects:
+ * the GUI publishes parameter edits as slot settings and SyncRenderSnapshotEffects
+ * loads them under SpatialEffect3D::RenderStateMutex(), so evaluation itself runs
+ * without the lock.
+ */
+struct EffectRenderSnapshot
+{
+    EffectRenderSnapshot(const GridContext3D& world, const GridContext3D& room)
+        : world_grid(world), room_grid(room)
+    {
+    }
+
+    std::uint64_t generation = 0;
+    GridContext3D world_grid;
+    GridContext3D room_grid;
+    /** Stack origin, also the radial key for the UpdateLEDs ordering on apply. */
+    Vector3D stack_ref_origin{};
+    ReferenceMode stack_origin_mode = REF_MODE_USER_POSITION;
+    std::vector<RenderEffectSlot> slots;
+    std::vector<EffectSlotGridOverride> slot_grid_overrides;
+
+    size_t relay_stack_index = 0;
+    SpatialEffect3D* relay_layer_effect = nullptr;
+    EmitterLocalSampling::CombinedEmitterCanvas emitter_canvas;
+
+    /** Rendered LEDs / controller spans; shared with the layout cache until the layout epoch moves. */
+    std::shared_ptr<const LedFrameLayout3D> layout;
+    /**
+     * Copy of controller_transforms taken with the layout (same epoch), so occluders and the emitter relay
+     * mirror are rebuilt on the worker without reading transforms the GUI is editing.
+     */
+    std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>> scene;
+
+    /** LED colours quantize with a per-frame dither threshold instead of rounding (Render.TemporalDither). */
+    bool temporal_dither = false;
+
+    bool overlay_enabled = false;
+    /** While effects run, each frame refreshes a rotating window of overlay Z slabs so LED output keeps the budget. */
+    bool overlay_progressive = false;
+    std::vector<float> overlay_axis_x;
+    std::vector<float> overlay_axis_y;
+    std::vector<float> overlay_axis_z;
+};
+
+struct EffectRenderOutput
+{
+    std::shared_ptr<const EffectRenderSnapshot> snapshot;
+    float time = 0.0f;
+    /** Parallel to the snapshot layout's SoA streams. */
+    std::vector<RGBColor> led_colors;
+    bool overlay_valid = false;
+    /** Last completed overlay sweep; shared with the evaluator state and the viewport, never written again. */
+    std::shared_ptr<const std::vector<RGBColor>> overlay_colors;
+};
+
+#endif
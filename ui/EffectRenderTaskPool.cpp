@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "EffectRenderTaskPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+
+std::uint64_t PackBounds(std::uint32_t head, std::uint32_t tail)
+{
+    return (std::uint64_t)head | ((std::uint64_t)tail << 32);
+}
+
+std::uint32_t BoundsHead(std::uint64_t bounds)
+{
+    return (std::uint32_t)(bounds & 0xFFFFFFFFull);
+}
+
+std::uint32_t BoundsTail(std::uint64_t bounds)
+{
+    return (std::uint32_t)(bounds >> 32);
+}
+
+} // namespace
+
+EffectRenderTaskPool::EffectRenderTaskPool()
+    : queues_(std::make_unique<SlotQueue[]>(1)),
+      queue_count_(1)
+{
+}
+
+EffectRenderTaskPool::~EffectRenderTaskPool()
+{
+    StopWorkers();
+}
+
+unsigned int EffectRenderTaskPool::DefaultWorkerCount()
+{
+    const unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 1u ? hw - 1u : 0u;
+}
+
+void EffectRenderTaskPool::SetWorkerCount(unsigned int workers)
+{
+    workers = std::min(workers, DefaultWorkerCount());
+    if(workers == threads_.size())
+    {
+        return;
+    }
+
+    StopWorkers();
+
+    queue_count_ = workers + 1u;
+    queues_ = std::make_unique<SlotQueue[]>(queue_count_);
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        stopping_ = false;
+        job_open_ = false;
+    }
+    threads_.reserve(workers);
+    for(unsigned int worker = 0; worker < workers; worker++)
+    {
+        threads_.emplace_back(&EffectRenderTaskPool::WorkerLoop, this, worker + 1u);
+    }
+}
+
+void EffectRenderTaskPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        stopping_ = true;
+    }
+    job_cv_.notify_all();
+    for(std::thread& thread : threads_)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+void EffectRenderTaskPool::Run(const std::vector<TaskRange>& ranges, const RangeTask& task)
+{
+    using clock = std::chrono::steady_clock;
+
+    if(ranges.empty())
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_stats_ = FrameStats{};
+        return;
+    }
+
+    if(running_.exchange(true))
+    {
+        for(const TaskRange& range : ranges)
+        {
+            task(range.begin, range.end, 0u);
+        }
+        return;
+    }
+
+    const clock::time_point start = clock::now();
+
+    ranges_ = &ranges;
+    task_ = &task;
+    steals_.store(0);
+    slots_used_.store(0);
+    longest_range_ns_.store(0);
+
+    // Contiguous blocks per slot keep neighbouring LEDs (and their caches) on one thread until stolen.
+    const std::size_t range_count = ranges.size();
+    for(unsigned int slot = 0; slot < queue_count_; slot++)
+    {
+        const std::uint32_t head = (std::uint32_t)(range_count * slot / queue_count_);
+        const std::uint32_t tail = (std::uint32_t)(range_count * (slot + 1u) / queue_count_);
+        queues_[slot].bounds.store(PackBounds(head, tail));
+    }
+
+    if(!threads_.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            job_open_ = true;
+            ++job_generation_;
+        }
+        job_cv_.notify_all();
+    }
+
+    DrainRanges(0u);
+
+    if(!threads_.empty())
+    {
+        // Queues are empty once the caller drains; wait out ranges still running on workers.
+        std::unique_lock<std::mutex> lock(job_mutex_);
+        job_open_ = false;
+        idle_cv_.wait(lock, [this]() { return active_workers_ == 0; });
+    }
+
+    ranges_ = nullptr;
+    task_ = nullptr;
+
+    FrameStats stats;
+    stats.run_us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    stats.longest_range_us = (double)longest_range_ns_.load() / 1000.0;
+    stats.ranges = (unsigned int)range_count;
+    stats.slots_used = slots_used_.load();
+    stats.steals = steals_.load();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_stats_ = stats;
+    }
+
+    running_.store(false);
+}
+
+EffectRenderTaskPool::FrameStats EffectRenderTaskPool::GetLastFrameStats() const
+{
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_stats_;
+}
+
+void EffectRenderTaskPool::WorkerLoop(unsigned int slot)
+{
+    std::uint64_t seen_generation = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(job_mutex_);
+            job_cv_.wait(lock, [this, seen_generation]() {
+                return stopping_ || (job_open_ && job_generation_ != seen_generation);
+            });
+            if(stopping_)
+            {
+                return;
+            }
+            seen_generation = job_generation_;
+            ++active_workers_;
+        }
+
+        DrainRanges(slot);
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            --active_workers_;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+void EffectRenderTaskPool::DrainRanges(unsigned int slot)
+{
+    using clock = std::chrono::steady_clock;
+
+    unsigned int processed = 0;
+    std::uint32_t index = 0;
+    while(PopOwn(slot, &index) || StealOther(slot, &index))
+    {
+        const TaskRange& range = (*ranges_)[index];
+        const clock::time_point start = clock::now();
+        (*task_)(range.begin, range.end, slot);
+        const std::uint64_t elapsed_ns =
+            (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+        std::uint64_t longest = longest_range_ns_.load(std::memory_order_relaxed);
+        while(elapsed_ns > longest &&
+              !longest_range_ns_.compare_exchange_weak(longest, elapsed_ns, std::memory_order_relaxed))
+        {
+        }
+        processed++;
+    }
+    if(processed > 0)
+    {
+        slots_used_.fetch_add(1);
+    }
+}
+
+bool EffectRenderTaskPool::PopOwn(unsigned int slot, std::uint32_t* index)
+{
+    std::atomic<std::uint64_t>& bounds = queues_[slot].bounds;
+    std::uint64_t current = bounds.load();
+    while(true)
+    {
+        const std::uint32_t head = BoundsHead(current);
+        const std::uint32_t tail = BoundsTail(current);
+        if(head >= tail)
+        {
+            return false;
+        }
+        if(bounds.compare_exchange_weak(current, PackBounds(head + 1u, tail)))
+        {
+            *index = head;
+            return true;
+        }
+    }
+}
+
+bool EffectRenderTaskPool::StealOther(unsigned int slot, std::uint32_t* index)
+{
+    for(unsigned int offset = 1; offset < queue_count_; offset++)
+    {
+        std::atomic<std::uint64_t>& bounds = queues_[(slot + offset) % queue_count_].bounds;
+        std::uint64_t current = bounds.load();
+        while(true)
+        {
+            const std::uint32_t head = BoundsHead(current);
+            const std::uint32_t tail = BoundsTail(current);
+            if(head >= tail)
+            {
+                break;
+            }
+            if(bounds.compare_exchange_weak(current, PackBounds(head, tail - 1u)))
+            {
+                *index = tail - 1u;
+                steals_.fetch_add(1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
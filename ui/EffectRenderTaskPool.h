@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef EFFECTRENDERTASKPOOL_H
+#define EFFECTRENDERTASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing pool for the per-frame LED evaluation. Run() hands out a fixed
+ * list of [begin, end) ranges: each worker slot starts with a contiguous block of
+ * them and pops from its front, idle slots steal from the back of the others.
+ * Slot 0 is always the calling thread, so a pool with no workers runs inline.
+ *
+ * The slot index passed to the task is stable for the duration of one range, so
+ * callers can keep per-slot scratch in a plain vector. Run() is not re-entrant;
+ * a nested call evaluates its ranges inline on the caller.
+ */
+class EffectRenderTaskPool
+{
+public:
+    struct TaskRange
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    using RangeTask = std::function<void(std::size_t begin, std::size_t end, unsigned int slot)>;
+
+    struct FrameStats
+    {
+        /** Wall time of the last Run(), in microseconds. */
+        double run_us = 0.0;
+        /** Longest single range of the last Run(), in microseconds. */
+        double longest_range_us = 0.0;
+        unsigned int ranges = 0;
+        unsigned int slots_used = 0;
+        unsigned int steals = 0;
+    };
+
+    EffectRenderTaskPool();
+    ~EffectRenderTaskPool();
+
+    EffectRenderTaskPool(const EffectRenderTaskPool&) = delete;
+    EffectRenderTaskPool& operator=(const EffectRenderTaskPool&) = delete;
+
+    /** Background threads besides the caller; clamped to hardware_concurrency() - 1. */
+    void SetWorkerCount(unsigned int workers);
+    unsigned int GetWorkerCount() const { return (unsigned int)threads_.size(); }
+    /** Workers + the calling thread: size for per-slot scratch. */
+    unsigned int GetSlotCount() const { return GetWorkerCount() + 1u; }
+
+    /** hardware_concurrency() - 1, at least 0. */
+    static unsigned int DefaultWorkerCount();
+
+    void Run(const std::vector<TaskRange>& ranges, const RangeTask& task);
+
+    FrameStats GetLastFrameStats() const;
+
+private:
+    /** head (low 32 bits) / tail (high 32 bits) into ranges_; owner pops head, thieves take tail. */
+    struct alignas(64) SlotQueue
+    {
+        std::atomic<std::uint64_t> bounds{0};
+    };
+
+    void StopWorkers();
+    void WorkerLoop(unsigned int slot);
+    void DrainRanges(unsigned int slot);
+    bool PopOwn(unsigned int slot, std::uint32_t* index);
+    bool StealOther(unsigned int slot, std::uint32_t* index);
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<SlotQueue[]> queues_;
+    unsigned int queue_count_ = 0;
+
+    std::mutex job_mutex_;
+    std::condition_variable job_cv_;
+    std::condition_variable idle_cv_;
+    std::uint64_t job_generation_ = 0;
+    bool job_open_ = false;
+    bool stopping_ = false;
+    unsigned int active_workers_ = 0;
+
+    const std::vector<TaskRange>* ranges_ = nullptr;
+    const RangeTask* task_ = nullptr;
+    std::atomic<unsigned int> steals_{0};
+    std::atomic<unsigned int> slots_used_{0};
+    std::atomic<std::uint64_t> longest_range_ns_{0};
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex stats_mutex_;
+    FrameStats last_stats_;
+};
+
+#endif
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "EffectRenderWorker.h"
+
+#include <algorithm>
+#include <chrono>
+
+EffectRenderWorker::EffectRenderWorker(FrameCallback callback)
+    : callback_(std::move(callback))
+{
+}
+
+EffectRenderWorker::~EffectRenderWorker()
+{
+    Stop();
+}
+
+void EffectRenderWorker::Start(unsigned int target_fps)
+{
+    SetTargetFPS(target_fps);
+    if(running_.load())
+    {
+        return;
+    }
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+    late_frames_.store(0);
+    running_.store(true);
+    thread_ = std::thread(&EffectRenderWorker::RenderLoop, this);
+}
+
+void EffectRenderWorker::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_.store(false);
+    }
+    wake_cv_.notify_all();
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void EffectRenderWorker::SetTargetFPS(unsigned int target_fps)
+{
+    target_fps_.store(std::clamp(target_fps, 1u, 240u));
+    wake_cv_.notify_all();
+}
+
+void EffectRenderWorker::RenderLoop()
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point last_tick = clock::now();
+    clock::time_point next_frame = last_tick;
+
+    while(running_.load())
+    {
+        const clock::duration period =
+            std::chrono::duration_cast<clock::duration>(std::chrono::microseconds(1000000 / target_fps_.load()));
+
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_until(lock, next_frame, [this, &next_frame]() {
+                return !running_.load() || clock::now() >= next_frame;
+            });
+        }
+        if(!running_.load())
+        {
+            break;
+        }
+
+        const clock::time_point now = clock::now();
+        float dt = std::chrono::duration<float>(now - last_tick).count();
+        last_tick = now;
+        if(dt <= 0.0f) dt = 1.0f / (float)target_fps_.load();
+        if(dt > 0.1f) dt = 0.1f;
+
+        if(callback_)
+        {
+            callback_(dt);
+        }
+
+        next_frame += period;
+        const clock::time_point after = clock::now();
+        if(after > next_frame + period)
+        {
+            // Fell more than a frame behind (slow stack, debugger, suspend): resync instead of bursting.
+            late_frames_.fetch_add(1);
+            next_frame = after + period;
+        }
+    }
+}
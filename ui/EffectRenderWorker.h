@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef EFFECTRENDERWORKER_H
+#define EFFECTRENDERWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Frame-paced clock for the effect stack. Runs the frame callback on its own
+ * thread at the target FPS (steady_clock deadlines, no QTimer coalescing) so
+ * LED evaluation does not compete with viewport paint / input on the Qt thread.
+ * The callback receives the elapsed seconds since the previous tick, clamped to
+ * 0.1 s like the old timer path.
+ */
+class EffectRenderWorker
+{
+public:
+    using FrameCallback = std::function<void(float dt)>;
+
+    explicit EffectRenderWorker(FrameCallback callback);
+    ~EffectRenderWorker();
+
+    void Start(unsigned int target_fps);
+    void Stop();
+    bool IsRunning() const { return running_.load(); }
+
+    void SetTargetFPS(unsigned int target_fps);
+    unsigned int GetTargetFPS() const { return target_fps_.load(); }
+
+    /** Frames whose deadline was missed by more than one period (worker fell behind). */
+    unsigned long long GetLateFrameCount() const { return late_frames_.load(); }
+
+private:
+    void RenderLoop();
+
+    FrameCallback callback_;
+    std::atomic<bool> running_{false};
+    std::atomic<unsigned int> target_fps_{30};
+    std::atomic<unsigned long long> late_frames_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::thread thread_;
+};
+
+#endif
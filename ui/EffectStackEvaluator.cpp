@@ -0,0 +1,1283 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "EffectStackEvaluator.h"
+#include "ControllerLayout3D.h"
+#include "EffectRenderTaskPool.h"
+#include "GridSpaceUtils.h"
+#include "ScreenCaptureManager.h"
+#include "Effects3D/Games/Minecraft/MinecraftGame.h"
+#include "Effects3D/SpatialLighting/RoomSpatialLightingUi.h"
+#include "SpatialLighting/SpatialLightingSceneProvider.h"
+#include "SpatialRoom/SpatialRoomFrame.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+std::atomic<std::uint64_t> g_effect_render_sequence{0};
+/** Process-wide so overlays of different evaluator states never share a voxel shade key in the provider. */
+std::atomic<std::uint64_t> g_overlay_axes_serial{0};
+}
+
+std::uint64_t NextEffectRenderSequence()
+{
+    return ++g_effect_render_sequence;
+}
+
+const GridContext3D* ResolveActiveSlotGrid(const EffectSlotGridOverride& slot_override,
+                                           bool use_world_bounds)
+{
+    if(slot_override.use_zone_grid || slot_override.use_anchor_grid)
+    {
+        return use_world_bounds ? slot_override.world_grid_local.get() : slot_override.room_grid_local.get();
+    }
+    return nullptr;
+}
+
+bool EffectSlotAppliesToController(const RenderEffectSlot& slot, int ctrl_idx)
+{
+    if(slot.zone_index == -1)
+    {
+        return true;
+    }
+    if(slot.zone_index <= -1000)
+    {
+        const int target_ctrl_idx = -(slot.zone_index + 1000);
+        return target_ctrl_idx >= 0 && target_ctrl_idx == ctrl_idx;
+    }
+    return std::find(slot.zone_controllers.begin(), slot.zone_controllers.end(), ctrl_idx) != slot.zone_controllers.end();
+}
+
+bool ShouldApplyStackLayerToController(const SpatialEffect3D* effect,
+                                       size_t effect_index,
+                                       size_t relay_stack_index,
+                                       bool has_relay_stack,
+                                       int ctrl_idx,
+                                       const std::unordered_set<int>* relay_emitter_indices)
+{
+    if(!effect)
+    {
+        return false;
+    }
+    const auto is_relay_emitter = [&](int index) -> bool {
+        if(relay_emitter_indices)
+        {
+            return relay_emitter_indices->find(index) != relay_emitter_indices->end();
+        }
+        return SpatialLightingSceneProvider::instance()->isEmitterController(index);
+    };
+    if(has_relay_stack)
+    {
+        if(effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::Direct &&
+           !is_relay_emitter(ctrl_idx))
+        {
+            return false;
+        }
+        if(effect_index < relay_stack_index && !is_relay_emitter(ctrl_idx))
+        {
+            return false;
+        }
+    }
+    if(!effect->appliesRoomOutputToController(ctrl_idx))
+    {
+        return false;
+    }
+    return true;
+}
+
+SpatialLighting::OccluderBuildOptions MergeStackOccluderOptions(const std::vector<RenderEffectSlot>& effect_slots)
+{
+    SpatialLighting::OccluderBuildOptions merged{};
+    for(const RenderEffectSlot& effect_slot : effect_slots)
+    {
+        if(!effect_slot.effect)
+        {
+            continue;
+        }
+        const RoomSpatialLightingUi::RoomSpatialLightParams& params = effect_slot.effect->roomRelayParams();
+        if(!params.use_occlusion)
+        {
+            continue;
+        }
+        const SpatialLighting::OccluderBuildOptions layer_opts =
+            RoomSpatialLightingUi::BuildOccluderOptions(params);
+        merged.display_planes |= layer_opts.display_planes;
+        merged.room_walls |= layer_opts.room_walls;
+        merged.controllers |= layer_opts.controllers;
+        merged.light_blockers |= layer_opts.light_blockers;
+    }
+    return merged;
+}
+
+RGBColor SamplePatternOnEmitterCanvas(SpatialEffect3D* effect,
+                                      float room_x,
+                                      float room_y,
+                                      float room_z,
+                                      float time,
+                                      const GridContext3D* canvas_grid)
+{
+    if(!effect || !canvas_grid)
+    {
+        return 0x00000000;
+    }
+    return effect->EvaluateColorGrid(room_x, room_y, room_z, time, *canvas_grid);
+}
+
+RGBColor SampleStackLayerColor(SpatialEffect3D* effect,
+                               float x,
+                               float y,
+                               float z,
+                               float time,
+                               const GridContext3D& grid)
+{
+    if(!effect)
+    {
+        return 0x00000000;
+    }
+    return effect->EvaluateColorGrid(x, y, z, time, grid);
+}
+
+EffectRenderFrameGuard::EffectRenderFrameGuard()
+{
+    SpatialRoom::BeginEffectRenderFrame();
+}
+
+EffectRenderFrameGuard::~EffectRenderFrameGuard()
+{
+    SpatialRoom::EndEffectRenderFrame();
+}
+
+RenderTickSnapshotGuard::RenderTickSnapshotGuard(ScreenCaptureManager& m)
+    : mgr(m)
+{
+    mgr.BeginRenderTickSnapshot();
+}
+
+RenderTickSnapshotGuard::~RenderTickSnapshotGuard()
+{
+    mgr.EndRenderTickSnapshot();
+}
+
+namespace
+{
+
+const SpatialEffect3D* ResolveOverlayAmbientShadeSource(const std::vector<RenderEffectSlot>& effect_slots)
+{
+    for(size_t effect_idx = effect_slots.size(); effect_idx-- > 0;)
+    {
+        const SpatialEffect3D* effect = effect_slots[effect_idx].effect;
+        if(!effect)
+        {
+            continue;
+        }
+        if(effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
+        {
+            continue;
+        }
+        if(effect->roomRelayParams().use_occlusion)
+        {
+            return effect;
+        }
+    }
+    return nullptr;
+}
+
+bool IsRelayOnlyReceiver(const SpatialEffect3D* relay_effect, int ctrl_idx)
+{
+    return relay_effect &&
+           relay_effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay &&
+           relay_effect->isRoomReceiverController(ctrl_idx) &&
+           !relay_effect->isRoomEmitterController(ctrl_idx);
+}
+
+bool IsRelayEmitter(const SpatialEffect3D* relay_effect, int ctrl_idx)
+{
+    return relay_effect &&
+           relay_effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay &&
+           relay_effect->isRoomEmitterController(ctrl_idx);
+}
+
+/** Calls fn(slot_idx) for every layer set in mask, in stack order. */
+template<typename Fn>
+void ForEachPlannedLayer(const std::uint64_t* mask, size_t mask_words, Fn fn)
+{
+    for(size_t word = 0; word < mask_words; word++)
+    {
+        size_t slot_idx = word * 64u;
+        for(std::uint64_t bits = mask[word]; bits != 0; bits >>= 1, slot_idx++)
+        {
+            if(bits & 1u)
+            {
+                fn(slot_idx);
+            }
+        }
+    }
+}
+
+/**
+ * Everything the plan depends on. Stack, zone and layout edits bump generation / epoch; relay role,
+ * emitter / receiver lists and occlusion toggles bump the effect's roomRoutingRevision.
+ */
+std::uint64_t RenderPlanKey(const EffectRenderSnapshot& snapshot)
+{
+    std::uint64_t hash = 1469598103934665603ull;
+    const auto mix = [&hash](std::uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+    mix(snapshot.generation);
+    mix(snapshot.layout->epoch);
+    mix(snapshot.layout->controllers.size());
+    mix(snapshot.relay_stack_index);
+    mix(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(snapshot.relay_layer_effect)));
+    for(const RenderEffectSlot& slot : snapshot.slots)
+    {
+        mix(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(slot.effect)));
+        mix(static_cast<std::uint64_t>(static_cast<std::int64_t>(slot.zone_index)));
+        mix(slot.effect ? slot.effect->roomRoutingRevision() : 0u);
+        mix(slot.zone_controllers.size());
+        for(int ctrl_idx : slot.zone_controllers)
+        {
+            mix(static_cast<std::uint64_t>(static_cast<std::int64_t>(ctrl_idx)));
+        }
+    }
+    return hash;
+}
+
+void CompileRenderPlan(const EffectRenderSnapshot& snapshot, EffectStackRenderPlan& plan)
+{
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    const size_t span_count = layout.controllers.size();
+    const bool has_relay_stack = snapshot.relay_layer_effect != nullptr;
+
+    plan.mask_words = std::max<size_t>(1u, (active_effects.size() + 63u) / 64u);
+    plan.span_layer_masks.assign(span_count * plan.mask_words, 0u);
+    plan.span_shade_slots.assign(span_count, -1);
+    plan.span_relay_only_receiver.assign(span_count, 0);
+    plan.span_relay_emitter.assign(span_count, 0);
+
+    for(size_t span_idx = 0; span_idx < span_count; span_idx++)
+    {
+        const int ctrl_idx = static_cast<int>(layout.controllers[span_idx].ctrl_idx);
+        std::uint64_t* mask = plan.span_layer_masks.data() + span_idx * plan.mask_words;
+        for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
+        {
+            const RenderEffectSlot& slot = active_effects[effect_idx];
+            if(!slot.effect || !EffectSlotAppliesToController(slot, ctrl_idx))
+            {
+                continue;
+            }
+            if(!ShouldApplyStackLayerToController(slot.effect,
+                                                  effect_idx,
+                                                  snapshot.relay_stack_index,
+                                                  has_relay_stack,
+                                                  ctrl_idx))
+            {
+                continue;
+            }
+            mask[effect_idx / 64u] |= std::uint64_t{1} << (effect_idx % 64u);
+            if(slot.effect->GetRoomOutputRole() != SpatialRoom::SpatialRoomOutputRole::EmitterRelay &&
+               slot.effect->roomRelayParams().use_occlusion)
+            {
+                plan.span_shade_slots[span_idx] = static_cast<int>(effect_idx);
+            }
+        }
+        plan.span_relay_only_receiver[span_idx] = IsRelayOnlyReceiver(snapshot.relay_layer_effect, ctrl_idx) ? 1 : 0;
+        plan.span_relay_emitter[span_idx] = IsRelayEmitter(snapshot.relay_layer_effect, ctrl_idx) ? 1 : 0;
+    }
+}
+
+/** The state's plan, recompiled when RenderPlanKey moves. */
+const EffectStackRenderPlan& AcquireRenderPlan(const EffectRenderSnapshot& snapshot, EffectStackEvaluatorState& state)
+{
+    EffectStackRenderPlan& plan = state.plan;
+    const std::uint64_t key = RenderPlanKey(snapshot);
+    if(!plan.compiled || plan.key != key)
+    {
+        CompileRenderPlan(snapshot, plan);
+        plan.key = key;
+        plan.compiled = true;
+    }
+    return plan;
+}
+
+/**
+ * Grid copies stamped with this evaluation's render_sequence. A snapshot can be
+ * evaluated more than once (worker ticks faster than the GUI rebuilds it), and
+ * ScreenMirror / ShaderField / MinecraftGame refresh their per-frame caches by sequence.
+ */
+struct EvaluationGrids
+{
+    EvaluationGrids(const EffectRenderSnapshot& snapshot, std::uint64_t render_sequence)
+        : world_grid(snapshot.world_grid),
+          room_grid(snapshot.room_grid)
+    {
+        world_grid.render_sequence = render_sequence;
+        room_grid.render_sequence = render_sequence;
+
+        slot_grids.resize(snapshot.slot_grid_overrides.size());
+        for(size_t slot_idx = 0; slot_idx < snapshot.slot_grid_overrides.size(); slot_idx++)
+        {
+            const EffectSlotGridOverride& source = snapshot.slot_grid_overrides[slot_idx];
+            EffectSlotGridOverride& target = slot_grids[slot_idx];
+            target.use_zone_grid = source.use_zone_grid;
+            target.use_anchor_grid = source.use_anchor_grid;
+            if(source.room_grid_local)
+            {
+                target.room_grid_local = std::make_unique<GridContext3D>(*source.room_grid_local);
+                target.room_grid_local->render_sequence = render_sequence;
+            }
+            if(source.world_grid_local)
+            {
+                target.world_grid_local = std::make_unique<GridContext3D>(*source.world_grid_local);
+                target.world_grid_local->render_sequence = render_sequence;
+            }
+        }
+
+        if(snapshot.emitter_canvas.valid && snapshot.emitter_canvas.grid)
+        {
+            emitter_grid = std::make_unique<GridContext3D>(*snapshot.emitter_canvas.grid);
+            emitter_grid->render_sequence = render_sequence;
+        }
+
+        slot_stack_grids.assign(snapshot.slots.size(), nullptr);
+        for(size_t slot_idx = 0; slot_idx < snapshot.slots.size() && slot_idx < slot_grids.size(); slot_idx++)
+        {
+            const RenderEffectSlot& slot = snapshot.slots[slot_idx];
+            if(!slot.effect)
+            {
+                continue;
+            }
+            const EffectSlotGridOverride& grid_override = slot_grids[slot_idx];
+            if(slot.effect->UseZoneGrid() && slot.zone_index != -1 && !grid_override.use_zone_grid)
+            {
+                continue;
+            }
+            const bool use_world_bounds = slot.effect->UseWorldGridBounds();
+            const GridContext3D* local_grid = ResolveActiveSlotGrid(grid_override, use_world_bounds);
+            slot_stack_grids[slot_idx] = local_grid ? local_grid : (use_world_bounds ? &world_grid : &room_grid);
+        }
+    }
+
+    GridContext3D world_grid;
+    GridContext3D room_grid;
+    std::vector<EffectSlotGridOverride> slot_grids;
+    std::unique_ptr<GridContext3D> emitter_grid;
+    /** Per slot, bound once per evaluation: the grid stack / overlay batches use; nullptr = layer skipped. */
+    std::vector<const GridContext3D*> slot_stack_grids;
+};
+
+/**
+ * Samples the stack on every emitter LED (layers below the relay, on the emitter canvas when there is one)
+ * and publishes the resulting surfaces as the provider's relay mirror for receivers to read this frame.
+ * batch is scratch for one emitter controller at a time.
+ */
+void PublishEmitterRelayMirror(const EffectRenderSnapshot& snapshot,
+                               const EvaluationGrids& grids,
+                               float time,
+                               std::uint32_t dither_frame,
+                               ControllerSampleBatch& batch)
+{
+    SpatialLightingSceneProvider* provider = SpatialLightingSceneProvider::instance();
+    provider->ClearEmitterRelayFrame();
+
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    SpatialEffect3D* relay_layer_effect = snapshot.relay_layer_effect;
+    const size_t relay_idx = snapshot.relay_stack_index;
+    const std::vector<std::unique_ptr<ControllerTransform>>* transforms = snapshot.scene.get();
+    if(!relay_layer_effect || relay_idx >= active_effects.size() || !transforms)
+    {
+        return;
+    }
+
+    std::unordered_set<int> emitter_set;
+    for(int idx : relay_layer_effect->roomEmitterControllerIndices())
+    {
+        emitter_set.insert(idx);
+    }
+    if(emitter_set.empty())
+    {
+        return;
+    }
+
+    const GridContext3D& world_grid = grids.world_grid;
+    const GridContext3D& room_grid = grids.room_grid;
+    const GridContext3D* canvas_grid = grids.emitter_grid.get();
+    const RoomSpatialLightingUi::RoomSpatialLightParams& lp = relay_layer_effect->roomRelayParams();
+    const float bright = std::max(0.15f, relay_layer_effect->GetBrightness() / 100.0f);
+
+    /** One layer at one emitter LED: on the emitter canvas when there is one, else on the slot's grid. */
+    const auto sample_layer_at = [&](SpatialEffect3D* effect, size_t effect_idx, const LEDPosition3D& led_position) {
+        const float room_x = led_position.room_position.x;
+        const float room_y = led_position.room_position.y;
+        const float room_z = led_position.room_position.z;
+
+        RGBColor effect_color = 0x00000000;
+        if(canvas_grid)
+        {
+            effect_color = SamplePatternOnEmitterCanvas(effect, room_x, room_y, room_z, time, canvas_grid);
+            if(!effect->IsPointOnActiveSurface(room_x, room_y, room_z, *canvas_grid))
+            {
+                effect_color = 0x00000000;
+            }
+        }
+        else
+        {
+            const Vector3D& world_pos = led_position.world_position;
+            const bool requires_world = effect->RequiresWorldSpaceCoordinates();
+            const bool use_world_bounds = effect->UseWorldGridBounds();
+            const GridContext3D* local_grid = ResolveActiveSlotGrid(grids.slot_grids[effect_idx], use_world_bounds);
+            const GridContext3D& active_grid = local_grid ? *local_grid : (use_world_bounds ? world_grid : room_grid);
+
+            float sx = requires_world ? world_pos.x : room_x;
+            float sy = requires_world ? world_pos.y : room_y;
+            float sz = requires_world ? world_pos.z : room_z;
+            if(!effect->SkipsSpatialSampleWarp())
+            {
+                effect->ApplyAxisScale(sx, sy, sz, active_grid);
+                effect->ApplyEffectRotation(sx, sy, sz, active_grid);
+            }
+            effect_color = SampleStackLayerColor(effect, sx, sy, sz, time, active_grid);
+            if(!effect->IsPointOnActiveSurface(sx, sy, sz, active_grid))
+            {
+                effect_color = 0x00000000;
+            }
+        }
+        return effect->PostProcessColorGrid(effect_color);
+    };
+
+    EmitterRelayMirror::MirrorFrame mirror{};
+    mirror.room_center = {room_grid.center_x, room_grid.center_y, room_grid.center_z};
+    mirror.grid_scale_mm = room_grid.grid_scale_mm;
+    mirror.light_reach_mm = lp.light_reach_mm;
+    mirror.glow_feather_percent = std::clamp(lp.glow_radius_mm * 0.38f, 5.0f, 90.0f);
+    mirror.room_fill_strength = lp.room_fill / 100.0f;
+    mirror.brightness = bright;
+
+    std::vector<EmitterRelayMirror::LedColorSample> led_samples;
+    for(const int emitter_ctrl : emitter_set)
+    {
+        if(emitter_ctrl < 0 || emitter_ctrl >= (int)transforms->size())
+        {
+            continue;
+        }
+        // World positions were refreshed before the scene was copied alongside the layout.
+        const ControllerTransform* emitter_transform = (*transforms)[(size_t)emitter_ctrl].get();
+        if(!emitter_transform || emitter_transform->hidden_by_virtual)
+        {
+            continue;
+        }
+
+        Vector3D min_bounds{};
+        Vector3D max_bounds{};
+        ControllerLayout3D::CalculateControllerLocalBounds(emitter_transform, min_bounds, max_bounds);
+        const float span_x = std::max(max_bounds.x - min_bounds.x, 0.01f);
+        const float span_y = std::max(max_bounds.y - min_bounds.y, 0.01f);
+
+        // Layers blend into the float accumulator and quantize once, like the controller stack.
+        const std::vector<LEDPosition3D>& led_positions = emitter_transform->led_positions;
+        const size_t led_count = led_positions.size();
+        batch.stack.Reset(led_count);
+        batch.layer_colors.resize(led_count);
+        const int prev_shade_ctrl = provider->shadingControllerIndex();
+        provider->SetShadingControllerIndex(emitter_ctrl);
+        for(size_t effect_idx = 0; effect_idx < active_effects.size(); ++effect_idx)
+        {
+            const RenderEffectSlot& slot = active_effects[effect_idx];
+            SpatialEffect3D* effect = slot.effect;
+            if(!effect)
+            {
+                continue;
+            }
+            if(!EffectSlotAppliesToController(slot, emitter_ctrl))
+            {
+                continue;
+            }
+            if(!ShouldApplyStackLayerToController(effect, effect_idx, relay_idx, true, emitter_ctrl, &emitter_set))
+            {
+                continue;
+            }
+            if(!canvas_grid && effect->UseZoneGrid() && slot.zone_index != -1 &&
+               !grids.slot_grids[effect_idx].use_zone_grid)
+            {
+                continue;
+            }
+            for(size_t i = 0; i < led_count; i++)
+            {
+                batch.layer_colors[i] = sample_layer_at(effect, effect_idx, led_positions[i]);
+            }
+            batch.stack.Blend(batch.layer_colors.data(), led_count, slot.blend_mode);
+        }
+        provider->SetShadingControllerIndex(prev_shade_ctrl);
+        // Emitters have no layout range of their own; offset the dither hash per controller instead.
+        if(snapshot.temporal_dither)
+        {
+            batch.stack.QuantizeDithered(batch.layer_colors.data(), led_count,
+                                         static_cast<std::uint32_t>(emitter_ctrl) << 16, dither_frame);
+        }
+        else
+        {
+            batch.stack.Quantize(batch.layer_colors.data(), led_count);
+        }
+
+        led_samples.clear();
+        led_samples.reserve(led_count);
+        for(size_t i = 0; i < led_count; i++)
+        {
+            const LEDPosition3D& led_position = led_positions[i];
+            const RGBColor c = batch.layer_colors[i];
+            const uint8_t r = static_cast<uint8_t>(c & 0xFF);
+            const uint8_t g = static_cast<uint8_t>((c >> 8) & 0xFF);
+            const uint8_t b = static_cast<uint8_t>((c >> 16) & 0xFF);
+            if(static_cast<int>(r) + static_cast<int>(g) + static_cast<int>(b) < 6)
+            {
+                continue;
+            }
+            EmitterRelayMirror::LedColorSample sample{};
+            sample.u = (led_position.local_position.x - min_bounds.x) / span_x;
+            sample.v = (led_position.local_position.y - min_bounds.y) / span_y;
+            sample.r = r;
+            sample.g = g;
+            sample.b = b;
+            led_samples.push_back(sample);
+        }
+
+        if(led_samples.empty())
+        {
+            continue;
+        }
+
+        EmitterRelayMirror::EmitterSurface surface{};
+        EmitterRelayMirror::BuildSurfaceFromSamples(emitter_ctrl, emitter_transform, led_samples, surface);
+        if(!surface.tex_rgb.empty())
+        {
+            mirror.surfaces.push_back(std::move(surface));
+        }
+    }
+
+    provider->SetEmitterRelayMirrorFrame(std::move(mirror), std::move(emitter_set));
+}
+
+/**
+ * Per-frame scene work on the evaluating thread, so the GUI never waits on it: occluders against the
+ * snapshot's transform copy, GPU / CPU field atlases against each slot's active grid, then the relay
+ * mirror, which samples layers through those atlases.
+ */
+void PrepareFrameScene(const EffectRenderSnapshot& snapshot,
+                       const EvaluationGrids& grids,
+                       float time,
+                       std::uint64_t render_sequence,
+                       std::uint32_t dither_frame,
+                       ControllerSampleBatch& mirror_batch)
+{
+    SpatialLightingSceneProvider* provider = SpatialLightingSceneProvider::instance();
+    provider->SetFrameControllers(snapshot.scene);
+
+    const SpatialLighting::OccluderBuildOptions frame_occluder_options = MergeStackOccluderOptions(snapshot.slots);
+    if(frame_occluder_options.display_planes || frame_occluder_options.room_walls ||
+       frame_occluder_options.controllers || frame_occluder_options.light_blockers)
+    {
+        provider->EnsureFrameOccluders(grids.room_grid, frame_occluder_options);
+    }
+
+    for(size_t effect_idx = 0; effect_idx < snapshot.slots.size(); effect_idx++)
+    {
+        SpatialEffect3D* effect = snapshot.slots[effect_idx].effect;
+        if(!effect)
+        {
+            continue;
+        }
+        const bool use_world_bounds = effect->UseWorldGridBounds();
+        const GridContext3D* local_grid = ResolveActiveSlotGrid(grids.slot_grids[effect_idx], use_world_bounds);
+        const GridContext3D& active_grid = local_grid ? *local_grid
+                                                      : (use_world_bounds ? grids.world_grid : grids.room_grid);
+        effect->PrepareGpuFields(render_sequence, time, active_grid);
+    }
+
+    PublishEmitterRelayMirror(snapshot, grids, time, dither_frame, mirror_batch);
+}
+
+/**
+ * Ambient-shades the accumulated stack of layout LEDs [first, first + count) with the span's shade
+ * source and quantizes it once into colors[0, count) (dithered with snapshot.temporal_dither).
+ */
+void ResolveSpanStack(const EffectRenderSnapshot& snapshot,
+                      const EffectStackRenderPlan& plan,
+                      const GridContext3D& room_grid,
+                      size_t span_idx,
+                      size_t first,
+                      size_t count,
+                      std::uint32_t dither_frame,
+                      LayerAccumulator& stack,
+                      RGBColor* colors)
+{
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    const SpatialEffect3D* shade_source = plan.ShadeSource(snapshot, span_idx);
+    if(shade_source)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(stack.IsBlack(i))
+            {
+                continue;
+            }
+            const size_t layout_idx = first + i;
+            stack.Scale(i, shade_source->GetLayerRoomAmbientShadeFactor(layout.room_x[layout_idx],
+                                                                        layout.room_y[layout_idx],
+                                                                        layout.room_z[layout_idx],
+                                                                        room_grid,
+                                                                        static_cast<int>(layout_idx)));
+        }
+    }
+    if(snapshot.temporal_dither)
+    {
+        stack.QuantizeDithered(colors, count, static_cast<std::uint32_t>(first), dither_frame);
+    }
+    else
+    {
+        stack.Quantize(colors, count);
+    }
+}
+
+/**
+ * Relay receiver / emitter controllers: they branch on the relay layer rather than the stack. Emitter
+ * spans sample every layer on the emitter canvas and resolve through batch.stack like
+ * EvaluateControllerStack; receiver-only spans take the relay shade directly.
+ */
+void EvaluateRelayStack(const EffectRenderSnapshot& snapshot,
+                        const EffectStackRenderPlan& plan,
+                        const EvaluationGrids& grids,
+                        size_t span_idx,
+                        size_t first,
+                        size_t count,
+                        float time,
+                        std::uint32_t dither_frame,
+                        ControllerSampleBatch& batch,
+                        RGBColor* colors)
+{
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    SpatialEffect3D* relay_layer_effect = snapshot.relay_layer_effect;
+    const GridContext3D& world_grid = grids.world_grid;
+    const GridContext3D& room_grid = grids.room_grid;
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    if(count == 0)
+    {
+        return;
+    }
+
+    if(plan.span_relay_only_receiver[span_idx])
+    {
+        const bool relay_use_world = relay_layer_effect->RequiresWorldSpaceCoordinates();
+        const bool relay_world_bounds = relay_layer_effect->UseWorldGridBounds();
+        const GridContext3D& relay_grid = relay_world_bounds ? world_grid : room_grid;
+        const float* xs = (relay_use_world ? layout.world_x.data() : layout.room_x.data()) + first;
+        const float* ys = (relay_use_world ? layout.world_y.data() : layout.room_y.data()) + first;
+        const float* zs = (relay_use_world ? layout.world_z.data() : layout.room_z.data()) + first;
+        for(size_t i = 0; i < count; i++)
+        {
+            const RGBColor relay_color = relay_layer_effect->SampleRelayShadeAt(xs[i], ys[i], zs[i], relay_grid);
+            colors[i] = relay_layer_effect->PostProcessColorGrid(relay_color);
+        }
+        return;
+    }
+
+    const GridContext3D& canvas_grid = *grids.emitter_grid;
+    const float* room_x = layout.room_x.data() + first;
+    const float* room_y = layout.room_y.data() + first;
+    const float* room_z = layout.room_z.data() + first;
+    batch.stack.Reset(count);
+    batch.layer_colors.resize(count);
+
+    ForEachPlannedLayer(plan.SpanMask(span_idx), plan.mask_words, [&](size_t effect_idx) {
+        const RenderEffectSlot& slot = active_effects[effect_idx];
+        SpatialEffect3D* effect = slot.effect;
+        RGBColor* layer = batch.layer_colors.data();
+        for(size_t i = 0; i < count; i++)
+        {
+            RGBColor effect_color =
+                SamplePatternOnEmitterCanvas(effect, room_x[i], room_y[i], room_z[i], time, &canvas_grid);
+            if(!effect->IsPointOnActiveSurface(room_x[i], room_y[i], room_z[i], canvas_grid))
+            {
+                effect_color = 0x00000000;
+            }
+            layer[i] = effect->PostProcessColorGrid(effect_color);
+        }
+        batch.stack.Blend(layer, count, slot.blend_mode);
+    });
+
+    ResolveSpanStack(snapshot, plan, room_grid, span_idx, first, count, dither_frame, batch.stack, colors);
+}
+
+/**
+ * Standard stack for layout LEDs [first, first + count) of one controller span: each
+ * applicable layer is evaluated once over that slice of the layout streams
+ * (EvaluateColorGridBatch) and blended into a float accumulator, which ResolveSpanStack
+ * ambient-shades and quantizes into colors[0, count).
+ */
+void EvaluateControllerStack(const EffectRenderSnapshot& snapshot,
+                             const EffectStackRenderPlan& plan,
+                             const EvaluationGrids& grids,
+                             size_t span_idx,
+                             size_t first,
+                             size_t count,
+                             float time,
+                             std::uint32_t dither_frame,
+                             ControllerSampleBatch& batch,
+                             RGBColor* colors)
+{
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    const GridContext3D& room_grid = grids.room_grid;
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    const LedFrameLayout3D::ControllerSpan& span = layout.controllers[span_idx];
+    if(count == 0)
+    {
+        return;
+    }
+    batch.stack.Reset(count);
+    batch.layer_colors.resize(count);
+
+    ForEachPlannedLayer(plan.SpanMask(span_idx), plan.mask_words, [&](size_t effect_idx) {
+        const GridContext3D* stack_grid = grids.slot_stack_grids[effect_idx];
+        if(!stack_grid)
+        {
+            return;
+        }
+        const RenderEffectSlot& slot = active_effects[effect_idx];
+        SpatialEffect3D* effect = slot.effect;
+
+        const bool requires_world = effect->RequiresWorldSpaceCoordinates();
+        const float* xs = (requires_world ? layout.world_x.data() : layout.room_x.data()) + first;
+        const float* ys = (requires_world ? layout.world_y.data() : layout.room_y.data()) + first;
+        const float* zs = (requires_world ? layout.world_z.data() : layout.room_z.data()) + first;
+        RGBColor* layer = batch.layer_colors.data();
+
+        if(effect->RequiresPerLedSampleContext())
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                MinecraftGame::SetRenderSampleIndexContext((int)layout.led_position_index[first + i],
+                                                           (int)span.led_position_count);
+                effect->EvaluateColorGridBatch(xs + i, ys + i, zs + i, 1, time, *stack_grid, layer + i);
+            }
+            MinecraftGame::ClearRenderSampleIndexContext();
+        }
+        else
+        {
+            effect->EvaluateColorGridBatch(xs, ys, zs, count, time, *stack_grid, layer);
+        }
+
+        batch.stack.Blend(layer, count, slot.blend_mode);
+    });
+
+    ResolveSpanStack(snapshot, plan, room_grid, span_idx, first, count, dither_frame, batch.stack, colors);
+}
+
+/** LEDs per pool range: small enough to balance uneven controllers, large enough to amortize a batch call. */
+constexpr size_t kLedsPerRenderRange = 128;
+
+/** Every layer opts into concurrent batches; otherwise the stack stays on the calling thread. */
+bool CanEvaluateStackConcurrently(const EffectRenderSnapshot& snapshot)
+{
+    for(const RenderEffectSlot& slot : snapshot.slots)
+    {
+        if(slot.effect && (!slot.effect->SupportsConcurrentEvaluation() || slot.effect->RequiresPerLedSampleContext()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Z layers per overlay task: the unit of pool scheduling, boundary culling and progressive refresh. */
+constexpr size_t kOverlaySlabDepth = 2;
+
+/** Voxels one progressive overlay frame refreshes; the other slabs keep their previous colors. */
+constexpr size_t kOverlayProgressiveVoxelsPerFrame = 131072;
+
+/**
+ * Overlay voxels with iz in [iz_begin, iz_end) for every (ix, iy), written into colors
+ * (ix * ny * nz + iy * nz + iz). Each plane is one batch per layer; layers whose boundary
+ * cannot reach the slab (or the plane) blend as black without being evaluated.
+ */
+void EvaluateRoomGridOverlaySlab(const EffectRenderSnapshot& snapshot,
+                                 const std::vector<const GridContext3D*>& layer_grids,
+                                 const SpatialEffect3D* shade_source,
+                                 const GridContext3D& room_grid,
+                                 float time,
+                                 size_t iz_begin,
+                                 size_t iz_end,
+                                 OverlaySlabBatch& batch,
+                                 RGBColor* colors)
+{
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    const std::vector<float>& axis_x = snapshot.overlay_axis_x;
+    const std::vector<float>& axis_y = snapshot.overlay_axis_y;
+    const std::vector<float>& axis_z = snapshot.overlay_axis_z;
+    const size_t nx = axis_x.size();
+    const size_t ny = axis_y.size();
+    const size_t nz = axis_z.size();
+    const size_t depth = iz_end - iz_begin;
+    const size_t plane = ny * depth;
+
+    const auto y_range = std::minmax_element(axis_y.begin(), axis_y.end());
+    const auto x_range = std::minmax_element(axis_x.begin(), axis_x.end());
+    const auto z_range = std::minmax_element(axis_z.begin() + iz_begin, axis_z.begin() + iz_end);
+    Vector3D box_min{*x_range.first, *y_range.first, *z_range.first};
+    Vector3D box_max{*x_range.second, *y_range.second, *z_range.second};
+
+    bool any_layer = false;
+    batch.slab_layers.assign(active_effects.size(), 0);
+    for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
+    {
+        const GridContext3D* grid = layer_grids[effect_idx];
+        if(grid && active_effects[effect_idx].effect->EffectBoundaryTouchesBox(box_min, box_max, *grid))
+        {
+            batch.slab_layers[effect_idx] = 1;
+            any_layer = true;
+        }
+    }
+    if(!any_layer)
+    {
+        // Black blends and shades to black under every mode.
+        for(size_t ix = 0; ix < nx; ix++)
+        {
+            for(size_t iy = 0; iy < ny; iy++)
+            {
+                RGBColor* column_out = colors + ix * ny * nz + iy * nz;
+                std::fill(column_out + iz_begin, column_out + iz_end, ToRGBColor(0, 0, 0));
+            }
+        }
+        return;
+    }
+
+    batch.xs.resize(plane);
+    batch.ys.resize(plane);
+    batch.zs.resize(plane);
+    batch.layer_colors.resize(plane);
+    for(size_t iy = 0; iy < ny; iy++)
+    {
+        for(size_t dz = 0; dz < depth; dz++)
+        {
+            batch.ys[iy * depth + dz] = axis_y[iy];
+            batch.zs[iy * depth + dz] = axis_z[iz_begin + dz];
+        }
+    }
+
+    for(size_t ix = 0; ix < nx; ix++)
+    {
+        const float sample_x = axis_x[ix];
+        std::fill(batch.xs.begin(), batch.xs.end(), sample_x);
+        batch.stack.Reset(plane);
+        box_min.x = sample_x;
+        box_max.x = sample_x;
+
+        for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
+        {
+            const GridContext3D* grid = layer_grids[effect_idx];
+            if(!grid)
+            {
+                continue;
+            }
+            const RenderEffectSlot& slot = active_effects[effect_idx];
+            if(batch.slab_layers[effect_idx] && slot.effect->EffectBoundaryTouchesBox(box_min, box_max, *grid))
+            {
+                slot.effect->EvaluateColorGridBatch(batch.xs.data(),
+                                                    batch.ys.data(),
+                                                    batch.zs.data(),
+                                                    plane,
+                                                    time,
+                                                    *grid,
+                                                    batch.layer_colors.data());
+            }
+            else
+            {
+                std::fill(batch.layer_colors.begin(), batch.layer_colors.end(), ToRGBColor(0, 0, 0));
+            }
+            batch.stack.Blend(batch.layer_colors.data(), plane, slot.blend_mode);
+        }
+
+        if(shade_source)
+        {
+            for(size_t iy = 0; iy < ny; iy++)
+            {
+                for(size_t dz = 0; dz < depth; dz++)
+                {
+                    const size_t i = iy * depth + dz;
+                    if(batch.stack.IsBlack(i))
+                    {
+                        continue;
+                    }
+                    batch.stack.Scale(i, shade_source->GetLayerRoomAmbientShadeFactor(
+                                             sample_x, axis_y[iy], axis_z[iz_begin + dz], room_grid,
+                                             static_cast<int>(ix * ny * nz + iy * nz + iz_begin + dz)));
+                }
+            }
+        }
+        // The overlay is a preview: plain rounding, no temporal dither.
+        batch.stack_colors.resize(plane);
+        batch.stack.Quantize(batch.stack_colors.data(), plane);
+        for(size_t iy = 0; iy < ny; iy++)
+        {
+            RGBColor* column_out = colors + ix * ny * nz + iy * nz;
+            std::copy(batch.stack_colors.begin() + iy * depth,
+                      batch.stack_colors.begin() + (iy + 1) * depth,
+                      column_out + iz_begin);
+        }
+    }
+}
+
+/**
+ * Room-grid overlay fill, split into Z slabs that fan out over the pool when every layer
+ * allows concurrent batches. With snapshot.overlay_progressive only a rotating window of
+ * slabs (kOverlayProgressiveVoxelsPerFrame) is refreshed per frame, and out_colors stays
+ * the last completed sweep (the same buffer, so the viewport keeps it) until the window
+ * has covered every slab again. A new stack generation or different sample axes refresh
+ * every slab at once.
+ */
+void EvaluateRoomGridOverlay(const EffectRenderSnapshot& snapshot,
+                             const EvaluationGrids& grids,
+                             float time,
+                             EffectRenderTaskPool* pool,
+                             EffectStackEvaluatorState& evaluator_state,
+                             std::shared_ptr<const std::vector<RGBColor>>& out_colors)
+{
+    RoomGridOverlayState& state = evaluator_state.overlay;
+    std::vector<OverlaySlabBatch>& slot_batches = evaluator_state.overlay_batches;
+
+    const std::vector<RenderEffectSlot>& active_effects = snapshot.slots;
+    const size_t nx = snapshot.overlay_axis_x.size();
+    const size_t ny = snapshot.overlay_axis_y.size();
+    const size_t nz = snapshot.overlay_axis_z.size();
+    const size_t count = nx * ny * nz;
+    if(count == 0)
+    {
+        out_colors.reset();
+        return;
+    }
+
+    const bool axes_changed = state.axis_x != snapshot.overlay_axis_x ||
+                              state.axis_y != snapshot.overlay_axis_y ||
+                              state.axis_z != snapshot.overlay_axis_z;
+    const bool refresh_all = state.generation != snapshot.generation || axes_changed;
+    if(axes_changed)
+    {
+        state.axes_serial = ++g_overlay_axes_serial;
+    }
+    if(refresh_all)
+    {
+        state.generation = snapshot.generation;
+        state.axis_x = snapshot.overlay_axis_x;
+        state.axis_y = snapshot.overlay_axis_y;
+        state.axis_z = snapshot.overlay_axis_z;
+        // Every slab is refreshed this frame, so the buffer needs no clearing.
+        state.colors.resize(count);
+        state.swept_slabs = 0;
+        state.next_slab = 0;
+    }
+
+    const size_t slab_count = (nz + kOverlaySlabDepth - 1) / kOverlaySlabDepth;
+    size_t slab_budget = slab_count;
+    if(snapshot.overlay_progressive && !refresh_all)
+    {
+        const size_t slab_voxels = nx * ny * kOverlaySlabDepth;
+        slab_budget = std::clamp((kOverlayProgressiveVoxelsPerFrame + slab_voxels - 1) / slab_voxels,
+                                 (size_t)1,
+                                 slab_count);
+    }
+    const size_t first_slab = state.next_slab;
+    state.next_slab = (first_slab + slab_budget) % slab_count;
+
+    // Bound once per evaluation; nullptr = layer not drawn in the overlay.
+    const std::vector<const GridContext3D*>& layer_grids = grids.slot_stack_grids;
+    const SpatialEffect3D* overlay_shade_source = ResolveOverlayAmbientShadeSource(active_effects);
+    // Voxel shade terms persist across stack edits; slabs fill the ones a geometry change dropped.
+    SpatialLightingSceneProvider::instance()->BeginAmbientShadeOverlayFrame(state.axes_serial, count);
+
+    const bool concurrent = pool && pool->GetWorkerCount() > 0 && CanEvaluateStackConcurrently(snapshot);
+    slot_batches.resize(concurrent ? pool->GetSlotCount() : 1u);
+
+    // Overlay pass and shading index are per thread, so every slot sets its own.
+    const EffectRenderTaskPool::RangeTask evaluate_slabs = [&](size_t begin, size_t end, unsigned int slot) {
+        SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
+        SpatialRoom::BeginRoomGridOverlayPass();
+        for(size_t k = begin; k < end; k++)
+        {
+            const size_t iz_begin = ((first_slab + k) % slab_count) * kOverlaySlabDepth;
+            EvaluateRoomGridOverlaySlab(snapshot,
+                                        layer_grids,
+                                        overlay_shade_source,
+                                        grids.room_grid,
+                                        time,
+                                        iz_begin,
+                                        std::min(iz_begin + kOverlaySlabDepth, nz),
+                                        slot_batches[slot],
+                                        state.colors.data());
+        }
+        SpatialRoom::EndRoomGridOverlayPass();
+    };
+
+    if(concurrent)
+    {
+        // Slabs write disjoint voxels, so the result does not depend on scheduling.
+        std::vector<EffectRenderTaskPool::TaskRange> ranges(slab_budget);
+        for(size_t k = 0; k < slab_budget; k++)
+        {
+            ranges[k].begin = k;
+            ranges[k].end = k + 1;
+        }
+        pool->Run(ranges, evaluate_slabs);
+    }
+    else
+    {
+        evaluate_slabs(0, slab_budget, 0u);
+    }
+
+    // Windows are consecutive, so slab_count refreshed slabs cover every slab of the buffer.
+    state.swept_slabs += slab_budget;
+    if(state.swept_slabs >= slab_count)
+    {
+        std::shared_ptr<std::vector<RGBColor>> previous = std::move(state.published);
+        state.published = std::make_shared<std::vector<RGBColor>>(std::move(state.colors));
+        state.colors.clear();
+        // Only this state can hand out a new reference, so a sole owner means no reader is left.
+        if(previous && previous.use_count() == 1)
+        {
+            state.colors.swap(*previous);
+        }
+        state.colors.resize(count);
+        state.swept_slabs = 0;
+    }
+    out_colors = state.published;
+}
+
+bool IsRelayRoutedController(const EffectStackRenderPlan& plan, const EvaluationGrids& grids, size_t span_idx)
+{
+    return plan.span_relay_only_receiver[span_idx] || (plan.span_relay_emitter[span_idx] && grids.emitter_grid);
+}
+
+/** Index of the span containing layout index (ranges never straddle spans). */
+size_t FindLayoutSpanIndex(const LedFrameLayout3D& layout, size_t layout_idx)
+{
+    const auto it = std::upper_bound(layout.controllers.begin(),
+                                     layout.controllers.end(),
+                                     layout_idx,
+                                     [](size_t idx, const LedFrameLayout3D::ControllerSpan& span) { return idx < span.first; });
+    return static_cast<size_t>(it - layout.controllers.begin()) - 1u;
+}
+
+/** LEDs per shade bake range; tracing costs more per LED than a layer batch, so ranges stay smaller. */
+constexpr size_t kLedsPerShadeBakeRange = 32;
+
+/**
+ * Re-traces the LED shade slots that are missing or were dropped by a dirty region, before any layer runs,
+ * so the shading in EvaluateControllerStack is one buffer read per LED. Tracing only reads the frame
+ * occluders, so it uses the pool whether or not the layers allow concurrent batches.
+ */
+void BakeStackAmbientShade(const EffectRenderSnapshot& snapshot,
+                           const EffectStackRenderPlan& plan,
+                           const EvaluationGrids& grids,
+                           EffectRenderTaskPool* pool,
+                           EffectStackEvaluatorState& state)
+{
+    SpatialLightingSceneProvider* provider = SpatialLightingSceneProvider::instance();
+    if(provider->frameOccluderAabbs().empty() && provider->frameOccluderQuads().empty() &&
+       !provider->frameRoomBlockerField().IsValid())
+    {
+        // ApplyLayerRoomAmbientShading never reads the slots then.
+        return;
+    }
+
+    std::vector<SpanShadeParams>& span_params = state.span_shade_params;
+    std::vector<size_t>& stale = state.stale_shade_slots;
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    const GridContext3D& room_grid = grids.room_grid;
+    span_params.assign(layout.controllers.size(), SpanShadeParams());
+    stale.clear();
+
+    std::vector<EffectRenderTaskPool::TaskRange> ranges;
+    for(size_t span_idx = 0; span_idx < layout.controllers.size(); span_idx++)
+    {
+        const LedFrameLayout3D::ControllerSpan& span = layout.controllers[span_idx];
+        if(plan.span_relay_only_receiver[span_idx])
+        {
+            continue;
+        }
+        const SpatialEffect3D* shade_source = plan.ShadeSource(snapshot, span_idx);
+        float ao_strength = 0.0f;
+        SpanShadeParams& params = span_params[span_idx];
+        if(!shade_source || !shade_source->GetRoomAmbientShadeParams(room_grid, ao_strength, params.probe_span))
+        {
+            continue;
+        }
+        params.shaded = true;
+        params.need_openness = ao_strength > 0.01f;
+
+        const size_t span_begin = stale.size();
+        for(size_t layout_idx = span.first; layout_idx < span.first + span.count; layout_idx++)
+        {
+            if(!provider->AmbientShadeSlotBaked(layout_idx,
+                                                room_grid.center_x,
+                                                room_grid.center_y,
+                                                room_grid.center_z,
+                                                params.probe_span,
+                                                params.need_openness))
+            {
+                stale.push_back(layout_idx);
+            }
+        }
+        for(size_t begin = span_begin; begin < stale.size(); begin += kLedsPerShadeBakeRange)
+        {
+            EffectRenderTaskPool::TaskRange range;
+            range.begin = begin;
+            range.end = std::min(begin + kLedsPerShadeBakeRange, stale.size());
+            ranges.push_back(range);
+        }
+    }
+    if(ranges.empty())
+    {
+        return;
+    }
+
+    // Each task bakes only its own slots; the segment tests skip the range's own controller.
+    const EffectRenderTaskPool::RangeTask bake = [&](size_t begin, size_t end, unsigned int /*slot*/) {
+        const size_t span_idx = FindLayoutSpanIndex(layout, stale[begin]);
+        const LedFrameLayout3D::ControllerSpan& span = layout.controllers[span_idx];
+        const SpanShadeParams& params = span_params[span_idx];
+        provider->SetShadingControllerIndex(static_cast<int>(span.ctrl_idx));
+        for(size_t k = begin; k < end; k++)
+        {
+            const size_t layout_idx = stale[k];
+            provider->BakeAmbientShadeSlot(layout_idx,
+                                           layout.room_x[layout_idx],
+                                           layout.room_y[layout_idx],
+                                           layout.room_z[layout_idx],
+                                           room_grid.center_x,
+                                           room_grid.center_y,
+                                           room_grid.center_z,
+                                           params.probe_span,
+                                           params.need_openness);
+        }
+        provider->SetShadingControllerIndex(-1);
+    };
+
+    if(pool && pool->GetWorkerCount() > 0)
+    {
+        pool->Run(ranges, bake);
+    }
+    else
+    {
+        for(const EffectRenderTaskPool::TaskRange& range : ranges)
+        {
+            bake(range.begin, range.end, 0u);
+        }
+    }
+}
+
+} // namespace
+
+void SyncRenderSnapshotEffects(const EffectRenderSnapshot& snapshot, EffectStackEvaluatorState& state)
+{
+    std::unordered_map<const SpatialEffect3D*, std::shared_ptr<const nlohmann::json>> applied;
+    applied.reserve(snapshot.slots.size());
+    for(const RenderEffectSlot& slot : snapshot.slots)
+    {
+        SpatialEffect3D* effect = slot.effect;
+        if(!effect)
+        {
+            continue;
+        }
+        std::shared_ptr<const nlohmann::json>& loaded = applied[effect];
+        loaded = state.applied_settings[effect];
+        if(slot.settings && slot.settings != loaded)
+        {
+            effect->LoadSettings(*slot.settings);
+            loaded = slot.settings;
+        }
+        effect->SetGlobalReferencePoint(snapshot.stack_ref_origin);
+        effect->SetReferenceMode(snapshot.stack_origin_mode);
+        effect->PrepareRenderSnapshot();
+        // Before any fan-out: pool tasks only read the post-process and palette tables.
+        effect->PreparePostProcessStage();
+        effect->PreparePaletteLut();
+    }
+    // Only effects still in the stack; a freed effect's address may come back as a new layer.
+    state.applied_settings.swap(applied);
+}
+
+void EvaluateRenderSnapshot(const EffectRenderSnapshot& snapshot,
+                            float time,
+                            std::uint64_t render_sequence,
+                            EffectRenderTaskPool* pool,
+                            EffectStackEvaluatorState& state,
+                            EffectRenderOutput& output)
+{
+    MinecraftGame::ClearRenderSampleIndexContext();
+    SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
+    EffectRenderFrameGuard effect_render_frame_guard;
+    RenderTickSnapshotGuard render_tick_snapshot_guard(ScreenCaptureManager::Instance());
+
+    const EvaluationGrids grids(snapshot, render_sequence);
+    const std::uint32_t dither_frame = ++state.dither_frame;
+    PrepareFrameScene(snapshot, grids, time, render_sequence, dither_frame, state.relay_mirror_batch);
+    const EffectStackRenderPlan& plan = AcquireRenderPlan(snapshot, state);
+
+    const float shade_cache_quant = MMToGridUnits(24.0f, grids.room_grid.grid_scale_mm);
+    SpatialLightingSceneProvider::instance()->BeginAmbientShadeCacheFrame(shade_cache_quant, snapshot.layout.get());
+    BakeStackAmbientShade(snapshot, plan, grids, pool, state);
+
+    output.time = time;
+    output.overlay_valid = false;
+    if(snapshot.overlay_enabled)
+    {
+        EvaluateRoomGridOverlay(snapshot, grids, time, pool, state, output.overlay_colors);
+        output.overlay_valid = output.overlay_colors != nullptr;
+    }
+
+    const LedFrameLayout3D& layout = *snapshot.layout;
+    output.led_colors.assign(layout.size(), ToRGBColor(0, 0, 0));
+
+    std::vector<ControllerSampleBatch>& slot_batches = state.led_batches;
+    const bool concurrent = pool && pool->GetWorkerCount() > 0 && CanEvaluateStackConcurrently(snapshot);
+    slot_batches.resize(concurrent ? pool->GetSlotCount() : 1u);
+
+    std::vector<EffectRenderTaskPool::TaskRange> ranges;
+    for(size_t span_idx = 0; span_idx < layout.controllers.size(); span_idx++)
+    {
+        const LedFrameLayout3D::ControllerSpan& span = layout.controllers[span_idx];
+        SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(static_cast<int>(span.ctrl_idx));
+        if(IsRelayRoutedController(plan, grids, span_idx))
+        {
+            EvaluateRelayStack(snapshot, plan, grids, span_idx, span.first, span.count, time, dither_frame,
+                               slot_batches[0], output.led_colors.data() + span.first);
+            continue;
+        }
+        if(!concurrent)
+        {
+            EvaluateControllerStack(snapshot, plan, grids, span_idx, span.first, span.count, time, dither_frame,
+                                    slot_batches[0], output.led_colors.data() + span.first);
+            continue;
+        }
+        for(size_t begin = span.first; begin < span.first + span.count; begin += kLedsPerRenderRange)
+        {
+            EffectRenderTaskPool::TaskRange range;
+            range.begin = begin;
+            range.end = std::min(begin + kLedsPerRenderRange, span.first + span.count);
+            ranges.push_back(range);
+        }
+    }
+
+    if(concurrent)
+    {
+        // Each LED writes only its own color and shade slot, so the result does not depend on scheduling.
+        pool->Run(ranges, [&](size_t begin, size_t end, unsigned int slot) {
+            const size_t span_idx = FindLayoutSpanIndex(layout, begin);
+            SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(
+                static_cast<int>(layout.controllers[span_idx].ctrl_idx));
+            EvaluateControllerStack(snapshot, plan, grids, span_idx, begin, end - begin, time, dither_frame,
+                                    slot_batches[slot], output.led_colors.data() + begin);
+            SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
+        });
+    }
+
+    MinecraftGame::ClearRenderSampleIndexContext();
+}
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef EFFECTSTACKEVALUATOR_H
+#define EFFECTSTACKEVALUATOR_H
+
+#include "EffectLayerCompositor.h"
+#include "EffectRenderFrame.h"
+#include "SpatialLighting/SpatialLightingEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class EffectRenderTaskPool;
+class ScreenCaptureManager;
+
+/**
+ * Stack compositor shared by the tab and the headless engine build: everything
+ * from an EffectRenderSnapshot to per-LED / overlay colours, with no widget or
+ * controller access. Snapshot building (zones, UI state) stays in OpenRGB3DSpatialTab;
+ * the per-frame scene work (occluders, emitter relay mirror, GPU fields) happens here.
+ */
+
+/** Monotonic render_sequence for grids stamped by one evaluation. */
+std::uint64_t NextEffectRenderSequence();
+
+const GridContext3D* ResolveActiveSlotGrid(const EffectSlotGridOverride& slot_override,
+                                           bool use_world_bounds);
+
+bool EffectSlotAppliesToController(const RenderEffectSlot& slot, int ctrl_idx);
+
+/** relay_emitter_indices null = ask SpatialLightingSceneProvider. */
+bool ShouldApplyStackLayerToController(const SpatialEffect3D* effect,
+                                       size_t effect_index,
+                                       size_t relay_stack_index,
+                                       bool has_relay_stack,
+                                       int ctrl_idx,
+                                       const std::unordered_set<int>* relay_emitter_indices = nullptr);
+
+SpatialLighting::OccluderBuildOptions MergeStackOccluderOptions(const std::vector<RenderEffectSlot>& effect_slots);
+
+RGBColor SamplePatternOnEmitterCanvas(SpatialEffect3D* effect,
+                                      float room_x,
+                                      float room_y,
+                                      float room_z,
+                                      float time,
+                                      const GridContext3D* canvas_grid);
+
+RGBColor SampleStackLayerColor(SpatialEffect3D* effect,
+                               float x,
+                               float y,
+                               float z,
+                               float time,
+                               const GridContext3D& grid);
+
+struct EffectRenderFrameGuard
+{
+    EffectRenderFrameGuard();
+    ~EffectRenderFrameGuard();
+    EffectRenderFrameGuard(const EffectRenderFrameGuard&) = delete;
+    EffectRenderFrameGuard& operator=(const EffectRenderFrameGuard&) = delete;
+};
+
+struct RenderTickSnapshotGuard
+{
+    ScreenCaptureManager& mgr;
+    explicit RenderTickSnapshotGuard(ScreenCaptureManager& m);
+    ~RenderTickSnapshotGuard();
+    RenderTickSnapshotGuard(const RenderTickSnapshotGuard&) = delete;
+    RenderTickSnapshotGuard& operator=(const RenderTickSnapshotGuard&) = delete;
+};
+
+/**
+ * Which stack layers draw on each layout span, compiled from the snapshot and kept across frames while
+ * RenderPlanKey holds (stack generation, LED layout, zone membership, relay routing). The LED loops walk
+ * the set bits instead of re-running EffectSlotAppliesToController / ShouldApplyStackLayerToController.
+ */
+struct EffectStackRenderPlan
+{
+    std::uint64_t key = 0;
+    bool compiled = false;
+    /** 64-bit words per span in span_layer_masks; bit i set = slot i applies to the span's controller. */
+    size_t mask_words = 0;
+    std::vector<std::uint64_t> span_layer_masks;
+    /** Per span: topmost applying slot with room occlusion, whose settings shade the span's LEDs; -1 = none. */
+    std::vector<int> span_shade_slots;
+    std::vector<unsigned char> span_relay_only_receiver;
+    std::vector<unsigned char> span_relay_emitter;
+
+    const std::uint64_t* SpanMask(size_t span_idx) const { return span_layer_masks.data() + span_idx * mask_words; }
+
+    const SpatialEffect3D* ShadeSource(const EffectRenderSnapshot& snapshot, size_t span_idx) const
+    {
+        const int slot_idx = span_shade_slots[span_idx];
+        return slot_idx >= 0 ? snapshot.slots[(size_t)slot_idx].effect : nullptr;
+    }
+};
+
+/** Per-layer / blended scratch for one controller span slice; reused across controllers within a frame. */
+struct ControllerSampleBatch
+{
+    std::vector<RGBColor> layer_colors;
+    LayerAccumulator stack;
+};
+
+/** Per pool slot scratch for one overlay slab plane (fixed ix, every iy, the slab's iz). */
+struct OverlaySlabBatch
+{
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<RGBColor> layer_colors;
+    LayerAccumulator stack;
+    std::vector<RGBColor> stack_colors;
+    std::vector<unsigned char> slab_layers;
+};
+
+/**
+ * Overlay colors kept on the evaluation side so progressive frames only refresh some slabs.
+ * Slabs are written into colors; once every slab has been refreshed since the last publish,
+ * colors moves into published and filling continues in a recycled buffer, so a sweep is
+ * handed out without a copy and a published buffer is never written again.
+ */
+struct RoomGridOverlayState
+{
+    std::uint64_t generation = 0;
+    /** Renewed when the sample axes change; keys the overlay's ambient shade slots. */
+    std::uint64_t axes_serial = 0;
+    std::vector<float> axis_x;
+    std::vector<float> axis_y;
+    std::vector<float> axis_z;
+    std::vector<RGBColor> colors;
+    /** Slabs refreshed into colors since the last publish. */
+    size_t swept_slabs = 0;
+    std::shared_ptr<std::vector<RGBColor>> published;
+    size_t next_slab = 0;
+};
+
+/** Ambient shade probe one controller span's LEDs are baked with. */
+struct SpanShadeParams
+{
+    bool shaded = false;
+    bool need_openness = false;
+    float probe_span = 0.0f;
+};
+
+/**
+ * What EvaluateRenderSnapshot keeps between frames of one stack. Each host (the tab, each
+ * SpatialBench pass) owns its own and passes it to every evaluation; it is touched only
+ * under the same lock as the evaluation itself.
+ */
+struct EffectStackEvaluatorState
+{
+    EffectStackRenderPlan plan;
+    RoomGridOverlayState overlay;
+    /** Per pool slot. */
+    std::vector<OverlaySlabBatch> overlay_batches;
+    /** Per pool slot. */
+    std::vector<ControllerSampleBatch> led_batches;
+    /** Emitter relay mirror scratch; the mirror is sampled on the evaluating thread only. */
+    ControllerSampleBatch relay_mirror_batch;
+    std::vector<SpanShadeParams> span_shade_params;
+    /** Layout indices whose ambient shade slot this frame re-traces. */
+    std::vector<size_t> stale_shade_slots;
+    /** Advances every evaluation so temporally dithered LEDs cycle through their thresholds. */
+    std::uint32_t dither_frame = 0;
+    /** RenderEffectSlot::settings each slot effect last loaded; held so a freed document is never mistaken for it. */
+    std::unordered_map<const SpatialEffect3D*, std::shared_ptr<const nlohmann::json>> applied_settings;
+};
+
+/**
+ * Hands the snapshot's effects their frame state: loads slot settings published since the last call,
+ * then the stack origin and PrepareRenderSnapshot. Caller holds SpatialEffect3D::RenderStateMutex();
+ * this is the only part of a frame that does, so GUI edits wait at most for this, never for evaluation.
+ */
+void SyncRenderSnapshotEffects(const EffectRenderSnapshot& snapshot, EffectStackEvaluatorState& state);
+
+/**
+ * LED + overlay evaluation for one frame, after SyncRenderSnapshotEffects. Touches only the
+ * snapshot, the effects and the lighting provider: it first brings the provider's occluders
+ * and emitter relay mirror up to date with snapshot.scene and prepares GPU / CPU fields, then
+ * evaluates. Runs on the render worker without the render lock, or inline on the GUI thread
+ * when stopped. With a pool, overlay slabs and standard-stack LED ranges fan out across its
+ * slots; relay-routed controllers and stacks with non-concurrent layers stay on the calling thread.
+ */
+void EvaluateRenderSnapshot(const EffectRenderSnapshot& snapshot,
+                            float time,
+                            std::uint64_t render_sequence,
+                            EffectRenderTaskPool* pool,
+                            EffectStackEvaluatorState& state,
+                            EffectRenderOutput& output);
+
+#endif
@@ -187,6 +187,8 @@ void GridSettingsPanel::onGridScaleChanged(double value)
             sm->SetGridScaleMM(host_tab_->grid_scale_mm);
         }
     }
+    // Every LED moves with the scale; recompile the layout and rebuild the snapshot.
+    host_tab_->InvalidateRenderSnapshot();
     for(unsigned int i = 0; i < host_tab_->controller_transforms.size(); i++)
     {
         host_tab_->RegenerateLEDPositions(host_tab_->controller_transforms[i].get());
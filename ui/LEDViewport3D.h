@@ -91,8 +91,8 @@ public:
     void SetRoomGridOverlayBounds(float min_x, float max_x, float min_y, float max_y, float min_z, float max_z);
     void ClearRoomGridOverlayBounds();
     void SetRoomGridColorBuffer(std::vector<RGBColor> buf);
-    /** Swap-adopt overlay colors (avoids a full copy; leaves `buf` with the previous buffer). */
-    void SwapRoomGridColorBuffer(std::vector<RGBColor>& buf);
+    /** Adopt a published overlay buffer without copying; the same buffer again is a no-op. */
+    void ShareRoomGridColorBuffer(std::shared_ptr<const std::vector<RGBColor>> buf);
     void SetRoomGridColorCallback(std::function<RGBColor(float x, float y, float z)> cb)
     {
         if(!room_grid_color_callback && !cb)
@@ -305,7 +305,7 @@ private:
     float                                   room_grid_brightness;
     float                                   room_grid_point_size;
     int                                     room_grid_step;
-    std::vector<RGBColor>                   room_grid_color_buffer;
+    std::shared_ptr<const std::vector<RGBColor>> room_grid_color_buffer;
     std::function<RGBColor(float, float, float)> room_grid_color_callback;
     std::vector<float>                      room_grid_overlay_positions;
     std::vector<float>                      room_grid_overlay_interleaved_;
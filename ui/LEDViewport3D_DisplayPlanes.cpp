@@ -178,7 +178,7 @@ void LEDViewport3D::SetRoomGridStep(int step)
     room_grid_overlay_last_ny = -1;
     room_grid_overlay_last_nz = -1;
     room_grid_overlay_last_step = -1;
-    room_grid_color_buffer.clear();
+    room_grid_color_buffer.reset();
     invalidateRoomGridOverlayColors();
     update();
 }
@@ -292,14 +292,18 @@ void LEDViewport3D::SetRoomGridPointSize(float size)
 
 void LEDViewport3D::SetRoomGridColorBuffer(std::vector<RGBColor> buf)
 {
-    room_grid_color_buffer = std::move(buf);
+    room_grid_color_buffer = std::make_shared<const std::vector<RGBColor>>(std::move(buf));
     room_grid_overlay_colors_dirty = true;
     update();
 }
 
-void LEDViewport3D::SwapRoomGridColorBuffer(std::vector<RGBColor>& buf)
+void LEDViewport3D::ShareRoomGridColorBuffer(std::shared_ptr<const std::vector<RGBColor>> buf)
 {
-    room_grid_color_buffer.swap(buf);
+    if(buf == room_grid_color_buffer)
+    {
+        return;
+    }
+    room_grid_color_buffer = std::move(buf);
     room_grid_overlay_colors_dirty = true;
     update();
 }
@@ -314,7 +318,7 @@ void LEDViewport3D::DrawRoomGridOverlay()
     const size_t count = (size_t)nx * (size_t)ny * (size_t)nz;
     if(count <= 0) return;
 
-    const bool use_buffer = (room_grid_color_buffer.size() == count);
+    const bool use_buffer = (room_grid_color_buffer && room_grid_color_buffer->size() == count);
     const bool use_callback = (!use_buffer && room_grid_color_callback != nullptr);
     const float default_r = 0.0f;
     const float default_g = 0.0f;
@@ -370,7 +374,7 @@ void LEDViewport3D::DrawRoomGridOverlay()
                     if(use_buffer)
                     {
                         const size_t idx = (size_t)(ix * ny * nz + iy * nz + iz);
-                        RGBColor c = room_grid_color_buffer[idx];
+                        RGBColor c = (*room_grid_color_buffer)[idx];
                         r = (float)RGBGetRValue(c) / 255.0f * room_grid_brightness;
                         g = (float)RGBGetGValue(c) / 255.0f * room_grid_brightness;
                         b = (float)RGBGetBValue(c) / 255.0f * room_grid_brightness;
@@ -43,6 +43,7 @@
 #include "DisplayPlaneManager.h"
 #include "Effects3D/ScreenMirror/ScreenMirror.h"
 #include "SpatialLighting/SpatialLightingSceneProvider.h"
+#include "Shaders/SpatialVolumeFieldEngine.h"
 #include "GridSpaceUtils.h"
 #include <QStackedWidget>
 #include <fstream>
@@ -116,9 +117,9 @@ OpenRGB3DSpatialTab::OpenRGB3DSpatialTab(OpenRGBPluginAPIInterface* rm, QWidget
 
     QTimer::singleShot(0, this, [this]() { RunDeferredStartupTasks(); });
 
-    effect_timer = new QTimer(this);
-    effect_timer->setTimerType(Qt::CoarseTimer);
-    connect(effect_timer, &QTimer::timeout, this, &OpenRGB3DSpatialTab::effectTimerTimeout);
+    render_worker = std::make_unique<EffectRenderWorker>([this](float dt) { RenderWorkerTick(dt); });
+    render_task_pool = std::make_unique<EffectRenderTaskPool>();
+    controller_output = std::make_unique<ControllerOutputStage>();
 }
 
 void OpenRGB3DSpatialTab::RunDeferredStartupTasks()
@@ -138,6 +139,15 @@ void OpenRGB3DSpatialTab::RunDeferredStartupTasks()
 
 OpenRGB3DSpatialTab::~OpenRGB3DSpatialTab()
 {
+    StopRenderWorker();
+    render_worker.reset();
+    {
+        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+        SpatialVolumeFieldEngine::setCpuBakePool(nullptr);
+    }
+    render_task_pool.reset();
+    controller_output.reset();
+
     if(AudioInputManager* audio = AudioInputManager::instance())
     {
         audio->stop();
@@ -146,12 +156,6 @@ OpenRGB3DSpatialTab::~OpenRGB3DSpatialTab()
 
     SavePluginUiSettings();
 
-    if(effect_timer)
-    {
-        effect_timer->stop();
-        delete effect_timer;
-    }
-
     delete ui;
     ui = nullptr;
 }
@@ -823,10 +827,7 @@ void OpenRGB3DSpatialTab::ClearCustomEffectUI()
         return;
     }
 
-    if(effect_timer && effect_timer->isActive())
-    {
-        effect_timer->stop();
-    }
+    StopRenderWorker();
     effect_running = false;
     SyncScreenCaptureSession();
 
@@ -1181,21 +1182,23 @@ void OpenRGB3DSpatialTab::effectBoundsChanged(int index)
             EffectInstance3D* instance = effect_stack[current_row].get();
             if(instance)
             {
-                SpatialEffect3D* settings_source = nullptr;
-                if(instance->effect)
+                // The render instance may belong to the worker; change it through the settings hand-off.
+                nlohmann::json current_settings;
+                if(current_effect_ui)
                 {
-                    instance->effect->SetEffectBoundsMode(mode);
-                    settings_source = instance->effect.get();
+                    current_settings = current_effect_ui->SaveSettings();
                 }
-                else if(current_effect_ui)
+                else if(instance->effect)
                 {
-                    settings_source = current_effect_ui;
+                    std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                    current_settings = instance->effect->SaveSettings();
                 }
 
-                if(settings_source)
+                if(current_settings.is_object())
                 {
-                    nlohmann::json current_settings = settings_source->SaveSettings();
+                    current_settings["effect_bounds_mode"] = mode;
                     instance->saved_settings = std::make_unique<nlohmann::json>(current_settings);
+                    PublishRenderSettings(instance, current_settings);
                     SetLayoutDirty();
                 }
             }
@@ -24,9 +24,13 @@
 #include <QProgressBar>
 #include <QHash>
 #include <QVector3D>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_set>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include "filesystem.h"
 
@@ -50,6 +54,11 @@ namespace EffectPack { struct Pack; }
 #include "ZoneManager3D.h"
 #include "SpatialControllerEntryKey.h"
 #include "SpatialControllerListBacking.h"
+#include "EffectRenderWorker.h"
+#include "EffectRenderTaskPool.h"
+#include "ControllerOutputStage.h"
+#include "LedFrameLayout3D.h"
+#include "EffectStackEvaluator.h"
 
 class SpatialControllerCardList;
 class SpatialControllerCardWidget;
@@ -60,6 +69,8 @@ class ObjectCreatorTabPanel;
 class ControllerListPanel;
 class PositionAxisDragController;
 class EffectGlobalSettingsPanel;
+struct EffectRenderSnapshot;
+struct EffectRenderOutput;
 
 namespace Ui
 {
@@ -180,7 +191,6 @@ private slots:
     void deleteZoneClicked();
     void zoneSelected(int index);
 
-    void effectTimerTimeout();
     void RenderEffectStack();
     void gridSnapToggled(bool enabled);
     void roomGuideLabelsToggled(bool enabled);
@@ -479,11 +489,10 @@ private:
     QPushButton*                stop_effect_button = nullptr;
     SpatialEffect3D*            current_effect_ui = nullptr;
     class EffectRoomOutputPanel* stack_room_output_panel_ = nullptr;
-    QTimer*                     effect_timer = nullptr;
     bool                        deferred_startup_done_ = false;
     bool                        effect_running = false;
+    /** Advanced by the render worker; guarded by SpatialEffect3D::RenderStateMutex() while it runs. */
     float                       effect_time = 0.0f;
-    QElapsedTimer               effect_elapsed;
     bool                        stack_settings_updating = false;
 
     /** Internal packing wrap when adding physical devices (not shown in Grid Settings). */
@@ -548,7 +557,57 @@ private slots:
     void displayPlaneRotationSignal(int index, float x, float y, float z);
 
 private:
-    std::vector<RGBColor> room_grid_overlay_buffer;
+    /*-----------------------------------------------------*\
+    | Effect render worker: GUI builds snapshot, worker     |
+    | evaluates LEDs / overlay, GUI applies the output.     |
+    \*-----------------------------------------------------*/
+    std::shared_ptr<EffectRenderSnapshot> BuildRenderFrameSnapshot();
+    void ApplyRenderFrameOutput(EffectRenderOutput& output);
+    void InvalidateRenderSnapshot();
+    /** Parameter edits for a stack layer's render instance: loaded now when stopped, else by the worker's next frame. */
+    void PublishRenderSettings(EffectInstance3D* instance, const nlohmann::json& settings);
+    void StartRenderWorker(unsigned int target_fps);
+    void ConfigureRenderTaskPool();
+    void ConfigureControllerOutput();
+    void ConfigureRenderCompositor();
+    void StopRenderWorker();
+    void RenderWorkerTick(float dt);
+    void OnRenderWorkerFrameReady();
+
+    std::unique_ptr<EffectRenderWorker>          render_worker;
+    /** LED range fan-out for EvaluateRenderSnapshot; Run() only under render_evaluation_mutex. */
+    std::unique_ptr<EffectRenderTaskPool>        render_task_pool;
+    /** Plan, overlay and scratch EvaluateRenderSnapshot keeps for this tab's stack; guarded like render_task_pool. */
+    EffectStackEvaluatorState                    render_evaluator_state;
+    /**
+     * Held by whichever thread evaluates a frame (without the render lock). Structural edits wait on it
+     * in InvalidateRenderSnapshot so an in-flight frame never reads an effect or transform they free.
+     */
+    std::mutex                                   render_evaluation_mutex;
+    /** GUI thread only; UpdateLEDs() fan-out with change detection. Reset whenever the device list changes. */
+    std::unique_ptr<ControllerOutputStage>       controller_output;
+    /** Physical controllers in output order for output_order_generation (the render snapshot generation). */
+    std::vector<RGBControllerInterface*>         output_controller_order;
+    /** Copied into each snapshot; see EffectRenderSnapshot::temporal_dither. */
+    bool                                         render_temporal_dither = false;
+    std::uint64_t                                output_order_generation = 0;
+    bool                                         output_order_valid = false;
+    /** Guarded by SpatialEffect3D::RenderStateMutex(). */
+    std::shared_ptr<const EffectRenderSnapshot>  render_snapshot;
+    std::uint64_t                                render_snapshot_generation = 0;
+    std::mutex                                   render_output_mutex;
+    std::shared_ptr<EffectRenderOutput>          render_pending_output;
+    std::atomic<bool>                            render_frame_posted{false};
+    /** GUI thread only; compiled LED streams shared with every snapshot until the layout epoch moves. */
+    LedFrameLayoutCache3D                        led_frame_layout;
+    /** GUI thread only; EffectRenderSnapshot::scene, recopied when the layout epoch moves. */
+    std::shared_ptr<const std::vector<std::unique_ptr<ControllerTransform>>> render_scene;
+    std::uint64_t                                render_scene_layout_epoch = 0;
+    std::uint64_t                                room_sample_layout_epoch = 0;
+    /** Physical controllers driven through virtual controller mappings, for managed_by_virtuals_generation. */
+    std::unordered_set<RGBControllerInterface*>  controllers_managed_by_virtuals;
+    std::uint64_t                                managed_by_virtuals_generation = 0;
+    bool                                         managed_by_virtuals_valid = false;
 
     bool layout_dirty = false;
     QLabel* profile_unsaved_banner_ = nullptr;
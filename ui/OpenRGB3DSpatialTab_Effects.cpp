@@ -89,6 +89,7 @@ void OpenRGB3DSpatialTab::removeEffectFromStackClicked()
         LoadStackEffectControls(nullptr);
     }
 
+    InvalidateRenderSnapshot();
     effect_stack.erase(effect_stack.begin() + current_row);
 
     if(effect_stack.empty())
@@ -268,6 +269,7 @@ void OpenRGB3DSpatialTab::stackEffectTypeChanged(int)
     QString class_name = stackEffectTypeCombo()->currentData().toString();
     QString ui_name = stackEffectTypeCombo()->currentText();
 
+    InvalidateRenderSnapshot();
     if(class_name.isEmpty())
     {
         instance->effect.reset();
@@ -368,6 +370,7 @@ void OpenRGB3DSpatialTab::LoadStackEffectControls(EffectInstance3D* instance)
     if(current_effect_ui)
     {
         disconnect(current_effect_ui, nullptr, this, nullptr);
+        InvalidateRenderSnapshot();
         current_effect_ui = nullptr;
     }
     if(start_effect_button)
@@ -524,6 +527,7 @@ void OpenRGB3DSpatialTab::DisplayEffectInstanceDetails(EffectInstance3D* instanc
     }
     else if(instance->effect)
     {
+        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
         settings = instance->effect->SaveSettings();
     }
 
@@ -594,10 +598,7 @@ void OpenRGB3DSpatialTab::DisplayEffectInstanceDetails(EffectInstance3D* instanc
 
                 nlohmann::json updated = captured_ui->SaveSettings();
                 instance->saved_settings = std::make_unique<nlohmann::json>(updated);
-                if(instance->effect)
-                {
-                    instance->effect->LoadSettings(updated);
-                }
+                PublishRenderSettings(instance, updated);
                 SetLayoutDirty();
                 RefreshEffectDisplay();
 
@@ -776,13 +777,12 @@ void OpenRGB3DSpatialTab::startEffectClicked()
 
         effect_running = true;
         effect_time = 0.0f;
-        effect_elapsed.restart();
         if(viewport)
         {
             viewport->SetEffectRenderOwnsScreenPreviewUploads(true);
         }
 
-        if(effect_timer)
+        if(render_worker)
         {
             unsigned int target_fps = 30;
             for(size_t i = 0; i < effect_stack.size(); i++)
@@ -811,9 +811,7 @@ void OpenRGB3DSpatialTab::startEffectClicked()
             {
                 target_fps = 120u;
             }
-            int interval_ms = (int)(1000 / target_fps);
-            if(interval_ms < 1) interval_ms = 1;
-            effect_timer->start(interval_ms);
+            StartRenderWorker(target_fps);
         }
 
         if(start_effect_button) start_effect_button->setEnabled(false);
@@ -839,13 +837,12 @@ void OpenRGB3DSpatialTab::startEffectClicked()
 
     effect_running = true;
     effect_time = 0.0f;
-    effect_elapsed.restart();
     if(viewport)
     {
         viewport->SetEffectRenderOwnsScreenPreviewUploads(true);
     }
 
-    if(effect_timer)
+    if(render_worker)
     {
         unsigned int target_fps = current_effect_ui->GetTargetFPS();
         if(target_fps < 1) target_fps = 30;
@@ -853,9 +850,7 @@ void OpenRGB3DSpatialTab::startEffectClicked()
         {
             target_fps = 120u;
         }
-        int interval_ms = (int)(1000 / target_fps);
-        if(interval_ms < 1) interval_ms = 1;
-        effect_timer->start(interval_ms);
+        StartRenderWorker(target_fps);
     }
 
     if(start_effect_button) start_effect_button->setEnabled(false);
@@ -871,10 +866,7 @@ void OpenRGB3DSpatialTab::stopEffectClicked()
         viewport->SetEffectRenderOwnsScreenPreviewUploads(false);
     }
     SyncScreenCaptureSession();
-    if(effect_timer && effect_timer->isActive())
-    {
-        effect_timer->stop();
-    }
+    StopRenderWorker();
     if(start_effect_button) start_effect_button->setEnabled(true);
     if(stop_effect_button) stop_effect_button->setEnabled(false);
     UpdateStartStopAllButtons();
@@ -899,25 +891,10 @@ void OpenRGB3DSpatialTab::UpdateStartStopAllButtons()
         stopAllEffectsButton()->setEnabled(effect_running);
 }
 
-void OpenRGB3DSpatialTab::effectTimerTimeout()
-{
-    if(!effect_running)
-    {
-        return;
-    }
-
-    qint64 ms = effect_elapsed.isValid() ? effect_elapsed.restart() : 33;
-    if(ms <= 0) { ms = 33; }
-    float dt = static_cast<float>(ms) / 1000.0f;
-    if(dt > 0.1f) dt = 0.1f;
-    effect_time += dt;
-
-    RenderEffectStack();
-}
-
 bool OpenRGB3DSpatialTab::RebuildEffectStackFromJson(const nlohmann::json& effects_array)
 {
     LoadStackEffectControls(nullptr);
+    InvalidateRenderSnapshot();
     effect_stack.clear();
 
     if(!effects_array.is_array())
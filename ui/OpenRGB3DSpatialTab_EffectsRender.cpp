@@ -5,13 +5,10 @@
 #include "ZoneGrid3D.h"
 #include "Effects3D/Games/Minecraft/MinecraftGame.h"
 #include "Effects3D/ScreenMirror/ScreenMirror.h"
-#include "ScreenCaptureManager.h"
 #include "PluginLog.h"
 #include "ControllerLayout3D.h"
 #include "SpatialLighting/SpatialLightingSceneProvider.h"
-#include "SpatialLighting/EmitterRelayMirror.h"
 #include "SpatialLighting/EmitterLocalSampling.h"
-#include "Effects3D/SpatialLighting/RoomSpatialLightingUi.h"
 #include "VirtualController3D.h"
 #include "LEDPosition3D.h"
 #include "SpatialRoom/SpatialRoomFrame.h"
@@ -20,22 +17,36 @@
 #include "SpatialTabLedHelpers.h"
 #include "PluginUiUtils.h"
 #include "Game/RoomSampleConfigPublisher.h"
+#include "EffectRenderFrame.h"
+#include "EffectRenderWorker.h"
+#include "EffectRenderTaskPool.h"
+#include "EffectStackEvaluator.h"
+#include "Shaders/SpatialVolumeFieldEngine.h"
 #include "ui_OpenRGB3DSpatialTab.h"
 #include <cmath>
 #include <algorithm>
-#include <set>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 
 namespace
 {
-struct EffectSlotGridOverride
+/** settings["Render"][key] as T; fallback when the section or key is missing or has the wrong type. */
+template<typename T>
+T ReadRenderSetting(const nlohmann::json& settings, const char* key, T fallback)
 {
-    bool use_zone_grid = false;
-    bool use_anchor_grid = false;
-    std::unique_ptr<GridContext3D> room_grid_local;
-    std::unique_ptr<GridContext3D> world_grid_local;
-};
+    try
+    {
+        if(settings.contains("Render") && settings["Render"].contains(key))
+        {
+            return settings["Render"][key].get<T>();
+        }
+    }
+    catch(const std::exception&)
+    {
+    }
+    return fallback;
+}
 
 void ApplyZoneAnchorMetadata(GridContext3D& grid,
                              ReferenceMode origin_mode,
@@ -149,21 +160,6 @@ void PopulateEffectSlotGrids(EffectSlotGridOverride& slot_override,
     }
 }
 
-const GridContext3D* ResolveActiveSlotGrid(const EffectSlotGridOverride& slot_override,
-                                           bool use_world_bounds)
-{
-    if(slot_override.use_zone_grid || slot_override.use_anchor_grid)
-    {
-        return use_world_bounds ? slot_override.world_grid_local.get() : slot_override.room_grid_local.get();
-    }
-    return nullptr;
-}
-
-int PackAmbientShadeSlot(int controller_index, int led_index)
-{
-    return (controller_index << 16) ^ (led_index & 0xFFFF);
-}
-
 }
 
 static float AverageAlongAxis(ControllerTransform* transform,
@@ -229,255 +225,300 @@ static float AverageAlongAxis(ControllerTransform* transform,
     }
 }
 
-namespace
-{
-
-bool EffectSlotAppliesToController(int slot_zone_index, int ctrl_idx, ZoneManager3D* zone_manager)
+static bool TryGetGlobalLedIndex(RGBControllerInterface* controller,
+                                 unsigned int zone_idx,
+                                 unsigned int led_idx,
+                                 unsigned int* global_idx)
 {
-    if(slot_zone_index == -1)
+    if(!controller || !global_idx)
     {
-        return true;
+        return false;
     }
-    if(slot_zone_index <= -1000)
+    if(zone_idx >= controller->GetZoneCount())
     {
-        const int target_ctrl_idx = -(slot_zone_index + 1000);
-        return target_ctrl_idx >= 0 && target_ctrl_idx == ctrl_idx;
+        return false;
     }
-    if(zone_manager && slot_zone_index >= 0)
+    if(led_idx >= controller->GetZoneLEDsCount(zone_idx))
     {
-        if(Zone3D* zone = zone_manager->GetZone(slot_zone_index))
-        {
-            const std::vector<int>& zone_controllers = zone->GetControllers();
-            return std::find(zone_controllers.begin(), zone_controllers.end(), ctrl_idx) != zone_controllers.end();
-        }
+        return false;
     }
-    return false;
+
+    *global_idx = controller->GetZoneStartIndex(zone_idx) + led_idx;
+    return (*global_idx < controller->GetLEDCount());
 }
 
-bool ShouldApplyStackLayerToController(const SpatialEffect3D* effect,
-                                       size_t effect_index,
-                                       size_t relay_stack_index,
-                                       bool has_relay_stack,
-                                       int ctrl_idx,
-                                       const std::unordered_set<int>* relay_emitter_indices = nullptr)
+void OpenRGB3DSpatialTab::RenderEffectStack()
 {
-    if(!effect)
+    std::shared_ptr<EffectRenderSnapshot> snapshot;
     {
-        return false;
+        // Snapshot building only reads effect settings, which the worker writes under this lock.
+        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+        snapshot = BuildRenderFrameSnapshot();
+        render_snapshot = snapshot;
     }
-    const auto is_relay_emitter = [&](int index) -> bool {
-        if(relay_emitter_indices)
-        {
-            return relay_emitter_indices->find(index) != relay_emitter_indices->end();
-        }
-        return SpatialLightingSceneProvider::instance()->isEmitterController(index);
-    };
-    if(has_relay_stack)
+    if(!snapshot)
     {
-        if(effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::Direct &&
-           !is_relay_emitter(ctrl_idx))
-        {
-            return false;
-        }
-        if(effect_index < relay_stack_index && !is_relay_emitter(ctrl_idx))
-        {
-            return false;
-        }
+        return;
     }
-    if(!effect->appliesRoomOutputToController(ctrl_idx))
+
+    // While the worker runs it evaluates the fresh snapshot on its next tick.
+    if(render_worker && render_worker->IsRunning())
     {
-        return false;
+        return;
     }
-    return true;
-}
-
-struct RenderEffectSlot
-{
-    SpatialEffect3D* effect;
-    int zone_index;
-    BlendMode blend_mode;
-};
 
-SpatialLighting::OccluderBuildOptions MergeStackOccluderOptions(const std::vector<RenderEffectSlot>& effect_slots)
-{
-    SpatialLighting::OccluderBuildOptions merged{};
-    for(const RenderEffectSlot& effect_slot : effect_slots)
+    EffectRenderOutput output;
+    output.snapshot = snapshot;
     {
-        if(!effect_slot.effect)
+        std::lock_guard<std::mutex> evaluation_lock(render_evaluation_mutex);
         {
-            continue;
+            std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+            SyncRenderSnapshotEffects(*snapshot, render_evaluator_state);
         }
-        const RoomSpatialLightingUi::RoomSpatialLightParams& params = effect_slot.effect->roomRelayParams();
-        if(!params.use_occlusion)
-        {
-            continue;
-        }
-        const SpatialLighting::OccluderBuildOptions layer_opts =
-            RoomSpatialLightingUi::BuildOccluderOptions(params);
-        merged.display_planes |= layer_opts.display_planes;
-        merged.room_walls |= layer_opts.room_walls;
-        merged.controllers |= layer_opts.controllers;
-        merged.light_blockers |= layer_opts.light_blockers;
+        EvaluateRenderSnapshot(*snapshot,
+                               effect_time,
+                               NextEffectRenderSequence(),
+                               render_task_pool.get(),
+                               render_evaluator_state,
+                               output);
     }
-    return merged;
+    ApplyRenderFrameOutput(output);
 }
 
-const SpatialEffect3D* ResolveAmbientShadeSource(const std::vector<RenderEffectSlot>& effect_slots,
-                                                 size_t relay_stack_index,
-                                                 bool has_relay_stack,
-                                                 int ctrl_idx,
-                                                 ZoneManager3D* zone_manager)
+void OpenRGB3DSpatialTab::InvalidateRenderSnapshot()
 {
-    for(size_t effect_idx = effect_slots.size(); effect_idx-- > 0;)
+    // Callers go on to free effects or transforms; let a frame still reading them finish first.
+    std::lock_guard<std::mutex> evaluation_lock(render_evaluation_mutex);
+    std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+    render_snapshot.reset();
+    ++render_snapshot_generation;
+    led_frame_layout.Invalidate();
+    render_scene.reset();
+}
+
+void OpenRGB3DSpatialTab::PublishRenderSettings(EffectInstance3D* instance, const nlohmann::json& settings)
+{
+    if(!instance || !instance->effect)
     {
-        const RenderEffectSlot& effect_slot = effect_slots[effect_idx];
-        SpatialEffect3D* effect = effect_slot.effect;
-        if(!effect)
-        {
-            continue;
-        }
-        if(effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
-        {
-            continue;
-        }
-        if(!effect->roomRelayParams().use_occlusion)
-        {
-            continue;
-        }
-        if(!EffectSlotAppliesToController(effect_slot.zone_index, ctrl_idx, zone_manager))
-        {
-            continue;
-        }
-        if(!ShouldApplyStackLayerToController(effect,
-                                              effect_idx,
-                                              relay_stack_index,
-                                              has_relay_stack,
-                                              ctrl_idx))
-        {
-            continue;
-        }
-        return effect;
+        return;
     }
-    return nullptr;
+    if(render_worker && render_worker->IsRunning())
+    {
+        // The worker owns the render instance; SyncRenderSnapshotEffects loads these before its next frame.
+        instance->render_settings = std::make_shared<const nlohmann::json>(settings);
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+    instance->effect->LoadSettings(settings);
 }
 
-const SpatialEffect3D* ResolveOverlayAmbientShadeSource(const std::vector<RenderEffectSlot>& effect_slots)
+void OpenRGB3DSpatialTab::StartRenderWorker(unsigned int target_fps)
 {
-    for(size_t effect_idx = effect_slots.size(); effect_idx-- > 0;)
+    if(!render_worker)
     {
-        const SpatialEffect3D* effect = effect_slots[effect_idx].effect;
-        if(!effect)
-        {
-            continue;
-        }
-        if(effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
-        {
-            continue;
-        }
-        if(effect->roomRelayParams().use_occlusion)
-        {
-            return effect;
-        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> output_lock(render_output_mutex);
+        render_pending_output.reset();
     }
-    return nullptr;
+    render_frame_posted.store(false);
+    // Never let the first tick evaluate a snapshot built before the stack last changed.
+    InvalidateRenderSnapshot();
+    ConfigureRenderTaskPool();
+    ConfigureControllerOutput();
+    ConfigureRenderCompositor();
+    render_worker->Start(target_fps);
 }
 
-RGBColor SamplePatternOnEmitterCanvas(SpatialEffect3D* effect,
-                                      float room_x,
-                                      float room_y,
-                                      float room_z,
-                                      float time,
-                                      const EmitterLocalSampling::CombinedEmitterCanvas& canvas)
+void OpenRGB3DSpatialTab::ConfigureRenderTaskPool()
 {
-    if(!effect || !canvas.valid || !canvas.grid)
+    if(!render_task_pool)
+    {
+        return;
+    }
+
+    // Render.EvaluationThreads: pool workers besides the render thread; absent or negative = one per spare core.
+    unsigned int workers = EffectRenderTaskPool::DefaultWorkerCount();
+    const int configured = ReadRenderSetting<int>(GetPluginSettings(), "EvaluationThreads", -1);
+    if(configured >= 0)
     {
-        return 0x00000000;
+        workers = (unsigned int)configured;
     }
-    return effect->EvaluateColorGrid(room_x, room_y, room_z, time, *canvas.grid);
+
+    std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+    render_task_pool->SetWorkerCount(workers);
+    SpatialVolumeFieldEngine::setCpuBakePool(render_task_pool.get());
 }
 
-RGBColor SampleStackLayerColor(SpatialEffect3D* effect,
-                               float x,
-                               float y,
-                               float z,
-                               float time,
-                               const GridContext3D& grid)
+void OpenRGB3DSpatialTab::ConfigureControllerOutput()
 {
-    if(!effect)
+    if(!controller_output)
     {
-        return 0x00000000;
+        return;
     }
-    return effect->EvaluateColorGrid(x, y, z, time, grid);
+
+    // Render.AsyncDeviceOutput: false writes devices on the GUI thread (still skipping unchanged ones).
+    const bool async = ReadRenderSetting<bool>(GetPluginSettings(), "AsyncDeviceOutput", true);
+    controller_output->SetAsync(async);
 }
 
-bool IsRelayOnlyReceiver(const SpatialEffect3D* relay_effect, int ctrl_idx)
+void OpenRGB3DSpatialTab::ConfigureRenderCompositor()
 {
-    return relay_effect &&
-           relay_effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay &&
-           relay_effect->isRoomReceiverController(ctrl_idx) &&
-           !relay_effect->isRoomEmitterController(ctrl_idx);
+    // Render.TemporalDither: trade exact repeat frames (and unchanged-device skips) for smooth dim gradients.
+    render_temporal_dither = ReadRenderSetting<bool>(GetPluginSettings(), "TemporalDither", false);
 }
 
-bool IsRelayEmitter(const SpatialEffect3D* relay_effect, int ctrl_idx)
+void OpenRGB3DSpatialTab::StopRenderWorker()
 {
-    return relay_effect &&
-           relay_effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay &&
-           relay_effect->isRoomEmitterController(ctrl_idx);
+    if(render_worker)
+    {
+        render_worker->Stop();
+    }
+    {
+        // Edits published after the worker's last frame still belong on the render instances.
+        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+        for(const std::unique_ptr<EffectInstance3D>& instance : effect_stack)
+        {
+            if(!instance || !instance->render_settings)
+            {
+                continue;
+            }
+            if(instance->effect &&
+               render_evaluator_state.applied_settings[instance->effect.get()] != instance->render_settings)
+            {
+                instance->effect->LoadSettings(*instance->render_settings);
+            }
+            instance->render_settings.reset();
+        }
+        render_evaluator_state.applied_settings.clear();
+    }
+    InvalidateRenderSnapshot();
+    std::lock_guard<std::mutex> output_lock(render_output_mutex);
+    render_pending_output.reset();
 }
 
-} // namespace
+void OpenRGB3DSpatialTab::RenderWorkerTick(float dt)
+{
+    std::shared_ptr<EffectRenderOutput> output;
+    {
+        std::lock_guard<std::mutex> evaluation_lock(render_evaluation_mutex);
+        std::shared_ptr<const EffectRenderSnapshot> snapshot;
+        float time = 0.0f;
+        {
+            // Only the hand-off holds the render lock, so slider drags and snapshot rebuilds never wait on LEDs.
+            std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+            effect_time += dt;
+            time = effect_time;
+            snapshot = render_snapshot;
+            if(snapshot)
+            {
+                SyncRenderSnapshotEffects(*snapshot, render_evaluator_state);
+            }
+        }
+        if(snapshot)
+        {
+            output = std::make_shared<EffectRenderOutput>();
+            output->snapshot = snapshot;
+            EvaluateRenderSnapshot(*snapshot,
+                                   time,
+                                   NextEffectRenderSequence(),
+                                   render_task_pool.get(),
+                                   render_evaluator_state,
+                                   *output);
+        }
+    }
+
+    if(output)
+    {
+        std::lock_guard<std::mutex> output_lock(render_output_mutex);
+        render_pending_output = std::move(output);
+    }
 
-static bool TryGetGlobalLedIndex(RGBControllerInterface* controller,
-                                 unsigned int zone_idx,
-                                 unsigned int led_idx,
-                                 unsigned int* global_idx)
+    // One queued hop per GUI turn: apply the newest frame, then rebuild the snapshot
+    // (also requests a snapshot when there is none, e.g. after a structural edit).
+    if(!render_frame_posted.exchange(true))
+    {
+        QMetaObject::invokeMethod(this, [this]() { OnRenderWorkerFrameReady(); }, Qt::QueuedConnection);
+    }
+}
+
+void OpenRGB3DSpatialTab::OnRenderWorkerFrameReady()
 {
-    if(!controller || !global_idx)
+    render_frame_posted.store(false);
+    if(!effect_running || !render_worker || !render_worker->IsRunning())
     {
-        return false;
+        return;
     }
-    if(zone_idx >= controller->GetZoneCount())
+
+    std::shared_ptr<EffectRenderOutput> output;
     {
-        return false;
+        std::lock_guard<std::mutex> output_lock(render_output_mutex);
+        output = std::move(render_pending_output);
     }
-    if(led_idx >= controller->GetZoneLEDsCount(zone_idx))
+    if(output)
     {
-        return false;
+        ApplyRenderFrameOutput(*output);
     }
 
-    *global_idx = controller->GetZoneStartIndex(zone_idx) + led_idx;
-    return (*global_idx < controller->GetLEDCount());
+    RenderEffectStack();
 }
 
-void OpenRGB3DSpatialTab::RenderEffectStack()
+std::shared_ptr<EffectRenderSnapshot> OpenRGB3DSpatialTab::BuildRenderFrameSnapshot()
 {
-    MinecraftGame::ClearRenderSampleIndexContext();
-
     if(controller_transforms.empty())
     {
-        return;
+        return nullptr;
     }
 
     SpatialLightingSceneProvider::instance()->SetControllers(&controller_transforms);
     SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
 
-    static uint64_t s_effect_render_sequence = 0;
-    const uint64_t effect_render_sequence = ++s_effect_render_sequence;
+    const uint64_t effect_render_sequence = NextEffectRenderSequence();
+    EffectRenderFrameGuard effect_render_frame_guard;
 
-    struct EffectRenderFrameGuard
+    // Virtual mapping edits go through InvalidateRenderSnapshot, so the set only moves with the generation.
+    if(!managed_by_virtuals_valid || managed_by_virtuals_generation != render_snapshot_generation)
     {
-        EffectRenderFrameGuard()
+        controllers_managed_by_virtuals.clear();
+        for(const std::unique_ptr<ControllerTransform>& transform_ptr : controller_transforms)
         {
-            SpatialRoom::BeginEffectRenderFrame();
+            ControllerTransform* transform = transform_ptr.get();
+            if(!transform || transform->virtual_controller == nullptr)
+            {
+                continue;
+            }
+
+            const std::vector<GridLEDMapping>& mappings = transform->virtual_controller->GetMappings();
+            for(const GridLEDMapping& mapping : mappings)
+            {
+                if(mapping.controller)
+                {
+                    controllers_managed_by_virtuals.insert(mapping.controller);
+                }
+            }
         }
-        ~EffectRenderFrameGuard()
+        managed_by_virtuals_generation = render_snapshot_generation;
+        managed_by_virtuals_valid = true;
+    }
+
+    // Refreshes world positions and recompiles only when the layout epoch moved.
+    std::shared_ptr<const LedFrameLayout3D> led_layout =
+        led_frame_layout.Acquire(controller_transforms, controllers_managed_by_virtuals);
+
+    // The worker builds occluders and the relay mirror from this copy, never from the live transforms.
+    if(!render_scene || render_scene_layout_epoch != led_layout->epoch)
+    {
+        std::shared_ptr<std::vector<std::unique_ptr<ControllerTransform>>> scene =
+            std::make_shared<std::vector<std::unique_ptr<ControllerTransform>>>();
+        scene->reserve(controller_transforms.size());
+        for(const std::unique_ptr<ControllerTransform>& transform_ptr : controller_transforms)
         {
-            SpatialRoom::EndEffectRenderFrame();
+            scene->push_back(transform_ptr ? std::make_unique<ControllerTransform>(*transform_ptr) : nullptr);
         }
-        EffectRenderFrameGuard(const EffectRenderFrameGuard&) = delete;
-        EffectRenderFrameGuard& operator=(const EffectRenderFrameGuard&) = delete;
-    };
-    EffectRenderFrameGuard effect_render_frame_guard;
+        render_scene = std::move(scene);
+        render_scene_layout_epoch = led_layout->epoch;
+    }
 
     ManualRoomSettings room_settings = MakeManualRoomSettings(true,
                                                               manual_room_width,
@@ -505,29 +546,22 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
         world_grid.SetLedCentroid(led_mu.x, led_mu.y, led_mu.z);
     }
 
-    // LED-first Room Ambilight: publish against the global room grid + all layout LED room positions.
+    // LED-first Room Ambilight: publish against the global room grid + every rendered LED's room position.
     // (Effect-local zone grids must not be used for room bounds — that mapped LEDs to the wrong side.)
+    RoomSampleConfigPublisher::SetPublishRoomGrid(room_grid);
+    if(led_layout->epoch != room_sample_layout_epoch)
     {
-        RoomSampleConfigPublisher::SetPublishRoomGrid(room_grid);
-        std::vector<float> led_xyz;
-        led_xyz.reserve(4096);
-        for(const std::unique_ptr<ControllerTransform>& transform : controller_transforms)
+        std::vector<float> led_xyz(led_layout->size() * 3u);
+        for(size_t i = 0; i < led_layout->size(); i++)
         {
-            if(!transform || transform->hidden_by_virtual)
-            {
-                continue;
-            }
-            ControllerLayout3D::UpdateWorldPositions(transform.get());
-            for(const LEDPosition3D& led : transform->led_positions)
-            {
-                led_xyz.push_back(led.room_position.x);
-                led_xyz.push_back(led.room_position.y);
-                led_xyz.push_back(led.room_position.z);
-            }
+            led_xyz[i * 3u + 0u] = led_layout->room_x[i];
+            led_xyz[i * 3u + 1u] = led_layout->room_y[i];
+            led_xyz[i * 3u + 2u] = led_layout->room_z[i];
         }
         RoomSampleConfigPublisher::SetFrameLedRoomPositions(
             led_xyz.empty() ? nullptr : led_xyz.data(),
-            led_xyz.size() / 3u);
+            led_layout->size());
+        room_sample_layout_epoch = led_layout->epoch;
     }
 
     ReferenceMode stack_origin_mode = REF_MODE_USER_POSITION;
@@ -562,9 +596,25 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
         }
     }
 
-    std::vector<RenderEffectSlot> active_effects;
+    std::shared_ptr<EffectRenderSnapshot> snapshot = std::make_shared<EffectRenderSnapshot>(world_grid, room_grid);
+    snapshot->generation = render_snapshot_generation;
+    snapshot->stack_ref_origin = stack_ref_origin;
+    snapshot->stack_origin_mode = stack_origin_mode;
+    snapshot->scene = render_scene;
+    snapshot->temporal_dither = render_temporal_dither;
+    std::vector<RenderEffectSlot>& active_effects = snapshot->slots;
     active_effects.reserve(effect_stack.size());
 
+    const auto copy_zone_controllers = [this](RenderEffectSlot& slot) {
+        if(zone_manager && slot.zone_index >= 0)
+        {
+            if(Zone3D* zone = zone_manager->GetZone(slot.zone_index))
+            {
+                slot.zone_controllers = zone->GetControllers();
+            }
+        }
+    };
+
     for(const std::unique_ptr<EffectInstance3D>& instance_ptr : effect_stack)
     {
         EffectInstance3D* instance = instance_ptr.get();
@@ -575,20 +625,30 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
 
         RenderEffectSlot slot;
         slot.effect = instance->effect.get();
+        slot.settings = instance->render_settings;
         slot.zone_index = instance->zone_index;
         slot.blend_mode = instance->blend_mode;
-        active_effects.push_back(slot);
+        copy_zone_controllers(slot);
+        active_effects.push_back(std::move(slot));
     }
 
-    if(active_effects.empty() && current_effect_ui && effect_running)
+    // Nothing enabled: preview the layer whose settings are open, through its render instance
+    // (current_effect_ui is the GUI's widget copy and never goes to the worker).
+    if(active_effects.empty() && current_effect_ui && effect_running && effectStackList())
     {
-        RenderEffectSlot slot;
-        slot.effect = current_effect_ui;
-        slot.zone_index = ResolveZoneTargetSelection(effectZoneCombo());
-        slot.blend_mode = BlendMode::REPLACE;
-        if(slot.effect)
+        const int current_row = effectStackList()->currentRow();
+        EffectInstance3D* selected = (current_row >= 0 && current_row < (int)effect_stack.size())
+                                         ? effect_stack[(size_t)current_row].get()
+                                         : nullptr;
+        if(selected && selected->effect)
         {
-            active_effects.push_back(slot);
+            RenderEffectSlot slot;
+            slot.effect = selected->effect.get();
+            slot.settings = selected->render_settings;
+            slot.zone_index = ResolveZoneTargetSelection(effectZoneCombo());
+            slot.blend_mode = BlendMode::REPLACE;
+            copy_zone_controllers(slot);
+            active_effects.push_back(std::move(slot));
         }
     }
 
@@ -596,15 +656,6 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
     {
         const RGBColor black = 0x00000000;
         std::unordered_set<RGBControllerInterface*> controllers_to_update;
-        std::unordered_set<RGBControllerInterface*> controllers_managed_by_virtuals;
-        for(const std::unique_ptr<ControllerTransform>& t : controller_transforms)
-        {
-            if(!t || !t->virtual_controller) continue;
-            for(const GridLEDMapping& m : t->virtual_controller->GetMappings())
-            {
-                if(m.controller) controllers_managed_by_virtuals.insert(m.controller);
-            }
-        }
 
         for(const std::unique_ptr<ControllerTransform>& transform_ptr : controller_transforms)
         {
@@ -634,7 +685,10 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
                                                 led_position.led_idx,
                                                 &led_global_idx))
                         {
-                            mapping_controller->SetColor(led_global_idx, black);
+                            if(controller_output)
+                            {
+                                controller_output->GetFrameBuffer(mapping_controller)[led_global_idx] = black;
+                            }
                             controllers_to_update.insert(mapping_controller);
                         }
                     }
@@ -645,20 +699,22 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
             RGBControllerInterface* controller = transform->controller;
             if(!controller || controller->GetZoneCount() == 0 || controller->GetLEDCount() == 0) continue;
 
+            RGBColor* device_frame = controller_output ? controller_output->GetFrameBuffer(controller) : nullptr;
             for(unsigned int led_pos_idx = 0; led_pos_idx < transform->led_positions.size(); led_pos_idx++)
             {
                 LEDPosition3D& led_position = transform->led_positions[led_pos_idx];
                 led_position.preview_color = black;
                 unsigned int led_global_idx = 0;
-                if(TryGetGlobalLedIndex(controller, led_position.zone_idx, led_position.led_idx, &led_global_idx))
-                    controller->SetColor(led_global_idx, black);
+                if(device_frame &&
+                   TryGetGlobalLedIndex(controller, led_position.zone_idx, led_position.led_idx, &led_global_idx))
+                    device_frame[led_global_idx] = black;
             }
             controllers_to_update.insert(controller);
         }
 
         for(RGBControllerInterface* ctrl : controllers_to_update)
         {
-            if(ctrl) ctrl->UpdateLEDs();
+            if(ctrl && controller_output) controller_output->Submit(ctrl);
         }
 
         if(viewport)
@@ -678,55 +734,11 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
                 viewport->SetRoomGridColorBuffer(std::vector<RGBColor>());
             }
         }
-        return;
-    }
-
-    struct RenderTickSnapshotGuard
-    {
-        ScreenCaptureManager& mgr;
-        explicit RenderTickSnapshotGuard(ScreenCaptureManager& m)
-            : mgr(m)
-        {
-            mgr.BeginRenderTickSnapshot();
-        }
-        ~RenderTickSnapshotGuard()
-        {
-            mgr.EndRenderTickSnapshot();
-        }
-        RenderTickSnapshotGuard(const RenderTickSnapshotGuard&) = delete;
-        RenderTickSnapshotGuard& operator=(const RenderTickSnapshotGuard&) = delete;
-    };
-    RenderTickSnapshotGuard render_tick_snapshot_guard(ScreenCaptureManager::Instance());
-
-    for(size_t idx = 0; idx < active_effects.size(); idx++)
-    {
-        if(active_effects[idx].effect)
-        {
-            active_effects[idx].effect->SetGlobalReferencePoint(stack_ref_origin);
-            active_effects[idx].effect->SetReferenceMode(stack_origin_mode);
-        }
-    }
-
-    std::unordered_set<RGBControllerInterface*> controllers_managed_by_virtuals;
-    for(const std::unique_ptr<ControllerTransform>& transform_ptr : controller_transforms)
-    {
-        ControllerTransform* transform = transform_ptr.get();
-        if(!transform || transform->virtual_controller == nullptr)
-        {
-            continue;
-        }
-
-        const std::vector<GridLEDMapping>& mappings = transform->virtual_controller->GetMappings();
-        for(const GridLEDMapping& mapping : mappings)
-        {
-            if(mapping.controller)
-            {
-                controllers_managed_by_virtuals.insert(mapping.controller);
-            }
-        }
+        return nullptr;
     }
 
-    std::vector<EffectSlotGridOverride> slot_grid_overrides(active_effects.size());
+    std::vector<EffectSlotGridOverride>& slot_grid_overrides = snapshot->slot_grid_overrides;
+    slot_grid_overrides.resize(active_effects.size());
     for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
     {
         const RenderEffectSlot& slot = active_effects[effect_idx];
@@ -742,260 +754,40 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
                                 effect_render_sequence);
     }
 
-    SpatialLightingSceneProvider::instance()->ClearEmitterRelayFrame();
+    // Relay mirror sampling, occluders and GPU / CPU field bakes run on the worker (PrepareFrameScene);
+    // only the relay layer and its emitter canvas geometry are resolved here.
     size_t relay_stack_index = active_effects.size();
     SpatialEffect3D* relay_layer_effect = nullptr;
-    std::unordered_set<int> relay_emitter_controllers;
-    EmitterLocalSampling::CombinedEmitterCanvas emitter_canvas{};
+    for(size_t i = 0; i < active_effects.size(); ++i)
     {
-        for(size_t i = 0; i < active_effects.size(); ++i)
-        {
-            SpatialEffect3D* effect = active_effects[i].effect;
-            if(effect && effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
-            {
-                relay_stack_index = i;
-                relay_layer_effect = effect;
-                break;
-            }
-        }
-
-        if(!relay_layer_effect && current_effect_ui &&
-           current_effect_ui->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
-        {
-            for(size_t i = 0; i < active_effects.size(); ++i)
-            {
-                if(active_effects[i].effect == current_effect_ui)
-                {
-                    relay_stack_index = i;
-                    relay_layer_effect = current_effect_ui;
-                    break;
-                }
-            }
-        }
-
-        std::unordered_set<int>& emitter_set = relay_emitter_controllers;
-        if(relay_layer_effect && relay_stack_index < active_effects.size())
+        SpatialEffect3D* effect = active_effects[i].effect;
+        if(effect && effect->GetRoomOutputRole() == SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
         {
-            for(int idx : relay_layer_effect->roomEmitterControllerIndices())
-            {
-                emitter_set.insert(idx);
-            }
+            relay_stack_index = i;
+            relay_layer_effect = effect;
+            break;
         }
-
-        const bool has_relay_stack = relay_layer_effect != nullptr;
-        const size_t relay_idx = relay_stack_index;
-
-        if(relay_layer_effect && !emitter_set.empty())
+    }
+    if(relay_layer_effect)
+    {
+        const std::vector<int>& emitter_indices = relay_layer_effect->roomEmitterControllerIndices();
+        const std::unordered_set<int> emitter_set(emitter_indices.begin(), emitter_indices.end());
+        if(!emitter_set.empty())
         {
             EmitterLocalSampling::TryBuildCombinedEmitterCanvas(controller_transforms,
                                                                 emitter_set,
                                                                 room_grid.grid_scale_mm,
                                                                 effect_render_sequence,
-                                                                emitter_canvas);
-        }
-
-        if(relay_layer_effect && relay_stack_index < active_effects.size() && !emitter_set.empty())
-        {
-            const RoomSpatialLightingUi::RoomSpatialLightParams& lp = relay_layer_effect->roomRelayParams();
-            const float bright = std::max(0.15f, relay_layer_effect->GetBrightness() / 100.0f);
-
-            const auto sample_emitter_led = [&](const LEDPosition3D& led_position, int ctrl_idx) -> RGBColor {
-                const Vector3D& world_pos = led_position.world_position;
-                const float room_x = led_position.room_position.x;
-                const float room_y = led_position.room_position.y;
-                const float room_z = led_position.room_position.z;
-
-                SpatialLightingSceneProvider* shade_provider = SpatialLightingSceneProvider::instance();
-                const int prev_shade_ctrl = shade_provider->shadingControllerIndex();
-                shade_provider->SetShadingControllerIndex(ctrl_idx);
-                RGBColor blended = ToRGBColor(0, 0, 0);
-                for(size_t effect_idx = 0; effect_idx < active_effects.size(); ++effect_idx)
-                {
-                    const RenderEffectSlot& slot = active_effects[effect_idx];
-                    SpatialEffect3D* effect = slot.effect;
-                    if(!effect)
-                    {
-                        continue;
-                    }
-                    if(!EffectSlotAppliesToController(slot.zone_index, ctrl_idx, zone_manager.get()))
-                    {
-                        continue;
-                    }
-                    if(!ShouldApplyStackLayerToController(effect,
-                                                          effect_idx,
-                                                          relay_idx,
-                                                          has_relay_stack,
-                                                          ctrl_idx,
-                                                          &emitter_set))
-                    {
-                        continue;
-                    }
-
-                    RGBColor effect_color = 0x00000000;
-                    if(emitter_canvas.valid && emitter_canvas.grid)
-                    {
-                        effect_color = SamplePatternOnEmitterCanvas(effect,
-                                                                    room_x,
-                                                                    room_y,
-                                                                    room_z,
-                                                                    effect_time,
-                                                                    emitter_canvas);
-                        if(!effect->IsPointOnActiveSurface(room_x, room_y, room_z, *emitter_canvas.grid))
-                        {
-                            effect_color = 0x00000000;
-                        }
-                    }
-                    else
-                    {
-                        const EffectSlotGridOverride& grid_override = slot_grid_overrides[effect_idx];
-                        if(effect->UseZoneGrid() && slot.zone_index != -1 && !grid_override.use_zone_grid)
-                        {
-                            continue;
-                        }
-                        const bool requires_world = effect->RequiresWorldSpaceCoordinates();
-                        const bool use_world_bounds = effect->UseWorldGridBounds();
-                        const GridContext3D& global_grid = use_world_bounds ? world_grid : room_grid;
-                        const GridContext3D* local_grid =
-                            ResolveActiveSlotGrid(grid_override, use_world_bounds);
-                        const GridContext3D& stack_grid = local_grid ? *local_grid : global_grid;
-
-                        float sx = requires_world ? world_pos.x : room_x;
-                        float sy = requires_world ? world_pos.y : room_y;
-                        float sz = requires_world ? world_pos.z : room_z;
-                        const GridContext3D& active_grid = stack_grid;
-
-                        if(!effect->SkipsSpatialSampleWarp())
-                        {
-                            effect->ApplyAxisScale(sx, sy, sz, active_grid);
-                            effect->ApplyEffectRotation(sx, sy, sz, active_grid);
-                        }
-                        effect_color = SampleStackLayerColor(effect,
-                                                             sx,
-                                                             sy,
-                                                             sz,
-                                                             effect_time,
-                                                             active_grid);
-                        if(!effect->IsPointOnActiveSurface(sx, sy, sz, active_grid))
-                        {
-                            effect_color = 0x00000000;
-                        }
-                    }
-                    effect_color = effect->PostProcessColorGrid(effect_color);
-                    blended = BlendColors(blended, effect_color, slot.blend_mode);
-                }
-                shade_provider->SetShadingControllerIndex(prev_shade_ctrl);
-                return blended;
-            };
-
-            EmitterRelayMirror::MirrorFrame mirror{};
-            mirror.room_center = {room_grid.center_x, room_grid.center_y, room_grid.center_z};
-            mirror.grid_scale_mm = room_grid.grid_scale_mm;
-            mirror.light_reach_mm = lp.light_reach_mm;
-            mirror.glow_feather_percent = std::clamp(lp.glow_radius_mm * 0.38f, 5.0f, 90.0f);
-            mirror.room_fill_strength = lp.room_fill / 100.0f;
-            mirror.brightness = bright;
-
-            std::vector<EmitterRelayMirror::LedColorSample> led_samples;
-            for(const int emitter_ctrl : emitter_set)
-            {
-                if(emitter_ctrl < 0 || emitter_ctrl >= (int)controller_transforms.size())
-                {
-                    continue;
-                }
-                ControllerTransform* emitter_transform = controller_transforms[(size_t)emitter_ctrl].get();
-                if(!emitter_transform || emitter_transform->hidden_by_virtual)
-                {
-                    continue;
-                }
-                ControllerLayout3D::UpdateWorldPositions(emitter_transform);
-
-                Vector3D min_bounds{};
-                Vector3D max_bounds{};
-                ControllerLayout3D::CalculateControllerLocalBounds(emitter_transform, min_bounds, max_bounds);
-                const float span_x = std::max(max_bounds.x - min_bounds.x, 0.01f);
-                const float span_y = std::max(max_bounds.y - min_bounds.y, 0.01f);
-
-                led_samples.clear();
-                led_samples.reserve(emitter_transform->led_positions.size());
-
-                const auto push_led_sample = [&](const LEDPosition3D& led_position) {
-                    const RGBColor c = sample_emitter_led(led_position, emitter_ctrl);
-                    const uint8_t r = static_cast<uint8_t>(c & 0xFF);
-                    const uint8_t g = static_cast<uint8_t>((c >> 8) & 0xFF);
-                    const uint8_t b = static_cast<uint8_t>((c >> 16) & 0xFF);
-                    if(static_cast<int>(r) + static_cast<int>(g) + static_cast<int>(b) < 6)
-                    {
-                        return;
-                    }
-                    EmitterRelayMirror::LedColorSample sample{};
-                    sample.u = (led_position.local_position.x - min_bounds.x) / span_x;
-                    sample.v = (led_position.local_position.y - min_bounds.y) / span_y;
-                    sample.r = r;
-                    sample.g = g;
-                    sample.b = b;
-                    led_samples.push_back(sample);
-                };
-
-                for(const LEDPosition3D& led_position : emitter_transform->led_positions)
-                {
-                    push_led_sample(led_position);
-                }
-
-                if(led_samples.empty())
-                {
-                    continue;
-                }
-
-                EmitterRelayMirror::EmitterSurface surface{};
-                EmitterRelayMirror::BuildSurfaceFromSamples(emitter_ctrl, emitter_transform, led_samples, surface);
-                if(!surface.tex_rgb.empty())
-                {
-                    mirror.surfaces.push_back(std::move(surface));
-                }
-            }
-
-            SpatialLightingSceneProvider::instance()->SetEmitterRelayMirrorFrame(std::move(mirror),
-                                                                                 std::move(emitter_set));
-        }
-    }
-
-    const SpatialLighting::OccluderBuildOptions frame_occluder_options = MergeStackOccluderOptions(active_effects);
-    if(frame_occluder_options.display_planes || frame_occluder_options.room_walls ||
-       frame_occluder_options.controllers || frame_occluder_options.light_blockers)
-    {
-        SpatialLightingSceneProvider::instance()->EnsureFrameOccluders(room_grid, frame_occluder_options);
-    }
-
-    const float shade_cache_quant = MMToGridUnits(24.0f, room_grid.grid_scale_mm);
-    SpatialLightingSceneProvider::instance()->BeginAmbientShadeCacheFrame(shade_cache_quant);
-
-    // Prepare GPU atlases against the same per-slot active grid used for LED eval
-    // (zone / target-bounds / world), not always the full room.
-    for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
-    {
-        SpatialEffect3D* effect = active_effects[effect_idx].effect;
-        if(!effect)
-        {
-            continue;
+                                                                snapshot->emitter_canvas);
         }
-        const EffectSlotGridOverride& grid_override = slot_grid_overrides[effect_idx];
-        const bool use_world_bounds = effect->UseWorldGridBounds();
-        const GridContext3D& global_grid = use_world_bounds ? world_grid : room_grid;
-        const GridContext3D* local_grid =
-            ResolveActiveSlotGrid(grid_override, use_world_bounds);
-        const GridContext3D& active_grid = local_grid ? *local_grid : global_grid;
-        effect->PrepareGpuFields(effect_render_sequence, effect_time, active_grid);
     }
+    snapshot->relay_stack_index = relay_stack_index;
+    snapshot->relay_layer_effect = relay_layer_effect;
 
-    // Room-grid overlay can be tens of thousands of voxels × every effect. While effects
-    // are running, refresh every other frame so LED output keeps CPU/GPU budget.
-    const bool refresh_room_grid_overlay =
-        viewport && viewport->GetShowRoomGridOverlay() && active_effects.size() > 0 &&
-        (!effect_running || (effect_render_sequence & 1ull) == 0ull);
-    if(refresh_room_grid_overlay)
+    // Room-grid overlay can be hundreds of thousands of voxels × every effect. While effects
+    // are running, refresh it progressively so LED output keeps CPU/GPU budget.
+    if(viewport && viewport->GetShowRoomGridOverlay())
     {
-        SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(-1);
-
         viewport->SetRoomGridOverlayBounds(room_bounds.min_x, room_bounds.max_x,
                                            room_bounds.min_y, room_bounds.max_y,
                                            room_bounds.min_z, room_bounds.max_z);
@@ -1004,541 +796,165 @@ void OpenRGB3DSpatialTab::RenderEffectStack()
         const size_t count = (size_t)nx * (size_t)ny * (size_t)nz;
         if(count > 0 && count <= 500000u)
         {
-            if(room_grid_overlay_buffer.size() != count)
+            // Sample positions are separable per axis; capture them so the worker never reads the viewport.
+            snapshot->overlay_axis_x.resize((size_t)nx);
+            snapshot->overlay_axis_y.resize((size_t)ny);
+            snapshot->overlay_axis_z.resize((size_t)nz);
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            for(int ix = 0; ix < nx; ix++)
             {
-                room_grid_overlay_buffer.resize(count);
+                viewport->GetRoomGridOverlaySamplePosition(ix, 0, 0, x, y, z);
+                snapshot->overlay_axis_x[(size_t)ix] = x;
             }
-            const float time_val = effect_time;
-            SpatialRoom::BeginRoomGridOverlayPass();
-            const SpatialEffect3D* overlay_shade_source = ResolveOverlayAmbientShadeSource(active_effects);
-
-            for(int ix = 0; ix < nx; ix++)
+            for(int iy = 0; iy < ny; iy++)
             {
-                for(int iy = 0; iy < ny; iy++)
-                {
-                    for(int iz = 0; iz < nz; iz++)
-                    {
-                        RGBColor final_color = ToRGBColor(0, 0, 0);
-                        float sample_x = 0.0f;
-                        float sample_y = 0.0f;
-                        float sample_z = 0.0f;
-                        viewport->GetRoomGridOverlaySamplePosition(ix, iy, iz, sample_x, sample_y, sample_z);
-                        for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
-                        {
-                            const RenderEffectSlot& slot = active_effects[effect_idx];
-                            if(!slot.effect)
-                            {
-                                continue;
-                            }
-                            const EffectSlotGridOverride& grid_override = slot_grid_overrides[effect_idx];
-                            if(slot.effect->UseZoneGrid() && slot.zone_index != -1 && !grid_override.use_zone_grid)
-                            {
-                                continue;
-                            }
-                            const bool use_world_bounds = slot.effect->UseWorldGridBounds();
-                            const GridContext3D& global_grid = use_world_bounds ? world_grid : room_grid;
-                            const GridContext3D* local_grid =
-                                ResolveActiveSlotGrid(grid_override, use_world_bounds);
-                            const GridContext3D& active_grid = local_grid ? *local_grid : global_grid;
-                            float sx = sample_x;
-                            float sy = sample_y;
-                            float sz = sample_z;
-                            if(!slot.effect->SkipsSpatialSampleWarp())
-                            {
-                                slot.effect->ApplyAxisScale(sx, sy, sz, active_grid);
-                                slot.effect->ApplyEffectRotation(sx, sy, sz, active_grid);
-                            }
-                            RGBColor effect_color =
-                                slot.effect->EvaluateColorGrid(sx, sy, sz, time_val, active_grid);
-                            if(!slot.effect->IsPointOnActiveSurface(sx, sy, sz, active_grid))
-                                effect_color = 0x00000000;
-                            effect_color = slot.effect->PostProcessColorGrid(effect_color);
-                            final_color = BlendColors(final_color, effect_color, slot.blend_mode);
-                        }
-                        if(overlay_shade_source)
-                        {
-                            final_color = overlay_shade_source->ApplyLayerRoomAmbientShading(
-                                sample_x, sample_y, sample_z, final_color, room_grid);
-                        }
-                        room_grid_overlay_buffer[(size_t)ix * (size_t)ny * (size_t)nz + (size_t)iy * (size_t)nz + (size_t)iz] = final_color;
-                    }
-                }
+                viewport->GetRoomGridOverlaySamplePosition(0, iy, 0, x, y, z);
+                snapshot->overlay_axis_y[(size_t)iy] = y;
             }
-            SpatialRoom::EndRoomGridOverlayPass();
-            viewport->SetRoomGridColorCallback(nullptr);
-            viewport->SwapRoomGridColorBuffer(room_grid_overlay_buffer);
+            for(int iz = 0; iz < nz; iz++)
+            {
+                viewport->GetRoomGridOverlaySamplePosition(0, 0, iz, x, y, z);
+                snapshot->overlay_axis_z[(size_t)iz] = z;
+            }
+            snapshot->overlay_enabled = true;
+            snapshot->overlay_progressive = effect_running;
         }
     }
 
-    for(unsigned int ctrl_idx = 0; ctrl_idx < controller_transforms.size(); ctrl_idx++)
-    {
-        ControllerTransform* transform = controller_transforms[ctrl_idx].get();
-        if(!transform || transform->hidden_by_virtual)
-        {
-            continue;
-        }
+    snapshot->layout = std::move(led_layout);
 
-        if(transform->controller &&
-           controllers_managed_by_virtuals.find(transform->controller) != controllers_managed_by_virtuals.end())
-        {
-            continue;
-        }
+    return snapshot;
+}
 
-        ControllerLayout3D::UpdateWorldPositions(transform);
-        SpatialLightingSceneProvider::instance()->SetShadingControllerIndex(static_cast<int>(ctrl_idx));
+void OpenRGB3DSpatialTab::ApplyRenderFrameOutput(EffectRenderOutput& output)
+{
+    if(!output.snapshot || output.snapshot->generation != render_snapshot_generation)
+    {
+        return;
+    }
+    const EffectRenderSnapshot& snapshot = *output.snapshot;
 
-        if(transform->virtual_controller && !transform->controller)
+    const LedFrameLayout3D* layout = snapshot.layout.get();
+    if(layout && output.led_colors.size() == layout->size())
+    {
+        for(const LedFrameLayout3D::ControllerSpan& span : layout->controllers)
         {
-            for(unsigned int led_pos_idx = 0; led_pos_idx < transform->led_positions.size(); ++led_pos_idx)
+            if(span.ctrl_idx >= controller_transforms.size())
             {
-                const LEDPosition3D& led_position = transform->led_positions[led_pos_idx];
-                if(!led_position.controller)
-                {
-                    continue;
-                }
-
-                const Vector3D& world_pos = led_position.world_position;
-                float room_x = led_position.room_position.x;
-                float room_y = led_position.room_position.y;
-                float room_z = led_position.room_position.z;
-                float world_x = world_pos.x;
-                float world_y = world_pos.y;
-                float world_z = world_pos.z;
-
-                if(IsRelayOnlyReceiver(relay_layer_effect, static_cast<int>(ctrl_idx)))
-                {
-                    const bool relay_use_world = relay_layer_effect->RequiresWorldSpaceCoordinates();
-                    const bool relay_world_bounds = relay_layer_effect->UseWorldGridBounds();
-                    const GridContext3D& relay_grid = relay_world_bounds ? world_grid : room_grid;
-                    float sample_x = relay_use_world ? world_x : room_x;
-                    float sample_y = relay_use_world ? world_y : room_y;
-                    float sample_z = relay_use_world ? world_z : room_z;
-                    RGBColor final_color =
-                        relay_layer_effect->SampleRelayShadeAt(sample_x, sample_y, sample_z, relay_grid);
-                    final_color = relay_layer_effect->PostProcessColorGrid(final_color);
-                    transform->led_positions[led_pos_idx].preview_color = final_color;
-
-                    RGBControllerInterface* mapping_controller = led_position.controller;
-                    if(mapping_controller && mapping_controller->GetZoneCount() != 0 && mapping_controller->GetLEDCount() != 0 &&
-                       led_position.zone_idx < mapping_controller->GetZoneCount())
-                    {
-                        unsigned int led_global_idx = 0;
-                        if(TryGetGlobalLedIndex(mapping_controller,
-                                                led_position.zone_idx,
-                                                led_position.led_idx,
-                                                &led_global_idx))
-                        {
-                            mapping_controller->SetColor(led_global_idx, final_color);
-                        }
-                    }
-                    continue;
-                }
-
-                if(IsRelayEmitter(relay_layer_effect, static_cast<int>(ctrl_idx)) &&
-                   emitter_canvas.valid && emitter_canvas.grid)
-                {
-                    RGBColor final_color = ToRGBColor(0, 0, 0);
-                    for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
-                    {
-                        const RenderEffectSlot& slot = active_effects[effect_idx];
-                        SpatialEffect3D* effect = slot.effect;
-                        if(!effect)
-                        {
-                            continue;
-                        }
-                        if(!EffectSlotAppliesToController(slot.zone_index, static_cast<int>(ctrl_idx), zone_manager.get()))
-                        {
-                            continue;
-                        }
-                        if(!ShouldApplyStackLayerToController(effect,
-                                                              effect_idx,
-                                                              relay_stack_index,
-                                                              relay_layer_effect != nullptr,
-                                                              static_cast<int>(ctrl_idx)))
-                        {
-                            continue;
-                        }
-                        RGBColor effect_color = SamplePatternOnEmitterCanvas(effect,
-                                                                             room_x,
-                                                                             room_y,
-                                                                             room_z,
-                                                                             effect_time,
-                                                                             emitter_canvas);
-                        if(!effect->IsPointOnActiveSurface(room_x, room_y, room_z, *emitter_canvas.grid))
-                        {
-                            effect_color = 0x00000000;
-                        }
-                        effect_color = effect->PostProcessColorGrid(effect_color);
-                        final_color = BlendColors(final_color, effect_color, slot.blend_mode);
-                    }
-                    if(const SpatialEffect3D* shade_source = ResolveAmbientShadeSource(active_effects,
-                                                                                         relay_stack_index,
-                                                                                         relay_layer_effect != nullptr,
-                                                                                         static_cast<int>(ctrl_idx),
-                                                                                         zone_manager.get()))
-                    {
-                        final_color = shade_source->ApplyLayerRoomAmbientShading(room_x,
-                                                                                   room_y,
-                                                                                   room_z,
-                                                                                   final_color,
-                                                                                   room_grid,
-                                                                                   PackAmbientShadeSlot(static_cast<int>(ctrl_idx),
-                                                                                                        static_cast<int>(led_pos_idx)));
-                    }
-                    transform->led_positions[led_pos_idx].preview_color = final_color;
-
-                    RGBControllerInterface* mapping_controller = led_position.controller;
-                    if(mapping_controller && mapping_controller->GetZoneCount() != 0 && mapping_controller->GetLEDCount() != 0 &&
-                       led_position.zone_idx < mapping_controller->GetZoneCount())
-                    {
-                        unsigned int led_global_idx = 0;
-                        if(TryGetGlobalLedIndex(mapping_controller,
-                                                led_position.zone_idx,
-                                                led_position.led_idx,
-                                                &led_global_idx))
-                        {
-                            mapping_controller->SetColor(led_global_idx, final_color);
-                        }
-                    }
-                    continue;
-                }
-
-                RGBColor final_color = ToRGBColor(0, 0, 0);
-                    for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
-                    {
-                        const RenderEffectSlot& slot = active_effects[effect_idx];
-                        SpatialEffect3D* effect = slot.effect;
-                        if(!effect)
-                        {
-                            continue;
-                        }
-
-                        if(!EffectSlotAppliesToController(slot.zone_index,
-                                                          static_cast<int>(ctrl_idx),
-                                                          zone_manager.get()))
-                        {
-                            continue;
-                        }
-                        if(!ShouldApplyStackLayerToController(effect,
-                                                              effect_idx,
-                                                              relay_stack_index,
-                                                              relay_layer_effect != nullptr,
-                                                              static_cast<int>(ctrl_idx)))
-                        {
-                            continue;
-                        }
-                        const EffectSlotGridOverride& grid_override = slot_grid_overrides[effect_idx];
-                        if(effect->UseZoneGrid() && slot.zone_index != -1 && !grid_override.use_zone_grid)
-                        {
-                            continue;
-                        }
-
-                        const bool requires_world = effect->RequiresWorldSpaceCoordinates();
-                        float sample_x = requires_world ? world_x : room_x;
-                        float sample_y = requires_world ? world_y : room_y;
-                        float sample_z = requires_world ? world_z : room_z;
-                        const bool use_world_bounds = effect->UseWorldGridBounds();
-                        const GridContext3D& global_grid = use_world_bounds ? world_grid : room_grid;
-                        const GridContext3D* local_grid =
-                            ResolveActiveSlotGrid(grid_override, use_world_bounds);
-                        const GridContext3D& stack_grid = local_grid ? *local_grid : global_grid;
-                        MinecraftGame::SetRenderSampleIndexContext((int)led_pos_idx, (int)transform->led_positions.size());
-                        if(!effect->SkipsSpatialSampleWarp())
-                        {
-                            effect->ApplyAxisScale(sample_x, sample_y, sample_z, stack_grid);
-                            effect->ApplyEffectRotation(sample_x, sample_y, sample_z, stack_grid);
-                        }
-                        RGBColor effect_color = SampleStackLayerColor(effect,
-                                                                      sample_x,
-                                                                      sample_y,
-                                                                      sample_z,
-                                                                      effect_time,
-                                                                      stack_grid);
-                        if(!effect->IsPointOnActiveSurface(sample_x, sample_y, sample_z, stack_grid))
-                            effect_color = 0x00000000;
-                        effect_color = effect->PostProcessColorGrid(effect_color);
-                        final_color = BlendColors(final_color, effect_color, slot.blend_mode);
-                    }
-
-                if(const SpatialEffect3D* shade_source = ResolveAmbientShadeSource(active_effects,
-                                                                                     relay_stack_index,
-                                                                                     relay_layer_effect != nullptr,
-                                                                                     static_cast<int>(ctrl_idx),
-                                                                                     zone_manager.get()))
-                {
-                    final_color = shade_source->ApplyLayerRoomAmbientShading(room_x,
-                                                                               room_y,
-                                                                               room_z,
-                                                                               final_color,
-                                                                               room_grid,
-                                                                               PackAmbientShadeSlot(static_cast<int>(ctrl_idx),
-                                                                                                    static_cast<int>(led_pos_idx)));
-                }
-
-                transform->led_positions[led_pos_idx].preview_color = final_color;
-
-                RGBControllerInterface* mapping_controller = led_position.controller;
-                if(!mapping_controller || mapping_controller->GetZoneCount() == 0 || mapping_controller->GetLEDCount() == 0)
-                {
-                    continue;
-                }
-
-                if(led_position.zone_idx < mapping_controller->GetZoneCount())
-                {
-                    unsigned int led_global_idx = 0;
-                    if(TryGetGlobalLedIndex(mapping_controller,
-                                            led_position.zone_idx,
-                                            led_position.led_idx,
-                                            &led_global_idx))
-                    {
-                        mapping_controller->SetColor(led_global_idx, final_color);
-                    }
-                }
+                continue;
             }
-        }
-        else
-        {
-            RGBControllerInterface* controller = transform->controller;
-            if(!controller || controller->GetZoneCount() == 0 || controller->GetLEDCount() == 0)
+            ControllerTransform* transform = controller_transforms[span.ctrl_idx].get();
+            if(transform != span.transform ||
+               transform->led_positions.size() != span.led_position_count ||
+               (transform->virtual_controller && !transform->controller) != span.virtual_only)
             {
                 continue;
             }
-
-            for(unsigned int led_pos_idx = 0; led_pos_idx < transform->led_positions.size(); led_pos_idx++)
+            if(!span.virtual_only && !transform->controller)
             {
-                LEDPosition3D& led_position = transform->led_positions[led_pos_idx];
-                const Vector3D& world_pos = led_position.world_position;
-                const Vector3D& room_pos = led_position.room_position;
-                float room_x = room_pos.x;
-                float room_y = room_pos.y;
-                float room_z = room_pos.z;
-                float world_x = world_pos.x;
-                float world_y = world_pos.y;
-                float world_z = world_pos.z;
-
-                if(led_position.zone_idx >= controller->GetZoneCount())
-                {
-                    continue;
-                }
-                unsigned int led_global_idx = 0;
-                if(!TryGetGlobalLedIndex(controller, led_position.zone_idx, led_position.led_idx, &led_global_idx))
-                {
-                    continue;
-                }
-
-                if(IsRelayOnlyReceiver(relay_layer_effect, static_cast<int>(ctrl_idx)))
-                {
-                    const bool relay_use_world = relay_layer_effect->RequiresWorldSpaceCoordinates();
-                    const bool relay_world_bounds = relay_layer_effect->UseWorldGridBounds();
-                    const GridContext3D& relay_grid = relay_world_bounds ? world_grid : room_grid;
-                    float sample_x = relay_use_world ? world_x : room_x;
-                    float sample_y = relay_use_world ? world_y : room_y;
-                    float sample_z = relay_use_world ? world_z : room_z;
-                    RGBColor final_color =
-                        relay_layer_effect->SampleRelayShadeAt(sample_x, sample_y, sample_z, relay_grid);
-                    final_color = relay_layer_effect->PostProcessColorGrid(final_color);
-                    transform->led_positions[led_pos_idx].preview_color = final_color;
-                    if(led_global_idx < controller->GetLEDCount())
-                    {
-                        controller->SetColor(led_global_idx, final_color);
-                    }
-                    continue;
-                }
+                continue;
+            }
 
-                if(IsRelayEmitter(relay_layer_effect, static_cast<int>(ctrl_idx)) &&
-                   emitter_canvas.valid && emitter_canvas.grid)
+            for(size_t zone_idx = span.first_zone; zone_idx < span.first_zone + span.zone_count; zone_idx++)
+            {
+                const LedFrameLayout3D::ZoneSpan& zone = layout->zones[zone_idx];
+                // Virtual mappings can be rebound between compile and apply; only write where they still agree.
+                RGBControllerInterface* controller = zone.controller;
+                if(controller && !span.virtual_only && controller != transform->controller)
                 {
-                    RGBColor final_color = ToRGBColor(0, 0, 0);
-                    for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
-                    {
-                        const RenderEffectSlot& slot = active_effects[effect_idx];
-                        SpatialEffect3D* effect = slot.effect;
-                        if(!effect)
-                        {
-                            continue;
-                        }
-                        if(!EffectSlotAppliesToController(slot.zone_index, static_cast<int>(ctrl_idx), zone_manager.get()))
-                        {
-                            continue;
-                        }
-                        if(!ShouldApplyStackLayerToController(effect,
-                                                              effect_idx,
-                                                              relay_stack_index,
-                                                              relay_layer_effect != nullptr,
-                                                              static_cast<int>(ctrl_idx)))
-                        {
-                            continue;
-                        }
-                        RGBColor effect_color = SamplePatternOnEmitterCanvas(effect,
-                                                                             room_x,
-                                                                             room_y,
-                                                                             room_z,
-                                                                             effect_time,
-                                                                             emitter_canvas);
-                        if(!effect->IsPointOnActiveSurface(room_x, room_y, room_z, *emitter_canvas.grid))
-                        {
-                            effect_color = 0x00000000;
-                        }
-                        effect_color = effect->PostProcessColorGrid(effect_color);
-                        final_color = BlendColors(final_color, effect_color, slot.blend_mode);
-                    }
-                    if(const SpatialEffect3D* shade_source = ResolveAmbientShadeSource(active_effects,
-                                                                                         relay_stack_index,
-                                                                                         relay_layer_effect != nullptr,
-                                                                                         static_cast<int>(ctrl_idx),
-                                                                                         zone_manager.get()))
-                    {
-                        final_color = shade_source->ApplyLayerRoomAmbientShading(room_x,
-                                                                                   room_y,
-                                                                                   room_z,
-                                                                                   final_color,
-                                                                                   room_grid,
-                                                                                   PackAmbientShadeSlot(static_cast<int>(ctrl_idx),
-                                                                                                        static_cast<int>(led_pos_idx)));
-                    }
-                    transform->led_positions[led_pos_idx].preview_color = final_color;
-                    if(led_global_idx < controller->GetLEDCount())
-                    {
-                        controller->SetColor(led_global_idx, final_color);
-                    }
-                    continue;
+                    controller = nullptr;
                 }
-
-                RGBColor final_color = ToRGBColor(0, 0, 0);
-                for(size_t effect_idx = 0; effect_idx < active_effects.size(); effect_idx++)
+                // Device colours go through the output stage; its worker is the only writer of the controller.
+                RGBColor* device_frame = (controller && controller_output) ? controller_output->GetFrameBuffer(controller)
+                                                                           : nullptr;
+                const unsigned int device_led_count = device_frame ? controller->GetLEDCount() : 0;
+                for(size_t layout_idx = zone.first; layout_idx < zone.first + zone.count; layout_idx++)
                 {
-                    const RenderEffectSlot& slot = active_effects[effect_idx];
-                    SpatialEffect3D* effect = slot.effect;
-                    if(!effect)
-                    {
-                        continue;
-                    }
-
-                    if(!EffectSlotAppliesToController(slot.zone_index,
-                                                      static_cast<int>(ctrl_idx),
-                                                      zone_manager.get()))
-                    {
-                        continue;
-                    }
-                    if(!ShouldApplyStackLayerToController(effect,
-                                                          effect_idx,
-                                                          relay_stack_index,
-                                                          relay_layer_effect != nullptr,
-                                                          static_cast<int>(ctrl_idx)))
+                    LEDPosition3D& led_position = transform->led_positions[layout->led_position_index[layout_idx]];
+                    const RGBColor final_color = output.led_colors[layout_idx];
+                    led_position.preview_color = final_color;
+                    if(!device_frame || (span.virtual_only && led_position.controller != controller))
                     {
                         continue;
                     }
-                    const EffectSlotGridOverride& grid_override = slot_grid_overrides[effect_idx];
-                    if(effect->UseZoneGrid() && slot.zone_index != -1 && !grid_override.use_zone_grid)
+                    const unsigned int led_global_idx = layout->global_led_index[layout_idx];
+                    if(led_global_idx < device_led_count)
                     {
-                        continue;
+                        device_frame[led_global_idx] = final_color;
                     }
-
-                    const bool requires_world = effect->RequiresWorldSpaceCoordinates();
-                    float sample_x = requires_world ? world_x : room_x;
-                    float sample_y = requires_world ? world_y : room_y;
-                    float sample_z = requires_world ? world_z : room_z;
-                    const bool use_world_bounds = effect->UseWorldGridBounds();
-                    const GridContext3D& global_grid = use_world_bounds ? world_grid : room_grid;
-                    const GridContext3D* local_grid =
-                        ResolveActiveSlotGrid(grid_override, use_world_bounds);
-                    const GridContext3D& stack_grid = local_grid ? *local_grid : global_grid;
-                    MinecraftGame::SetRenderSampleIndexContext((int)led_pos_idx, (int)transform->led_positions.size());
-                    if(!effect->SkipsSpatialSampleWarp())
-                    {
-                        effect->ApplyAxisScale(sample_x, sample_y, sample_z, stack_grid);
-                        effect->ApplyEffectRotation(sample_x, sample_y, sample_z, stack_grid);
-                    }
-                    RGBColor effect_color = SampleStackLayerColor(effect,
-                                                                  sample_x,
-                                                                  sample_y,
-                                                                  sample_z,
-                                                                  effect_time,
-                                                                  stack_grid);
-                    if(!effect->IsPointOnActiveSurface(sample_x, sample_y, sample_z, stack_grid))
-                        effect_color = 0x00000000;
-                    effect_color = effect->PostProcessColorGrid(effect_color);
-
-                    final_color = BlendColors(final_color, effect_color, slot.blend_mode);
-                }
-
-                if(const SpatialEffect3D* shade_source = ResolveAmbientShadeSource(active_effects,
-                                                                                     relay_stack_index,
-                                                                                     relay_layer_effect != nullptr,
-                                                                                     static_cast<int>(ctrl_idx),
-                                                                                     zone_manager.get()))
-                {
-                    final_color = shade_source->ApplyLayerRoomAmbientShading(room_x,
-                                                                               room_y,
-                                                                               room_z,
-                                                                               final_color,
-                                                                               room_grid,
-                                                                               PackAmbientShadeSlot(static_cast<int>(ctrl_idx),
-                                                                                                    static_cast<int>(led_pos_idx)));
-                }
-
-                transform->led_positions[led_pos_idx].preview_color = final_color;
-
-                if(led_global_idx < controller->GetLEDCount())
-                {
-                    controller->SetColor(led_global_idx, final_color);
                 }
             }
         }
     }
 
-    EffectAxis sort_axis = AXIS_Y;
-    std::vector<std::pair<float, unsigned int>> sorted_controllers;
-    sorted_controllers.reserve(controller_transforms.size());
-
-    for(unsigned int i = 0; i < controller_transforms.size(); i++)
+    if(output.overlay_valid && viewport && viewport->GetShowRoomGridOverlay())
     {
-        ControllerTransform* transform = controller_transforms[i].get();
-        if(!transform) continue;
-        float key = AverageAlongAxis(transform, sort_axis, stack_ref_origin);
-        sorted_controllers.emplace_back(key, i);
+        int nx = 0, ny = 0, nz = 0;
+        viewport->GetRoomGridOverlayDimensions(&nx, &ny, &nz);
+        if(output.overlay_colors->size() == (size_t)nx * (size_t)ny * (size_t)nz)
+        {
+            viewport->SetRoomGridColorCallback(nullptr);
+            viewport->ShareRoomGridColorBuffer(output.overlay_colors);
+        }
     }
 
-    std::sort(sorted_controllers.begin(), sorted_controllers.end(),
-        [&](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b){
-        return a.first < b.first;
-    });
+    // Output order only changes with the layout, so it is sorted once per snapshot generation.
+    if(!output_order_valid || output_order_generation != snapshot.generation)
+    {
+        EffectAxis sort_axis = AXIS_Y;
+        std::vector<std::pair<float, unsigned int>> sorted_controllers;
+        sorted_controllers.reserve(controller_transforms.size());
 
-    std::set<RGBControllerInterface*> updated_physical_controllers;
+        for(unsigned int i = 0; i < controller_transforms.size(); i++)
+        {
+            ControllerTransform* transform = controller_transforms[i].get();
+            if(!transform) continue;
+            float key = AverageAlongAxis(transform, sort_axis, snapshot.stack_ref_origin);
+            sorted_controllers.emplace_back(key, i);
+        }
 
-    for(unsigned int i = 0; i < sorted_controllers.size(); i++)
-    {
-        unsigned int ctrl_idx = sorted_controllers[i].second;
-        ControllerTransform* transform = controller_transforms[ctrl_idx].get();
+        std::sort(sorted_controllers.begin(), sorted_controllers.end(),
+            [&](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b){
+            return a.first < b.first;
+        });
 
-        if(!transform) continue;
+        std::unordered_set<RGBControllerInterface*> ordered_physical_controllers;
+        output_controller_order.clear();
 
-        if(transform->virtual_controller && !transform->controller)
+        for(unsigned int i = 0; i < sorted_controllers.size(); i++)
         {
-            VirtualController3D* virtual_ctrl = transform->virtual_controller;
-            const std::vector<GridLEDMapping>& mappings = virtual_ctrl->GetMappings();
+            ControllerTransform* transform = controller_transforms[sorted_controllers[i].second].get();
 
-            for(unsigned int mapping_idx = 0; mapping_idx < mappings.size(); mapping_idx++)
+            if(!transform) continue;
+
+            if(transform->virtual_controller && !transform->controller)
             {
-                if(mappings[mapping_idx].controller &&
-                   updated_physical_controllers.find(mappings[mapping_idx].controller) == updated_physical_controllers.end())
+                const std::vector<GridLEDMapping>& mappings = transform->virtual_controller->GetMappings();
+                for(unsigned int mapping_idx = 0; mapping_idx < mappings.size(); mapping_idx++)
                 {
-                    mappings[mapping_idx].controller->UpdateLEDs();
-                    updated_physical_controllers.insert(mappings[mapping_idx].controller);
+                    if(mappings[mapping_idx].controller &&
+                       ordered_physical_controllers.insert(mappings[mapping_idx].controller).second)
+                    {
+                        output_controller_order.push_back(mappings[mapping_idx].controller);
+                    }
                 }
             }
-        }
-        else if(transform->controller)
-        {
-            if(updated_physical_controllers.find(transform->controller) == updated_physical_controllers.end())
+            else if(transform->controller && ordered_physical_controllers.insert(transform->controller).second)
             {
-                transform->controller->UpdateLEDs();
-                updated_physical_controllers.insert(transform->controller);
+                output_controller_order.push_back(transform->controller);
             }
         }
+        output_order_generation = snapshot.generation;
+        output_order_valid = true;
     }
 
-    MinecraftGame::ClearRenderSampleIndexContext();
+    if(controller_output)
+    {
+        for(RGBControllerInterface* controller : output_controller_order)
+        {
+            controller_output->Submit(controller);
+        }
+    }
 
     if(viewport)
     {
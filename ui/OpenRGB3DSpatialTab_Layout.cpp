@@ -433,6 +433,7 @@ void OpenRGB3DSpatialTab::LoadLayoutFromJSON(const nlohmann::json& layout_json)
             ControllerLayout3D::MarkWorldPositionsDirty(ctrl_transform.get());
             ControllerLayout3D::UpdateWorldPositions(ctrl_transform.get());
 
+            InvalidateRenderSnapshot();
             controller_transforms.push_back(std::move(ctrl_transform));
 
             QColor color;
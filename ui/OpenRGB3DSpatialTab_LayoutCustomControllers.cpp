@@ -87,6 +87,7 @@ void OpenRGB3DSpatialTab::createCustomControllerClicked()
         for(int ti : transform_indices_to_remove)
         {
             RemoveControllerLinkedReferencePoint(ti);
+            InvalidateRenderSnapshot();
             controller_transforms.erase(controller_transforms.begin() + ti);
         }
         if(viewport)
@@ -450,6 +451,7 @@ void OpenRGB3DSpatialTab::editCustomControllerClicked()
             for(int ti : transform_indices_to_remove)
             {
                 RemoveControllerLinkedReferencePoint(ti);
+                InvalidateRenderSnapshot();
                 controller_transforms.erase(controller_transforms.begin() + ti);
             }
             if(viewport)
@@ -591,6 +593,7 @@ void OpenRGB3DSpatialTab::deleteCustomControllerClicked()
         for(int ti : transform_indices_to_remove)
         {
             RemoveControllerLinkedReferencePoint(ti);
+            InvalidateRenderSnapshot();
             controller_transforms.erase(controller_transforms.begin() + ti);
         }
         if(viewport)
@@ -694,6 +697,7 @@ void OpenRGB3DSpatialTab::RemoveVirtualControllerFromLibrary(int index)
         for(int ti : transform_indices_to_remove)
         {
             RemoveControllerLinkedReferencePoint(ti);
+            InvalidateRenderSnapshot();
             controller_transforms.erase(controller_transforms.begin() + ti);
         }
         if(viewport)
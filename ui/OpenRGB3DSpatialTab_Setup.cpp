@@ -470,6 +470,13 @@ void OpenRGB3DSpatialTab::SelectAvailableControllerEntry(int type_code, int obje
 
 void OpenRGB3DSpatialTab::UpdateDeviceList()
 {
+    // Workers hold raw controller pointers; let in-flight writes finish before the list is rebuilt.
+    if(controller_output)
+    {
+        controller_output->Reset();
+    }
+    output_controller_order.clear();
+    output_order_valid = false;
     LoadDevices();
 }
 
@@ -944,6 +951,7 @@ bool OpenRGB3DSpatialTab::AddCustomControllerToScene(int virtual_controller_inde
     QColor color = QColor::fromHsv(hue, 200, 255);
     ctrl_transform->display_color = (color.blue() << 16) | (color.green() << 8) | color.red();
     ControllerLayout3D::UpdateWorldPositions(ctrl_transform.get());
+    InvalidateRenderSnapshot();
     controller_transforms.push_back(std::move(ctrl_transform));
     int new_transform_index = (int)controller_transforms.size() - 1;
     QString name = QString("[Custom] ") + QString::fromStdString(virtual_ctrl->GetName());
@@ -1403,6 +1411,7 @@ void OpenRGB3DSpatialTab::AddControllerEntryToScene(int  ctrl_idx,
     ControllerLayout3D::MarkWorldPositionsDirty(ctrl_transform.get());
     ControllerLayout3D::UpdateWorldPositions(ctrl_transform.get());
 
+    InvalidateRenderSnapshot();
     controller_transforms.push_back(std::move(ctrl_transform));
     int new_transform_index = (int)controller_transforms.size() - 1;
 
@@ -1508,6 +1517,7 @@ void OpenRGB3DSpatialTab::removeControllerClicked()
     }
 
     RemoveControllerLinkedReferencePoint(transform_index);
+    InvalidateRenderSnapshot();
     controller_transforms.erase(controller_transforms.begin() + transform_index);
 
     scene_controllers_.removeAt(selected_row);
@@ -1532,6 +1542,7 @@ void OpenRGB3DSpatialTab::removeControllerFromViewport(int index)
 
     int list_row = TransformIndexToControllerListRow(index);
     RemoveControllerLinkedReferencePoint(index);
+    InvalidateRenderSnapshot();
     controller_transforms.erase(controller_transforms.begin() + index);
 
     if(list_row >= 0)
@@ -1570,6 +1581,7 @@ void OpenRGB3DSpatialTab::clearAllClicked()
         display_planes[i]->SetVisible(false);
     }
 
+    InvalidateRenderSnapshot();
     controller_transforms.clear();
     scene_controllers_.clear();
 
@@ -22,6 +22,7 @@
 #include <QVBoxLayout>
 
 #include <algorithm>
+#include <mutex>
 
 EffectRoomOutputPanel::EffectRoomOutputPanel(QWidget* parent) : QWidget(parent)
 {
@@ -209,6 +210,7 @@ void EffectRoomOutputPanel::appendDeviceCards(QVBoxLayout* layout,
                     const auto* transforms = SpatialLightingSceneProvider::instance()->controllers();
                     if(transforms)
                     {
+                        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
                         for(size_t j = 0; j < transforms->size(); ++j)
                         {
                             const ControllerTransform* t = (*transforms)[j].get();
@@ -339,6 +341,7 @@ void EffectRoomOutputPanel::syncFromState(SpatialRoom::SpatialRoomOutputRole out
     relay_panel_->syncFromParams(relay_params);
     if(bound_role_)
     {
+        std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
         *bound_role_ = display_role;
     }
     refreshRolePanels();
@@ -368,9 +371,12 @@ void EffectRoomOutputPanel::bind(SpatialEffect3D* effect,
     connect(output_combo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
             [&output_role, changed, this](int index) {
                 const int raw = output_combo_->itemData(index).toInt();
-                output_role = (raw == (int)SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
-                                  ? SpatialRoom::SpatialRoomOutputRole::EmitterRelay
-                                  : SpatialRoom::SpatialRoomOutputRole::Direct;
+                {
+                    std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                    output_role = (raw == (int)SpatialRoom::SpatialRoomOutputRole::EmitterRelay)
+                                      ? SpatialRoom::SpatialRoomOutputRole::EmitterRelay
+                                      : SpatialRoom::SpatialRoomOutputRole::Direct;
+                }
                 refreshRolePanels();
                 changed();
             });
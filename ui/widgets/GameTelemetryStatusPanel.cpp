@@ -72,7 +72,8 @@ void GameTelemetryStatusPanel::RefreshStatus()
                                    .arg(valid)
                                    .arg(error));
 
-    const GameTelemetryBridge::TelemetrySnapshot snap = GameTelemetryBridge::GetTelemetrySnapshot();
+    const std::shared_ptr<const GameTelemetryBridge::TelemetrySnapshot> snap_ptr = GameTelemetryBridge::GetTelemetrySnapshot();
+    const GameTelemetryBridge::TelemetrySnapshot& snap = *snap_ptr;
     if(signals_label)
     {
         QString room_detail = QStringLiteral("no");
@@ -6,6 +6,9 @@
 #include "SpatialLighting/RoomSpatialLightingUi.h"
 #include "EffectSliderRow.h"
 #include "EffectInfoLabel.h"
+#include "SpatialEffect3D.h"
+
+#include <mutex>
 
 RoomSpatialLightSettingsPanel::RoomSpatialLightSettingsPanel(QWidget* parent)
     : QWidget(parent)
@@ -56,7 +59,10 @@ void RoomSpatialLightSettingsPanel::bindRelayTuneSliders(QObject* owner,
     ui->glowSizeRow->bindValueChanged(
         owner,
         [&params, tuneChanged](int v) {
-            params.glow_radius_mm = static_cast<float>(v);
+            {
+                std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                params.glow_radius_mm = static_cast<float>(v);
+            }
             if(tuneChanged)
             {
                 tuneChanged();
@@ -68,7 +74,10 @@ void RoomSpatialLightSettingsPanel::bindRelayTuneSliders(QObject* owner,
     ui->lightReachRow->bindValueChanged(
         owner,
         [&params, tuneChanged](int v) {
-            params.light_reach_mm = static_cast<float>(v);
+            {
+                std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                params.light_reach_mm = static_cast<float>(v);
+            }
             if(tuneChanged)
             {
                 tuneChanged();
@@ -80,7 +89,10 @@ void RoomSpatialLightSettingsPanel::bindRelayTuneSliders(QObject* owner,
     ui->roomFillRow->bindValueChanged(
         owner,
         [&params, tuneChanged](int v) {
-            params.room_fill = static_cast<float>(v);
+            {
+                std::lock_guard<std::recursive_mutex> render_lock(SpatialEffect3D::RenderStateMutex());
+                params.room_fill = static_cast<float>(v);
+            }
             if(tuneChanged)
             {
                 tuneChanged();